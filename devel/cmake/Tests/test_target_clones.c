@@ -0,0 +1,16 @@
+#include <stdlib.h>
+
+__attribute__((target_clones("avx2","default")))
+static int sum( const int * data , int size ) {
+  int s = 0;
+  int i;
+  for (i=0; i < size; i++)
+    s += data[i];
+  return s;
+}
+
+
+int main(int argc, char ** argv) {
+  int data[4] = {1,2,3,4};
+  return sum( data , 4 ) - 10;
+}
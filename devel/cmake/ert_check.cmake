@@ -76,6 +76,11 @@ if (HAVE_FNMATCH)
   add_definitions( -DHAVE_FNMATCH )
 endif()
 
+check_function_exists( mmap HAVE_MMAP )
+if (HAVE_MMAP)
+  add_definitions( -DHAVE_MMAP )
+endif()
+
 check_function_exists( fsync HAVE_FSYNC )
 if (HAVE_FSYNC)
   add_definitions( -DHAVE_FSYNC )
@@ -135,6 +140,14 @@ if (HAVE_VA_COPY)
 endif()
 
 
+# Function multiversioning; used to compile the bulk conversion loops
+# in util.c for several instruction sets with runtime selection.
+try_compile( HAVE_TARGET_CLONES ${CMAKE_BINARY_DIR} ${PROJECT_SOURCE_DIR}/cmake/Tests/test_target_clones.c )
+if (HAVE_TARGET_CLONES)
+   add_definitions( -DHAVE_TARGET_CLONES )
+endif()
+
+
 try_compile( ISREG_POSIX ${CMAKE_BINARY_DIR} ${PROJECT_SOURCE_DIR}/cmake/Tests/test_isreg.c )
 if (ISREG_POSIX)
   add_definitions( -DHAVE_ISREG )
@@ -17,100 +17,209 @@
 */
 
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/msg.h>
 
 #include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
 #include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_archive.h>
 #include <ert/ecl/ecl_endian_flip.h>   
 
 
+/*
+  Will copy all the keywords of the file @src_file to the archive;
+  the keywords are read one at a time so the full file is never in
+  memory.
+*/
+
+static void archive_add_file( ecl_archive_type * archive , const char * src_file , bool fmt_file) {
+  fortio_type * fortio = fortio_open_reader( src_file , fmt_file , ECL_ENDIAN_FLIP );
+  while (true) {
+    ecl_kw_type * ecl_kw = ecl_kw_fread_alloc( fortio );
+    if (ecl_kw == NULL)
+      break;
+    
+    ecl_archive_add_kw( archive , ecl_kw );
+    ecl_kw_free( ecl_kw );
+  }
+  fortio_fclose( fortio );
+}
+
+
+static void archive_report( ecl_archive_type * archive ) {
+  size_t data_size = ecl_archive_get_data_size( archive );
+  size_t compressed_size = ecl_archive_get_compressed_size( archive );
+
+  printf("Archived %d keywords: %ld bytes compressed to %ld bytes \n", 
+         ecl_archive_get_size( archive ) , (long) data_size , (long) compressed_size);
+}
+
+
+/*
+  A unified file given with the -z option is stored as an archive
+  without any further processing.
+*/
+
+static void archive_unified_file( const char * filename , bool fmt_file , int num_threads) {
+  char * ecl_base;
+  char * extension;
+  char * target_file_name;
+  ecl_archive_type * archive;
+
+  util_alloc_file_components( filename , NULL , &ecl_base , &extension);
+  target_file_name = util_alloc_sprintf("%s.%s.%s" , ecl_base , extension , ECL_ARCHIVE_EXT);
+  archive = ecl_archive_alloc_writer( target_file_name , 0 , num_threads );
+
+  printf("Packing %s <= %s \n", target_file_name , filename);
+  archive_add_file( archive , filename , fmt_file );
+  ecl_archive_close( archive );
+  {
+    ecl_archive_type * result = ecl_archive_open( target_file_name );
+    archive_report( result );
+    ecl_archive_close( result );
+  }
+
+  free( target_file_name );
+  free( extension );
+  free( ecl_base );
+}
+
+
+/*
+  The packed restart and summary files can optionally be written as
+  a compressed ecl_archive with the -z option; the archive can be
+  read directly by ecl_file, or unpacked again with ecl_unpack.
+*/
 
 int main(int argc, char ** argv) {
-  int num_files = argc - 1;
-  if (num_files >= 1) {
-    /* File type and formatted / unformatted is determined from the first argument on the command line. */
-    char * ecl_base;
-    char * path;
-    ecl_file_enum file_type , target_type;
-    bool fmt_file;
-
-    /** Look at the first command line argument to determine type and formatted/unformatted status. */
-    file_type = ecl_util_get_file_type( argv[1] , &fmt_file , NULL);
-    if (file_type == ECL_SUMMARY_FILE)
-      target_type = ECL_UNIFIED_SUMMARY_FILE;
-    else if (file_type == ECL_RESTART_FILE)
-      target_type = ECL_UNIFIED_RESTART_FILE;
-    else {
-      util_exit("The ecl_pack program can only be used with ECLIPSE restart files or summary files.\n");
-      target_type = -1;
-    }
-    util_alloc_file_components( argv[1] , &path , &ecl_base , NULL);
+  bool use_archive = false;
+  int arg_offset = 1;
 
-    
-    /**
-       Will pack to cwd, even though the source files might be
-       somewhere else. To unpack to the same directory as the source
-       files, just send in @path as first argument when creating the
-       target_file.
-    */
+  if ((argc > 1) && util_string_equal( argv[1] , "-z")) {
+    use_archive = true;
+    arg_offset = 2;
+  }
 
+  {
+    int num_files = argc - arg_offset;
+    if (num_files < 1) {
+      printf("Usage: ecl_pack [-z] FILE1 FILE2 FILE3 .... \n\nWith the -z option the result is written as a compressed archive; a unified file can then also be given as input.\n");
+      exit(1);
+    }
     {
-      msg_type * msg;
-      int i , report_step , prev_report_step;
-      char *  target_file_name   = ecl_util_alloc_filename( NULL , ecl_base , target_type , fmt_file , -1);
-      stringlist_type * filelist = stringlist_alloc_argv_copy( (const char **) &argv[1] , num_files );
-      ecl_kw_type * seqnum_kw    = NULL;
-      fortio_type * target       = fortio_open_writer( target_file_name , fmt_file , ECL_ENDIAN_FLIP);
-
-      if (target_type == ECL_UNIFIED_RESTART_FILE) {
-        int dummy;
-        seqnum_kw = ecl_kw_alloc_new("SEQNUM" , 1 , ECL_INT_TYPE , &dummy);
-      } 
+      /* File type and formatted / unformatted is determined from the first argument on the command line. */
+      const char * first_file = argv[arg_offset];
+      int num_threads = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
+      char * ecl_base;
+      char * path;
+      ecl_file_enum file_type , target_type;
+      bool fmt_file;
       
-      {
-        char * msg_format = util_alloc_sprintf("Packing %s <= " , target_file_name);
-        msg = msg_alloc( msg_format , false);
-        free( msg_format );
+      /** Look at the first command line argument to determine type and formatted/unformatted status. */
+      file_type = ecl_util_get_file_type( first_file , &fmt_file , NULL);
+      if (use_archive && (num_files == 1) && ((file_type == ECL_UNIFIED_SUMMARY_FILE) || (file_type == ECL_UNIFIED_RESTART_FILE))) {
+        archive_unified_file( first_file , fmt_file , num_threads );
+        exit(0);
       }
-      
 
-      msg_show( msg );
-      stringlist_sort( filelist , ecl_util_fname_report_cmp);
-      prev_report_step = -1;
-      for (i=0; i < num_files; i++) {
-        ecl_file_enum this_file_type;
-        this_file_type = ecl_util_get_file_type( stringlist_iget(filelist , i)  , NULL , &report_step);
-        if (this_file_type == file_type) {
-          if (report_step == prev_report_step)
-            util_exit("Tried to write same report step twice: %s / %s \n",
-                      stringlist_iget(filelist , i-1) , 
-                      stringlist_iget(filelist , i));
-
-          prev_report_step = report_step;
-          msg_update(msg , stringlist_iget( filelist , i));
-          {
-            ecl_file_type * src_file = ecl_file_open( stringlist_iget( filelist , i) );
+      if (file_type == ECL_SUMMARY_FILE)
+        target_type = ECL_UNIFIED_SUMMARY_FILE;
+      else if (file_type == ECL_RESTART_FILE)
+        target_type = ECL_UNIFIED_RESTART_FILE;
+      else {
+        util_exit("The ecl_pack program can only be used with ECLIPSE restart files or summary files.\n");
+        target_type = -1;
+      }
+      util_alloc_file_components( first_file , &path , &ecl_base , NULL);
+      
+      
+      /**
+         Will pack to cwd, even though the source files might be
+         somewhere else. To unpack to the same directory as the source
+         files, just send in @path as first argument when creating the
+         target_file.
+      */
+      
+      {
+        msg_type * msg;
+        int i , report_step , prev_report_step;
+        char *  target_file_name   = ecl_util_alloc_filename( NULL , ecl_base , target_type , fmt_file , -1);
+        stringlist_type * filelist = stringlist_alloc_argv_copy( (const char **) &argv[arg_offset] , num_files );
+        ecl_kw_type * seqnum_kw    = NULL;
+        fortio_type * target       = NULL;
+        ecl_archive_type * archive = NULL;
+        
+        if (use_archive) {
+          char * archive_file_name = util_alloc_sprintf("%s.%s" , target_file_name , ECL_ARCHIVE_EXT);
+          free( target_file_name );
+          target_file_name = archive_file_name;
+          archive = ecl_archive_alloc_writer( target_file_name , 0 , num_threads );
+        } else
+          target = fortio_open_writer( target_file_name , fmt_file , ECL_ENDIAN_FLIP);
+        
+        if (target_type == ECL_UNIFIED_RESTART_FILE) 
+          seqnum_kw = ecl_kw_alloc( SEQNUM_KW , 1 , ECL_INT_TYPE );
+        
+        {
+          char * msg_format = util_alloc_sprintf("Packing %s <= " , target_file_name);
+          msg = msg_alloc( msg_format , false);
+          free( msg_format );
+        }
+        
+        
+        msg_show( msg );
+        stringlist_sort( filelist , ecl_util_fname_report_cmp);
+        prev_report_step = -1;
+        for (i=0; i < num_files; i++) {
+          ecl_file_enum this_file_type;
+          this_file_type = ecl_util_get_file_type( stringlist_iget(filelist , i)  , NULL , &report_step);
+          if (this_file_type == file_type) {
+            if (report_step == prev_report_step)
+              util_exit("Tried to write same report step twice: %s / %s \n",
+                        stringlist_iget(filelist , i-1) , 
+                        stringlist_iget(filelist , i));
+            
+            prev_report_step = report_step;
+            msg_update(msg , stringlist_iget( filelist , i));
             if (target_type == ECL_UNIFIED_RESTART_FILE) {
               /* Must insert the SEQNUM keyword first. */
               ecl_kw_iset_int(seqnum_kw , 0 , report_step);
-              ecl_kw_fwrite( seqnum_kw , target );
+              if (archive != NULL)
+                ecl_archive_add_kw( archive , seqnum_kw );
+              else
+                ecl_kw_fwrite( seqnum_kw , target );
+            }
+
+            if (archive != NULL) 
+              archive_add_file( archive , stringlist_iget( filelist , i) , fmt_file );
+            else {
+              ecl_file_type * src_file = ecl_file_open( stringlist_iget( filelist , i) , 0 );
+              ecl_file_fwrite_fortio( src_file , target , 0);
+              ecl_file_close( src_file );
             }
-            ecl_file_fwrite_fortio( src_file , target , 0);
-            ecl_file_close( src_file );
-          }
-        }  /* Else skipping file of incorrect type. */
+          }  /* Else skipping file of incorrect type. */
+        }
+        msg_free(msg , false);
+        if (archive != NULL) {
+          ecl_archive_close( archive );
+          archive = ecl_archive_open( target_file_name );
+          archive_report( archive );
+          ecl_archive_close( archive );
+        } else
+          fortio_fclose( target );
+        
+        free(target_file_name);
+        stringlist_free( filelist );
+        if (seqnum_kw != NULL) ecl_kw_free(seqnum_kw);
       }
-      msg_free(msg , false);
-      fortio_fclose( target );
-      free(target_file_name);
-      stringlist_free( filelist );
-      if (seqnum_kw != NULL) ecl_kw_free(seqnum_kw);
+      free(ecl_base);
+      util_safe_free(path);
     }
-    free(ecl_base);
-    util_safe_free(path);
   }
+  exit(0);
 }
-  
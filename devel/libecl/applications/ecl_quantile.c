@@ -19,6 +19,7 @@
 #define  _GNU_SOURCE   /* Must define this to get access to pthread_rwlock_t */
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <ctype.h>
 #include <unistd.h>
 #include <pthread.h>
@@ -26,22 +27,23 @@
 
 #include <ert/util/util.h>
 #include <ert/util/double_vector.h>
+#include <ert/util/int_vector.h>
 #include <ert/util/time_t_vector.h>
 #include <ert/util/statistics.h>
 #include <ert/util/vector.h>
-#include <ert/util/arg_pack.h>
-#include <ert/util/thread_pool.h>
+#include <ert/util/stringlist.h>
 
 #include <ert/config/config.h>
 #include <ert/config/config_content_item.h>
 #include <ert/config/config_content_node.h>
 
 #include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_sum_ensemble.h>
 
 #define DEFAULT_NUM_INTERP  50
 #define SUMMARY_JOIN       ":"
 #define MIN_SIZE            10
-#define LOAD_THREADS         4 
+#define MAX_DATA_SIZE       (64 * 1024 * 1024)   /* Max number of elements in the interpolated data table. */
 
 
 typedef enum {
@@ -51,15 +53,6 @@ typedef enum {
 } format_type;
 
 
-typedef struct {
-  ecl_sum_type             * ecl_sum;
-  double_vector_type       * interp_data;
-  const time_t_vector_type * interp_time;
-  time_t                     start_time;
-  time_t                     end_time;
-} sum_case_type;
-
-
 /**
    Microscopic data structure representing one column of data;
    i.e. one ECLIPSE summary key and one accompanying quantile value. 
@@ -76,18 +69,59 @@ typedef struct  {
   vector_type     * keys;  /* Vector of quant_key_type instances. */
   char            * file;
   format_type       format;
+  double         ** data;  /* The quantile values - indexed as data[time][column]. */
+  int               data_rows;
 } output_type;
 
 
 
+/*
+  The ensemble is processed in two steps, so that only @num_threads
+  summary cases are in memory at any time:
+
+    1. The simulated time span of all the cases, which is needed to
+       set up the interpolation times, is read with
+       ecl_sum_fread_time_span(); i.e. only the SMSPEC header and the
+       last ministep of each case is read. The first valid case is
+       loaded as refcase.
+
+    2. The summary keys requested in the OUTPUT lines are processed in
+       blocks of @block_size keys. For each block the cases are
+       streamed through with ecl_sum_ensemble_fread_apply(), the keys
+       are interpolated to the interpolation times and stored in the
+       @data array, which is indexed as data[key][time][iens], and
+       then the quantiles are calculated and stored in the output
+       instances before the next block is loaded. Elements where the
+       interpolation time is outside the time span of the case are
+       set to NAN.
+
+  The block size is chosen so that the size of @data, block_size *
+  num_interp * num_cases, stays below MAX_DATA_SIZE; for a normal
+  configuration all the keys fit in one block. The refcase is kept
+  loaded, and is not streamed through again.
+*/
+
 typedef struct {
-  vector_type         * data;
+  stringlist_type     * case_list;
+  time_t_vector_type  * case_start;  /* Set to -1 for cases which could not be loaded. */
+  time_t_vector_type  * case_end;
   time_t_vector_type  * interp_time;
   int                   num_interp;
+  int                   num_threads;
+  int                   num_loaded;
   time_t                start_time;
   time_t                end_time;
-  const ecl_sum_type  * refcase;     /* Pointer to an arbitrary ecl_sum instance in the ensemble - to have access to indexing functions. */
-  pthread_rwlock_t      rwlock;
+  ecl_sum_type        * refcase;     /* A private copy of one of the cases in the ensemble - to have access to indexing functions. */
+  int                   ref_index;   /* The index of the refcase in case_list. */
+  stringlist_type     * load_list;   /* The cases which are streamed through in step 2, i.e. all except the refcase. */
+  int_vector_type     * load_index;  /* load_index[i] is the index in case_list of load_list[i]. */
+  stringlist_type     * keys;        /* The distinct summary keys in all the OUTPUT lines. */
+  hash_type           * key_index;
+  int                   key_offset;  /* The first key in the currently loaded block. */
+  int                   block_size;  /* The number of keys in the currently loaded block. */
+  float               * data;
+  bool                  missing_key;
+  pthread_mutex_t       mutex;
 } ensemble_type;
 
 
@@ -119,63 +153,6 @@ static void quant_key_free__( void * qkey ) {
 
 /*****************************************************************/
 
-sum_case_type * sum_case_fread_alloc( const char * data_file , const time_t_vector_type * interp_time ) {
-  sum_case_type * sum_case = util_malloc( sizeof * sum_case );
-
-  sum_case->ecl_sum     = ecl_sum_fread_alloc_case( data_file , SUMMARY_JOIN );
-  sum_case->interp_data = double_vector_alloc(0 , 0);
-  sum_case->interp_time = interp_time; 
-  sum_case->start_time  = ecl_sum_get_start_time( sum_case->ecl_sum );
-  sum_case->end_time    = ecl_sum_get_end_time( sum_case->ecl_sum );
-  return sum_case;
-}
-
-
-void sum_case_free( sum_case_type * sum_case) {
-  ecl_sum_free( sum_case->ecl_sum );
-  double_vector_free( sum_case->interp_data );
-  free( sum_case );
-}
-
-
-void sum_case_free__( void * sum_case) {
-  sum_case_free( (sum_case_type *) sum_case);
-}
-
-
-/*****************************************************************/
-
-
-void ensemble_add_case( ensemble_type * ensemble , const char * data_file ) {
-  sum_case_type * sum_case = sum_case_fread_alloc( data_file , ensemble->interp_time );
-  
-  pthread_rwlock_wrlock( &ensemble->rwlock );
-  {
-    printf("Loading case: %s \n", data_file );
-    vector_append_owned_ref( ensemble->data , sum_case , sum_case_free__ );
-    if (ensemble->start_time > 0)
-      ensemble->start_time = util_time_t_min( ensemble->start_time , sum_case->start_time);
-    else
-      ensemble->start_time = ecl_sum_get_start_time( sum_case->ecl_sum );
-    
-    ensemble->end_time   = util_time_t_max( ensemble->end_time   , sum_case->end_time);
-  }
-  pthread_rwlock_unlock( &ensemble->rwlock );
-
-}
-
-void * ensemble_add_case__( void * arg ) {
-  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
-  ensemble_type * ensemble = arg_pack_iget_ptr( arg , 0 );
-  const char * data_file   = arg_pack_iget_ptr( arg , 1 );
-  ensemble_add_case( ensemble , data_file );
-  arg_pack_free( arg_pack );
-  return NULL;
-}
-
-
-
-
 void ensemble_init_time_interp( ensemble_type * ensemble ) {
   int i;
   for (i = 0; i < ensemble->num_interp; i++)
@@ -186,17 +163,13 @@ void ensemble_init_time_interp( ensemble_type * ensemble ) {
 
 
 
-void ensemble_load_from_glob( ensemble_type * ensemble , const char * pattern , thread_pool_type * tp) {
+void ensemble_load_from_glob( ensemble_type * ensemble , const char * pattern , stringlist_type * case_list) {
   glob_t pglob;
   int    i;
   glob( pattern , GLOB_NOSORT , NULL , &pglob );
 
-  for (i=0; i < pglob.gl_pathc; i++) {
-    arg_pack_type * arg_pack = arg_pack_alloc( );
-    arg_pack_append_ptr( arg_pack , ensemble );
-    arg_pack_append_owned_ptr( arg_pack , util_alloc_string_copy( pglob.gl_pathv[i] ) , free );
-    thread_pool_add_job( tp , ensemble_add_case__ , arg_pack );
-  }
+  for (i=0; i < pglob.gl_pathc; i++) 
+    stringlist_append_copy( case_list , pglob.gl_pathv[i] );
 
   globfree( &pglob );
 }
@@ -206,12 +179,26 @@ void ensemble_load_from_glob( ensemble_type * ensemble , const char * pattern ,
 ensemble_type * ensemble_alloc( ) {
   ensemble_type * ensemble = util_malloc( sizeof * ensemble );
 
-  ensemble->num_interp  = DEFAULT_NUM_INTERP;
-  ensemble->start_time  = -1;
-  ensemble->end_time    = -1;
-  ensemble->data        = vector_alloc_new();
-  ensemble->interp_time = time_t_vector_alloc( 0 , -1 );
-  pthread_rwlock_init( &ensemble->rwlock , NULL );
+  ensemble->num_interp   = DEFAULT_NUM_INTERP;
+  ensemble->num_threads  = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
+  ensemble->num_loaded   = 0;
+  ensemble->start_time   = -1;
+  ensemble->end_time     = -1;
+  ensemble->case_list    = stringlist_alloc_new();
+  ensemble->case_start   = time_t_vector_alloc( 0 , -1 );
+  ensemble->case_end     = time_t_vector_alloc( 0 , -1 );
+  ensemble->interp_time  = time_t_vector_alloc( 0 , -1 );
+  ensemble->refcase      = NULL;
+  ensemble->ref_index    = -1;
+  ensemble->load_list    = stringlist_alloc_new();
+  ensemble->load_index   = int_vector_alloc( 0 , 0 );
+  ensemble->keys         = stringlist_alloc_new();
+  ensemble->key_index    = hash_alloc();
+  ensemble->key_offset   = 0;
+  ensemble->block_size   = 0;
+  ensemble->data         = NULL;
+  ensemble->missing_key  = false;
+  pthread_mutex_init( &ensemble->mutex , NULL );
   return ensemble;
 }
 
@@ -219,42 +206,67 @@ ensemble_type * ensemble_alloc( ) {
 void ensemble_init( ensemble_type * ensemble , config_type * config) {
 
   /*1 : Loading ensembles and settings from the config instance */
-  /*1a: Loading the eclipse summary cases. */
+  /*1a: Collecting the eclipse summary cases. */
   {
-    thread_pool_type * tp = thread_pool_alloc( LOAD_THREADS , true );
-    {
-      int i,j;
-      const config_content_item_type * case_item = config_get_content_item( config , "CASE_LIST" );
-
-      if (case_item != NULL) {
-        for (j=0; j < config_content_node_get_size( case_item ); j++) {
-          const config_content_node_type * case_node = config_content_item_iget_node( case_item );
-          for (i=0; i < config_content_node_get_size( case_node ) i++) {
-            const char * case_glob = config_content_node_iget( case_node , i );
-            ensemble_load_from_glob( ensemble , case_glob , tp);
-          }
+    int i,j;
+    const config_content_item_type * case_item = config_get_content_item( config , "CASE_LIST" );
+
+    if (case_item != NULL) {
+      for (j=0; j < config_content_item_get_size( case_item ); j++) {
+        const config_content_node_type * case_node = config_content_item_iget_node( case_item , j );
+        for (i=0; i < config_content_node_get_size( case_node ); i++) {
+          const char * case_glob = config_content_node_iget( case_node , i );
+          ensemble_load_from_glob( ensemble , case_glob , ensemble->case_list);
         }
       }
-      
     }
-    thread_pool_join( tp );
-    thread_pool_free( tp );
-  }
-    
-  {
-    const sum_case_type * tmp = vector_iget_const( ensemble->data , 0 );
-    ensemble->refcase = tmp->ecl_sum;
   }
   
   /*1b: Other config settings */
   if (config_item_set( config , "NUM_INTERP" ))
     ensemble->num_interp  = config_iget_as_int( config , "NUM_INTERP" , 0 , 0 );
+
+  if (config_item_set( config , "NUM_THREADS" ))
+    ensemble->num_threads = util_int_max( 1 , config_iget_as_int( config , "NUM_THREADS" , 0 , 0 ));
   
+  /*2: Scanning the time span of all the cases. */
+  {
+    int num_cases = stringlist_get_size( ensemble->case_list );
+    int iens;
+
+    for (iens = 0; iens < num_cases; iens++) {
+      const char * case_name = stringlist_iget( ensemble->case_list , iens );
+      time_t case_start;
+      time_t case_end;
+      
+      if (ecl_sum_fread_time_span( case_name , SUMMARY_JOIN , &case_start , &case_end )) {
+        printf("Loading case: %s \n", case_name );
+        if (ensemble->refcase == NULL) {
+          ensemble->refcase   = ecl_sum_fread_alloc_case( case_name , SUMMARY_JOIN );
+          ensemble->ref_index = iens;
+        } else {
+          stringlist_append_ref( ensemble->load_list , case_name );
+          int_vector_append( ensemble->load_index , iens );
+        }
+
+        if (ensemble->start_time > 0)
+          ensemble->start_time = util_time_t_min( ensemble->start_time , case_start );
+        else
+          ensemble->start_time = case_start;
+        ensemble->end_time = util_time_t_max( ensemble->end_time , case_end );
+        ensemble->num_loaded++;
+      } else
+        case_start = case_end = -1;
+
+      time_t_vector_iset( ensemble->case_start , iens , case_start );
+      time_t_vector_iset( ensemble->case_end   , iens , case_end );
+    }
+  }
   
-  /*2: Remaining initialization */
-  ensemble_init_time_interp( ensemble );
-  if (vector_get_size( ensemble->data ) < MIN_SIZE )
+  /*3: Remaining initialization */
+  if (ensemble->num_loaded < MIN_SIZE )
     util_exit("Sorry - quantiles make no sense with with < %d realizations; should have ~> 100.\n" , MIN_SIZE);
+  ensemble_init_time_interp( ensemble );
 }
 
 const ecl_sum_type * ensemble_get_refcase( const ensemble_type * ensemble ) {
@@ -262,9 +274,75 @@ const ecl_sum_type * ensemble_get_refcase( const ensemble_type * ensemble ) {
 }
 
 
+/*
+  The @key_nr is the index in the ensemble->keys list, and must be in
+  the currently loaded block.
+*/
+
+static float * ensemble_get_data( const ensemble_type * ensemble , int key_nr , int time_index) {
+  int num_cases = stringlist_get_size( ensemble->case_list );
+  return &ensemble->data[ ((key_nr - ensemble->key_offset) * ensemble->num_interp + time_index) * num_cases ];
+}
+
+
+static void ensemble_load_case_data__( ensemble_type * ensemble , const ecl_sum_type * ecl_sum , int index ) {
+  int num_cases = stringlist_get_size( ensemble->case_list );
+  int key_nr;
+
+  for (key_nr = ensemble->key_offset; key_nr < ensemble->key_offset + ensemble->block_size; key_nr++) {
+    const char * sum_key = stringlist_iget( ensemble->keys , key_nr );
+    
+    if (ecl_sum_has_general_var( ecl_sum , sum_key )) {
+      float * data = ensemble_get_data( ensemble , key_nr , 0 );
+      time_t case_start = ecl_sum_get_start_time( ecl_sum );
+      time_t case_end   = ecl_sum_get_end_time( ecl_sum );
+      int time_index;
+
+      for (time_index = 0; time_index < ensemble->num_interp; time_index++) {
+        time_t interp_time = time_t_vector_iget( ensemble->interp_time , time_index );
+        
+        /* We allow the different simulations to have differing length */
+        if ((interp_time >= case_start) && (interp_time <= case_end))
+          data[ time_index * num_cases + index ] = ecl_sum_get_general_var_from_sim_time( ecl_sum , interp_time , sum_key );
+      }
+    } else {
+      pthread_mutex_lock( &ensemble->mutex );
+      {
+        ensemble->missing_key = true;
+        fprintf(stderr,"** Sorry: the case:%s does not have the summary key:%s \n", ecl_sum_get_case( ecl_sum ), sum_key);
+      }
+      pthread_mutex_unlock( &ensemble->mutex );
+    }
+  }
+}
+
+
+/*
+  Callback for ecl_sum_ensemble_fread_apply() on the load_list; the
+  @index is mapped back to the index in the full case list.
+*/
+
+static void ensemble_load_case_data( const ecl_sum_type * ecl_sum , int index , void * arg ) {
+  ensemble_type * ensemble = arg;
+  if (ecl_sum != NULL)
+    ensemble_load_case_data__( ensemble , ecl_sum , int_vector_iget( ensemble->load_index , index ));
+}
+
+
+
 void ensemble_free( ensemble_type * ensemble ) {
-  vector_free( ensemble->data );
+  if (ensemble->refcase != NULL)
+    ecl_sum_free( ensemble->refcase );
+  stringlist_free( ensemble->load_list );
+  int_vector_free( ensemble->load_index );
+  stringlist_free( ensemble->case_list );
+  time_t_vector_free( ensemble->case_start );
+  time_t_vector_free( ensemble->case_end );
   time_t_vector_free( ensemble->interp_time );
+  stringlist_free( ensemble->keys );
+  hash_free( ensemble->key_index );
+  util_safe_free( ensemble->data );
+  pthread_mutex_destroy( &ensemble->mutex );
   free( ensemble );
 }
 
@@ -274,6 +352,8 @@ static output_type * output_alloc( const char * file , const char * format_strin
   output_type * output = util_malloc( sizeof * output );
   output->keys = vector_alloc_new();
   output->file = util_alloc_string_copy( file );
+  output->data = NULL;
+  output->data_rows = 0;
   {
     format_type  format;
 
@@ -296,6 +376,12 @@ static output_type * output_alloc( const char * file , const char * format_strin
 
 
 static void output_free( output_type * output ) {
+  if (output->data != NULL) {
+    int row_nr;
+    for (row_nr = 0; row_nr < output->data_rows; row_nr++)
+      free( output->data[row_nr] );
+    free( output->data );
+  }
   vector_free( output->keys );
   free( output->file );
   free( output );
@@ -605,99 +691,125 @@ void output_save( const output_type * output , ensemble_type * ensemble , const
 
 
 
-void output_run_line( const output_type * output , ensemble_type * ensemble) {
-  
+/**
+   Will calculate the quantiles for all the columns in @output with a
+   summary key in the block currently loaded in the ensemble.
+*/
+
+static void output_update_data( output_type * output , const ensemble_type * ensemble , double_vector_type * interp_data) {
   const int    data_columns = vector_get_size( output->keys );
-  const int    data_rows    = time_t_vector_size( ensemble->interp_time );
-  double     ** data;
+  const int    num_cases    = stringlist_get_size( ensemble->case_list );
   int row_nr, column_nr;
 
-  data = util_calloc( data_rows , sizeof * data );
-  /*
-    time-direction, i.e. the row index is the first index and the
-    column number (i.e. the different keys) is the second index. 
-  */
-  for (row_nr=0; row_nr < data_rows; row_nr++)
-    data[row_nr] = util_calloc( data_columns , sizeof * data[row_nr] );
-  
-  printf("Creating output file: %s \n",output->file );
+  if (output->data == NULL) {
+    /*
+      time-direction, i.e. the row index is the first index and the
+      column number (i.e. the different keys) is the second index. 
+    */
+    output->data_rows = time_t_vector_size( ensemble->interp_time );
+    output->data = util_calloc( output->data_rows , sizeof * output->data );
+    for (row_nr=0; row_nr < output->data_rows; row_nr++)
+      output->data[row_nr] = util_calloc( data_columns , sizeof * output->data[row_nr] );
+  }
 
-  
   /* 
-     Go through all the cases and check that they have this key;
-     exit if missing. Could also ignore the missing keys and just
-     continue; and even defer the checking to the inner loop.
+     The quantiles are found with selection, which reorders the
+     interp_data vector - it is therefore refilled for every key.
   */
-  for (column_nr = 0; column_nr < vector_get_size( output->keys ); column_nr++) {
+  for (column_nr = 0; column_nr < data_columns; column_nr++) {
     const quant_key_type * qkey = vector_iget( output->keys , column_nr );
-    {
-      bool OK = true;
-      
-      for (int iens = 0; iens < vector_get_size( ensemble->data ); iens++) {
-        const sum_case_type * sum_case = vector_iget_const( ensemble->data , iens );
-        
-        if (!ecl_sum_has_general_var(sum_case->ecl_sum , qkey->sum_key)) {
-          OK = false;
-          fprintf(stderr,"** Sorry: the case:%s does not have the summary key:%s \n", ecl_sum_get_case( sum_case->ecl_sum ), qkey->sum_key);
-        }
-      }
+    int key_nr = hash_get_int( ensemble->key_index , qkey->sum_key );
 
-      if (!OK) 
-        util_exit("Exiting due to missing summary vector(s).\n");
+    if ((key_nr < ensemble->key_offset) || (key_nr >= ensemble->key_offset + ensemble->block_size))
+      continue;
+
+    for (row_nr = 0; row_nr < output->data_rows; row_nr++) {
+      const float * case_data = ensemble_get_data( ensemble , key_nr , row_nr );
+      int iens;
+
+      double_vector_reset( interp_data );
+      for (iens = 0; iens < num_cases; iens++) {
+        if (!isnan( case_data[iens] ))
+          double_vector_append( interp_data , case_data[iens] );
+      }
+      
+      if (double_vector_size( interp_data ) > 0)
+        output->data[row_nr][column_nr] = statistics_empirical_quantile_select( interp_data , qkey->quantile );
+      else
+        output->data[row_nr][column_nr] = NAN;
     }
   }
-  
-  
-  /* The main loop - outer loop is running over time. */
-  {
-    /**
-       In the quite typical case that we are asking for several
-       quantiles of the quantity, i.e.
+}
 
-       WWCT:OP_1:0.10  WWCT:OP_1:0.50  WWCT:OP_1:0.90 
 
-       the interp_data_cache construction will ensure that the
-       underlying ecl_sum object is only queried once; and also the
-       sorting will be performed once.
-    */
-    
-    hash_type * interp_data_cache = hash_alloc();
+/**
+   Will go through all the cases in the ensemble and interpolate the
+   data for all the keys in all the output lines to the common
+   interpolation times, and calculate the quantiles; the program will
+   exit if one or more of the cases are missing one of the keys. Could
+   also ignore the missing keys and just continue.
 
-    for (row_nr = 0; row_nr < data_rows; row_nr++) {
-      time_t interp_time = time_t_vector_iget( ensemble->interp_time , row_nr);
-      for (column_nr = 0; column_nr < vector_get_size( output->keys ); column_nr++) {
-        const quant_key_type * qkey = vector_iget( output->keys , column_nr );
-        double_vector_type * interp_data;
+   In the quite typical case that we are asking for several quantiles
+   of the same quantity, i.e.
 
-        /* Check if we have the vector in the cache table - if not create it. */
-        if (!hash_has_key( interp_data_cache , qkey->sum_key)) {
-          interp_data = double_vector_alloc(0 , 0);
-          hash_insert_hash_owned_ref( interp_data_cache , qkey->sum_key , interp_data , double_vector_free__);
-        }
-        interp_data = hash_get( interp_data_cache , qkey->sum_key );
-
-        /* Check if the vector has data - if not initialize it. */
-        if (double_vector_size( interp_data ) == 0) {
-          for (int iens = 0; iens < vector_get_size( ensemble->data ); iens++) {
-            const sum_case_type * sum_case = vector_iget_const( ensemble->data , iens );
-            
-            if ((interp_time >= sum_case->start_time) && (interp_time <= sum_case->end_time))  /* We allow the different simulations to have differing length */
-              double_vector_append( interp_data , ecl_sum_get_general_var_from_sim_time( sum_case->ecl_sum , interp_time , qkey->sum_key)) ;
-            
-            double_vector_sort( interp_data );
-          }
+       WWCT:OP_1:0.10  WWCT:OP_1:0.50  WWCT:OP_1:0.90
+
+   the key is only loaded once. If the keys do not fit in one block
+   the cases are streamed through once for each block.
+*/
+
+void ensemble_load_data( ensemble_type * ensemble , hash_type * output_table ) {
+  const int num_cases = stringlist_get_size( ensemble->case_list );
+  int num_keys;
+  int max_block_size;
+  {
+    hash_iter_type * iter = hash_iter_alloc( output_table );
+    while (!hash_iter_is_complete( iter )) {
+      const output_type * output = hash_iter_get_next_value( iter );
+      int column_nr;
+      for (column_nr = 0; column_nr < vector_get_size( output->keys ); column_nr++) {
+        const quant_key_type * qkey = vector_iget_const( output->keys , column_nr );
+        if (!hash_has_key( ensemble->key_index , qkey->sum_key )) {
+          hash_insert_int( ensemble->key_index , qkey->sum_key , stringlist_get_size( ensemble->keys ));
+          stringlist_append_copy( ensemble->keys , qkey->sum_key );
         }
-        data[row_nr][column_nr] = statistics_empirical_quantile__( interp_data , qkey->quantile );
       }
-      hash_apply( interp_data_cache , double_vector_reset__ );
     }
-    hash_free( interp_data_cache );
+    hash_iter_free( iter );
   }
-  
-  output_save( output , ensemble , (const double **) data);
-  for (row_nr=0; row_nr < data_rows; row_nr++)
-    free( data[row_nr] );
-  free( data );
+
+  num_keys = stringlist_get_size( ensemble->keys );
+  max_block_size = util_int_max( 1 , MAX_DATA_SIZE / (ensemble->num_interp * num_cases));
+  max_block_size = util_int_min( max_block_size , util_int_max( 1 , num_keys ));
+  ensemble->data = util_calloc( (size_t) max_block_size * ensemble->num_interp * num_cases , sizeof * ensemble->data );
+  {
+    double_vector_type * interp_data = double_vector_alloc( 0 , 0 );
+
+    for (ensemble->key_offset = 0; ensemble->key_offset < num_keys; ensemble->key_offset += max_block_size) {
+      ensemble->block_size = util_int_min( max_block_size , num_keys - ensemble->key_offset );
+      {
+        size_t data_size = (size_t) ensemble->block_size * ensemble->num_interp * num_cases;
+        size_t i;
+        for (i = 0; i < data_size; i++)
+          ensemble->data[i] = NAN;
+      }
+
+      ensemble_load_case_data__( ensemble , ensemble->refcase , ensemble->ref_index );
+      ecl_sum_ensemble_fread_apply( ensemble->load_list , SUMMARY_JOIN , ensemble->num_threads , ensemble_load_case_data , ensemble );
+      if (ensemble->missing_key)
+        util_exit("Exiting due to missing summary vector(s).\n");
+
+      {
+        hash_iter_type * iter = hash_iter_alloc( output_table );
+        while (!hash_iter_is_complete( iter )) 
+          output_update_data( hash_iter_get_next_value( iter ) , ensemble , interp_data );
+        hash_iter_free( iter );
+      }
+    }
+    double_vector_free( interp_data );
+  }
+  free( ensemble->data );
+  ensemble->data = NULL;
 }
 
 
@@ -708,8 +820,12 @@ void output_table_run( hash_type * output_table , ensemble_type * ensemble ) {
   while (!hash_iter_is_complete( iter )) {
     const char * output_file     = hash_iter_get_next_key( iter );
     const output_type * output   = hash_get( output_table , output_file );
-    output_run_line( output, ensemble );
+
+    printf("Creating output file: %s \n",output->file );
+    if (output->data != NULL)
+      output_save( output , ensemble , (const double **) output->data);
   }
+  hash_iter_free( iter );
 }
 
 
@@ -722,6 +838,7 @@ void config_init( config_type * config ) {
 
   config_add_schema_item( config , "CASE_LIST"      , true , true );
   config_add_key_value( config , "NUM_INTERP" , false , CONFIG_INT);
+  config_add_key_value( config , "NUM_THREADS" , false , CONFIG_INT);
   
   {
     config_schema_item_type * item;
@@ -745,7 +862,7 @@ void usage() {
   printf("files, it can then output quantiles of summary vectors over the time\n");
   printf("span of the simulation. The program is based on a simple configuration\n");
   printf("file which must be given as a commandline argument. The configuration\n");
-  printf("file only has three keywords:\n");
+  printf("file only has four keywords:\n");
   printf("\n");
   printf("\n");
   printf("   CASE_LIST   simulation*X/run*X/CASE*.DATA\n");
@@ -753,6 +870,7 @@ void usage() {
   printf("   OUTPUT      FILE1   S3GRAPH WWCT:OP_1:0.10  WWCT:OP_1:0.50   WOPR:OP_3\n");
   printf("   OUTPUT      FILE2   PLAIN   FOPT:0.10  FOPT:0.90  FGPT:0.10  FGPT:0.90   FWPT:0.10  FWPT:0.90\n");
   printf("   NUM_INTERP  100\n");
+  printf("   NUM_THREADS 8\n");
   printf("\n");
   printf("\n");
   printf("CASE_LIST: This keyword is used to give the path to ECLIPSE data files\n");
@@ -808,6 +926,12 @@ void usage() {
   printf("  between ECLIPSE report steps, the might therefore look a bit jagged\n");
   printf("  if NUM_INTERP is set too high. This keyword is optional.\n");
   printf("\n");
+  printf("\n");
+  printf("NUM_THREADS: The summary cases are loaded in parallel by NUM_THREADS\n");
+  printf("  threads, and only NUM_THREADS cases are kept in memory at the same\n");
+  printf("  time. The default is the number of processors on the computer.\n");
+  printf("  This keyword is optional.\n");
+  printf("\n");
   printf("All filenames in the configuration file will be interpreted relative to\n");
   printf("the location of the configuration file, i.e. irrespective of the current\n");
   printf("working directory when invoking the ecl_quantile program.\n\n");
@@ -847,6 +971,7 @@ int main( int argc , char ** argv ) {
       config_free( config );
 
     } 
+    ensemble_load_data( ensemble , output_table );
     output_table_run( output_table , ensemble );
     ensemble_free( ensemble );
     hash_free( output_table );
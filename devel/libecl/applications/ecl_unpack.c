@@ -17,19 +17,53 @@
 */
 
 #include <stdbool.h>
-#include <util.h>
-#include <ecl_file.h>
-#include <ecl_util.h>
-#include <ecl_kw.h>
-#include <msg.h>
-#include <ecl_endian_flip.h>
-#include <ecl_kw_magic.h>
+#include <stdlib.h>
+
+#include <ert/util/util.h>
+#include <ert/util/msg.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_archive.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/ecl_kw_magic.h>
+
+
+/*
+  An archive created with 'ecl_pack -z' is opened transparently by
+  ecl_file; the type of the packed file is determined from the
+  filename with the archive extension removed.
+*/
+
+static char * alloc_unpacked_name( const char * filename ) {
+  char * unpacked_name = NULL;
+  if (ecl_archive_is_archive( filename )) {
+    char * path;
+    char * base;
+    char * extension;
+    
+    util_alloc_file_components( filename , &path , &base , &extension );
+    if (util_string_equal( extension , ECL_ARCHIVE_EXT ))
+      unpacked_name = util_alloc_filename( path , base , NULL );
+    
+    util_safe_free( path );
+    util_safe_free( base );
+    util_safe_free( extension );
+  } 
+
+  if (unpacked_name == NULL)
+    unpacked_name = util_alloc_string_copy( filename );
+  return unpacked_name;
+}
+
 
 void unpack_file(const char * filename) {
   ecl_file_enum target_type = ECL_OTHER_FILE;
   ecl_file_enum file_type;
   bool fmt_file;
-  file_type = ecl_util_get_file_type(filename , &fmt_file , NULL);
+  char * unpacked_name = alloc_unpacked_name( filename );
+  file_type = ecl_util_get_file_type(unpacked_name , &fmt_file , NULL);
   if (file_type == ECL_UNIFIED_SUMMARY_FILE)
     target_type = ECL_SUMMARY_FILE;
   else if (file_type == ECL_UNIFIED_RESTART_FILE)
@@ -41,7 +75,7 @@ void unpack_file(const char * filename) {
     printf("** Warning: when unpacking unified summary files it as ambigous - starting with 0001  -> \n");
   }
   {
-    ecl_file_type * src_file = ecl_file_open( filename );
+    ecl_file_type * src_file = ecl_file_open( filename , 0 );
     int    size;
     int    offset;
     int    report_step = 0;
@@ -49,7 +83,7 @@ void unpack_file(const char * filename) {
     char * path; 
     char * base;
     msg_type * msg;
-    util_alloc_file_components( filename , &path , &base , NULL);
+    util_alloc_file_components( unpacked_name , &path , &base , NULL);
     {
       char * label  = util_alloc_sprintf("Unpacking %s => ", filename);
       msg = msg_alloc( label , false);
@@ -102,6 +136,7 @@ void unpack_file(const char * filename) {
     free(base);
     msg_free(msg , true);
   }
+  free( unpacked_name );
 }
 
 
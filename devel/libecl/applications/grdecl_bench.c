@@ -0,0 +1,114 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'grdecl_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/time.h>
+
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_grdecl.h>
+#include <ert/ecl/ecl_grdecl_file.h>
+
+/*
+  Small benchmark of GRDECL loading; compares the stream based
+  ecl_kw_fscanf_alloc_grdecl_dynamic() with ecl_grdecl_file and checks
+  that the two give identical keywords. If no file is given a file
+  with a PORO keyword of @size elements is generated.
+
+    grdecl_bench.x  [GRDECL_FILE KW]  [size]
+*/
+
+
+static double wall_time( void ) {
+  struct timeval tv;
+  gettimeofday( &tv , NULL );
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+
+static void report( const char * name , int size , double seconds) {
+  printf("%-24s  %10.3f ms   %8.2f Mvalues/s\n", name , 1000 * seconds , 1e-6 * size / seconds);
+}
+
+
+static void create_file( const char * filename , int size ) {
+  FILE * stream = util_fopen( filename , "w" );
+  int i;
+
+  srand( 1 );
+  fprintf(stream , "PORO\n");
+  for (i = 0; i < size; i++) {
+    fprintf(stream , " %.6f" , 0.000001 * (rand() % 400000));
+    if ((i % 8) == 7)
+      fprintf(stream , "\n");
+  }
+  fprintf(stream , "\n/\n");
+  fclose( stream );
+}
+
+
+static void bench_load( const char * filename , const char * kw ) {
+  ecl_kw_type * kw1;
+  ecl_kw_type * kw2;
+  double t0;
+
+  t0 = wall_time();
+  {
+    FILE * stream = util_fopen( filename , "r" );
+    kw1 = ecl_kw_fscanf_alloc_grdecl_dynamic( stream , kw , ECL_FLOAT_TYPE );
+    fclose( stream );
+  }
+  if (kw1 == NULL)
+    util_exit("Could not find keyword:%s in file:%s \n", kw , filename );
+  report( "stream" , ecl_kw_get_size( kw1 ) , wall_time() - t0 );
+
+  t0 = wall_time();
+  {
+    ecl_grdecl_file_type * grdecl_file = ecl_grdecl_file_open( filename );
+    kw2 = ecl_grdecl_file_alloc_kw( grdecl_file , kw , 0 , ECL_FLOAT_TYPE );
+    ecl_grdecl_file_close( grdecl_file );
+  }
+  report( "ecl_grdecl_file" , ecl_kw_get_size( kw2 ) , wall_time() - t0 );
+
+  if (!ecl_kw_equal( kw1 , kw2 ))
+    util_abort("%s: the two loaders give different results for:%s \n",__func__ , kw);
+
+  ecl_kw_free( kw1 );
+  ecl_kw_free( kw2 );
+}
+
+
+
+int main(int argc , char ** argv) {
+  if (argc > 2 && util_file_exists( argv[1] ))
+    bench_load( argv[1] , argv[2] );
+  else {
+    const char * filename = "grdecl_bench.grdecl";
+    int size = 10000000;
+
+    if (argc > 1)
+      util_sscanf_int( argv[1] , &size );
+
+    create_file( filename , size );
+    bench_load( filename , "PORO" );
+    util_unlink_existing( filename );
+  }
+  exit(0);
+}
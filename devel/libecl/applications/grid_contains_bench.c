@@ -0,0 +1,131 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'grid_contains_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/time.h>
+
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+/*
+  Small benchmark of the point in cell tests; compares calling
+  ecl_grid_cell_contains_xyz1() point by point with the batched
+  ecl_grid_cell_contains_xyz_list1() and checks that the two give
+  identical answers. The numbers are reported as million point/cell
+  tests per second, using wall clock time.
+
+    grid_contains_bench.x  [GRID_FILE]  [num_points]
+*/
+
+
+static double wall_time( void ) {
+  struct timeval tv;
+  gettimeofday( &tv , NULL );
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+
+static void report( const char * name , long tests , double seconds) {
+  printf("%-24s  %10.3f ms   %8.2f Mtest/s\n", name , 1000 * seconds , 1e-6 * tests / seconds);
+}
+
+
+/*
+  Random points in the bounding box of the cell, extended by 25% in
+  all directions so that a fair fraction of the points are outside.
+*/
+
+static void init_points( const ecl_grid_type * grid , int global_index , int num_points , double * x , double * y , double * z) {
+  double x0,y0,z0;
+  double x1,y1,z1;
+  int ip;
+
+  ecl_grid_get_corner_xyz1( grid , global_index , 0 , &x0 , &y0 , &z0 );
+  ecl_grid_get_corner_xyz1( grid , global_index , 7 , &x1 , &y1 , &z1 );
+  for (ip = 0; ip < num_points; ip++) {
+    x[ip] = x0 + (1.5 * rand() / RAND_MAX - 0.25) * (x1 - x0);
+    y[ip] = y0 + (1.5 * rand() / RAND_MAX - 0.25) * (y1 - y0);
+    z[ip] = z0 + (1.5 * rand() / RAND_MAX - 0.25) * (z1 - z0);
+  }
+}
+
+
+static void bench_contains( const ecl_grid_type * grid , int num_points ) {
+  const int global_size = ecl_grid_get_global_size( grid );
+  const int delta = util_int_max( 1 , global_size / 1000 );
+  double * x = util_calloc( num_points , sizeof * x );
+  double * y = util_calloc( num_points , sizeof * y );
+  double * z = util_calloc( num_points , sizeof * z );
+  bool * contains = util_calloc( num_points , sizeof * contains );
+  double scalar_time = 0;
+  double batch_time = 0;
+  long tests = 0;
+  int inside = 0;
+  int global_index;
+
+  srand( 1 );
+  for (global_index = 0; global_index < global_size; global_index += delta) {
+    double t0;
+    int ip;
+
+    init_points( grid , global_index , num_points , x , y , z );
+
+    t0 = wall_time();
+    ecl_grid_cell_contains_xyz_list1( grid , global_index , num_points , x , y , z , contains );
+    batch_time += wall_time() - t0;
+
+    t0 = wall_time();
+    for (ip = 0; ip < num_points; ip++) {
+      if (ecl_grid_cell_contains_xyz1( grid , global_index , x[ip] , y[ip] , z[ip] ) != contains[ip])
+        util_abort("%s: batched and scalar results differ for cell:%d \n",__func__ , global_index);
+      inside += contains[ip];
+    }
+    scalar_time += wall_time() - t0;
+    tests += num_points;
+  }
+
+  printf("cells:%d  points/cell:%d  inside:%d\n", global_size / delta , num_points , inside);
+  report( "scalar" , tests , scalar_time );
+  report( "batched" , tests , batch_time );
+
+  free( contains );
+  free( x );
+  free( y );
+  free( z );
+}
+
+
+
+int main(int argc , char ** argv) {
+  ecl_grid_type * grid;
+  int num_points = 1000;
+
+  if (argc > 1 && util_file_exists( argv[1] ))
+    grid = ecl_grid_alloc( argv[1] );
+  else
+    grid = ecl_grid_alloc_rectangular( 50 , 50 , 20 , 10 , 10 , 2 , NULL );
+
+  if (argc > 2)
+    util_sscanf_int( argv[2] , &num_points );
+
+  bench_contains( grid , num_points );
+  ecl_grid_free( grid );
+  exit(0);
+}
@@ -16,18 +16,19 @@
    for more details. 
 */
 
-#include <util.h>
-#include <hash.h>
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
-#include <ecl_file.h>
-#include <ecl_util.h>
-#include <vector.h>
-#include <ecl_grid.h>
 #include <math.h>
-#include <thread_pool.h>
-#include <arg_pack.h>
+
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/vector.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_grav.h>
 
 #define WATER 1
 #define GAS   2
@@ -59,12 +60,6 @@ typedef struct {
 
 
 
-static void truncate_saturation(float * value) {
-  util_apply_float_limits( value , 0.0 , 1.0);
-}
-
-
-
 static bool has_phase( int phase_sum , int phase) {
   if ((phase_sum & phase) == 0)
     return false;
@@ -73,16 +68,6 @@ static bool has_phase( int phase_sum , int phase) {
 } 
 
 
-static const float * safe_get_float_ptr( const ecl_kw_type * ecl_kw , const float * alternative) {
-  if (ecl_kw != NULL)
-    return ecl_kw_get_float_ptr(ecl_kw);
-  else
-    return alternative;
-}
-
-
-
-
 /*****************************************************************/
 
 void print_usage(int line) {
@@ -349,8 +334,8 @@ ecl_file_type ** load_restart_info(const char ** input,           /* Input taken
     if (input_length >= 2) {
       file_type = ecl_util_get_file_type( input[1] , fmt_file , &report_nr );
       if (file_type == ECL_RESTART_FILE) {
-        restart_files[0] = ecl_file_open( input[0] );
-        restart_files[1] = ecl_file_open( input[1] );
+        restart_files[0] = ecl_file_open( input[0] , 0 );
+        restart_files[1] = ecl_file_open( input[1] , 0 );
         *arg_offset = 2;
       } else print_usage(__LINE__);
     } else print_usage(__LINE__);
@@ -359,8 +344,8 @@ ecl_file_type ** load_restart_info(const char ** input,           /* Input taken
     if (input_length >= 3) {
       int report1 , report2;
       if ((util_sscanf_int( input[1] , &report1) && util_sscanf_int( input[2] , &report2))) {
-        restart_files[0] = ecl_file_open( input[0] );
-        restart_files[1] = ecl_file_open( input[0] );
+        restart_files[0] = ecl_file_open( input[0] , 0 );
+        restart_files[1] = ecl_file_open( input[0] , 0 );
         
         ecl_file_select_rstblock_report_step( restart_files[0] , report1 );
         ecl_file_select_rstblock_report_step( restart_files[1] , report2 );
@@ -421,8 +406,8 @@ ecl_file_type ** load_restart_info(const char ** input,           /* Input taken
         }
 
         if ((storage_mode == ECL_BINARY_UNIFIED) || (storage_mode == ECL_FORMATTED_UNIFIED)) {
-          restart_files[0] = ecl_file_open( input[0] );
-          restart_files[1] = ecl_file_open( input[0] );
+          restart_files[0] = ecl_file_open( input[0] , 0 );
+          restart_files[1] = ecl_file_open( input[0] , 0 );
           
           if (!ecl_file_select_rstblock_report_step( restart_files[0] , report1 ))
             util_exit("Failed to load report:%d from %s \n",report1 , unified_file );
@@ -430,8 +415,8 @@ ecl_file_type ** load_restart_info(const char ** input,           /* Input taken
           if (!ecl_file_select_rstblock_report_step( restart_files[1] , report2 )) 
             util_exit("Failed to load report:%d from %s \n",report2 , unified_file );
         } else {
-          restart_files[0] = ecl_file_open( file1 );
-          restart_files[1] = ecl_file_open( file2 );
+          restart_files[0] = ecl_file_open( file1 , 0 );
+          restart_files[1] = ecl_file_open( file2 , 0 );
         }
         
         *use_eclbase = true;
@@ -453,250 +438,6 @@ ecl_file_type ** load_restart_info(const char ** input,           /* Input taken
 
 
 
-/*
-  This function calculates the gravimetric response for the
-  gravitation station given as input parameter grav_station.
-  
-  For code cleanliness the code is written in a way where this
-  function is called for every position we are interested in,
-  performance-wise it would be smarter to loop over the interesting
-  locations as the inner loop.
-  
-  This function does NOT check whether the restart_file / init_file
-  contains the necessary keywords - and will fail HARD if a required
-  keyword is not present. That the the input is well-formed should be
-  checked PRIOR to calling this function.
-*/
-
-static double gravity_response(const ecl_grid_type * ecl_grid      , 
-                               const ecl_file_type * init_file     , 
-                               const ecl_file_type * restart_file1 , 
-                               const ecl_file_type * restart_file2 ,
-                               const grav_station_type * grav_station , 
-                               int model_phases, 
-                               int file_phases) {
-  
-  ecl_kw_type * rporv1_kw   = NULL;  
-  ecl_kw_type * rporv2_kw   = NULL;
-  ecl_kw_type * oil_den1_kw = NULL;  
-  ecl_kw_type * oil_den2_kw = NULL;
-  ecl_kw_type * gas_den1_kw = NULL;
-  ecl_kw_type * gas_den2_kw = NULL;
-  ecl_kw_type * wat_den1_kw = NULL;
-  ecl_kw_type * wat_den2_kw = NULL;
-  ecl_kw_type * sgas1_kw    = NULL;
-  ecl_kw_type * sgas2_kw    = NULL;
-  ecl_kw_type * swat1_kw    = NULL;
-  ecl_kw_type * swat2_kw    = NULL;
-  ecl_kw_type * aquifern_kw = NULL ;
-  double local_deltag = 0;
-
-  /* Extracting the pore volumes */
-  rporv1_kw = ecl_file_iget_named_kw( restart_file1 , "RPORV" , 0);      
-  rporv2_kw = ecl_file_iget_named_kw( restart_file2 , "RPORV" , 0);      
-  
-  
-  /** Extracting the densities */
-  {
-    // OIL_DEN
-    if( has_phase(model_phases , OIL) ) {
-      if (simulator == ECLIPSE100) {
-        oil_den1_kw  = ecl_file_iget_named_kw(restart_file1, "OIL_DEN", 0);
-        oil_den2_kw  = ecl_file_iget_named_kw(restart_file2, "OIL_DEN", 0);
-      } else { // ECLIPSE300
-        oil_den1_kw  = ecl_file_iget_named_kw(restart_file1, "DENO", 0);
-        oil_den2_kw  = ecl_file_iget_named_kw(restart_file2, "DENO", 0);
-      } ;
-    }
-    
-    // GAS_DEN
-    if( has_phase( model_phases , GAS) ) {
-      if (simulator == ECLIPSE100) {
-        gas_den1_kw  = ecl_file_iget_named_kw(restart_file1, "GAS_DEN", 0);
-        gas_den2_kw  = ecl_file_iget_named_kw(restart_file2, "GAS_DEN", 0);
-      } else { // ECLIPSE300
-        gas_den1_kw  = ecl_file_iget_named_kw(restart_file1, "DENG", 0);
-        gas_den2_kw  = ecl_file_iget_named_kw(restart_file2, "DENG", 0);
-      } ;
-    }
-    
-    // WAT_DEN
-    if( has_phase( model_phases , WATER) ) {
-      if (simulator == ECLIPSE100) {
-        wat_den1_kw  = ecl_file_iget_named_kw(restart_file1, "WAT_DEN", 0);
-        wat_den2_kw  = ecl_file_iget_named_kw(restart_file2, "WAT_DEN", 0);
-      } else { // ECLIPSE300
-        wat_den1_kw  = ecl_file_iget_named_kw(restart_file1, "DENW", 0);
-        wat_den2_kw  = ecl_file_iget_named_kw(restart_file2, "DENW", 0);
-      } ;
-    }
-  }
-  
-  
-  /* Extracting the saturations */
-  {
-    // SGAS
-    if( has_phase( file_phases , GAS )) {
-      sgas1_kw     = ecl_file_iget_named_kw(restart_file1, "SGAS", 0);
-      sgas2_kw     = ecl_file_iget_named_kw(restart_file2, "SGAS", 0);
-    } 
-    
-    // SWAT
-    if( has_phase( file_phases , WATER )) {
-      swat1_kw     = ecl_file_iget_named_kw(restart_file1, "SWAT", 0);
-      swat2_kw     = ecl_file_iget_named_kw(restart_file2, "SWAT", 0);
-    } 
-  }
-  
-  
-  /* The numerical aquifer information */
-  if( ecl_file_has_kw( init_file , "AQUIFERN")) 
-    aquifern_kw     = ecl_file_iget_named_kw(init_file, "AQUIFERN", 0);
-  {
-    int     nactive  = ecl_grid_get_active_size( ecl_grid );
-    float * zero     = util_calloc( nactive , sizeof * zero     );    /* Fake vector of zeros used for densities / sturations when you do not have data. */
-    int   * int_zero = util_calloc( nactive , sizeof * int_zero );    /* Fake vector of zeros used for AQUIFER when the init file does not supply data. */
-    /* 
-       Observe that the fake vectors are only a coding simplification,
-       they should not be really used.
-    */
-
-    {
-      int i;
-      for (i=0; i < nactive; i++) {
-        zero[i]     = 0;
-        int_zero[i] = 0;
-      }
-    }
-    {
-      const float * sgas1_v   = safe_get_float_ptr( sgas1_kw    , NULL );
-      const float * swat1_v   = safe_get_float_ptr( swat1_kw    , NULL );
-      const float * oil_den1  = safe_get_float_ptr( oil_den1_kw , zero );
-      const float * gas_den1  = safe_get_float_ptr( gas_den1_kw , zero );
-      const float * wat_den1  = safe_get_float_ptr( wat_den1_kw , zero );
-      
-      const float * sgas2_v   = safe_get_float_ptr( sgas2_kw    , NULL );
-      const float * swat2_v   = safe_get_float_ptr( swat2_kw    , NULL );
-      const float * oil_den2  = safe_get_float_ptr( oil_den2_kw , zero );
-      const float * gas_den2  = safe_get_float_ptr( gas_den2_kw , zero );
-      const float * wat_den2  = safe_get_float_ptr( wat_den2_kw , zero );
-      
-      const float * rporv1    = ecl_kw_get_float_ptr(rporv1_kw);
-      const float * rporv2    = ecl_kw_get_float_ptr(rporv2_kw);
-      double utm_x = grav_station->utm_x;
-      double utm_y = grav_station->utm_y;
-      double tvd   = grav_station->depth;
-      
-      int   * aquifern;
-      int global_index;
-          
-      if (aquifern_kw != NULL)
-        aquifern = ecl_kw_get_int_ptr( aquifern_kw );
-      else
-        aquifern = int_zero;
-
-      for (global_index=0;global_index < ecl_grid_get_global_size( ecl_grid ); global_index++){
-        const int act_index = ecl_grid_get_active_index1( ecl_grid , global_index );
-        if (act_index >= 0) {
-
-          // Not numerical aquifer 
-          if(aquifern[act_index] >= 0){ 
-            float swat1 = swat1_v[act_index];
-            float swat2 = swat2_v[act_index];
-            float sgas1 = 0;
-            float sgas2 = 0;
-            float soil1 = 0;
-            float soil2 = 0;
-
-            truncate_saturation( &swat1 );
-            truncate_saturation( &swat2 );
-            
-            if (has_phase( model_phases , GAS)) {
-              if (has_phase( file_phases , GAS )) {
-                sgas1 = sgas1_v[act_index];
-                sgas2 = sgas2_v[act_index];
-                truncate_saturation( &sgas1 );
-                truncate_saturation( &sgas2 );
-              } else {
-                sgas1 = 1 - swat1;
-                sgas2 = 1 - swat2;
-              }
-            }
-            
-            if (has_phase( model_phases , OIL )) {
-              soil1 =  1 - sgas1  - swat1;
-              soil2 =  1 - sgas2  - swat2;
-              truncate_saturation( &soil1 );
-              truncate_saturation( &soil2 );
-            }
-            
-                        
-            /* 
-               We have found all the info we need for one cell.
-            */
-            
-            {
-              double  mas1 , mas2;
-              double  xpos , ypos , zpos;
-              
-              mas1 = rporv1[act_index]*(soil1 * oil_den1[act_index] + sgas1 * gas_den1[act_index] + swat1 * wat_den1[act_index] );
-              mas2 = rporv2[act_index]*(soil2 * oil_den2[act_index] + sgas2 * gas_den2[act_index] + swat2 * wat_den2[act_index] );
-              
-              ecl_grid_get_xyz1(ecl_grid , global_index , &xpos , &ypos , &zpos);
-              {
-                double dist_x   = xpos - utm_x;
-                double dist_y   = ypos - utm_y;
-                double dist_d   = zpos - tvd;
-                double dist_sq  = dist_x*dist_x + dist_y*dist_y + dist_d*dist_d;
-                
-                if(dist_sq == 0){
-                  exit(1);
-                }
-                local_deltag += 6.67428E-3*(mas2 - mas1)*dist_d/pow(dist_sq, 1.5); // Gravity in units of \mu Gal = 10^{-8} m/s^2
-              }
-              
-            }
-          }
-        }
-      }
-    }
-    free( zero );
-    free( int_zero );
-  }
-  return local_deltag;
-}
-
-
-static void * gravity_response_mt( void * arg ) {
-  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
-  vector_type * grav_stations          = arg_pack_iget_ptr( arg_pack , 0 );
-  const ecl_grid_type * ecl_grid       = arg_pack_iget_ptr( arg_pack , 1 );
-  const ecl_file_type * init_file      = arg_pack_iget_ptr( arg_pack , 2 );
-  ecl_file_type ** restart_files       = arg_pack_iget_ptr( arg_pack , 3 );
-  int station1                         = arg_pack_iget_int( arg_pack , 4 );
-  int station2                         = arg_pack_iget_int( arg_pack , 5 );
-  int model_phases                     = arg_pack_iget_int( arg_pack , 6 );
-  int file_phases                      = arg_pack_iget_int( arg_pack , 7 );
-  
-  int station_nr;
-  for (station_nr = station1; station_nr < station2; station_nr++) {
-    grav_station_type * gs = vector_iget( grav_stations , station_nr );
-    
-    gs->grav_diff = gravity_response( ecl_grid , 
-                                      init_file , 
-                                      restart_files[0] , 
-                                      restart_files[1] , 
-                                      gs , 
-                                      model_phases , 
-                                      file_phases);
-  }
-  return NULL;
-}
-
-
-
-
-  
 /* 
    Validate input:
    ---------------
@@ -928,7 +669,7 @@ int main(int argc , char ** argv) {
         } else print_usage(__LINE__);
       }
       
-      init_file     = ecl_file_open(init_filename );
+      init_file     = ecl_file_open( init_filename , 0 );
       ecl_grid      = ecl_grid_alloc(grid_filename );
       free( init_filename );
       free( grid_filename );
@@ -954,42 +695,39 @@ int main(int argc , char ** argv) {
     
     /* 
        OK - now it seems the provided files have all the information
-       we need. Let us start using it. The main loop is run in
-       parallell on four threads - most people have four cores these
-       days.
+       we need. Let us start using it. All the stations are evaluated
+       in one pass with ecl_grav_eval_list().
     */
     {
-      int i;
-      int num_threads = 4;
-      thread_pool_type * tp = thread_pool_alloc( num_threads , true);
-      arg_pack_type ** arg_list = util_calloc( num_threads , sizeof * arg_list);
-      {
-        int station_delta = vector_get_size( grav_stations ) / num_threads;
-        for (i = 0; i < num_threads; i++) {
-          int station1 = i * station_delta;
-          int station2 = station1 + station_delta;
-          if (i == num_threads)
-            station2 = vector_get_size( grav_stations );
-          
-          arg_list[i] = arg_pack_alloc( );
-
-          arg_pack_append_ptr( arg_list[i] , grav_stations );
-          arg_pack_append_ptr( arg_list[i] , ecl_grid);
-          arg_pack_append_ptr( arg_list[i] , init_file );
-          arg_pack_append_ptr( arg_list[i] , restart_files);
-          arg_pack_append_int( arg_list[i] , station1 );
-          arg_pack_append_int( arg_list[i] , station2 );
-          arg_pack_append_int( arg_list[i] , model_phases );
-          arg_pack_append_int( arg_list[i] , file_phases );
-
-          thread_pool_add_job( tp , gravity_response_mt , arg_list[i]);
-        }
+      ecl_grav_type * ecl_grav = ecl_grav_alloc( ecl_grid , init_file );
+      int num_stations = vector_get_size( grav_stations );
+      double * utm_x   = util_calloc( num_stations , sizeof * utm_x );
+      double * utm_y   = util_calloc( num_stations , sizeof * utm_y );
+      double * depth   = util_calloc( num_stations , sizeof * depth );
+      double * deltag  = util_calloc( num_stations , sizeof * deltag );
+      int station_nr;
+
+      for (station_nr = 0; station_nr < num_stations; station_nr++) {
+        const grav_station_type * gs = vector_iget_const( grav_stations , station_nr );
+        utm_x[station_nr] = gs->utm_x;
+        utm_y[station_nr] = gs->utm_y;
+        depth[station_nr] = gs->depth;
       }
-      thread_pool_join( tp );
-      for (i = 0; i < num_threads; i++) 
-        arg_pack_free( arg_list[i] );
-      free( arg_list );
-        
+
+      ecl_grav_add_survey_RPORV( ecl_grav , "BASE"    , restart_files[0] );
+      ecl_grav_add_survey_RPORV( ecl_grav , "MONITOR" , restart_files[1] );
+      ecl_grav_eval_list( ecl_grav , "BASE" , "MONITOR" , NULL , num_stations , utm_x , utm_y , depth , ECL_OIL_PHASE + ECL_GAS_PHASE + ECL_WATER_PHASE , deltag );
+
+      for (station_nr = 0; station_nr < num_stations; station_nr++) {
+        grav_station_type * gs = vector_iget( grav_stations , station_nr );
+        gs->grav_diff = deltag[station_nr];
+      }
+
+      free( utm_x );
+      free( utm_y );
+      free( depth );
+      free( deltag );
+      ecl_grav_free( ecl_grav );
     }
     
     {
@@ -19,11 +19,13 @@
 #include <string.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <unistd.h>
 
 #include <ert/util/util.h>
 #include <ert/util/stringlist.h>
 
 #include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_sum_ensemble.h>
 
 
 
@@ -49,22 +51,88 @@ static bool extend_key_list( const ecl_sum_type * ecl_sum , const stringlist_typ
 }
 
 
+/*
+  Shared, read-only, state for all the cases; the cases are processed
+  concurrently by the ecl_sum_ensemble loader threads, and each case
+  is written to its own file.
+*/
+
+typedef struct {
+  const stringlist_type  * case_list;
+  const stringlist_type  * var_list;
+  const ecl_sum_fmt_type * fmt;
+  bool                     well_rows;
+} csv_arg_type;
+
+
+
+static void write_csv( const ecl_sum_type * ecl_sum , int index , void * arg ) {
+  const csv_arg_type * csv_arg = arg;
+
+  if (ecl_sum != NULL) {
+    /* Saved next to the case, so that cases with the same basename in different directories do not clobber each other. */
+    char * csv_file = util_alloc_filename( ecl_sum_get_path( ecl_sum ) , ecl_sum_get_base(ecl_sum) , "txt");
+    FILE * stream = util_fopen( csv_file , "w");
+    
+    stringlist_type * well_list = ecl_sum_alloc_well_list( ecl_sum , NULL );
+    stringlist_type * key_list = stringlist_alloc_new( );
+    int iw;
+    
+    for (iw = 0; iw < stringlist_get_size( well_list ); iw++) {
+      const char * well = stringlist_iget( well_list , iw );
+      if (!extend_key_list( ecl_sum , csv_arg->var_list , well , key_list))
+        fprintf(stderr , "Ignoring well: %s \n",well);
+      
+      if (csv_arg->well_rows) {
+        if (stringlist_get_size(key_list)) { 
+          ecl_sum_fprintf(ecl_sum , stream , key_list , false , csv_arg->fmt);
+          stringlist_clear( key_list );
+        }
+      }                  
+    }
+    if (!csv_arg->well_rows) 
+      ecl_sum_fprintf(ecl_sum , stream , key_list , false , csv_arg->fmt);
+    
+    stringlist_free( well_list );
+    stringlist_free( key_list );
+    fclose( stream );
+    free( csv_file );
+  } else 
+    fprintf(stderr,"summary2csv: No summary data found for case:%s\n", stringlist_iget( csv_arg->case_list , index ));
+}
+
+
+
+/*
+  Several cases can be given on the commandline; they are loaded and
+  written by @num_threads worker threads, and at most @num_threads
+  cases are in memory at the same time. The output for the case
+  path/BASE is written to path/BASE.txt.
+*/
+
 int main(int argc , char ** argv) {
   {
     ecl_sum_fmt_type fmt;
-    bool           well_rows       = false;   
-    bool           include_restart = true;
+    int            num_threads     = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
     int            arg_offset      = 1;  
     
-    if (argc != 2) {
-      printf("You must supply the name of a case as:\n\n   summary2csv.exe  ECLIPSE_CASE\n\nThe case can optionally contain a leading path component.\n");
+    if ((argc > 2) && util_string_equal( argv[1] , "-j")) {
+      if (!util_sscanf_int( argv[2] , &num_threads ) || (num_threads < 1)) {
+        fprintf(stderr,"summary2csv: failed to interpret:%s as a positive number of threads\n", argv[2]);
+        exit(1);
+      }
+      arg_offset = 3;
+    }
+    
+    if (argc <= arg_offset) {
+      printf("You must supply the name of a case as:\n\n   summary2csv.exe  [-j num_threads] ECLIPSE_CASE1 [ECLIPSE_CASE2 ...]\n\nThe cases can optionally contain a leading path component; the output\nfor path/CASE is written to path/CASE.txt.\n");
       exit(1);
     }
 
     {
-      char         * data_file = argv[arg_offset];
-      ecl_sum_type * ecl_sum;
+      stringlist_type * case_list = stringlist_alloc_argv_ref( (const char **) &argv[arg_offset] , argc - arg_offset );
       stringlist_type * var_list = stringlist_alloc_new();
+      csv_arg_type csv_arg;
 
       stringlist_append_ref( var_list , "WOPR" );
       stringlist_append_ref( var_list , "WOPT" );
@@ -74,39 +142,15 @@ int main(int argc , char ** argv) {
       stringlist_append_ref( var_list , "WWPT" );
     
       ecl_sum_fmt_init_csv( &fmt );
-      ecl_sum = ecl_sum_fread_alloc_case__( data_file , ":" , include_restart);
-      if (ecl_sum != NULL) {
-        char * csv_file = util_alloc_filename( NULL , ecl_sum_get_base(ecl_sum) , "txt");  // Will save to current path; can use ecl_sum_get_path() to save to target path instead.
-        FILE * stream = util_fopen( csv_file , "w");
-        
-        stringlist_type * well_list = ecl_sum_alloc_well_list( ecl_sum , NULL );
-        stringlist_type * key_list = stringlist_alloc_new( );
-        int iw;
-
-        for (iw = 0; iw < stringlist_get_size( well_list ); iw++) {
-          const char * well = stringlist_iget( well_list , iw );
-          if (!extend_key_list( ecl_sum , var_list , well , key_list))
-            fprintf(stderr , "Ignoring well: %s \n",well);
-          
-          if (well_rows) {
-            if (stringlist_get_size(key_list)) { 
-              ecl_sum_fprintf(ecl_sum , stream , key_list , false , &fmt);
-              stringlist_clear( key_list );
-            }
-          }                  
-        }
-        if (!well_rows) 
-          ecl_sum_fprintf(ecl_sum , stream , key_list , false , &fmt);
-
-        stringlist_free( well_list );
-        stringlist_free( key_list );
-        ecl_sum_free(ecl_sum);
-        fclose( stream );
-        free( csv_file );
-      } else 
-        fprintf(stderr,"summary2csv: No summary data found for case:%s\n", data_file );
+      csv_arg.case_list = case_list;
+      csv_arg.var_list  = var_list;
+      csv_arg.fmt       = &fmt;
+      csv_arg.well_rows = false;
+      
+      ecl_sum_ensemble_fread_apply( case_list , ":" , num_threads , write_csv , &csv_arg );
       
       stringlist_free( var_list );
+      stringlist_free( case_list );
     }
   }
 }
@@ -0,0 +1,61 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'ecl_archive.h' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#ifndef __ECL_ARCHIVE_H__
+#define __ECL_ARCHIVE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/type_macros.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+
+#define ECL_ARCHIVE_DEFAULT_BLOCK_SIZE  (1024 * 1024)
+#define ECL_ARCHIVE_EXT                 "ecla"     /* Conventional extension appended to the name of the archived file, e.g. CASE.UNRST.ecla */
+
+  typedef struct ecl_archive_struct ecl_archive_type;
+
+  UTIL_IS_INSTANCE_HEADER(ecl_archive);
+
+  bool               ecl_archive_is_archive( const char * filename );
+  ecl_archive_type * ecl_archive_alloc_writer( const char * filename , int block_size , int num_threads );
+  ecl_archive_type * ecl_archive_open( const char * filename );
+  void               ecl_archive_close( ecl_archive_type * archive );
+  void               ecl_archive_set_num_threads( ecl_archive_type * archive , int num_threads );
+  void               ecl_archive_add_kw( ecl_archive_type * archive , const ecl_kw_type * ecl_kw );
+  
+  const char       * ecl_archive_get_filename( const ecl_archive_type * archive );
+  int                ecl_archive_get_size( const ecl_archive_type * archive );
+  int                ecl_archive_get_block_size( const ecl_archive_type * archive );
+  int                ecl_archive_get_num_blocks( const ecl_archive_type * archive );
+  size_t             ecl_archive_get_data_size( const ecl_archive_type * archive );
+  size_t             ecl_archive_get_compressed_size( const ecl_archive_type * archive );
+  const char       * ecl_archive_iget_header( const ecl_archive_type * archive , int index );
+  ecl_type_enum      ecl_archive_iget_type( const ecl_archive_type * archive , int index );
+  int                ecl_archive_iget_size( const ecl_archive_type * archive , int index );
+  ecl_kw_type      * ecl_archive_iget_kw( ecl_archive_type * archive , int index );
+  bool               ecl_archive_verify( ecl_archive_type * archive );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
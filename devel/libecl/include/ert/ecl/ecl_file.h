@@ -29,6 +29,7 @@ extern "C" {
 
 #include <ert/ecl/ecl_kw.h>
 #include <ert/ecl/ecl_file_kw.h>
+#include <ert/ecl/ecl_kw_prefetch.h>
 #include <ert/ecl/fortio.h>
 #include <ert/ecl/ecl_util.h>
 
@@ -38,19 +39,34 @@ extern "C" {
                                       mainly to save filedescriptors in cases where many ecl_file instances are open at
                                       the same time. */
     //
-    ECL_FILE_WRITABLE      =  2    /*
+    ECL_FILE_WRITABLE      =  2 ,  /*
                                       This flag opens the file in a mode where it can be updated and modified, but it
                                       must still exist and be readable. I.e. this should not compared with the normal:
                                       fopen(filename , "w") where an existing file is truncated to zero upon successfull
                                       open.
                                    */
+    //
+    ECL_FILE_USE_INDEX     =  8 ,  /*
+                                      This flag will use an index file 'filename.idx' with the keyword headers and
+                                      offsets, instead of scanning through the whole file when opening. If the index
+                                      file does not exist, or is not valid for the current file, the file is scanned
+                                      and a new index file is written.
+                                   */
+    //
+    ECL_FILE_PREFETCH      = 16    /*
+                                      This flag will start a background thread which reads the keywords ahead in file
+                                      order, so that reading overlaps with processing when the keywords are accessed
+                                      sequentially. The flag is ignored for writable files.
+                                   */
   } ecl_file_flag_type;
 
 
 #define ECL_FILE_FLAGS_ENUM_DEFS \
   {.value =   1 , .name="ECL_FILE_CLOSE_STREAM"}, \
-  {.value =   2 , .name="ECL_FILE_WRITABLE"}
-#define ECL_FILE_FLAGS_ENUM_SIZE 2
+  {.value =   2 , .name="ECL_FILE_WRITABLE"}, \
+  {.value =   8 , .name="ECL_FILE_USE_INDEX"}, \
+  {.value =  16 , .name="ECL_FILE_PREFETCH"}
+#define ECL_FILE_FLAGS_ENUM_SIZE 4
 
 
 
@@ -61,8 +77,10 @@ extern "C" {
   void             ecl_file_pop_block( ecl_file_type * ecl_file );
   ecl_file_type  * ecl_file_open( const char * filename , int flags);
   ecl_file_type  * ecl_file_try_open( const char * filename , int flags);
+  ecl_file_type  * ecl_file_open_clone( const ecl_file_type * src );
   void             ecl_file_close( ecl_file_type * ecl_file );
   void             ecl_file_fortio_detach( ecl_file_type * ecl_file );
+  ecl_kw_prefetch_type       * ecl_file_get_prefetch( const ecl_file_type * ecl_file );
   void             ecl_file_free__(void * arg);
   ecl_kw_type    * ecl_file_icopy_named_kw( const ecl_file_type * ecl_file , const char * kw, int ith);
   ecl_kw_type    * ecl_file_icopy_kw( const ecl_file_type * ecl_file , int index);
@@ -101,6 +119,7 @@ extern "C" {
   bool               ecl_file_subselect_block( ecl_file_type * ecl_file , const char * kw , int occurence);
   bool               ecl_file_select_block( ecl_file_type * ecl_file , const char * kw , int occurence);
   void               ecl_file_select_global( ecl_file_type * ecl_file );
+  void               ecl_file_unload_active( ecl_file_type * ecl_file );
   //bool               ecl_file_writable( const ecl_file_type * ecl_file );
   bool               ecl_file_save_kw( const ecl_file_type * ecl_file , const ecl_kw_type * ecl_kw);
   bool               ecl_file_has_kw_ptr( const ecl_file_type * ecl_file , const ecl_kw_type * ecl_kw);
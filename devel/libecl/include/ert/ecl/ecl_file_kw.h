@@ -26,6 +26,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <ert/util/util.h>
+#include <ert/util/buffer.h>
 
 #include <ert/ecl/ecl_kw.h>
 #include <ert/ecl/fortio.h>
@@ -38,18 +39,24 @@ typedef struct inv_map_struct inv_map_type;
   void               inv_map_free( inv_map_type * map );
 
   ecl_file_kw_type * ecl_file_kw_alloc( const ecl_kw_type * ecl_kw , offset_type offset);
+  ecl_file_kw_type * ecl_file_kw_alloc_header( const char * header , ecl_type_enum ecl_type , int size , offset_type offset);
   void               ecl_file_kw_free( ecl_file_kw_type * file_kw );
   void               ecl_file_kw_free__( void * arg );
   ecl_kw_type      * ecl_file_kw_get_kw( ecl_file_kw_type * file_kw , fortio_type * fortio, inv_map_type * inv_map);
   ecl_kw_type      * ecl_file_kw_get_kw_ptr( ecl_file_kw_type * file_kw , fortio_type * fortio , inv_map_type * inv_map );
+  void               ecl_file_kw_set_kw( ecl_file_kw_type * file_kw , ecl_kw_type * ecl_kw , inv_map_type * inv_map);
+  void               ecl_file_kw_drop_kw( ecl_file_kw_type * file_kw , inv_map_type * inv_map );
   ecl_file_kw_type * ecl_file_kw_alloc_copy( const ecl_file_kw_type * src );
   const char       * ecl_file_kw_get_header( const ecl_file_kw_type * file_kw );
   int                ecl_file_kw_get_size( const ecl_file_kw_type * file_kw );
+  offset_type        ecl_file_kw_get_offset( const ecl_file_kw_type * file_kw );
   ecl_type_enum      ecl_file_kw_get_type( const ecl_file_kw_type * file_kw);
   bool               ecl_file_kw_ptr_eq( const ecl_file_kw_type * file_kw , const ecl_kw_type * ecl_kw);
   void               ecl_file_kw_replace_kw( ecl_file_kw_type * file_kw , fortio_type * target , ecl_kw_type * new_kw );
   void               ecl_file_kw_fskip_data( const ecl_file_kw_type * file_kw , fortio_type * fortio);
   void               ecl_file_kw_inplace_fwrite( ecl_file_kw_type * file_kw , fortio_type * fortio);
+  void               ecl_file_kw_buffer_fwrite( const ecl_file_kw_type * file_kw , buffer_type * buffer );
+  ecl_file_kw_type * ecl_file_kw_buffer_alloc( buffer_type * buffer );
  
 #ifdef __cplusplus
 }
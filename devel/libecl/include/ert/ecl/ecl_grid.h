@@ -31,10 +31,15 @@ extern "C" {
 #include <ert/ecl/ecl_kw.h>  
 #include <ert/ecl/grid_dims.h>
 #include <ert/ecl/nnc_info.h>
+#include <ert/ecl/nnc_table.h>
 
 #define ECL_GRID_GLOBAL_GRID   "Global"  // used as key in hash tables over grids.
 #define  ECL_GRID_MAINGRID_LGR_NR 0
 
+/* Flags which can be passed to ecl_grid_alloc_flags(). */
+#define ECL_GRID_COMPACT  1    /* Store the cell geometry as float arrays - see ecl_grid_alloc_compact(). */
+#define ECL_GRID_LAZY     2    /* Defer the cell geometry until the first geometric query; EGRID files only. */
+
   typedef double (block_function_ftype) ( const double_vector_type *); 
   typedef struct ecl_grid_struct ecl_grid_type;
 
@@ -62,12 +67,15 @@ extern "C" {
   int             ecl_grid_get_global_index_from_xy( const ecl_grid_type * ecl_grid , int k , bool lower_layer , double x , double y);
   bool            ecl_grid_cell_contains_xyz1( const ecl_grid_type * ecl_grid , int global_index , double x , double y , double z);
   bool            ecl_grid_cell_contains_xyz3( const ecl_grid_type * ecl_grid , int i , int j , int k, double x , double y , double z );
+  void            ecl_grid_cell_contains_xyz_list1( const ecl_grid_type * ecl_grid , int global_index , int num_points , const double * xlist , const double * ylist , const double * zlist , bool * contains);
+  void            ecl_grid_cell_list_contains_xyz( const ecl_grid_type * ecl_grid , int num_cells , const int * global_index_list , double x , double y , double z , bool * contains);
   double          ecl_grid_get_cell_volume1( const ecl_grid_type * ecl_grid, int global_index );
   double          ecl_grid_get_cell_volume1_tskille( const ecl_grid_type * ecl_grid, int global_index );
   double          ecl_grid_get_cell_volume3( const ecl_grid_type * ecl_grid, int i , int j , int k);
   bool            ecl_grid_cell_contains1(const ecl_grid_type * grid , int global_index , double x , double y , double z);
   bool            ecl_grid_cell_contains3(const ecl_grid_type * grid , int i , int j ,int k , double x , double y , double z);
   int             ecl_grid_get_global_index_from_xyz(ecl_grid_type * grid , double x , double y , double z , int start_index);
+  void            ecl_grid_get_global_index_list_from_xyz( ecl_grid_type * grid , int num_points , const double * xlist , const double * ylist , const double * zlist , int * index_list);
   const  char   * ecl_grid_get_name( const ecl_grid_type * );
   int             ecl_grid_get_active_index3(const ecl_grid_type * ecl_grid , int i , int j , int k);
   int             ecl_grid_get_active_index1(const ecl_grid_type * ecl_grid , int global_index);
@@ -79,6 +87,8 @@ extern "C" {
   int             ecl_grid_get_global_index3(const ecl_grid_type * , int  , int , int );
   int             ecl_grid_get_global_index1A(const ecl_grid_type * ecl_grid , int active_index);
   int             ecl_grid_get_global_index1F(const ecl_grid_type * ecl_grid , int active_fracture_index);
+  const int     * ecl_grid_get_index_map_ptr( const ecl_grid_type * ecl_grid );
+  const int     * ecl_grid_get_inv_index_map_ptr( const ecl_grid_type * ecl_grid );
 
   const nnc_info_type * ecl_grid_get_cell_nnc_info3( const ecl_grid_type * grid , int i , int j , int k); 
   const nnc_info_type * ecl_grid_get_cell_nnc_info1( const ecl_grid_type * grid , int global_index); 
@@ -87,6 +97,10 @@ extern "C" {
   ecl_grid_type * ecl_grid_alloc_GRDECL_data(int , int , int , const float *  , const float *  , const int * , const float * mapaxes);
   ecl_grid_type * ecl_grid_alloc_GRID_data(int num_coords , int nx, int ny , int nz , int coords_size , int ** coords , float ** corners , const float * mapaxes);
   ecl_grid_type * ecl_grid_alloc(const char * );
+  ecl_grid_type * ecl_grid_alloc_compact(const char * grid_file );
+  ecl_grid_type * ecl_grid_alloc_flags(const char * grid_file , int flags);
+  bool            ecl_grid_is_compact( const ecl_grid_type * grid );
+  bool            ecl_grid_has_geometry( const ecl_grid_type * grid );
   ecl_grid_type * ecl_grid_load_case( const char * case_input );
   ecl_grid_type * ecl_grid_alloc_rectangular( int nx , int ny , int nz , double dx , double dy , double dz , const int * actnum);
   ecl_grid_type * ecl_grid_alloc_regular( int nx, int ny , int nz , const double * ivec, const double * jvec , const double * kvec , const int * actnum);
@@ -186,6 +200,7 @@ extern "C" {
 
   bool             ecl_grid_dual_grid( const ecl_grid_type * ecl_grid );
   int              ecl_grid_get_num_nnc( const ecl_grid_type * grid );
+  const nnc_table_type * ecl_grid_get_nnc_table( const ecl_grid_type * grid );
 
   bool ecl_grid_cell_regular3( const ecl_grid_type * ecl_grid, int i,int j,int k);
   bool ecl_grid_cell_regular1( const ecl_grid_type * ecl_grid, int global_index);
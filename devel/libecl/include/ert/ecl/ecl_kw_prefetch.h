@@ -0,0 +1,52 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_kw_prefetch.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __ECL_KW_PREFETCH_H__
+#define __ECL_KW_PREFETCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/util.h>
+#include <ert/util/long_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+
+  typedef struct ecl_kw_prefetch_struct ecl_kw_prefetch_type;
+
+  ecl_kw_prefetch_type * ecl_kw_prefetch_alloc( const char * filename , bool fmt_file , bool close_stream , const long_vector_type * offset_list , size_t max_buffer_size );
+  void                   ecl_kw_prefetch_free( ecl_kw_prefetch_type * prefetch );
+  void                   ecl_kw_prefetch_stop( ecl_kw_prefetch_type * prefetch );
+  void                   ecl_kw_prefetch_wait_idle( ecl_kw_prefetch_type * prefetch );
+  bool                   ecl_kw_prefetch_stream_is_open( ecl_kw_prefetch_type * prefetch );
+  ecl_kw_type          * ecl_kw_prefetch_get_kw( ecl_kw_prefetch_type * prefetch , offset_type offset );
+  int                    ecl_kw_prefetch_get_hits( ecl_kw_prefetch_type * prefetch );
+  int                    ecl_kw_prefetch_get_misses( ecl_kw_prefetch_type * prefetch );
+  double                 ecl_kw_prefetch_get_hit_rate( ecl_kw_prefetch_type * prefetch );
+  size_t                 ecl_kw_prefetch_get_prefetch_bytes( ecl_kw_prefetch_type * prefetch );
+
+  UTIL_IS_INSTANCE_HEADER( ecl_kw_prefetch );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_region_stat.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __ECL_REGION_STAT_H__
+#define __ECL_REGION_STAT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+
+  typedef struct ecl_region_stat_struct ecl_region_stat_type;
+
+  ecl_region_stat_type * ecl_region_stat_alloc( const ecl_grid_type * grid , const ecl_kw_type * weight_kw );
+  void                   ecl_region_stat_free( ecl_region_stat_type * region_stat );
+  void                   ecl_region_stat_add_kw( ecl_region_stat_type * region_stat , const ecl_kw_type * ecl_kw );
+  int                    ecl_region_stat_get_num_kw( const ecl_region_stat_type * region_stat );
+  int                    ecl_region_stat_get_num_regions( const ecl_region_stat_type * region_stat );
+
+  void                   ecl_region_stat_eval_region_kw( ecl_region_stat_type * region_stat , const ecl_kw_type * region_kw );
+  void                   ecl_region_stat_eval_region_list( ecl_region_stat_type * region_stat , vector_type * region_list );
+
+  int                    ecl_region_stat_get_count( const ecl_region_stat_type * region_stat , int region_nr );
+  double                 ecl_region_stat_get_weight( const ecl_region_stat_type * region_stat , int region_nr );
+  double                 ecl_region_stat_get_sum( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr );
+  double                 ecl_region_stat_get_mean( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr );
+  double                 ecl_region_stat_get_weighted_mean( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr );
+  double                 ecl_region_stat_get_min( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr );
+  double                 ecl_region_stat_get_max( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr );
+
+  UTIL_IS_INSTANCE_HEADER( ecl_region_stat );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
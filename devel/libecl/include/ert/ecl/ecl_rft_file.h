@@ -44,6 +44,10 @@ ecl_rft_node_type    * ecl_rft_file_get_node(const ecl_rft_file_type * , const c
 int                       ecl_rft_file_get_size__( const ecl_rft_file_type * rft_file, const char * well_pattern , time_t recording_time);
 int                       ecl_rft_file_get_size( const ecl_rft_file_type * rft_file);
 ecl_rft_node_type       * ecl_rft_file_get_well_time_rft( const ecl_rft_file_type * rft_file , const char * well , time_t recording_time);
+int                       ecl_rft_file_get_well_time_index( const ecl_rft_file_type * rft_file , const char * well , time_t recording_time);
+int                       ecl_rft_file_lookup_cells( const ecl_rft_file_type * rft_file , int num_points , const char ** well_list , const time_t * time_list , 
+                                                     const int * i , const int * j , const int * k , 
+                                                     double * pressure , double * swat , double * sgas , bool * found);
 ecl_rft_node_type       * ecl_rft_file_iget_node( const ecl_rft_file_type * rft_file , int index);
 ecl_rft_node_type       * ecl_rft_file_iget_well_rft( const ecl_rft_file_type * rft_file , const char * well, int index);
 bool                      ecl_rft_file_has_well( const ecl_rft_file_type * rft_file , const char * well);
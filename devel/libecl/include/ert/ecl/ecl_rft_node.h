@@ -23,6 +23,7 @@ extern "C" {
 #endif
 #include <stdbool.h>
 
+#include <ert/ecl/ecl_kw.h>
 #include <ert/ecl/ecl_file.h>
 #include <ert/ecl/ecl_rft_cell.h>
 
@@ -38,6 +39,9 @@ const ecl_rft_cell_type * ecl_rft_node_iget_cell( const ecl_rft_node_type * rft_
 const ecl_rft_cell_type * ecl_rft_node_lookup_ijk( const ecl_rft_node_type * rft_node , int i, int j , int k);
 void                ecl_rft_node_fprintf_rft_obs(const ecl_rft_node_type * , double , const char * , const char * , double );
 ecl_rft_node_type * ecl_rft_node_alloc(const ecl_file_type * file_map );
+ecl_rft_node_type * ecl_rft_node_alloc_header(const ecl_kw_type * welletc , const ecl_kw_type * date_kw , const ecl_kw_type * time_kw);
+void                ecl_rft_node_load_cells( ecl_rft_node_type * rft_node , const ecl_file_type * rft);
+bool                ecl_rft_node_cells_loaded( const ecl_rft_node_type * rft_node );
 const char        * ecl_rft_node_get_well_name(const ecl_rft_node_type * );
 void                ecl_rft_node_free(ecl_rft_node_type * );
 void                ecl_rft_node_free__(void * );
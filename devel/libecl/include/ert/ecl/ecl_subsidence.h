@@ -39,6 +39,11 @@ extern "C" {
                                                     const char * base, const char * monitor , 
                                                     ecl_region_type * region , 
                                                     double utm_x, double utm_y , double depth, double compressibility, double poisson_ratio);
+  void                         ecl_subsidence_eval_list( const ecl_subsidence_type * subsidence ,
+                                                         const char * base, const char * monitor ,
+                                                         ecl_region_type * region ,
+                                                         int num_stations , const double * utm_x, const double * utm_y , const double * depth,
+                                                         double compressibility, double poisson_ratio , double * deltaz);
 
 
 #ifdef __plusplus
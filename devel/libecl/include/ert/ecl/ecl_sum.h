@@ -92,7 +92,9 @@ typedef struct ecl_sum_struct       ecl_sum_type;
   ecl_sum_type   * ecl_sum_fread_alloc(const char * , const stringlist_type * data_files, const char * key_join_string);
   ecl_sum_type   * ecl_sum_fread_alloc_case(const char *  , const char * key_join_string);
   ecl_sum_type   * ecl_sum_fread_alloc_case__(const char *  , const char * key_join_string , bool include_restart);
+  ecl_sum_type   * ecl_sum_fread_alloc_shared( const char * input_file , const char * header_file , const stringlist_type * data_files , const char * key_join_string , ecl_smspec_type * smspec);
   bool             ecl_sum_case_exists( const char * input_file );
+  bool             ecl_sum_fread_time_span( const char * input_file , const char * key_join_string , time_t * start_time , time_t * end_time);
   
   /* Accessor functions : */
   double            ecl_sum_get_well_var(const ecl_sum_type * ecl_sum , int time_index , const char * well , const char *var);
@@ -156,6 +158,10 @@ typedef struct ecl_sum_struct       ecl_sum_type;
   
   void                 ecl_sum_init_data_vector( const ecl_sum_type * ecl_sum , double_vector_type * data_vector , int data_index , bool report_only );
   double_vector_type * ecl_sum_alloc_data_vector( const ecl_sum_type * ecl_sum  , int data_index , bool report_only);
+  int                  ecl_sum_get_data_vector_length( const ecl_sum_type * ecl_sum , bool report_only);
+  void                 ecl_sum_fill_data_vectors( const ecl_sum_type * ecl_sum , const stringlist_type * key_list , bool report_only , double * buffer);
+  void                 ecl_sum_set_columnar( ecl_sum_type * ecl_sum , bool columnar );
+  bool                 ecl_sum_is_columnar( const ecl_sum_type * ecl_sum );
   time_t_vector_type * ecl_sum_alloc_time_vector( const ecl_sum_type * ecl_sum  , bool report_only);
   time_t       ecl_sum_get_data_start( const ecl_sum_type * ecl_sum );
   time_t       ecl_sum_get_end_time( const ecl_sum_type * ecl_sum);
@@ -28,6 +28,7 @@ extern "C" {
 
 #include <ert/util/time_t_vector.h>
 #include <ert/util/double_vector.h>
+#include <ert/util/int_vector.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/time_interval.h>
 
@@ -49,6 +50,10 @@ typedef struct ecl_sum_data_struct ecl_sum_data_type ;
   int                      ecl_sum_data_get_num_ministep( const ecl_sum_data_type * data );
   double_vector_type     * ecl_sum_data_alloc_data_vector( const ecl_sum_data_type * data , int data_index , bool report_only);
   void                     ecl_sum_data_init_data_vector( const ecl_sum_data_type * data , double_vector_type * data_vector , int data_index , bool report_only);
+  int                      ecl_sum_data_get_data_vector_length( const ecl_sum_data_type * data , bool report_only);
+  void                     ecl_sum_data_fill_data_vectors( const ecl_sum_data_type * data , const int_vector_type * params_list , bool report_only , double * buffer);
+  void                     ecl_sum_data_set_columnar( ecl_sum_data_type * data , bool columnar );
+  bool                     ecl_sum_data_is_columnar( const ecl_sum_data_type * data );
   void                     ecl_sum_data_init_time_vector( const ecl_sum_data_type * data , time_t_vector_type * time_vector , bool report_only);
   time_t_vector_type     * ecl_sum_data_alloc_time_vector( const ecl_sum_data_type * data , bool report_only);
   time_t                   ecl_sum_data_get_data_start( const ecl_sum_data_type * data );  
@@ -0,0 +1,48 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_ensemble.h' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#ifndef __ECL_SUM_ENSEMBLE_H__
+#define __ECL_SUM_ENSEMBLE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+
+#include <ert/ecl/ecl_sum.h>
+
+  typedef struct ecl_sum_ensemble_struct ecl_sum_ensemble_type;
+  typedef void (ecl_sum_ensemble_func_type) ( const ecl_sum_type * ecl_sum , int index , void * arg );
+
+  ecl_sum_ensemble_type * ecl_sum_ensemble_fread_alloc( const stringlist_type * case_list , const char * key_join_string , int num_threads );
+  void                    ecl_sum_ensemble_free( ecl_sum_ensemble_type * ensemble );
+  void                    ecl_sum_ensemble_fread_apply( const stringlist_type * case_list , const char * key_join_string , int num_threads , ecl_sum_ensemble_func_type * func , void * arg);
+  int                     ecl_sum_ensemble_get_size( const ecl_sum_ensemble_type * ensemble );
+  int                     ecl_sum_ensemble_get_num_smspec( const ecl_sum_ensemble_type * ensemble );
+  const char            * ecl_sum_ensemble_iget_case( const ecl_sum_ensemble_type * ensemble , int index );
+  ecl_sum_type          * ecl_sum_ensemble_iget( const ecl_sum_ensemble_type * ensemble , int index );
+
+  UTIL_IS_INSTANCE_HEADER( ecl_sum_ensemble );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
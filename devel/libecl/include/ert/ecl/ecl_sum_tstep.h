@@ -42,12 +42,16 @@ typedef struct ecl_sum_tstep_struct ecl_sum_tstep_type;
   ecl_sum_tstep_type * ecl_sum_tstep_alloc_new( int report_step , int ministep , float sim_days , const ecl_smspec_type * smspec );
   
   double ecl_sum_tstep_iget(const ecl_sum_tstep_type * ministep , int index);
+  const float * ecl_sum_tstep_get_data_ptr(const ecl_sum_tstep_type * ministep);
+  void ecl_sum_tstep_free_data( ecl_sum_tstep_type * ministep );
+  void ecl_sum_tstep_set_data( ecl_sum_tstep_type * ministep , const float * data );
   time_t ecl_sum_tstep_get_sim_time(const ecl_sum_tstep_type * ministep);
   double ecl_sum_tstep_get_sim_days(const ecl_sum_tstep_type * ministep);
   int  ecl_sum_tstep_get_report(const ecl_sum_tstep_type * ministep);
   int  ecl_sum_tstep_get_ministep(const ecl_sum_tstep_type * ministep);
 
   void ecl_sum_tstep_fwrite( const ecl_sum_tstep_type * ministep , const int_vector_type * index_map , fortio_type * fortio);
+  void ecl_sum_tstep_fwrite_row( const ecl_sum_tstep_type * ministep , const float * row_data , const int_vector_type * index_map , fortio_type * fortio);
   void ecl_sum_tstep_iset( ecl_sum_tstep_type * tstep , int index , float value);
   void ecl_sum_tstep_set_from_node( ecl_sum_tstep_type * tstep , const smspec_node_type * smspec_node , float value);
   void ecl_sum_tstep_set_from_key( ecl_sum_tstep_type * tstep , const char * gen_key , float value);
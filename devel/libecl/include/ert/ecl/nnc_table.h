@@ -0,0 +1,54 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'nnc_table.h' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#ifndef __NNC_TABLE_H__
+#define __NNC_TABLE_H__
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include <ert/util/int_vector.h>
+#include <ert/util/type_macros.h>
+
+  typedef struct nnc_table_struct nnc_table_type;
+
+  UTIL_IS_INSTANCE_HEADER(nnc_table);
+
+  nnc_table_type        * nnc_table_alloc( int lgr_nr , int num_cells );
+  void                    nnc_table_free( nnc_table_type * nnc_table );
+  void                    nnc_table_add_nnc( nnc_table_type * nnc_table , int global_index1 , int lgr_nr2 , int global_index2 , int nnc_index);
+  void                    nnc_table_build( nnc_table_type * nnc_table );
+  bool                    nnc_table_is_built( const nnc_table_type * nnc_table );
+
+  int                     nnc_table_get_lgr_nr( const nnc_table_type * nnc_table );
+  int                     nnc_table_get_num_cells( const nnc_table_type * nnc_table );
+  int                     nnc_table_get_size( const nnc_table_type * nnc_table );
+  const int_vector_type * nnc_table_get_lgr_list( const nnc_table_type * nnc_table );
+
+  int                     nnc_table_get_cell_offset( const nnc_table_type * nnc_table , int global_index1 );
+  int                     nnc_table_get_cell_size( const nnc_table_type * nnc_table , int global_index1 );
+  int                     nnc_table_iget_lgr_nr( const nnc_table_type * nnc_table , int index );
+  int                     nnc_table_iget_global_index( const nnc_table_type * nnc_table , int index );
+  int                     nnc_table_iget_nnc_index( const nnc_table_type * nnc_table , int index );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,727 @@
+
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'ecl_archive.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef WITH_PTHREAD
+#include <ert/util/thread_pool.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/buffer.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/long_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_archive.h>
+
+
+/*
+  The ecl_archive is a compressed container for ecl_kw instances,
+  e.g. the content of a unified restart or summary file. The payload
+  of each keyword is split in independent blocks of @block_size
+  bytes, which are compressed with zlib on several threads, and the
+  crc32 checksum of the uncompressed data is stored for every
+  block. The file layout is:
+
+     ECL_ARCHIVE_ID | version | block_size | index_offset | block ... block | index
+
+  The index at the end of the file has one entry for each keyword,
+  with header, type, size and the range of blocks holding the data,
+  and one entry for each block with file offset, compressed size,
+  uncompressed size and checksum; the index ends with the crc32
+  checksum of the index itself. When an archive is opened only the
+  index is read, and it is checked that the index is consistent with
+  the file before it is used; the keywords can then be loaded in
+  random order and only the blocks of the requested keyword are read
+  and uncompressed.
+  The ecl_file_open() function recognizes archives, so they can be
+  used in place of the normal fortio files when reading.
+
+  The data is stored in the in-memory representation of the ecl_kw,
+  i.e. in native byte order - like the ecl_file index files, the
+  archives can not be moved between computers of different
+  endianness. An archive which has not been properly closed has no
+  index, and will not be recognized by ecl_archive_open().
+*/
+
+#define ECL_ARCHIVE_TYPE_ID       776110
+#define ECL_ARCHIVE_ID            776111
+#define ECL_ARCHIVE_VERSION       2
+#define ECL_ARCHIVE_HEADER_SIZE   (3 * sizeof(int) + sizeof(offset_type))
+#define ECL_ARCHIVE_THREAD_BLOCKS 4     /* The writer compresses num_threads * ECL_ARCHIVE_THREAD_BLOCKS blocks at a time. */
+
+
+typedef struct {
+  char          * data;
+  int             data_size;
+  unsigned char * zdata;
+  unsigned long   zsize;
+  unsigned int    crc;
+  bool            data_ok;
+} archive_block_type;
+
+
+struct ecl_archive_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char               * filename;
+  FILE               * stream;
+  bool                 writer;
+  int                  block_size;
+  int                  num_threads;
+
+  stringlist_type    * kw_header;       /* The keyword index. */
+  int_vector_type    * kw_type;
+  int_vector_type    * kw_size;
+  int_vector_type    * kw_first_block;
+  int_vector_type    * kw_num_blocks;
+
+  long_vector_type   * block_offset;    /* The block index. */
+  int_vector_type    * block_zsize;
+  int_vector_type    * block_data_size;
+  int_vector_type    * block_crc;
+
+  archive_block_type * pending;         /* Writer only: blocks waiting to be compressed and written. */
+  int                  num_pending;
+  int                  max_pending;
+  offset_type          data_offset;
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( ecl_archive , ECL_ARCHIVE_TYPE_ID )
+
+/*****************************************************************/
+
+#ifdef WITH_ZLIB
+
+static unsigned int ecl_archive_crc( const void * data , size_t size ) {
+  return crc32( 0L , (const Bytef *) data , size );
+}
+
+
+static void archive_block_compress( archive_block_type * block ) {
+  block->zsize = compressBound( block->data_size );
+  block->zdata = util_malloc( block->zsize );
+  util_compress_buffer( block->data , block->data_size , block->zdata , &block->zsize );
+  block->crc = crc32( 0L , (const Bytef *) block->data , block->data_size );
+}
+
+
+/*
+  Runs on the worker threads; errors are only flagged here and
+  reported by the calling thread.
+*/
+
+static void archive_block_uncompress( archive_block_type * block ) {
+  uLongf data_size = block->data_size;
+  int result = uncompress( (Bytef *) block->data , &data_size , block->zdata , block->zsize );
+  
+  block->data_ok = false;
+  if ((result == Z_OK) && (data_size == block->data_size)) {
+    if (crc32( 0L , (const Bytef *) block->data , block->data_size ) == block->crc)
+      block->data_ok = true;
+  }
+}
+
+#else
+
+static unsigned int ecl_archive_crc( const void * data , size_t size ) {
+  util_abort("%s: ecl_archive support requires zlib.\n",__func__);
+  return 0;
+}
+
+static void archive_block_compress( archive_block_type * block ) {
+  util_abort("%s: ecl_archive support requires zlib.\n",__func__);
+}
+
+static void archive_block_uncompress( archive_block_type * block ) {
+  util_abort("%s: ecl_archive support requires zlib.\n",__func__);
+}
+
+#endif
+
+
+#ifdef WITH_PTHREAD
+static void * archive_block_compress__( void * arg ) {
+  archive_block_compress( arg );
+  return NULL;
+}
+
+
+static void * archive_block_uncompress__( void * arg ) {
+  archive_block_uncompress( arg );
+  return NULL;
+}
+#endif
+
+
+static void ecl_archive_run_blocks( const ecl_archive_type * archive , archive_block_type * block_list , int num_blocks , bool compress) {
+#ifdef WITH_PTHREAD
+  if ((archive->num_threads > 1) && (num_blocks > 1)) {
+    thread_pool_type * tp = thread_pool_alloc( util_int_min( archive->num_threads , num_blocks ) , true );
+    int i;
+
+    for (i=0; i < num_blocks; i++)
+      thread_pool_add_job( tp , compress ? archive_block_compress__ : archive_block_uncompress__ , &block_list[i] );
+
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+    return;
+  } 
+#endif
+  {
+    int i;
+    for (i=0; i < num_blocks; i++) {
+      if (compress)
+        archive_block_compress( &block_list[i] );
+      else
+        archive_block_uncompress( &block_list[i] );
+    }
+  }
+}
+
+/*****************************************************************/
+
+static ecl_archive_type * ecl_archive_alloc__( const char * filename , FILE * stream , bool writer , int block_size ) {
+  ecl_archive_type * archive = util_malloc( sizeof * archive );
+  UTIL_TYPE_ID_INIT( archive , ECL_ARCHIVE_TYPE_ID );
+  archive->filename        = util_alloc_string_copy( filename );
+  archive->stream          = stream;
+  archive->writer          = writer;
+  archive->block_size      = block_size;
+  archive->num_threads     = 1;
+  
+  archive->kw_header       = stringlist_alloc_new();
+  archive->kw_type         = int_vector_alloc( 0 , 0 );
+  archive->kw_size         = int_vector_alloc( 0 , 0 );
+  archive->kw_first_block  = int_vector_alloc( 0 , 0 );
+  archive->kw_num_blocks   = int_vector_alloc( 0 , 0 );
+
+  archive->block_offset    = long_vector_alloc( 0 , 0 );
+  archive->block_zsize     = int_vector_alloc( 0 , 0 );
+  archive->block_data_size = int_vector_alloc( 0 , 0 );
+  archive->block_crc       = int_vector_alloc( 0 , 0 );
+
+  archive->pending         = NULL;
+  archive->num_pending     = 0;
+  archive->max_pending     = 0;
+  archive->data_offset     = ECL_ARCHIVE_HEADER_SIZE;
+  ecl_archive_set_num_threads( archive , 0 );
+  return archive;
+}
+
+
+/**
+   The @num_threads threads are used to compress the blocks when
+   writing, and to uncompress the blocks of large keywords when
+   reading; a value <= 0 will use one thread per processor.
+*/
+
+void ecl_archive_set_num_threads( ecl_archive_type * archive , int num_threads ) {
+  if (num_threads <= 0)
+    num_threads = sysconf( _SC_NPROCESSORS_ONLN );
+  archive->num_threads = util_int_max( 1 , num_threads );
+
+  if (archive->writer && (archive->num_pending == 0)) {
+    util_safe_free( archive->pending );
+    archive->max_pending = archive->num_threads * ECL_ARCHIVE_THREAD_BLOCKS;
+    archive->pending = util_calloc( archive->max_pending , sizeof * archive->pending );
+  }
+}
+
+
+static void ecl_archive_fwrite_header( const ecl_archive_type * archive , offset_type index_offset ) {
+  int id = ECL_ARCHIVE_ID;
+  int version = ECL_ARCHIVE_VERSION;
+
+  util_fseek( archive->stream , 0 , SEEK_SET );
+  util_fwrite( &id , sizeof id , 1 , archive->stream , __func__ );
+  util_fwrite( &version , sizeof version , 1 , archive->stream , __func__ );
+  util_fwrite( &archive->block_size , sizeof archive->block_size , 1 , archive->stream , __func__ );
+  util_fwrite( &index_offset , sizeof index_offset , 1 , archive->stream , __func__ );
+}
+
+
+/**
+   Will create a new archive @filename; the keywords are added with
+   ecl_archive_add_kw() and the archive is completed by
+   ecl_archive_close(). A @block_size <= 0 will use the default
+   ECL_ARCHIVE_DEFAULT_BLOCK_SIZE.
+*/
+
+ecl_archive_type * ecl_archive_alloc_writer( const char * filename , int block_size , int num_threads ) {
+  FILE * stream = util_fopen( filename , "w");
+  ecl_archive_type * archive;
+
+  if (block_size <= 0)
+    block_size = ECL_ARCHIVE_DEFAULT_BLOCK_SIZE;
+  
+  archive = ecl_archive_alloc__( filename , stream , true , block_size );
+  ecl_archive_set_num_threads( archive , num_threads );
+  ecl_archive_fwrite_header( archive , 0 );
+  return archive;
+}
+
+
+/*
+  Compresses all the pending blocks in parallel, and then writes them
+  to file in order.
+*/
+
+static void ecl_archive_flush( ecl_archive_type * archive ) {
+  int i;
+  ecl_archive_run_blocks( archive , archive->pending , archive->num_pending , true );
+  
+  util_fseek( archive->stream , archive->data_offset , SEEK_SET );
+  for (i=0; i < archive->num_pending; i++) {
+    archive_block_type * block = &archive->pending[i];
+
+    util_fwrite( block->zdata , 1 , block->zsize , archive->stream , __func__ );
+    long_vector_append( archive->block_offset , archive->data_offset );
+    int_vector_append( archive->block_zsize , block->zsize );
+    int_vector_append( archive->block_data_size , block->data_size );
+    int_vector_append( archive->block_crc , (int) block->crc );
+    archive->data_offset += block->zsize;
+
+    free( block->data );
+    free( block->zdata );
+  }
+  archive->num_pending = 0;
+}
+
+
+void ecl_archive_add_kw( ecl_archive_type * archive , const ecl_kw_type * ecl_kw ) {
+  if (!archive->writer)
+    util_abort("%s: archive:%s is not opened for writing \n",__func__ , archive->filename);
+  {
+    ecl_type_enum ecl_type = ecl_kw_get_type( ecl_kw );
+    size_t byte_size = (size_t) ecl_kw_get_size( ecl_kw ) * ecl_util_get_sizeof_ctype( ecl_type );
+    const char * data = ecl_kw_get_void_ptr( ecl_kw );
+    int num_blocks = (byte_size + archive->block_size - 1) / archive->block_size;
+    int iblock;
+
+    stringlist_append_copy( archive->kw_header , ecl_kw_get_header( ecl_kw ));
+    int_vector_append( archive->kw_type , ecl_type );
+    int_vector_append( archive->kw_size , ecl_kw_get_size( ecl_kw ));
+    int_vector_append( archive->kw_first_block , long_vector_size( archive->block_offset ) + archive->num_pending );
+    int_vector_append( archive->kw_num_blocks , num_blocks );
+
+    for (iblock = 0; iblock < num_blocks; iblock++) {
+      size_t offset = (size_t) iblock * archive->block_size;
+      archive_block_type * block = &archive->pending[ archive->num_pending ];
+
+      block->data_size = util_size_t_min( archive->block_size , byte_size - offset );
+      block->data = util_alloc_copy( &data[offset] , block->data_size );
+      archive->num_pending++;
+
+      if (archive->num_pending == archive->max_pending)
+        ecl_archive_flush( archive );
+    }
+  }
+}
+
+
+static void ecl_archive_fwrite_index( ecl_archive_type * archive ) {
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int i;
+
+  buffer_fwrite_int( buffer , stringlist_get_size( archive->kw_header ));
+  for (i=0; i < stringlist_get_size( archive->kw_header ); i++) {
+    buffer_fwrite_string( buffer , stringlist_iget( archive->kw_header , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->kw_type , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->kw_size , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->kw_first_block , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->kw_num_blocks , i ));
+  }
+
+  buffer_fwrite_int( buffer , long_vector_size( archive->block_offset ));
+  for (i=0; i < long_vector_size( archive->block_offset ); i++) {
+    offset_type offset = long_vector_iget( archive->block_offset , i );
+    buffer_fwrite( buffer , &offset , sizeof offset , 1 );
+    buffer_fwrite_int( buffer , int_vector_iget( archive->block_zsize , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->block_data_size , i ));
+    buffer_fwrite_int( buffer , int_vector_iget( archive->block_crc , i ));
+  }
+  {
+    unsigned int index_crc = ecl_archive_crc( buffer_get_data( buffer ) , buffer_get_size( buffer ));
+    buffer_fwrite( buffer , &index_crc , sizeof index_crc , 1 );
+  }
+
+  util_fseek( archive->stream , archive->data_offset , SEEK_SET );
+  buffer_stream_fwrite_n( buffer , 0 , buffer_get_size( buffer ) , archive->stream );
+  ecl_archive_fwrite_header( archive , archive->data_offset );
+  buffer_free( buffer );
+}
+
+
+/*
+  Checks that the index describes the file as it is written by
+  ecl_archive_flush(): the blocks follow each other from the end of
+  the header to @index_offset, each keyword has the blocks following
+  those of the previous keyword, and the blocks of a keyword hold
+  exactly the data of the keyword. With this checked the blocks can be
+  read and uncompressed into the keyword storage without further
+  checks.
+*/
+
+static bool ecl_archive_index_ok( const ecl_archive_type * archive , offset_type index_offset ) {
+  int num_blocks = long_vector_size( archive->block_offset );
+  offset_type offset = ECL_ARCHIVE_HEADER_SIZE;
+  int next_block = 0;
+  int i;
+
+  if (archive->block_size <= 0)
+    return false;
+
+  for (i=0; i < num_blocks; i++) {
+    int zsize     = int_vector_iget( archive->block_zsize , i );
+    int data_size = int_vector_iget( archive->block_data_size , i );
+    
+    if ((long_vector_iget( archive->block_offset , i ) != offset) || (zsize < 0) || (data_size <= 0) || (data_size > archive->block_size))
+      return false;
+    offset += zsize;
+  }
+  if (offset != index_offset)
+    return false;
+  
+  for (i=0; i < stringlist_get_size( archive->kw_header ); i++) {
+    ecl_type_enum ecl_type = int_vector_iget( archive->kw_type , i );
+    int kw_size            = int_vector_iget( archive->kw_size , i );
+    int first_block        = int_vector_iget( archive->kw_first_block , i );
+    int kw_blocks          = int_vector_iget( archive->kw_num_blocks , i );
+    
+    if ((ecl_type < ECL_CHAR_TYPE) || (ecl_type > ECL_MESS_TYPE) || (kw_size < 0))
+      return false;
+    
+    if ((first_block != next_block) || (kw_blocks < 0) || (kw_blocks > num_blocks - first_block))
+      return false;
+    
+    {
+      size_t byte_size = (size_t) kw_size * ecl_util_get_sizeof_ctype( ecl_type );
+      size_t data_size = 0;
+      int iblock;
+      
+      if (kw_blocks != (byte_size + archive->block_size - 1) / archive->block_size)
+        return false;
+      
+      for (iblock = first_block; iblock < first_block + kw_blocks; iblock++) {
+        if ((iblock < first_block + kw_blocks - 1) && (int_vector_iget( archive->block_data_size , iblock ) != archive->block_size))
+          return false;
+        data_size += int_vector_iget( archive->block_data_size , iblock );
+      }
+      if (data_size != byte_size)
+        return false;
+    }
+    next_block += kw_blocks;
+  }
+  return (next_block == num_blocks);
+}
+
+
+/*
+  The index is only parsed if the checksum at the end of the index is
+  correct; i.e. the index has been written by ecl_archive_close() and
+  not modified since.
+*/
+
+static bool ecl_archive_fread_index( ecl_archive_type * archive , buffer_type * buffer , offset_type index_offset ) {
+  const char * index_data = buffer_get_data( buffer );
+  size_t index_size = buffer_get_size( buffer );
+  unsigned int index_crc;
+  int num_kw , num_blocks;
+  int i;
+
+  if (index_size < 2 * sizeof(int) + sizeof index_crc)
+    return false;
+  
+  index_size -= sizeof index_crc;
+  memcpy( &index_crc , &index_data[ index_size ] , sizeof index_crc );
+  if (index_crc != ecl_archive_crc( index_data , index_size ))
+    return false;
+
+  /* Every keyword entry holds at least six ints, every block entry an offset and three ints. */
+  num_kw = buffer_fread_int( buffer );
+  if ((num_kw < 0) || (num_kw > index_size / (6 * sizeof(int))))
+    return false;
+  for (i=0; i < num_kw; i++) {
+    stringlist_append_copy( archive->kw_header , buffer_fread_string( buffer ));
+    int_vector_append( archive->kw_type , buffer_fread_int( buffer ));
+    int_vector_append( archive->kw_size , buffer_fread_int( buffer ));
+    int_vector_append( archive->kw_first_block , buffer_fread_int( buffer ));
+    int_vector_append( archive->kw_num_blocks , buffer_fread_int( buffer ));
+  }
+
+  num_blocks = buffer_fread_int( buffer );
+  if ((num_blocks < 0) || (num_blocks > index_size / (sizeof(offset_type) + 3 * sizeof(int))))
+    return false;
+  for (i=0; i < num_blocks; i++) {
+    offset_type offset;
+    buffer_fread( buffer , &offset , sizeof offset , 1 );
+    long_vector_append( archive->block_offset , offset );
+    int_vector_append( archive->block_zsize , buffer_fread_int( buffer ));
+    int_vector_append( archive->block_data_size , buffer_fread_int( buffer ));
+    int_vector_append( archive->block_crc , buffer_fread_int( buffer ));
+  }
+  
+  if (buffer_get_offset( buffer ) != index_size)
+    return false;
+
+  return ecl_archive_index_ok( archive , index_offset );
+}
+
+
+/*
+  Will read the header of @stream, and return the offset of the index
+  if this is an ecl_archive file; otherwise -1 is returned.
+*/
+
+static offset_type ecl_archive_fread_header( FILE * stream , int * block_size ) {
+  int id = 0;
+  int version = 0;
+  offset_type index_offset = -1;
+
+  if (fread( &id , sizeof id , 1 , stream ) == 1 && (id == ECL_ARCHIVE_ID)) {
+    if (fread( &version , sizeof version , 1 , stream ) == 1 && (version == ECL_ARCHIVE_VERSION)) {
+      if ((fread( block_size , sizeof * block_size , 1 , stream ) == 1) &&
+          (fread( &index_offset , sizeof index_offset , 1 , stream ) == 1)) {
+        if (index_offset < ECL_ARCHIVE_HEADER_SIZE)
+          index_offset = -1;
+      }
+    }
+  }
+  return index_offset;
+}
+
+
+bool ecl_archive_is_archive( const char * filename ) {
+  bool is_archive = false;
+  FILE * stream = util_fopen__( filename , "r");
+  if (stream != NULL) {
+    int block_size;
+    is_archive = (ecl_archive_fread_header( stream , &block_size ) > 0);
+    fclose( stream );
+  }
+  return is_archive;
+}
+
+
+/**
+   Will open an existing archive for reading; will return NULL if
+   @filename is not a (complete) ecl_archive file.
+*/
+
+ecl_archive_type * ecl_archive_open( const char * filename ) {
+  FILE * stream = util_fopen__( filename , "r");
+  if (stream != NULL) {
+    int block_size;
+    offset_type index_offset = ecl_archive_fread_header( stream , &block_size );
+    offset_type file_size = util_file_size( filename );
+    
+    if ((index_offset > 0) && (index_offset <= file_size)) {
+      ecl_archive_type * archive = ecl_archive_alloc__( filename , stream , false , block_size );
+      buffer_type * buffer = buffer_alloc( file_size - index_offset );
+      bool index_ok;
+      
+      util_fseek( stream , index_offset , SEEK_SET );
+      buffer_stream_fread( buffer , file_size - index_offset , stream );
+      buffer_rewind( buffer );
+      index_ok = ecl_archive_fread_index( archive , buffer , index_offset );
+      buffer_free( buffer );
+
+      if (index_ok)
+        return archive;
+      
+      ecl_archive_close( archive );
+      return NULL;
+    }
+    fclose( stream );
+  }
+  return NULL;
+}
+
+
+void ecl_archive_close( ecl_archive_type * archive ) {
+  if (archive->writer) {
+    if (archive->num_pending > 0)
+      ecl_archive_flush( archive );
+    ecl_archive_fwrite_index( archive );
+  }
+  fclose( archive->stream );
+  
+  stringlist_free( archive->kw_header );
+  int_vector_free( archive->kw_type );
+  int_vector_free( archive->kw_size );
+  int_vector_free( archive->kw_first_block );
+  int_vector_free( archive->kw_num_blocks );
+  long_vector_free( archive->block_offset );
+  int_vector_free( archive->block_zsize );
+  int_vector_free( archive->block_data_size );
+  int_vector_free( archive->block_crc );
+  util_safe_free( archive->pending );
+  free( archive->filename );
+  free( archive );
+}
+
+/*****************************************************************/
+
+const char * ecl_archive_get_filename( const ecl_archive_type * archive ) {
+  return archive->filename;
+}
+
+int ecl_archive_get_size( const ecl_archive_type * archive ) {
+  return stringlist_get_size( archive->kw_header );
+}
+
+int ecl_archive_get_block_size( const ecl_archive_type * archive ) {
+  return archive->block_size;
+}
+
+int ecl_archive_get_num_blocks( const ecl_archive_type * archive ) {
+  return long_vector_size( archive->block_offset );
+}
+
+
+/*
+  The total size of the blocks which have been written, before and
+  after compression respectively.
+*/
+
+size_t ecl_archive_get_data_size( const ecl_archive_type * archive ) {
+  size_t data_size = 0;
+  int i;
+  for (i=0; i < int_vector_size( archive->block_data_size ); i++)
+    data_size += int_vector_iget( archive->block_data_size , i );
+  return data_size;
+}
+
+size_t ecl_archive_get_compressed_size( const ecl_archive_type * archive ) {
+  size_t compressed_size = 0;
+  int i;
+  for (i=0; i < int_vector_size( archive->block_zsize ); i++)
+    compressed_size += int_vector_iget( archive->block_zsize , i );
+  return compressed_size;
+}
+
+const char * ecl_archive_iget_header( const ecl_archive_type * archive , int index ) {
+  return stringlist_iget( archive->kw_header , index );
+}
+
+ecl_type_enum ecl_archive_iget_type( const ecl_archive_type * archive , int index ) {
+  return int_vector_iget( archive->kw_type , index );
+}
+
+int ecl_archive_iget_size( const ecl_archive_type * archive , int index ) {
+  return int_vector_iget( archive->kw_size , index );
+}
+
+
+/*
+  Will read and uncompress the blocks of keyword nr @index into the
+  storage @data; the return value is false if any of the blocks has
+  the wrong checksum.
+*/
+
+static bool ecl_archive_iload_data( ecl_archive_type * archive , int index , char * data ) {
+  int first_block = int_vector_iget( archive->kw_first_block , index );
+  int num_blocks  = int_vector_iget( archive->kw_num_blocks , index );
+  bool data_ok = true;
+
+  if (archive->writer)
+    util_abort("%s: archive:%s is opened for writing \n",__func__ , archive->filename);
+
+  if (num_blocks > 0) {
+    int last_block = first_block + num_blocks - 1;
+    offset_type start = long_vector_iget( archive->block_offset , first_block );
+    offset_type end   = long_vector_iget( archive->block_offset , last_block ) + int_vector_iget( archive->block_zsize , last_block );
+    unsigned char * zbuffer = util_malloc( end - start );
+    archive_block_type * block_list = util_calloc( num_blocks , sizeof * block_list );
+    int i;
+    
+    /* The blocks of one keyword are consecutive in the file. */
+    util_fseek( archive->stream , start , SEEK_SET );
+    util_fread( zbuffer , 1 , end - start , archive->stream , __func__ );
+    
+    for (i=0; i < num_blocks; i++) {
+      archive_block_type * block = &block_list[i];
+      int iblock = first_block + i;
+
+      block->zdata     = &zbuffer[ long_vector_iget( archive->block_offset , iblock ) - start ];
+      block->zsize     = int_vector_iget( archive->block_zsize , iblock );
+      block->data      = &data[ (size_t) i * archive->block_size ];
+      block->data_size = int_vector_iget( archive->block_data_size , iblock );
+      block->crc       = (unsigned int) int_vector_iget( archive->block_crc , iblock );
+    }
+    ecl_archive_run_blocks( archive , block_list , num_blocks , false );
+    
+    for (i=0; i < num_blocks; i++)
+      data_ok = data_ok && block_list[i].data_ok;
+    
+    free( block_list );
+    free( zbuffer );
+  }
+  return data_ok;
+}
+
+
+/**
+   Will load keyword nr @index from the archive; the function will
+   abort if the stored checksums do not match the data. The calling
+   scope takes ownership of the keyword.
+*/
+
+ecl_kw_type * ecl_archive_iget_kw( ecl_archive_type * archive , int index ) {
+  ecl_kw_type * ecl_kw = ecl_kw_alloc( ecl_archive_iget_header( archive , index ) ,
+                                       ecl_archive_iget_size( archive , index ) ,
+                                       ecl_archive_iget_type( archive , index ));
+  
+  if (!ecl_archive_iload_data( archive , index , ecl_kw_get_void_ptr( ecl_kw )))
+    util_abort("%s: checksum error in keyword:%s nr:%d in archive:%s \n",__func__ , ecl_kw_get_header( ecl_kw ) , index , archive->filename );
+
+  return ecl_kw;
+}
+
+
+/**
+   Will read and uncompress all the data in the archive and verify
+   the checksums; returns false if any errors are found.
+*/
+
+bool ecl_archive_verify( ecl_archive_type * archive ) {
+  int index;
+  for (index = 0; index < ecl_archive_get_size( archive ); index++) {
+    size_t byte_size = (size_t) ecl_archive_iget_size( archive , index ) * ecl_util_get_sizeof_ctype( ecl_archive_iget_type( archive , index ));
+    char * data = util_malloc( util_size_t_max( byte_size , 1 ));
+    bool data_ok = ecl_archive_iload_data( archive , index , data );
+    
+    free( data );
+    if (!data_ok)
+      return false;
+  }
+  return true;
+}
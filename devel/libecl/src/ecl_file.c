@@ -27,6 +27,8 @@
 #include <ert/util/vector.h>
 #include <ert/util/int_vector.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/buffer.h>
+#include <ert/util/long_vector.h>
 
 #include <ert/ecl/fortio.h>
 #include <ert/ecl/ecl_kw.h>
@@ -35,6 +37,8 @@
 #include <ert/ecl/ecl_kw_magic.h>
 #include <ert/ecl/ecl_rsthead.h>
 #include <ert/ecl/ecl_file_kw.h>
+#include <ert/ecl/ecl_kw_prefetch.h>
+#include <ert/ecl/ecl_archive.h>
 
 
 /**
@@ -125,6 +129,14 @@
 
 
 typedef struct file_map_struct file_map_type;
+typedef struct rst_index_struct rst_index_type;
+
+/* The rst_index functions are implemented in ecl_rstfile.c. */
+static void             rst_index_free( rst_index_type * rst_index );
+static void             rst_index_buffer_fwrite( const rst_index_type * rst_index , buffer_type * buffer );
+static rst_index_type * rst_index_buffer_alloc( buffer_type * buffer );
+static rst_index_type * file_map_get_rst_index( const file_map_type * file_map );
+
 struct file_map_struct {
   vector_type       * kw_list;      /* This is a vector of ecl_file_kw instances corresponding to the content of the file. */
   hash_type         * kw_index;     /* A hash table with integer vectors of indices - see comment below. */
@@ -132,6 +144,9 @@ struct file_map_struct {
   fortio_type       * fortio;       /* The same fortio instance pointer as in the ecl_file styructure. */
   bool                owner;        /* Is this map the owner of the ecl_file_kw instances; only true for the global_map. */
   inv_map_type     *  inv_map;       /* Shared reference owned by the ecl_file structure. */
+  ecl_kw_prefetch_type * prefetch;  /* Shared reference owned by the ecl_file structure; NULL unless ECL_FILE_PREFETCH is set. */
+  ecl_archive_type  * archive;      /* Shared reference owned by the ecl_file structure; NULL unless the file is an ecl_archive. */
+  rst_index_type    * rst_index;    /* Restart block index; created on demand by file_map_get_rst_index(). */
   int                 flags;
 };
 
@@ -148,6 +163,9 @@ struct ecl_file_struct {
   int             flags;
   vector_type   * map_stack;
   inv_map_type  * inv_map;
+  ecl_kw_prefetch_type * prefetch;
+  ecl_archive_type     * archive;   /* Alternative source of the keywords, used instead of fortio when
+                                       the file is an ecl_archive. */
 };
 
 
@@ -200,6 +218,9 @@ static file_map_type * file_map_alloc( fortio_type * fortio , int flags , inv_ma
   file_map->fortio             = fortio;
   file_map->inv_map            = inv_map;
   file_map->flags              = flags;
+  file_map->prefetch           = NULL;
+  file_map->archive            = NULL;
+  file_map->rst_index          = NULL;
   return file_map;
 }
 
@@ -221,6 +242,10 @@ static int file_map_get_global_index( const file_map_type * file_map , const cha
 
 
 static void file_map_make_index( file_map_type * file_map ) {
+  if (file_map->rst_index != NULL) {
+    rst_index_free( file_map->rst_index );
+    file_map->rst_index = NULL;
+  }
   stringlist_clear( file_map->distinct_kw );
   hash_clear( file_map->kw_index );
   {
@@ -260,9 +285,46 @@ static ecl_file_kw_type * file_map_iget_named_file_kw( const file_map_type * fil
 
 
 
-static ecl_kw_type * file_map_iget_kw( const file_map_type * file_map , int index) {
-  ecl_file_kw_type * file_kw = file_map_iget_file_kw( file_map , index );
+/*
+  For a keyword which is not yet loaded: if the file is prefetched
+  and the keyword has already been read by the prefetch thread it is
+  installed in the file_kw instance and returned; otherwise NULL is
+  returned and the keyword must be read from the fortio instance.
+*/
+
+static ecl_kw_type * file_map_get_prefetch_kw( const file_map_type * file_map , ecl_file_kw_type * file_kw ) {
+  ecl_kw_type * ecl_kw = NULL;
+  if (file_map->prefetch != NULL) {
+    ecl_kw = ecl_kw_prefetch_get_kw( file_map->prefetch , ecl_file_kw_get_offset( file_kw ));
+    if (ecl_kw != NULL)
+      ecl_file_kw_set_kw( file_kw , ecl_kw , file_map->inv_map );
+  }
+  return ecl_kw;
+}
+
+
+/*
+  For a file backed by an ecl_archive the keyword is uncompressed from
+  the archive; the offset of the file_kw instances is the index of
+  the keyword in the archive.
+*/
+
+static ecl_kw_type * file_map_get_archive_kw( const file_map_type * file_map , ecl_file_kw_type * file_kw ) {
+  ecl_kw_type * ecl_kw = ecl_archive_iget_kw( file_map->archive , ecl_file_kw_get_offset( file_kw ));
+  ecl_file_kw_set_kw( file_kw , ecl_kw , file_map->inv_map );
+  return ecl_kw;
+}
+
+
+static ecl_kw_type * file_map_get_file_kw_kw( const file_map_type * file_map , ecl_file_kw_type * file_kw ) {
   ecl_kw_type * ecl_kw = ecl_file_kw_get_kw_ptr( file_kw , file_map->fortio , file_map->inv_map);
+  if (!ecl_kw) {
+    if (file_map->archive != NULL)
+      return file_map_get_archive_kw( file_map , file_kw );
+    
+    ecl_kw = file_map_get_prefetch_kw( file_map , file_kw );
+  }
+
   if (!ecl_kw) {
     if (fortio_assert_stream_open( file_map->fortio )) {
       
@@ -276,23 +338,12 @@ static ecl_kw_type * file_map_iget_kw( const file_map_type * file_map , int inde
 }
 
 
-static int file_map_find_kw_value( const file_map_type * file_map , const char * kw , const void * value) {
-  int global_index = -1;
-  if ( file_map_has_kw( file_map , kw)) {
-    const int_vector_type * index_list = hash_get( file_map->kw_index , kw );
-    int index = 0;
-    while (index < int_vector_size( index_list )) {
-      const ecl_kw_type * ecl_kw = file_map_iget_kw( file_map , int_vector_iget( index_list , index ));
-      if (ecl_kw_data_equal( ecl_kw , value )) {
-        global_index = int_vector_iget( index_list , index );
-        break;
-      }
-      index++;
-    }
-  }
-  return global_index;
+static ecl_kw_type * file_map_iget_kw( const file_map_type * file_map , int index) {
+  ecl_file_kw_type * file_kw = file_map_iget_file_kw( file_map , index );
+  return file_map_get_file_kw_kw( file_map , file_kw );
 }
 
+
 static const char * file_map_iget_distinct_kw( const file_map_type * file_map , int index) {
   return stringlist_iget( file_map->distinct_kw , index);
 }
@@ -324,17 +375,7 @@ static const char * file_map_iget_header( const file_map_type * file_map , int i
 
 static ecl_kw_type * file_map_iget_named_kw( const file_map_type * file_map , const char * kw, int ith) {
   ecl_file_kw_type * file_kw = file_map_iget_named_file_kw( file_map , kw , ith);
-  ecl_kw_type * ecl_kw = ecl_file_kw_get_kw_ptr( file_kw , file_map->fortio , file_map->inv_map );
-  if (!ecl_kw) {
-    if (fortio_assert_stream_open( file_map->fortio )) {
-      
-      ecl_kw = ecl_file_kw_get_kw( file_kw , file_map->fortio , file_map->inv_map);
-      
-      if (FILE_FLAGS_SET( file_map->flags , ECL_FILE_CLOSE_STREAM))
-        fortio_fclose_stream( file_map->fortio );
-    }
-  }
-  return ecl_kw;
+  return file_map_get_file_kw_kw( file_map , file_kw );
 }
 
 static ecl_type_enum file_map_iget_named_type( const file_map_type * file_map , const char * kw , int ith) {
@@ -375,10 +416,19 @@ static void file_map_replace_kw( file_map_type * file_map , ecl_kw_type * old_kw
 static bool file_map_load_all( file_map_type * file_map ) {
   bool loadOK = false;
   
+  if (file_map->archive != NULL) {
+    int index;
+    for (index = 0; index < vector_get_size( file_map->kw_list); index++) 
+      file_map_iget_kw( file_map , index );
+    return true;
+  }
+
   if (fortio_assert_stream_open( file_map->fortio )) {
     int index;
     for (index = 0; index < vector_get_size( file_map->kw_list); index++) {
       ecl_file_kw_type * ikw = vector_iget( file_map->kw_list , index );
+      if (!ecl_file_kw_get_kw_ptr( ikw , file_map->fortio , file_map->inv_map ))
+        file_map_get_prefetch_kw( file_map , ikw );
       ecl_file_kw_get_kw( ikw , file_map->fortio , file_map->inv_map);
     }
     loadOK = true;
@@ -403,6 +453,8 @@ static void file_map_add_kw( file_map_type * file_map , ecl_file_kw_type * file_
 }
 
 static void file_map_free( file_map_type * file_map ) {
+  if (file_map->rst_index != NULL)
+    rst_index_free( file_map->rst_index );
   hash_free( file_map->kw_index );
   stringlist_free( file_map->distinct_kw );
   vector_free( file_map->kw_list );
@@ -471,6 +523,8 @@ static void file_map_fprintf_kw_list(const file_map_type * file_map , FILE * str
 static file_map_type * file_map_alloc_blockmap(const file_map_type * file_map , const char * header, int occurence) {
   if (file_map_get_num_named_kw( file_map , header ) > occurence) {
     file_map_type * block_map = file_map_alloc( file_map->fortio , file_map->flags , file_map->inv_map , false);
+    block_map->prefetch = file_map->prefetch;
+    block_map->archive  = file_map->archive;
     if (file_map_has_kw( file_map , header )) {
       int kw_index = file_map_get_global_index( file_map , header , occurence );
       ecl_file_kw_type * file_kw = vector_iget( file_map->kw_list , kw_index );
@@ -511,6 +565,9 @@ ecl_file_type * ecl_file_alloc_empty( int flags ) {
   ecl_file->map_stack = vector_alloc_new();
   ecl_file->inv_map   = inv_map_alloc( );
   ecl_file->flags     = flags;
+  ecl_file->prefetch  = NULL;
+  ecl_file->archive   = NULL;
+  ecl_file->fortio    = NULL;
   return ecl_file;
 }
 
@@ -642,6 +699,8 @@ void ecl_file_fwrite(const ecl_file_type * ecl_file , const char * filename, boo
 
 
 void ecl_file_replace_kw( ecl_file_type * ecl_file , ecl_kw_type * old_kw , ecl_kw_type * new_kw , bool insert_copy) {
+  if (ecl_file->archive != NULL)
+    util_abort("%s: the archive file:%s can not be updated \n",__func__ , ecl_archive_get_filename( ecl_file->archive ));
   file_map_replace_kw( ecl_file->active_map , old_kw , new_kw , insert_copy );
 }
 
@@ -722,7 +781,10 @@ const char * ecl_file_iget_distinct_kw(const ecl_file_type * ecl_file, int index
 
 
 const char * ecl_file_get_src_file( const ecl_file_type * ecl_file ) {
-  return fortio_filename_ref( ecl_file->fortio );
+  if (ecl_file->archive != NULL)
+    return ecl_archive_get_filename( ecl_file->archive );
+  else
+    return fortio_filename_ref( ecl_file->fortio );
 }
 
 
@@ -839,34 +901,312 @@ static void ecl_file_scan( ecl_file_type * ecl_file ) {
 }
 
 
+/*****************************************************************/
+/*
+  The index file: When the ECL_FILE_USE_INDEX flag is set the keyword
+  headers found by ecl_file_scan() are stored in the file
+  'filename.idx', and on subsequent opens the global map is created
+  from the index file with one read instead of scanning through the
+  whole file. The index file has the layout:
+
+     ECL_FILE_INDEX_ID | version | index size | file size | file mtime | num_kw | file_kw ... | rst_index
+
+  The trailing rst_index is the restart block index (see
+  ecl_rstfile.c), so that restart blocks can be selected by report
+  step or simulation time without reading any keywords from the file.
+
+  The index is only used if the size and the modification time of the
+  source file are unchanged since the index was created; otherwise
+  the file is scanned and the index file is recreated. Failure to
+  write the index file, e.g. in a readonly directory, is silently
+  ignored.
+*/
+
+#define ECL_FILE_INDEX_ID       776108
+#define ECL_FILE_INDEX_VERSION  3
+
+static char * ecl_file_alloc_index_filename( const char * filename ) {
+  return util_alloc_sprintf("%s.idx" , filename );
+}
+
+
+static bool ecl_file_index_fread_header( buffer_type * buffer , const char * filename ) {
+  if (buffer_get_size( buffer ) < 3 * sizeof(int) + sizeof(size_t))
+    return false;
+
+  if (buffer_fread_int( buffer ) != ECL_FILE_INDEX_ID)
+    return false;
+
+  if (buffer_fread_int( buffer ) != ECL_FILE_INDEX_VERSION)
+    return false;
+  
+  {
+    size_t index_size;
+    buffer_fread( buffer , &index_size , sizeof index_size , 1 );
+    if (index_size != buffer_get_size( buffer ))
+      return false;
+  }
+
+  {
+    size_t file_size;
+    time_t file_mtime;
+
+    buffer_fread( buffer , &file_size , sizeof file_size , 1 );
+    file_mtime = buffer_fread_time_t( buffer );
+    
+    if (file_size != util_file_size( filename ))
+      return false;
+    
+    if (file_mtime != util_file_mtime( filename ))
+      return false;
+  }
+
+  return true;
+}
+
+
+static bool ecl_file_load_index( ecl_file_type * ecl_file , const char * index_file , const char * filename) {
+  bool index_loaded = false;
+
+  if (util_file_exists( index_file )) {
+    buffer_type * buffer = buffer_fread_alloc( index_file );
+    
+    if (ecl_file_index_fread_header( buffer , filename )) {
+      int num_kw = buffer_fread_int( buffer );
+      int ikw;
+      
+      for (ikw = 0; ikw < num_kw; ikw++) 
+        file_map_add_kw( ecl_file->global_map , ecl_file_kw_buffer_alloc( buffer ));
+      
+      file_map_make_index( ecl_file->global_map );
+      ecl_file->global_map->rst_index = rst_index_buffer_alloc( buffer );
+      index_loaded = true;
+    }
+
+    buffer_free( buffer );
+  }
+  
+  return index_loaded;
+}
+
+
+/*
+  The index is written to a temporary file which is then renamed, so
+  that other processes opening the same file concurrently will never
+  see a partly written index.
+*/
+
+static void ecl_file_save_index( const ecl_file_type * ecl_file , const char * index_file , const char * filename) {
+  buffer_type * buffer = buffer_alloc( 1024 );
+  size_t index_size = 0;
+  
+  buffer_fwrite_int( buffer , ECL_FILE_INDEX_ID );
+  buffer_fwrite_int( buffer , ECL_FILE_INDEX_VERSION );
+  buffer_fwrite( buffer , &index_size , sizeof index_size , 1 );
+  {
+    size_t file_size = util_file_size( filename );
+    buffer_fwrite( buffer , &file_size , sizeof file_size , 1 );
+    buffer_fwrite_time_t( buffer , util_file_mtime( filename ));
+  }
+  
+  {
+    const file_map_type * global_map = ecl_file->global_map;
+    int num_kw = vector_get_size( global_map->kw_list );
+    int ikw;
+
+    buffer_fwrite_int( buffer , num_kw );
+    for (ikw = 0; ikw < num_kw; ikw++) 
+      ecl_file_kw_buffer_fwrite( file_map_iget_file_kw( global_map , ikw ) , buffer );
+    
+    rst_index_buffer_fwrite( file_map_get_rst_index( global_map ) , buffer );
+  }
+  
+  index_size = buffer_get_size( buffer );
+  buffer_fseek( buffer , 2 * sizeof(int) , SEEK_SET );
+  buffer_fwrite( buffer , &index_size , sizeof index_size , 1 );
+  
+  {
+    char * path;
+    char * tmp_file;
+    FILE * stream;
+    
+    util_alloc_file_components( index_file , &path , NULL , NULL );
+    tmp_file = util_alloc_tmp_file( (path == NULL) ? "." : path , "ecl_file_index" , true );
+    stream = util_fopen__( tmp_file , "w");
+    if (stream != NULL) {
+      bool write_ok = (fwrite( buffer_get_data( buffer ) , 1 , index_size , stream ) == index_size);
+      
+      if (fclose( stream ) != 0)
+        write_ok = false;
+      
+      if (!write_ok || (rename( tmp_file , index_file ) != 0))
+        util_unlink_existing( tmp_file );
+    }
+    util_safe_free( path );
+    free( tmp_file );
+  }
+  
+  buffer_free( buffer );
+}
+
+
+static void ecl_file_scan_or_load_index( ecl_file_type * ecl_file ) {
+  if (FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_USE_INDEX )) {
+    const char * filename = fortio_filename_ref( ecl_file->fortio );
+    char * index_file = ecl_file_alloc_index_filename( filename );
+    
+    if (!ecl_file_load_index( ecl_file , index_file , filename )) {
+      ecl_file_scan( ecl_file );
+      ecl_file_save_index( ecl_file , index_file , filename );
+    }
+    
+    free( index_file );
+  } else
+    ecl_file_scan( ecl_file );
+}
+
+
 void ecl_file_select_global( ecl_file_type * ecl_file ) {
   ecl_file->active_map = ecl_file->global_map;
 }
 
 
+/**
+   Frees all the ecl_kw instances of the currently active map which
+   have been loaded; they will be loaded again from the file if they
+   are asked for. All ecl_kw pointers previously returned for these
+   keywords are invalidated. For a writable file the function does
+   nothing, since the keywords might have been modified in memory.
+*/
+
+void ecl_file_unload_active( ecl_file_type * ecl_file ) {
+  file_map_type * file_map = ecl_file->active_map;
+  if (!FILE_FLAGS_SET( file_map->flags , ECL_FILE_WRITABLE)) {
+    int index;
+    for (index = 0; index < vector_get_size( file_map->kw_list ); index++)
+      ecl_file_kw_drop_kw( vector_iget( file_map->kw_list , index ) , file_map->inv_map );
+  }
+}
+
+
+/**
+   When the ECL_FILE_PREFETCH flag is set a background thread will
+   read the keywords in file order into a buffer of at most
+   ECL_FILE_PREFETCH_SIZE bytes, so that reading from disk overlaps
+   with the processing of the keywords. The flag is ignored for
+   writable files. If ECL_FILE_CLOSE_STREAM is also set the
+   background thread will close its stream whenever it is not reading.
+*/
+
+#define ECL_FILE_PREFETCH_SIZE  (64 * 1024 * 1024)
+
+static void ecl_file_start_prefetch( ecl_file_type * ecl_file , bool fmt_file) {
+  if (FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_PREFETCH ) &&
+      !FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_WRITABLE )) {
+    
+    const file_map_type * global_map = ecl_file->global_map;
+    if (file_map_get_size( global_map ) > 0) {
+      long_vector_type * offset_list = long_vector_alloc( 0 , 0 );
+      int index;
+
+      for (index = 0; index < file_map_get_size( global_map ); index++)
+        long_vector_append( offset_list , ecl_file_kw_get_offset( file_map_iget_file_kw( global_map , index )));
+      
+      ecl_file->prefetch = ecl_kw_prefetch_alloc( fortio_filename_ref( ecl_file->fortio ) ,
+                                                  fmt_file ,
+                                                  FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_CLOSE_STREAM ) ,
+                                                  offset_list ,
+                                                  ECL_FILE_PREFETCH_SIZE );
+      ecl_file->global_map->prefetch = ecl_file->prefetch;
+      long_vector_free( offset_list );
+    }
+  }
+}
+
+
+/**
+   Will return the prefetch instance of the file, which can be queried
+   for hit rate and the number of bytes prefetched; NULL if the
+   ECL_FILE_PREFETCH flag is not in use.
+*/
+
+ecl_kw_prefetch_type * ecl_file_get_prefetch( const ecl_file_type * ecl_file ) {
+  return ecl_file->prefetch;
+}
+
+
 /**
    The fundamental open file function; all alternative open()
    functions start by calling this one. This function will read
    through the complete file, extract all the keyword headers and
    create the map/index stored in the global_map field of the ecl_file
-   structure. No keyword data will be loaded from the file.
+   structure - or load the map from the index file if the
+   ECL_FILE_USE_INDEX flag is set. No keyword data will be loaded from
+   the file.
 
    The ecl_file instance will retain an open fortio reference to the
-   file until ecl_file_close() is called. 
+   file until ecl_file_close() is called. Files written by
+   ecl_archive are recognized, and read through the archive instead.
+*/
+
+
+/**
+   An ecl_archive file is opened without any fortio instance; the
+   global map is created from the keyword index of the archive, and
+   the keywords are uncompressed from the archive on demand. The
+   archive files are read only.
 */
 
+static ecl_file_type * ecl_file_open_archive__( const char * filename , int flags) {
+  ecl_archive_type * archive;
+  
+  if (FILE_FLAGS_SET(flags , ECL_FILE_WRITABLE))
+    util_abort("%s: the archive file:%s can not be opened for writing \n",__func__ , filename);
+
+  archive = ecl_archive_open( filename );
+  if (archive) {
+    ecl_file_type * ecl_file = ecl_file_alloc_empty( flags );
+    int index;
+
+    ecl_file->archive = archive;
+    ecl_file->global_map = file_map_alloc( NULL , ecl_file->flags , ecl_file->inv_map , true );
+    ecl_file->global_map->archive = archive;
+    ecl_file_add_map( ecl_file , ecl_file->global_map );
+
+    for (index = 0; index < ecl_archive_get_size( archive ); index++) {
+      ecl_file_kw_type * file_kw = ecl_file_kw_alloc_header( ecl_archive_iget_header( archive , index ) , 
+                                                             ecl_archive_iget_type( archive , index ) , 
+                                                             ecl_archive_iget_size( archive , index ) , 
+                                                             index );
+      file_map_add_kw( ecl_file->global_map , file_kw );
+    }
+    file_map_make_index( ecl_file->global_map );
+    ecl_file_select_global( ecl_file );
+    return ecl_file;
+  } else
+    return NULL;
+}
+
+
+static fortio_type * ecl_file_open_fortio( const char * filename , bool fmt_file , int flags) {
+  if (FILE_FLAGS_SET(flags , ECL_FILE_WRITABLE))
+    return fortio_open_readwrite( filename , fmt_file , ECL_ENDIAN_FLIP);
+  else 
+    return fortio_open_reader( filename , fmt_file , ECL_ENDIAN_FLIP);      
+}
+
 
 static ecl_file_type * ecl_file_open__( const char * filename , int flags) {
   fortio_type * fortio;
   bool          fmt_file;
 
+  if (ecl_archive_is_archive( filename ))
+    return ecl_file_open_archive__( filename , flags );
+
   ecl_util_fmt_file( filename , &fmt_file);
   //flags |= ECL_FILE_CLOSE_STREAM;   // DEBUG DEBUG DEBUG
   
-  if (FILE_FLAGS_SET(flags , ECL_FILE_WRITABLE))
-    fortio = fortio_open_readwrite( filename , fmt_file , ECL_ENDIAN_FLIP);
-  else 
-    fortio = fortio_open_reader( filename , fmt_file , ECL_ENDIAN_FLIP);      
+  fortio = ecl_file_open_fortio( filename , fmt_file , flags );
 
   if (fortio) {
     ecl_file_type * ecl_file = ecl_file_alloc_empty( flags );
@@ -874,8 +1214,9 @@ static ecl_file_type * ecl_file_open__( const char * filename , int flags) {
     ecl_file->global_map = file_map_alloc( ecl_file->fortio , ecl_file->flags , ecl_file->inv_map , true );
     
     ecl_file_add_map( ecl_file , ecl_file->global_map );
-    ecl_file_scan( ecl_file );
+    ecl_file_scan_or_load_index( ecl_file );
     ecl_file_select_global( ecl_file );
+    ecl_file_start_prefetch( ecl_file , fmt_file );
 
     if (FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_CLOSE_STREAM))
       fortio_fclose_stream( ecl_file->fortio );
@@ -902,6 +1243,55 @@ ecl_file_type * ecl_file_try_open( const char * filename, int flags) {
 }
 
 
+/**
+   Will open a new read-only instance of the file behind @src, with
+   the same flags as @src. The keyword index is copied from @src
+   instead of scanning the file again, and no keywords are loaded; the
+   new instance has its own stream and block selection,
+   so the two instances can be used independently from different
+   threads. The ECL_FILE_PREFETCH flag is not copied.
+*/
+
+ecl_file_type * ecl_file_open_clone( const ecl_file_type * src ) {
+  const char * filename = ecl_file_get_src_file( src );
+  int flags = src->flags & ~ECL_FILE_PREFETCH;
+  
+  if (FILE_FLAGS_SET( flags , ECL_FILE_WRITABLE ))
+    util_abort("%s: can not clone the writable file:%s \n",__func__ , filename);
+  
+  if (src->archive != NULL)
+    return ecl_file_open( filename , flags );
+  else {
+    fortio_type * fortio;
+    bool fmt_file;
+    
+    ecl_util_fmt_file( filename , &fmt_file );
+    fortio = ecl_file_open_fortio( filename , fmt_file , flags );
+    if (fortio) {
+      ecl_file_type * ecl_file = ecl_file_alloc_empty( flags );
+      int index;
+      
+      ecl_file->fortio = fortio;
+      ecl_file->global_map = file_map_alloc( ecl_file->fortio , ecl_file->flags , ecl_file->inv_map , true );
+      ecl_file_add_map( ecl_file , ecl_file->global_map );
+      
+      for (index = 0; index < file_map_get_size( src->global_map ); index++)
+        file_map_add_kw( ecl_file->global_map , ecl_file_kw_alloc_copy( file_map_iget_file_kw( src->global_map , index )));
+      file_map_make_index( ecl_file->global_map );
+      ecl_file_select_global( ecl_file );
+      
+      if (FILE_FLAGS_SET( ecl_file->flags , ECL_FILE_CLOSE_STREAM))
+        fortio_fclose_stream( ecl_file->fortio );
+      
+      return ecl_file;
+    } else {
+      util_abort("%s: failed to open ECLIPSE file:%s \n",__func__ , filename);
+      return NULL;
+    }
+  }
+}
+
+
 
 int ecl_file_get_flags( const ecl_file_type * ecl_file ) {
   return ecl_file->flags;
@@ -953,9 +1343,15 @@ bool ecl_file_select_block( ecl_file_type * ecl_file , const char * kw , int occ
 */
 
 void ecl_file_close(ecl_file_type * ecl_file) {
+  if (ecl_file->prefetch != NULL)
+    ecl_kw_prefetch_free( ecl_file->prefetch );
+
   if (ecl_file->fortio != NULL)
     fortio_fclose( ecl_file->fortio  );
   
+  if (ecl_file->archive != NULL)
+    ecl_archive_close( ecl_file->archive );
+  
   inv_map_free( ecl_file->inv_map );
   vector_free( ecl_file->map_list  );
   vector_free( ecl_file->map_stack );
@@ -974,8 +1370,23 @@ void ecl_file_close(ecl_file_type * ecl_file) {
 
 
 void ecl_file_fortio_detach( ecl_file_type * ecl_file ) {
-  fortio_fclose( ecl_file->fortio );
-  ecl_file->fortio = NULL;
+  if (ecl_file->prefetch != NULL)
+    ecl_kw_prefetch_stop( ecl_file->prefetch );
+
+  if (ecl_file->archive != NULL) {
+    int imap;
+    for (imap = 0; imap < vector_get_size( ecl_file->map_list ); imap++) {
+      file_map_type * file_map = vector_iget( ecl_file->map_list , imap );
+      file_map->archive = NULL;
+    }
+    ecl_archive_close( ecl_file->archive );
+    ecl_file->archive = NULL;
+  }
+
+  if (ecl_file->fortio != NULL) {
+    fortio_fclose( ecl_file->fortio );
+    ecl_file->fortio = NULL;
+  }
 }
 
 
@@ -1087,6 +1498,9 @@ bool ecl_file_has_kw_ptr( const ecl_file_type * ecl_file , const ecl_kw_type * e
 
 bool ecl_file_save_kw( const ecl_file_type * ecl_file , const ecl_kw_type * ecl_kw) {
   ecl_file_kw_type * file_kw = inv_map_get_file_kw( ecl_file->inv_map , ecl_kw );  // We just verify that the input ecl_kw points to an ecl_kw 
+  if (ecl_file->archive != NULL)
+    util_abort("%s: the archive file:%s can not be updated \n",__func__ , ecl_archive_get_filename( ecl_file->archive ));
+  
   if (file_kw != NULL) {                                                           // we manage; from then on we use the reference contained in
     if (fortio_assert_stream_open( ecl_file->fortio )) {                           // the corresponding ecl_file_kw instance. 
     
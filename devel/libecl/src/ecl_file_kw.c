@@ -23,6 +23,7 @@
 
 #include <ert/util/size_t_vector.h>
 #include <ert/util/util.h>
+#include <ert/util/buffer.h>
 
 #include <ert/ecl/ecl_util.h>
 #include <ert/ecl/ecl_kw.h>
@@ -165,6 +166,42 @@ ecl_file_kw_type * ecl_file_kw_alloc( const ecl_kw_type * ecl_kw , offset_type o
 }
 
 
+/*
+  As ecl_file_kw_alloc(), but with the header information given
+  explicitly; used when the ecl_file is backed by an ecl_archive,
+  where @offset is the index of the keyword in the archive.
+*/
+
+ecl_file_kw_type * ecl_file_kw_alloc_header( const char * header , ecl_type_enum ecl_type , int size , offset_type offset ) {
+  return ecl_file_kw_alloc__( header , ecl_type , size , offset );
+}
+
+
+/**
+   Serialize/deserialize the header information of the ecl_file_kw
+   instance; this is used when storing the index of an ecl_file to
+   disk. The kw pointer is not stored.
+*/
+
+void ecl_file_kw_buffer_fwrite( const ecl_file_kw_type * file_kw , buffer_type * buffer ) {
+  buffer_fwrite_string( buffer , file_kw->header );
+  buffer_fwrite_int( buffer , file_kw->ecl_type );
+  buffer_fwrite_int( buffer , file_kw->kw_size );
+  buffer_fwrite( buffer , &file_kw->file_offset , sizeof file_kw->file_offset , 1 );
+}
+
+
+ecl_file_kw_type * ecl_file_kw_buffer_alloc( buffer_type * buffer ) {
+  const char * header    = buffer_fread_string( buffer );
+  ecl_type_enum ecl_type = buffer_fread_int( buffer );
+  int kw_size            = buffer_fread_int( buffer );
+  offset_type offset;
+
+  buffer_fread( buffer , &offset , sizeof offset , 1 );
+  return ecl_file_kw_alloc__( header , ecl_type , kw_size , offset );
+}
+
+
 /** 
     Does NOT copy the kw pointer which must be reloaded.
 */
@@ -204,7 +241,12 @@ static void ecl_file_kw_assert_kw( const ecl_file_kw_type * file_kw ) {
 }
 
 
-static void ecl_file_kw_drop_kw( ecl_file_kw_type * file_kw , inv_map_type * inv_map ) {
+/*
+  Frees the ecl_kw instance if it has been loaded; it will be loaded
+  again from the file by the next ecl_file_kw_get_kw() call.
+*/
+
+void ecl_file_kw_drop_kw( ecl_file_kw_type * file_kw , inv_map_type * inv_map ) {
   if (file_kw->kw != NULL) {
     inv_map_drop_kw( inv_map , file_kw->kw );
     ecl_kw_free( file_kw->kw );
@@ -232,6 +274,22 @@ ecl_kw_type * ecl_file_kw_get_kw_ptr( ecl_file_kw_type * file_kw , fortio_type *
   return file_kw->kw;
 }
 
+
+/*
+  Install a keyword which has been loaded by other means than
+  ecl_file_kw_load_kw(), e.g. by the prefetch thread of the
+  ecl_file. The file_kw instance takes ownership of @ecl_kw.
+*/
+
+void ecl_file_kw_set_kw( ecl_file_kw_type * file_kw , ecl_kw_type * ecl_kw , inv_map_type * inv_map) {
+  if (file_kw->kw != NULL) 
+    ecl_file_kw_drop_kw( file_kw , inv_map );
+
+  file_kw->kw = ecl_kw;
+  ecl_file_kw_assert_kw( file_kw );
+  inv_map_add_kw( inv_map , file_kw , file_kw->kw );
+}
+
 /*
   Will return the ecl_kw instance of this file_kw; if it is not
   currently loaded the method will instantiate the ecl_kw instance
@@ -285,6 +343,10 @@ const char * ecl_file_kw_get_header( const ecl_file_kw_type * file_kw ) {
   return file_kw->header;
 }
 
+offset_type ecl_file_kw_get_offset( const ecl_file_kw_type * file_kw ) {
+  return file_kw->file_offset;
+}
+
 int ecl_file_kw_get_size( const ecl_file_kw_type * file_kw ) {
   return file_kw->kw_size;
 }
@@ -562,6 +562,44 @@ static double ecl_grav_survey_eval( const ecl_grav_survey_type * base_survey,
   return deltag;
 }
 
+
+/*
+  Will calculate the total mass difference, summed over all the phases
+  in @phase_mask, for every cell. The returned array should be freed
+  by the calling scope.
+*/
+
+static double * ecl_grav_survey_alloc_mass_diff( const ecl_grav_survey_type * base_survey,
+                                                 const ecl_grav_survey_type * monitor_survey ,
+                                                 int phase_mask) {
+  const int size = ecl_grid_cache_get_size( base_survey->grid_cache );
+  double * mass_diff = util_calloc( size , sizeof * mass_diff );
+  int phase_nr;
+  int index;
+
+  for (index = 0; index < size; index++)
+    mass_diff[index] = 0;
+
+  for (phase_nr = 0; phase_nr < vector_get_size( base_survey->phase_list ); phase_nr++) {
+    const ecl_grav_phase_type * base_phase = vector_iget_const( base_survey->phase_list , phase_nr );
+    if (base_phase->phase & phase_mask) {
+      if (monitor_survey != NULL) {
+        const ecl_grav_phase_type * monitor_phase = vector_iget_const( monitor_survey->phase_list , phase_nr );
+        if (base_phase->phase != monitor_phase->phase)
+          util_abort("%s comparing different phases ... \n",__func__);
+
+        for (index = 0; index < size; index++)
+          mass_diff[index] += monitor_phase->fluid_mass[index] - base_phase->fluid_mass[index];
+      } else {
+        for (index = 0; index < size; index++)
+          mass_diff[index] -= base_phase->fluid_mass[index];
+      }
+    }
+  }
+  return mass_diff;
+}
+
+
 /*****************************************************************/
 /**
    The grid instance is only used during the construction phase. The
@@ -646,6 +684,32 @@ double ecl_grav_eval( const ecl_grav_type * grav , const char * base, const char
 }
 
 
+/**
+   Will evaluate the gravity change for all the @num_stations stations
+   with positions (utm_x[i], utm_y[i], depth[i]) in one pass; the
+   results are stored in @deltag which must have room for
+   @num_stations elements. The mass differences between the two
+   surveys are only calculated once, and all the phases are summed
+   before the sum over the cells - so the results can differ from
+   ecl_grav_eval() in the last digits.
+*/
+
+void ecl_grav_eval_list( const ecl_grav_type * grav , const char * base, const char * monitor , ecl_region_type * region ,
+                         int num_stations , const double * utm_x, const double * utm_y , const double * depth, int phase_mask , double * deltag) {
+  ecl_grav_survey_type * base_survey    = ecl_grav_get_survey( grav , base );
+  ecl_grav_survey_type * monitor_survey = ecl_grav_get_survey( grav , monitor );
+  double * mass_diff = ecl_grav_survey_alloc_mass_diff( base_survey , monitor_survey , phase_mask );
+  int station;
+
+  ecl_grav_common_eval_biot_savart_list( grav->grid_cache , region , grav->aquifer_cell , mass_diff , num_stations , utm_x , utm_y , depth , deltag );
+  /* Scaled to microGal - see ecl_grav_phase_eval(). */
+  for (station = 0; station < num_stations; station++)
+    deltag[station] *= 6.67428E-3;
+
+  free( mass_diff );
+}
+
+
 /******************************************************************/
 /* The functions ecl_grav_new_std_density() and ecl_grav_add_std_density() are
    used to "install" standard conditions densities for the various phases
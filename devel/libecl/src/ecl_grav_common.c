@@ -21,6 +21,12 @@
 #include <stdbool.h>
 #include <math.h>
 
+#ifdef WITH_PTHREAD
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#include <ert/util/arg_pack.h>
+#endif
+
 #include <ert/util/util.h>
 
 #include <ert/ecl/ecl_kw.h>
@@ -96,6 +102,194 @@ double ecl_grav_common_eval_biot_savart( const ecl_grid_cache_type * grid_cache
     }
   }
   return sum;
-}  
+}
+
+
+
+/*
+  Evaluating the sum for many stations in one pass
+  ------------------------------------------------
+
+  The cells which should be included, i.e. the non aquifer cells -
+  in the region if a region is given, are first packed into
+  contiguous position and weight arrays. The sum is then blocked over
+  cells and stations: each block of ECL_GRAV_CELL_BLOCK cells is loaded
+  once for all the stations, and the innermost loop runs over a block
+  of ECL_GRAV_STATION_BLOCK stations with one independent accumulator
+  for each station; that loop is free of dependencies and can be
+  vectorized. For each station the cells are summed in the same order
+  as in ecl_grav_common_eval_biot_savart(), so the results are
+  identical.
+
+  With many stations and cells the stations are distributed over
+  several threads.
+*/
+
+#define ECL_GRAV_CELL_BLOCK       2048
+#define ECL_GRAV_STATION_BLOCK      16
+#define ECL_GRAV_MT_MIN_WORK   5000000     /* Minimum number of cells x stations before threads are used. */
+
+
+static void ecl_grav_common_eval_stations( int num_cells , const double * xpos , const double * ypos , const double * zpos , const double * weight ,
+                                           int station1 , int station2 , const double * utm_x , const double * utm_y , const double * depth , double * sum) {
+  int cell1 , station;
+
+  for (station = station1; station < station2; station++)
+    sum[station] = 0;
+
+  for (cell1 = 0; cell1 < num_cells; cell1 += ECL_GRAV_CELL_BLOCK) {
+    const int cell2 = util_int_min( cell1 + ECL_GRAV_CELL_BLOCK , num_cells );
+    int block1;
 
+    for (block1 = station1; block1 < station2; block1 += ECL_GRAV_STATION_BLOCK) {
+      const int block_size = util_int_min( ECL_GRAV_STATION_BLOCK , station2 - block1 );
+      double block_x[ECL_GRAV_STATION_BLOCK];
+      double block_y[ECL_GRAV_STATION_BLOCK];
+      double block_z[ECL_GRAV_STATION_BLOCK];
+      double block_sum[ECL_GRAV_STATION_BLOCK];
+      int index , s;
 
+      for (s = 0; s < block_size; s++) {
+        block_x[s]   = utm_x[ block1 + s ];
+        block_y[s]   = utm_y[ block1 + s ];
+        block_z[s]   = depth[ block1 + s ];
+        block_sum[s] = sum[ block1 + s ];
+      }
+
+      for (index = cell1; index < cell2; index++) {
+        const double x = xpos[index];
+        const double y = ypos[index];
+        const double z = zpos[index];
+        const double w = weight[index];
+
+        for (s = 0; s < block_size; s++) {
+          double dist_x  = (x - block_x[s] );
+          double dist_y  = (y - block_y[s] );
+          double dist_z  = (z - block_z[s] );
+          double dist    = sqrt( dist_x*dist_x + dist_y*dist_y + dist_z*dist_z );
+
+          block_sum[s] += w * dist_z/(dist * dist * dist );
+        }
+      }
+
+      for (s = 0; s < block_size; s++)
+        sum[ block1 + s ] = block_sum[s];
+    }
+  }
+}
+
+
+#ifdef WITH_PTHREAD
+static void * ecl_grav_common_eval_stations__( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  int num_cells          = arg_pack_iget_int( arg_pack , 0 );
+  const double * xpos    = arg_pack_iget_const_ptr( arg_pack , 1 );
+  const double * ypos    = arg_pack_iget_const_ptr( arg_pack , 2 );
+  const double * zpos    = arg_pack_iget_const_ptr( arg_pack , 3 );
+  const double * weight  = arg_pack_iget_const_ptr( arg_pack , 4 );
+  int station1           = arg_pack_iget_int( arg_pack , 5 );
+  int station2           = arg_pack_iget_int( arg_pack , 6 );
+  const double * utm_x   = arg_pack_iget_const_ptr( arg_pack , 7 );
+  const double * utm_y   = arg_pack_iget_const_ptr( arg_pack , 8 );
+  const double * depth   = arg_pack_iget_const_ptr( arg_pack , 9 );
+  double * sum           = arg_pack_iget_ptr( arg_pack , 10 );
+
+  ecl_grav_common_eval_stations( num_cells , xpos , ypos , zpos , weight , station1 , station2 , utm_x , utm_y , depth , sum );
+  return NULL;
+}
+#endif
+
+
+/**
+   Will evaluate the same sum as ecl_grav_common_eval_biot_savart()
+   for all the @num_stations stations with positions (utm_x[i],
+   utm_y[i], depth[i]); the results are stored in @sum which must have
+   room for @num_stations elements.
+*/
+
+void ecl_grav_common_eval_biot_savart_list( const ecl_grid_cache_type * grid_cache , ecl_region_type * region , const bool * aquifer , const double * weight ,
+                                            int num_stations , const double * utm_x , const double * utm_y , const double * depth , double * sum) {
+  const double * xpos = ecl_grid_cache_get_xpos( grid_cache );
+  const double * ypos = ecl_grid_cache_get_ypos( grid_cache );
+  const double * zpos = ecl_grid_cache_get_zpos( grid_cache );
+  int size;
+  const int * index_list;
+
+  if (region == NULL) {
+    size = ecl_grid_cache_get_size( grid_cache );
+    index_list = NULL;
+  } else {
+    const int_vector_type * index_vector = ecl_region_get_active_list( region );
+    size = int_vector_size( index_vector );
+    index_list = int_vector_get_const_ptr( index_vector );
+  }
+
+  {
+    double * cell_x      = util_calloc( size , sizeof * cell_x );
+    double * cell_y      = util_calloc( size , sizeof * cell_y );
+    double * cell_z      = util_calloc( size , sizeof * cell_z );
+    double * cell_weight = util_calloc( size , sizeof * cell_weight );
+    int num_cells = 0;
+    int num_threads = 1;
+    int i;
+
+    for (i = 0; i < size; i++) {
+      int index = (index_list == NULL) ? i : index_list[i];
+      if (!aquifer[index]) {
+        cell_x[num_cells]      = xpos[index];
+        cell_y[num_cells]      = ypos[index];
+        cell_z[num_cells]      = zpos[index];
+        cell_weight[num_cells] = weight[index];
+        num_cells++;
+      }
+    }
+
+#ifdef WITH_PTHREAD
+    if (1.0 * num_cells * num_stations >= ECL_GRAV_MT_MIN_WORK) {
+      int num_blocks = (num_stations + ECL_GRAV_STATION_BLOCK - 1) / ECL_GRAV_STATION_BLOCK;
+      num_threads = util_int_min( num_blocks , util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN )));
+    }
+#endif
+
+    if (num_threads == 1)
+      ecl_grav_common_eval_stations( num_cells , cell_x , cell_y , cell_z , cell_weight , 0 , num_stations , utm_x , utm_y , depth , sum );
+#ifdef WITH_PTHREAD
+    else {
+      const int num_blocks = (num_stations + ECL_GRAV_STATION_BLOCK - 1) / ECL_GRAV_STATION_BLOCK;
+      thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+      arg_pack_type ** arg_list = util_calloc( num_threads , sizeof * arg_list );
+      int ithread;
+
+      for (ithread = 0; ithread < num_threads; ithread++) {
+        int station1 = util_int_min( num_stations , ECL_GRAV_STATION_BLOCK * ((ithread * num_blocks) / num_threads));
+        int station2 = util_int_min( num_stations , ECL_GRAV_STATION_BLOCK * (((ithread + 1) * num_blocks) / num_threads));
+
+        arg_list[ithread] = arg_pack_alloc();
+        arg_pack_append_int( arg_list[ithread] , num_cells );
+        arg_pack_append_const_ptr( arg_list[ithread] , cell_x );
+        arg_pack_append_const_ptr( arg_list[ithread] , cell_y );
+        arg_pack_append_const_ptr( arg_list[ithread] , cell_z );
+        arg_pack_append_const_ptr( arg_list[ithread] , cell_weight );
+        arg_pack_append_int( arg_list[ithread] , station1 );
+        arg_pack_append_int( arg_list[ithread] , station2 );
+        arg_pack_append_const_ptr( arg_list[ithread] , utm_x );
+        arg_pack_append_const_ptr( arg_list[ithread] , utm_y );
+        arg_pack_append_const_ptr( arg_list[ithread] , depth );
+        arg_pack_append_ptr( arg_list[ithread] , sum );
+        thread_pool_add_job( tp , ecl_grav_common_eval_stations__ , arg_list[ithread] );
+      }
+      thread_pool_join( tp );
+      thread_pool_free( tp );
+
+      for (ithread = 0; ithread < num_threads; ithread++)
+        arg_pack_free( arg_list[ithread] );
+      free( arg_list );
+    }
+#endif
+
+    free( cell_x );
+    free( cell_y );
+    free( cell_z );
+    free( cell_weight );
+  }
+}
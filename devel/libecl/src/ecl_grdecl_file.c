@@ -0,0 +1,777 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grdecl_file.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <float.h>
+#include <stdint.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifdef WITH_PTHREAD
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/size_t_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_kw_grdecl.h>
+#include <ert/ecl/ecl_grdecl_file.h>
+
+/*
+  The ecl_grdecl_file structure is an alternative to the stream based
+  functions in ecl_kw_grdecl.c for loading keywords from large GRDECL
+  files. The whole file is memory mapped (or read into memory where
+  mmap() is not available) when it is opened, and the keyword headers
+  are indexed in one pass over the file. When a keyword is loaded the
+  data section is split in chunks on line boundaries, and the chunks
+  are decoded in parallel in two passes: the first pass counts the
+  values and locates the terminating '/', the second pass decodes the
+  values directly into the keyword storage.
+
+  The results are identical to the stream based loader:
+
+   1. The data is split into tokens exactly like fscanf("%32s"), and
+      comments and the '/' terminator are recognized in the same way.
+
+   2. The common number formats are parsed directly; the parser only
+      accepts input where the result is guaranteed to be equal to the
+      correctly rounded value from sscanf(). All other tokens -
+      e.g. hexadecimal numbers, "inf" or numbers with very many
+      digits - are passed on to sscanf() with the same format strings
+      as the stream loader uses.
+
+   3. Keywords without a terminating '/' before the next keyword, and
+      keywords with negative repeat counts, are loaded with the stream
+      based loader.
+
+  Keyword headers are the first token on a line, starting with a
+  letter. If a keyword occurs several times the first occurrence is
+  used.
+*/
+
+#define ECL_GRDECL_FILE_TYPE_ID      771302
+#define ECL_GRDECL_TOKEN_SIZE            32                 /* Same as fscanf("%32s") in the stream loader. */
+#define ECL_GRDECL_MT_MIN_SIZE      (4 << 20)               /* Keywords with less data than this (bytes) are decoded in one thread. */
+#define ECL_GRDECL_CHUNKS_PER_THREAD      4
+
+
+struct ecl_grdecl_file_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char               * filename;
+  char               * data;         /* The file content - either mapped or read into memory. */
+  size_t               data_size;
+  bool                 mapped;
+  stringlist_type    * kw_list;      /* The keyword headers in file order. */
+  size_t_vector_type * kw_offset;    /* The file offset of each keyword header. */
+  hash_type          * kw_index;     /* The index of the first occurrence of each keyword. */
+};
+
+
+typedef struct {
+  const char     * start;
+  const char     * end;
+  ecl_type_enum    ecl_type;
+  char           * data;            /* Target storage for the decoded values; NULL when counting. */
+  int              offset;          /* The index of the first value of this chunk in the keyword. */
+  int              count;           /* The number of values in this chunk. */
+  bool             terminated;      /* A '/' was found; end has been moved to the terminator. */
+  bool             char_input;      /* The chunk contains non numeric tokens. */
+  bool             legacy;          /* The chunk contains constructs left to the stream loader. */
+} grdecl_chunk_type;
+
+
+/*****************************************************************/
+
+static const double grdecl_pow10[] = { 1e0  , 1e1  , 1e2  , 1e3  , 1e4  , 1e5  , 1e6  , 1e7  , 1e8  , 1e9  , 1e10 , 1e11 ,
+                                       1e12 , 1e13 , 1e14 , 1e15 , 1e16 , 1e17 , 1e18 , 1e19 , 1e20 , 1e21 , 1e22 };
+
+
+/* The isspace() characters in the C locale. */
+static inline bool grdecl_isspace( char c ) {
+  return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+
+static inline bool grdecl_isdigit( char c ) {
+  return (c >= '0') && (c <= '9');
+}
+
+
+static bool grdecl_token_equal( const char * token , int length , const char * s) {
+  return (length == strlen( s )) && (memcmp( token , s , length ) == 0);
+}
+
+
+static const char * grdecl_skip_line( const char * pos , const char * end ) {
+  const char * newline = memchr( pos , '\n' , end - pos );
+  if (newline == NULL)
+    return end;
+  else
+    return newline + 1;
+}
+
+
+/*
+  Will locate the next token in [*pos , end) and advance *pos past
+  it; the tokens are split exactly as with fscanf("%32s"), i.e. longer
+  strings are split in several tokens. Returns false when there are
+  no more tokens.
+*/
+
+static bool grdecl_next_token( const char ** pos , const char * end , const char ** token , int * length) {
+  const char * p = *pos;
+  while ((p < end) && grdecl_isspace( *p ))
+    p++;
+
+  *pos = p;
+  if (p == end)
+    return false;
+
+  *token = p;
+  while ((p < end) && !grdecl_isspace( *p ) && ((p - *token) < ECL_GRDECL_TOKEN_SIZE))
+    p++;
+
+  *length = p - *token;
+  *pos = p;
+  return true;
+}
+
+
+/*
+  Scans the complete range [p , end) as a decimal number
+
+     [+-]digits[.digits][(e|E)[+-]digits]
+
+  with at most 19 significant digits. The number is returned as
+  mantissa * 10^exp10. Returns false if the range does not match.
+*/
+
+static bool grdecl_scan_decimal( const char * p , const char * end , bool * negative , uint64_t * mantissa , int * exp10) {
+  uint64_t m = 0;
+  int significant_digits = 0;
+  int digits = 0;
+  int e = 0;
+
+  *negative = false;
+  if ((p < end) && ((*p == '+') || (*p == '-'))) {
+    *negative = (*p == '-');
+    p++;
+  }
+
+  while ((p < end) && grdecl_isdigit( *p )) {
+    if ((m > 0) || (*p != '0')) {
+      if (significant_digits == 19)
+        return false;
+      m = 10*m + (*p - '0');
+      significant_digits++;
+    }
+    digits++;
+    p++;
+  }
+
+  if ((p < end) && (*p == '.')) {
+    p++;
+    while ((p < end) && grdecl_isdigit( *p )) {
+      if ((m > 0) || (*p != '0')) {
+        if (significant_digits == 19)
+          return false;
+        m = 10*m + (*p - '0');
+        significant_digits++;
+      }
+      e--;
+      digits++;
+      p++;
+    }
+  }
+
+  if (digits == 0)
+    return false;
+
+  if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+    bool exp_negative = false;
+    int exp_digits = 0;
+    int exp = 0;
+
+    p++;
+    if ((p < end) && ((*p == '+') || (*p == '-'))) {
+      exp_negative = (*p == '-');
+      p++;
+    }
+
+    while ((p < end) && grdecl_isdigit( *p )) {
+      if (exp_digits == 4)
+        return false;
+      exp = 10*exp + (*p - '0');
+      exp_digits++;
+      p++;
+    }
+    if (exp_digits == 0)
+      return false;
+
+    e += exp_negative ? -exp : exp;
+  }
+
+  if (p != end)
+    return false;
+
+  *mantissa = m;
+  *exp10 = e;
+  return true;
+}
+
+
+/*
+  When both the mantissa and the power of ten are exactly
+  representable as doubles, a single multiplication or division gives
+  the correctly rounded result. This requires that the floating point
+  arithmetic is done in double precision; otherwise everything goes
+  through sscanf().
+*/
+
+static bool grdecl_fast_double( uint64_t mantissa , int exp10 , bool negative , double * value) {
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+  double d;
+  if (mantissa == 0)
+    d = 0;
+  else {
+    if (mantissa > (UINT64_C(1) << 53))
+      return false;
+
+    if ((exp10 < -22) || (exp10 > 22))
+      return false;
+
+    d = (double) mantissa;
+    if (exp10 < 0)
+      d /= grdecl_pow10[ -exp10 ];
+    else
+      d *= grdecl_pow10[ exp10 ];
+  }
+
+  *value = negative ? -d : d;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+/*
+  The correctly rounded double is converted to float. Since the
+  double is within half a double ulp of the exact value, rounding it
+  to float gives the same result as rounding the exact value - unless
+  the double is exactly half way between two floats.
+*/
+
+static bool grdecl_fast_float( uint64_t mantissa , int exp10 , bool negative , float * value) {
+  double d;
+  if (!grdecl_fast_double( mantissa , exp10 , false , &d ))
+    return false;
+
+  if (d != 0) {
+    uint64_t bits;
+    const uint64_t half = UINT64_C(1) << 28;
+
+    if ((d < FLT_MIN) || (d > FLT_MAX))
+      return false;
+
+    memcpy( &bits , &d , sizeof bits );
+    if ((bits & (2*half - 1)) == half)
+      return false;
+  }
+
+  {
+    float f = (float) d;
+    *value = negative ? -f : f;
+  }
+  return true;
+}
+
+
+static bool grdecl_parse_value( const char * p , const char * end , ecl_type_enum ecl_type , void * value) {
+  if (ecl_type == ECL_INT_TYPE) {
+    const char * q = p;
+    bool negative = false;
+    int  int_value = 0;
+    int  digits = 0;
+
+    if ((q < end) && ((*q == '+') || (*q == '-'))) {
+      negative = (*q == '-');
+      q++;
+    }
+    while ((q < end) && grdecl_isdigit( *q ) && (digits < 9)) {
+      int_value = 10*int_value + (*q - '0');
+      digits++;
+      q++;
+    }
+
+    if ((digits == 0) || (q != end))
+      return false;
+
+    *((int *) value) = negative ? -int_value : int_value;
+    return true;
+  } else {
+    bool negative;
+    uint64_t mantissa;
+    int exp10;
+
+    if (!grdecl_scan_decimal( p , end , &negative , &mantissa , &exp10 ))
+      return false;
+
+    if (ecl_type == ECL_FLOAT_TYPE)
+      return grdecl_fast_float( mantissa , exp10 , negative , value );
+    else
+      return grdecl_fast_double( mantissa , exp10 , negative , value );
+  }
+}
+
+
+/*
+  The same sscanf() calls as in fscanf_alloc_grdecl_data() in
+  ecl_kw_grdecl.c.
+*/
+
+static bool grdecl_parse_token_sscanf( const char * token , int length , ecl_type_enum ecl_type , int * multiplier , void * value) {
+  char buffer[ECL_GRDECL_TOKEN_SIZE + 1];
+  memcpy( buffer , token , length );
+  buffer[length] = '\0';
+
+  if (ecl_type == ECL_INT_TYPE) {
+    if (sscanf(buffer , "%d*%d" , multiplier , (int *) value) == 2)
+      return true;
+    else if (sscanf( buffer , "%d" , (int *) value) == 1) {
+      *multiplier = 1;
+      return true;
+    }
+  } else if (ecl_type == ECL_FLOAT_TYPE) {
+    if (sscanf(buffer , "%d*%g" , multiplier , (float *) value) == 2)
+      return true;
+    else if (sscanf( buffer , "%g" , (float *) value) == 1) {
+      *multiplier = 1;
+      return true;
+    }
+  } else {
+    if (sscanf(buffer , "%d*%lg" , multiplier , (double *) value) == 2)
+      return true;
+    else if (sscanf( buffer , "%lg" , (double *) value) == 1) {
+      *multiplier = 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+  Parses one token like "0.25" or "1000*0.25"; returns false for non
+  numeric tokens.
+*/
+
+static bool grdecl_parse_token( const char * token , int length , ecl_type_enum ecl_type , int * multiplier , void * value) {
+  const char * end = token + length;
+  const char * p = token;
+  int repeat = 0;
+  int digits = 0;
+
+  while ((p < end) && grdecl_isdigit( *p ) && (digits < 9)) {
+    repeat = 10*repeat + (*p - '0');
+    digits++;
+    p++;
+  }
+
+  if ((digits > 0) && (p < end) && (*p == '*')) {
+    if (grdecl_parse_value( p + 1 , end , ecl_type , value )) {
+      *multiplier = repeat;
+      return true;
+    }
+  } else if (grdecl_parse_value( token , end , ecl_type , value )) {
+    *multiplier = 1;
+    return true;
+  }
+
+  return grdecl_parse_token_sscanf( token , length , ecl_type , multiplier , value );
+}
+
+
+static void grdecl_iset_range( char * data , int offset , ecl_type_enum ecl_type , const void * value , int multiplier) {
+  int index;
+  if (ecl_type == ECL_INT_TYPE) {
+    int * target = (int *) data + offset;
+    int int_value = *((const int *) value);
+    for (index = 0; index < multiplier; index++)
+      target[index] = int_value;
+  } else if (ecl_type == ECL_FLOAT_TYPE) {
+    float * target = (float *) data + offset;
+    float float_value = *((const float *) value);
+    for (index = 0; index < multiplier; index++)
+      target[index] = float_value;
+  } else {
+    double * target = (double *) data + offset;
+    double double_value = *((const double *) value);
+    for (index = 0; index < multiplier; index++)
+      target[index] = double_value;
+  }
+}
+
+
+/*
+  Runs through the tokens in the chunk; if chunk->data != NULL the
+  values are stored, otherwise they are only counted.
+*/
+
+static void grdecl_chunk_scan( grdecl_chunk_type * chunk ) {
+  const char * pos = chunk->start;
+  const char * token;
+  int length;
+
+  chunk->count = 0;
+  while (grdecl_next_token( &pos , chunk->end , &token , &length )) {
+    if (grdecl_token_equal( token , length , ECL_COMMENT_STRING ))
+      pos = grdecl_skip_line( pos , chunk->end );
+    else if (grdecl_token_equal( token , length , ECL_DATA_TERMINATION )) {
+      chunk->terminated = true;
+      chunk->end = token;
+      break;
+    } else {
+      int multiplier;
+      double value;    /* Storage for an int, float or double value. */
+
+      if (grdecl_parse_token( token , length , chunk->ecl_type , &multiplier , &value )) {
+        if (multiplier < 0) {
+          chunk->legacy = true;
+          break;
+        }
+
+        if (chunk->data != NULL)
+          grdecl_iset_range( chunk->data , chunk->offset + chunk->count , chunk->ecl_type , &value , multiplier );
+        chunk->count += multiplier;
+      } else
+        chunk->char_input = true;
+    }
+  }
+}
+
+
+static void * grdecl_chunk_scan__( void * arg ) {
+  grdecl_chunk_scan( arg );
+  return NULL;
+}
+
+
+static void grdecl_scan_chunks( grdecl_chunk_type * chunk_list , int num_chunks , int num_threads) {
+#ifdef WITH_PTHREAD
+  if (num_threads > 1) {
+    thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+    int ichunk;
+    for (ichunk = 0; ichunk < num_chunks; ichunk++)
+      thread_pool_add_job( tp , grdecl_chunk_scan__ , &chunk_list[ichunk] );
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+    return;
+  }
+#endif
+  {
+    int ichunk;
+    for (ichunk = 0; ichunk < num_chunks; ichunk++)
+      grdecl_chunk_scan( &chunk_list[ichunk] );
+  }
+}
+
+
+/*
+  Warnings for (or with @strict == true abort on) the non numeric
+  tokens in the chunk; with the same messages as the stream loader.
+*/
+
+static void grdecl_chunk_report( const grdecl_chunk_type * chunk , const char * header , bool strict) {
+  const char * pos = chunk->start;
+  const char * token;
+  int length;
+
+  while (grdecl_next_token( &pos , chunk->end , &token , &length )) {
+    if (grdecl_token_equal( token , length , ECL_COMMENT_STRING ))
+      pos = grdecl_skip_line( pos , chunk->end );
+    else {
+      int multiplier;
+      double value;
+
+      if (!grdecl_parse_token( token , length , chunk->ecl_type , &multiplier , &value )) {
+        char buffer[ECL_GRDECL_TOKEN_SIZE + 1];
+        memcpy( buffer , token , length );
+        buffer[length] = '\0';
+
+        if (strict)
+          util_abort("%s: Malformed content:\"%s\" when reading keyword:%s \n",__func__ , buffer , header);
+        fprintf(stderr,"Warning: character string: \'%s\' ignored when reading keyword:%s \n",buffer , header);
+      }
+    }
+  }
+}
+
+
+/*****************************************************************/
+
+
+static void ecl_grdecl_file_build_index( ecl_grdecl_file_type * grdecl_file ) {
+  const char * data = grdecl_file->data;
+  const char * end  = data + grdecl_file->data_size;
+  const char * pos  = data;
+
+  while (true) {
+    while ((pos < end) && grdecl_isspace( *pos ))
+      pos++;
+
+    if (pos == end)
+      break;
+
+    {
+      const char * token = pos;
+      while ((pos < end) && !grdecl_isspace( *pos ))
+        pos++;
+
+      if (isalpha( (unsigned char) token[0] )) {
+        char * header = util_alloc_substring_copy( token , 0 , pos - token );
+        if (!hash_has_key( grdecl_file->kw_index , header ))
+          hash_insert_int( grdecl_file->kw_index , header , stringlist_get_size( grdecl_file->kw_list ));
+
+        stringlist_append_owned_ref( grdecl_file->kw_list , header );
+        size_t_vector_append( grdecl_file->kw_offset , token - data );
+      }
+      pos = grdecl_skip_line( pos , end );
+    }
+  }
+}
+
+
+UTIL_IS_INSTANCE_FUNCTION( ecl_grdecl_file , ECL_GRDECL_FILE_TYPE_ID )
+
+
+ecl_grdecl_file_type * ecl_grdecl_file_open( const char * filename ) {
+  ecl_grdecl_file_type * grdecl_file = util_malloc( sizeof * grdecl_file );
+  UTIL_TYPE_ID_INIT( grdecl_file , ECL_GRDECL_FILE_TYPE_ID );
+  grdecl_file->filename  = util_alloc_string_copy( filename );
+  grdecl_file->data      = NULL;
+  grdecl_file->data_size = 0;
+  grdecl_file->mapped    = false;
+  grdecl_file->kw_list   = stringlist_alloc_new();
+  grdecl_file->kw_offset = size_t_vector_alloc( 0 , 0 );
+  grdecl_file->kw_index  = hash_alloc();
+
+#ifdef HAVE_MMAP
+  {
+    FILE * stream = util_fopen( filename , "r" );
+    size_t file_size = util_file_size( filename );
+    if (file_size > 0) {
+      void * data = mmap( NULL , file_size , PROT_READ , MAP_PRIVATE , fileno( stream ) , 0 );
+      if (data != MAP_FAILED) {
+        grdecl_file->data      = data;
+        grdecl_file->data_size = file_size;
+        grdecl_file->mapped    = true;
+      }
+    }
+    fclose( stream );
+  }
+#endif
+
+  if (!grdecl_file->mapped) {
+    int file_size;
+    grdecl_file->data      = util_fread_alloc_file_content( filename , &file_size );
+    grdecl_file->data_size = file_size;
+  }
+
+  ecl_grdecl_file_build_index( grdecl_file );
+  return grdecl_file;
+}
+
+
+void ecl_grdecl_file_close( ecl_grdecl_file_type * grdecl_file ) {
+#ifdef HAVE_MMAP
+  if (grdecl_file->mapped)
+    munmap( grdecl_file->data , grdecl_file->data_size );
+#endif
+  if (!grdecl_file->mapped)
+    free( grdecl_file->data );
+
+  stringlist_free( grdecl_file->kw_list );
+  size_t_vector_free( grdecl_file->kw_offset );
+  hash_free( grdecl_file->kw_index );
+  free( grdecl_file->filename );
+  free( grdecl_file );
+}
+
+
+int ecl_grdecl_file_get_num_kw( const ecl_grdecl_file_type * grdecl_file ) {
+  return stringlist_get_size( grdecl_file->kw_list );
+}
+
+
+const char * ecl_grdecl_file_iget_header( const ecl_grdecl_file_type * grdecl_file , int index ) {
+  return stringlist_iget( grdecl_file->kw_list , index );
+}
+
+
+bool ecl_grdecl_file_has_kw( const ecl_grdecl_file_type * grdecl_file , const char * kw ) {
+  return hash_has_key( grdecl_file->kw_index , kw );
+}
+
+
+static ecl_kw_type * ecl_grdecl_file_alloc_kw_stream( const ecl_grdecl_file_type * grdecl_file , size_t header_offset , bool strict , int size , ecl_type_enum ecl_type) {
+  FILE * stream = util_fopen( grdecl_file->filename , "r" );
+  ecl_kw_type * ecl_kw;
+
+  util_fseek( stream , (offset_type) header_offset , SEEK_SET );
+  ecl_kw = ecl_kw_fscanf_alloc_grdecl_data__( stream , strict , size , ecl_type );
+  fclose( stream );
+
+  return ecl_kw;
+}
+
+
+/**
+   Will load the keyword @kw, with the same semantics for @strict,
+   @size and @ecl_type as ecl_kw_fscanf_alloc_grdecl__(). If the file
+   does not contain the keyword the function will return NULL.
+*/
+
+ecl_kw_type * ecl_grdecl_file_alloc_kw__( const ecl_grdecl_file_type * grdecl_file , const char * kw , bool strict , int size , ecl_type_enum ecl_type ) {
+  if (! (ecl_type == ECL_FLOAT_TYPE || ecl_type == ECL_INT_TYPE || ecl_type == ECL_DOUBLE_TYPE))
+    util_abort("%s: sorry only types FLOAT, INT and DOUBLE supported\n",__func__);
+
+  if (!hash_has_key( grdecl_file->kw_index , kw ))
+    return NULL;
+
+  {
+    const int kw_nr            = hash_get_int( grdecl_file->kw_index , kw );
+    const size_t header_offset = size_t_vector_iget( grdecl_file->kw_offset , kw_nr );
+    const char * start         = grdecl_file->data + header_offset + strlen( kw );
+    const char * end;
+    int num_threads = 1;
+    int num_chunks  = 1;
+    grdecl_chunk_type * chunk_list;
+
+    if (kw_nr + 1 < size_t_vector_size( grdecl_file->kw_offset ))
+      end = grdecl_file->data + size_t_vector_iget( grdecl_file->kw_offset , kw_nr + 1 );
+    else
+      end = grdecl_file->data + grdecl_file->data_size;
+
+#ifdef WITH_PTHREAD
+    if ((end - start) >= ECL_GRDECL_MT_MIN_SIZE) {
+      num_threads = util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN ));
+      num_chunks  = num_threads * ECL_GRDECL_CHUNKS_PER_THREAD;
+    }
+#endif
+
+    /* Split the data in chunks on line boundaries. */
+    chunk_list = util_calloc( num_chunks , sizeof * chunk_list );
+    {
+      const char * chunk_start = start;
+      int ichunk;
+      for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+        grdecl_chunk_type * chunk = &chunk_list[ichunk];
+        const char * chunk_end;
+
+        if (ichunk == num_chunks - 1)
+          chunk_end = end;
+        else {
+          chunk_end = start + ((ichunk + 1) * (end - start)) / num_chunks;
+          if (chunk_end < chunk_start)
+            chunk_end = chunk_start;
+          chunk_end = grdecl_skip_line( chunk_end , end );
+        }
+
+        chunk->start      = chunk_start;
+        chunk->end        = chunk_end;
+        chunk->ecl_type   = ecl_type;
+        chunk->data       = NULL;
+        chunk->offset     = 0;
+        chunk->count      = 0;
+        chunk->terminated = false;
+        chunk->char_input = false;
+        chunk->legacy     = false;
+        chunk_start = chunk_end;
+      }
+    }
+
+    grdecl_scan_chunks( chunk_list , num_chunks , num_threads );
+    {
+      int  kw_size = 0;
+      bool legacy = true;
+      int ichunk;
+
+      for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+        grdecl_chunk_type * chunk = &chunk_list[ichunk];
+        if (chunk->legacy)
+          break;
+
+        chunk->offset = kw_size;
+        kw_size += chunk->count;
+        if (chunk->terminated) {
+          num_chunks = ichunk + 1;
+          legacy = false;
+          break;
+        }
+      }
+
+      if (legacy) {
+        free( chunk_list );
+        return ecl_grdecl_file_alloc_kw_stream( grdecl_file , header_offset , strict , size , ecl_type );
+      }
+
+      for (ichunk = 0; ichunk < num_chunks; ichunk++) {
+        if (chunk_list[ichunk].char_input)
+          grdecl_chunk_report( &chunk_list[ichunk] , kw , strict );
+      }
+
+      if (size > 0)
+        if (size != kw_size) {
+          free( chunk_list );
+          util_abort("%s: size mismatch when loading:%s. File:%d elements. Requested:%d elements \n",
+                     __func__ , kw , kw_size , size);
+        }
+
+      {
+        char * data = util_calloc( kw_size , ecl_util_get_sizeof_ctype( ecl_type ));
+        ecl_kw_type * ecl_kw;
+
+        for (ichunk = 0; ichunk < num_chunks; ichunk++)
+          chunk_list[ichunk].data = data;
+        grdecl_scan_chunks( chunk_list , num_chunks , num_threads );
+        free( chunk_list );
+
+        ecl_kw = ecl_kw_alloc_new( kw , kw_size , ecl_type , NULL );
+        ecl_kw_set_data_ptr( ecl_kw , data );
+        return ecl_kw;
+      }
+    }
+  }
+}
+
+
+ecl_kw_type * ecl_grdecl_file_alloc_kw( const ecl_grdecl_file_type * grdecl_file , const char * kw , int size , ecl_type_enum ecl_type ) {
+  return ecl_grdecl_file_alloc_kw__( grdecl_file , kw , true , size , ecl_type );
+}
@@ -22,6 +22,13 @@
 #include <stdbool.h>
 #include <math.h>
 
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#include <ert/util/arg_pack.h>
+#endif
+
 #include <ert/util/util.h>
 #include <ert/util/double_vector.h>
 #include <ert/util/int_vector.h>
@@ -42,6 +49,7 @@
 #include <ert/ecl/tetrahedron.h>
 #include <ert/ecl/grid_dims.h>
 #include <ert/ecl/nnc_info.h>
+#include <ert/ecl/nnc_table.h>
 
 
 /**
@@ -369,6 +377,12 @@
        In the nnc_info structure the different grids are identified
        through the lgr_nr.
 
+       When the grid is loaded the connections are first assembled in
+       one compact nnc_table per grid (see nnc_table.c); the nnc_info
+       structures are only created from that table when they are
+       first requested. The nnc export in ecl_nnc_export.c works
+       directly on the nnc_table.
+
 
 
   Example usage:
@@ -581,6 +595,94 @@ struct ecl_cell_struct {
 
 
 
+/*
+  Compact cell storage
+  --------------------
+
+  When a grid is loaded with ecl_grid_alloc_compact() the
+  ecl_cell_type structs are never allocated. Instead the geometry is
+  stored in contiguous float arrays, and the remaining cell properties
+  in the small ecl_cell_attr_type struct; this roughly halves the
+  memory usage. To retain reasonable precision with UTM coordinates
+  the corners and centers are stored relative to the double precision
+  offset of the grid. The lgr and nnc_info pointers are only set for a
+  small minority of the cells, and those arrays are allocated on
+  demand.
+
+  The cells are materialized on request in a caller supplied buffer
+  with ecl_grid_get_cell_view(); code which modifies a cell must write
+  it back with ecl_grid_store_cell() or ecl_grid_store_cell_attr().
+*/
+
+typedef struct {
+  int                    active;
+  int                    active_index[2];
+  int                    host_cell;
+  int                    coarse_group;
+  int                    cell_flags;
+} ecl_cell_attr_type;
+
+
+typedef struct {
+  int                    attr_size;
+  double                 offset[3];
+  float                * corner_x;         /* Corner c of cell g is at index 8*g + c. */
+  float                * corner_y;
+  float                * corner_z;
+  float                * center_x;
+  float                * center_y;
+  float                * center_z;
+  ecl_cell_attr_type   * attr;
+  const ecl_grid_type ** lgr;              /* NULL until the first lgr is installed. */
+  nnc_info_type       ** nnc_info;         /* NULL until the first nnc is added.     */
+} ecl_grid_compact_type;
+
+
+
+/*
+  Spatial index (bounding volume hierarchy) over the bounding boxes
+  of the cells, used to locate the cell containing a point. The
+  implementation is further down, next to the xyz lookup functions.
+*/
+
+#define ECL_GRID_BVH_LEAF_SIZE   8
+#define ECL_GRID_BVH_MAX_DEPTH  64
+
+/* Grids smaller than this are initialized by one thread. */
+#define ECL_GRID_MT_MIN_SIZE    50000
+
+typedef struct {
+  double  min[3];
+  double  max[3];
+  int     left;                 /* Internal nodes: index of the two child nodes. */
+  int     right;
+  int     first;                /* Leaf nodes: offset into the cell_list. */
+  int     count;                /* Number of cells in a leaf node; 0 for internal nodes. */
+} ecl_grid_bvh_node_type;
+
+typedef struct {
+  int                      * cell_list;   /* Global index of all the untainted cells - ordered by leaf. */
+  ecl_grid_bvh_node_type   * nodes;       /* nodes[0] is the root. */
+  int                        num_nodes;
+  int                        alloc_size;
+} ecl_grid_bvh_type;
+
+
+/*
+  For grids loaded with the ECL_GRID_LAZY flag the cell geometry is
+  not calculated when the grid is loaded; instead the ZCORN, ACTNUM
+  and CORSNUM data is retained here (the COORD data is retained in the
+  coord_kw anyway), and the geometry is calculated on the first
+  geometric query, see ecl_grid_assert_geometry().
+*/
+
+typedef struct {
+  float * zcorn;
+  int   * actnum;     /* Can be NULL. */
+  int   * corsnum;    /* Can be NULL. */
+} ecl_grid_lazy_type;
+
+
 #define LARGE_CELL_MALLOC 1
 #define ECL_GRID_ID       991010
 
@@ -593,7 +695,19 @@ struct ecl_grid_struct {
   int                   size;          /* == nx*ny*nz */
   int                   total_active; 
   int                   total_active_fracture;
-  bool                * visited;                /* internal helper struct used when searching for index - can be NULL. */
+  ecl_grid_bvh_type   * cell_bvh;               /* spatial index used when searching for index - built on demand, can be NULL. */
+#ifdef WITH_PTHREAD
+  pthread_mutex_t       cell_bvh_lock;
+#endif
+  ecl_grid_lazy_type  * lazy_geometry;          /* Only for lazy grids before the geometry has been initialized - otherwise NULL. */
+#ifdef WITH_PTHREAD
+  pthread_mutex_t       geometry_lock;
+#endif
+  nnc_table_type      * nnc_table;              /* The nnc originating in this grid - NULL if there are none. */
+  bool                  nnc_info_loaded;        /* Have the per cell nnc_info instances been created from the nnc_table? */
+#ifdef WITH_PTHREAD
+  pthread_mutex_t       nnc_lock;
+#endif
   int                 * index_map;              /* this a list of nx*ny*nz elements, where value -1 means inactive cell .*/
   int                 * inv_index_map;          /* this is list of total_active elements - which point back to the index_map. */
 
@@ -605,6 +719,7 @@ struct ecl_grid_struct {
 #else
   ecl_cell_type      ** cells;         
 #endif
+  ecl_grid_compact_type * compact;      /* Compact cell storage - NULL unless allocated with ecl_grid_alloc_compact(); then cells is NULL. */
 
   char                * parent_name;   /* the name of the parent for a nested lgr - for the main grid, and also a
                                           lgr descending directly from the main grid this will be NULL. */
@@ -1219,6 +1334,9 @@ UTIL_IS_INSTANCE_FUNCTION( ecl_grid , ECL_GRID_ID);
 
 
 static ecl_cell_type * ecl_grid_get_cell(const ecl_grid_type * grid , int global_index) {
+  if (grid->compact != NULL)
+    util_abort("%s: internal error - the cells of a compact grid must be accessed with ecl_grid_get_cell_view()\n",__func__);
+
 #ifdef LARGE_CELL_MALLOC
   return &grid->cells[global_index];
 #else
@@ -1227,6 +1345,168 @@ static ecl_cell_type * ecl_grid_get_cell(const ecl_grid_type * grid , int global
 }
 
 
+static void ecl_grid_compact_load_cell( const ecl_grid_compact_type * compact , int global_index , ecl_cell_type * cell , bool load_geometry) {
+  const ecl_cell_attr_type * attr = &compact->attr[global_index];
+  
+  cell->active                       = attr->active;
+  cell->active_index[MATRIX_INDEX]   = attr->active_index[MATRIX_INDEX];
+  cell->active_index[FRACTURE_INDEX] = attr->active_index[FRACTURE_INDEX];
+  cell->host_cell                    = attr->host_cell;
+  cell->coarse_group                 = attr->coarse_group;
+  cell->cell_flags                   = attr->cell_flags;
+  cell->lgr                          = (compact->lgr == NULL)      ? NULL : compact->lgr[global_index];
+  cell->nnc_info                     = (compact->nnc_info == NULL) ? NULL : compact->nnc_info[global_index];
+
+  if (load_geometry) {
+    const int offset = 8 * global_index;
+    int c;
+    for (c = 0; c < 8; c++) 
+      point_set( &cell->corner_list[c] , 
+                 compact->offset[0] + compact->corner_x[offset + c] , 
+                 compact->offset[1] + compact->corner_y[offset + c] , 
+                 compact->offset[2] + compact->corner_z[offset + c]);
+    
+    point_set( &cell->center , 
+               compact->offset[0] + compact->center_x[global_index] , 
+               compact->offset[1] + compact->center_y[global_index] , 
+               compact->offset[2] + compact->center_z[global_index]);
+    SET_CELL_FLAG( cell , CELL_FLAG_CENTER );
+  }
+}
+
+
+/**
+   Will return a pointer to cell @global_index. For normal grids this
+   is a pointer to the cell itself, and @buffer is not used; for
+   compact grids the cell is assembled in @buffer. If the cell is
+   modified it must be written back with ecl_grid_store_cell().
+*/
+
+static ecl_cell_type * ecl_grid_get_cell_view__(const ecl_grid_type * grid , int global_index , ecl_cell_type * buffer) {
+  if (grid->compact == NULL)
+    return ecl_grid_get_cell( grid , global_index );
+  else {
+    ecl_grid_compact_load_cell( grid->compact , global_index , buffer , true );
+    return buffer;
+  }
+}
+
+
+static void ecl_grid_assert_geometry( const ecl_grid_type * grid );
+
+/*
+  As ecl_grid_get_cell_view__(), but will first make sure that the
+  geometry of a lazy grid has been initialized. All geometric queries
+  should go through this function.
+*/
+
+static ecl_cell_type * ecl_grid_get_cell_view(const ecl_grid_type * grid , int global_index , ecl_cell_type * buffer) {
+  ecl_grid_assert_geometry( grid );
+  return ecl_grid_get_cell_view__( grid , global_index , buffer );
+}
+
+
+/**
+   As ecl_grid_get_cell_view(), but for compact grids only the
+   non-geometric properties are loaded; i.e. the corners and center
+   of the returned cell are undefined.
+*/
+
+static ecl_cell_type * ecl_grid_get_cell_attr_view(const ecl_grid_type * grid , int global_index , ecl_cell_type * buffer) {
+  if (grid->compact == NULL)
+    return ecl_grid_get_cell( grid , global_index );
+  else {
+    ecl_grid_compact_load_cell( grid->compact , global_index , buffer , false );
+    return buffer;
+  }
+}
+
+
+static void ecl_grid_compact_store_attr( ecl_grid_compact_type * compact , int global_index , const ecl_cell_type * cell) {
+  ecl_cell_attr_type * attr = &compact->attr[global_index];
+  
+  attr->active                       = cell->active;
+  attr->active_index[MATRIX_INDEX]   = cell->active_index[MATRIX_INDEX];
+  attr->active_index[FRACTURE_INDEX] = cell->active_index[FRACTURE_INDEX];
+  attr->host_cell                    = cell->host_cell;
+  attr->coarse_group                 = cell->coarse_group;
+  attr->cell_flags                   = cell->cell_flags & ~CELL_FLAG_CENTER;
+
+  if ((cell->lgr != NULL) && (compact->lgr == NULL)) {
+    compact->lgr = util_calloc( compact->attr_size , sizeof * compact->lgr );
+    memset( compact->lgr , 0 , compact->attr_size * sizeof * compact->lgr );
+  }
+  if (compact->lgr != NULL)
+    compact->lgr[global_index] = cell->lgr;
+
+  if ((cell->nnc_info != NULL) && (compact->nnc_info == NULL)) {
+    compact->nnc_info = util_calloc( compact->attr_size , sizeof * compact->nnc_info );
+    memset( compact->nnc_info , 0 , compact->attr_size * sizeof * compact->nnc_info );
+  }
+  if (compact->nnc_info != NULL)
+    compact->nnc_info[global_index] = cell->nnc_info;
+}
+
+
+/**
+   Writes the non-geometric properties of a cell obtained with
+   ecl_grid_get_cell_view() or ecl_grid_get_cell_attr_view() back to
+   the grid; a no-op for normal grids.
+*/
+
+static void ecl_grid_store_cell_attr( ecl_grid_type * grid , int global_index , const ecl_cell_type * cell) {
+  if (grid->compact != NULL)
+    ecl_grid_compact_store_attr( grid->compact , global_index , cell );
+}
+
+
+/**
+   Writes both the geometry and the remaining properties of a cell
+   obtained with ecl_grid_get_cell_view() back to the grid; a no-op
+   for normal grids. The center of the cell is recalculated.
+*/
+
+static void ecl_grid_store_cell( ecl_grid_type * grid , int global_index , const ecl_cell_type * cell) {
+  ecl_grid_compact_type * compact = grid->compact;
+  if (compact != NULL) {
+    const int offset = 8 * global_index;
+    double center[3] = {0 , 0 , 0};
+    int c;
+
+    for (c = 0; c < 8; c++) {
+      const point_type * p = &cell->corner_list[c];
+      compact->corner_x[offset + c] = p->x - compact->offset[0];
+      compact->corner_y[offset + c] = p->y - compact->offset[1];
+      compact->corner_z[offset + c] = p->z - compact->offset[2];
+      
+      center[0] += p->x;
+      center[1] += p->y;
+      center[2] += p->z;
+    }
+    compact->center_x[global_index] = center[0] / 8 - compact->offset[0];
+    compact->center_y[global_index] = center[1] / 8 - compact->offset[1];
+    compact->center_z[global_index] = center[2] / 8 - compact->offset[2];
+    
+    ecl_grid_compact_store_attr( compact , global_index , cell );
+  }
+}
+
+
+/**
+   The corners of a compact grid are stored relative to an offset; this
+   should be set to a point in the grid before the cell geometry is
+   installed. Ignored for normal grids.
+*/
+
+static void ecl_grid_set_compact_offset( ecl_grid_type * grid , double x , double y , double z) {
+  if (grid->compact != NULL) {
+    grid->compact->offset[0] = x;
+    grid->compact->offset[1] = y;
+    grid->compact->offset[2] = z;
+  }
+}
+
+
 /**
    this function uses heuristics (ahhh - i hate it) in an attempt to
    mark cells with fucked geometry - see further comments in the
@@ -1236,19 +1516,49 @@ static ecl_cell_type * ecl_grid_get_cell(const ecl_grid_type * grid , int global
 static void ecl_grid_taint_cells( ecl_grid_type * ecl_grid ) {
   int index;
   for (index = 0; index < ecl_grid->size; index++) {
-    ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , index );
+    ecl_cell_type cell_buffer;
+    ecl_cell_type * cell = ecl_grid_get_cell_view__( ecl_grid , index , &cell_buffer );
     ecl_cell_taint_cell( cell );
+    ecl_grid_store_cell_attr( ecl_grid , index , cell );
   }
 }
 
 
-static void ecl_grid_free_cells( ecl_grid_type * grid ) {
+static void ecl_grid_free_compact( ecl_grid_compact_type * compact ) {
+  if (compact->nnc_info != NULL) {
+    int i;
+    for (i=0; i < compact->attr_size; i++) {
+      if (compact->nnc_info[i])
+        nnc_info_free( compact->nnc_info[i] );
+    }
+    free( compact->nnc_info );
+  }
+  
+  util_safe_free( compact->lgr );
+  free( compact->attr );
+  free( compact->corner_x );
+  free( compact->corner_y );
+  free( compact->corner_z );
+  free( compact->center_x );
+  free( compact->center_y );
+  free( compact->center_z );
+  free( compact );
+}
 
-  int i;
-  for (i=0; i < grid->size; i++) {
-    ecl_cell_type * cell = ecl_grid_get_cell( grid , i );
-    if (cell->nnc_info)
-      nnc_info_free(cell->nnc_info);
+
+static void ecl_grid_free_cells( ecl_grid_type * grid ) {
+  if (grid->compact != NULL) {
+    ecl_grid_free_compact( grid->compact );
+    return;
+  }
+  
+  {
+    int i;
+    for (i=0; i < grid->size; i++) {
+      ecl_cell_type * cell = ecl_grid_get_cell( grid , i );
+      if (cell->nnc_info)
+        nnc_info_free(cell->nnc_info);
+    }
   }
 
 #ifndef LARGE_CELL_MALLOC
@@ -1261,7 +1571,38 @@ static void ecl_grid_free_cells( ecl_grid_type * grid ) {
   free( grid->cells );
 }
 
+static void ecl_grid_alloc_compact_cells( ecl_grid_type * grid , bool init_valid) {
+  ecl_grid_compact_type * compact = util_malloc( sizeof * compact );
+  ecl_cell_type cell0;
+
+  compact->attr_size = grid->size;
+  compact->offset[0] = 0;
+  compact->offset[1] = 0;
+  compact->offset[2] = 0;
+  compact->corner_x  = util_calloc( 8 * grid->size , sizeof * compact->corner_x );
+  compact->corner_y  = util_calloc( 8 * grid->size , sizeof * compact->corner_y );
+  compact->corner_z  = util_calloc( 8 * grid->size , sizeof * compact->corner_z );
+  compact->center_x  = util_calloc( grid->size , sizeof * compact->center_x );
+  compact->center_y  = util_calloc( grid->size , sizeof * compact->center_y );
+  compact->center_z  = util_calloc( grid->size , sizeof * compact->center_z );
+  compact->attr      = util_calloc( grid->size , sizeof * compact->attr );
+  compact->lgr       = NULL;
+  compact->nnc_info  = NULL;
+
+  ecl_cell_init( &cell0 , init_valid );
+  {
+    int i;
+    for (i=0; i < grid->size; i++)
+      ecl_grid_compact_store_attr( compact , i , &cell0 );
+  }
+
+  grid->cells   = NULL;
+  grid->compact = compact;
+}
+
+
 static void ecl_grid_alloc_cells( ecl_grid_type * grid , bool init_valid) {
+  grid->compact         = NULL;
   grid->cells           = util_calloc(grid->size , sizeof * grid->cells );
 #ifndef LARGE_CELL_MALLOC
   {
@@ -1291,7 +1632,7 @@ static void ecl_grid_alloc_cells( ecl_grid_type * grid , bool init_valid) {
    is performed.
 */
 
-static ecl_grid_type * ecl_grid_alloc_empty(ecl_grid_type * global_grid , int dualp_flag , int nx , int ny , int nz, int lgr_nr, bool init_valid) {
+static ecl_grid_type * ecl_grid_alloc_empty(ecl_grid_type * global_grid , int dualp_flag , int nx , int ny , int nz, int lgr_nr, bool init_valid , int flags) {
   ecl_grid_type * grid = util_malloc(sizeof * grid );
   UTIL_TYPE_ID_INIT(grid , ECL_GRID_ID);
   grid->total_active   = 0;
@@ -1306,12 +1647,27 @@ static ecl_grid_type * ecl_grid_alloc_empty(ecl_grid_type * global_grid , int du
 
   grid->dualp_flag            = dualp_flag;
   grid->coord_kw              = NULL;
-  grid->visited               = NULL;
+  grid->cell_bvh              = NULL;
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &grid->cell_bvh_lock , NULL );
+#endif
+  grid->lazy_geometry         = NULL;
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &grid->geometry_lock , NULL );
+#endif
+  grid->nnc_table             = NULL;
+  grid->nnc_info_loaded       = false;
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &grid->nnc_lock , NULL );
+#endif
   grid->inv_index_map         = NULL;
   grid->index_map             = NULL; 
   grid->fracture_index_map    = NULL;
   grid->inv_fracture_index_map = NULL;
-  ecl_grid_alloc_cells( grid , init_valid );
+  if (flags & ECL_GRID_COMPACT)
+    ecl_grid_alloc_compact_cells( grid , init_valid );
+  else
+    ecl_grid_alloc_cells( grid , init_valid );
   
 
   if (global_grid != NULL) {
@@ -1367,7 +1723,8 @@ static void ecl_grid_set_cell_EGRID(ecl_grid_type * ecl_grid , int i, int j , in
                                     const int * actnum, const int * corsnum) {
   
   const int global_index   = ecl_grid_get_global_index__(ecl_grid , i , j  , k );
-  ecl_cell_type * cell     = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell     = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer );
   int ip , iz;
 
   for (iz = 0; iz < 2; iz++) {
@@ -1396,6 +1753,8 @@ static void ecl_grid_set_cell_EGRID(ecl_grid_type * ecl_grid , int i, int j , in
   
   if (corsnum != NULL)
     cell->coarse_group = corsnum[ global_index ] - 1;
+
+  ecl_grid_store_cell( ecl_grid , global_index , cell );
 }
 
 
@@ -1405,6 +1764,7 @@ static void ecl_grid_set_cell_GRID(ecl_grid_type * ecl_grid , int coords_size ,
   const int j  = coords[1] - 1;
   int k  = coords[2] - 1;
   int global_index;
+  ecl_cell_type cell_buffer;
   ecl_cell_type * cell;
   bool matrix_cell = true;
   int active_value = ACTIVE_MATRIX;
@@ -1425,7 +1785,7 @@ static void ecl_grid_set_cell_GRID(ecl_grid_type * ecl_grid , int coords_size ,
 
 
   global_index = ecl_grid_get_global_index__(ecl_grid , i, j , k);
-  cell = ecl_grid_get_cell( ecl_grid , global_index);
+  cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer);
   
   /* the coords keyword can optionally contain 4,5 or 7 elements:
 
@@ -1489,6 +1849,7 @@ static void ecl_grid_set_cell_GRID(ecl_grid_type * ecl_grid , int coords_size ,
     }
   }
   SET_CELL_FLAG(cell , CELL_FLAG_VALID );
+  ecl_grid_store_cell( ecl_grid , global_index , cell );
 }
 
 
@@ -1502,7 +1863,8 @@ static void ecl_grid_init_index_map__( ecl_grid_type * ecl_grid , int * index_ma
   int global_index;
 
   for (global_index = 0; global_index < ecl_grid->size; global_index++) {     
-    const ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index);
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer);
     if (cell->active & active_mask) {
       index_map[global_index] = cell->active_index[type_index];
       
@@ -1589,10 +1951,12 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
        groups and single porosity. */
     {
       for (global_index = 0; global_index < ecl_grid->size; global_index++) {
-        ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index);
+        ecl_cell_type cell_buffer;
+        ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer);
         
         if (cell->active & ACTIVE_MATRIX) {
           cell->active_index[MATRIX_INDEX] = active_index;
+          ecl_grid_store_cell_attr( ecl_grid , global_index , cell );
           active_index++;
         } 
       }
@@ -1600,9 +1964,11 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
     
     if (ecl_grid->dualp_flag != FILEHEAD_SINGLE_POROSITY) {
       for (global_index = 0; global_index < ecl_grid->size; global_index++) {
-        ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index);
+        ecl_cell_type cell_buffer;
+        ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer);
         if (cell->active & ACTIVE_FRACTURE) {
           cell->active_index[FRACTURE_INDEX] = active_fracture_index;
+          ecl_grid_store_cell_attr( ecl_grid , global_index , cell );
           active_fracture_index++;
         } 
       }
@@ -1615,7 +1981,8 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
           the entire coarse cell.
     */
     for (global_index = 0; global_index < ecl_grid->size; global_index++) {
-      ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index);
+      ecl_cell_type cell_buffer;
+      ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer);
       if (cell->active != INACTIVE) {
         if (cell->coarse_group == COARSE_GROUP_NONE) {
           
@@ -1633,6 +2000,7 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
           ecl_coarse_cell_type * coarse_cell = ecl_grid_iget_coarse_group( ecl_grid , cell->coarse_group );
           ecl_coarse_cell_update_index( coarse_cell , global_index , &active_index , &active_fracture_index , cell->active);
         }
+        ecl_grid_store_cell_attr( ecl_grid , global_index , cell );
       } 
     }
 
@@ -1656,7 +2024,8 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
           for (i=0; i < group_size; i++) {
             global_index = coarse_cell_list[i];
             {
-              ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+              ecl_cell_type cell_buffer;
+              ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer );
               
               if (cell_active_value & ACTIVE_MATRIX)
                 cell->active_index[MATRIX_INDEX] = cell_active_index;
@@ -1666,6 +2035,7 @@ static void ecl_grid_set_active_index(ecl_grid_type * ecl_grid) {
                 int cell_active_fracture_index = ecl_coarse_cell_get_active_fracture_index( coarse_cell );
                 cell->active_index[FRACTURE_INDEX] = cell_active_fracture_index;
               }
+              ecl_grid_store_cell_attr( ecl_grid , global_index , cell );
             }
           }
 
@@ -1699,7 +2069,8 @@ static void ecl_grid_init_coarse_cells( ecl_grid_type * ecl_grid ) {
   if (ecl_grid->coarsening_active) {
     int global_index;
     for (global_index = 0; global_index < ecl_grid->size; global_index++) {
-      ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+      ecl_cell_type cell_buffer;
+      ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer );
       if (cell->coarse_group != COARSE_GROUP_NONE) {
         ecl_coarse_cell_type * coarse_cell = ecl_grid_get_or_create_coarse_cell( ecl_grid , cell->coarse_group);
         int i,j,k;
@@ -1717,7 +2088,8 @@ ecl_coarse_cell_type * ecl_grid_iget_coarse_group( const ecl_grid_type * ecl_gri
 
 
 ecl_coarse_cell_type * ecl_grid_get_cell_coarse_group1( const ecl_grid_type * ecl_grid , int global_index) {
-  ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer );
   if (cell->coarse_group == COARSE_GROUP_NONE)
     return NULL;
   else
@@ -1732,7 +2104,8 @@ ecl_coarse_cell_type * ecl_grid_get_cell_coarse_group3( const ecl_grid_type * ec
 
 
 bool ecl_grid_cell_in_coarse_group1( const ecl_grid_type * main_grid , int global_index ) {
-  ecl_cell_type * cell = ecl_grid_get_cell( main_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_attr_view( main_grid , global_index , &cell_buffer );
   if (cell->coarse_group == COARSE_GROUP_NONE )
     return false;
   else
@@ -1855,11 +2228,15 @@ static void ecl_grid_install_lgr_EGRID(ecl_grid_type * host_grid , ecl_grid_type
 
   for (global_lgr_index = 0; global_lgr_index < lgr_grid->size; global_lgr_index++) {
     int host_index = hostnum[ global_lgr_index ] - 1;
-    ecl_cell_type * lgr_cell  = ecl_grid_get_cell( lgr_grid , global_lgr_index);
-    ecl_cell_type * host_cell = ecl_grid_get_cell( host_grid ,  host_index );
+    ecl_cell_type lgr_buffer;
+    ecl_cell_type host_buffer;
+    ecl_cell_type * lgr_cell  = ecl_grid_get_cell_attr_view( lgr_grid , global_lgr_index , &lgr_buffer);
+    ecl_cell_type * host_cell = ecl_grid_get_cell_attr_view( host_grid ,  host_index , &host_buffer );
   
     ecl_cell_install_lgr( host_cell , lgr_grid );
     lgr_cell->host_cell = host_index;
+    ecl_grid_store_cell_attr( host_grid , host_index , host_cell );
+    ecl_grid_store_cell_attr( lgr_grid , global_lgr_index , lgr_cell );
   }
   ecl_grid_install_lgr_common( host_grid , lgr_grid );
 }
@@ -1872,9 +2249,12 @@ static void ecl_grid_install_lgr_GRID(ecl_grid_type * host_grid , ecl_grid_type
   int global_lgr_index;
   
   for (global_lgr_index = 0; global_lgr_index < lgr_grid->size; global_lgr_index++) {
-    ecl_cell_type * lgr_cell = ecl_grid_get_cell( lgr_grid , global_lgr_index);
-    ecl_cell_type * host_cell = ecl_grid_get_cell( host_grid , lgr_cell->host_cell );
+    ecl_cell_type lgr_buffer;
+    ecl_cell_type host_buffer;
+    ecl_cell_type * lgr_cell = ecl_grid_get_cell_attr_view( lgr_grid , global_lgr_index , &lgr_buffer);
+    ecl_cell_type * host_cell = ecl_grid_get_cell_attr_view( host_grid , lgr_cell->host_cell , &host_buffer );
     ecl_cell_install_lgr( host_cell , lgr_grid );
+    ecl_grid_store_cell_attr( host_grid , lgr_cell->host_cell , host_cell );
   }
   ecl_grid_install_lgr_common( host_grid , lgr_grid );
 }
@@ -2002,12 +2382,166 @@ static void ecl_grid_init_GRDECL_data_jslice(ecl_grid_type * ecl_grid ,  const f
 }
 
 
+#if defined(WITH_PTHREAD) && !defined(_OPENMP)
+static void * ecl_grid_init_GRDECL_data_jslices__( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  ecl_grid_type * ecl_grid = arg_pack_iget_ptr( arg_pack , 0 );
+  const float * zcorn      = arg_pack_iget_const_ptr( arg_pack , 1 );
+  const float * coord      = arg_pack_iget_const_ptr( arg_pack , 2 );
+  const int   * actnum     = arg_pack_iget_const_ptr( arg_pack , 3 );
+  const int   * corsnum    = arg_pack_iget_const_ptr( arg_pack , 4 );
+  int j1                   = arg_pack_iget_int( arg_pack , 5 );
+  int j2                   = arg_pack_iget_int( arg_pack , 6 );
+  int j;
+
+  for (j = j1; j < j2; j++)
+    ecl_grid_init_GRDECL_data_jslice( ecl_grid , zcorn , coord , actnum , corsnum , j );
+  
+  return NULL;
+}
+#endif
+
+
+/*
+  The j slices are initialized in parallel; with OpenMP if that is
+  available, otherwise with a thread pool - where the grid is large
+  enough to make that worthwhile.
+*/
+
 void ecl_grid_init_GRDECL_data(ecl_grid_type * ecl_grid ,  const float * zcorn , const float * coord , const int * actnum, const int * corsnum) {
   const int ny = ecl_grid->ny;
-  int j;
+  {
+    point_type p0;
+    point_set( &p0 , coord[0] , coord[1] , zcorn[0] );
+    if (ecl_grid->use_mapaxes)
+      point_mapaxes_transform( &p0 , ecl_grid->origo , ecl_grid->unit_x , ecl_grid->unit_y );
+    ecl_grid_set_compact_offset( ecl_grid , p0.x , p0.y , p0.z );
+  }
+#ifdef _OPENMP
+  {
+    int j;
 #pragma omp parallel for
-  for ( j=0; j < ny; j++) 
-    ecl_grid_init_GRDECL_data_jslice( ecl_grid , zcorn, coord , actnum , corsnum , j );
+    for ( j=0; j < ny; j++) 
+      ecl_grid_init_GRDECL_data_jslice( ecl_grid , zcorn, coord , actnum , corsnum , j );
+  }
+#else
+  {
+    int num_threads = 1;
+#ifdef WITH_PTHREAD
+    if (ecl_grid->size >= ECL_GRID_MT_MIN_SIZE) 
+      num_threads = util_int_min( ny , util_int_max( 1 , sysconf( _SC_NPROCESSORS_ONLN )));
+#endif
+    
+    if (num_threads == 1) {
+      int j;
+      for ( j=0; j < ny; j++) 
+        ecl_grid_init_GRDECL_data_jslice( ecl_grid , zcorn, coord , actnum , corsnum , j );
+    } 
+#ifdef WITH_PTHREAD
+    else {
+      thread_pool_type * tp = thread_pool_alloc( num_threads , true );
+      arg_pack_type ** arg_list = util_calloc( num_threads , sizeof * arg_list );
+      int ithread;
+      
+      for (ithread = 0; ithread < num_threads; ithread++) {
+        arg_list[ithread] = arg_pack_alloc();
+        arg_pack_append_ptr( arg_list[ithread] , ecl_grid );
+        arg_pack_append_const_ptr( arg_list[ithread] , zcorn );
+        arg_pack_append_const_ptr( arg_list[ithread] , coord );
+        arg_pack_append_const_ptr( arg_list[ithread] , actnum );
+        arg_pack_append_const_ptr( arg_list[ithread] , corsnum );
+        arg_pack_append_int( arg_list[ithread] , (ithread * ny) / num_threads );
+        arg_pack_append_int( arg_list[ithread] , ((ithread + 1) * ny) / num_threads );
+        thread_pool_add_job( tp , ecl_grid_init_GRDECL_data_jslices__ , arg_list[ithread] );
+      }
+      thread_pool_join( tp );
+      thread_pool_free( tp );
+      
+      for (ithread = 0; ithread < num_threads; ithread++)
+        arg_pack_free( arg_list[ithread] );
+      free( arg_list );
+    }
+#endif
+  }
+#endif
+}
+
+
+static void ecl_grid_lazy_free( ecl_grid_lazy_type * lazy ) {
+  free( lazy->zcorn );
+  util_safe_free( lazy->actnum );
+  util_safe_free( lazy->corsnum );
+  free( lazy );
+}
+
+
+/*
+  Will set the active and coarse_group properties of the cells, but
+  not the geometry; that is deferred to ecl_grid_assert_geometry().
+*/
+
+static void ecl_grid_init_GRDECL_lazy(ecl_grid_type * ecl_grid ,  const float * zcorn , const int * actnum, const int * corsnum) {
+  ecl_grid_lazy_type * lazy = util_malloc( sizeof * lazy );
+  int global_index;
+
+  for (global_index = 0; global_index < ecl_grid->size; global_index++) {
+    ecl_cell_type cell_buffer;
+    ecl_cell_type * cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer );
+    
+    cell->active = (actnum == NULL) ? ACTIVE : actnum[global_index];
+    if (corsnum != NULL)
+      cell->coarse_group = corsnum[ global_index ] - 1;
+    
+    ecl_grid_store_cell_attr( ecl_grid , global_index , cell );
+  }
+
+  lazy->zcorn   = util_alloc_copy( zcorn , 8 * ecl_grid->size * sizeof * zcorn );
+  lazy->actnum  = (actnum == NULL)  ? NULL : util_alloc_copy( actnum , ecl_grid->size * sizeof * actnum );
+  lazy->corsnum = (corsnum == NULL) ? NULL : util_alloc_copy( corsnum , ecl_grid->size * sizeof * corsnum );
+  ecl_grid->lazy_geometry = lazy;
+}
+
+
+static void ecl_grid_init_lazy_geometry( ecl_grid_type * ecl_grid ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &ecl_grid->geometry_lock );
+#endif
+  if (ecl_grid->lazy_geometry != NULL) {
+    ecl_grid_lazy_type * lazy = ecl_grid->lazy_geometry;
+    
+    ecl_grid_init_GRDECL_data( ecl_grid , lazy->zcorn , ecl_kw_get_float_ptr( ecl_grid->coord_kw ) , lazy->actnum , lazy->corsnum );
+    ecl_grid_taint_cells( ecl_grid );
+    
+    /* Release: the cell geometry must be visible before lazy_geometry is seen as NULL. */
+    __atomic_store_n( &ecl_grid->lazy_geometry , NULL , __ATOMIC_RELEASE );
+    ecl_grid_lazy_free( lazy );
+  }
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &ecl_grid->geometry_lock );
+#endif
+}
+
+
+/*
+  The unlocked test of lazy_geometry is an acquire load, pairing with
+  the release store in ecl_grid_init_lazy_geometry(); a thread which
+  sees lazy_geometry == NULL is guaranteed to also see the initialized
+  cell geometry.
+*/
+
+static bool ecl_grid_lazy_geometry_done( const ecl_grid_type * grid ) {
+  return (__atomic_load_n( &grid->lazy_geometry , __ATOMIC_ACQUIRE ) == NULL);
+}
+
+
+static void ecl_grid_assert_geometry( const ecl_grid_type * grid ) {
+  if (!ecl_grid_lazy_geometry_done( grid ))
+    ecl_grid_init_lazy_geometry( (ecl_grid_type *) grid );
+}
+
+
+bool ecl_grid_has_geometry( const ecl_grid_type * grid ) {
+  return ecl_grid_lazy_geometry_done( grid );
 }
 
 
@@ -2021,9 +2555,9 @@ void ecl_grid_init_GRDECL_data(ecl_grid_type * ecl_grid ,  const float * zcorn ,
 static ecl_grid_type * ecl_grid_alloc_GRDECL_data__(ecl_grid_type * global_grid , 
                                                     int dualp_flag , int nx , int ny , int nz , 
                                                     const float * zcorn , const float * coord , const int * actnum, const float * mapaxes, const int * corsnum, 
-                                                    int lgr_nr) {
+                                                    int lgr_nr , int flags) {
 
-  ecl_grid_type * ecl_grid = ecl_grid_alloc_empty(global_grid , dualp_flag , nx,ny,nz,lgr_nr,true);
+  ecl_grid_type * ecl_grid = ecl_grid_alloc_empty(global_grid , dualp_flag , nx,ny,nz,lgr_nr,true,flags);
   
   if (mapaxes != NULL)
     ecl_grid_init_mapaxes( ecl_grid , mapaxes );
@@ -2032,11 +2566,15 @@ static ecl_grid_type * ecl_grid_alloc_GRDECL_data__(ecl_grid_type * global_grid
     ecl_grid->coarsening_active = true;
   
   ecl_grid->coord_kw = ecl_kw_alloc_new("COORD" , 6*(nx + 1) * (ny + 1) , ECL_FLOAT_TYPE , coord );
-  ecl_grid_init_GRDECL_data( ecl_grid , zcorn , coord , actnum , corsnum);
+  if (flags & ECL_GRID_LAZY)
+    ecl_grid_init_GRDECL_lazy( ecl_grid , zcorn , actnum , corsnum );
+  else
+    ecl_grid_init_GRDECL_data( ecl_grid , zcorn , coord , actnum , corsnum);
 
   ecl_grid_init_coarse_cells( ecl_grid );
   ecl_grid_update_index( ecl_grid );
-  ecl_grid_taint_cells( ecl_grid );
+  if (!(flags & ECL_GRID_LAZY))
+    ecl_grid_taint_cells( ecl_grid );
   return ecl_grid;
 }
 
@@ -2048,7 +2586,7 @@ static ecl_grid_type * ecl_grid_alloc_GRDECL_data__(ecl_grid_type * global_grid
 */
 
 ecl_grid_type * ecl_grid_alloc_GRDECL_data(int nx , int ny , int nz , const float * zcorn , const float * coord , const int * actnum, const float * mapaxes) {
-  return ecl_grid_alloc_GRDECL_data__(NULL , FILEHEAD_SINGLE_POROSITY , nx , ny , nz , zcorn , coord , actnum , mapaxes , NULL , 0);
+  return ecl_grid_alloc_GRDECL_data__(NULL , FILEHEAD_SINGLE_POROSITY , nx , ny , nz , zcorn , coord , actnum , mapaxes , NULL , 0 , 0);
 }
 
 static ecl_grid_type * ecl_grid_alloc_GRDECL_kw__(ecl_grid_type * global_grid ,  
@@ -2058,7 +2596,8 @@ static ecl_grid_type * ecl_grid_alloc_GRDECL_kw__(ecl_grid_type * global_grid ,
                                                   const ecl_kw_type * coord_kw , 
                                                   const ecl_kw_type * actnum_kw ,    /* Can be NULL */ 
                                                   const ecl_kw_type * mapaxes_kw ,   /* Can be NULL */
-                                                  const ecl_kw_type * corsnum_kw) {   /* Can be NULL */ 
+                                                  const ecl_kw_type * corsnum_kw,     /* Can be NULL */ 
+                                                  int flags) {
    int gtype, nx,ny,nz, lgr_nr;
   
   gtype   = ecl_kw_iget_int(gridhead_kw , GRIDHEAD_TYPE_INDEX);
@@ -2101,7 +2640,8 @@ static ecl_grid_type * ecl_grid_alloc_GRDECL_kw__(ecl_grid_type * global_grid ,
                                         actnum_data,
                                         mapaxes_data, 
                                         corsnum_data,
-                                        lgr_nr);
+                                        lgr_nr , 
+                                        flags);
   }
 }
 
@@ -2121,7 +2661,7 @@ ecl_grid_type * ecl_grid_alloc_GRDECL_kw( int nx, int ny , int nz ,
 
 
   ecl_kw_type * gridhead_kw = ecl_grid_alloc_gridhead_kw( nx , ny , nz , 0);
-  ecl_grid_type * ecl_grid = ecl_grid_alloc_GRDECL_kw__(NULL , FILEHEAD_SINGLE_POROSITY , gridhead_kw , zcorn_kw , coord_kw , actnum_kw , mapaxes_kw , NULL);
+  ecl_grid_type * ecl_grid = ecl_grid_alloc_GRDECL_kw__(NULL , FILEHEAD_SINGLE_POROSITY , gridhead_kw , zcorn_kw , coord_kw , actnum_kw , mapaxes_kw , NULL , 0);
   ecl_kw_free( gridhead_kw );
   return ecl_grid;
 
@@ -2132,17 +2672,29 @@ ecl_grid_type * ecl_grid_alloc_GRDECL_kw( int nx, int ny , int nz ,
 
 
 
-static void ecl_grid_init_cell_nnc_info(ecl_grid_type * ecl_grid, int global_index) {
-  ecl_cell_type * grid_cell = ecl_grid_get_cell(ecl_grid, global_index);
+static nnc_info_type * ecl_grid_init_cell_nnc_info(ecl_grid_type * ecl_grid, int global_index) {
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * grid_cell = ecl_grid_get_cell_attr_view(ecl_grid, global_index , &cell_buffer);
   
-  if (!grid_cell->nnc_info) 
+  if (!grid_cell->nnc_info) {
     grid_cell->nnc_info = nnc_info_alloc(ecl_grid->lgr_nr); 
+    ecl_grid_store_cell_attr( ecl_grid , global_index , grid_cell );
+  }
+  return grid_cell->nnc_info;
+}
+
+
+static nnc_table_type * ecl_grid_assert_nnc_table( ecl_grid_type * ecl_grid ) {
+  if (ecl_grid->nnc_table == NULL)
+    ecl_grid->nnc_table = nnc_table_alloc( ecl_grid->lgr_nr , ecl_grid->size );
+  return ecl_grid->nnc_table;
 }
 
 
 /*
-  This function populates nnc_info for cells with non neighbour
-  connections. For cells C1 and C2 the function will only add the directed link: 
+  This function populates the nnc_table of grid1 with the cells with
+  non neighbour connections. For cells C1 and C2 the function will
+  only add the directed link:
 
       C1 -> C2
 
@@ -2187,14 +2739,72 @@ static void ecl_grid_init_nnc_cells( ecl_grid_type * grid1, ecl_grid_type * grid
 
     
     {
-      ecl_cell_type * grid1_cell = ecl_grid_get_cell(grid1, grid1_cell_index);
-      ecl_grid_init_cell_nnc_info(grid1, grid1_cell_index);
-      nnc_info_add_nnc(grid1_cell->nnc_info, grid2->lgr_nr, grid2_cell_index , nnc_index);
+      nnc_table_type * nnc_table = ecl_grid_assert_nnc_table( grid1 );
+      nnc_table_add_nnc( nnc_table , grid1_cell_index , grid2->lgr_nr , grid2_cell_index , nnc_index );
+    }
+  }
+}
+
+
+static void ecl_grid_build_nnc_tables( ecl_grid_type * main_grid ) {
+  if (main_grid->nnc_table != NULL)
+    nnc_table_build( main_grid->nnc_table );
+  {
+    int grid_nr;
+    for (grid_nr = 0; grid_nr < vector_get_size( main_grid->LGR_list ); grid_nr++) {
+      ecl_grid_type * igrid = vector_iget( main_grid->LGR_list , grid_nr );
+      if (igrid->nnc_table != NULL)
+        nnc_table_build( igrid->nnc_table );
     }
   }
 }
 
 
+/*
+  The nnc_info instances of the cells are only created from the
+  nnc_table when they are first requested with
+  ecl_grid_get_cell_nnc_info1(); the nnc export and counting
+  functions work directly on the nnc_table.
+*/
+
+static void ecl_grid_init_nnc_info( ecl_grid_type * ecl_grid ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &ecl_grid->nnc_lock );
+#endif
+  if (!ecl_grid->nnc_info_loaded) {
+    const nnc_table_type * nnc_table = ecl_grid->nnc_table;
+    if (nnc_table != NULL) {
+      int global_index1;
+      for (global_index1 = 0; global_index1 < ecl_grid->size; global_index1++) {
+        int cell_size = nnc_table_get_cell_size( nnc_table , global_index1 );
+        if (cell_size > 0) {
+          nnc_info_type * nnc_info = ecl_grid_init_cell_nnc_info( ecl_grid , global_index1 );
+          int offset = nnc_table_get_cell_offset( nnc_table , global_index1 );
+          int index;
+
+          for (index = offset; index < offset + cell_size; index++)
+            nnc_info_add_nnc( nnc_info ,
+                              nnc_table_iget_lgr_nr( nnc_table , index ) ,
+                              nnc_table_iget_global_index( nnc_table , index ) ,
+                              nnc_table_iget_nnc_index( nnc_table , index ));
+        }
+      }
+    }
+    /* Release: pairs with the acquire load in ecl_grid_assert_nnc_info(). */
+    __atomic_store_n( &ecl_grid->nnc_info_loaded , true , __ATOMIC_RELEASE );
+  }
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &ecl_grid->nnc_lock );
+#endif
+}
+
+
+static void ecl_grid_assert_nnc_info( const ecl_grid_type * grid ) {
+  if (!__atomic_load_n( &grid->nnc_info_loaded , __ATOMIC_ACQUIRE ))
+    ecl_grid_init_nnc_info( (ecl_grid_type *) grid );
+}
+
+
 /*
   This function reads the non-neighbour connection data from file and initializes the grid structure with the the nnc data
 */
@@ -2275,7 +2885,7 @@ static void ecl_grid_init_nnc_amalgamated(ecl_grid_type * main_grid, ecl_file_ty
 */
 
 
-static ecl_grid_type * ecl_grid_alloc_EGRID__( ecl_grid_type * main_grid , const ecl_file_type * ecl_file , int grid_nr) {
+static ecl_grid_type * ecl_grid_alloc_EGRID__( ecl_grid_type * main_grid , const ecl_file_type * ecl_file , int grid_nr , int flags) {
   ecl_kw_type * gridhead_kw  = ecl_file_iget_named_kw( ecl_file , GRIDHEAD_KW  , grid_nr);
   ecl_kw_type * zcorn_kw     = ecl_file_iget_named_kw( ecl_file , ZCORN_KW     , grid_nr);
   ecl_kw_type * coord_kw     = ecl_file_iget_named_kw( ecl_file , COORD_KW     , grid_nr);
@@ -2313,7 +2923,8 @@ static ecl_grid_type * ecl_grid_alloc_EGRID__( ecl_grid_type * main_grid , const
                                                            coord_kw , 
                                                            actnum_kw , 
                                                            mapaxes_kw , 
-                                                           corsnum_kw );
+                                                           corsnum_kw , 
+                                                           flags );
                                                            
     if (ECL_GRID_MAINGRID_LGR_NR != grid_nr) ecl_grid_set_lgr_name_EGRID(ecl_grid , ecl_file , grid_nr);
     return ecl_grid;
@@ -2322,7 +2933,7 @@ static ecl_grid_type * ecl_grid_alloc_EGRID__( ecl_grid_type * main_grid , const
 
 
 
-static ecl_grid_type * ecl_grid_alloc_EGRID(const char * grid_file) {
+static ecl_grid_type * ecl_grid_alloc_EGRID(const char * grid_file , int flags) {
   ecl_file_enum   file_type;
   file_type = ecl_util_get_file_type(grid_file , NULL , NULL);
   if (file_type != ECL_EGRID_FILE)
@@ -2330,11 +2941,11 @@ static ecl_grid_type * ecl_grid_alloc_EGRID(const char * grid_file) {
   {
     ecl_file_type * ecl_file   = ecl_file_open( grid_file , 0);
     int num_grid               = ecl_file_get_num_named_kw( ecl_file , GRIDHEAD_KW );
-    ecl_grid_type * main_grid  = ecl_grid_alloc_EGRID__( NULL , ecl_file , 0 );
+    ecl_grid_type * main_grid  = ecl_grid_alloc_EGRID__( NULL , ecl_file , 0 , flags );
     int grid_nr;
     
     for ( grid_nr = 1; grid_nr < num_grid; grid_nr++) {
-      ecl_grid_type * lgr_grid = ecl_grid_alloc_EGRID__( main_grid , ecl_file , grid_nr );
+      ecl_grid_type * lgr_grid = ecl_grid_alloc_EGRID__( main_grid , ecl_file , grid_nr , flags );
       ecl_grid_add_lgr( main_grid , lgr_grid );
       {
         ecl_grid_type * host_grid;
@@ -2351,6 +2962,7 @@ static ecl_grid_type * ecl_grid_alloc_EGRID(const char * grid_file) {
     
     ecl_grid_init_nnc(main_grid, ecl_file); 
     ecl_grid_init_nnc_amalgamated(main_grid, ecl_file); 
+    ecl_grid_build_nnc_tables( main_grid );
     
     ecl_file_close( ecl_file );
     return main_grid;
@@ -2363,15 +2975,23 @@ static ecl_grid_type * ecl_grid_alloc_EGRID(const char * grid_file) {
 
 
 
-static ecl_grid_type * ecl_grid_alloc_GRID_data__(ecl_grid_type * global_grid , int num_coords , int dualp_flag , int nx, int ny , int nz , int grid_nr , int coords_size , int ** coords , float ** corners , const float * mapaxes) {
+static ecl_grid_type * ecl_grid_alloc_GRID_data__(ecl_grid_type * global_grid , int num_coords , int dualp_flag , int nx, int ny , int nz , int grid_nr , int coords_size , int ** coords , float ** corners , const float * mapaxes , int flags) {
   if (dualp_flag != FILEHEAD_SINGLE_POROSITY)
     nz = nz / 2;
   {
-    ecl_grid_type * grid = ecl_grid_alloc_empty( global_grid , dualp_flag , nx , ny , nz , grid_nr, false);
+    ecl_grid_type * grid = ecl_grid_alloc_empty( global_grid , dualp_flag , nx , ny , nz , grid_nr, false , flags);
     
     if (mapaxes != NULL)
       ecl_grid_init_mapaxes( grid , mapaxes );
     
+    if (num_coords > 0) {
+      point_type p0;
+      point_set( &p0 , corners[0][0] , corners[0][1] , corners[0][2] );
+      if (grid->use_mapaxes)
+        point_mapaxes_transform( &p0 , grid->origo , grid->unit_x , grid->unit_y );
+      ecl_grid_set_compact_offset( grid , p0.x , p0.y , p0.z );
+    }
+
     {
       int index;
       for ( index=0; index < num_coords; index++) 
@@ -2394,7 +3014,7 @@ ecl_grid_type * ecl_grid_alloc_GRID_data(int num_coords , int nx , int ny , int
   return ecl_grid_alloc_GRID_data__( NULL , 
                                      num_coords , 
                                      FILEHEAD_SINGLE_POROSITY , /* Does currently not support to determine dualp_flag from inspection. */
-                                     nx , ny , nz , 0 , coords_size , coords , corners , mapaxes);
+                                     nx , ny , nz , 0 , coords_size , coords , corners , mapaxes , 0);
 }
 
 
@@ -2441,7 +3061,7 @@ static int ecl_grid_dual_porosity_GRID_check( ecl_file_type * ecl_file ) {
 }
 
 
-static ecl_grid_type * ecl_grid_alloc_GRID__(ecl_grid_type * global_grid , const ecl_file_type * ecl_file , int cell_offset , int grid_nr, int dualp_flag) {
+static ecl_grid_type * ecl_grid_alloc_GRID__(ecl_grid_type * global_grid , const ecl_file_type * ecl_file , int cell_offset , int grid_nr, int dualp_flag , int flags) {
   int           nx,ny,nz;
   const float * mapaxes_data = NULL;
   ecl_grid_type * grid;
@@ -2536,7 +3156,7 @@ static ecl_grid_type * ecl_grid_alloc_GRID__(ecl_grid_type * global_grid , const
         coords_size = ecl_kw_get_size( coords_kw );
       }
       // Create the grid:
-      grid = ecl_grid_alloc_GRID_data__( global_grid , num_coords , dualp_flag , nx , ny , nz , grid_nr , coords_size , coords , corners , mapaxes_data );
+      grid = ecl_grid_alloc_GRID_data__( global_grid , num_coords , dualp_flag , nx , ny , nz , grid_nr , coords_size , coords , corners , mapaxes_data , flags );
 
       free( coords );
       free( corners );
@@ -2551,7 +3171,7 @@ static ecl_grid_type * ecl_grid_alloc_GRID__(ecl_grid_type * global_grid , const
 
 
 
-static ecl_grid_type * ecl_grid_alloc_GRID(const char * grid_file) {
+static ecl_grid_type * ecl_grid_alloc_GRID(const char * grid_file , int flags) {
 
   ecl_file_enum   file_type;
   file_type = ecl_util_get_file_type(grid_file , NULL , NULL);
@@ -2567,11 +3187,11 @@ static ecl_grid_type * ecl_grid_alloc_GRID(const char * grid_file) {
     int dualp_flag;
 
     dualp_flag = ecl_grid_dual_porosity_GRID_check( ecl_file );
-    main_grid  = ecl_grid_alloc_GRID__(NULL , ecl_file , cell_offset , 0,dualp_flag);
+    main_grid  = ecl_grid_alloc_GRID__(NULL , ecl_file , cell_offset , 0,dualp_flag , flags);
     cell_offset += ecl_grid_get_global_size( main_grid );
 
     for (grid_nr = 1; grid_nr < num_grid; grid_nr++) {
-      ecl_grid_type * lgr_grid = ecl_grid_alloc_GRID__(main_grid , ecl_file , cell_offset , grid_nr , dualp_flag);
+      ecl_grid_type * lgr_grid = ecl_grid_alloc_GRID__(main_grid , ecl_file , cell_offset , grid_nr , dualp_flag , flags);
       cell_offset += ecl_grid_get_global_size( lgr_grid );
       ecl_grid_add_lgr( main_grid , lgr_grid );
       {
@@ -2604,7 +3224,7 @@ static ecl_grid_type * ecl_grid_alloc_GRID(const char * grid_file) {
    which case all cells will be active.
 */
 ecl_grid_type * ecl_grid_alloc_regular( int nx, int ny , int nz , const double * ivec, const double * jvec , const double * kvec , const int * actnum) {
-  ecl_grid_type * grid = ecl_grid_alloc_empty(NULL , FILEHEAD_SINGLE_POROSITY , nx , ny , nz , 0, true);
+  ecl_grid_type * grid = ecl_grid_alloc_empty(NULL , FILEHEAD_SINGLE_POROSITY , nx , ny , nz , 0, true , 0);
   const double grid_offset[3] = {0,0,0};
 
   int k,j,i;
@@ -2662,7 +3282,7 @@ ecl_grid_type * ecl_grid_alloc_dxv_dyv_dzv( int nx, int ny , int nz , const doub
     ecl_grid_type* grid = ecl_grid_alloc_empty(NULL,
                                                FILEHEAD_SINGLE_POROSITY,
                                                nx, ny, nz,
-                                               /*lgr_nr=*/0, /*init_valid=*/true);
+                                               /*lgr_nr=*/0, /*init_valid=*/true, /*flags=*/0);
 
     double ivec[3] = { 0, 0, 0 };
     double jvec[3] = { 0, 0, 0 };
@@ -2709,15 +3329,30 @@ ecl_grid_type * ecl_grid_alloc_dxv_dyv_dzv( int nx, int ny , int nz , const doub
    with these keywords.
 */
 
-ecl_grid_type * ecl_grid_alloc(const char * grid_file ) {
+/**
+   Will load the grid from a GRID or EGRID file. The @flags argument
+   is a combination of ECL_GRID_COMPACT and ECL_GRID_LAZY:
+
+     ECL_GRID_COMPACT: See ecl_grid_alloc_compact().
+
+     ECL_GRID_LAZY: The cell geometry (i.e. the corners and centers)
+        is not calculated when loading, only when the grid is queried
+        for geometry the first time. The dimensions, the active index
+        maps, LGR and NNC information are available immediately. This
+        is much faster for code which only needs the index
+        mapping. The flag only applies to EGRID files; GRID files are
+        always loaded fully.
+*/
+
+ecl_grid_type * ecl_grid_alloc_flags(const char * grid_file , int flags) {
   ecl_file_enum    file_type;
   ecl_grid_type  * ecl_grid = NULL;
 
   file_type = ecl_util_get_file_type(grid_file , NULL ,  NULL);
   if (file_type == ECL_GRID_FILE)
-    ecl_grid = ecl_grid_alloc_GRID(grid_file);
+    ecl_grid = ecl_grid_alloc_GRID(grid_file , flags);
   else if (file_type == ECL_EGRID_FILE)
-    ecl_grid = ecl_grid_alloc_EGRID(grid_file);
+    ecl_grid = ecl_grid_alloc_EGRID(grid_file , flags);
   else
     util_abort("%s must have .GRID or .EGRID file - %s not recognized \n", __func__ , grid_file);
   
@@ -2725,6 +3360,30 @@ ecl_grid_type * ecl_grid_alloc(const char * grid_file ) {
 }
 
 
+ecl_grid_type * ecl_grid_alloc(const char * grid_file ) {
+  return ecl_grid_alloc_flags( grid_file , 0 );
+}
+
+
+/**
+   Will load the grid in compact mode; the cell geometry is then
+   stored as float arrays, and the individual cells are only assembled
+   when they are queried. This uses roughly half the memory of
+   ecl_grid_alloc(), at the price of single precision corner
+   coordinates and somewhat slower access to individual cells. Apart
+   from that the compact grid can be used exactly as a normal grid.
+*/
+
+ecl_grid_type * ecl_grid_alloc_compact(const char * grid_file ) {
+  return ecl_grid_alloc_flags( grid_file , ECL_GRID_COMPACT );
+}
+
+
+bool ecl_grid_is_compact( const ecl_grid_type * grid ) {
+  return (grid->compact != NULL);
+}
+
+
 static void ecl_grid_file_nactive_dims( fortio_type * data_fortio , int * dims) {
   if (data_fortio) {
     if (ecl_kw_fseek_kw( INTEHEAD_KW , false , false , data_fortio )) {
@@ -2952,8 +3611,10 @@ static bool ecl_grid_compare__(const ecl_grid_type * g1 , const ecl_grid_type *
     int g;
     for (g = 0; g < g1->size; g++) {
       bool this_equal = true;
-      ecl_cell_type *c1 = ecl_grid_get_cell( g1 , g );
-      ecl_cell_type *c2 = ecl_grid_get_cell( g2 , g );
+      ecl_cell_type c1_buffer;
+      ecl_cell_type * c1 = ecl_grid_get_cell_view( g1 , g , &c1_buffer );
+      ecl_cell_type c2_buffer;
+      ecl_cell_type * c2 = ecl_grid_get_cell_view( g2 , g , &c2_buffer );
       ecl_cell_compare(c1 , c2 , &this_equal);
 
       if (!this_equal) {
@@ -3001,7 +3662,8 @@ bool ecl_grid_compare(const ecl_grid_type * g1 , const ecl_grid_type * g2 , bool
 bool ecl_grid_cell_contains_xyz1( const ecl_grid_type * ecl_grid , int global_index , double x , double y , double z) {
   const double min_volume = 1e-9;
   point_type p;
-  ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer );
   
   point_set( &p , x , y , z);
   /*
@@ -3170,6 +3832,265 @@ bool ecl_grid_cell_contains_xyz3( const ecl_grid_type * ecl_grid , int i , int j
 }
 
 
+/*
+  Batched point in cell tests
+  ---------------------------
+
+  The functions ecl_grid_cell_contains_xyz_list1() and
+  ecl_grid_cell_list_contains_xyz() give exactly the same answers as
+  ecl_grid_cell_contains_xyz1(), but avoid recalculating the cell
+  geometry for every point. The cell dependent part of the test -
+  bounding box, the corner special cases, the sign of the volume and
+  the six bounding planes - is evaluated once and stored in a
+  ecl_cell_contains_type instance; the point dependent part is then
+  evaluated for blocks of points in branch free loops which the
+  compiler can vectorize.
+
+  The plane normals are calculated with exactly the same arithmetic
+  as point3_plane_distance(), so the results are bitwise identical to
+  the scalar version.
+*/
+
+#define ECL_CELL_CONTAINS_BLOCK_SIZE 64
+
+typedef struct {
+  bool    tainted;
+  bool    empty;                   /* Too small volume or degenerate bounding planes; only the corners can be contained. */
+  int     global_index;
+  double  min_x , max_x;
+  double  min_y , max_y;
+  double  min_z , max_z;
+
+  point_type corner_list[8];
+  bool       corner_contains[8];   /* The result when the point coincides exactly with a corner. */
+
+  double  sign;
+  double  plane_x[6] , plane_y[6] , plane_z[6];
+  double  normal_x[6] , normal_y[6] , normal_z[6];
+  double  norm[6];
+} ecl_cell_contains_type;
+
+
+/*
+  Only the bounding box; this is sufficient to reject most points and
+  is much cheaper than the full initialization.
+*/
+
+static void ecl_cell_contains_init_bbox( ecl_cell_contains_type * contains , const ecl_cell_type * cell , int global_index) {
+  contains->global_index = global_index;
+  contains->tainted = GET_CELL_FLAG( cell , CELL_FLAG_TAINTED );
+  if (!contains->tainted) {
+    contains->min_x = ecl_cell_min_x( cell );
+    contains->max_x = ecl_cell_max_x( cell );
+    contains->min_y = ecl_cell_min_y( cell );
+    contains->max_y = ecl_cell_max_y( cell );
+    contains->min_z = ecl_cell_min_z( cell );
+    contains->max_z = ecl_cell_max_z( cell );
+  }
+}
+
+
+static bool ecl_cell_contains_bbox( const ecl_cell_contains_type * contains , double x , double y , double z) {
+  if (contains->tainted)
+    return false;
+
+  return !((z < contains->min_z) | (z > contains->max_z) |
+           (x < contains->min_x) | (x > contains->max_x) |
+           (y < contains->min_y) | (y > contains->max_y));
+}
+
+
+static void ecl_cell_contains_init_planes( ecl_cell_contains_type * contains , const ecl_grid_type * grid , ecl_cell_type * cell) {
+  const double min_volume = 1e-9;
+  int i,j,k,c;
+
+  ecl_grid_get_ijk1( grid , contains->global_index , &i , &j , &k);
+  ecl_cell_assert_center( cell );
+  for (c = 0; c < 8; c++) {
+    contains->corner_list[c] = cell->corner_list[c];
+    contains->corner_contains[c] = ((!(c & 1) || (i == (grid->nx - 1))) &&
+                                    (!(c & 2) || (j == (grid->ny - 1))) &&
+                                    (!(c & 4) || (k == (grid->nz - 1))));
+  }
+
+  {
+    double signed_volume = ecl_cell_get_signed_volume( cell );
+    contains->empty = !(fabs( signed_volume ) > min_volume);
+    contains->sign = (signed_volume < 0) ? -1 : 1;
+  }
+
+  if (!contains->empty) {
+    int plane_nr;
+    for (plane_nr = 0; plane_nr < 6; plane_nr++) {
+      const point_type * p0 = &cell->corner_list[ bounding_planes[plane_nr][0] ];
+      const point_type * p1 = &cell->corner_list[ bounding_planes[plane_nr][1] ];
+      const point_type * p2 = &cell->corner_list[ bounding_planes[plane_nr][2] ];
+
+      if (point_equal(p0, p1) || point_equal(p0,p2) || point_equal(p1,p2)) {
+        contains->empty = true;
+        break;
+      }
+
+      {
+        point_type v1 , v2 , n;
+        point_set( &v1 , p1->x - p0->x , p1->y - p0->y , p1->z - p0->z );
+        point_set( &v2 , p2->x - p0->x , p2->y - p0->y , p2->z - p0->z );
+        point_vector_cross( &n , &v1 , &v2 );
+
+        contains->plane_x[plane_nr] = p0->x;
+        contains->plane_y[plane_nr] = p0->y;
+        contains->plane_z[plane_nr] = p0->z;
+        contains->normal_x[plane_nr] = n.x;
+        contains->normal_y[plane_nr] = n.y;
+        contains->normal_z[plane_nr] = n.z;
+        contains->norm[plane_nr] = sqrt( n.x*n.x + n.y*n.y + n.z*n.z );
+      }
+    }
+  }
+}
+
+
+/*
+  The corner special cases; returns -1 if the point does not coincide
+  with any of the corners, otherwise 0/1.
+*/
+
+static int ecl_cell_contains_corner( const ecl_cell_contains_type * contains , double x , double y , double z) {
+  point_type p;
+  int c;
+  point_set( &p , x , y , z );
+  for (c = 0; c < 8; c++) {
+    if (point_equal( &p , &contains->corner_list[c] ))
+      return contains->corner_contains[c] ? 1 : 0;
+  }
+  return -1;
+}
+
+
+/*
+  Evaluates the bounding plane test for 'num_points' (at most
+  ECL_CELL_CONTAINS_BLOCK_SIZE) points; the loops over the points have
+  no branches and no function calls.
+*/
+
+static void ecl_cell_contains_eval_planes( const ecl_cell_contains_type * contains , int num_points , const double * xlist , const double * ylist , const double * zlist , bool * inside) {
+  int plane_nr , ip;
+  for (ip = 0; ip < num_points; ip++)
+    inside[ip] = true;
+
+  for (plane_nr = 0; plane_nr < 6; plane_nr++) {
+    const double px = contains->plane_x[plane_nr];
+    const double py = contains->plane_y[plane_nr];
+    const double pz = contains->plane_z[plane_nr];
+    const double nx = contains->normal_x[plane_nr];
+    const double ny = contains->normal_y[plane_nr];
+    const double nz = contains->normal_z[plane_nr];
+    const double norm = contains->norm[plane_nr];
+    const double sign = contains->sign;
+
+    for (ip = 0; ip < num_points; ip++) {
+      double d = (nx*(xlist[ip] - px) + ny*(ylist[ip] - py) + nz*(zlist[ip] - pz)) / norm;
+      inside[ip] &= !(sign * d < 0);
+    }
+  }
+}
+
+
+static bool ecl_cell_contains_eval1( const ecl_cell_contains_type * contains , double x , double y , double z) {
+  int corner = ecl_cell_contains_corner( contains , x , y , z );
+  if (corner >= 0)
+    return (corner == 1);
+
+  if (contains->empty)
+    return false;
+  else {
+    bool inside;
+    ecl_cell_contains_eval_planes( contains , 1 , &x , &y , &z , &inside );
+    return inside;
+  }
+}
+
+
+/**
+   Will check whether each of the 'num_points' points given by
+   (xlist[i], ylist[i], zlist[i]) is contained in the cell
+   'global_index'; the results are stored in the 'contains' vector
+   which must have room for 'num_points' elements. The result is
+   exactly equal to calling ecl_grid_cell_contains_xyz1() for each of
+   the points, but considerably faster when many points are tested
+   against the same cell.
+*/
+
+void ecl_grid_cell_contains_xyz_list1( const ecl_grid_type * ecl_grid , int global_index , int num_points , const double * xlist , const double * ylist , const double * zlist , bool * contains) {
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer );
+  ecl_cell_contains_type cell_contains;
+  bool planes_initialized = false;
+  int offset;
+
+  ecl_cell_contains_init_bbox( &cell_contains , cell , global_index );
+  for (offset = 0; offset < num_points; offset += ECL_CELL_CONTAINS_BLOCK_SIZE) {
+    const int block_size = util_int_min( ECL_CELL_CONTAINS_BLOCK_SIZE , num_points - offset );
+    const double * x = &xlist[offset];
+    const double * y = &ylist[offset];
+    const double * z = &zlist[offset];
+    bool * block_contains = &contains[offset];
+    bool inside[ECL_CELL_CONTAINS_BLOCK_SIZE];
+    int  num_inside = 0;
+    int ip;
+
+    for (ip = 0; ip < block_size; ip++) {
+      block_contains[ip] = ecl_cell_contains_bbox( &cell_contains , x[ip] , y[ip] , z[ip] );
+      num_inside += block_contains[ip];
+    }
+
+    if (num_inside > 0) {
+      if (!planes_initialized) {
+        ecl_cell_contains_init_planes( &cell_contains , ecl_grid , cell );
+        planes_initialized = true;
+      }
+
+      if (!cell_contains.empty)
+        ecl_cell_contains_eval_planes( &cell_contains , block_size , x , y , z , inside );
+
+      for (ip = 0; ip < block_size; ip++) {
+        if (block_contains[ip]) {
+          int corner = ecl_cell_contains_corner( &cell_contains , x[ip] , y[ip] , z[ip] );
+          if (corner >= 0)
+            block_contains[ip] = (corner == 1);
+          else
+            block_contains[ip] = !cell_contains.empty && inside[ip];
+        }
+      }
+    }
+  }
+}
+
+
+/**
+   Will check whether the point (x,y,z) is contained in each of the
+   'num_cells' cells in 'global_index_list'; the results are stored in
+   'contains'. The result is exactly equal to calling
+   ecl_grid_cell_contains_xyz1() for each of the cells.
+*/
+
+void ecl_grid_cell_list_contains_xyz( const ecl_grid_type * ecl_grid , int num_cells , const int * global_index_list , double x , double y , double z , bool * contains) {
+  int ic;
+  for (ic = 0; ic < num_cells; ic++) {
+    ecl_cell_type cell_buffer;
+    ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index_list[ic] , &cell_buffer );
+    ecl_cell_contains_type cell_contains;
+
+    ecl_cell_contains_init_bbox( &cell_contains , cell , global_index_list[ic] );
+    contains[ic] = ecl_cell_contains_bbox( &cell_contains , x , y , z );
+    if (contains[ic]) {
+      ecl_cell_contains_init_planes( &cell_contains , ecl_grid , cell );
+      contains[ic] = ecl_cell_contains_eval1( &cell_contains , x , y , z );
+    }
+  }
+}
+
+
 
 /**
    This function returns the global index for the cell (in layer 'k')
@@ -3183,7 +4104,8 @@ int ecl_grid_get_global_index_from_xy( const ecl_grid_type * ecl_grid , int k ,
   for (j=0; j < ecl_grid->ny; j++)
     for (i=0; i < ecl_grid->nx; i++) {
       int global_index = ecl_grid_get_global_index3( ecl_grid , i , j , k );
-      if (ecl_cell_layer_contains_xy( ecl_grid_get_cell( ecl_grid , global_index ) , lower_layer , x , y))
+      ecl_cell_type cell_buffer;
+      if (ecl_cell_layer_contains_xy( ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer ) , lower_layer , x , y))
         return global_index;  
     }
   return -1; /* Did not find x,y */
@@ -3200,143 +4122,327 @@ int ecl_grid_get_global_index_from_xy_bottom( const ecl_grid_type * ecl_grid , d
 }
 
 
-static void ecl_grid_clear_visited( ecl_grid_type * grid ) {
-  if (grid->visited == NULL)
-    grid->visited = util_calloc( grid->size , sizeof * grid->visited );
-  
-  { 
-    int i;
-    for (i=0; i < grid->size; i++)
-      grid->visited[i] = false;
+/*****************************************************************/
+/*
+  The cell lookup from (x,y,z) is based on a bounding volume
+  hierarchy over the bounding boxes of the cells. The hierarchy is a
+  binary tree where each node holds the bounding box of all the cells
+  below it; the cells are split in two halves around the median of
+  the cell centers along the longest axis, until a node holds at most
+  ECL_GRID_BVH_LEAF_SIZE cells. Locating a point then only involves
+  the full geometric test for the cells in the leaves whose bounding
+  box contains the point, i.e. O(log n) instead of a linear scan.
+
+  The index is built on demand the first time a point is looked up,
+  and is read-only after that; all lookups are thread safe. Tainted
+  cells never contain a point and are not included in the index.
+*/
+
+static void ecl_grid_bvh_free( ecl_grid_bvh_type * bvh ) {
+  free( bvh->cell_list );
+  free( bvh->nodes );
+  free( bvh );
+}
+
+
+static int ecl_grid_bvh_alloc_node( ecl_grid_bvh_type * bvh ) {
+  if (bvh->num_nodes == bvh->alloc_size) {
+    bvh->alloc_size = 2 * bvh->alloc_size + 1;
+    bvh->nodes = util_realloc( bvh->nodes , bvh->alloc_size * sizeof * bvh->nodes );
   }
+  bvh->num_nodes++;
+  return bvh->num_nodes - 1;
 }
 
 
-/* 
-   Box coordinates are not inclusive, i.e. [i1,i2) 
+/*
+  Observe that for normal grids the cell center must have been
+  calculated in advance.
 */
-static int ecl_grid_box_contains_xyz( const ecl_grid_type * grid , int i1, int i2 , int j1 , int j2 , int k1 , int k2 , const point_type * p) {
 
-  int i,j,k;
-  int global_index = -1;
-  for (k=k1; k < k2; k++)
-    for (j=j1; j < j2; j++)
-      for (i=i1; i < i2; i++) {
-        global_index = ecl_grid_get_global_index3( grid , i , j , k);
-        if (!grid->visited[ global_index ]) {
-          grid->visited[ global_index ] = true;
-          if (ecl_grid_cell_contains_xyz1( grid , global_index , p->x , p->y , p->z )) {
-            return global_index;
-          }
-        }
+static double ecl_grid_get_center_coord( const ecl_grid_type * grid , int global_index , int axis ) {
+  const ecl_grid_compact_type * compact = grid->compact;
+  if (compact != NULL) {
+    if (axis == 0)
+      return compact->offset[0] + compact->center_x[global_index];
+    else if (axis == 1)
+      return compact->offset[1] + compact->center_y[global_index];
+    else
+      return compact->offset[2] + compact->center_z[global_index];
+  } else {
+    const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index );
+    if (axis == 0)
+      return cell->center.x;
+    else if (axis == 1)
+      return cell->center.y;
+    else
+      return cell->center.z;
+  }
+}
+
+
+/*
+  Reorders the elements [start,end) of the cell_list so that element
+  @k is the element which would be at position k if the list was
+  sorted on the cell center coordinate @axis; all elements before k
+  are smaller or equal and all elements after are larger or equal.
+*/
+
+static void ecl_grid_bvh_select( const ecl_grid_type * grid , int * cell_list , int axis , int start , int end , int k) {
+  int left  = start;
+  int right = end - 1;
+
+  while (left < right) {
+    double pivot = ecl_grid_get_center_coord( grid , cell_list[ (left + right) / 2 ] , axis );
+    int i = left;
+    int j = right;
+
+    while (i <= j) {
+      while (ecl_grid_get_center_coord( grid , cell_list[i] , axis ) < pivot)
+        i++;
+      while (ecl_grid_get_center_coord( grid , cell_list[j] , axis ) > pivot)
+        j--;
+      if (i <= j) {
+        int tmp = cell_list[i];
+        cell_list[i] = cell_list[j];
+        cell_list[j] = tmp;
+        i++;
+        j--;
       }
-  return -1;  /* Returning -1; did not find xyz. */
+    }
+
+    if (k <= j)
+      right = j;
+    else if (k >= i)
+      left = i;
+    else
+      break;
+  }
 }
 
 
-/**
-   This function will find the global index of the cell containing the
-   world coordinates (x,y,z), if no cell can be found the function
-   will return -1.
+static void ecl_grid_bvh_init_leaf( ecl_grid_bvh_node_type * node , const ecl_grid_type * grid , const int * cell_list ) {
+  int c;
+  node->min[0] = node->min[1] = node->min[2] =  INFINITY;
+  node->max[0] = node->max[1] = node->max[2] = -INFINITY;
+
+  for (c = node->first; c < node->first + node->count; c++) {
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , cell_list[c] , &cell_buffer );
+    node->min[0] = util_double_min( node->min[0] , ecl_cell_min_x( cell ));
+    node->max[0] = util_double_max( node->max[0] , ecl_cell_max_x( cell ));
+    node->min[1] = util_double_min( node->min[1] , ecl_cell_min_y( cell ));
+    node->max[1] = util_double_max( node->max[1] , ecl_cell_max_y( cell ));
+    node->min[2] = util_double_min( node->min[2] , ecl_cell_min_z( cell ));
+    node->max[2] = util_double_max( node->max[2] , ecl_cell_max_z( cell ));
+  }
+}
 
-   The function is basically based on scanning through the cells in
-   natural (i fastest) order and querying whether the cell[i,j,k]
-   contains the (x,y,z) point; not very elegant :-(
 
-   The last argument - 'start_index' - can be used to speed things up
-   a bit if you have reasonable guess of where the the (x,y,z) is
-   located. The start_index value is used as this:
+static int ecl_grid_bvh_build_node( ecl_grid_bvh_type * bvh , const ecl_grid_type * grid , int start , int end , int depth) {
+  int node_index = ecl_grid_bvh_alloc_node( bvh );
 
+  if (((end - start) <= ECL_GRID_BVH_LEAF_SIZE) || (depth == ECL_GRID_BVH_MAX_DEPTH - 1)) {
+    ecl_grid_bvh_node_type * node = &bvh->nodes[node_index];
+    node->first = start;
+    node->count = end - start;
+    node->left  = -1;
+    node->right = -1;
+    ecl_grid_bvh_init_leaf( node , grid , bvh->cell_list );
+  } else {
+    int axis = 0;
+    {
+      double center_min[3] = { INFINITY ,  INFINITY ,  INFINITY };
+      double center_max[3] = {-INFINITY , -INFINITY , -INFINITY };
+      int c , d;
+
+      for (c = start; c < end; c++) {
+        for (d = 0; d < 3; d++) {
+          double coord = ecl_grid_get_center_coord( grid , bvh->cell_list[c] , d );
+          center_min[d] = util_double_min( center_min[d] , coord );
+          center_max[d] = util_double_max( center_max[d] , coord );
+        }
+      }
 
-     start_index == 0: I do not have a clue, start from the beginning
-        and scan through the grid linearly.
+      for (d = 1; d < 3; d++)
+        if ((center_max[d] - center_min[d]) > (center_max[axis] - center_min[axis]))
+          axis = d;
+    }
 
+    {
+      int mid = (start + end) / 2;
+      int left , right;
+      ecl_grid_bvh_select( grid , bvh->cell_list , axis , start , end , mid );
 
-     start_index != 0: 
-        1. Check the cell 'start_index'.
-        2. Check the neighbours (i +/- 1, j +/- 1, k +/- 1 ).
-        3. Give up and do a linear search starting from start_index.
+      left  = ecl_grid_bvh_build_node( bvh , grid , start , mid , depth + 1);
+      right = ecl_grid_bvh_build_node( bvh , grid , mid , end , depth + 1);
+      {
+        ecl_grid_bvh_node_type * node = &bvh->nodes[node_index];
+        const ecl_grid_bvh_node_type * left_node  = &bvh->nodes[left];
+        const ecl_grid_bvh_node_type * right_node = &bvh->nodes[right];
+        int d;
+
+        node->left  = left;
+        node->right = right;
+        node->first = -1;
+        node->count = 0;
+        for (d = 0; d < 3; d++) {
+          node->min[d] = util_double_min( left_node->min[d] , right_node->min[d] );
+          node->max[d] = util_double_max( left_node->max[d] , right_node->max[d] );
+        }
+      }
+    }
+  }
+  return node_index;
+}
 
-*/
 
+static ecl_grid_bvh_type * ecl_grid_bvh_alloc( const ecl_grid_type * grid ) {
+  ecl_grid_bvh_type * bvh = util_malloc( sizeof * bvh );
+  int num_cells = 0;
+
+  ecl_grid_assert_geometry( grid );
+  bvh->cell_list  = util_calloc( util_int_max( grid->size , 1 ) , sizeof * bvh->cell_list );
+  bvh->alloc_size = util_int_max( grid->size / (ECL_GRID_BVH_LEAF_SIZE / 2) , 1 );
+  bvh->nodes      = util_calloc( bvh->alloc_size , sizeof * bvh->nodes );
+  bvh->num_nodes  = 0;
+  {
+    int global_index;
+    for (global_index = 0; global_index < grid->size; global_index++) {
+      ecl_cell_type cell_buffer;
+      ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , global_index , &cell_buffer );
+      /*
+        The cell centers are used when building the index; by
+        calculating all of them here the cells are not modified by
+        the subsequent (possibly concurrent) lookups. For compact
+        grids the centers are always present.
+      */
+      if (grid->compact == NULL)
+        ecl_cell_assert_center( cell );
+      if (!GET_CELL_FLAG( cell , CELL_FLAG_TAINTED )) {
+        bvh->cell_list[num_cells] = global_index;
+        num_cells++;
+      }
+    }
+  }
 
+  if (num_cells > 0)
+    ecl_grid_bvh_build_node( bvh , grid , 0 , num_cells , 0 );
 
-int ecl_grid_get_global_index_from_xyz(ecl_grid_type * grid , double x , double y , double z , int start_index) {
-  int global_index;
-  point_type p;
-  point_set( &p , x , y , z);
-  ecl_grid_clear_visited( grid );
-  
-  if (start_index >= 0) {
-    /* Try start index */
-    if (ecl_grid_cell_contains_xyz1( grid , start_index , x,y,z))
-      return start_index;
-    else {
-      /* Try neighbours */
-      int i,j,k;
-      int i1,i2,j1,j2,k1,k2;
-      int nx,ny,nz;
-      ecl_grid_get_dims( grid , &nx , &ny , &nz , NULL);
-      ecl_grid_get_ijk1( grid , start_index , &i , &j , &k);
-
-      i1 = util_int_max( 0 , i - 1 );
-      j1 = util_int_max( 0 , j - 1 );
-      k1 = util_int_max( 0 , k - 1 );
-      
-      i2 = util_int_min( nx , i + 1 );
-      j2 = util_int_min( ny , j + 1 );
-      k2 = util_int_min( nz , k + 1 );
-      
-      global_index = ecl_grid_box_contains_xyz( grid , i1 , i2 , j1 , j2 , k1 , k2 , &p);
-      if (global_index >= 0)
-        return global_index;
+  return bvh;
+}
 
 
-      /* Try a bigger box */
-      i1 = util_int_max( 0 , i - 2 );
-      j1 = util_int_max( 0 , j - 2 );
-      k1 = util_int_max( 0 , k - 2 );
-      
-      i2 = util_int_min( nx , i + 2 );
-      j2 = util_int_min( ny , j + 2 );
-      k2 = util_int_min( nz , k + 2 );
-      
-      global_index = ecl_grid_box_contains_xyz( grid , i1 , i2 , j1 , j2 , k1 , k2 , &p);
-      if (global_index >= 0)
-        return global_index;
+static ecl_grid_bvh_type * ecl_grid_assert_cell_bvh( ecl_grid_type * grid ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &grid->cell_bvh_lock );
+#endif
+  if (grid->cell_bvh == NULL)
+    grid->cell_bvh = ecl_grid_bvh_alloc( grid );
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &grid->cell_bvh_lock );
+#endif
+  return grid->cell_bvh;
+}
 
 
-    }
-  } 
-  
-  /* 
-     OK - the attempted shortcuts did not pay off. We start on the
-     full linear search starting from start_index.
-  */
-  
-  {
-    int index    = 0;
-    global_index = -1;
+static bool ecl_grid_bvh_node_contains( const ecl_grid_bvh_node_type * node , const double * p ) {
+  int d;
+  for (d = 0; d < 3; d++) {
+    if (p[d] < node->min[d])
+      return false;
+    if (p[d] > node->max[d])
+      return false;
+  }
+  return true;
+}
 
-    while (true) {
-      int current_index = ((index + start_index) % grid->size);
-      bool cell_contains;
-      cell_contains = ecl_grid_cell_contains_xyz1( grid , current_index , x , y , z);
-      
-      if (cell_contains) {
-        global_index = current_index;
-        break;
+
+/*
+  Will return the lowest global index of the cells containing the
+  point, or -1 if no cell contains the point.
+*/
+
+static int ecl_grid_bvh_find( const ecl_grid_type * grid , const ecl_grid_bvh_type * bvh , double x , double y , double z) {
+  int global_index = -1;
+  if (bvh->num_nodes > 0) {
+    const double p[3] = { x , y , z };
+    int stack[ECL_GRID_BVH_MAX_DEPTH + 1];
+    int stack_size = 1;
+    stack[0] = 0;
+
+    while (stack_size > 0) {
+      const ecl_grid_bvh_node_type * node = &bvh->nodes[ stack[ stack_size - 1 ] ];
+      stack_size--;
+
+      if (ecl_grid_bvh_node_contains( node , p )) {
+        if (node->count > 0) {
+          int c;
+          for (c = node->first; c < node->first + node->count; c++) {
+            int cell_index = bvh->cell_list[c];
+            if ((global_index < 0) || (cell_index < global_index)) {
+              bool contains;
+              ecl_grid_cell_list_contains_xyz( grid , 1 , &cell_index , x , y , z , &contains );
+              if (contains)
+                global_index = cell_index;
+            }
+          }
+        } else {
+          stack[stack_size]     = node->right;
+          stack[stack_size + 1] = node->left;
+          stack_size += 2;
+        }
       }
-      index++;
-      if (index == grid->size)
-        break;
-    } 
+    }
   }
   return global_index;
 }
 
 
+/**
+   This function will find the global index of the cell containing the
+   world coordinates (x,y,z), if no cell can be found the function
+   will return -1. If several cells contain the point the cell with
+   the lowest global index is returned.
+
+   The lookup is based on a spatial index over the cell bounding
+   boxes which is built the first time the function is called; the
+   function is thread safe.
+
+   The last argument - 'start_index' - can be used to speed things up
+   a bit if you have reasonable guess of where the the (x,y,z) is
+   located; if the cell 'start_index' contains the point it is
+   returned directly. Use start_index < 0 if you do not have a clue.
+*/
+
+int ecl_grid_get_global_index_from_xyz(ecl_grid_type * grid , double x , double y , double z , int start_index) {
+  const ecl_grid_bvh_type * bvh = ecl_grid_assert_cell_bvh( grid );
+
+  if ((start_index >= 0) && (start_index < grid->size)) {
+    if (ecl_grid_cell_contains_xyz1( grid , start_index , x,y,z))
+      return start_index;
+  }
+
+  return ecl_grid_bvh_find( grid , bvh , x , y , z );
+}
+
+
+/**
+   Batch version of ecl_grid_get_global_index_from_xyz(); will locate
+   the @num_points points (xlist[i] , ylist[i] , zlist[i]) and store
+   the global index of the cell containing point i, or -1, in
+   index_list[i]. The points are located in parallel when the library
+   is built with OpenMP.
+*/
 
+void ecl_grid_get_global_index_list_from_xyz( ecl_grid_type * grid , int num_points , const double * xlist , const double * ylist , const double * zlist , int * index_list) {
+  const ecl_grid_bvh_type * bvh = ecl_grid_assert_cell_bvh( grid );
+  int i;
+
+#pragma omp parallel for schedule(dynamic , 256)
+  for (i = 0; i < num_points; i++)
+    index_list[i] = ecl_grid_bvh_find( grid , bvh , xlist[i] , ylist[i] , zlist[i] );
+}
 
 
 
@@ -3424,7 +4530,21 @@ void ecl_grid_free(ecl_grid_type * grid) {
   vector_free( grid->coarse_cells );
   hash_free( grid->children );
   util_safe_free( grid->parent_name );
-  util_safe_free( grid->visited );
+  if (grid->cell_bvh != NULL)
+    ecl_grid_bvh_free( grid->cell_bvh );
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &grid->cell_bvh_lock );
+#endif
+  if (grid->lazy_geometry != NULL)
+    ecl_grid_lazy_free( grid->lazy_geometry );
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &grid->geometry_lock );
+#endif
+  if (grid->nnc_table != NULL)
+    nnc_table_free( grid->nnc_table );
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &grid->nnc_lock );
+#endif
   util_safe_free( grid->name );
   free( grid );
 }
@@ -3439,8 +4559,10 @@ void ecl_grid_free__( void * arg ) {
 
 
 void ecl_grid_get_distance(const ecl_grid_type * grid , int global_index1, int global_index2 , double *dx , double *dy , double *dz) {
-  ecl_cell_type * cell1 = ecl_grid_get_cell( grid , global_index1);
-  ecl_cell_type * cell2 = ecl_grid_get_cell( grid , global_index2);
+  ecl_cell_type cell1_buffer;
+  ecl_cell_type * cell1 = ecl_grid_get_cell_view( grid , global_index1 , &cell1_buffer );
+  ecl_cell_type cell2_buffer;
+  ecl_cell_type * cell2 = ecl_grid_get_cell_view( grid , global_index2 , &cell2_buffer );
 
   ecl_cell_assert_center( cell1 );
   ecl_cell_assert_center( cell2 );
@@ -3530,7 +4652,8 @@ int ecl_grid_get_nactive_fracture( const ecl_grid_type * grid ) {
 
 
 int ecl_grid_get_parent_cell1( const ecl_grid_type * grid , int global_index ) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid, global_index );
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , global_index , &cell_buffer );
   return cell->host_cell;
 }
 
@@ -3573,6 +4696,22 @@ int ecl_grid_get_global_index1F(const ecl_grid_type * ecl_grid , int active_frac
 }
 
 
+/**
+   Direct access to the global -> active (nx*ny*nz elements, -1 for
+   inactive cells) and active -> global (nactive elements) maps; for
+   code which needs to translate many indices in a tight loop.
+*/
+
+const int * ecl_grid_get_index_map_ptr( const ecl_grid_type * ecl_grid ) {
+  return ecl_grid->index_map;
+}
+
+
+const int * ecl_grid_get_inv_index_map_ptr( const ecl_grid_type * ecl_grid ) {
+  return ecl_grid->inv_index_map;
+}
+
+
 
 /**
    Converts: (i,j,k) -> active_index
@@ -3654,12 +4793,19 @@ void ecl_grid_get_ijk1A(const ecl_grid_type *ecl_grid , int active_index , int *
 */
 
 void ecl_grid_get_xyz1(const ecl_grid_type * grid , int global_index , double *xpos , double *ypos , double *zpos) {
-  ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
-  ecl_cell_assert_center( cell );
-  {
-    *xpos = cell->center.x;
-    *ypos = cell->center.y;
-    *zpos = cell->center.z;
+  ecl_grid_assert_geometry( grid );
+  if (grid->compact != NULL) {
+    *xpos = ecl_grid_get_center_coord( grid , global_index , 0 );
+    *ypos = ecl_grid_get_center_coord( grid , global_index , 1 );
+    *zpos = ecl_grid_get_center_coord( grid , global_index , 2 );
+  } else {
+    ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+    ecl_cell_assert_center( cell );
+    {
+      *xpos = cell->center.x;
+      *ypos = cell->center.y;
+      *zpos = cell->center.z;
+    }
   }
 }
 
@@ -3683,7 +4829,8 @@ void ecl_grid_get_xyz3(const ecl_grid_type * grid , int i, int j , int k, double
 
 void ecl_grid_get_corner_xyz1(const ecl_grid_type * grid , int global_index , int corner_nr , double * xpos , double * ypos , double * zpos ) {
   if ((corner_nr >= 0) &&  (corner_nr <= 7)) {
-    const ecl_cell_type * cell  = ecl_grid_get_cell( grid , global_index );
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
     const point_type      point = cell->corner_list[ corner_nr ];
     *xpos = point.x;
     *ypos = point.y;
@@ -3707,9 +4854,14 @@ void ecl_grid_get_xyz1A(const ecl_grid_type * grid , int active_index , double *
 
 
 double ecl_grid_get_cdepth1(const ecl_grid_type * grid , int global_index) {
-  ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
-  ecl_cell_assert_center( cell );
-  return cell->center.z;
+  ecl_grid_assert_geometry( grid );
+  if (grid->compact != NULL)
+    return ecl_grid_get_center_coord( grid , global_index , 2 );
+  else {
+    ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+    ecl_cell_assert_center( cell );
+    return cell->center.z;
+  }
 }
 
 
@@ -3749,7 +4901,8 @@ int ecl_grid_locate_depth( const ecl_grid_type * grid , double depth , int i , i
 */
 
 double ecl_grid_get_top1(const ecl_grid_type * grid , int global_index) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index );
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
   double depth = 0;
   int ij;
 
@@ -3791,7 +4944,8 @@ double ecl_grid_get_top1A(const ecl_grid_type * grid , int active_index) {
 */
 
 double ecl_grid_get_bottom1(const ecl_grid_type * grid , int global_index) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
   double depth = 0;
   int ij;
 
@@ -3817,7 +4971,8 @@ double ecl_grid_get_bottom1A(const ecl_grid_type * grid , int active_index) {
 
   
 double ecl_grid_get_cell_thickness1( const ecl_grid_type * grid , int global_index ) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
   double thickness = 0;
   int ij;
   
@@ -3837,7 +4992,11 @@ double ecl_grid_get_cell_thickness3( const ecl_grid_type * grid , int i , int j
 
 
 const nnc_info_type * ecl_grid_get_cell_nnc_info1( const ecl_grid_type * grid , int global_index) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell;
+
+  ecl_grid_assert_nnc_info( grid );
+  cell = ecl_grid_get_cell_attr_view( grid , global_index , &cell_buffer );
   return cell->nnc_info;
 } 
 
@@ -3874,7 +5033,12 @@ bool ecl_grid_cell_active3(const ecl_grid_type * ecl_grid, int i , int j , int k
 /*****************************************************************/
 
 bool ecl_grid_cell_invalid1(const ecl_grid_type * ecl_grid , int global_index) {
-  ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index);
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell;
+
+  /* The tainting is based on the geometry. */
+  ecl_grid_assert_geometry( ecl_grid );
+  cell = ecl_grid_get_cell_attr_view( ecl_grid , global_index , &cell_buffer);
   return GET_CELL_FLAG(cell , CELL_FLAG_TAINTED);
 }
 
@@ -4003,7 +5167,8 @@ ecl_grid_type * ecl_grid_get_lgr_from_lgr_nr(const ecl_grid_type * main_grid, in
 
 
 const ecl_grid_type * ecl_grid_get_cell_lgr1(const ecl_grid_type * grid , int global_index ) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index);
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , global_index , &cell_buffer );
   return cell->lgr;
 }
 
@@ -4120,7 +5285,8 @@ bool ecl_grid_cell_regular3( const ecl_grid_type * ecl_grid, int i,int j,int k)
 
 
 double ecl_grid_get_cell_volume1( const ecl_grid_type * ecl_grid, int global_index ) {
-  ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer );
   int i,j,k;
   ecl_grid_get_ijk1( ecl_grid , global_index, &i , &j , &k);
   return ecl_cell_get_volume( cell );
@@ -4128,7 +5294,8 @@ double ecl_grid_get_cell_volume1( const ecl_grid_type * ecl_grid, int global_ind
 
 
 double ecl_grid_get_cell_volume1_tskille( const ecl_grid_type * ecl_grid, int global_index ) {
-  ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer );
   return ecl_cell_get_volume_tskille( cell );
 }
 
@@ -4510,7 +5677,8 @@ static void ecl_grid_dump__(const ecl_grid_type * grid , FILE * stream) {
   {
     int i;
     for (i=0; i < grid->size; i++) {
-      const ecl_cell_type * cell = ecl_grid_get_cell( grid , i );
+      ecl_cell_type cell_buffer;
+      const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , i , &cell_buffer );
       ecl_cell_dump( cell , stream );
     }
   }
@@ -4529,7 +5697,8 @@ static void ecl_grid_dump_ascii__(ecl_grid_type * grid , bool active_only , FILE
   {
     int l;
     for (l=0; l < grid->size; l++) {
-      ecl_cell_type * cell = ecl_grid_get_cell( grid , l );
+      ecl_cell_type cell_buffer;
+      ecl_cell_type * cell = ecl_grid_get_cell_view( grid , l , &cell_buffer );
       if (cell->active_index[MATRIX_INDEX] >= 0 || !active_only) {
         int i,j,k;
         ecl_grid_get_ijk1( grid , l , &i , &j , &k);
@@ -4569,7 +5738,8 @@ void ecl_grid_dump_ascii(ecl_grid_type * grid , bool active_only , FILE * stream
 
 
 void ecl_grid_dump_ascii_cell1(ecl_grid_type * grid , int global_index , FILE * stream , const double * offset) {
-  ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
   int i,j,k;
   ecl_grid_get_ijk1( grid , global_index , &i , &j , &k);
   ecl_cell_dump_ascii(cell , i,j,k, stream , offset);
@@ -4578,7 +5748,8 @@ void ecl_grid_dump_ascii_cell1(ecl_grid_type * grid , int global_index , FILE *
 
 void ecl_grid_dump_ascii_cell3(ecl_grid_type * grid , int i , int j , int k , FILE * stream , const double * offset) {
   int global_index  = ecl_grid_get_global_index3(grid , i,j,k);
-  ecl_cell_type * cell = ecl_grid_get_cell( grid , global_index );
+  ecl_cell_type cell_buffer;
+  ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
   ecl_cell_dump_ascii(cell , i,j,k, stream , offset);
 }
 
@@ -4708,7 +5879,8 @@ static void ecl_grid_fwrite_GRID__( const ecl_grid_type * grid , int coords_size
       for (j=0; j < grid->ny; j++) {
         for (i=0; i < grid->nx; i++) {
           int global_index = ecl_grid_get_global_index__(grid , i , j , k );
-          const ecl_cell_type * cell = ecl_grid_get_cell( grid ,  global_index );
+          ecl_cell_type cell_buffer;
+          const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
           
           ecl_cell_fwrite_GRID( grid , cell , false , coords_size , i,j,k,global_index,coords_kw , corners_kw , fortio );
         }
@@ -4720,7 +5892,8 @@ static void ecl_grid_fwrite_GRID__( const ecl_grid_type * grid , int coords_size
         for (j=0; j < grid->ny; j++) {
           for (i=0; i < grid->nx; i++) {
             int global_index = ecl_grid_get_global_index__(grid , i , j , k - grid->nz );
-            const ecl_cell_type * cell = ecl_grid_get_cell( grid ,  global_index );
+            ecl_cell_type cell_buffer;
+            const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , global_index , &cell_buffer );
             
             ecl_cell_fwrite_GRID( grid , cell , true , coords_size , i,j,k,global_index ,  coords_kw , corners_kw , fortio );
           }
@@ -4836,10 +6009,11 @@ static int ecl_grid_get_valid_index( const ecl_grid_type * grid , int i , int j
   int delta = (k1 < k2) ? 1 : -1 ;
 
   while (true) {
+    ecl_cell_type cell_buffer;
     ecl_cell_type * cell;
     global_index = ecl_grid_get_global_index3( grid , i , j , k );
     
-    cell = ecl_grid_get_cell( grid ,  global_index );
+    cell = ecl_grid_get_cell_attr_view( grid ,  global_index , &cell_buffer );
     if (GET_CELL_FLAG(cell , CELL_FLAG_VALID))
       return global_index;
     else {
@@ -4874,8 +6048,10 @@ static bool ecl_grid_init_coord_section__( const ecl_grid_type * grid , int i, i
     point_type top_point;
     point_type bottom_point;
   
-    const ecl_cell_type * bottom_cell = ecl_grid_get_cell( grid , bottom_index );
-    const ecl_cell_type * top_cell    = ecl_grid_get_cell( grid , top_index);
+    ecl_cell_type bottom_cell_buffer;
+    const ecl_cell_type * bottom_cell = ecl_grid_get_cell_view( grid , bottom_index , &bottom_cell_buffer );
+    ecl_cell_type top_cell_buffer;
+    const ecl_cell_type * top_cell = ecl_grid_get_cell_view( grid , top_index , &top_cell_buffer );
     
     /*
       2---3
@@ -4975,7 +6151,8 @@ static void ecl_grid_init_zcorn_data( const ecl_grid_type * grid , float * zcorn
     for (i=0; i < nx; i++) {
       for (k=0; k < nz; k++) {
         const int cell_index   = ecl_grid_get_global_index3( grid , i,j,k);
-        const ecl_cell_type * cell = ecl_grid_get_cell( grid , cell_index );
+        ecl_cell_type cell_buffer;
+        const ecl_cell_type * cell = ecl_grid_get_cell_view( grid , cell_index , &cell_buffer );
         int l;
 
         for (l=0; l < 2; l++) {
@@ -5014,7 +6191,8 @@ ecl_kw_type * ecl_grid_alloc_zcorn_kw( const ecl_grid_type * grid ) {
 static void ecl_grid_init_actnum_data( const ecl_grid_type * grid , int * actnum ) {
   int i;
   for (i=0; i < grid->size; i++) {
-    const ecl_cell_type * cell = ecl_grid_get_cell( grid , i );
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , i , &cell_buffer );
     if (cell->coarse_group == COARSE_GROUP_NONE)
       actnum[i] = cell->active;
     else {
@@ -5069,7 +6247,8 @@ ecl_kw_type * ecl_grid_alloc_actnum_kw( const ecl_grid_type * grid ) {
 static void ecl_grid_init_hostnum_data( const ecl_grid_type * grid , int * hostnum ) {
   int i;
   for (i=0; i < grid->size; i++) {
-    const ecl_cell_type * cell = ecl_grid_get_cell(grid , i );
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , i , &cell_buffer );
     hostnum[i] = cell->host_cell;
   }
 }
@@ -5092,7 +6271,8 @@ ecl_kw_type * ecl_grid_alloc_hostnum_kw( const ecl_grid_type * grid ) {
 static void ecl_grid_init_corsnum_data( const ecl_grid_type * grid , int * corsnum ) {
   int i;
   for (i=0; i < grid->size; i++) {
-    const ecl_cell_type * cell = ecl_grid_get_cell(grid , i );
+    ecl_cell_type cell_buffer;
+    const ecl_cell_type * cell = ecl_grid_get_cell_attr_view( grid , i , &cell_buffer );
     corsnum[i] = cell->coarse_group + 1;
   }
 }
@@ -5285,7 +6465,8 @@ void ecl_grid_fprintf_grdecl(ecl_grid_type * grid , FILE * stream ) {
 */
 
 void ecl_grid_cell_ri_export( const ecl_grid_type * ecl_grid , int global_index , double * ri_points) {
-  const ecl_cell_type * cell = ecl_grid_get_cell( ecl_grid , global_index );
+  ecl_cell_type cell_buffer;
+  const ecl_cell_type * cell = ecl_grid_get_cell_view( ecl_grid , global_index , &cell_buffer );
   int offset = global_index * 8 * 3;
   ecl_cell_ri_export( cell , &ri_points[ offset ] );
 }
@@ -5308,14 +6489,21 @@ bool ecl_grid_dual_grid( const ecl_grid_type * ecl_grid ) {
 }
 
 static int ecl_grid_get_num_nnc__( const ecl_grid_type * grid ) {
-  int g;
-  int num_nnc = 0;
-  for (g = 0; g < grid->size; g++) {
-    const nnc_info_type * nnc_info = ecl_grid_get_cell_nnc_info1( grid , g );
-    if (nnc_info) 
-      num_nnc += nnc_info_get_total_size( nnc_info );
-  }
-  return num_nnc;
+  if (grid->nnc_table != NULL)
+    return nnc_table_get_size( grid->nnc_table );
+  else
+    return 0;
+}
+
+
+/*
+  Returns the table of all the nnc originating in this grid, or NULL
+  if there are no such nnc. The table is built when the grid is
+  loaded, see nnc_table.c for the layout.
+*/
+
+const nnc_table_type * ecl_grid_get_nnc_table( const ecl_grid_type * grid ) {
+  return grid->nnc_table;
 }
 
 
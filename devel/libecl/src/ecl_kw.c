@@ -255,9 +255,37 @@ static void ecl_kw_assert_index(const ecl_kw_type *ecl_kw , int index, const cha
 
 
 
+/*
+  The bulk operations on the data vector (endian flipping and type
+  conversion) are split in chunks of ECL_KW_CHUNK_SIZE elements; when
+  compiled with OpenMP keywords with more than ECL_KW_PARALLEL_CHUNKS
+  chunks are processed in parallel. For smaller keywords the cost of
+  starting the threads is larger than the gain.
+*/
+
+#define ECL_KW_CHUNK_SIZE       65536
+#define ECL_KW_PARALLEL_CHUNKS  4
+
+static int ecl_kw_num_chunks( int size ) {
+  return (size + ECL_KW_CHUNK_SIZE - 1) / ECL_KW_CHUNK_SIZE;
+}
+
+
 static void ecl_kw_endian_convert_data(ecl_kw_type *ecl_kw) {
-  if (ecl_kw->ecl_type != ECL_CHAR_TYPE && ecl_kw->ecl_type != ECL_MESS_TYPE) 
-    util_endian_flip_vector(ecl_kw->data , ecl_kw->sizeof_ctype , ecl_kw->size);
+  if (ecl_kw->ecl_type != ECL_CHAR_TYPE && ecl_kw->ecl_type != ECL_MESS_TYPE) {
+    char * data      = ecl_kw->data;
+    int sizeof_ctype = ecl_kw->sizeof_ctype;
+    int size         = ecl_kw->size;
+    int num_chunks   = ecl_kw_num_chunks( size );
+    int chunk;
+    
+#pragma omp parallel for if (num_chunks > ECL_KW_PARALLEL_CHUNKS)
+    for (chunk = 0; chunk < num_chunks; chunk++) {
+      int offset   = chunk * ECL_KW_CHUNK_SIZE;
+      int elements = util_int_min( ECL_KW_CHUNK_SIZE , size - offset );
+      util_endian_flip_vector( &data[ offset * sizeof_ctype ] , sizeof_ctype , elements );
+    }
+  }
 }
 
 
@@ -1684,20 +1712,41 @@ void ecl_kw_fwrite_param(const char * filename , bool fmt_file , const char * he
 
 
 
+static void ecl_kw_int_to_double( double * double_data , const int * int_data , int size) {
+  int i;
+  for (i=0; i < size; i++)
+    double_data[i] = int_data[i];
+}
+
+
+static void ecl_kw_int_to_float( float * float_data , const int * int_data , int size) {
+  int i;
+  for (i=0; i < size; i++)
+    float_data[i] = (float) int_data[i];
+}
+
+
 void ecl_kw_get_data_as_double(const ecl_kw_type * ecl_kw , double * double_data) {
 
   if (ecl_kw->ecl_type == ECL_DOUBLE_TYPE)
     // Direct memcpy - no conversion
     ecl_kw_get_memcpy_data(ecl_kw , double_data);
   else {
-    if (ecl_kw->ecl_type == ECL_FLOAT_TYPE) {
-      const float * float_data = (const float *) ecl_kw->data;
-      util_float_to_double(double_data , float_data  , ecl_kw->size);
-    } else if (ecl_kw->ecl_type == ECL_INT_TYPE) {
-      const int * int_data = (const int *) ecl_kw->data;
-      int i;
-      for (i=0; i < ecl_kw->size; i++)
-        double_data[i] = int_data[i];
+    if (ecl_kw->ecl_type == ECL_FLOAT_TYPE || ecl_kw->ecl_type == ECL_INT_TYPE) {
+      int size       = ecl_kw->size;
+      int num_chunks = ecl_kw_num_chunks( size );
+      int chunk;
+
+#pragma omp parallel for if (num_chunks > ECL_KW_PARALLEL_CHUNKS)
+      for (chunk = 0; chunk < num_chunks; chunk++) {
+        int offset   = chunk * ECL_KW_CHUNK_SIZE;
+        int elements = util_int_min( ECL_KW_CHUNK_SIZE , size - offset );
+
+        if (ecl_kw->ecl_type == ECL_FLOAT_TYPE) 
+          util_float_to_double(&double_data[offset] , &((const float *) ecl_kw->data)[offset] , elements);
+        else
+          ecl_kw_int_to_double(&double_data[offset] , &((const int *) ecl_kw->data)[offset] , elements);
+      }
     } else {
       fprintf(stderr,"%s: type can not be converted to double - aborting \n",__func__);
       ecl_kw_summarize(ecl_kw);
@@ -1713,14 +1762,21 @@ void ecl_kw_get_data_as_float(const ecl_kw_type * ecl_kw , float * float_data) {
     // Direct memcpy - no conversion
     ecl_kw_get_memcpy_data(ecl_kw , float_data);
   else {
-    if (ecl_kw->ecl_type == ECL_DOUBLE_TYPE) {
-      const double * double_data = (const double *) ecl_kw->data;
-      util_double_to_float(float_data , double_data  , ecl_kw->size);
-    } else if (ecl_kw->ecl_type == ECL_INT_TYPE) {
-      const int * int_data = (const int *) ecl_kw->data;
-      int i;
-      for (i=0; i < ecl_kw->size; i++)
-        float_data[i] = (float) int_data[i];
+    if (ecl_kw->ecl_type == ECL_DOUBLE_TYPE || ecl_kw->ecl_type == ECL_INT_TYPE) {
+      int size       = ecl_kw->size;
+      int num_chunks = ecl_kw_num_chunks( size );
+      int chunk;
+
+#pragma omp parallel for if (num_chunks > ECL_KW_PARALLEL_CHUNKS)
+      for (chunk = 0; chunk < num_chunks; chunk++) {
+        int offset   = chunk * ECL_KW_CHUNK_SIZE;
+        int elements = util_int_min( ECL_KW_CHUNK_SIZE , size - offset );
+
+        if (ecl_kw->ecl_type == ECL_DOUBLE_TYPE) 
+          util_double_to_float(&float_data[offset] , &((const double *) ecl_kw->data)[offset] , elements);
+        else
+          ecl_kw_int_to_float(&float_data[offset] , &((const int *) ecl_kw->data)[offset] , elements);
+      }
     } else {
       fprintf(stderr,"%s: type can not be converted to float - aborting \n",__func__);
       ecl_kw_summarize(ecl_kw);
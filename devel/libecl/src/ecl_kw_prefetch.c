@@ -0,0 +1,413 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_kw_prefetch.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/long_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/ecl_kw_prefetch.h>
+
+/*
+  The ecl_kw_prefetch structure implements read-ahead of keywords
+  from a file. The prefetch instance is created with a sorted list of
+  keyword offsets, and a background thread with its own fortio
+  instance will read the keywords in file order into a buffer. The
+  consumer asks for keywords with ecl_kw_prefetch_get_kw(); if the
+  keyword has already been read it is handed over to the caller (a
+  hit), otherwise NULL is returned (a miss) and the caller must read
+  the keyword itself.
+
+  The buffer is bounded by @max_buffer_size bytes of keyword data;
+  when the buffer is full the background thread waits until the
+  consumer has taken keywords out of the buffer. If the consumer
+  jumps ahead of the background thread, the thread will continue
+  reading after the keyword asked for; keywords which have been
+  passed by the consumer are discarded when the buffer is full.
+
+  When the prefetch instance is created with @close_stream == true
+  the background thread will only keep its file stream open while it
+  is actively reading; when the buffer is full the stream is closed,
+  and it is reopened when the consumer has made room in the buffer.
+  This is used by ecl_file to honor the ECL_FILE_CLOSE_STREAM flag.
+
+  Without pthread support no background thread is started, and all
+  lookups will be misses.
+*/
+
+#define ECL_KW_PREFETCH_TYPE_ID 661097
+
+struct ecl_kw_prefetch_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char              * filename;
+  bool                fmt_file;
+  bool                close_stream;      /* Close the stream of the background thread when it is waiting. */
+  long_vector_type  * offset_list;       /* The offsets of the keywords which should be prefetched - sorted. */
+  ecl_kw_type      ** kw_list;           /* kw_list[i] is the prefetched keyword at offset_list[i], or NULL. */
+  int                 next_index;        /* The index of the next keyword the background thread will read. */
+  int                 active_index;      /* The index currently being read by the background thread; -1 if none. */
+  int                 consumer_index;    /* The highest index the consumer has asked for. */
+  int                 drop_index;        /* All keywords before this index have been discarded. */
+  size_t              buffer_size;       /* The number of bytes of keyword data currently in the buffer. */
+  size_t              max_buffer_size;
+
+  int                 hits;
+  int                 misses;
+  size_t              prefetch_bytes;
+
+  bool                stop;
+  bool                running;
+  bool                stream_open;       /* Is the stream of the background thread currently open? */
+  bool                thread_created;
+#ifdef WITH_PTHREAD
+  pthread_t           thread;
+  pthread_mutex_t     mutex;
+  pthread_cond_t      cond;
+#endif
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( ecl_kw_prefetch , ECL_KW_PREFETCH_TYPE_ID )
+
+
+#ifdef WITH_PTHREAD
+
+static size_t ecl_kw_prefetch_kw_bytes( const ecl_kw_type * ecl_kw ) {
+  return ecl_kw_get_size( ecl_kw ) * ecl_util_get_sizeof_ctype( ecl_kw_get_type( ecl_kw ));
+}
+
+
+/*
+  Must be called with the mutex held.
+*/
+
+static void ecl_kw_prefetch_drop( ecl_kw_prefetch_type * prefetch , int index) {
+  ecl_kw_type * ecl_kw = prefetch->kw_list[index];
+  if (ecl_kw != NULL) {
+    prefetch->buffer_size -= ecl_kw_prefetch_kw_bytes( ecl_kw );
+    ecl_kw_free( ecl_kw );
+    prefetch->kw_list[index] = NULL;
+  }
+}
+
+
+static bool ecl_kw_prefetch_wait( const ecl_kw_prefetch_type * prefetch ) {
+  if (prefetch->stop)
+    return false;
+
+  if (prefetch->next_index >= long_vector_size( prefetch->offset_list ))
+    return false;
+
+  return (prefetch->buffer_size > 0) && (prefetch->buffer_size >= prefetch->max_buffer_size);
+}
+
+
+static void * ecl_kw_prefetch_main( void * arg ) {
+  ecl_kw_prefetch_type * prefetch = (ecl_kw_prefetch_type *) arg;
+  fortio_type * fortio = fortio_open_reader( prefetch->filename , prefetch->fmt_file , ECL_ENDIAN_FLIP );
+
+  pthread_mutex_lock( &prefetch->mutex );
+  if (fortio != NULL) {
+    prefetch->stream_open = true;
+    while (true) {
+      if (ecl_kw_prefetch_wait( prefetch )) {
+        if (prefetch->close_stream) {
+          fortio_fclose_stream( fortio );
+          prefetch->stream_open = false;
+        }
+        pthread_cond_broadcast( &prefetch->cond );
+
+        while (ecl_kw_prefetch_wait( prefetch ))
+          pthread_cond_wait( &prefetch->cond , &prefetch->mutex );
+      }
+
+      if (prefetch->stop || (prefetch->next_index >= long_vector_size( prefetch->offset_list )))
+        break;
+
+      if (!prefetch->stream_open) {
+        if (!fortio_fopen_stream( fortio ))
+          break;
+        prefetch->stream_open = true;
+      }
+
+      {
+        int index = prefetch->next_index;
+        offset_type offset = long_vector_iget( prefetch->offset_list , index );
+        ecl_kw_type * ecl_kw;
+
+        prefetch->active_index = index;
+        pthread_mutex_unlock( &prefetch->mutex );
+        {
+          fortio_fseek( fortio , offset , SEEK_SET );
+          ecl_kw = ecl_kw_fread_alloc( fortio );
+        }
+        pthread_mutex_lock( &prefetch->mutex );
+        prefetch->active_index = -1;
+        prefetch->next_index = util_int_max( prefetch->next_index , index + 1 );
+
+        if (ecl_kw != NULL) {
+          if (prefetch->stop || (index < prefetch->consumer_index))
+            ecl_kw_free( ecl_kw );
+          else {
+            size_t kw_bytes = ecl_kw_prefetch_kw_bytes( ecl_kw );
+            prefetch->kw_list[index] = ecl_kw;
+            prefetch->buffer_size    += kw_bytes;
+            prefetch->prefetch_bytes += kw_bytes;
+          }
+        }
+        pthread_cond_broadcast( &prefetch->cond );
+
+        if (ecl_kw == NULL)
+          break;
+      }
+    }
+  }
+  if (fortio != NULL)
+    fortio_fclose( fortio );
+
+  prefetch->stream_open = false;
+  prefetch->running = false;
+  pthread_cond_broadcast( &prefetch->cond );
+  pthread_mutex_unlock( &prefetch->mutex );
+  return NULL;
+}
+
+#endif
+
+
+ecl_kw_prefetch_type * ecl_kw_prefetch_alloc( const char * filename , bool fmt_file , bool close_stream , const long_vector_type * offset_list , size_t max_buffer_size ) {
+  ecl_kw_prefetch_type * prefetch = util_malloc( sizeof * prefetch );
+  UTIL_TYPE_ID_INIT( prefetch , ECL_KW_PREFETCH_TYPE_ID );
+  prefetch->filename        = util_alloc_string_copy( filename );
+  prefetch->fmt_file        = fmt_file;
+  prefetch->close_stream    = close_stream;
+  prefetch->offset_list     = long_vector_alloc_copy( offset_list );
+  prefetch->kw_list         = util_calloc( long_vector_size( offset_list ) , sizeof * prefetch->kw_list );
+  prefetch->next_index      = 0;
+  prefetch->active_index    = -1;
+  prefetch->consumer_index  = 0;
+  prefetch->drop_index      = 0;
+  prefetch->buffer_size     = 0;
+  prefetch->max_buffer_size = max_buffer_size;
+  prefetch->hits            = 0;
+  prefetch->misses          = 0;
+  prefetch->prefetch_bytes  = 0;
+  prefetch->stop            = false;
+  prefetch->running         = false;
+  prefetch->stream_open     = false;
+  prefetch->thread_created  = false;
+  {
+    int i;
+    for (i=0; i < long_vector_size( offset_list ); i++)
+      prefetch->kw_list[i] = NULL;
+  }
+
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &prefetch->mutex , NULL );
+  pthread_cond_init( &prefetch->cond , NULL );
+  prefetch->running = true;
+  if (pthread_create( &prefetch->thread , NULL , ecl_kw_prefetch_main , prefetch ) == 0)
+    prefetch->thread_created = true;
+  else
+    prefetch->running = false;
+#endif
+
+  return prefetch;
+}
+
+
+/**
+   Will stop the background thread and discard all the keywords in the
+   buffer; after ecl_kw_prefetch_stop() has been called all lookups
+   will be misses.
+*/
+
+void ecl_kw_prefetch_stop( ecl_kw_prefetch_type * prefetch ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+  prefetch->stop = true;
+  pthread_cond_broadcast( &prefetch->cond );
+  while (prefetch->running)
+    pthread_cond_wait( &prefetch->cond , &prefetch->mutex );
+  {
+    int i;
+    for (i=0; i < long_vector_size( prefetch->offset_list ); i++)
+      ecl_kw_prefetch_drop( prefetch , i );
+  }
+  pthread_mutex_unlock( &prefetch->mutex );
+#else
+  prefetch->stop = true;
+#endif
+}
+
+
+/**
+   Will block until the background thread is idle, i.e. it has either
+   read all the keywords, been stopped, or is waiting for the consumer
+   to make room in a full buffer. Without pthread support the function
+   returns immediately.
+*/
+
+void ecl_kw_prefetch_wait_idle( ecl_kw_prefetch_type * prefetch ) {
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+  while (prefetch->running && !ecl_kw_prefetch_wait( prefetch ))
+    pthread_cond_wait( &prefetch->cond , &prefetch->mutex );
+  pthread_mutex_unlock( &prefetch->mutex );
+#endif
+}
+
+
+bool ecl_kw_prefetch_stream_is_open( ecl_kw_prefetch_type * prefetch ) {
+  bool stream_open;
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+  stream_open = prefetch->stream_open;
+  pthread_mutex_unlock( &prefetch->mutex );
+#else
+  stream_open = false;
+#endif
+  return stream_open;
+}
+
+
+void ecl_kw_prefetch_free( ecl_kw_prefetch_type * prefetch ) {
+  ecl_kw_prefetch_stop( prefetch );
+#ifdef WITH_PTHREAD
+  if (prefetch->thread_created)
+    pthread_join( prefetch->thread , NULL );
+  pthread_mutex_destroy( &prefetch->mutex );
+  pthread_cond_destroy( &prefetch->cond );
+#endif
+  long_vector_free( prefetch->offset_list );
+  free( prefetch->kw_list );
+  free( prefetch->filename );
+  free( prefetch );
+}
+
+
+/**
+   Will return the keyword at file offset @offset if it has been
+   prefetched, otherwise NULL. If the keyword is currently being read
+   by the background thread the function will wait for it. Ownership
+   of the returned keyword is transferred to the caller.
+*/
+
+ecl_kw_type * ecl_kw_prefetch_get_kw( ecl_kw_prefetch_type * prefetch , offset_type offset ) {
+  ecl_kw_type * ecl_kw = NULL;
+  int index = long_vector_index_sorted( prefetch->offset_list , offset );
+
+  if (index < 0)
+    return NULL;
+
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+  {
+    prefetch->consumer_index = util_int_max( prefetch->consumer_index , index );
+    while (prefetch->active_index == index)
+      pthread_cond_wait( &prefetch->cond , &prefetch->mutex );
+
+    ecl_kw = prefetch->kw_list[index];
+    if (ecl_kw != NULL) {
+      prefetch->kw_list[index] = NULL;
+      prefetch->buffer_size -= ecl_kw_prefetch_kw_bytes( ecl_kw );
+      prefetch->hits++;
+    } else {
+      prefetch->misses++;
+      if (prefetch->next_index <= index)
+        prefetch->next_index = index + 1;
+    }
+
+    if (prefetch->buffer_size >= prefetch->max_buffer_size) {
+      int i;
+      for (i=prefetch->drop_index; i < index; i++)
+        ecl_kw_prefetch_drop( prefetch , i );
+      prefetch->drop_index = util_int_max( prefetch->drop_index , index );
+    }
+    pthread_cond_broadcast( &prefetch->cond );
+  }
+  pthread_mutex_unlock( &prefetch->mutex );
+#else
+  prefetch->misses++;
+#endif
+
+  return ecl_kw;
+}
+
+
+int ecl_kw_prefetch_get_hits( ecl_kw_prefetch_type * prefetch ) {
+  int hits;
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+#endif
+  hits = prefetch->hits;
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &prefetch->mutex );
+#endif
+  return hits;
+}
+
+
+int ecl_kw_prefetch_get_misses( ecl_kw_prefetch_type * prefetch ) {
+  int misses;
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+#endif
+  misses = prefetch->misses;
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &prefetch->mutex );
+#endif
+  return misses;
+}
+
+
+double ecl_kw_prefetch_get_hit_rate( ecl_kw_prefetch_type * prefetch ) {
+  int hits    = ecl_kw_prefetch_get_hits( prefetch );
+  int lookups = hits + ecl_kw_prefetch_get_misses( prefetch );
+  if (lookups > 0)
+    return 1.0 * hits / lookups;
+  else
+    return 0;
+}
+
+
+/**
+   The total number of bytes of keyword data read by the background
+   thread.
+*/
+
+size_t ecl_kw_prefetch_get_prefetch_bytes( ecl_kw_prefetch_type * prefetch ) {
+  size_t prefetch_bytes;
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &prefetch->mutex );
+#endif
+  prefetch_bytes = prefetch->prefetch_bytes;
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &prefetch->mutex );
+#endif
+  return prefetch_bytes;
+}
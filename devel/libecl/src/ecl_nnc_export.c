@@ -16,13 +16,14 @@
    for more detals. 
 */ 
 #include <stdlib.h>
+#include <string.h>
 
 #include <ert/util/int_vector.h>
 
 #include <ert/ecl/ecl_file.h>
 #include <ert/ecl/ecl_grid.h>
 #include <ert/ecl/ecl_nnc_export.h>
-#include <ert/ecl/nnc_info.h>
+#include <ert/ecl/nnc_table.h>
 #include <ert/ecl/ecl_kw_magic.h>
 
 
@@ -33,59 +34,93 @@ int ecl_nnc_export_get_size( const ecl_grid_type * grid ) {
 
 
 
-static void  ecl_nnc_export__( const ecl_grid_type * grid , int lgr_index1 , const ecl_file_type * init_file , ecl_nnc_type * nnc_data, int * nnc_offset) {
-  int nnc_index = *nnc_offset;
-  int lgr_nr1 = ecl_grid_get_lgr_nr( grid );
-  int global_index1;
-  const ecl_grid_type * global_grid = ecl_grid_get_global_grid( grid );
+/*
+  The nnc are exported directly from the nnc_table of each grid, and
+  in the order given by ecl_nnc_cmp(): the grids are visited in order
+  of increasing lgr_nr, then for each lgr_nr2 the cells are visited
+  in order of increasing global_index1 and the (typically very few)
+  connections of each cell are sorted on global_index2 in place. The
+  tran keyword is looked up once for each (lgr_nr1 , lgr_nr2) pair.
+*/
+
+static void ecl_nnc_export_sort_cell( ecl_nnc_type * nnc_data , int size ) {
+  int i;
+  for (i = 1; i < size; i++) {
+    ecl_nnc_type nnc = nnc_data[i];
+    int j = i;
+
+    while ((j > 0) && (nnc_data[j - 1].global_index2 > nnc.global_index2)) {
+      nnc_data[j] = nnc_data[j - 1];
+      j--;
+    }
+    nnc_data[j] = nnc;
+  }
+}
 
-  if (!global_grid)
-    global_grid = grid;
 
-  
-  for (global_index1 = 0; global_index1 < ecl_grid_get_global_size( grid ); global_index1++) {
-    const nnc_info_type * nnc_info = ecl_grid_get_cell_nnc_info1( grid , global_index1 );
-    if (nnc_info) {
-      int lgr_index2;
-      for (lgr_index2=0; lgr_index2 < nnc_info_get_size( nnc_info ); lgr_index2++) {
-        const nnc_vector_type * nnc_vector = nnc_info_iget_vector( nnc_info , lgr_index2 );
-        const int_vector_type * grid2_index_list = nnc_vector_get_grid_index_list( nnc_vector );
-        const int_vector_type * nnc_index_list = nnc_vector_get_nnc_index_list( nnc_vector );
-        int lgr_nr2 = nnc_vector_get_lgr_nr( nnc_vector );
-        const ecl_kw_type * tran_kw = ecl_nnc_export_get_tranx_kw(global_grid  , init_file , lgr_nr1 , lgr_nr2 );
-        int index2;
-        ecl_nnc_type nnc;
-
-        nnc.grid_nr1 = lgr_nr1;
-        nnc.grid_nr2 = lgr_nr2;
-        nnc.global_index1 = global_index1;
+static void  ecl_nnc_export__( const ecl_grid_type * grid , const ecl_file_type * init_file , ecl_nnc_type * nnc_data, int * nnc_offset) {
+  const nnc_table_type * nnc_table = ecl_grid_get_nnc_table( grid );
+
+  if (nnc_table) {
+    int nnc_index = *nnc_offset;
+    int lgr_nr1 = ecl_grid_get_lgr_nr( grid );
+    const int_vector_type * lgr_list = nnc_table_get_lgr_list( nnc_table );
+    const ecl_grid_type * global_grid = ecl_grid_get_global_grid( grid );
+    int ilgr;
+
+    if (!global_grid)
+      global_grid = grid;
+
+    for (ilgr = 0; ilgr < int_vector_size( lgr_list ); ilgr++) {
+      int lgr_nr2 = int_vector_iget( lgr_list , ilgr );
+      const ecl_kw_type * tran_kw = ecl_nnc_export_get_tranx_kw(global_grid  , init_file , lgr_nr1 , lgr_nr2 );
+      int global_index1;
+      ecl_nnc_type nnc;
 
-        for (index2 = 0; index2 < nnc_vector_get_size( nnc_vector ); index2++) {
-          nnc.global_index2 = int_vector_iget( grid2_index_list , index2 );
-          nnc.trans = ecl_kw_iget_as_double( tran_kw , int_vector_iget( nnc_index_list , index2));
+      nnc.grid_nr1 = lgr_nr1;
+      nnc.grid_nr2 = lgr_nr2;
 
-          nnc_data[nnc_index] = nnc;
-          nnc_index++;
+      for (global_index1 = 0; global_index1 < nnc_table_get_num_cells( nnc_table ); global_index1++) {
+        int offset = nnc_table_get_cell_offset( nnc_table , global_index1 );
+        int cell_size = nnc_table_get_cell_size( nnc_table , global_index1 );
+        int cell_start = nnc_index;
+        int index;
+
+        nnc.global_index1 = global_index1;
+        for (index = offset; index < offset + cell_size; index++) {
+          if (nnc_table_iget_lgr_nr( nnc_table , index ) == lgr_nr2) {
+            nnc.global_index2 = nnc_table_iget_global_index( nnc_table , index );
+            nnc.trans = ecl_kw_iget_as_double( tran_kw , nnc_table_iget_nnc_index( nnc_table , index ));
+
+            nnc_data[nnc_index] = nnc;
+            nnc_index++;
+          }
         }
+        ecl_nnc_export_sort_cell( &nnc_data[cell_start] , nnc_index - cell_start );
       }
     }
+    *nnc_offset = nnc_index;
   }
-  *nnc_offset = nnc_index;
 }
 
 
 void  ecl_nnc_export( const ecl_grid_type * grid , const ecl_file_type * init_file , ecl_nnc_type * nnc_data) {
   int nnc_index = 0;
-  ecl_nnc_export__( grid , 0 , init_file , nnc_data , &nnc_index );
+  ecl_nnc_export__( grid , init_file , nnc_data , &nnc_index );
   {
+    int_vector_type * lgr_nr_list = int_vector_alloc( 0 , 0 );
     int lgr_index; 
-    for (lgr_index = 0; lgr_index < ecl_grid_get_num_lgr(grid); lgr_index++) {
-      ecl_grid_type * igrid = ecl_grid_iget_lgr( grid , lgr_index );
-      ecl_nnc_export__( igrid , lgr_index , init_file , nnc_data , &nnc_index );
+
+    for (lgr_index = 0; lgr_index < ecl_grid_get_num_lgr(grid); lgr_index++) 
+      int_vector_append( lgr_nr_list , ecl_grid_get_lgr_nr( ecl_grid_iget_lgr( grid , lgr_index )));
+    int_vector_sort( lgr_nr_list );
+    
+    for (lgr_index = 0; lgr_index < int_vector_size( lgr_nr_list ); lgr_index++) {
+      const ecl_grid_type * igrid = ecl_grid_get_lgr_from_lgr_nr( grid , int_vector_iget( lgr_nr_list , lgr_index ));
+      ecl_nnc_export__( igrid , init_file , nnc_data , &nnc_index );
     }
+    int_vector_free( lgr_nr_list );
   }
-  nnc_index = ecl_nnc_export_get_size( grid );
-  ecl_nnc_sort( nnc_data , nnc_index );
 }
 
 
@@ -143,12 +178,13 @@ ecl_kw_type * ecl_nnc_export_get_tranll_kw( const ecl_grid_type * grid , const e
   const int file_num_kw = ecl_file_get_size( init_file );
   int global_kw_index = 0;
   
+  /* Only the LGRJOIN keywords are loaded while scanning the file. */
   while (true) {
     if (global_kw_index >= file_num_kw) 
       break;
     {
-      ecl_kw_type * ecl_kw = ecl_file_iget_kw( init_file , global_kw_index );
-      if (strcmp( LGRJOIN_KW , ecl_kw_get_header( ecl_kw)) == 0) {
+      if (strcmp( LGRJOIN_KW , ecl_file_iget_header( init_file , global_kw_index )) == 0) {
+        ecl_kw_type * ecl_kw = ecl_file_iget_kw( init_file , global_kw_index );
         
         if (ecl_kw_icmp_string( ecl_kw , 0 , lgr_name1) && ecl_kw_icmp_string( ecl_kw , 1 , lgr_name2)) {
           tran_kw = ecl_file_iget_kw( init_file , global_kw_index + 1);
@@ -183,18 +219,20 @@ ecl_kw_type * ecl_nnc_export_get_tran_kw( const ecl_file_type * init_file , cons
       else
         tran_kw_forward_skip = 4;
       
+      /* 
+         The headers are checked before the keywords are loaded, so
+         that only the LGRHEADI keywords and the tran keyword we are
+         after are actually read from the file.
+      */
       while (!finished) {
-        ecl_kw_type * ecl_kw = ecl_file_iget_kw( init_file , global_kw_index );
-        
-        if (strcmp( LGRHEADI_KW , ecl_kw_get_header( ecl_kw )) == 0) {
+        if (strcmp( LGRHEADI_KW , ecl_file_iget_header( init_file , global_kw_index )) == 0) {
+          ecl_kw_type * ecl_kw = ecl_file_iget_kw( init_file , global_kw_index );
           if (ecl_kw_iget_int( ecl_kw , LGRHEADI_LGR_NR_INDEX) == lgr_nr) {
             
             if ((global_kw_index + tran_kw_forward_skip) < file_num_kw) {
-              ecl_kw_type * ecl_kw = ecl_file_iget_kw( init_file , global_kw_index + tran_kw_forward_skip);
-
               /* We found the TRANGL / TRANNC keyword we are after. */
-              if (strcmp( kw , ecl_kw_get_header( ecl_kw )) == 0) {
-                tran_kw = ecl_kw;
+              if (strcmp( kw , ecl_file_iget_header( init_file , global_kw_index + tran_kw_forward_skip )) == 0) {
+                tran_kw = ecl_file_iget_kw( init_file , global_kw_index + tran_kw_forward_skip);
                 finished = true;
                 break;
               } 
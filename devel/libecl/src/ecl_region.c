@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
 
 #include <ert/util/int_vector.h>
 #include <ert/util/util.h>
@@ -61,6 +62,13 @@
    elements. This is checked, and the program will fail hard if it is
    not satisfied.
 
+   The selection is stored as a packed bitset with one bit per global
+   cell. The selectors evaluate their criteria for one 64 bit word at
+   a time and update the mask word-wise, and the set operations
+   (union, intersection, ...) are plain word-wise bit operations. The
+   index lists are created lazily from the bitset when they are
+   requested.
+
    Example:
    --------
    
@@ -92,10 +100,12 @@
 
 
 #define ECL_REGION_TYPE_ID 1106377
+#define ECL_REGION_WORD_SIZE 64
 
 struct ecl_region_struct {
   UTIL_TYPE_ID_DECLARATION;
-  bool                * active_mask;          /* This marks active|inactive in the region, which is unrelated to active in the grid. */
+  uint64_t            * active_mask;          /* Bitset marking active|inactive in the region, which is unrelated to active in the grid. */
+  int                   num_words;            /* The number of words in active_mask; the bits beyond grid_vol are always zero. */
   int_vector_type     * global_index_list;    /* This is a list of the cells in the region - irrespective of whether they are active in the grid or not. */
   int_vector_type     * active_index_list;    /* This means cells in the region which are also active in the grid */
   int_vector_type     * global_active_list;   /* This is a list of (maximum) nactive elements, where the values are in the [0,..nx*ny*nz) range. */
@@ -122,6 +132,111 @@ static void ecl_region_invalidate_index_list( ecl_region_type * region ) {
 }
 
 
+/*****************************************************************/
+/* Bitset primitives. */
+
+static inline int ecl_region_popcount( uint64_t bits ) {
+#ifdef __GNUC__
+  return __builtin_popcountll( bits );
+#else
+  bits = bits - ((bits >> 1) & UINT64_C(0x5555555555555555));
+  bits = (bits & UINT64_C(0x3333333333333333)) + ((bits >> 2) & UINT64_C(0x3333333333333333));
+  bits = (bits + (bits >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+  return (int) ((bits * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+
+/* The index of the lowest set bit; bits must be nonzero. */
+static inline int ecl_region_lowest_bit( uint64_t bits ) {
+#ifdef __GNUC__
+  return __builtin_ctzll( bits );
+#else
+  return ecl_region_popcount( (bits & -bits) - 1 );
+#endif
+}
+
+
+static inline void ecl_region_apply_word( ecl_region_type * region , int word , uint64_t bits , bool select) {
+  if (select)
+    region->active_mask[ word ] |= bits;
+  else
+    region->active_mask[ word ] &= ~bits;
+}
+
+
+static inline void ecl_region_apply_bit( ecl_region_type * region , int global_index , bool value , bool select) {
+  uint64_t bits = ((uint64_t) value) << (global_index % ECL_REGION_WORD_SIZE);
+  ecl_region_apply_word( region , global_index / ECL_REGION_WORD_SIZE , bits , select );
+}
+
+
+static inline bool ecl_region_get_bit( const ecl_region_type * region , int global_index ) {
+  return (region->active_mask[ global_index / ECL_REGION_WORD_SIZE ] >> (global_index % ECL_REGION_WORD_SIZE)) & 1;
+}
+
+
+/* Selects/deselects all the cells in the global index range [global1, global2). */
+static void ecl_region_apply_range( ecl_region_type * region , int global1 , int global2 , bool select) {
+  if (global1 < global2) {
+    const int word1 = global1 / ECL_REGION_WORD_SIZE;
+    const int word2 = (global2 - 1) / ECL_REGION_WORD_SIZE;
+    const uint64_t mask1 = ~UINT64_C(0) << (global1 % ECL_REGION_WORD_SIZE);
+    const uint64_t mask2 = ~UINT64_C(0) >> (ECL_REGION_WORD_SIZE - 1 - (global2 - 1) % ECL_REGION_WORD_SIZE);
+
+    if (word1 == word2)
+      ecl_region_apply_word( region , word1 , mask1 & mask2 , select );
+    else {
+      int word;
+      ecl_region_apply_word( region , word1 , mask1 , select );
+      for (word = word1 + 1; word < word2; word++)
+        region->active_mask[ word ] = select ? ~UINT64_C(0) : 0;
+      ecl_region_apply_word( region , word2 , mask2 , select );
+    }
+  }
+}
+
+
+/*
+  The selection kernels: @predicate is an expression in the variable
+  'index', which is the global index for keywords with nx*ny*nz
+  elements, and the active index for keywords with nactive
+  elements. For global keywords the predicate is evaluated for 64
+  cells into one word, which is then applied to the mask in one
+  operation; for active keywords the bits are scattered through the
+  active -> global map of the grid.
+*/
+
+#define ECL_REGION_SELECT_GLOBAL( region , select , predicate )                                       \
+  do {                                                                                               \
+    int word;                                                                                        \
+    for (word = 0; word < (region)->num_words; word++) {                                             \
+      const int offset = word * ECL_REGION_WORD_SIZE;                                                \
+      const int length = ((region)->grid_vol - offset < ECL_REGION_WORD_SIZE) ? (region)->grid_vol - offset : ECL_REGION_WORD_SIZE; \
+      uint64_t bits = 0;                                                                             \
+      int bit;                                                                                       \
+      for (bit = 0; bit < length; bit++) {                                                           \
+        const int index = offset + bit;                                                              \
+        bits |= ((uint64_t) (predicate)) << bit;                                                     \
+      }                                                                                              \
+      ecl_region_apply_word( region , word , bits , select );                                        \
+    }                                                                                                \
+  } while (0)
+
+
+#define ECL_REGION_SELECT_KW( region , global_kw , select , predicate )                               \
+  do {                                                                                               \
+    if (global_kw)                                                                                   \
+      ECL_REGION_SELECT_GLOBAL( region , select , predicate );                                       \
+    else {                                                                                           \
+      const int * inv_index_map = ecl_grid_get_inv_index_map_ptr( (region)->parent_grid );           \
+      int index;                                                                                     \
+      for (index = 0; index < (region)->grid_active; index++)                                        \
+        ecl_region_apply_bit( region , inv_index_map[ index ] , (predicate) , select );              \
+    }                                                                                                \
+  } while (0)
+
+
 void ecl_region_lock( ecl_region_type * region ){
   int_vector_set_read_only( region->global_index_list , true );
   int_vector_set_read_only( region->active_index_list , true );
@@ -142,7 +257,8 @@ ecl_region_type * ecl_region_alloc( const ecl_grid_type * ecl_grid , bool presel
   region->parent_grid = ecl_grid;
   ecl_grid_get_dims( ecl_grid , &region->grid_nx , &region->grid_ny , &region->grid_nz , &region->grid_active);
   region->grid_vol          = region->grid_nx * region->grid_ny * region->grid_nz;
-  region->active_mask       = util_calloc(region->grid_vol , sizeof * region->active_mask );
+  region->num_words         = (region->grid_vol + ECL_REGION_WORD_SIZE - 1) / ECL_REGION_WORD_SIZE;
+  region->active_mask       = util_calloc(region->num_words , sizeof * region->active_mask );
   region->active_index_list  = int_vector_alloc(0 , 0);
   region->global_index_list  = int_vector_alloc(0 , 0);
   region->global_active_list = int_vector_alloc(0 , 0);
@@ -159,7 +275,7 @@ ecl_region_type * ecl_region_alloc( const ecl_grid_type * ecl_grid , bool presel
 
 ecl_region_type * ecl_region_alloc_copy( const ecl_region_type * ecl_region ) {
   ecl_region_type * new_region = ecl_region_alloc( ecl_region->parent_grid , ecl_region->preselect );
-  memcpy( new_region->active_mask , ecl_region->active_mask , ecl_region->grid_vol * sizeof * ecl_region->active_mask );
+  memcpy( new_region->active_mask , ecl_region->active_mask , ecl_region->num_words * sizeof * ecl_region->active_mask );
   ecl_region_invalidate_index_list( new_region );
   return new_region;
 }
@@ -185,15 +301,40 @@ void ecl_region_free__( void * __region ) {
 /*****************************************************************/
  
 
+static int ecl_region_count_selected( const ecl_region_type * region ) {
+  int count = 0;
+  int word;
+  for (word = 0; word < region->num_words; word++)
+    count += ecl_region_popcount( region->active_mask[ word ] );
+  return count;
+}
+
+
+/*
+  The index lists are sized from a popcount of the mask, and then
+  filled by extracting the set bits of each word directly.
+*/
+
 static void ecl_region_assert_global_index_list( ecl_region_type * region ) {
   if (!region->global_index_list_valid) {
-    int global_index;
+    int size = ecl_region_count_selected( region );
 
     int_vector_reset( region->global_index_list  );
-    for (global_index = 0; global_index < region->grid_vol; global_index++) 
-      if (region->active_mask[ global_index ]) 
-        int_vector_append( region->global_index_list , global_index );
-    
+    if (size > 0) {
+      int * index_list;
+      int word;
+
+      int_vector_iset( region->global_index_list , size - 1 , 0 );
+      index_list = int_vector_get_ptr( region->global_index_list );
+      for (word = 0; word < region->num_words; word++) {
+        uint64_t bits = region->active_mask[ word ];
+        while (bits) {
+          *index_list = word * ECL_REGION_WORD_SIZE + ecl_region_lowest_bit( bits );
+          index_list++;
+          bits &= bits - 1;
+        }
+      }
+    }
     region->global_index_list_valid = true;
   }
 }
@@ -201,16 +342,35 @@ static void ecl_region_assert_global_index_list( ecl_region_type * region ) {
 
 static void ecl_region_assert_active_index_list( ecl_region_type * region ) {
   if (!region->active_index_list_valid) {
-    int global_index;
+    const int * index_map = ecl_grid_get_index_map_ptr( region->parent_grid );
+    const int * global_list;
+    int global_size;
+    int size = 0;
+    int i;
+
+    ecl_region_assert_global_index_list( region );
+    global_list = int_vector_get_const_ptr( region->global_index_list );
+    global_size = int_vector_size( region->global_index_list );
+    for (i = 0; i < global_size; i++)
+      size += (index_map[ global_list[i] ] >= 0);
 
     int_vector_reset( region->active_index_list  );
     int_vector_reset( region->global_active_list );
-    for (global_index = 0; global_index < region->grid_vol; global_index++) {
-      if (region->active_mask[ global_index ]) {
-        int active_index = ecl_grid_get_active_index1( region->parent_grid , global_index );
+    if (size > 0) {
+      int * active_list;
+      int * global_active_list;
+      int active_size = 0;
+
+      int_vector_iset( region->active_index_list , size - 1 , 0 );
+      int_vector_iset( region->global_active_list , size - 1 , 0 );
+      active_list        = int_vector_get_ptr( region->active_index_list );
+      global_active_list = int_vector_get_ptr( region->global_active_list );
+      for (i = 0; i < global_size; i++) {
+        int active_index = index_map[ global_list[i] ];
         if (active_index >= 0) {
-          int_vector_append( region->active_index_list , active_index );
-          int_vector_append( region->global_active_list , global_index );
+          active_list[ active_size ]        = active_index;
+          global_active_list[ active_size ] = global_list[i];
+          active_size++;
         }
       }
     }
@@ -276,9 +436,8 @@ static void ecl_region_assert_kw( const ecl_region_type * region , const ecl_kw_
 /*****************************************************************/ 
 
 void ecl_region_reset( ecl_region_type * ecl_region ) {
-  int i;
-  for (i=0; i < ecl_region->grid_vol; i++) 
-    ecl_region->active_mask[i] = ecl_region->preselect;
+  memset( ecl_region->active_mask , 0 , ecl_region->num_words * sizeof * ecl_region->active_mask );
+  ecl_region_apply_range( ecl_region , 0 , ecl_region->grid_vol , ecl_region->preselect );
   ecl_region_invalidate_index_list( ecl_region );
 }
 
@@ -287,7 +446,7 @@ void ecl_region_reset( ecl_region_type * ecl_region ) {
 
 static void ecl_region_select_cell__( ecl_region_type * region , int i , int j , int k, bool select) {
   int global_index = ecl_grid_get_global_index3( region->parent_grid , i,j,k);
-  region->active_mask[global_index] = select;
+  ecl_region_apply_bit( region , global_index , true , select );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -310,21 +469,7 @@ static void ecl_region_select_equal__( ecl_region_type * region , const ecl_kw_t
     util_abort("%s: sorry - select by equality is only supported for integer keywords \n",__func__);
   {
     const int * kw_data = ecl_kw_get_int_ptr( ecl_kw );
-    if (global_kw) {
-      int global_index;
-      for (global_index = 0; global_index < region->grid_vol; global_index++) {
-        if (kw_data[ global_index ] == value)
-          region->active_mask[ global_index ] = select;
-      }
-    } else {
-      int active_index;
-      for (active_index = 0; active_index < region->grid_active; active_index++) {
-        if (kw_data[active_index] == value) {
-          int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-          region->active_mask[ global_index ] = select;
-        }
-      }
-    }
+    ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] == value );
   }
   ecl_region_invalidate_index_list( region );
 }
@@ -349,21 +494,7 @@ static void ecl_region_select_in_interval__( ecl_region_type * region , const ec
     util_abort("%s: sorry - select by in_interval is only supported for float keywords \n",__func__);
   {
     const float * kw_data = ecl_kw_get_float_ptr( ecl_kw );
-    if (global_kw) {
-      int global_index;
-      for (global_index = 0; global_index < region->grid_vol; global_index++) {
-        if (kw_data[ global_index ] >= min_value && kw_data[ global_index ] < max_value)
-          region->active_mask[ global_index ] = select;
-      }
-    } else {
-      int active_index;
-      for (active_index = 0; active_index < region->grid_active; active_index++) {
-        if (kw_data[ active_index ] >= min_value && kw_data[ active_index ] < max_value) {
-          int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-          region->active_mask[ global_index ] = select;
-        }
-      }
-    }
+    ECL_REGION_SELECT_KW( region , global_kw , select , (kw_data[ index ] >= min_value) & (kw_data[ index ] < max_value) );
   }
   ecl_region_invalidate_index_list( region );
 }
@@ -380,13 +511,6 @@ void ecl_region_deselect_in_interval( ecl_region_type * region , const ecl_kw_ty
 
 /*****************************************************************/
 
-/**
-   This is waaaay to fucking large:
-
-   Float / Int / double *  Active / Global  *  More / Less ==> In total 12 code blocks written out ...
-*/
-
-
 /*
   NBNBNBNB: Select >= on float values and select > on integer!!!!!!
 */
@@ -401,93 +525,24 @@ static void ecl_region_select_with_limit__( ecl_region_type * region , const ecl
     if (ecl_type == ECL_FLOAT_TYPE) {
       const float * kw_data = ecl_kw_get_float_ptr( ecl_kw );
       float float_limit = limit;
-      if (global_kw) {
-        int global_index;
-        for (global_index = 0; global_index < region->grid_vol; global_index++) {
-          if (select_less) {
-            if (kw_data[ global_index ] < float_limit)
-              region->active_mask[ global_index ] = select;
-          } else {
-            if (kw_data[ global_index ] >= float_limit)
-              region->active_mask[ global_index ] = select;
-          }
-        }
-      } else {
-        int active_index;
-        for (active_index = 0; active_index < region->grid_active; active_index++) {
-          if (select_less) {
-            if (kw_data[ active_index ] < float_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          } else {
-            if (kw_data[ active_index ] >= float_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          }
-        }
-      }
+      if (select_less)
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] < float_limit );
+      else
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] >= float_limit );
     } else if (ecl_type == ECL_INT_TYPE) {
       const int * kw_data = ecl_kw_get_int_ptr( ecl_kw );
       int int_limit = (int) limit;
-      if (global_kw) {
-        int global_index;
-        for (global_index = 0; global_index < region->grid_vol; global_index++) {
-          if (select_less) {
-            if (kw_data[ global_index ] < int_limit)
-              region->active_mask[ global_index ] = select;
-          } else {
-            if (kw_data[ global_index ] > int_limit)
-              region->active_mask[ global_index ] = select;
-          }
-        }
-      } else {
-        int active_index;
-        for (active_index = 0; active_index < region->grid_active; active_index++) {
-          if (select_less) {
-            if (kw_data[ active_index ] < int_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          } else {
-            if (kw_data[ active_index ] > int_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          }
-        }
-      }
+      if (select_less)
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] < int_limit );
+      else
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] > int_limit );
     } else if (ecl_type == ECL_DOUBLE_TYPE) {
       const double * kw_data = ecl_kw_get_double_ptr( ecl_kw );
       double double_limit = (double) limit;
-      if (global_kw) {
-        int global_index;
-        for (global_index = 0; global_index < region->grid_vol; global_index++) {
-          if (select_less) {
-            if (kw_data[ global_index ] < double_limit)
-              region->active_mask[ global_index ] = select;
-          } else {
-            if (kw_data[ global_index ] >= double_limit)
-              region->active_mask[ global_index ] = select;
-          }
-        }
-      } else {
-        int active_index;
-        for (active_index = 0; active_index < region->grid_active; active_index++) {
-          if (select_less) {
-            if (kw_data[ active_index ] < double_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          } else {
-            if (kw_data[ active_index ] >= double_limit) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          }
-        }
-      }
+      if (select_less)
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] < double_limit );
+      else
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw_data[ index ] >= double_limit );
     }
   }
   ecl_region_invalidate_index_list( region );
@@ -528,33 +583,10 @@ static void ecl_region_cmp_select__( ecl_region_type * region , const ecl_kw_typ
       const float * kw1_data = ecl_kw_get_float_ptr( kw1 );
       const float * kw2_data = ecl_kw_get_float_ptr( kw2 );
       
-      if (global_kw) {
-        int global_index;
-        for (global_index = 0; global_index < region->grid_vol; global_index++) {
-          if (select_less) {
-            if (kw1_data[ global_index ] < kw2_data[ global_index ])
-              region->active_mask[ global_index ] = select;
-          } else {
-            if (kw1_data[ global_index ] >= kw2_data[ global_index ] )
-              region->active_mask[ global_index ] = select;
-          }
-        }
-      } else {
-        int active_index;
-        for (active_index = 0; active_index < region->grid_active; active_index++) {
-          if (select_less) {
-            if (kw1_data[ active_index ] < kw2_data[ active_index] ) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          } else {
-            if (kw1_data[ active_index ] >= kw2_data[ active_index ]) {
-              int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index );
-              region->active_mask[ global_index ] = select;
-            }
-          }
-        }
-      }
+      if (select_less)
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw1_data[ index ] < kw2_data[ index ] );
+      else
+        ECL_REGION_SELECT_KW( region , global_kw , select , kw1_data[ index ] >= kw2_data[ index ] );
     } else 
       util_abort("%s: type/size mismatch between keywords. \n",__func__);
   }
@@ -593,7 +625,7 @@ static void ecl_region_select_from_box__( ecl_region_type * region , const ecl_b
   int box_index;
 
   for (box_index = 0; box_index < box_size; box_index++) 
-    region->active_mask[ active_list[box_index] ] = select;
+    ecl_region_apply_bit( region , active_list[box_index] , true , select );
       
   ecl_region_invalidate_index_list( region );
 }
@@ -653,13 +685,12 @@ static void ecl_region_select_i1i2__( ecl_region_type * region , int i1 , int i2
   i1 = util_int_max(0 , i1);
   i2 = util_int_min(region->grid_nx - 1 , i2);
   {
-    int i,j,k;
+    int j,k;
     for (k = 0; k < region->grid_nz; k++)
-      for (j = 0; j < region->grid_ny; j++)
-        for (i = i1; i <= i2; i++) {
-          int global_index = ecl_grid_get_global_index3( region->parent_grid , i,j,k);
-          region->active_mask[global_index] = select;
-        }
+      for (j = 0; j < region->grid_ny; j++) {
+        int global_index = ecl_grid_get_global_index3( region->parent_grid , 0 , j , k);
+        ecl_region_apply_range( region , global_index + i1 , global_index + i2 + 1 , select );
+      }
   }
   ecl_region_invalidate_index_list( region );
 }
@@ -693,13 +724,12 @@ static void ecl_region_select_j1j2__( ecl_region_type * region , int j1 , int j2
   j1 = util_int_max(0 , j1);
   j2 = util_int_min(region->grid_ny - 1 , j2);
   {
-    int i,j,k;
-    for (k = 0; k < region->grid_nz; k++)
-      for ( j = j1; j <= j2; j++)
-        for ( i = 0; i < region->grid_nx; i++) {
-          int global_index = ecl_grid_get_global_index3( region->parent_grid , i,j,k);
-          region->active_mask[global_index] = select;
-        }
+    const int nx = region->grid_nx;
+    int k;
+    for (k = 0; k < region->grid_nz; k++) {
+      int global_index = ecl_grid_get_global_index3( region->parent_grid , 0 , 0 , k);
+      ecl_region_apply_range( region , global_index + j1 * nx , global_index + (j2 + 1) * nx , select );
+    }
   }
   ecl_region_invalidate_index_list( region );
 }
@@ -732,13 +762,8 @@ static void ecl_region_select_k1k2__( ecl_region_type * region , int k1 , int k2
   k1 = util_int_max(0 , k1);
   k2 = util_int_min(region->grid_nz - 1 , k2);
   {
-    int i,j,k;
-    for (k = k1; k <= k2; k++)
-      for (j = 0; j < region->grid_ny; j++)
-        for (i = 0; i < region->grid_nx; i++) {
-          int global_index = ecl_grid_get_global_index3( region->parent_grid , i,j,k);
-          region->active_mask[global_index] = select;
-        }
+    const int layer_size = region->grid_nx * region->grid_ny;
+    ecl_region_apply_range( region , k1 * layer_size , (k2 + 1) * layer_size , select );
   }
   ecl_region_invalidate_index_list( region );
 }
@@ -763,19 +788,13 @@ void ecl_region_deselect_k1k2( ecl_region_type * region , int k1 , int k2) {
 
 
 static void ecl_region_select_from_depth__( ecl_region_type * region , double depth_limit , bool select_deep  , bool select) {
-  int global_index;
-  for (global_index = 0; global_index < region->grid_vol; global_index++) {
-    double cell_depth = ecl_grid_get_cdepth1( region->parent_grid , global_index );
-    if (select_deep) {
-      // The select/deselect mechanism should be applied to deep cells.
-      if (cell_depth >= depth_limit)
-        region->active_mask[ global_index ] = select;
-    } else {
-      // The select/deselect mechanism should be applied to shallow cells.
-      if (cell_depth <= depth_limit)
-        region->active_mask[ global_index ] = select;
-    }
-  }
+  const ecl_grid_type * grid = region->parent_grid;
+  if (select_deep)
+    // The select/deselect mechanism should be applied to deep cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cdepth1( grid , index ) >= depth_limit );
+  else
+    // The select/deselect mechanism should be applied to shallow cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cdepth1( grid , index ) <= depth_limit );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -801,19 +820,13 @@ void ecl_region_deselect_deep_cells( ecl_region_type * region , double depth_lim
 /*****************************************************************/
 
 static void ecl_region_select_from_volume__( ecl_region_type * region , double volum_limit , bool select_small , bool select) {
-  int global_index;
-  for (global_index = 0; global_index < region->grid_vol; global_index++) {
-    double cell_size = ecl_grid_get_cell_volume1( region->parent_grid , global_index );
-    if (select_small) {
-      // The select/deselect mechanism should be applied to small cells.
-      if (cell_size <= volum_limit)
-        region->active_mask[ global_index ] = select;
-    } else {
-      // The select/deselect mechanism should be applied to large cells.
-      if (cell_size >= volum_limit)
-        region->active_mask[ global_index ] = select;
-    }
-  }
+  const ecl_grid_type * grid = region->parent_grid;
+  if (select_small)
+    // The select/deselect mechanism should be applied to small cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cell_volume1( grid , index ) <= volum_limit );
+  else
+    // The select/deselect mechanism should be applied to large cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cell_volume1( grid , index ) >= volum_limit );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -837,19 +850,13 @@ void ecl_region_deselect_large_cells( ecl_region_type * ecl_region , double volu
 /*****************************************************************/
 
 static void ecl_region_select_from_dz__( ecl_region_type * region , double dz_limit , bool select_thin , bool select) {
-  int global_index;
-  for (global_index = 0; global_index < region->grid_vol; global_index++) {
-    double cell_dz = ecl_grid_get_cell_thickness1( region->parent_grid , global_index );
-    if (select_thin) {
-      // The select/deselect mechanism should be applied to thin cells.
-      if (cell_dz <= dz_limit)
-        region->active_mask[ global_index ] = select;
-    } else {
-      // The select/deselect mechanism should be applied to thick cells.
-      if (cell_dz >= dz_limit)
-        region->active_mask[ global_index ] = select;
-    }
-  }
+  const ecl_grid_type * grid = region->parent_grid;
+  if (select_thin)
+    // The select/deselect mechanism should be applied to thin cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cell_thickness1( grid , index ) <= dz_limit );
+  else
+    // The select/deselect mechanism should be applied to thick cells.
+    ECL_REGION_SELECT_GLOBAL( region , select , ecl_grid_get_cell_thickness1( grid , index ) >= dz_limit );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -871,16 +878,11 @@ void ecl_region_deselect_thick_cells( ecl_region_type * ecl_region , double dz_l
 }
 /*****************************************************************/
 static void ecl_region_select_active_cells__( ecl_region_type * ecl_region , bool select_active , bool select) {
-  int global_index;
-  for (global_index = 0; global_index < ecl_region->grid_vol; global_index++) {
-    if (select_active) {
-      if (ecl_grid_get_active_index1( ecl_region->parent_grid , global_index) >= 0)
-        ecl_region->active_mask[ global_index ] = select;
-    } else {
-      if (ecl_grid_get_active_index1( ecl_region->parent_grid , global_index) < 0)
-        ecl_region->active_mask[ global_index ] = select;
-    }
-  }
+  const int * index_map = ecl_grid_get_index_map_ptr( ecl_region->parent_grid );
+  if (select_active)
+    ECL_REGION_SELECT_GLOBAL( ecl_region , select , index_map[ index ] >= 0 );
+  else
+    ECL_REGION_SELECT_GLOBAL( ecl_region , select , index_map[ index ] < 0 );
   ecl_region_invalidate_index_list( ecl_region );
 }
 
@@ -908,7 +910,7 @@ void ecl_region_deselect_inactive_cells( ecl_region_type * region ) {
 
 static void ecl_region_select_global_index__( ecl_region_type * region , int global_index , bool select) {
   if ((global_index >= 0) && (global_index < region->grid_vol))
-    region->active_mask[ global_index ] = select;
+    ecl_region_apply_bit( region , global_index , true , select );
   else
     util_abort("%s: global_index:%d invalid - legal interval: [0,%d) \n",__func__ , global_index , region->grid_vol);
   ecl_region_invalidate_index_list( region );
@@ -947,9 +949,9 @@ static void ecl_region_cylinder_select__( ecl_region_type * region , double x0 ,
       if ((z >= z1) && (z <= z2)) {
         double pointR2 = (x - x0) * (x - x0) + (y - y0) * (y - y0);
         if ((pointR2 < R2) && (select_inside)) 
-          region->active_mask[ global_index ] = select;
+          ecl_region_apply_bit( region , global_index , true , select );
         else if ((pointR2 > R2) && (!select_inside))
-          region->active_mask[ global_index ] = select;
+          ecl_region_apply_bit( region , global_index , true , select );
       }
     }
   } else {
@@ -974,7 +976,7 @@ static void ecl_region_cylinder_select__( ecl_region_type * region , double x0 ,
           int k;
           for (k=0; k < nz; k++) {
             int global_index = ecl_grid_get_global_index3( region->parent_grid , i,j,k);
-            region->active_mask[ global_index ] = select;
+            ecl_region_apply_bit( region , global_index , true , select );
           }
         }
                 }
@@ -1028,9 +1030,9 @@ static void ecl_region_plane_select__( ecl_region_type * region, const double n[
       ecl_grid_get_xyz1( region->parent_grid , global_index , &x , &y , &z);
       D = a*x + b*y + c*z + d;
       if ((D >= 0) && (select_above))
-        region->active_mask[ global_index ] = select;
+        ecl_region_apply_bit( region , global_index , true , select );
       else if ((D < 0) && (!select_above))
-        region->active_mask[ global_index ] = select;
+        ecl_region_apply_bit( region , global_index , true , select );
     }
   }
   ecl_region_invalidate_index_list( region );
@@ -1100,12 +1102,13 @@ static void ecl_region_polygon_select__( ecl_region_type * region ,
           int k;
           for (k=k1; k < k2; k++) {
             global_index = ecl_grid_get_global_index3( region->parent_grid , i , j , k);
-            region->active_mask[ global_index ] = select;
+            ecl_region_apply_bit( region , global_index , true , select );
           }
         }
       }
     }
   }
+  ecl_region_invalidate_index_list( region );
 }
 
 void ecl_region_select_inside_polygon( ecl_region_type * region , const geo_polygon_type * polygon) {
@@ -1132,7 +1135,7 @@ void ecl_region_deselect_outside_polygon( ecl_region_type * region , const geo_p
 static void ecl_region_select_active_index__( ecl_region_type * region , int active_index , bool select) {
   if ((active_index >= 0) && (active_index < region->grid_active)) {
     int global_index = ecl_grid_get_global_index1A( region->parent_grid , active_index);
-    region->active_mask[ global_index ] = select;
+    ecl_region_apply_bit( region , global_index , true , select );
   } else
     util_abort("%s: active_index:%d invalid - legal interval: [0,%d) \n",__func__ , active_index , region->grid_vol);
   ecl_region_invalidate_index_list( region );
@@ -1151,9 +1154,7 @@ void ecl_region_deselect_active_index( ecl_region_type * region , int active_ind
 /*****************************************************************/
 
 static void ecl_region_select_all__( ecl_region_type * region , bool select) {
-  int global_index;
-  for (global_index = 0; global_index < region->grid_vol; global_index++) 
-    region->active_mask[ global_index ] = select;
+  ecl_region_apply_range( region , 0 , region->grid_vol , select );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -1170,9 +1171,10 @@ void ecl_region_deselect_all( ecl_region_type * region ) {
 /*****************************************************************/
 
 void ecl_region_invert_selection( ecl_region_type * region ) {
-  int global_index;
-  for (global_index = 0; global_index < region->grid_vol; global_index++) 
-    region->active_mask[ global_index ] = !region->active_mask[ global_index ];
+  int word;
+  for (word = 0; word < region->num_words; word++) 
+    region->active_mask[ word ] = ~region->active_mask[ word ];
+  ecl_region_apply_range( region , region->grid_vol , region->num_words * ECL_REGION_WORD_SIZE , false );
   ecl_region_invalidate_index_list( region );
 }
 
@@ -1186,18 +1188,18 @@ void ecl_region_invert_selection( ecl_region_type * region ) {
 
 bool ecl_region_contains_ijk( const ecl_region_type * ecl_region , int i , int j , int k) {
   int global_index = ecl_grid_get_global_index3( ecl_region->parent_grid , i , j , k );
-  return ecl_region->active_mask[ global_index ];
+  return ecl_region_get_bit( ecl_region , global_index );
 }
 
 
 bool ecl_region_contains_global( const ecl_region_type * ecl_region , int global_index) {
-  return ecl_region->active_mask[ global_index ];
+  return ecl_region_get_bit( ecl_region , global_index );
 }
 
 
 bool ecl_region_contains_active( const ecl_region_type * ecl_region , int active_index) {
   int global_index = ecl_grid_get_global_index1A( ecl_region->parent_grid , active_index );
-  return ecl_region->active_mask[ global_index ];
+  return ecl_region_get_bit( ecl_region , global_index );
 }
 
 
@@ -1216,9 +1218,9 @@ bool ecl_region_contains_active( const ecl_region_type * ecl_region , int active
 
 void ecl_region_intersection( ecl_region_type * region , const ecl_region_type * new_region ) {
   if (region->parent_grid == new_region->parent_grid) {
-    int global_index;
-    for (global_index = 0; global_index < region->grid_vol; global_index++) 
-      region->active_mask[global_index] = (region->active_mask[global_index] && new_region->active_mask[global_index]);
+    int word;
+    for (word = 0; word < region->num_words; word++)
+      region->active_mask[word] &= new_region->active_mask[word];
     
     ecl_region_invalidate_index_list( region );
   } else
@@ -1234,9 +1236,9 @@ void ecl_region_intersection( ecl_region_type * region , const ecl_region_type *
 */
 void ecl_region_union( ecl_region_type * region , const ecl_region_type * new_region ) {
   if (region->parent_grid == new_region->parent_grid) {
-    int global_index;
-    for (global_index = 0; global_index < region->grid_vol; global_index++)
-      region->active_mask[global_index] = (region->active_mask[global_index] || new_region->active_mask[global_index]);
+    int word;
+    for (word = 0; word < region->num_words; word++)
+      region->active_mask[word] |= new_region->active_mask[word];
     
     ecl_region_invalidate_index_list( region );
   } else 
@@ -1252,9 +1254,9 @@ void ecl_region_union( ecl_region_type * region , const ecl_region_type * new_re
 */
 void ecl_region_subtract( ecl_region_type * region , const ecl_region_type * new_region) {
   if (region->parent_grid == new_region->parent_grid) {
-    int global_index;
-    for (global_index = 0; global_index < region->grid_vol; global_index++)
-      region->active_mask[global_index] &= !new_region->active_mask[global_index];
+    int word;
+    for (word = 0; word < region->num_words; word++)
+      region->active_mask[word] &= ~new_region->active_mask[word];
     
     ecl_region_invalidate_index_list( region );
   } else 
@@ -1270,9 +1272,10 @@ void ecl_region_subtract( ecl_region_type * region , const ecl_region_type * new
 */
 void ecl_region_xor( ecl_region_type * region , const ecl_region_type * new_region) {
   if (region->parent_grid == new_region->parent_grid) {
-    int global_index;
-    for (global_index = 0; global_index < region->grid_vol; global_index++)
-      region->active_mask[global_index] ^= !new_region->active_mask[global_index];
+    int word;
+    for (word = 0; word < region->num_words; word++)
+      region->active_mask[word] ^= ~new_region->active_mask[word];
+    ecl_region_apply_range( region , region->grid_vol , region->num_words * ECL_REGION_WORD_SIZE , false );
     
     ecl_region_invalidate_index_list( region );
   } else 
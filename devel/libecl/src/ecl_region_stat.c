@@ -0,0 +1,550 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_region_stat.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef WITH_PTHREAD
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+#include <ert/ecl/ecl_region_stat.h>
+
+/*
+  The ecl_region_stat structure calculates sum, mean, weighted mean,
+  minimum and maximum of several keywords for many regions at once,
+  i.e. typical region based reporting like the average pressure in
+  each FIPNUM region, weighted by pore volume.
+
+  The keywords are added with ecl_region_stat_add_kw(), and the
+  optional weight keyword is given when the structure is
+  allocated. The regions are given either as an integer keyword,
+  e.g. FIPNUM, where the value in each cell is the region number, or
+  as a list of ecl_region instances. All keywords can have either
+  nactive or nx*ny*nz elements; the statistics are always calculated
+  over the active cells of the grid.
+
+     ecl_region_stat_type * region_stat = ecl_region_stat_alloc( grid , porv_kw );
+     ecl_region_stat_add_kw( region_stat , pressure_kw );
+     ecl_region_stat_add_kw( region_stat , swat_kw );
+     ecl_region_stat_eval_region_kw( region_stat , fipnum_kw );
+
+     for (region_nr = 1; region_nr < ecl_region_stat_get_num_regions( region_stat ); region_nr++)
+        printf("Region:%d  pressure:%g \n", region_nr , ecl_region_stat_get_weighted_mean( region_stat , region_nr , 0 ));
+
+  All the keywords are processed in the same pass over the grid, in
+  blocks of cells; for large grids the cells (or regions) are
+  distributed over several threads, each accumulating into its own
+  set of results which are combined at the end. The statistics of an
+  empty region are all zero.
+*/
+
+#define ECL_REGION_STAT_TYPE_ID      661207
+#define ECL_REGION_STAT_BLOCK_SIZE     1024
+#define ECL_REGION_STAT_MT_MIN_WORK 1000000       /* Active cells x keywords required before the evaluation is threaded. */
+
+
+typedef struct {
+  int      num_regions;
+  int      num_kw;
+  int    * count;
+  double * weight;
+  double * sum;                       /* The per keyword statistics are stored as [region_nr * num_kw + kw_nr]. */
+  double * weighted_sum;
+  double * min;
+  double * max;
+} region_acc_type;
+
+
+struct ecl_region_stat_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  const ecl_grid_type * grid;
+  const ecl_kw_type   * weight_kw;
+  vector_type         * kw_list;      /* Shared references to the keywords. */
+  region_acc_type     * acc;          /* The results of the last evaluation; NULL before the first evaluation. */
+};
+
+
+typedef struct {
+  const ecl_region_stat_type * region_stat;
+  region_acc_type            * acc;
+  const ecl_kw_type          * region_kw;
+  vector_type                * region_list;
+  int                          offset1;      /* Range of active cells for region_kw evaluation, or of regions for region_list evaluation. */
+  int                          offset2;
+} region_stat_job_type;
+
+
+/*****************************************************************/
+
+static region_acc_type * region_acc_alloc( int num_regions , int num_kw ) {
+  region_acc_type * acc = util_malloc( sizeof * acc );
+  const int size = util_int_max( 1 , num_regions * num_kw );
+  int i;
+
+  acc->num_regions  = num_regions;
+  acc->num_kw       = num_kw;
+  acc->count        = util_calloc( util_int_max( 1 , num_regions ) , sizeof * acc->count );
+  acc->weight       = util_calloc( util_int_max( 1 , num_regions ) , sizeof * acc->weight );
+  acc->sum          = util_calloc( size , sizeof * acc->sum );
+  acc->weighted_sum = util_calloc( size , sizeof * acc->weighted_sum );
+  acc->min          = util_calloc( size , sizeof * acc->min );
+  acc->max          = util_calloc( size , sizeof * acc->max );
+
+  for (i = 0; i < num_regions; i++) {
+    acc->count[i]  = 0;
+    acc->weight[i] = 0;
+  }
+
+  for (i = 0; i < num_regions * num_kw; i++) {
+    acc->sum[i]          = 0;
+    acc->weighted_sum[i] = 0;
+    acc->min[i]          = HUGE_VAL;
+    acc->max[i]          = -HUGE_VAL;
+  }
+  return acc;
+}
+
+
+static void region_acc_free( region_acc_type * acc ) {
+  free( acc->count );
+  free( acc->weight );
+  free( acc->sum );
+  free( acc->weighted_sum );
+  free( acc->min );
+  free( acc->max );
+  free( acc );
+}
+
+
+static void region_acc_merge( region_acc_type * acc , const region_acc_type * other ) {
+  int i;
+  for (i = 0; i < acc->num_regions; i++) {
+    acc->count[i]  += other->count[i];
+    acc->weight[i] += other->weight[i];
+  }
+
+  for (i = 0; i < acc->num_regions * acc->num_kw; i++) {
+    acc->sum[i]          += other->sum[i];
+    acc->weighted_sum[i] += other->weighted_sum[i];
+    acc->min[i]           = util_double_min( acc->min[i] , other->min[i] );
+    acc->max[i]           = util_double_max( acc->max[i] , other->max[i] );
+  }
+}
+
+
+/*****************************************************************/
+
+static bool ecl_region_stat_global_kw( const ecl_region_stat_type * region_stat , const ecl_kw_type * ecl_kw) {
+  return (ecl_kw_get_size( ecl_kw ) != ecl_grid_get_active_size( region_stat->grid ));
+}
+
+
+static void ecl_region_stat_assert_kw( const ecl_region_stat_type * region_stat , const ecl_kw_type * ecl_kw) {
+  const int kw_size = ecl_kw_get_size( ecl_kw );
+  const ecl_type_enum ecl_type = ecl_kw_get_type( ecl_kw );
+
+  if (!(kw_size == ecl_grid_get_active_size( region_stat->grid ) || kw_size == ecl_grid_get_global_size( region_stat->grid )))
+    util_abort("%s: size mismatch between keyword:%s and grid \n",__func__ , ecl_kw_get_header( ecl_kw ));
+
+  if (!(ecl_type == ECL_FLOAT_TYPE || ecl_type == ECL_DOUBLE_TYPE || ecl_type == ECL_INT_TYPE))
+    util_abort("%s: keyword:%s - only types FLOAT, DOUBLE and INT supported \n",__func__ , ecl_kw_get_header( ecl_kw ));
+}
+
+
+/*
+  Fetches the values of @ecl_kw for a block of cells as double.
+*/
+
+static void ecl_region_stat_gather( const ecl_region_stat_type * region_stat , const ecl_kw_type * ecl_kw , int size ,
+                                    const int * active_index , const int * global_index , double * value) {
+  const int * index = ecl_region_stat_global_kw( region_stat , ecl_kw ) ? global_index : active_index;
+  int i;
+
+  switch (ecl_kw_get_type( ecl_kw )) {
+  case(ECL_FLOAT_TYPE):
+    {
+      const float * data = ecl_kw_get_float_ptr( ecl_kw );
+      for (i = 0; i < size; i++)
+        value[i] = data[ index[i] ];
+    }
+    break;
+  case(ECL_DOUBLE_TYPE):
+    {
+      const double * data = ecl_kw_get_double_ptr( ecl_kw );
+      for (i = 0; i < size; i++)
+        value[i] = data[ index[i] ];
+    }
+    break;
+  case(ECL_INT_TYPE):
+    {
+      const int * data = ecl_kw_get_int_ptr( ecl_kw );
+      for (i = 0; i < size; i++)
+        value[i] = data[ index[i] ];
+    }
+    break;
+  default:
+    util_abort("%s: unsupported type \n",__func__);
+  }
+}
+
+
+/*
+  Adds a block of cells to the accumulator; cells with a negative
+  region number are ignored.
+*/
+
+static void ecl_region_stat_add_block( const ecl_region_stat_type * region_stat , region_acc_type * acc , int size ,
+                                       const int * active_index , const int * global_index , const int * region_nr) {
+  double weight[ECL_REGION_STAT_BLOCK_SIZE];
+  double value[ECL_REGION_STAT_BLOCK_SIZE];
+  const int num_kw = acc->num_kw;
+  int i , kw_nr;
+
+  if (region_stat->weight_kw != NULL)
+    ecl_region_stat_gather( region_stat , region_stat->weight_kw , size , active_index , global_index , weight );
+  else {
+    for (i = 0; i < size; i++)
+      weight[i] = 1;
+  }
+
+  for (i = 0; i < size; i++) {
+    if (region_nr[i] >= 0) {
+      acc->count[ region_nr[i] ]++;
+      acc->weight[ region_nr[i] ] += weight[i];
+    }
+  }
+
+  for (kw_nr = 0; kw_nr < num_kw; kw_nr++) {
+    const ecl_kw_type * ecl_kw = vector_iget_const( region_stat->kw_list , kw_nr );
+    ecl_region_stat_gather( region_stat , ecl_kw , size , active_index , global_index , value );
+    for (i = 0; i < size; i++) {
+      if (region_nr[i] >= 0) {
+        const int index = region_nr[i] * num_kw + kw_nr;
+        acc->sum[ index ]          += value[i];
+        acc->weighted_sum[ index ] += weight[i] * value[i];
+        if (value[i] < acc->min[ index ])
+          acc->min[ index ] = value[i];
+        if (value[i] > acc->max[ index ])
+          acc->max[ index ] = value[i];
+      }
+    }
+  }
+}
+
+
+static void ecl_region_stat_eval_job( region_stat_job_type * job ) {
+  const ecl_region_stat_type * region_stat = job->region_stat;
+  int active_index[ECL_REGION_STAT_BLOCK_SIZE];
+  int global_index[ECL_REGION_STAT_BLOCK_SIZE];
+  int region_nr[ECL_REGION_STAT_BLOCK_SIZE];
+  int i;
+
+  if (job->region_kw != NULL) {
+    const int * inv_index_map = ecl_grid_get_inv_index_map_ptr( region_stat->grid );
+    const int * region_data = ecl_kw_get_int_ptr( job->region_kw );
+    const bool global_region_kw = ecl_region_stat_global_kw( region_stat , job->region_kw );
+    int offset;
+
+    for (offset = job->offset1; offset < job->offset2; offset += ECL_REGION_STAT_BLOCK_SIZE) {
+      const int size = util_int_min( ECL_REGION_STAT_BLOCK_SIZE , job->offset2 - offset );
+      for (i = 0; i < size; i++) {
+        active_index[i] = offset + i;
+        global_index[i] = inv_index_map[ offset + i ];
+        region_nr[i]    = global_region_kw ? region_data[ global_index[i] ] : region_data[ active_index[i] ];
+      }
+      ecl_region_stat_add_block( region_stat , job->acc , size , active_index , global_index , region_nr );
+    }
+  } else {
+    int list_nr;
+    for (list_nr = job->offset1; list_nr < job->offset2; list_nr++) {
+      ecl_region_type * region = vector_iget( job->region_list , list_nr );
+      const int_vector_type * active_list = ecl_region_get_active_list( region );
+      const int_vector_type * global_list = ecl_region_get_global_active_list( region );
+      const int * active_ptr = int_vector_get_const_ptr( active_list );
+      const int * global_ptr = int_vector_get_const_ptr( global_list );
+      const int region_size  = int_vector_size( active_list );
+      int offset;
+
+      for (i = 0; i < ECL_REGION_STAT_BLOCK_SIZE; i++)
+        region_nr[i] = list_nr;
+
+      for (offset = 0; offset < region_size; offset += ECL_REGION_STAT_BLOCK_SIZE) {
+        const int size = util_int_min( ECL_REGION_STAT_BLOCK_SIZE , region_size - offset );
+        ecl_region_stat_add_block( region_stat , job->acc , size , &active_ptr[ offset ] , &global_ptr[ offset ] , region_nr );
+      }
+    }
+  }
+}
+
+
+static void * ecl_region_stat_eval_job__( void * arg ) {
+  ecl_region_stat_eval_job( arg );
+  return NULL;
+}
+
+
+/*
+  Runs the evaluation split in @num_jobs jobs over the range [0,
+  @size) of active cells or regions, and stores the combined result
+  in region_stat->acc.
+*/
+
+static void ecl_region_stat_eval( ecl_region_stat_type * region_stat , const ecl_kw_type * region_kw , vector_type * region_list , int num_regions , int size) {
+  const int num_kw = vector_get_size( region_stat->kw_list );
+  int num_jobs = 1;
+
+#ifdef WITH_PTHREAD
+  {
+    double work = 1.0 * ecl_grid_get_active_size( region_stat->grid ) * (num_kw + 1);
+    if (work >= ECL_REGION_STAT_MT_MIN_WORK)
+      num_jobs = util_int_max( 1 , util_int_min( size , sysconf( _SC_NPROCESSORS_ONLN )));
+  }
+#endif
+
+  if (region_stat->acc != NULL)
+    region_acc_free( region_stat->acc );
+  region_stat->acc = region_acc_alloc( num_regions , num_kw );
+
+  {
+    region_stat_job_type * job_list = util_calloc( num_jobs , sizeof * job_list );
+    int job_nr;
+
+    for (job_nr = 0; job_nr < num_jobs; job_nr++) {
+      region_stat_job_type * job = &job_list[ job_nr ];
+      job->region_stat = region_stat;
+      job->acc         = (job_nr == 0) ? region_stat->acc : region_acc_alloc( num_regions , num_kw );
+      job->region_kw   = region_kw;
+      job->region_list = region_list;
+      job->offset1     = (int) ((1.0 * job_nr * size) / num_jobs);
+      job->offset2     = (int) ((1.0 * (job_nr + 1) * size) / num_jobs);
+    }
+
+    if (num_jobs == 1)
+      ecl_region_stat_eval_job( &job_list[0] );
+#ifdef WITH_PTHREAD
+    else {
+      thread_pool_type * tp = thread_pool_alloc( num_jobs , true );
+      for (job_nr = 0; job_nr < num_jobs; job_nr++)
+        thread_pool_add_job( tp , ecl_region_stat_eval_job__ , &job_list[ job_nr ] );
+      thread_pool_join( tp );
+      thread_pool_free( tp );
+    }
+#endif
+
+    for (job_nr = 1; job_nr < num_jobs; job_nr++) {
+      region_acc_merge( region_stat->acc , job_list[ job_nr ].acc );
+      region_acc_free( job_list[ job_nr ].acc );
+    }
+    free( job_list );
+  }
+}
+
+
+/*****************************************************************/
+
+UTIL_IS_INSTANCE_FUNCTION( ecl_region_stat , ECL_REGION_STAT_TYPE_ID )
+
+
+ecl_region_stat_type * ecl_region_stat_alloc( const ecl_grid_type * grid , const ecl_kw_type * weight_kw ) {
+  ecl_region_stat_type * region_stat = util_malloc( sizeof * region_stat );
+  UTIL_TYPE_ID_INIT( region_stat , ECL_REGION_STAT_TYPE_ID );
+  region_stat->grid      = grid;
+  region_stat->weight_kw = weight_kw;
+  region_stat->kw_list   = vector_alloc_new();
+  region_stat->acc       = NULL;
+
+  if (weight_kw != NULL)
+    ecl_region_stat_assert_kw( region_stat , weight_kw );
+
+  return region_stat;
+}
+
+
+void ecl_region_stat_free( ecl_region_stat_type * region_stat ) {
+  if (region_stat->acc != NULL)
+    region_acc_free( region_stat->acc );
+  vector_free( region_stat->kw_list );
+  free( region_stat );
+}
+
+
+void ecl_region_stat_add_kw( ecl_region_stat_type * region_stat , const ecl_kw_type * ecl_kw ) {
+  ecl_region_stat_assert_kw( region_stat , ecl_kw );
+  vector_append_ref( region_stat->kw_list , ecl_kw );
+}
+
+
+int ecl_region_stat_get_num_kw( const ecl_region_stat_type * region_stat ) {
+  return vector_get_size( region_stat->kw_list );
+}
+
+
+int ecl_region_stat_get_num_regions( const ecl_region_stat_type * region_stat ) {
+  if (region_stat->acc == NULL)
+    return 0;
+  else
+    return region_stat->acc->num_regions;
+}
+
+
+/**
+   Will evaluate the statistics for all the regions in the integer
+   keyword @region_kw, e.g. FIPNUM; the results for the cells with
+   value N in @region_kw are found with region_nr == N. The number of
+   regions is one more than the largest value in @region_kw, cells
+   with negative values are ignored.
+*/
+
+void ecl_region_stat_eval_region_kw( ecl_region_stat_type * region_stat , const ecl_kw_type * region_kw ) {
+  ecl_region_stat_assert_kw( region_stat , region_kw );
+  if (ecl_kw_get_type( region_kw ) != ECL_INT_TYPE)
+    util_abort("%s: the region keyword:%s must be of integer type \n",__func__ , ecl_kw_get_header( region_kw ));
+
+  {
+    const int active_size = ecl_grid_get_active_size( region_stat->grid );
+    const int * region_data = ecl_kw_get_int_ptr( region_kw );
+    int max_region = -1;
+
+    if (ecl_region_stat_global_kw( region_stat , region_kw )) {
+      const int * inv_index_map = ecl_grid_get_inv_index_map_ptr( region_stat->grid );
+      int active_index;
+      for (active_index = 0; active_index < active_size; active_index++)
+        max_region = util_int_max( max_region , region_data[ inv_index_map[ active_index ]] );
+    } else {
+      int active_index;
+      for (active_index = 0; active_index < active_size; active_index++)
+        max_region = util_int_max( max_region , region_data[ active_index ] );
+    }
+
+    ecl_region_stat_eval( region_stat , region_kw , NULL , max_region + 1 , active_size );
+  }
+}
+
+
+/**
+   Will evaluate the statistics for the ecl_region instances in
+   @region_list; the results for region number i in the list are
+   found with region_nr == i. The regions may overlap.
+*/
+
+void ecl_region_stat_eval_region_list( ecl_region_stat_type * region_stat , vector_type * region_list ) {
+  const int num_regions = vector_get_size( region_list );
+  int list_nr;
+
+  /* The index lists are created up front, the regions are only read during the threaded evaluation. */
+  for (list_nr = 0; list_nr < num_regions; list_nr++) {
+    ecl_region_type * region = vector_iget( region_list , list_nr );
+    ecl_region_get_active_list( region );
+    ecl_region_get_global_active_list( region );
+  }
+
+  ecl_region_stat_eval( region_stat , NULL , region_list , num_regions , num_regions );
+}
+
+
+/*****************************************************************/
+
+static void ecl_region_stat_assert_region( const ecl_region_stat_type * region_stat , int region_nr ) {
+  const region_acc_type * acc = region_stat->acc;
+  if (acc == NULL)
+    util_abort("%s: must call one of the ecl_region_stat_eval_xxx() functions first \n",__func__);
+
+  if ((region_nr < 0) || (region_nr >= acc->num_regions))
+    util_abort("%s: region_nr:%d invalid - legal interval: [0,%d) \n",__func__ , region_nr , acc->num_regions);
+}
+
+
+static int ecl_region_stat_get_index( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  const region_acc_type * acc = region_stat->acc;
+  ecl_region_stat_assert_region( region_stat , region_nr );
+
+  if ((kw_nr < 0) || (kw_nr >= acc->num_kw))
+    util_abort("%s: kw_nr:%d invalid - legal interval: [0,%d) \n",__func__ , kw_nr , acc->num_kw);
+
+  return region_nr * acc->num_kw + kw_nr;
+}
+
+
+int ecl_region_stat_get_count( const ecl_region_stat_type * region_stat , int region_nr ) {
+  ecl_region_stat_assert_region( region_stat , region_nr );
+  return region_stat->acc->count[ region_nr ];
+}
+
+
+/**
+   The sum of the weights in the region; with no weight keyword this
+   is the number of cells.
+*/
+
+double ecl_region_stat_get_weight( const ecl_region_stat_type * region_stat , int region_nr ) {
+  ecl_region_stat_assert_region( region_stat , region_nr );
+  return region_stat->acc->weight[ region_nr ];
+}
+
+
+double ecl_region_stat_get_sum( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  int index = ecl_region_stat_get_index( region_stat , region_nr , kw_nr );
+  return region_stat->acc->sum[ index ];
+}
+
+
+double ecl_region_stat_get_mean( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  int index = ecl_region_stat_get_index( region_stat , region_nr , kw_nr );
+  if (region_stat->acc->count[ region_nr ] == 0)
+    return 0;
+  else
+    return region_stat->acc->sum[ index ] / region_stat->acc->count[ region_nr ];
+}
+
+
+double ecl_region_stat_get_weighted_mean( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  int index = ecl_region_stat_get_index( region_stat , region_nr , kw_nr );
+  if (region_stat->acc->weight[ region_nr ] == 0)
+    return 0;
+  else
+    return region_stat->acc->weighted_sum[ index ] / region_stat->acc->weight[ region_nr ];
+}
+
+
+double ecl_region_stat_get_min( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  int index = ecl_region_stat_get_index( region_stat , region_nr , kw_nr );
+  if (region_stat->acc->count[ region_nr ] == 0)
+    return 0;
+  else
+    return region_stat->acc->min[ index ];
+}
+
+
+double ecl_region_stat_get_max( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr ) {
+  int index = ecl_region_stat_get_index( region_stat , region_nr , kw_nr );
+  if (region_stat->acc->count[ region_nr ] == 0)
+    return 0;
+  else
+    return region_stat->acc->max[ index ];
+}
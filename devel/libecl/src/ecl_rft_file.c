@@ -25,6 +25,10 @@
 #include <fnmatch.h>
 #endif
 
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#endif
+
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/vector.h>
@@ -47,6 +51,22 @@
    All of this is just lumped together in one long vector, both in the
    file, and in this implementation. The data for one specific RFT
    (one well, one time) is internalized in the ecl_rft_node type.   
+
+   When the file is opened only the WELLETC, DATE and TIME keywords
+   of each block are read, and the ecl_rft_node instances are
+   allocated with header information only. The cell data of a node is
+   loaded from the file the first time the node is returned from one
+   of the ecl_rft_file_xxx() functions; the underlying ecl_file is
+   therefor kept until ecl_rft_file_free() is called. The keywords of
+   the block are unloaded from the ecl_file again when the cells have
+   been copied into the node, and the ecl_file is opened with
+   ECL_FILE_CLOSE_STREAM, so the file descriptor is only held while
+   cells are loaded.
+
+   The node lookup functions take a const ecl_rft_file instance, but
+   the lazy load modifies the node and selects blocks in the shared
+   ecl_file; this is serialized with the load_lock mutex, so the
+   lookup functions can be called concurrently from several threads.
 */
    
 
@@ -56,8 +76,14 @@
 struct ecl_rft_file_struct {
   UTIL_TYPE_ID_DECLARATION;
   char        * filename;
-  vector_type * data;          /* This vector just contains all the rft nodes in one long vector. */
-  hash_type   * well_index;    /* This indexes well names into the data vector - very similar to the scheme used in ecl_file. */
+  ecl_file_type   * ecl_file;  /* Kept to load the cells of the nodes on demand. */
+  vector_type     * data;      /* This vector just contains all the rft nodes in one long vector. */
+  int_vector_type * block_nr;  /* The TIME block in ecl_file of each node in the data vector. */
+  hash_type       * well_index;/* This indexes well names into the data vector - very similar to the scheme used in ecl_file. */
+  hash_type       * time_index;/* This indexes "WELL:time" into the data vector. */
+#ifdef WITH_PTHREAD
+  pthread_mutex_t   load_lock; /* Serializes the lazy load of the cells in ecl_rft_file_iget_node(). */
+#endif
 };
 
 
@@ -65,9 +91,15 @@ struct ecl_rft_file_struct {
 static ecl_rft_file_type * ecl_rft_file_alloc_empty(const char * filename) {
   ecl_rft_file_type * rft_vector = util_malloc(sizeof * rft_vector );
   UTIL_TYPE_ID_INIT( rft_vector , ECL_RFT_FILE_ID );
+  rft_vector->ecl_file   = NULL;
   rft_vector->data       = vector_alloc_new();
+  rft_vector->block_nr   = int_vector_alloc( 0 , 0 );
   rft_vector->filename   = util_alloc_string_copy(filename);
   rft_vector->well_index = hash_alloc();
+  rft_vector->time_index = hash_alloc();
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &rft_vector->load_lock , NULL );
+#endif
   return rft_vector;
 }
 
@@ -82,38 +114,70 @@ UTIL_SAFE_CAST_FUNCTION( ecl_rft_file , ECL_RFT_FILE_ID );
 UTIL_IS_INSTANCE_FUNCTION( ecl_rft_file , ECL_RFT_FILE_ID );
 
 
-static void ecl_rft_file_add_node(ecl_rft_file_type * rft_vector , const ecl_rft_node_type * rft_node) {
-  vector_append_owned_ref( rft_vector->data , rft_node , ecl_rft_node_free__);
+static char * ecl_rft_file_alloc_time_key( const char * well , time_t recording_time ) {
+  return util_alloc_sprintf("%s:%ld" , well , (long) recording_time );
 }
 
 
+static void ecl_rft_file_add_node(ecl_rft_file_type * rft_vector , ecl_rft_node_type * rft_node , int block_nr) {
+  const char * well_name = ecl_rft_node_get_well_name( rft_node );
+  int global_index = vector_get_size( rft_vector->data );
+  
+  vector_append_owned_ref( rft_vector->data , rft_node , ecl_rft_node_free__);
+  int_vector_append( rft_vector->block_nr , block_nr );
+  
+  if (!hash_has_key( rft_vector->well_index , well_name)) 
+    hash_insert_hash_owned_ref( rft_vector->well_index , well_name , int_vector_alloc( 0 , 0 ) , int_vector_free__);
+  {
+    int_vector_type * index_list = hash_get( rft_vector->well_index , well_name );
+    int_vector_append(index_list , global_index);
+  }
 
+  /* Only the first occurence of a (well,time) pair is indexed. */
+  {
+    char * key = ecl_rft_file_alloc_time_key( well_name , ecl_rft_node_get_date( rft_node ));
+    if (!hash_has_key( rft_vector->time_index , key ))
+      hash_insert_int( rft_vector->time_index , key , global_index );
+    free( key );
+  }
+}
+
+
+/**
+   Each block in the RFT file starts with a TIME keyword, and contains
+   exactly one DATE and one WELLETC keyword; when the number of these
+   keywords agree the header keywords can be read directly from the
+   global map without selecting the blocks one by one.
+*/
 
 ecl_rft_file_type * ecl_rft_file_alloc(const char * filename) {
   ecl_rft_file_type * rft_vector = ecl_rft_file_alloc_empty( filename );
-  ecl_file_type * ecl_file       = ecl_file_open( filename , 0);
-  int global_index = 0;
-  int block_nr = 0;
+  ecl_file_type * ecl_file       = ecl_file_open( filename , ECL_FILE_CLOSE_STREAM );
+  int num_blocks = ecl_file_get_num_named_kw( ecl_file , TIME_KW );
+  bool global_header = ((ecl_file_get_num_named_kw( ecl_file , DATE_KW ) == num_blocks) &&
+                        (ecl_file_get_num_named_kw( ecl_file , WELLETC_KW ) == num_blocks));
+  int block_nr;
   
-  while (true) {
-    if (ecl_file_select_block( ecl_file , TIME_KW , block_nr)) {
-      ecl_rft_node_type * rft_node = ecl_rft_node_alloc( ecl_file );
-      if (rft_node != NULL) { 
-        const char * well_name = ecl_rft_node_get_well_name( rft_node );
-        ecl_rft_file_add_node(rft_vector , rft_node);
-        if (!hash_has_key( rft_vector->well_index , well_name)) 
-          hash_insert_hash_owned_ref( rft_vector->well_index , well_name , int_vector_alloc( 0 , 0 ) , int_vector_free__);
-        {
-          int_vector_type * index_list = hash_get( rft_vector->well_index , well_name );
-          int_vector_append(index_list , global_index);
-        }         
-        global_index++;
-      } 
-    } else
-      break;
-    block_nr++;
+  rft_vector->ecl_file = ecl_file;
+  for (block_nr = 0; block_nr < num_blocks; block_nr++) {
+    ecl_rft_node_type * rft_node;
+    
+    if (global_header)
+      rft_node = ecl_rft_node_alloc_header( ecl_file_iget_named_kw( ecl_file , WELLETC_KW , block_nr ) ,
+                                            ecl_file_iget_named_kw( ecl_file , DATE_KW    , block_nr ) ,
+                                            ecl_file_iget_named_kw( ecl_file , TIME_KW    , block_nr ));
+    else {
+      ecl_file_select_block( ecl_file , TIME_KW , block_nr );
+      rft_node = ecl_rft_node_alloc_header( ecl_file_iget_named_kw( ecl_file , WELLETC_KW , 0 ) ,
+                                            ecl_file_iget_named_kw( ecl_file , DATE_KW    , 0 ) ,
+                                            ecl_file_iget_named_kw( ecl_file , TIME_KW    , 0 ));
+      ecl_file_unload_active( ecl_file );
+      ecl_file_select_global( ecl_file );
+    }
+    
+    if (rft_node != NULL) 
+      ecl_rft_file_add_node( rft_vector , rft_node , block_nr );
   } 
-  ecl_file_close( ecl_file );
   return rft_vector;
 }
 
@@ -191,7 +255,13 @@ bool ecl_rft_file_case_has_rft( const char * case_input ) {
 
 void ecl_rft_file_free(ecl_rft_file_type * rft_vector) {
   vector_free(rft_vector->data);
+  int_vector_free( rft_vector->block_nr );
   hash_free( rft_vector->well_index );
+  hash_free( rft_vector->time_index );
+  ecl_file_close( rft_vector->ecl_file );
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &rft_vector->load_lock );
+#endif
   free(rft_vector->filename);
   free(rft_vector);
 }
@@ -270,7 +340,22 @@ const char * ecl_rft_file_get_filename( const ecl_rft_file_type * rft_file ) {
 */
 
 ecl_rft_node_type * ecl_rft_file_iget_node( const ecl_rft_file_type * rft_file , int index) {
-  return vector_iget( rft_file->data , index );
+  ecl_rft_node_type * rft_node = vector_iget( rft_file->data , index );
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( (pthread_mutex_t *) &rft_file->load_lock );
+#endif
+  if (!ecl_rft_node_cells_loaded( rft_node )) {
+    ecl_file_type * ecl_file = rft_file->ecl_file;
+    
+    ecl_file_select_block( ecl_file , TIME_KW , int_vector_iget( rft_file->block_nr , index ));
+    ecl_rft_node_load_cells( rft_node , ecl_file );
+    ecl_file_unload_active( ecl_file );    /* The cells have been copied into the node. */
+    ecl_file_select_global( ecl_file );
+  }
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( (pthread_mutex_t *) &rft_file->load_lock );
+#endif
+  return rft_node;
 }
 
 
@@ -316,25 +401,93 @@ ecl_rft_node_type * ecl_rft_file_iget_well_rft( const ecl_rft_file_type * rft_fi
 
 
 ecl_rft_node_type * ecl_rft_file_get_well_time_rft( const ecl_rft_file_type * rft_file , const char * well , time_t recording_time) {
-  ecl_rft_node_type * node = NULL;
-  if (hash_has_key( rft_file->well_index , well)) {
-    const int_vector_type * index_vector = hash_get(rft_file->well_index , well);
-    int index = 0;
-    while (true) {
-      if (index == int_vector_size( index_vector ))
-        break;
+  int index = ecl_rft_file_get_well_time_index( rft_file , well , recording_time );
+  if (index >= 0)
+    return ecl_rft_file_iget_node( rft_file , index );
+  else
+    return NULL;
+}
+
+
+/**
+   Returns the index in the file of the rft for well 'well' at time
+   'recording_time', or -1 if there is no such rft. The cells of the
+   node are not loaded.
+*/
+
+int ecl_rft_file_get_well_time_index( const ecl_rft_file_type * rft_file , const char * well , time_t recording_time) {
+  int index = -1;
+  char * key = ecl_rft_file_alloc_time_key( well , recording_time );
+  if (hash_has_key( rft_file->time_index , key ))
+    index = hash_get_int( rft_file->time_index , key );
+  free( key );
+  return index;
+}
+
+
+/**
+   Will look up the rft cells at @num_points (well,time,i,j,k) points
+   in one call; the i,j,k coordinates are offset zero. The results are
+   written to the @pressure, @swat and @sgas arrays, any of which can
+   be NULL. Points where the (well,time) rft or the connection can not
+   be found will have @found[] == false and output values 0; @found
+   can also be NULL. The saturations are only available for RFT
+   nodes, for PLT nodes the @swat and @sgas values are set to 0.
+
+   Consecutive points from the same (well,time) only look up the rft
+   node once, so the points should preferably be grouped by well and
+   time. Returns the number of points found.
+*/
+
+int ecl_rft_file_lookup_cells( const ecl_rft_file_type * rft_file , int num_points , const char ** well_list , const time_t * time_list , 
+                               const int * i , const int * j , const int * k , 
+                               double * pressure , double * swat , double * sgas , bool * found) {
+  const ecl_rft_node_type * rft_node = NULL;
+  const char * current_well = NULL;
+  time_t current_time = -1;
+  int num_found = 0;
+  int point;
+
+  for (point = 0; point < num_points; point++) {
+    const ecl_rft_cell_type * cell = NULL;
+
+    if ((current_well == NULL) || (current_time != time_list[point]) || (strcmp( current_well , well_list[point] ) != 0)) {
+      current_well = well_list[point];
+      current_time = time_list[point];
+      rft_node = ecl_rft_file_get_well_time_rft( rft_file , current_well , current_time );
+    }
+
+    if (rft_node != NULL) 
+      cell = ecl_rft_node_lookup_ijk( rft_node , i[point] , j[point] , k[point] );
+
+    if (cell != NULL) {
+      bool is_RFT = ecl_rft_node_is_RFT( rft_node );
       
-      node = ecl_rft_file_iget_node( rft_file , int_vector_iget( index_vector , index ));
-      if (ecl_rft_node_get_date( node ) == recording_time) 
-        break;
-      else {
-        node = NULL;
-        index++;
-      }
+      if (pressure)
+        pressure[point] = ecl_rft_cell_get_pressure( cell );
+
+      if (swat)
+        swat[point] = is_RFT ? ecl_rft_cell_get_swat( cell ) : 0;
+
+      if (sgas)
+        sgas[point] = is_RFT ? ecl_rft_cell_get_sgas( cell ) : 0;
       
+      num_found++;
+    } else {
+      if (pressure)
+        pressure[point] = 0;
+
+      if (swat)
+        swat[point] = 0;
+
+      if (sgas)
+        sgas[point] = 0;
     }
+
+    if (found)
+      found[point] = (cell != NULL);
   }
-  return node;
+  return num_found;
 }
 
 
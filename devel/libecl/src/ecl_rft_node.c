@@ -60,6 +60,7 @@ struct ecl_rft_node_struct {
   time_t       recording_date;         /* When was the RFT recorded - date.*/ 
   double       days;                   /* When was the RFT recorded - days after simulaton start. */
   bool         MSW;
+  bool         cells_loaded;           /* False until ecl_rft_node_load_cells() has been called. */
   
   bool              sort_perm_in_sync            ;   
   int_vector_type * sort_perm;
@@ -101,6 +102,8 @@ static ecl_rft_node_type * ecl_rft_node_alloc_empty(const char * data_type_strin
     rft_node->data_type = data_type;
     rft_node->sort_perm = NULL;
     rft_node->sort_perm_in_sync = false;
+    rft_node->cells_loaded = false;
+    rft_node->MSW = false;
     
     return rft_node;
   }
@@ -214,27 +217,63 @@ static void ecl_rft_node_init_cells( ecl_rft_node_type * rft_node , const ecl_fi
 }
 
 
-ecl_rft_node_type * ecl_rft_node_alloc(const ecl_file_type * rft) {
-  ecl_kw_type       * welletc   = ecl_file_iget_named_kw(rft , WELLETC_KW , 0);
+/**
+   Will allocate a rft node with the header information, i.e. well
+   name, data type and recording time; the cell data is not loaded
+   before ecl_rft_node_load_cells() is called. This makes it possible
+   to index a large RFT file by only reading the small WELLETC, DATE
+   and TIME keywords of each block. Will return NULL for SEGMENT data.
+*/
+
+ecl_rft_node_type * ecl_rft_node_alloc_header(const ecl_kw_type * welletc , const ecl_kw_type * date_kw , const ecl_kw_type * time_kw) {
   ecl_rft_node_type * rft_node  = ecl_rft_node_alloc_empty(ecl_kw_iget_ptr(welletc , WELLETC_TYPE_INDEX));
   
   if (rft_node != NULL) {
-    ecl_kw_type * date_kw = ecl_file_iget_named_kw( rft , DATE_KW    , 0);
     rft_node->well_name = util_alloc_strip_copy( ecl_kw_iget_ptr(welletc , WELLETC_NAME_INDEX));
     
     /* Time information. */
     {
-      int * time = ecl_kw_get_int_ptr( date_kw );
+      const int * time = ecl_kw_get_int_ptr( date_kw );
       rft_node->recording_date = ecl_util_make_date( time[DATE_DAY_INDEX] , time[DATE_MONTH_INDEX] , time[DATE_YEAR_INDEX] );
     }
-    rft_node->days = ecl_kw_iget_float( ecl_file_iget_named_kw( rft , TIME_KW , 0 ) , 0);
+    rft_node->days = ecl_kw_iget_float( time_kw , 0);
+  }
+  return rft_node;
+}
+
+
+/**
+   Will load the cells of the rft node from the currently selected
+   block of the ecl_file; the block must be the same block the header
+   was read from. Calling the function on a node which already has
+   loaded the cells is a no-op.
+*/
+
+void ecl_rft_node_load_cells( ecl_rft_node_type * rft_node , const ecl_file_type * rft) {
+  if (!rft_node->cells_loaded) {
     if (ecl_file_has_kw( rft , CONLENST_KW))
       rft_node->MSW = true;
     else
       rft_node->MSW = false;
-
+    
     ecl_rft_node_init_cells( rft_node , rft );
+    rft_node->cells_loaded = true;
   }
+}
+
+
+bool ecl_rft_node_cells_loaded( const ecl_rft_node_type * rft_node ) {
+  return rft_node->cells_loaded;
+}
+
+
+ecl_rft_node_type * ecl_rft_node_alloc(const ecl_file_type * rft) {
+  ecl_rft_node_type * rft_node  = ecl_rft_node_alloc_header( ecl_file_iget_named_kw( rft , WELLETC_KW , 0 ) ,
+                                                             ecl_file_iget_named_kw( rft , DATE_KW    , 0 ) ,
+                                                             ecl_file_iget_named_kw( rft , TIME_KW    , 0 ));
+  if (rft_node != NULL) 
+    ecl_rft_node_load_cells( rft_node , rft );
+  
   return rft_node;
 }
 
@@ -323,18 +362,15 @@ void ecl_rft_node_iget_ijk( const ecl_rft_node_type * rft_node , int index , int
 
 
 const ecl_rft_cell_type * ecl_rft_node_lookup_ijk( const ecl_rft_node_type * rft_node , int i, int j , int k) { 
-  int index = 0; 
   int size = ecl_rft_node_get_size( rft_node );
-  while (true) {
+  int index;
+  for (index = 0; index < size; index++) {
     const ecl_rft_cell_type * cell = ecl_rft_node_iget_cell( rft_node , index );
     
     if (ecl_rft_cell_ijk_equal( cell , i , j , k ))
       return cell;
-    
-    index++;
-    if (index == size)                             /* Could not find it. */
-      return NULL;
   }
+  return NULL;                                     /* Could not find it. */
 }
 
 
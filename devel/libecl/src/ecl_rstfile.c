@@ -143,9 +143,265 @@ we have introduced the following concepts:
 */
 
 
+/*
+  The restart block index
+  =======================
+
+  To avoid scanning through, and loading, all the SEQNUM and INTEHEAD
+  keywords every time a block is looked up, each file_map has a
+  rst_index with one element for each SEQNUM block in the map:
+
+      (report_step , sim_time , sim_days , seqnum_index , intehead_index)
+
+  where sim_time is taken from the first INTEHEAD keyword in the
+  block, sim_days from the first DOUBHEAD keyword, and seqnum_index
+  and intehead_index are the occurence numbers of the SEQNUM keyword
+  and the first INTEHEAD keyword in the map respectively. The blocks
+  are also sorted on report_step and sim_time, so that lookup is a
+  binary search; when several blocks have the same report step or
+  simulation time the first of them is found.
+
+  The index is created with one pass through the map the first time
+  it is needed, and for the global map it is also stored in the index
+  file when the ECL_FILE_USE_INDEX flag is set. The time_t value
+  depends on the time zone of the process, so the index file stores
+  the day, month and year from INTEHEAD, and sim_time is recomputed
+  when the index file is loaded.
+*/
+
+typedef struct {
+  int     report_step;
+  int     day;              /* The date fields from INTEHEAD; 0 if the block does not have an INTEHEAD keyword. */
+  int     month;
+  int     year;
+  time_t  sim_time;         /* -1 if the block does not have an INTEHEAD keyword. */
+  double  sim_days;         /*  0 if the block does not have a DOUBHEAD keyword. */
+  int     seqnum_index;
+  int     intehead_index;   /* -1 if the block does not have an INTEHEAD keyword. */
+} rst_block_type;
+
+
+struct rst_index_struct {
+  int               size;
+  rst_block_type  * blocks;        /* In file order, i.e. blocks[i].seqnum_index == i. */
+  rst_block_type ** report_order;  /* Sorted on (report_step , seqnum_index). */
+  rst_block_type ** time_order;    /* Sorted on (sim_time , seqnum_index). */
+};
+
+
+
+static int rst_block_cmp_report_step( const void * arg1 , const void * arg2 ) {
+  const rst_block_type * block1 = *((const rst_block_type **) arg1);
+  const rst_block_type * block2 = *((const rst_block_type **) arg2);
+
+  if (block1->report_step != block2->report_step)
+    return (block1->report_step < block2->report_step) ? -1 : 1;
+  else
+    return block1->seqnum_index - block2->seqnum_index;
+}
+
+
+static int rst_block_cmp_sim_time( const void * arg1 , const void * arg2 ) {
+  const rst_block_type * block1 = *((const rst_block_type **) arg1);
+  const rst_block_type * block2 = *((const rst_block_type **) arg2);
+
+  if (block1->sim_time != block2->sim_time)
+    return (block1->sim_time < block2->sim_time) ? -1 : 1;
+  else
+    return block1->seqnum_index - block2->seqnum_index;
+}
+
+
+static rst_index_type * rst_index_alloc( int size ) {
+  rst_index_type * rst_index = util_malloc( sizeof * rst_index );
+  rst_index->size         = size;
+  rst_index->blocks       = util_calloc( util_int_max( size , 1 ) , sizeof * rst_index->blocks );
+  rst_index->report_order = util_calloc( util_int_max( size , 1 ) , sizeof * rst_index->report_order );
+  rst_index->time_order   = util_calloc( util_int_max( size , 1 ) , sizeof * rst_index->time_order );
+  return rst_index;
+}
+
+
+/*
+  Must be called when the blocks have been filled in.
+*/
+
+static void rst_index_sort( rst_index_type * rst_index ) {
+  int i;
+  for (i=0; i < rst_index->size; i++) {
+    rst_index->report_order[i] = &rst_index->blocks[i];
+    rst_index->time_order[i]   = &rst_index->blocks[i];
+  }
+  qsort( rst_index->report_order , rst_index->size , sizeof * rst_index->report_order , rst_block_cmp_report_step );
+  qsort( rst_index->time_order   , rst_index->size , sizeof * rst_index->time_order   , rst_block_cmp_sim_time );
+}
+
+
+static void rst_block_set_date( rst_block_type * block , int day , int month , int year ) {
+  block->day   = day;
+  block->month = month;
+  block->year  = year;
+  if (block->intehead_index >= 0)
+    block->sim_time = ecl_util_make_date( day , month , year );
+  else
+    block->sim_time = -1;
+}
+
+
+static void rst_index_free( rst_index_type * rst_index ) {
+  free( rst_index->blocks );
+  free( rst_index->report_order );
+  free( rst_index->time_order );
+  free( rst_index );
+}
+
+
+static rst_index_type * rst_index_alloc_from_map( const file_map_type * file_map ) {
+  rst_index_type * rst_index = rst_index_alloc( file_map_get_num_named_kw( file_map , SEQNUM_KW ));
+  rst_block_type * block     = NULL;
+  bool doubhead_found        = false;
+  int  seqnum_index          = 0;
+  int  intehead_index        = 0;
+  int  index;
+
+  for (index = 0; index < file_map_get_size( file_map ); index++) {
+    const char * header = file_map_iget_header( file_map , index );
+
+    if (strcmp( header , SEQNUM_KW ) == 0) {
+      block = &rst_index->blocks[seqnum_index];
+      block->report_step    = ecl_kw_iget_int( file_map_iget_kw( file_map , index ) , 0 );
+      block->sim_days       = 0;
+      block->seqnum_index   = seqnum_index;
+      block->intehead_index = -1;
+      rst_block_set_date( block , 0 , 0 , 0 );
+      doubhead_found = false;
+      seqnum_index++;
+    } else if (strcmp( header , INTEHEAD_KW ) == 0) {
+      if ((block != NULL) && (block->intehead_index < 0)) {
+        const ecl_kw_type * intehead_kw = file_map_iget_kw( file_map , index );
+        block->intehead_index = intehead_index;
+        rst_block_set_date( block , 
+                            ecl_kw_iget_int( intehead_kw , INTEHEAD_DAY_INDEX ) , 
+                            ecl_kw_iget_int( intehead_kw , INTEHEAD_MONTH_INDEX ) , 
+                            ecl_kw_iget_int( intehead_kw , INTEHEAD_YEAR_INDEX ));
+      }
+      intehead_index++;
+    } else if (strcmp( header , DOUBHEAD_KW ) == 0) {
+      if ((block != NULL) && !doubhead_found) {
+        block->sim_days = ecl_kw_iget_double( file_map_iget_kw( file_map , index ) , DOUBHEAD_DAYS_INDEX );
+        doubhead_found = true;
+      }
+    }
+  }
+
+  rst_index_sort( rst_index );
+  return rst_index;
+}
+
+
+static void rst_index_buffer_fwrite( const rst_index_type * rst_index , buffer_type * buffer ) {
+  int i;
+  buffer_fwrite_int( buffer , rst_index->size );
+  for (i=0; i < rst_index->size; i++) {
+    const rst_block_type * block = &rst_index->blocks[i];
+    buffer_fwrite_int( buffer , block->report_step );
+    buffer_fwrite_int( buffer , block->day );
+    buffer_fwrite_int( buffer , block->month );
+    buffer_fwrite_int( buffer , block->year );
+    buffer_fwrite_double( buffer , block->sim_days );
+    buffer_fwrite_int( buffer , block->intehead_index );
+  }
+}
+
+
+static rst_index_type * rst_index_buffer_alloc( buffer_type * buffer ) {
+  rst_index_type * rst_index = rst_index_alloc( buffer_fread_int( buffer ));
+  int i;
+  for (i=0; i < rst_index->size; i++) {
+    rst_block_type * block = &rst_index->blocks[i];
+    int day , month , year;
+    block->report_step    = buffer_fread_int( buffer );
+    day                   = buffer_fread_int( buffer );
+    month                 = buffer_fread_int( buffer );
+    year                  = buffer_fread_int( buffer );
+    block->sim_days       = buffer_fread_double( buffer );
+    block->seqnum_index   = i;
+    block->intehead_index = buffer_fread_int( buffer );
+    rst_block_set_date( block , day , month , year );
+  }
+  rst_index_sort( rst_index );
+  return rst_index;
+}
+
+
+static const rst_block_type * rst_index_iget_block( const rst_index_type * rst_index , int seqnum_index ) {
+  if ((seqnum_index >= 0) && (seqnum_index < rst_index->size))
+    return &rst_index->blocks[seqnum_index];
+  else
+    return NULL;
+}
+
+
+/*
+  The two lookup functions find the first element in the sorted list
+  which is >= the key, and then check for equality.
+*/
+
+static const rst_block_type * rst_index_find_report_step( const rst_index_type * rst_index , int report_step ) {
+  int lower = 0;
+  int upper = rst_index->size;
+
+  while (lower < upper) {
+    int mid = (lower + upper) / 2;
+    if (rst_index->report_order[mid]->report_step < report_step)
+      lower = mid + 1;
+    else
+      upper = mid;
+  }
+  
+  if ((lower < rst_index->size) && (rst_index->report_order[lower]->report_step == report_step))
+    return rst_index->report_order[lower];
+  else
+    return NULL;
+}
+
+
+static const rst_block_type * rst_index_find_sim_time( const rst_index_type * rst_index , time_t sim_time ) {
+  int lower = 0;
+  int upper = rst_index->size;
+
+  while (lower < upper) {
+    int mid = (lower + upper) / 2;
+    if (rst_index->time_order[mid]->sim_time < sim_time)
+      lower = mid + 1;
+    else
+      upper = mid;
+  }
+  
+  if ((lower < rst_index->size) && (rst_index->time_order[lower]->sim_time == sim_time))
+    return rst_index->time_order[lower];
+  else
+    return NULL;
+}
+
+
+/*
+  The rst_index is a cache which is created on first use; hence the
+  cast away from const.
+*/
+
+static rst_index_type * file_map_get_rst_index( const file_map_type * file_map ) {
+  if (file_map->rst_index == NULL)
+    ((file_map_type *) file_map)->rst_index = rst_index_alloc_from_map( file_map );
+  return file_map->rst_index;
+}
+
+
+/*****************************************************************/
+
+
 static bool file_map_has_report_step( const file_map_type * file_map , int report_step) {
-  int global_index = file_map_find_kw_value( file_map , SEQNUM_KW , &report_step );
-  if (global_index >= 0)
+  if (rst_index_find_report_step( file_map_get_rst_index( file_map ) , report_step ) != NULL)
     return true;
   else
     return false;
@@ -153,38 +409,36 @@ static bool file_map_has_report_step( const file_map_type * file_map , int repor
 
 
 static time_t file_map_iget_restart_sim_date(const file_map_type * file_map , int seqnum_index) {
-  time_t sim_time = -1;
-  file_map_type * seqnum_map = seqnum_map = file_map_alloc_blockmap( file_map , SEQNUM_KW , seqnum_index);
-
-  if (seqnum_map != NULL) {
-    ecl_kw_type * intehead_kw = file_map_iget_named_kw( seqnum_map , INTEHEAD_KW , 0);
-    sim_time = ecl_rsthead_date( intehead_kw );
-    file_map_free( seqnum_map );
-  } 
-  
-  return sim_time;
+  const rst_block_type * block = rst_index_iget_block( file_map_get_rst_index( file_map ) , seqnum_index );
+  if (block != NULL)
+    return block->sim_time;
+  else
+    return -1;
 }
 
 
 static double file_map_iget_restart_sim_days(const file_map_type * file_map , int seqnum_index) {
-  double sim_days = 0;
-  file_map_type * seqnum_map = seqnum_map = file_map_alloc_blockmap( file_map , SEQNUM_KW , seqnum_index);
-
-  if (seqnum_map != NULL) {
-    ecl_kw_type * doubhead_kw = file_map_iget_named_kw( seqnum_map , DOUBHEAD_KW , 0);
-    sim_days = ecl_kw_iget_double( doubhead_kw , DOUBHEAD_DAYS_INDEX);
-    file_map_free( seqnum_map );
-  } 
-  
-  return sim_days;
+  const rst_block_type * block = rst_index_iget_block( file_map_get_rst_index( file_map ) , seqnum_index );
+  if (block != NULL)
+    return block->sim_days;
+  else
+    return 0;
 }
 
 
 
+/*
+  Files without SEQNUM keywords, e.g. INIT files, have no restart
+  blocks; for those the INTEHEAD keywords are searched directly.
+*/
 
 static int file_map_find_sim_time(const file_map_type * file_map , time_t sim_time) {
   int seqnum_index = -1;
-  if ( file_map_has_kw( file_map , INTEHEAD_KW)) {
+  if (file_map_has_kw( file_map , SEQNUM_KW )) {
+    const rst_block_type * block = rst_index_find_sim_time( file_map_get_rst_index( file_map ) , sim_time );
+    if (block != NULL)
+      seqnum_index = block->intehead_index;
+  } else if ( file_map_has_kw( file_map , INTEHEAD_KW)) {
     const int_vector_type * intehead_index_list = hash_get( file_map->kw_index , INTEHEAD_KW );
     int index = 0;
     while (index < int_vector_size( intehead_index_list )) {
@@ -201,10 +455,10 @@ static int file_map_find_sim_time(const file_map_type * file_map , time_t sim_ti
 
 
 /**
-   This function will scan through the ecl_file looking for INTEHEAD
-   headers corresponding to sim_time. If sim_time is found the
-   function will return the INTEHEAD occurence number, i.e. for a
-   unified restart file like:
+   This function will look for a restart block with the INTEHEAD
+   header corresponding to sim_time. If sim_time is found the
+   function ecl_file_get_restart_index() will return the INTEHEAD
+   occurence number, i.e. for a unified restart file like:
 
    INTEHEAD  /  01.01.2000
    ...
@@ -243,54 +497,19 @@ static int file_map_find_sim_time(const file_map_type * file_map , time_t sim_ti
 
 
 static bool file_map_has_sim_time( const file_map_type * file_map , time_t sim_time) {
-  int num_INTEHEAD = file_map_get_num_named_kw( file_map , INTEHEAD_KW );
-  if (num_INTEHEAD == 0)
-    return false;       /* We have no INTEHEAD headers - probably not a restart file at all. */
-  else {
-    /*
-      Should probably do something smarter than a linear search; but I dare not
-      take the chance that all INTEHEAD headers are properly set. This is from
-      Schlumberger after all.
-    */
-    int intehead_index = 0;
-    while (true) {
-      time_t itime = file_map_iget_restart_sim_date( file_map , intehead_index );
-      
-      if (itime == sim_time) /* Perfect hit. */
-        return true;
-      
-      if (itime > sim_time)  /* We have gone past the target_time - i.e. we do not have it. */
-        return false;
-      
-      intehead_index++;
-      if (intehead_index == num_INTEHEAD)  /* We have iterated through the whole thing without finding sim_time. */
-        return false;
-    }
-  }
+  if (rst_index_find_sim_time( file_map_get_rst_index( file_map ) , sim_time ) != NULL)
+    return true;
+  else
+    return false;
 }
 
 
 static int file_map_seqnum_index_from_sim_time( file_map_type * parent_map , time_t sim_time) {
-  int num_seqnum = file_map_get_num_named_kw( parent_map , SEQNUM_KW );
-  int seqnum_index = 0;
-  file_map_type * seqnum_map;
-  
-  while (true) {
-    seqnum_map = file_map_alloc_blockmap( parent_map , SEQNUM_KW , seqnum_index);
-
-    if (seqnum_map != NULL) {
-      if (file_map_has_sim_time( seqnum_map , sim_time)) {
-        file_map_free( seqnum_map );
-        return seqnum_index;
-      } else {
-        file_map_free( seqnum_map );
-        seqnum_index++;
-      }
-    }
-    
-    if (num_seqnum == seqnum_index)
-      return -1;
-  }
+  const rst_block_type * block = rst_index_find_sim_time( file_map_get_rst_index( parent_map ) , sim_time );
+  if (block != NULL)
+    return block->seqnum_index;
+  else
+    return -1;
 }
 
 
@@ -406,11 +625,10 @@ bool ecl_file_select_rstblock_sim_time( ecl_file_type * ecl_file , time_t sim_ti
 
 
 bool ecl_file_select_rstblock_report_step( ecl_file_type * ecl_file , int report_step) {
-  int global_index = file_map_find_kw_value( ecl_file->global_map , SEQNUM_KW , &report_step);
-  if ( global_index >= 0) {
-    int seqnum_index = file_map_iget_occurence( ecl_file->global_map , global_index );
-    return ecl_file_iselect_rstblock( ecl_file ,  seqnum_index);
-  } else 
+  const rst_block_type * block = rst_index_find_report_step( file_map_get_rst_index( ecl_file->global_map ) , report_step );
+  if (block != NULL)
+    return ecl_file_iselect_rstblock( ecl_file , block->seqnum_index );
+  else 
     return false;
 }
 
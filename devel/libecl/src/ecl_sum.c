@@ -37,6 +37,9 @@
 #include <ert/ecl/ecl_sum.h>
 #include <ert/ecl/ecl_smspec.h>
 #include <ert/ecl/ecl_sum_data.h>
+#include <ert/ecl/ecl_sum_tstep.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw_magic.h>
 #include <ert/ecl/smspec_node.h>
 
 
@@ -94,6 +97,7 @@
 struct ecl_sum_struct {
   UTIL_TYPE_ID_DECLARATION;
   ecl_smspec_type   * smspec;     /* Internalized version of the SMSPEC file. */
+  bool                smspec_owner; /* False when the smspec is shared with other cases, e.g. in an ecl_sum_ensemble. */
   ecl_sum_data_type * data;       /* The data - can be NULL. */
 
 
@@ -105,6 +109,7 @@ struct ecl_sum_struct {
   char              * base;       /* Only the basename. */
   char              * ecl_case;   /* This is the current case, with optional path component. == path + base*/
   char              * ext;        /* Only to support selective loading of formatted|unformatted and unified|multiple. (can be NULL) */ 
+  char              * header_file; /* Only set when the smspec is shared - otherwise the smspec header file is used. */
 };
 
 
@@ -161,6 +166,8 @@ static ecl_sum_type * ecl_sum_alloc__( const char * input_arg , const char * key
   ecl_sum->key_join_string = util_alloc_string_copy( key_join_string );
   
   ecl_sum->smspec = NULL;
+  ecl_sum->smspec_owner = true;
+  ecl_sum->header_file  = NULL;
   ecl_sum->data   = NULL;
 
   return ecl_sum;
@@ -190,9 +197,20 @@ static void ecl_sum_fread_data( ecl_sum_type * ecl_sum , const stringlist_type *
 
 
 
-static void ecl_sum_fread(ecl_sum_type * ecl_sum , const char *header_file , const stringlist_type *data_files , bool include_restart) {
-  
-  ecl_sum->smspec = ecl_smspec_fread_alloc( header_file , ecl_sum->key_join_string , include_restart);
+/*
+  If @shared_smspec is different from NULL the SMSPEC header is not
+  parsed, instead the ecl_sum instance will use the shared smspec;
+  the shared smspec is not freed by ecl_sum_free().
+*/
+
+static void ecl_sum_fread(ecl_sum_type * ecl_sum , const char *header_file , const stringlist_type *data_files , bool include_restart , ecl_smspec_type * shared_smspec) {
+
+  if (shared_smspec != NULL) {
+    ecl_sum->smspec = shared_smspec;
+    ecl_sum->smspec_owner = false;
+    ecl_sum->header_file = util_alloc_realpath( header_file );
+  } else
+    ecl_sum->smspec = ecl_smspec_fread_alloc( header_file , ecl_sum->key_join_string , include_restart);
   {
     bool fmt_file;
     ecl_util_get_file_type( header_file , &fmt_file , NULL);
@@ -221,7 +239,7 @@ static bool ecl_sum_fread_case( ecl_sum_type * ecl_sum , bool include_restart) {
   
   ecl_util_alloc_summary_files( ecl_sum->path , ecl_sum->base , ecl_sum->ext , &header_file , summary_file_list );
   if ((header_file != NULL) && (stringlist_get_size( summary_file_list ) > 0)) {
-    ecl_sum_fread( ecl_sum , header_file , summary_file_list , include_restart );
+    ecl_sum_fread( ecl_sum , header_file , summary_file_list , include_restart , NULL );
     caseOK = true;
   }
   util_safe_free( header_file );
@@ -244,7 +262,27 @@ static bool ecl_sum_fread_case( ecl_sum_type * ecl_sum , bool include_restart) {
   
 ecl_sum_type * ecl_sum_fread_alloc(const char *header_file , const stringlist_type *data_files , const char * key_join_string) {
   ecl_sum_type * ecl_sum = ecl_sum_alloc__( header_file , key_join_string );
-  ecl_sum_fread( ecl_sum , header_file , data_files , false );
+  ecl_sum_fread( ecl_sum , header_file , data_files , false , NULL );
+  return ecl_sum;
+}
+
+
+/**
+   Will load the case @input_file, with the header and data files
+   @header_file and @data_files, using the already loaded @smspec
+   instead of parsing the SMSPEC header. The @smspec instance must
+   have been loaded from a header file identical to @header_file, and
+   is NOT owned by the returned ecl_sum instance; it must be kept
+   alive until the ecl_sum instance has been freed. Loading of
+   restarted cases is as for ecl_sum_fread_alloc_case().
+
+   This is used by the ecl_sum_ensemble loader to share one smspec
+   among all the members of an ensemble.
+*/
+
+ecl_sum_type * ecl_sum_fread_alloc_shared( const char * input_file , const char * header_file , const stringlist_type * data_files , const char * key_join_string , ecl_smspec_type * smspec) {
+  ecl_sum_type * ecl_sum = ecl_sum_alloc__( input_file , key_join_string );
+  ecl_sum_fread( ecl_sum , header_file , data_files , true , smspec );
   return ecl_sum;
 }
 
@@ -328,12 +366,13 @@ void ecl_sum_free( ecl_sum_type * ecl_sum ) {
   if (ecl_sum->data != NULL)
     ecl_sum_free_data( ecl_sum );
 
-  if (ecl_sum->smspec != NULL)
+  if ((ecl_sum->smspec != NULL) && ecl_sum->smspec_owner)
     ecl_smspec_free( ecl_sum->smspec );
   
   util_safe_free( ecl_sum->path );
   util_safe_free( ecl_sum->ext );
   util_safe_free( ecl_sum->abs_path );
+  util_safe_free( ecl_sum->header_file );
 
   free( ecl_sum->base );
   free( ecl_sum->ecl_case );
@@ -415,6 +454,71 @@ bool ecl_sum_case_exists( const char * input_file ) {
 }
 
 
+/**
+   Will find the simulated time span of the case @input_file without
+   loading the summary data: the start time is taken from the SMSPEC
+   header, and the end time from the last ministep in the summary
+   files, i.e. only one PARAMS vector is read. The span is the same as
+   ecl_sum_get_start_time() and ecl_sum_get_end_time() would give for
+   the loaded case. Returns false if the case does not exist, or no
+   ministeps have been written.
+*/
+
+bool ecl_sum_fread_time_span( const char * input_file , const char * key_join_string , time_t * start_time , time_t * end_time) {
+  char * header_file = NULL;
+  stringlist_type * data_files = stringlist_alloc_new();
+  char * path;
+  char * basename;
+  char * extension;
+  bool   span_ok = false;
+
+  util_alloc_file_components( input_file , &path , &basename , &extension);
+  ecl_util_alloc_summary_files( path , basename , extension , &header_file , data_files );
+  if ((header_file != NULL) && (stringlist_get_size( data_files ) > 0)) {
+    ecl_smspec_type * smspec = ecl_smspec_fread_alloc( header_file , key_join_string , false );
+    int file_nr;
+
+    /*
+      ECLIPSE starts a report step by writing a summary section
+      without any PARAMS keyword, so the last file need not contain a
+      ministep.
+    */
+    for (file_nr = stringlist_get_size( data_files ) - 1; file_nr >= 0; file_nr--) {
+      ecl_file_type * ecl_file = ecl_file_open( stringlist_iget( data_files , file_nr ) , 0 );
+      int num_ministep = ecl_file_get_num_named_kw( ecl_file , PARAMS_KW );
+
+      if (num_ministep > 0) {
+        const ecl_kw_type * ministep_kw = ecl_file_iget_named_kw( ecl_file , MINISTEP_KW , num_ministep - 1);
+        const ecl_kw_type * params_kw   = ecl_file_iget_named_kw( ecl_file , PARAMS_KW   , num_ministep - 1);
+        ecl_sum_tstep_type * tstep = ecl_sum_tstep_alloc_from_file( 0 ,
+                                                                    ecl_kw_iget_int( ministep_kw , 0 ) ,
+                                                                    params_kw ,
+                                                                    ecl_file_get_src_file( ecl_file ) ,
+                                                                    smspec );
+        if (tstep != NULL) {
+          *start_time = ecl_smspec_get_start_time( smspec );
+          *end_time   = ecl_sum_tstep_get_sim_time( tstep );
+          span_ok = true;
+          ecl_sum_tstep_free( tstep );
+        }
+      }
+      ecl_file_close( ecl_file );
+      if (num_ministep > 0)
+        break;
+    }
+    ecl_smspec_free( smspec );
+  }
+
+  util_safe_free( path );
+  util_safe_free( basename );
+  util_safe_free( extension );
+  util_safe_free( header_file );
+  stringlist_free( data_files );
+
+  return span_ok;
+}
+
+
 /*****************************************************************/
 
 double ecl_sum_get_from_sim_time( const ecl_sum_type * ecl_sum , time_t sim_time , const smspec_node_type * node) {
@@ -771,6 +875,48 @@ double_vector_type * ecl_sum_alloc_data_vector( const ecl_sum_type * ecl_sum  ,
 }
 
 
+int ecl_sum_get_data_vector_length( const ecl_sum_type * ecl_sum , bool report_only) {
+  return ecl_sum_data_get_data_vector_length( ecl_sum->data , report_only );
+}
+
+
+/**
+   Will fill the time series of all the keys in @key_list into
+   @buffer, which must have room for stringlist_get_size( key_list ) *
+   ecl_sum_get_data_vector_length() elements. See the documentation
+   of ecl_sum_data_fill_data_vectors() for the layout of the buffer.
+*/
+
+void ecl_sum_fill_data_vectors( const ecl_sum_type * ecl_sum , const stringlist_type * key_list , bool report_only , double * buffer) {
+  int_vector_type * params_list = int_vector_alloc( 0 , 0 );
+  int ikey;
+  
+  for (ikey = 0; ikey < stringlist_get_size( key_list ); ikey++)
+    int_vector_append( params_list , ecl_sum_get_general_var_params_index( ecl_sum , stringlist_iget( key_list , ikey )));
+
+  ecl_sum_data_fill_data_vectors( ecl_sum->data , params_list , report_only , buffer );
+  int_vector_free( params_list );
+}
+
+
+/**
+   Will keep the summary data in column storage, which makes
+   extraction of complete time series faster; see the documentation
+   in ecl_sum_data.c. In write mode a tstep returned from
+   ecl_sum_add_tstep() can only be updated until the next tstep is
+   added.
+*/
+
+void ecl_sum_set_columnar( ecl_sum_type * ecl_sum , bool columnar ) {
+  ecl_sum_data_set_columnar( ecl_sum->data , columnar );
+}
+
+
+bool ecl_sum_is_columnar( const ecl_sum_type * ecl_sum ) {
+  return ecl_sum_data_is_columnar( ecl_sum->data );
+}
+
+
 
 void ecl_sum_summarize( const ecl_sum_type * ecl_sum , FILE * stream ) {
   ecl_sum_data_summarize( ecl_sum->data , stream );
@@ -1049,7 +1195,8 @@ bool ecl_sum_same_case( const ecl_sum_type * ecl_sum , const char * input_file )
       bool   fmt_file = ecl_smspec_get_formatted( ecl_sum->smspec );
       char * header_file = ecl_util_alloc_exfilename( path , base , ECL_SUMMARY_HEADER_FILE , fmt_file , -1 );
       if (header_file != NULL) {
-        same_case = util_same_file( header_file , ecl_smspec_get_header_file( ecl_sum->smspec ));
+        const char * loaded_header = ecl_sum->smspec_owner ? ecl_smspec_get_header_file( ecl_sum->smspec ) : ecl_sum->header_file;
+        same_case = util_same_file( header_file , loaded_header );
         free( header_file );
       }
     }
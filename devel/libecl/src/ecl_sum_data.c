@@ -200,6 +200,33 @@
       ecl_sum_data_get_xxx : Expects the time direction given as a ministep_nr.
       ecl_sum_data_iget_xxx: Expects the time direction given as an internal index.
 
+
+
+   Column storage
+   --------------
+   The data is stored row wise, with one ecl_sum_tstep instance for
+   each ministep; that is the natural layout when loading, but when
+   complete time series for one variable are extracted every lookup
+   is in a different tstep instance. By calling
+   ecl_sum_data_set_columnar() the data is moved to column storage:
+
+      column_data = [ V0(t0) V0(t1) V0(t2) ... | V1(t0) V1(t1) ... | ... ]
+
+   i.e. the time series for params_index @k starts at offset k *
+   column_capacity. The columns are created with one transpose, and
+   the row data of the tsteps is then freed, so the memory usage is
+   not increased. The tsteps are still used for the time information.
+
+   Tsteps which are added later, either with
+   ecl_sum_data_add_new_tstep() in write mode or by loading restart
+   data, keep their row data until they are appended to the columns;
+   the tsteps [0,column_length) are in the columns and the remaining
+   tsteps have row data. In write mode a tstep is appended to the
+   columns when the next tstep is added, i.e. a tstep can NOT be
+   modified with ecl_sum_tstep_iset() after the next tstep has been
+   added. If new tsteps do not come in time order the columns are
+   transposed back to rows before sorting.
+
 */   
 
 
@@ -221,6 +248,10 @@ struct ecl_sum_data_struct {
   time_t                   __min_time;             /* An internal member used during the load of 
                                                       restarted cases; see doc in ecl_sum_data_append_tstep. */
   bool                     index_valid;
+  bool                     columnar;               /* Should the data be kept in column storage? */
+  float                  * column_data;            /* Column wise storage of the data - see documentation of column storage above; can be NULL. */
+  int                      column_length;          /* The number of tsteps which have been moved to column_data. */
+  int                      column_capacity;        /* The allocated length of each column in column_data. */
   time_interval_type     * sim_time;               /* The time interval sim_time goes from the first time value where we have
                                                       data to the end of the simulation. In the case of restarts the start
                                                       value might disagree with the simulation start reported by the smspec file. */
@@ -233,6 +264,7 @@ struct ecl_sum_data_struct {
 /*****************************************************************/
 
  void ecl_sum_data_free( ecl_sum_data_type * data ) {
+  util_safe_free( data->column_data );
   vector_free( data->data );
   int_vector_free( data->report_first_index );
   int_vector_free( data->report_last_index  );
@@ -271,6 +303,10 @@ ecl_sum_data_type * ecl_sum_data_alloc(ecl_smspec_type * smspec) {
   data->report_first_index    = int_vector_alloc( 0 , INVALID_MINISTEP_NR );  
   data->report_last_index     = int_vector_alloc( 0 , INVALID_MINISTEP_NR );
   data->sim_time              = time_interval_alloc_open();
+  data->columnar              = false;
+  data->column_data           = NULL;
+  data->column_length         = 0;
+  data->column_capacity       = 0;
 
   ecl_sum_data_clear_index( data );
   return data;
@@ -335,7 +371,17 @@ static void ecl_sum_data_fwrite_report__( const ecl_sum_data_type * data , int r
     ecl_sum_data_report2internal_range( data , report_step , &index1 , &index2);
     for (index = index1; index <= index2; index++) {
       const ecl_sum_tstep_type * tstep = ecl_sum_data_iget_ministep( data , index );
-      ecl_sum_tstep_fwrite( tstep , ecl_smspec_get_index_map( data->smspec ) , fortio );
+      if (index < data->column_length) {
+        int params_size = ecl_smspec_get_params_size( data->smspec );
+        float * row = util_calloc( params_size , sizeof * row );
+        int params_index;
+        
+        for (params_index = 0; params_index < params_size; params_index++)
+          row[params_index] = ecl_sum_data_iget( data , index , params_index );
+        ecl_sum_tstep_fwrite_row( tstep , row , ecl_smspec_get_index_map( data->smspec ) , fortio );
+        free( row );
+      } else
+        ecl_sum_tstep_fwrite( tstep , ecl_smspec_get_index_map( data->smspec ) , fortio );
     }
   }
 }
@@ -728,14 +774,181 @@ static int cmp_ministep( const void * arg1 , const void * arg2) {
 }
 
 
+/*
+  The transpose is done in blocks of ECL_SUM_DATA_COLUMN_BLOCK tsteps,
+  so that the rows which are read stay in cache while the columns are
+  written.
+*/
+
+#define ECL_SUM_DATA_COLUMN_BLOCK 64
+
+
+static const float * ecl_sum_data_iget_column( const ecl_sum_data_type * data , int params_index ) {
+  return &data->column_data[ (size_t) params_index * data->column_capacity ];
+}
+
+
+/*
+  Will grow the columns so that each column has room for at least
+  @length elements; the columns are moved to their new offsets.
+*/
+
+static void ecl_sum_data_resize_columns( ecl_sum_data_type * data , int length ) {
+  if (length > data->column_capacity) {
+    int params_size  = ecl_smspec_get_params_size( data->smspec );
+    int new_capacity = util_int_max( length , 2 * data->column_capacity );
+    float * new_data = util_calloc( (size_t) new_capacity * params_size , sizeof * new_data );
+    
+    if (data->column_length > 0) {
+      int params_index;
+      for (params_index = 0; params_index < params_size; params_index++)
+        memcpy( &new_data[ (size_t) params_index * new_capacity ] , 
+                ecl_sum_data_iget_column( data , params_index ) , 
+                data->column_length * sizeof * new_data );
+    }
+    
+    util_safe_free( data->column_data );
+    data->column_data     = new_data;
+    data->column_capacity = new_capacity;
+  }
+}
+
+
+/*
+  Will append the row data of all the tsteps [column_length, size) to
+  the columns, and free the row data of the tsteps.
+*/
+
+static void ecl_sum_data_append_columns( ecl_sum_data_type * sum_data ) {
+  int length = vector_get_size( sum_data->data );
+  
+  if (length > sum_data->column_length) {
+    int params_size = ecl_smspec_get_params_size( sum_data->smspec );
+    const float * row_data[ECL_SUM_DATA_COLUMN_BLOCK];
+    int t0;
+
+    ecl_sum_data_resize_columns( sum_data , length );
+    for (t0 = sum_data->column_length; t0 < length; t0 += ECL_SUM_DATA_COLUMN_BLOCK) {
+      int block_size = util_int_min( ECL_SUM_DATA_COLUMN_BLOCK , length - t0 );
+      int params_index;
+      int t;
+
+      for (t = 0; t < block_size; t++)
+        row_data[t] = ecl_sum_tstep_get_data_ptr( ecl_sum_data_iget_ministep( sum_data , t0 + t ));
+      
+      for (params_index = 0; params_index < params_size; params_index++) {
+        float * column = &sum_data->column_data[ (size_t) params_index * sum_data->column_capacity + t0 ];
+        for (t = 0; t < block_size; t++)
+          column[t] = row_data[t][params_index];
+      }
+      
+      for (t = 0; t < block_size; t++)
+        ecl_sum_tstep_free_data( vector_iget( sum_data->data , t0 + t ));
+    }
+    sum_data->column_length = length;
+  }
+}
+
+
+/*
+  Will transpose the columns back to row data in the tsteps, and free
+  the columns.
+*/
+
+static void ecl_sum_data_restore_rows( ecl_sum_data_type * sum_data ) {
+  if (sum_data->column_data != NULL) {
+    int params_size = ecl_smspec_get_params_size( sum_data->smspec );
+    float * row = util_calloc( params_size , sizeof * row );
+    int t;
+
+    for (t = 0; t < sum_data->column_length; t++) {
+      int params_index;
+      for (params_index = 0; params_index < params_size; params_index++)
+        row[params_index] = sum_data->column_data[ (size_t) params_index * sum_data->column_capacity + t ];
+      ecl_sum_tstep_set_data( vector_iget( sum_data->data , t ) , row );
+    }
+    
+    free( row );
+    free( sum_data->column_data );
+    sum_data->column_data     = NULL;
+    sum_data->column_length   = 0;
+    sum_data->column_capacity = 0;
+  }
+}
+
+
+/*
+  Will return the value of variable @params_index at internal index
+  @time_index; from the columns or from the row data of the tstep.
+*/
+
+static double ecl_sum_data_iget_value( const ecl_sum_data_type * data , int time_index , int params_index ) {
+  if (time_index < data->column_length) {
+    int params_size = ecl_smspec_get_params_size( data->smspec );
+    if ((params_index < 0) || (params_index >= params_size))
+      util_abort("%s: param index:%d invalid: Valid range: [0,%d) \n",__func__ , params_index , params_size);
+    
+    return data->column_data[ (size_t) params_index * data->column_capacity + time_index ];
+  } else
+    return ecl_sum_tstep_iget( ecl_sum_data_iget_ministep( data , time_index ) , params_index );
+}
+
+
+/*
+  Checks whether the tsteps are already sorted in time.
+*/
+
+static bool ecl_sum_data_is_sorted( const ecl_sum_data_type * sum_data ) {
+  int t;
+  for (t = 1; t < vector_get_size( sum_data->data ); t++) {
+    const ecl_sum_tstep_type * prev = ecl_sum_data_iget_ministep( sum_data , t - 1 );
+    const ecl_sum_tstep_type * tstep = ecl_sum_data_iget_ministep( sum_data , t );
+    if (ecl_sum_tstep_get_sim_time( prev ) > ecl_sum_tstep_get_sim_time( tstep ))
+      return false;
+  }
+  return true;
+}
+
+
+/**
+   Will move the data to/from column storage; see the documentation
+   of column storage at the top of this file. 
+*/
+
+void ecl_sum_data_set_columnar( ecl_sum_data_type * data , bool columnar ) {
+  if (columnar != data->columnar) {
+    data->columnar = columnar;
+    if (columnar) {
+      if (data->index_valid)
+        ecl_sum_data_append_columns( data );
+    } else
+      ecl_sum_data_restore_rows( data );
+  }
+}
+
+
+bool ecl_sum_data_is_columnar( const ecl_sum_data_type * data ) {
+  return data->columnar;
+}
+
+
 static void ecl_sum_data_build_index( ecl_sum_data_type * sum_data ) {
   /* Clear the existing index (if any): */
   ecl_sum_data_clear_index( sum_data );
   
   /*
-    Sort the internal storage vector after sim_time. 
+    Sort the internal storage vector after sim_time. If the data is in
+    column storage the order of the tsteps must be retained, so unless
+    the tsteps are already sorted the data is moved back to the rows
+    first.
   */
-  vector_sort( sum_data->data , cmp_ministep );
+  if (sum_data->column_data != NULL) {
+    if (!ecl_sum_data_is_sorted( sum_data )) {
+      ecl_sum_data_restore_rows( sum_data );
+      vector_sort( sum_data->data , cmp_ministep );
+    }
+  } else
+    vector_sort( sum_data->data , cmp_ministep );
 
   
   /* Identify various global first and last values.  */
@@ -802,6 +1015,14 @@ ecl_sum_tstep_type * ecl_sum_data_add_new_tstep( ecl_sum_data_type * data , int
   ecl_sum_tstep_type * tstep = ecl_sum_tstep_alloc_new( report_step , ministep_nr , sim_days , data->smspec );
   ecl_sum_tstep_type * prev_tstep = NULL;
 
+  /* 
+     The new tstep will be modified by the calling scope, so it keeps
+     its row data; the previous tsteps are complete and can be moved
+     to the columns.
+  */
+  if (data->columnar)
+    ecl_sum_data_append_columns( data );
+
   if (vector_get_size( data->data ) > 0)
     prev_tstep = vector_get_last( data->data );
   
@@ -967,6 +1188,8 @@ static void ecl_sum_data_fread__( ecl_sum_data_type * data , time_t load_end , c
       util_abort("%s: invalid file type:%s \n",__func__ , ecl_util_file_type_name(file_type )); 
   } 
   ecl_sum_data_build_index( data );
+  if (data->columnar)
+    ecl_sum_data_append_columns( data );
 }
 
 void ecl_sum_data_fread( ecl_sum_data_type * data , const stringlist_type * filelist) {
@@ -1094,8 +1317,7 @@ int ecl_sum_data_iget_mini_step(const ecl_sum_data_type * data , int internal_in
 
 
 double ecl_sum_data_iget( const ecl_sum_data_type * data , int time_index , int params_index ) {
-  const ecl_sum_tstep_type * ministep_data = ecl_sum_data_iget_ministep( data , time_index  );
-  return ecl_sum_tstep_iget( ministep_data , params_index);  
+  return ecl_sum_data_iget_value( data , time_index , params_index );
 }
 
 
@@ -1112,10 +1334,7 @@ double ecl_sum_data_iget( const ecl_sum_data_type * data , int time_index , int
 */
 
 double ecl_sum_data_interp_get(const ecl_sum_data_type * data , int time_index1 , int time_index2 , double weight1 , double weight2 , int params_index) {
-  const ecl_sum_tstep_type * ministep_data1 = ecl_sum_data_iget_ministep( data , time_index1 );  
-  const ecl_sum_tstep_type * ministep_data2 = ecl_sum_data_iget_ministep( data , time_index2 );  
-  
-  return ecl_sum_tstep_iget( ministep_data1 , params_index ) * weight1 + ecl_sum_tstep_iget( ministep_data2 , params_index ) * weight2;
+  return ecl_sum_data_iget_value( data , time_index1 , params_index ) * weight1 + ecl_sum_data_iget_value( data , time_index2 , params_index ) * weight2;
 }
 
 
@@ -1311,6 +1530,15 @@ time_t_vector_type *  ecl_sum_data_alloc_time_vector( const ecl_sum_data_type *
 }
 
 
+static const float * ecl_sum_data_get_column( const ecl_sum_data_type * data , int params_index ) {
+  int params_size = ecl_smspec_get_params_size( data->smspec );
+  if ((params_index < 0) || (params_index >= params_size))
+    util_abort("%s: param index:%d invalid: Valid range: [0,%d) \n",__func__ , params_index , params_size);
+  
+  return ecl_sum_data_iget_column( data , params_index );
+}
+
+
 void ecl_sum_data_init_data_vector( const ecl_sum_data_type * data , double_vector_type * data_vector , int data_index , bool report_only) {
   double_vector_reset( data_vector );
   double_vector_append( data_vector , ecl_smspec_get_start_time( data->smspec ));
@@ -1318,12 +1546,17 @@ void ecl_sum_data_init_data_vector( const ecl_sum_data_type * data , double_vect
     int report_step;
     for (report_step = data->first_report_step; report_step <= data->last_report_step; report_step++) {
       int last_index = int_vector_iget(data->report_last_index , report_step);
-      const ecl_sum_tstep_type * ministep = ecl_sum_data_iget_ministep( data , last_index );
-      double_vector_append( data_vector , ecl_sum_tstep_iget( ministep , data_index ));
+      double_vector_append( data_vector , ecl_sum_data_iget_value( data , last_index , data_index ));
     }
   } else {
-    int i;
-    for (i = 0; i < vector_get_size(data->data); i++) {
+    int i = 0;
+    if (data->column_data != NULL) {
+      const float * column = ecl_sum_data_get_column( data , data_index );
+      for (i = 0; i < data->column_length; i++)
+        double_vector_append( data_vector , column[i] );
+    }
+    
+    for (; i < vector_get_size(data->data); i++) {
       const ecl_sum_tstep_type * ministep = ecl_sum_data_iget_ministep( data , i  );
       double_vector_append( data_vector , ecl_sum_tstep_iget( ministep , data_index ));
     }
@@ -1338,6 +1571,95 @@ double_vector_type * ecl_sum_data_alloc_data_vector( const ecl_sum_data_type * d
 }
 
 
+/*
+  The internal indices of the rows which are used by
+  ecl_sum_data_fill_data_vectors(); either all the ministeps or the
+  last ministep of each report step.
+*/
+
+static int_vector_type * ecl_sum_data_alloc_row_index( const ecl_sum_data_type * data , bool report_only) {
+  int_vector_type * row_index = int_vector_alloc( 0 , 0 );
+  if (report_only) {
+    int report_step;
+    for (report_step = data->first_report_step; report_step <= data->last_report_step; report_step++) {
+      if (ecl_sum_data_has_report_step( data , report_step ))
+        int_vector_append( row_index , int_vector_iget( data->report_last_index , report_step ));
+    }
+  } else {
+    int i;
+    for (i = 0; i < vector_get_size( data->data ); i++)
+      int_vector_append( row_index , i );
+  }
+  return row_index;
+}
+
+
+int ecl_sum_data_get_data_vector_length( const ecl_sum_data_type * data , bool report_only) {
+  int_vector_type * row_index = ecl_sum_data_alloc_row_index( data , report_only );
+  int length = int_vector_size( row_index );
+  int_vector_free( row_index );
+  return length;
+}
+
+
+/**
+   Will extract the time series of all the variables in @params_list
+   in one go. The results are stored in the caller supplied @buffer,
+   which must have room for int_vector_size( @params_list ) *
+   ecl_sum_data_get_data_vector_length( data , @report_only ) elements;
+   the time series for the variable params_list[k] starts at offset
+   k * length:
+
+      buffer = [ V0(t0) V0(t1) ... V0(tn) | V1(t0) V1(t1) ... ]
+
+   Observe that contrary to ecl_sum_data_init_data_vector() there is
+   no leading element with the simulation start. If the column wise
+   copy of the data is available it is used, otherwise each tstep is
+   visited only once, picking out all the variables.
+*/
+
+void ecl_sum_data_fill_data_vectors( const ecl_sum_data_type * data , const int_vector_type * params_list , bool report_only , double * buffer) {
+  int_vector_type * row_index = ecl_sum_data_alloc_row_index( data , report_only );
+  const int * rows = int_vector_get_const_ptr( row_index );
+  int length       = int_vector_size( row_index );
+  int num_vectors  = int_vector_size( params_list );
+  
+  int column_rows  = 0;  /* The number of leading entries in rows which are in column storage. */
+
+  while ((column_rows < length) && (rows[column_rows] < data->column_length))
+    column_rows++;
+
+  if (column_rows > 0) {
+    int k;
+    for (k = 0; k < num_vectors; k++) {
+      const float * column = ecl_sum_data_get_column( data , int_vector_iget( params_list , k ));
+      double * target = &buffer[ (size_t) k * length ];
+      int t;
+      
+      if (report_only) {
+        for (t = 0; t < column_rows; t++)
+          target[t] = column[ rows[t] ];
+      } else {
+        for (t = 0; t < column_rows; t++)
+          target[t] = column[t];
+      }
+    }
+  }
+
+  {
+    int t;
+    for (t = column_rows; t < length; t++) {
+      const ecl_sum_tstep_type * ministep = ecl_sum_data_iget_ministep( data , rows[t] );
+      int k;
+      for (k = 0; k < num_vectors; k++)
+        buffer[ (size_t) k * length + t ] = ecl_sum_tstep_iget( ministep , int_vector_iget( params_list , k ));
+    }
+  }
+  
+  int_vector_free( row_index );
+}
+
+
 
 /**
    This function will return the total number of ministeps in the
@@ -0,0 +1,333 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_ensemble.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef WITH_PTHREAD
+#include <pthread.h>
+#include <ert/util/thread_pool.h>
+#include <ert/util/arg_pack.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+#include <ert/util/buffer.h>
+#include <ert/util/stringlist.h>
+
+#include <ert/ecl/ecl_util.h>
+#include <ert/ecl/ecl_smspec.h>
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_sum_ensemble.h>
+
+/*
+  The ecl_sum_ensemble structure loads the summary results from a
+  list of cases, typically all the realisations of an ensemble. The
+  cases are loaded in parallel by a thread pool with @num_threads
+  threads (serially without pthread support).
+
+  All the realisations of an ensemble will normally have identical
+  SMSPEC headers; when loading a case the content of the header file
+  is compared with the headers which have already been loaded, and if
+  an identical header is found the corresponding ecl_smspec instance
+  (with all the key lookup tables) is shared among the cases instead
+  of parsing the header again. The smspec instances are owned by the
+  ensemble, and the ecl_sum instances of the ensemble can not outlive
+  the ensemble.
+
+  Observe that the RESTART information in a shared header is resolved
+  relative to the case which was loaded first.
+*/
+
+#define ECL_SUM_ENSEMBLE_TYPE_ID 771634
+
+struct ecl_sum_ensemble_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  char              * key_join_string;
+  stringlist_type   * case_list;
+  ecl_sum_type     ** members;          /* members[i] is the case loaded from case_list[i], or NULL if loading failed. */
+  vector_type       * smspec_list;      /* The distinct smspec instances - owned by the ensemble. */
+  vector_type       * header_list;      /* header_list[i] is the content of the header file smspec_list[i] was loaded from. */
+#ifdef WITH_PTHREAD
+  pthread_mutex_t     mutex;
+#endif
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( ecl_sum_ensemble , ECL_SUM_ENSEMBLE_TYPE_ID )
+
+
+static void ecl_sum_ensemble_free_smspec__( void * arg ) {
+  ecl_smspec_free( (ecl_smspec_type *) arg );
+}
+
+
+static void ecl_sum_ensemble_free_header__( void * arg ) {
+  buffer_free( (buffer_type *) arg );
+}
+
+
+static bool ecl_sum_ensemble_equal_header( const buffer_type * header1 , const buffer_type * header2 ) {
+  if (buffer_get_size( header1 ) == buffer_get_size( header2 ))
+    return (memcmp( buffer_get_data( header1 ) , buffer_get_data( header2 ) , buffer_get_size( header1 )) == 0);
+  else
+    return false;
+}
+
+
+/*
+  Will return an smspec instance loaded from a header file with
+  content identical to @header_file; if no such smspec has been loaded
+  yet the header is parsed and added to the ensemble.
+*/
+
+static ecl_smspec_type * ecl_sum_ensemble_get_smspec( ecl_sum_ensemble_type * ensemble , const char * header_file ) {
+  ecl_smspec_type * smspec = NULL;
+  buffer_type * header = buffer_fread_alloc( header_file );
+
+#ifdef WITH_PTHREAD
+  pthread_mutex_lock( &ensemble->mutex );
+#endif
+  {
+    int i;
+    for (i=0; i < vector_get_size( ensemble->header_list ); i++) {
+      if (ecl_sum_ensemble_equal_header( header , vector_iget_const( ensemble->header_list , i ))) {
+        smspec = vector_iget( ensemble->smspec_list , i );
+        break;
+      }
+    }
+
+    if (smspec == NULL) {
+      smspec = ecl_smspec_fread_alloc( header_file , ensemble->key_join_string , true );
+      vector_append_owned_ref( ensemble->smspec_list , smspec , ecl_sum_ensemble_free_smspec__ );
+      vector_append_owned_ref( ensemble->header_list , header , ecl_sum_ensemble_free_header__ );
+      header = NULL;
+    }
+  }
+#ifdef WITH_PTHREAD
+  pthread_mutex_unlock( &ensemble->mutex );
+#endif
+
+  if (header != NULL)
+    buffer_free( header );
+
+  return smspec;
+}
+
+
+static void ecl_sum_ensemble_load_case( ecl_sum_ensemble_type * ensemble , int index ) {
+  const char * input_file = stringlist_iget( ensemble->case_list , index );
+  stringlist_type * data_files = stringlist_alloc_new();
+  char * header_file = NULL;
+  char * path;
+  char * base;
+  char * ext;
+
+  util_alloc_file_components( input_file , &path , &base , &ext );
+  ecl_util_alloc_summary_files( path , base , ext , &header_file , data_files );
+  if ((header_file != NULL) && (stringlist_get_size( data_files ) > 0)) {
+    ecl_smspec_type * smspec = ecl_sum_ensemble_get_smspec( ensemble , header_file );
+    ensemble->members[index] = ecl_sum_fread_alloc_shared( input_file , header_file , data_files , ensemble->key_join_string , smspec );
+  }
+
+  util_safe_free( header_file );
+  util_safe_free( path );
+  util_safe_free( base );
+  util_safe_free( ext );
+  stringlist_free( data_files );
+}
+
+
+/*
+  Without a @func the loaded case is retained in the ensemble;
+  otherwise it is passed to @func and discarded immediately
+  afterwards.
+*/
+
+static void ecl_sum_ensemble_run_case( ecl_sum_ensemble_type * ensemble , int index , ecl_sum_ensemble_func_type * func , void * arg) {
+  ecl_sum_ensemble_load_case( ensemble , index );
+  if (func != NULL) {
+    func( ensemble->members[index] , index , arg );
+    if (ensemble->members[index] != NULL) {
+      ecl_sum_free( ensemble->members[index] );
+      ensemble->members[index] = NULL;
+    }
+  }
+}
+
+
+#ifdef WITH_PTHREAD
+static void * ecl_sum_ensemble_run_case__( void * arg ) {
+  arg_pack_type * arg_pack = arg_pack_safe_cast( arg );
+  ecl_sum_ensemble_type * ensemble = arg_pack_iget_ptr( arg_pack , 0 );
+  int index = arg_pack_iget_int( arg_pack , 1 );
+  ecl_sum_ensemble_func_type * func = arg_pack_iget_ptr( arg_pack , 2 );
+  void * func_arg = arg_pack_iget_ptr( arg_pack , 3 );
+
+  ecl_sum_ensemble_run_case( ensemble , index , func , func_arg );
+  return NULL;
+}
+#endif
+
+
+static void ecl_sum_ensemble_run( ecl_sum_ensemble_type * ensemble , int num_threads , ecl_sum_ensemble_func_type * func , void * arg) {
+  const stringlist_type * case_list = ensemble->case_list;
+#ifdef WITH_PTHREAD
+  {
+    thread_pool_type * tp = thread_pool_alloc( util_int_max( num_threads , 1 ) , true );
+    arg_pack_type ** arg_list = util_calloc( stringlist_get_size( case_list ) , sizeof * arg_list );
+    int i;
+
+    for (i=0; i < stringlist_get_size( case_list ); i++) {
+      arg_list[i] = arg_pack_alloc();
+      arg_pack_append_ptr( arg_list[i] , ensemble );
+      arg_pack_append_int( arg_list[i] , i );
+      arg_pack_append_ptr( arg_list[i] , func );
+      arg_pack_append_ptr( arg_list[i] , arg );
+      thread_pool_add_job( tp , ecl_sum_ensemble_run_case__ , arg_list[i] );
+    }
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+
+    for (i=0; i < stringlist_get_size( case_list ); i++)
+      arg_pack_free( arg_list[i] );
+    free( arg_list );
+  }
+#else
+  {
+    int i;
+    for (i=0; i < stringlist_get_size( case_list ); i++)
+      ecl_sum_ensemble_run_case( ensemble , i , func , arg );
+  }
+#endif
+}
+
+
+static ecl_sum_ensemble_type * ecl_sum_ensemble_alloc__( const stringlist_type * case_list , const char * key_join_string ) {
+  ecl_sum_ensemble_type * ensemble = util_malloc( sizeof * ensemble );
+  UTIL_TYPE_ID_INIT( ensemble , ECL_SUM_ENSEMBLE_TYPE_ID );
+  ensemble->key_join_string = util_alloc_string_copy( key_join_string );
+  ensemble->case_list       = stringlist_alloc_deep_copy( case_list );
+  ensemble->members         = util_calloc( stringlist_get_size( case_list ) , sizeof * ensemble->members );
+  ensemble->smspec_list     = vector_alloc_new();
+  ensemble->header_list     = vector_alloc_new();
+  {
+    int i;
+    for (i=0; i < stringlist_get_size( case_list ); i++)
+      ensemble->members[i] = NULL;
+  }
+#ifdef WITH_PTHREAD
+  pthread_mutex_init( &ensemble->mutex , NULL );
+#endif
+  return ensemble;
+}
+
+
+/**
+   Will load the summary results for all the cases in @case_list; the
+   elements in @case_list are interpreted as the input argument to
+   ecl_sum_fread_alloc_case(). Cases which can not be loaded will be
+   NULL in the ensemble.
+*/
+
+ecl_sum_ensemble_type * ecl_sum_ensemble_fread_alloc( const stringlist_type * case_list , const char * key_join_string , int num_threads ) {
+  ecl_sum_ensemble_type * ensemble = ecl_sum_ensemble_alloc__( case_list , key_join_string );
+  ecl_sum_ensemble_run( ensemble , num_threads , NULL , NULL );
+
+  /* The header content is only needed while loading. */
+  vector_clear( ensemble->header_list );
+  return ensemble;
+}
+
+
+/**
+   Streaming alternative to ecl_sum_ensemble_fread_alloc(): the cases
+   in @case_list are loaded by @num_threads worker threads, and each
+   case is passed to @func as soon as it has been loaded, and freed
+   when @func returns. I.e. at most @num_threads cases are in memory
+   at the same time, which makes it possible to process ensembles
+   which do not fit in memory.
+
+   The @func callback is called as func( ecl_sum , index , arg ),
+   where @index is the position of the case in @case_list and
+   @ecl_sum is NULL if the case could not be loaded. The calls are
+   made concurrently from the worker threads, in no particular order,
+   so @func must synchronize access to shared state in @arg
+   itself. The SMSPEC headers are shared between the cases as in
+   ecl_sum_ensemble_fread_alloc().
+*/
+
+void ecl_sum_ensemble_fread_apply( const stringlist_type * case_list , const char * key_join_string , int num_threads , ecl_sum_ensemble_func_type * func , void * arg) {
+  ecl_sum_ensemble_type * ensemble = ecl_sum_ensemble_alloc__( case_list , key_join_string );
+  ecl_sum_ensemble_run( ensemble , num_threads , func , arg );
+  ecl_sum_ensemble_free( ensemble );
+}
+
+
+void ecl_sum_ensemble_free( ecl_sum_ensemble_type * ensemble ) {
+  int i;
+  for (i=0; i < stringlist_get_size( ensemble->case_list ); i++) {
+    if (ensemble->members[i] != NULL)
+      ecl_sum_free( ensemble->members[i] );
+  }
+
+#ifdef WITH_PTHREAD
+  pthread_mutex_destroy( &ensemble->mutex );
+#endif
+  vector_free( ensemble->smspec_list );
+  vector_free( ensemble->header_list );
+  stringlist_free( ensemble->case_list );
+  free( ensemble->members );
+  free( ensemble->key_join_string );
+  free( ensemble );
+}
+
+
+int ecl_sum_ensemble_get_size( const ecl_sum_ensemble_type * ensemble ) {
+  return stringlist_get_size( ensemble->case_list );
+}
+
+
+/**
+   The number of distinct SMSPEC headers which have been parsed while
+   loading the ensemble.
+*/
+
+int ecl_sum_ensemble_get_num_smspec( const ecl_sum_ensemble_type * ensemble ) {
+  return vector_get_size( ensemble->smspec_list );
+}
+
+
+const char * ecl_sum_ensemble_iget_case( const ecl_sum_ensemble_type * ensemble , int index ) {
+  return stringlist_iget( ensemble->case_list , index );
+}
+
+
+/**
+   Will return the ecl_sum instance loaded from case nr @index, or NULL
+   if that case could not be loaded. The ecl_sum instance is owned by
+   the ensemble.
+*/
+
+ecl_sum_type * ecl_sum_ensemble_iget( const ecl_sum_ensemble_type * ensemble , int index ) {
+  if ((index < 0) || (index >= stringlist_get_size( ensemble->case_list )))
+    util_abort("%s: invalid index:%d valid range: [0,%d) \n",__func__ , index , stringlist_get_size( ensemble->case_list ));
+
+  return ensemble->members[index];
+}
@@ -18,6 +18,7 @@
 
 #include <time.h>
 #include <math.h>
+#include <string.h>
 
 #include <ert/util/util.h>
 #include <ert/util/type_macros.h>
@@ -210,7 +211,14 @@ ecl_sum_tstep_type * ecl_sum_tstep_alloc_new( int report_step , int ministep , f
 
 
 
+static void ecl_sum_tstep_assert_data( const ecl_sum_tstep_type * ministep , const char * caller) {
+  if (ministep->data == NULL)
+    util_abort("%s: the data of ministep:%d has been moved to column storage in ecl_sum_data.\n",caller , ministep->ministep);
+}
+
+
 double ecl_sum_tstep_iget(const ecl_sum_tstep_type * ministep , int index) {
+  ecl_sum_tstep_assert_data( ministep , __func__ );
   if ((index >= 0) && (index < ministep->data_size))
     return ministep->data[index];
   else {
@@ -220,6 +228,33 @@ double ecl_sum_tstep_iget(const ecl_sum_tstep_type * ministep , int index) {
 }
 
 
+/*
+  Direct access to the PARAMS data of the tstep; used by ecl_sum_data
+  when building the column wise copy of the data. When ecl_sum_data
+  keeps the data in column storage the row data of the tstep is freed
+  with ecl_sum_tstep_free_data(), and the pointer returned from
+  ecl_sum_tstep_get_data_ptr() is NULL; ecl_sum_tstep_set_data() will
+  reinstate the row data.
+*/
+
+const float * ecl_sum_tstep_get_data_ptr(const ecl_sum_tstep_type * ministep) {
+  return ministep->data;
+}
+
+
+void ecl_sum_tstep_free_data( ecl_sum_tstep_type * ministep ) {
+  free( ministep->data );
+  ministep->data = NULL;
+}
+
+
+void ecl_sum_tstep_set_data( ecl_sum_tstep_type * ministep , const float * data ) {
+  if (ministep->data == NULL)
+    ministep->data = util_calloc( ministep->data_size , sizeof * ministep->data );
+  memcpy( ministep->data , data , ministep->data_size * sizeof * ministep->data );
+}
+
+
 time_t ecl_sum_tstep_get_sim_time(const ecl_sum_tstep_type * ministep) {
   return ministep->sim_time;
 }
@@ -241,7 +276,12 @@ int ecl_sum_tstep_get_ministep(const ecl_sum_tstep_type * ministep) {
 
 /*****************************************************************/
 
-void ecl_sum_tstep_fwrite( const ecl_sum_tstep_type * ministep , const int_vector_type * index_map , fortio_type * fortio) {
+/*
+  Will write the tstep with the PARAMS data given by @row_data; this
+  is used by ecl_sum_data when the data is in column storage.
+*/
+
+void ecl_sum_tstep_fwrite_row( const ecl_sum_tstep_type * ministep , const float * row_data , const int_vector_type * index_map , fortio_type * fortio) {
   {
     ecl_kw_type * ministep_kw = ecl_kw_alloc( MINISTEP_KW , 1 , ECL_INT_TYPE );
     ecl_kw_iset_int( ministep_kw , 0 , ministep->ministep );
@@ -259,7 +299,7 @@ void ecl_sum_tstep_fwrite( const ecl_sum_tstep_type * ministep , const int_vecto
     {
       int i;
       for (i=0; i < compact_size; i++)
-        data[i] = ministep->data[ index[i] ];
+        data[i] = row_data[ index[i] ];
     }
     ecl_kw_fwrite( params_kw , fortio );
     ecl_kw_free( params_kw );
@@ -267,9 +307,16 @@ void ecl_sum_tstep_fwrite( const ecl_sum_tstep_type * ministep , const int_vecto
 }
 
 
+void ecl_sum_tstep_fwrite( const ecl_sum_tstep_type * ministep , const int_vector_type * index_map , fortio_type * fortio) {
+  ecl_sum_tstep_assert_data( ministep , __func__ );
+  ecl_sum_tstep_fwrite_row( ministep , ministep->data , index_map , fortio );
+}
+
+
 /*****************************************************************/
 
 void ecl_sum_tstep_iset( ecl_sum_tstep_type * tstep , int index , float value) {
+  ecl_sum_tstep_assert_data( tstep , __func__ );
   if ((index < tstep->data_size) && (index >= 0))
     tstep->data[index] = value;
   else
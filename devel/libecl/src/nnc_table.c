@@ -0,0 +1,349 @@
+
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'nnc_table.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef WITH_PTHREAD
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#endif
+
+#include <ert/util/util.h>
+#include <ert/util/type_macros.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/nnc_table.h>
+
+/*
+  The nnc_table holds all the non neighbour connections originating
+  in the cells of one grid, i.e. the main grid or one LGR, in
+  compressed sparse row (CSR) format. The connections from cell
+  global_index1 are found at positions [offset[global_index1],
+  offset[global_index1 + 1]) of the lgr_nr, global_index and
+  nnc_index arrays; where lgr_nr and global_index identify the
+  connected cell and nnc_index is the position of the connection in
+  the NNC1/NNC2, NNCG/NNCL or NNA1/NNA2 keywords - and thereby in the
+  corresponding TRANNNC, TRANGL or TRANLL keyword of the INIT file.
+
+  The table is filled with nnc_table_add_nnc() while the grid file is
+  loaded, and then compressed with nnc_table_build(). Within a cell
+  the connections retain the order in which they were added.
+*/
+
+#define NNC_TABLE_TYPE_ID 871356079
+
+/* Tables with fewer connections than this are built by one thread. */
+#define NNC_TABLE_MT_MIN_SIZE 100000
+
+
+struct nnc_table_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int               lgr_nr;         /* The lgr_nr of the grid holding this table. */
+  int               num_cells;
+  int               size;
+
+  int_vector_type * add_global_index1;  /* The add_xxx vectors are only used before nnc_table_build(). */
+  int_vector_type * add_lgr_nr;
+  int_vector_type * add_global_index2;
+  int_vector_type * add_nnc_index;
+
+  int             * offset;         /* num_cells + 1 elements; NULL before nnc_table_build(). */
+  int             * lgr_nr2;
+  int             * global_index2;
+  int             * nnc_index;
+  int_vector_type * lgr_list;       /* Sorted list of the distinct lgr_nr2 values. */
+};
+
+
+typedef struct {
+  const int * global_index1;
+  const int * lgr_nr2;
+  const int * global_index2;
+  const int * nnc_index;
+  int         input_size;
+  int         cell1;                /* This job handles the cells in [cell1, cell2). */
+  int         cell2;
+  nnc_table_type * nnc_table;
+} nnc_table_job_type;
+
+
+UTIL_IS_INSTANCE_FUNCTION( nnc_table , NNC_TABLE_TYPE_ID )
+
+
+nnc_table_type * nnc_table_alloc( int lgr_nr , int num_cells ) {
+  nnc_table_type * nnc_table = util_malloc( sizeof * nnc_table );
+  UTIL_TYPE_ID_INIT( nnc_table , NNC_TABLE_TYPE_ID );
+  nnc_table->lgr_nr    = lgr_nr;
+  nnc_table->num_cells = num_cells;
+  nnc_table->size      = 0;
+
+  nnc_table->add_global_index1 = int_vector_alloc( 0 , 0 );
+  nnc_table->add_lgr_nr        = int_vector_alloc( 0 , 0 );
+  nnc_table->add_global_index2 = int_vector_alloc( 0 , 0 );
+  nnc_table->add_nnc_index     = int_vector_alloc( 0 , 0 );
+
+  nnc_table->offset        = NULL;
+  nnc_table->lgr_nr2       = NULL;
+  nnc_table->global_index2 = NULL;
+  nnc_table->nnc_index     = NULL;
+  nnc_table->lgr_list      = int_vector_alloc( 0 , 0 );
+  return nnc_table;
+}
+
+
+static void nnc_table_free_input( nnc_table_type * nnc_table ) {
+  if (nnc_table->add_global_index1 != NULL) {
+    int_vector_free( nnc_table->add_global_index1 );
+    int_vector_free( nnc_table->add_lgr_nr );
+    int_vector_free( nnc_table->add_global_index2 );
+    int_vector_free( nnc_table->add_nnc_index );
+
+    nnc_table->add_global_index1 = NULL;
+    nnc_table->add_lgr_nr        = NULL;
+    nnc_table->add_global_index2 = NULL;
+    nnc_table->add_nnc_index     = NULL;
+  }
+}
+
+
+void nnc_table_free( nnc_table_type * nnc_table ) {
+  nnc_table_free_input( nnc_table );
+  util_safe_free( nnc_table->offset );
+  util_safe_free( nnc_table->lgr_nr2 );
+  util_safe_free( nnc_table->global_index2 );
+  util_safe_free( nnc_table->nnc_index );
+  int_vector_free( nnc_table->lgr_list );
+  free( nnc_table );
+}
+
+
+bool nnc_table_is_built( const nnc_table_type * nnc_table ) {
+  return (nnc_table->offset != NULL);
+}
+
+
+static void nnc_table_assert_built( const nnc_table_type * nnc_table ) {
+  if (!nnc_table_is_built( nnc_table ))
+    util_abort("%s: must call nnc_table_build() first \n",__func__);
+}
+
+
+void nnc_table_add_nnc( nnc_table_type * nnc_table , int global_index1 , int lgr_nr2 , int global_index2 , int nnc_index) {
+  if (nnc_table_is_built( nnc_table ))
+    util_abort("%s: can not add connections after nnc_table_build() \n",__func__);
+
+  if ((global_index1 < 0) || (global_index1 >= nnc_table->num_cells))
+    util_abort("%s: invalid cell index:%d - valid range: [0,%d) \n",__func__ , global_index1 , nnc_table->num_cells);
+
+  int_vector_append( nnc_table->add_global_index1 , global_index1 );
+  int_vector_append( nnc_table->add_lgr_nr , lgr_nr2 );
+  int_vector_append( nnc_table->add_global_index2 , global_index2 );
+  int_vector_append( nnc_table->add_nnc_index , nnc_index );
+}
+
+
+/*
+  The build is a counting sort on global_index1. The cells are split
+  in contiguous ranges, one for each job, and every job scans the full
+  input and only counts/copies the connections originating in its own
+  range of cells; i.e. the jobs never write to the same locations and
+  the input order is retained within each cell.
+*/
+
+static void nnc_table_count_cells( nnc_table_job_type * job ) {
+  int * count = &job->nnc_table->offset[1];
+  int index;
+
+  for (index = 0; index < job->input_size; index++) {
+    int global_index1 = job->global_index1[index];
+    if ((global_index1 >= job->cell1) && (global_index1 < job->cell2))
+      count[ global_index1 ]++;
+  }
+}
+
+
+static void nnc_table_fill_cells( nnc_table_job_type * job ) {
+  nnc_table_type * nnc_table = job->nnc_table;
+  int * cursor = util_alloc_copy( &nnc_table->offset[ job->cell1 ] , (job->cell2 - job->cell1) * sizeof * cursor );
+  int index;
+
+  for (index = 0; index < job->input_size; index++) {
+    int global_index1 = job->global_index1[index];
+    if ((global_index1 >= job->cell1) && (global_index1 < job->cell2)) {
+      int pos = cursor[ global_index1 - job->cell1 ]++;
+
+      nnc_table->lgr_nr2[pos]       = job->lgr_nr2[index];
+      nnc_table->global_index2[pos] = job->global_index2[index];
+      nnc_table->nnc_index[pos]     = job->nnc_index[index];
+    }
+  }
+  free( cursor );
+}
+
+
+#ifdef WITH_PTHREAD
+static void * nnc_table_count_cells__( void * arg ) {
+  nnc_table_count_cells( arg );
+  return NULL;
+}
+
+
+static void * nnc_table_fill_cells__( void * arg ) {
+  nnc_table_fill_cells( arg );
+  return NULL;
+}
+
+
+static void nnc_table_run_jobs( nnc_table_job_type * job_list , int num_jobs , void * (func) (void *)) {
+  thread_pool_type * tp = thread_pool_alloc( num_jobs , true );
+  int job_nr;
+
+  for (job_nr = 0; job_nr < num_jobs; job_nr++)
+    thread_pool_add_job( tp , func , &job_list[ job_nr ] );
+
+  thread_pool_join( tp );
+  thread_pool_free( tp );
+}
+#endif
+
+
+void nnc_table_build( nnc_table_type * nnc_table ) {
+  if (nnc_table_is_built( nnc_table ))
+    return;
+  {
+    int num_cells = nnc_table->num_cells;
+    int size = int_vector_size( nnc_table->add_global_index1 );
+    int num_jobs = 1;
+    nnc_table_job_type * job_list;
+
+#ifdef WITH_PTHREAD
+    if (size >= NNC_TABLE_MT_MIN_SIZE)
+      num_jobs = util_int_max( 1 , util_int_min( num_cells , sysconf( _SC_NPROCESSORS_ONLN )));
+#endif
+
+    nnc_table->size          = size;
+    nnc_table->offset        = util_calloc( num_cells + 1 , sizeof * nnc_table->offset );
+    nnc_table->lgr_nr2       = util_calloc( size , sizeof * nnc_table->lgr_nr2 );
+    nnc_table->global_index2 = util_calloc( size , sizeof * nnc_table->global_index2 );
+    nnc_table->nnc_index     = util_calloc( size , sizeof * nnc_table->nnc_index );
+    memset( nnc_table->offset , 0 , (num_cells + 1) * sizeof * nnc_table->offset );
+
+    job_list = util_calloc( num_jobs , sizeof * job_list );
+    {
+      int job_nr;
+      for (job_nr = 0; job_nr < num_jobs; job_nr++) {
+        nnc_table_job_type * job = &job_list[ job_nr ];
+
+        job->global_index1 = int_vector_get_const_ptr( nnc_table->add_global_index1 );
+        job->lgr_nr2       = int_vector_get_const_ptr( nnc_table->add_lgr_nr );
+        job->global_index2 = int_vector_get_const_ptr( nnc_table->add_global_index2 );
+        job->nnc_index     = int_vector_get_const_ptr( nnc_table->add_nnc_index );
+        job->input_size    = size;
+        job->cell1         = (int) (((long) job_nr * num_cells) / num_jobs);
+        job->cell2         = (int) (((long) (job_nr + 1) * num_cells) / num_jobs);
+        job->nnc_table     = nnc_table;
+      }
+    }
+
+#ifdef WITH_PTHREAD
+    if (num_jobs > 1)
+      nnc_table_run_jobs( job_list , num_jobs , nnc_table_count_cells__ );
+    else
+#endif
+      nnc_table_count_cells( &job_list[0] );
+
+    {
+      int global_index1;
+      for (global_index1 = 0; global_index1 < num_cells; global_index1++)
+        nnc_table->offset[ global_index1 + 1 ] += nnc_table->offset[ global_index1 ];
+    }
+
+#ifdef WITH_PTHREAD
+    if (num_jobs > 1)
+      nnc_table_run_jobs( job_list , num_jobs , nnc_table_fill_cells__ );
+    else
+#endif
+      nnc_table_fill_cells( &job_list[0] );
+
+    free( job_list );
+
+    if (size > 0) {
+      int_vector_select_unique( nnc_table->add_lgr_nr );
+      int_vector_memcpy( nnc_table->lgr_list , nnc_table->add_lgr_nr );
+    }
+    nnc_table_free_input( nnc_table );
+  }
+}
+
+
+int nnc_table_get_lgr_nr( const nnc_table_type * nnc_table ) {
+  return nnc_table->lgr_nr;
+}
+
+
+int nnc_table_get_num_cells( const nnc_table_type * nnc_table ) {
+  return nnc_table->num_cells;
+}
+
+
+/*
+  The total number of connections in the table.
+*/
+
+int nnc_table_get_size( const nnc_table_type * nnc_table ) {
+  if (nnc_table_is_built( nnc_table ))
+    return nnc_table->size;
+  else
+    return int_vector_size( nnc_table->add_global_index1 );
+}
+
+
+const int_vector_type * nnc_table_get_lgr_list( const nnc_table_type * nnc_table ) {
+  nnc_table_assert_built( nnc_table );
+  return nnc_table->lgr_list;
+}
+
+
+int nnc_table_get_cell_offset( const nnc_table_type * nnc_table , int global_index1 ) {
+  nnc_table_assert_built( nnc_table );
+  return nnc_table->offset[ global_index1 ];
+}
+
+
+int nnc_table_get_cell_size( const nnc_table_type * nnc_table , int global_index1 ) {
+  nnc_table_assert_built( nnc_table );
+  return nnc_table->offset[ global_index1 + 1 ] - nnc_table->offset[ global_index1 ];
+}
+
+
+int nnc_table_iget_lgr_nr( const nnc_table_type * nnc_table , int index ) {
+  return nnc_table->lgr_nr2[ index ];
+}
+
+
+int nnc_table_iget_global_index( const nnc_table_type * nnc_table , int index ) {
+  return nnc_table->global_index2[ index ];
+}
+
+
+int nnc_table_iget_nnc_index( const nnc_table_type * nnc_table , int index ) {
+  return nnc_table->nnc_index[ index ];
+}
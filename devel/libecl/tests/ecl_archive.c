@@ -0,0 +1,257 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_archive.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_archive.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+
+#define NUM_STEPS   10
+#define BLOCK_SIZE  1000
+#define PRESSURE_SIZE 2500   /* Spans several blocks of BLOCK_SIZE bytes. */
+
+
+ecl_kw_type * alloc_seqnum( int step ) {
+  ecl_kw_type * seqnum_kw = ecl_kw_alloc( SEQNUM_KW , 1 , ECL_INT_TYPE );
+  ecl_kw_iset_int( seqnum_kw , 0 , step );
+  return seqnum_kw;
+}
+
+
+ecl_kw_type * alloc_pressure( int step ) {
+  ecl_kw_type * pressure_kw = ecl_kw_alloc( "PRESSURE" , PRESSURE_SIZE , ECL_FLOAT_TYPE );
+  int i;
+  for (i=0; i < PRESSURE_SIZE; i++)
+    ecl_kw_iset_float( pressure_kw , i , 100 + step + (i % 17) * 0.25 );
+  return pressure_kw;
+}
+
+
+ecl_kw_type * alloc_zwel( ) {
+  ecl_kw_type * zwel_kw = ecl_kw_alloc( ZWEL_KW , 3 , ECL_CHAR_TYPE );
+  ecl_kw_iset_string8( zwel_kw , 0 , "OP_1" );
+  ecl_kw_iset_string8( zwel_kw , 1 , "OP_2" );
+  ecl_kw_iset_string8( zwel_kw , 2 , "WI_1" );
+  return zwel_kw;
+}
+
+
+void add_step( ecl_archive_type * archive , int step ) {
+  ecl_kw_type * seqnum_kw   = alloc_seqnum( step );
+  ecl_kw_type * pressure_kw = alloc_pressure( step );
+  ecl_kw_type * zwel_kw     = alloc_zwel( );
+  ecl_kw_type * empty_kw    = ecl_kw_alloc( "EMPTY" , 0 , ECL_DOUBLE_TYPE );
+
+  ecl_archive_add_kw( archive , seqnum_kw );
+  ecl_archive_add_kw( archive , pressure_kw );
+  ecl_archive_add_kw( archive , zwel_kw );
+  ecl_archive_add_kw( archive , empty_kw );
+
+  ecl_kw_free( seqnum_kw );
+  ecl_kw_free( pressure_kw );
+  ecl_kw_free( zwel_kw );
+  ecl_kw_free( empty_kw );
+}
+
+
+void create_archive( const char * filename , int num_threads ) {
+  ecl_archive_type * archive = ecl_archive_alloc_writer( filename , BLOCK_SIZE , num_threads );
+  int step;
+  
+  test_assert_true( ecl_archive_is_instance( archive ));
+  for (step = 0; step < NUM_STEPS; step++)
+    add_step( archive , step );
+  
+  ecl_archive_close( archive );
+}
+
+
+void test_archive( const char * filename , int num_threads ) {
+  ecl_archive_type * archive = ecl_archive_open( filename );
+  int step;
+
+  test_assert_not_NULL( archive );
+  ecl_archive_set_num_threads( archive , num_threads );
+  test_assert_int_equal( ecl_archive_get_size( archive ) , 4 * NUM_STEPS );
+  test_assert_int_equal( ecl_archive_get_block_size( archive ) , BLOCK_SIZE );
+  test_assert_int_equal( ecl_archive_get_num_blocks( archive ) , NUM_STEPS * (1 + 10 + 1) );
+  test_assert_true( ecl_archive_get_compressed_size( archive ) < ecl_archive_get_data_size( archive ));
+  test_assert_true( ecl_archive_verify( archive ));
+
+  /* Reading in reverse order. */
+  for (step = NUM_STEPS - 1; step >= 0; step--) {
+    ecl_kw_type * pressure_kw = alloc_pressure( step );
+    ecl_kw_type * zwel_kw = alloc_zwel( );
+    ecl_kw_type * archive_kw;
+
+    archive_kw = ecl_archive_iget_kw( archive , 4*step + 1 );
+    test_assert_true( ecl_kw_equal( archive_kw , pressure_kw ));
+    ecl_kw_free( archive_kw );
+
+    archive_kw = ecl_archive_iget_kw( archive , 4*step + 2 );
+    test_assert_true( ecl_kw_equal( archive_kw , zwel_kw ));
+    ecl_kw_free( archive_kw );
+
+    archive_kw = ecl_archive_iget_kw( archive , 4*step + 3 );
+    test_assert_int_equal( ecl_kw_get_size( archive_kw ) , 0 );
+    test_assert_string_equal( ecl_kw_get_header( archive_kw ) , "EMPTY" );
+    ecl_kw_free( archive_kw );
+
+    ecl_kw_free( pressure_kw );
+    ecl_kw_free( zwel_kw );
+  }
+  ecl_archive_close( archive );
+}
+
+
+void test_ecl_file( const char * filename ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
+  int step;
+
+  test_assert_string_equal( ecl_file_get_src_file( ecl_file ) , filename );
+  test_assert_int_equal( ecl_file_get_size( ecl_file ) , 4 * NUM_STEPS );
+  test_assert_int_equal( ecl_file_get_num_named_kw( ecl_file , "PRESSURE" ) , NUM_STEPS );
+  test_assert_int_equal( ecl_file_iget_named_size( ecl_file , "PRESSURE" , 3 ) , PRESSURE_SIZE );
+
+  for (step = NUM_STEPS - 1; step >= 0; step--) {
+    ecl_kw_type * pressure_kw = alloc_pressure( step );
+
+    test_assert_true( ecl_file_has_report_step( ecl_file , step ));
+    test_assert_true( ecl_file_select_rstblock_report_step( ecl_file , step ));
+    test_assert_int_equal( ecl_file_get_size( ecl_file ) , 4 );
+    test_assert_true( ecl_kw_equal( ecl_file_iget_named_kw( ecl_file , "PRESSURE" , 0 ) , pressure_kw ));
+    ecl_file_select_global( ecl_file );
+    
+    ecl_kw_free( pressure_kw );
+  }
+  test_assert_true( ecl_file_load_all( ecl_file ));
+  ecl_file_fortio_detach( ecl_file );
+  test_assert_int_equal( ecl_kw_iget_int( ecl_file_iget_named_kw( ecl_file , SEQNUM_KW , 5 ) , 0 ) , 5 );
+  ecl_file_close( ecl_file );
+}
+
+
+void test_corrupt( const char * filename ) {
+  ecl_archive_type * archive;
+  {
+    FILE * stream = util_fopen( filename , "r+");
+    unsigned char c;
+    
+    fseek( stream , 200 , SEEK_SET );
+    test_assert_int_equal( fread( &c , 1 , 1 , stream ) , 1 );
+    c = ~c;
+    fseek( stream , 200 , SEEK_SET );
+    fwrite( &c , 1 , 1 , stream );
+    fclose( stream );
+  }
+  archive = ecl_archive_open( filename );
+  test_assert_not_NULL( archive );
+  test_assert_false( ecl_archive_verify( archive ));
+  ecl_archive_close( archive );
+}
+
+
+void modify_file( const char * src_file , const char * target_file , long offset , const void * data , size_t size ) {
+  FILE * stream;
+  util_copy_file( src_file , target_file );
+  stream = util_fopen( target_file , "r+");
+  fseek( stream , offset , SEEK_SET );
+  fwrite( data , 1 , size , stream );
+  fclose( stream );
+}
+
+
+/*
+  The index is checked when the archive is opened; an archive where
+  the index is damaged, or does not fit the file, is not opened.
+*/
+
+void test_corrupt_index( const char * filename ) {
+  long file_size = util_file_size( filename );
+  
+  {
+    unsigned char c = 0xFF;
+    modify_file( filename , "INDEX.ecla" , file_size - 20 , &c , 1 );
+    test_assert_NULL( ecl_archive_open( "INDEX.ecla" ));
+  }
+  {
+    FILE * stream;
+    util_copy_file( filename , "TRUNCATED.ecla" );
+    stream = util_fopen( "TRUNCATED.ecla" , "r+");
+    test_assert_int_equal( ftruncate( fileno( stream ) , file_size - 1 ) , 0 );
+    fclose( stream );
+    test_assert_NULL( ecl_archive_open( "TRUNCATED.ecla" ));
+  }
+  /* The header is not covered by the index checksum. */
+  {
+    int block_size = BLOCK_SIZE / 2;
+    modify_file( filename , "BLOCK_SIZE.ecla" , 2 * sizeof(int) , &block_size , sizeof block_size );
+    test_assert_NULL( ecl_archive_open( "BLOCK_SIZE.ecla" ));
+
+    block_size = 2 * BLOCK_SIZE;
+    modify_file( filename , "BLOCK_SIZE.ecla" , 2 * sizeof(int) , &block_size , sizeof block_size );
+    test_assert_NULL( ecl_archive_open( "BLOCK_SIZE.ecla" ));
+  }
+  {
+    offset_type index_offset = 3 * sizeof(int) + sizeof(offset_type);
+    modify_file( filename , "OFFSET.ecla" , 3 * sizeof(int) , &index_offset , sizeof index_offset );
+    test_assert_NULL( ecl_archive_open( "OFFSET.ecla" ));
+  }
+}
+
+
+void test_not_archive( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  ecl_kw_type * seqnum_kw = alloc_seqnum( 0 );
+  ecl_kw_fwrite( seqnum_kw , fortio );
+  ecl_kw_free( seqnum_kw );
+  fortio_fclose( fortio );
+  
+  test_assert_false( ecl_archive_is_archive( filename ));
+  test_assert_NULL( ecl_archive_open( filename ));
+  test_assert_false( ecl_archive_is_archive( "does/not/exist" ));
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_archive");
+  
+  create_archive( "TEST1.UNRST.ecla" , 1 );
+  create_archive( "TEST4.UNRST.ecla" , 4 );
+  test_assert_true( util_files_equal( "TEST1.UNRST.ecla" , "TEST4.UNRST.ecla" ));
+
+  test_archive( "TEST1.UNRST.ecla" , 1 );
+  test_archive( "TEST1.UNRST.ecla" , 4 );
+  test_ecl_file( "TEST1.UNRST.ecla" );
+
+  test_corrupt_index( "TEST1.UNRST.ecla" );
+  test_corrupt( "TEST4.UNRST.ecla" );
+  test_not_archive( "TEST.UNRST" );
+  test_work_area_free( work_area );
+  exit(0);
+}
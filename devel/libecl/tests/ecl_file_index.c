@@ -0,0 +1,142 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_file_index.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <utime.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+
+
+void write_kw( fortio_type * fortio , const char * header , int size ) {
+  ecl_kw_type * ecl_kw = ecl_kw_alloc( header , size , ECL_FLOAT_TYPE );
+  int i;
+  for (i=0; i < size; i++)
+    ecl_kw_iset_float( ecl_kw , i , i * 0.25 );
+
+  ecl_kw_fwrite( ecl_kw , fortio );
+  ecl_kw_free( ecl_kw );
+}
+
+
+void create_file( const char * filename , int num_steps ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  int step;
+
+  for (step = 0; step < num_steps; step++) {
+    ecl_kw_type * seqnum_kw = ecl_kw_alloc( "SEQNUM" , 1 , ECL_INT_TYPE );
+    ecl_kw_iset_int( seqnum_kw , 0 , step );
+    ecl_kw_fwrite( seqnum_kw , fortio );
+    ecl_kw_free( seqnum_kw );
+
+    write_kw( fortio , "PRESSURE" , 1000 + step );
+    write_kw( fortio , "SWAT" , 1000 );
+  }
+  fortio_fclose( fortio );
+}
+
+
+void set_mtime( const char * filename , time_t mtime ) {
+  struct utimbuf times;
+  times.actime = mtime;
+  times.modtime = mtime;
+  utime( filename , &times );
+}
+
+
+void test_equal( const char * filename ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
+  ecl_file_type * index_file = ecl_file_open( filename , ECL_FILE_USE_INDEX );
+  int i;
+
+  test_assert_int_equal( ecl_file_get_size( ecl_file ) , ecl_file_get_size( index_file ));
+  test_assert_int_equal( ecl_file_get_num_distinct_kw( ecl_file ) , ecl_file_get_num_distinct_kw( index_file ));
+  test_assert_int_equal( ecl_file_get_num_named_kw( ecl_file , "SEQNUM" ) , ecl_file_get_num_named_kw( index_file , "SEQNUM" ));
+  for (i=0; i < ecl_file_get_size( ecl_file ); i++)
+    test_assert_true( ecl_kw_equal( ecl_file_iget_kw( ecl_file , i ) , ecl_file_iget_kw( index_file , i )));
+
+  ecl_file_close( ecl_file );
+  ecl_file_close( index_file );
+}
+
+
+/*
+  The clone shares the index of the source file; the block selection
+  of the two instances is independent.
+*/
+
+void test_clone( const char * filename ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , ECL_FILE_CLOSE_STREAM );
+  ecl_file_type * clone = ecl_file_open_clone( ecl_file );
+  int i;
+
+  test_assert_int_equal( ecl_file_get_size( ecl_file ) , ecl_file_get_size( clone ));
+  test_assert_int_equal( ecl_file_get_flags( ecl_file ) , ecl_file_get_flags( clone ));
+  
+  test_assert_true( ecl_file_select_block( clone , "SEQNUM" , 3 ));
+  test_assert_int_equal( ecl_kw_iget_int( ecl_file_iget_named_kw( clone , "SEQNUM" , 0 ) , 0 ) , 3 );
+  test_assert_int_equal( ecl_file_get_num_named_kw( ecl_file , "SEQNUM" ) , 20 );
+  ecl_file_select_global( clone );
+  
+  for (i=0; i < ecl_file_get_size( ecl_file ); i++)
+    test_assert_true( ecl_kw_equal( ecl_file_iget_kw( ecl_file , i ) , ecl_file_iget_kw( clone , i )));
+
+  ecl_file_close( ecl_file );
+  ecl_file_close( clone );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_file_index");
+  const char * filename = "TEST.UNRST";
+  const char * index_file = "TEST.UNRST.idx";
+
+  create_file( filename , 10 );
+  test_equal( filename );
+  test_assert_true( util_file_exists( index_file ));
+
+  /* Valid index - the index file should not be rewritten. */
+  set_mtime( index_file , 1000 );
+  test_equal( filename );
+  test_assert_true( util_file_mtime( index_file ) == 1000 );
+
+  /* The file has changed - the index should be rebuilt. */
+  create_file( filename , 20 );
+  test_equal( filename );
+  test_assert_true( util_file_mtime( index_file ) != 1000 );
+
+  /* Corrupt index file. */
+  {
+    FILE * stream = util_fopen( index_file , "w");
+    fprintf(stream , "XX");
+    fclose( stream );
+  }
+  test_equal( filename );
+  test_assert_true( util_file_size( index_file ) > 2 );
+
+  test_clone( filename );
+
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,171 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_file_prefetch.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/long_vector.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_prefetch.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+
+
+void create_file( const char * filename , int num_steps ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  int step;
+
+  for (step = 0; step < num_steps; step++) {
+    ecl_kw_type * seqnum_kw = ecl_kw_alloc( "SEQNUM" , 1 , ECL_INT_TYPE );
+    ecl_kw_type * pressure_kw = ecl_kw_alloc( "PRESSURE" , 10000 , ECL_FLOAT_TYPE );
+    ecl_kw_type * swat_kw = ecl_kw_alloc( "SWAT" , 10000 , ECL_DOUBLE_TYPE );
+    int i;
+
+    ecl_kw_iset_int( seqnum_kw , 0 , step );
+    for (i=0; i < 10000; i++) {
+      ecl_kw_iset_float( pressure_kw , i , step + i * 0.25 );
+      ecl_kw_iset_double( swat_kw , i , step + i * 0.125 );
+    }
+
+    ecl_kw_fwrite( seqnum_kw , fortio );
+    ecl_kw_fwrite( pressure_kw , fortio );
+    ecl_kw_fwrite( swat_kw , fortio );
+
+    ecl_kw_free( seqnum_kw );
+    ecl_kw_free( pressure_kw );
+    ecl_kw_free( swat_kw );
+  }
+  fortio_fclose( fortio );
+}
+
+
+void test_sequential( const char * filename ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
+  ecl_file_type * prefetch_file = ecl_file_open( filename , ECL_FILE_PREFETCH );
+  ecl_kw_prefetch_type * prefetch = ecl_file_get_prefetch( prefetch_file );
+  int i;
+
+  test_assert_NULL( ecl_file_get_prefetch( ecl_file ));
+  test_assert_true( ecl_kw_prefetch_is_instance( prefetch ));
+
+  /* The whole file fits in the prefetch buffer; wait for it to be read. */
+  ecl_kw_prefetch_wait_idle( prefetch );
+  test_assert_false( ecl_kw_prefetch_stream_is_open( prefetch ));
+  test_assert_int_equal( ecl_kw_prefetch_get_prefetch_bytes( prefetch ) , 20 * (4 + 10000 * 4 + 10000 * 8));
+  test_assert_int_equal( ecl_file_get_size( ecl_file ) , ecl_file_get_size( prefetch_file ));
+  for (i=0; i < ecl_file_get_size( ecl_file ); i++)
+    test_assert_true( ecl_kw_equal( ecl_file_iget_kw( ecl_file , i ) , ecl_file_iget_kw( prefetch_file , i )));
+
+  test_assert_int_equal( ecl_kw_prefetch_get_hits( prefetch ) + ecl_kw_prefetch_get_misses( prefetch ) , ecl_file_get_size( ecl_file ));
+  test_assert_int_equal( ecl_kw_prefetch_get_hits( prefetch ) , ecl_file_get_size( ecl_file ));
+  test_assert_true( ecl_kw_prefetch_get_prefetch_bytes( prefetch ) > 0 );
+  test_assert_true( ecl_kw_prefetch_get_hit_rate( prefetch ) > 0 );
+
+  ecl_file_close( ecl_file );
+  ecl_file_close( prefetch_file );
+}
+
+
+void test_random_access( const char * filename ) {
+  ecl_file_type * prefetch_file = ecl_file_open( filename , ECL_FILE_PREFETCH );
+  ecl_kw_type * swat_kw = ecl_file_iget_named_kw( prefetch_file , "SWAT" , 5 );
+  ecl_kw_type * pressure_kw = ecl_file_iget_named_kw( prefetch_file , "PRESSURE" , 2 );
+
+  test_assert_double_equal( ecl_kw_iget_double( swat_kw , 8 ) , 6 );
+  test_assert_double_equal( ecl_kw_iget_float( pressure_kw , 4 ) , 3 );
+
+  ecl_file_select_block( prefetch_file , "SEQNUM" , 7 );
+  test_assert_int_equal( ecl_kw_iget_int( ecl_file_iget_named_kw( prefetch_file , "SEQNUM" , 0 ) , 0 ) , 7 );
+  test_assert_double_equal( ecl_kw_iget_double( ecl_file_iget_named_kw( prefetch_file , "SWAT" , 0 ) , 8 ) , 8 );
+  ecl_file_select_global( prefetch_file );
+
+  test_assert_true( ecl_file_load_all( prefetch_file ));
+  ecl_file_fortio_detach( prefetch_file );
+  test_assert_double_equal( ecl_kw_iget_double( ecl_file_iget_named_kw( prefetch_file , "SWAT" , 19 ) , 0 ) , 19 );
+  ecl_file_close( prefetch_file );
+}
+
+
+void test_close_stream( const char * filename ) {
+  ecl_file_type * prefetch_file = ecl_file_open( filename , ECL_FILE_PREFETCH + ECL_FILE_CLOSE_STREAM );
+  ecl_kw_prefetch_type * prefetch = ecl_file_get_prefetch( prefetch_file );
+
+  ecl_kw_prefetch_wait_idle( prefetch );
+  test_assert_false( ecl_kw_prefetch_stream_is_open( prefetch ));
+  test_assert_double_equal( ecl_kw_iget_double( ecl_file_iget_named_kw( prefetch_file , "SWAT" , 3 ) , 8 ) , 4 );
+  test_assert_int_equal( ecl_kw_prefetch_get_hits( prefetch ) , 1 );
+  ecl_file_close( prefetch_file );
+}
+
+
+void test_full_buffer( const char * filename ) {
+  long_vector_type * offset_list = long_vector_alloc( 0 , 0 );
+  {
+    fortio_type * fortio = fortio_open_reader( filename , false , ECL_ENDIAN_FLIP );
+    int i;
+    for (i=0; i < 3; i++) {
+      long_vector_append( offset_list , fortio_ftell( fortio ));
+      ecl_kw_free( ecl_kw_fread_alloc( fortio ));
+    }
+    fortio_fclose( fortio );
+  }
+
+  {
+    ecl_kw_prefetch_type * prefetch = ecl_kw_prefetch_alloc( filename , false , true , offset_list , 1 );
+    ecl_kw_type * ecl_kw;
+    int i;
+
+    for (i=0; i < long_vector_size( offset_list ); i++) {
+      ecl_kw_prefetch_wait_idle( prefetch );
+      test_assert_false( ecl_kw_prefetch_stream_is_open( prefetch ));
+      test_assert_int_equal( ecl_kw_prefetch_get_hits( prefetch ) , i );
+
+      ecl_kw = ecl_kw_prefetch_get_kw( prefetch , long_vector_iget( offset_list , i ));
+      test_assert_not_NULL( ecl_kw );
+      ecl_kw_free( ecl_kw );
+    }
+    ecl_kw_prefetch_free( prefetch );
+  }
+  long_vector_free( offset_list );
+}
+
+
+void test_close_early( const char * filename ) {
+  ecl_file_type * prefetch_file = ecl_file_open( filename , ECL_FILE_PREFETCH );
+  ecl_file_close( prefetch_file );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_file_prefetch");
+  const char * filename = "TEST.UNRST";
+
+  create_file( filename , 20 );
+  test_sequential( filename );
+  test_random_access( filename );
+  test_close_stream( filename );
+  test_full_buffer( filename );
+  test_close_early( filename );
+
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,183 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_file_rstblock.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+
+#define NUM_BLOCKS 50
+#define NUM_LGR     2
+
+
+int block_report_step( int block ) {
+  return 5 * block;
+}
+
+
+time_t block_sim_time( int block ) {
+  return util_make_date( 1 , 1 + (block % 12) , 2000 + block / 12 );
+}
+
+
+double block_sim_days( int block ) {
+  return 30.5 * block;
+}
+
+
+void write_intehead( fortio_type * fortio , time_t sim_time ) {
+  ecl_kw_type * intehead_kw = ecl_kw_alloc( INTEHEAD_KW , INTEHEAD_RESTART_SIZE , ECL_INT_TYPE );
+  int mday , month , year;
+  int i;
+
+  util_set_date_values( sim_time , &mday , &month , &year );
+  for (i=0; i < INTEHEAD_RESTART_SIZE; i++)
+    ecl_kw_iset_int( intehead_kw , i , 0 );
+  ecl_kw_iset_int( intehead_kw , INTEHEAD_DAY_INDEX , mday );
+  ecl_kw_iset_int( intehead_kw , INTEHEAD_MONTH_INDEX , month );
+  ecl_kw_iset_int( intehead_kw , INTEHEAD_YEAR_INDEX , year );
+  ecl_kw_fwrite( intehead_kw , fortio );
+  ecl_kw_free( intehead_kw );
+}
+
+
+/*
+  Every block has one INTEHEAD for the global grid and one for each
+  LGR, i.e. INTEHEAD occurence number != block number.
+*/
+
+void create_file( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  int block;
+
+  for (block = 0; block < NUM_BLOCKS; block++) {
+    {
+      ecl_kw_type * seqnum_kw = ecl_kw_alloc( SEQNUM_KW , 1 , ECL_INT_TYPE );
+      ecl_kw_iset_int( seqnum_kw , 0 , block_report_step( block ));
+      ecl_kw_fwrite( seqnum_kw , fortio );
+      ecl_kw_free( seqnum_kw );
+    }
+    write_intehead( fortio , block_sim_time( block ));
+    {
+      ecl_kw_type * doubhead_kw = ecl_kw_alloc( DOUBHEAD_KW , 1 , ECL_DOUBLE_TYPE );
+      ecl_kw_iset_double( doubhead_kw , DOUBHEAD_DAYS_INDEX , block_sim_days( block ));
+      ecl_kw_fwrite( doubhead_kw , fortio );
+      ecl_kw_free( doubhead_kw );
+    }
+    {
+      int lgr;
+      for (lgr = 0; lgr < NUM_LGR; lgr++)
+        write_intehead( fortio , block_sim_time( block ));
+    }
+  }
+  fortio_fclose( fortio );
+}
+
+
+void test_rstblock( const char * filename , int flags ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , flags );
+  int block;
+
+  for (block = 0; block < NUM_BLOCKS; block++) {
+    test_assert_true( ecl_file_has_report_step( ecl_file , block_report_step( block )));
+    test_assert_false( ecl_file_has_report_step( ecl_file , block_report_step( block ) + 1));
+    test_assert_true( ecl_file_has_sim_time( ecl_file , block_sim_time( block )));
+    test_assert_int_equal( ecl_file_get_restart_index( ecl_file , block_sim_time( block )) , block * (NUM_LGR + 1));
+    test_assert_true( ecl_file_iget_restart_sim_date( ecl_file , block ) == block_sim_time( block ));
+    test_assert_double_equal( ecl_file_iget_restart_sim_days( ecl_file , block ) , block_sim_days( block ));
+  }
+  test_assert_false( ecl_file_has_sim_time( ecl_file , block_sim_time( NUM_BLOCKS )));
+  test_assert_int_equal( ecl_file_get_restart_index( ecl_file , block_sim_time( NUM_BLOCKS )) , -1 );
+  test_assert_true( ecl_file_iget_restart_sim_date( ecl_file , NUM_BLOCKS ) == -1 );
+
+  /* Selecting blocks in reverse order. */
+  for (block = NUM_BLOCKS - 1; block >= 0; block--) {
+    test_assert_true( ecl_file_select_rstblock_report_step( ecl_file , block_report_step( block )));
+    test_assert_int_equal( ecl_kw_iget_int( ecl_file_iget_named_kw( ecl_file , SEQNUM_KW , 0 ) , 0 ) , block_report_step( block ));
+    test_assert_int_equal( ecl_file_get_num_named_kw( ecl_file , INTEHEAD_KW ) , NUM_LGR + 1 );
+    test_assert_true( ecl_file_has_report_step( ecl_file , block_report_step( block )));
+    test_assert_false( ecl_file_has_report_step( ecl_file , block_report_step( 0 ) - 5 ));
+    test_assert_int_equal( ecl_file_get_restart_index( ecl_file , block_sim_time( block )) , 0 );
+
+    test_assert_true( ecl_file_select_rstblock_sim_time( ecl_file , block_sim_time( block )));
+    test_assert_int_equal( ecl_kw_iget_int( ecl_file_iget_named_kw( ecl_file , SEQNUM_KW , 0 ) , 0 ) , block_report_step( block ));
+  }
+  test_assert_false( ecl_file_select_rstblock_report_step( ecl_file , block_report_step( NUM_BLOCKS )));
+  test_assert_false( ecl_file_select_rstblock_sim_time( ecl_file , block_sim_time( NUM_BLOCKS )));
+  ecl_file_close( ecl_file );
+
+  {
+    ecl_file_type * block_file = ecl_file_open_rstblock_report_step( filename , block_report_step( 7 ) , flags );
+    test_assert_not_NULL( block_file );
+    test_assert_true( ecl_file_iget_restart_sim_date( block_file , 0 ) == block_sim_time( 7 ));
+    ecl_file_close( block_file );
+  }
+  test_assert_NULL( ecl_file_open_rstblock_sim_time( filename , block_sim_time( NUM_BLOCKS ) , flags ));
+}
+
+
+/*
+  A file with INTEHEAD but without SEQNUM keywords, like an INIT
+  file, has no restart blocks.
+*/
+
+void test_init_file( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  write_intehead( fortio , block_sim_time( 3 ));
+  fortio_fclose( fortio );
+  {
+    ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
+    test_assert_int_equal( ecl_file_get_restart_index( ecl_file , block_sim_time( 3 )) , 0 );
+    test_assert_false( ecl_file_has_sim_time( ecl_file , block_sim_time( 3 )));
+    test_assert_false( ecl_file_has_report_step( ecl_file , 0 ));
+    ecl_file_close( ecl_file );
+  }
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_file_rstblock");
+  const char * filename = "TEST.UNRST";
+
+  create_file( filename );
+  test_rstblock( filename , 0 );
+  test_rstblock( filename , ECL_FILE_USE_INDEX );   /* Creates the index file. */
+  test_assert_true( util_file_exists( "TEST.UNRST.idx" ));
+  test_rstblock( filename , ECL_FILE_USE_INDEX );   /* Loads the index file. */
+
+  /* The index file must be valid when loaded in another time zone. */
+  setenv( "TZ" , "UTC" , 1 );
+  tzset();
+  create_file( filename );
+  test_rstblock( filename , ECL_FILE_USE_INDEX );
+  setenv( "TZ" , "XXX-10" , 1 );
+  tzset();
+  test_rstblock( filename , ECL_FILE_USE_INDEX );
+
+  test_init_file( "TEST.INIT" );
+  test_work_area_free( work_area );
+  exit(0);
+}
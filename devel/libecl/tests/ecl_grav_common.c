@@ -0,0 +1,85 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grav_common.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+#include <ert/ecl/ecl_grid_cache.h>
+#include <ert/ecl/ecl_grav_common.h>
+
+
+
+void test_eval_list( const ecl_grid_cache_type * grid_cache , ecl_region_type * region , int num_stations ) {
+  const int size = ecl_grid_cache_get_size( grid_cache );
+  bool   * aquifer = util_calloc( size , sizeof * aquifer );
+  double * weight  = util_calloc( size , sizeof * weight );
+  double * utm_x   = util_calloc( num_stations , sizeof * utm_x );
+  double * utm_y   = util_calloc( num_stations , sizeof * utm_y );
+  double * depth   = util_calloc( num_stations , sizeof * depth );
+  double * sum     = util_calloc( num_stations , sizeof * sum );
+  int i;
+
+  for (i = 0; i < size; i++) {
+    aquifer[i] = ((i % 13) == 0);
+    weight[i]  = 1000.0 * rand() / RAND_MAX - 500;
+  }
+
+  for (i = 0; i < num_stations; i++) {
+    utm_x[i] = 400.0 * rand() / RAND_MAX;
+    utm_y[i] = 400.0 * rand() / RAND_MAX;
+    depth[i] = -10.0 * rand() / RAND_MAX;
+  }
+
+  ecl_grav_common_eval_biot_savart_list( grid_cache , region , aquifer , weight , num_stations , utm_x , utm_y , depth , sum );
+  for (i = 0; i < num_stations; i++)
+    test_assert_double_equal( sum[i] , ecl_grav_common_eval_biot_savart( grid_cache , region , aquifer , weight , utm_x[i] , utm_y[i] , depth[i] ));
+
+  free( aquifer );
+  free( weight );
+  free( utm_x );
+  free( utm_y );
+  free( depth );
+  free( sum );
+}
+
+
+
+int main(int argc , char ** argv) {
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( 40 , 40 , 20 , 10 , 10 , 5 , NULL );
+  ecl_grid_cache_type * grid_cache = ecl_grid_cache_alloc( grid );
+  ecl_region_type * region = ecl_region_alloc( grid , false );
+
+  srand( 1 );
+  ecl_region_select_from_ijkbox( region , 5 , 30 , 10 , 20 , 2 , 12 );
+
+  test_eval_list( grid_cache , NULL , 1 );
+  test_eval_list( grid_cache , NULL , 37 );
+  test_eval_list( grid_cache , region , 37 );
+
+  /* Large enough to be evaluated by several threads. */
+  test_eval_list( grid_cache , NULL , 250 );
+
+  ecl_region_free( region );
+  ecl_grid_cache_free( grid_cache );
+  ecl_grid_free( grid );
+  exit(0);
+}
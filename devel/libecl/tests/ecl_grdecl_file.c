@@ -0,0 +1,150 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grdecl_file.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_grdecl.h>
+#include <ert/ecl/ecl_grdecl_file.h>
+
+/* Large enough for the keyword to be decoded by several threads. */
+#define LARGE_SIZE 1000000
+
+
+/*
+  Loads @kw both with the stream based loader and with
+  ecl_grdecl_file, and checks that the results are identical.
+*/
+
+void test_equal( const ecl_grdecl_file_type * grdecl_file , const char * filename , const char * kw , bool strict , ecl_type_enum ecl_type) {
+  FILE * stream = util_fopen( filename , "r" );
+  ecl_kw_type * kw1 = ecl_kw_fscanf_alloc_grdecl_dynamic__( stream , kw , strict , ecl_type );
+  ecl_kw_type * kw2 = ecl_grdecl_file_alloc_kw__( grdecl_file , kw , strict , 0 , ecl_type );
+
+  test_assert_not_NULL( kw1 );
+  test_assert_not_NULL( kw2 );
+  test_assert_true( ecl_kw_equal( kw1 , kw2 ));
+
+  ecl_kw_free( kw1 );
+  ecl_kw_free( kw2 );
+  fclose( stream );
+}
+
+
+void create_small( const char * filename ) {
+  FILE * stream = util_fopen( filename , "w" );
+  fprintf(stream , "-- A comment line\n");
+  fprintf(stream , "PORO\n 0.25 0.125 3*0.5 -- Trailing comment 7 8 9\n  1.5E-3 2e+2 -0.0 0*7 /\n\n");
+  fprintf(stream , "NTG 1 1 1 0.5\n0.1 2*0.3 /\n");
+  fprintf(stream , "ACTNUM\n 10*1 0 0 1 -7 +5 /\n");
+  fprintf(stream , "PERMX\n 0x1A inf 1.000000000000000000000001 12345678901234567890123456789012345678901234567890 1e-400 1e400 0.1 /\n");
+  fprintf(stream , "SATNUM\n 1.5 2 3 /\n");
+  fprintf(stream , "FIPNUM\n 1 2 F 3 4 /\n");
+  fprintf(stream , "MULTX\n 1.0 2.0\n 3.0\nMULTY\n 1 2 3 /\n");
+  fprintf(stream , "MULTZ\n 3*1.0 -2*7 1.0 /\n");
+  fprintf(stream , "EQLNUM /\n");
+  fclose( stream );
+}
+
+
+void test_small( void ) {
+  const char * filename = "SMALL.grdecl";
+  create_small( filename );
+  {
+    ecl_grdecl_file_type * grdecl_file = ecl_grdecl_file_open( filename );
+
+    test_assert_true( ecl_grdecl_file_is_instance( grdecl_file ));
+    test_assert_true( ecl_grdecl_file_has_kw( grdecl_file , "PORO" ));
+    test_assert_true( ecl_grdecl_file_has_kw( grdecl_file , "MULTY" ));
+    test_assert_false( ecl_grdecl_file_has_kw( grdecl_file , "PERMZ" ));
+    test_assert_string_equal( ecl_grdecl_file_iget_header( grdecl_file , 0 ) , "PORO" );
+    test_assert_NULL( ecl_grdecl_file_alloc_kw( grdecl_file , "PERMZ" , 0 , ECL_FLOAT_TYPE ));
+
+    test_equal( grdecl_file , filename , "PORO"   , true  , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "PORO"   , true  , ECL_DOUBLE_TYPE );
+    test_equal( grdecl_file , filename , "NTG"    , true  , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "ACTNUM" , true  , ECL_INT_TYPE );
+    test_equal( grdecl_file , filename , "PERMX"  , true  , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "PERMX"  , true  , ECL_DOUBLE_TYPE );
+    test_equal( grdecl_file , filename , "SATNUM" , true  , ECL_INT_TYPE );
+    test_equal( grdecl_file , filename , "FIPNUM" , false , ECL_INT_TYPE );
+    test_equal( grdecl_file , filename , "MULTX"  , false , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "MULTZ"  , true  , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "EQLNUM" , true  , ECL_INT_TYPE );
+
+    {
+      ecl_kw_type * poro = ecl_grdecl_file_alloc_kw( grdecl_file , "PORO" , 8 , ECL_FLOAT_TYPE );
+      test_assert_int_equal( ecl_kw_get_size( poro ) , 8 );
+      test_assert_double_equal( ecl_kw_iget_float( poro , 4 ) , 0.5 );
+      ecl_kw_free( poro );
+    }
+    ecl_grdecl_file_close( grdecl_file );
+  }
+}
+
+
+void create_large( const char * filename ) {
+  FILE * stream = util_fopen( filename , "w" );
+  int i;
+
+  fprintf(stream , "PERMX\n");
+  for (i = 0; i < LARGE_SIZE; i++) {
+    fprintf(stream , " %g" , 0.001 * (rand() % 1000000) * ((i % 3) ? 1 : 1e-5));
+    if ((i % 8) == 7)
+      fprintf(stream , "\n");
+  }
+  fprintf(stream , "\n/\n");
+
+  fprintf(stream , "SATNUM\n");
+  for (i = 0; i < LARGE_SIZE / 10; i++) {
+    if ((i % 100) == 0)
+      fprintf(stream , "-- Block %d\n" , i);
+    fprintf(stream , " %d*%d\n" , 1 + (i % 20) , rand() % 10);
+  }
+  fprintf(stream , "/\n");
+  fclose( stream );
+}
+
+
+void test_large( void ) {
+  const char * filename = "LARGE.grdecl";
+  create_large( filename );
+  {
+    ecl_grdecl_file_type * grdecl_file = ecl_grdecl_file_open( filename );
+    test_assert_int_equal( ecl_grdecl_file_get_num_kw( grdecl_file ) , 2 );
+    test_equal( grdecl_file , filename , "PERMX"  , true , ECL_FLOAT_TYPE );
+    test_equal( grdecl_file , filename , "PERMX"  , true , ECL_DOUBLE_TYPE );
+    test_equal( grdecl_file , filename , "SATNUM" , true , ECL_INT_TYPE );
+    ecl_grdecl_file_close( grdecl_file );
+  }
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_grdecl_file");
+  srand( 1 );
+  test_small();
+  test_large();
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -204,6 +204,82 @@ void test_find( ecl_grid_type * grid ) {
 //}
 
 
+/*
+  The batched versions must give exactly the same answers as the
+  scalar ecl_grid_cell_contains_xyz1(); the points are the cell
+  corners and center, the centers of the neighbouring cells and random
+  points around the cell.
+*/
+
+#define BATCH_POINTS 100
+
+void test_contains_batch( const ecl_grid_type * grid ) {
+  const int global_size = ecl_grid_get_global_size( grid );
+  const int delta = util_int_max( 1 , global_size / 500 );
+  double x[BATCH_POINTS] , y[BATCH_POINTS] , z[BATCH_POINTS];
+  bool contains[BATCH_POINTS];
+  int global_index;
+
+  srand( 1 );
+  for (global_index = 0; global_index < global_size; global_index += delta) {
+    int num_points = 0;
+    int ip;
+
+    for (ip = 0; ip < 8; ip++) {
+      ecl_grid_get_corner_xyz1( grid , global_index , ip , &x[num_points] , &y[num_points] , &z[num_points]);
+      num_points++;
+    }
+    ecl_grid_get_xyz1( grid , global_index , &x[num_points] , &y[num_points] , &z[num_points]);
+    num_points++;
+
+    for (ip = -2; ip <= 2; ip++) {
+      int neighbour = global_index + ip * ecl_grid_get_nx( grid );
+      if (neighbour >= 0 && neighbour < global_size) {
+        ecl_grid_get_xyz1( grid , neighbour , &x[num_points] , &y[num_points] , &z[num_points]);
+        num_points++;
+      }
+    }
+
+    while (num_points < BATCH_POINTS) {
+      double x0 , y0 , z0;
+      double x1 , y1 , z1;
+      double r1 = 1.5 * rand() / RAND_MAX - 0.25;
+      double r2 = 1.5 * rand() / RAND_MAX - 0.25;
+      double r3 = 1.5 * rand() / RAND_MAX - 0.25;
+
+      ecl_grid_get_corner_xyz1( grid , global_index , 0 , &x0 , &y0 , &z0 );
+      ecl_grid_get_corner_xyz1( grid , global_index , 7 , &x1 , &y1 , &z1 );
+      x[num_points] = x0 + r1 * (x1 - x0);
+      y[num_points] = y0 + r2 * (y1 - y0);
+      z[num_points] = z0 + r3 * (z1 - z0);
+      num_points++;
+    }
+
+    ecl_grid_cell_contains_xyz_list1( grid , global_index , num_points , x , y , z , contains );
+    for (ip = 0; ip < num_points; ip++)
+      test_assert_bool_equal( contains[ip] , ecl_grid_cell_contains_xyz1( grid , global_index , x[ip] , y[ip] , z[ip] ));
+
+    {
+      int cell_list[5];
+      int num_cells = 0;
+      int ic;
+
+      for (ic = -2; ic <= 2; ic++) {
+        int neighbour = global_index + ic;
+        if (neighbour >= 0 && neighbour < global_size)
+          cell_list[num_cells++] = neighbour;
+      }
+
+      for (ip = 0; ip < num_points; ip++) {
+        ecl_grid_cell_list_contains_xyz( grid , num_cells , cell_list , x[ip] , y[ip] , z[ip] , contains );
+        for (ic = 0; ic < num_cells; ic++)
+          test_assert_bool_equal( contains[ic] , ecl_grid_cell_contains_xyz1( grid , cell_list[ic] , x[ip] , y[ip] , z[ip] ));
+      }
+    }
+  }
+}
+
+
 void test_corners() {
   ecl_grid_type * grid = ecl_grid_alloc_rectangular(3,3,3,1,1,1,NULL);
 
@@ -279,7 +355,7 @@ int main(int argc , char ** argv) {
   
   test_grid_covering( grid );
   test_contains_count( grid );
-  
+  test_contains_batch( grid );
 
   test_find(grid);
   test_corners();
@@ -0,0 +1,153 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grid_compact.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#define NX 10
+#define NY  8
+#define NZ  5
+
+/* UTM like coordinates - to check that the float storage retains sufficient precision. */
+#define X0   456000
+#define Y0  6780000
+
+
+void test_assert_close( double d1 , double d2 , double tolerance ) {
+  if (fabs( d1 - d2 ) > tolerance)
+    test_error_exit("Values %g and %g differ by more than %g \n", d1 , d2 , tolerance );
+}
+
+
+void create_grid( const char * filename ) {
+  float * coord = util_calloc( 6 * (NX + 1) * (NY + 1) , sizeof * coord );
+  float * zcorn = util_calloc( 8 * NX * NY * NZ , sizeof * zcorn );
+  int   * actnum = util_calloc( NX * NY * NZ , sizeof * actnum );
+  int i,j,k;
+
+  for (j=0; j <= NY; j++) {
+    for (i=0; i <= NX; i++) {
+      float * pillar = &coord[ 6 * (j * (NX + 1) + i) ];
+      pillar[0] = X0 + 50 * i + 3 * j;
+      pillar[1] = Y0 + 40 * j;
+      pillar[2] = 1900;
+      pillar[3] = X0 + 50 * i + 3 * j + 5;
+      pillar[4] = Y0 + 40 * j;
+      pillar[5] = 2100;
+    }
+  }
+
+  for (k=0; k < NZ; k++) {
+    for (j=0; j < NY; j++) {
+      for (i=0; i < NX; i++) {
+        int ip , c;
+        for (c = 0; c < 2; c++) {
+          for (ip = 0; ip < 4; ip++) {
+            int ic = i + (ip & 1);
+            int jc = j + (ip >> 1);
+            int index = k*8*NX*NY + j*4*NX + 2*i + (ip & 1) + (ip >> 1) * 2 * NX + c*4*NX*NY;
+            zcorn[index] = 2000 + 10 * (k + c) + 0.5 * ic + 0.25 * jc;
+          }
+        }
+        actnum[ i + j*NX + k*NX*NY ] = ((i + j + k) % 7 == 0) ? 0 : 1;
+      }
+    }
+  }
+
+  {
+    ecl_grid_type * grid = ecl_grid_alloc_GRDECL_data( NX , NY , NZ , zcorn , coord , actnum , NULL );
+    ecl_grid_fwrite_EGRID( grid , filename );
+    ecl_grid_free( grid );
+  }
+
+  free( coord );
+  free( zcorn );
+  free( actnum );
+}
+
+
+void test_equal( const ecl_grid_type * grid , ecl_grid_type * compact ) {
+  int global_index;
+
+  test_assert_false( ecl_grid_is_compact( grid ));
+  test_assert_true( ecl_grid_is_compact( compact ));
+  test_assert_int_equal( ecl_grid_get_global_size( grid ) , ecl_grid_get_global_size( compact ));
+  test_assert_int_equal( ecl_grid_get_active_size( grid ) , ecl_grid_get_active_size( compact ));
+
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++) {
+    double x1,y1,z1;
+    double x2,y2,z2;
+    int corner;
+
+    test_assert_int_equal( ecl_grid_get_active_index1( grid , global_index ) , ecl_grid_get_active_index1( compact , global_index ));
+    test_assert_bool_equal( ecl_grid_cell_invalid1( grid , global_index ) , ecl_grid_cell_invalid1( compact , global_index ));
+
+    ecl_grid_get_xyz1( grid , global_index , &x1 , &y1 , &z1 );
+    ecl_grid_get_xyz1( compact , global_index , &x2 , &y2 , &z2 );
+    test_assert_close( x1 , x2 , 1e-3 );
+    test_assert_close( y1 , y2 , 1e-3 );
+    test_assert_close( z1 , z2 , 1e-3 );
+
+    for (corner = 0; corner < 8; corner++) {
+      ecl_grid_get_corner_xyz1( grid , global_index , corner , &x1 , &y1 , &z1 );
+      ecl_grid_get_corner_xyz1( compact , global_index , corner , &x2 , &y2 , &z2 );
+      test_assert_close( x1 , x2 , 1e-3 );
+      test_assert_close( y1 , y2 , 1e-3 );
+      test_assert_close( z1 , z2 , 1e-3 );
+    }
+
+    test_assert_close( ecl_grid_get_cdepth1( grid , global_index ) , ecl_grid_get_cdepth1( compact , global_index ) , 1e-3 );
+    test_assert_close( ecl_grid_get_top1( grid , global_index ) , ecl_grid_get_top1( compact , global_index ) , 1e-3 );
+    test_assert_close( ecl_grid_get_bottom1( grid , global_index ) , ecl_grid_get_bottom1( compact , global_index ) , 1e-3 );
+    test_assert_close( ecl_grid_get_cell_volume1( grid , global_index ) , ecl_grid_get_cell_volume1( compact , global_index ) , 1e-4 * ecl_grid_get_cell_volume1( grid , global_index ));
+
+    ecl_grid_get_xyz1( compact , global_index , &x2 , &y2 , &z2 );
+    test_assert_int_equal( global_index , ecl_grid_get_global_index_from_xyz( compact , x2 , y2 , z2 , -1 ));
+  }
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_grid_compact");
+  create_grid( "CASE.EGRID" );
+  {
+    ecl_grid_type * grid = ecl_grid_alloc( "CASE.EGRID" );
+    ecl_grid_type * compact = ecl_grid_alloc_compact( "CASE.EGRID" );
+
+    test_equal( grid , compact );
+
+    /* Round trip through the file. */
+    ecl_grid_fwrite_EGRID( compact , "COMPACT.EGRID" );
+    {
+      ecl_grid_type * compact2 = ecl_grid_alloc_compact( "COMPACT.EGRID" );
+      test_equal( grid , compact2 );
+      ecl_grid_free( compact2 );
+    }
+
+    ecl_grid_free( compact );
+    ecl_grid_free( grid );
+  }
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,104 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grid_global_index_xyz.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+#define NUM_POINTS 2000
+
+
+int linear_find( const ecl_grid_type * grid , double x , double y , double z) {
+  int global_index;
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++) {
+    if (ecl_grid_cell_contains_xyz1( grid , global_index , x , y , z ))
+      return global_index;
+  }
+  return -1;
+}
+
+
+void test_centers( ecl_grid_type * grid ) {
+  int global_index;
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++) {
+    double x,y,z;
+    ecl_grid_get_xyz1( grid , global_index , &x , &y , &z );
+    test_assert_int_equal( global_index , ecl_grid_get_global_index_from_xyz( grid , x , y , z , -1 ));
+    test_assert_int_equal( global_index , ecl_grid_get_global_index_from_xyz( grid , x , y , z , 0 ));
+  }
+}
+
+
+void test_random_points( ecl_grid_type * grid ) {
+  double * xlist = util_calloc( NUM_POINTS , sizeof * xlist );
+  double * ylist = util_calloc( NUM_POINTS , sizeof * ylist );
+  double * zlist = util_calloc( NUM_POINTS , sizeof * zlist );
+  int    * index_list = util_calloc( NUM_POINTS , sizeof * index_list );
+  int outside = 0;
+  int i;
+
+  srand( 1013 );
+  for (i = 0; i < NUM_POINTS; i++) {
+    xlist[i] = -20 + 280.0 * rand() / RAND_MAX;
+    ylist[i] = -20 + 200.0 * rand() / RAND_MAX;
+    zlist[i] =  -5 +  60.0 * rand() / RAND_MAX;
+  }
+  /* Points on the grid nodes. */
+  ecl_grid_get_corner_xyz1( grid , 0 , 0 , &xlist[0] , &ylist[0] , &zlist[0]);
+  ecl_grid_get_corner_xyz1( grid , 117 , 5 , &xlist[1] , &ylist[1] , &zlist[1]);
+  ecl_grid_get_corner_xyz1( grid , ecl_grid_get_global_size( grid ) - 1 , 7 , &xlist[2] , &ylist[2] , &zlist[2]);
+
+  ecl_grid_get_global_index_list_from_xyz( grid , NUM_POINTS , xlist , ylist , zlist , index_list );
+  for (i = 0; i < NUM_POINTS; i++) {
+    int global_index = linear_find( grid , xlist[i] , ylist[i] , zlist[i] );
+    test_assert_int_equal( global_index , index_list[i] );
+    test_assert_int_equal( global_index , ecl_grid_get_global_index_from_xyz( grid , xlist[i] , ylist[i] , zlist[i] , -1 ));
+    if (global_index < 0)
+      outside++;
+  }
+  test_assert_true( outside > 0 );
+  test_assert_true( outside < NUM_POINTS );
+  test_assert_true( index_list[0] == 0 );
+
+  free( xlist );
+  free( ylist );
+  free( zlist );
+  free( index_list );
+}
+
+
+int main( int argc , char ** argv) {
+  const double ivec[3] = { 10 ,  2 , 0.5 };
+  const double jvec[3] = { -1 , 10 , 0.25 };
+  const double kvec[3] = {  0 ,  0 , 4 };
+  ecl_grid_type * grid = ecl_grid_alloc_regular( 20 , 15 , 10 , ivec , jvec , kvec , NULL );
+
+  test_random_points( grid );
+  test_centers( grid );
+  ecl_grid_free( grid );
+
+  grid = ecl_grid_alloc_rectangular( 1 , 1 , 1 , 1 , 1 , 1 , NULL );
+  test_assert_int_equal( 0 , ecl_grid_get_global_index_from_xyz( grid , 0.5 , 0.5 , 0.5 , -1 ));
+  test_assert_int_equal( -1 , ecl_grid_get_global_index_from_xyz( grid , 1.5 , 0.5 , 0.5 , -1 ));
+  ecl_grid_free( grid );
+
+  exit(0);
+}
@@ -0,0 +1,161 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_grid_lazy.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_grid.h>
+
+/* Large enough for the cells to be initialized by several threads. */
+#define NX 60
+#define NY 50
+#define NZ 20
+
+
+double corner_depth( int ic , int jc , int kc ) {
+  return 2000 + 10 * kc + 0.5 * ic + 0.25 * jc;
+}
+
+
+void create_grid( const char * filename ) {
+  float * coord = util_calloc( 6 * (NX + 1) * (NY + 1) , sizeof * coord );
+  float * zcorn = util_calloc( 8 * NX * NY * NZ , sizeof * zcorn );
+  int   * actnum = util_calloc( NX * NY * NZ , sizeof * actnum );
+  int i,j,k;
+
+  for (j=0; j <= NY; j++) {
+    for (i=0; i <= NX; i++) {
+      float * pillar = &coord[ 6 * (j * (NX + 1) + i) ];
+      pillar[0] = 50 * i + 3 * j;
+      pillar[1] = 40 * j;
+      pillar[2] = 1900;
+      pillar[3] = 50 * i + 3 * j + 5;
+      pillar[4] = 40 * j;
+      pillar[5] = 2600;
+    }
+  }
+
+  for (k=0; k < NZ; k++) {
+    for (j=0; j < NY; j++) {
+      for (i=0; i < NX; i++) {
+        int ip , c;
+        for (c = 0; c < 2; c++) {
+          for (ip = 0; ip < 4; ip++) {
+            int index = k*8*NX*NY + j*4*NX + 2*i + (ip & 1) + (ip >> 1) * 2 * NX + c*4*NX*NY;
+            zcorn[index] = corner_depth( i + (ip & 1) , j + (ip >> 1) , k + c );
+          }
+        }
+        actnum[ i + j*NX + k*NX*NY ] = ((i + j + k) % 7 == 0) ? 0 : 1;
+      }
+    }
+  }
+
+  {
+    ecl_grid_type * grid = ecl_grid_alloc_GRDECL_data( NX , NY , NZ , zcorn , coord , actnum , NULL );
+    ecl_grid_fwrite_EGRID( grid , filename );
+    ecl_grid_free( grid );
+  }
+
+  free( coord );
+  free( zcorn );
+  free( actnum );
+}
+
+
+void test_corners( const ecl_grid_type * grid ) {
+  int i,j,k;
+  for (k=0; k < NZ; k++) {
+    for (j=0; j < NY; j++) {
+      for (i=0; i < NX; i++) {
+        int global_index = ecl_grid_get_global_index3( grid , i , j , k );
+        int corner;
+        for (corner = 0; corner < 8; corner++) {
+          double x,y,z;
+          ecl_grid_get_corner_xyz1( grid , global_index , corner , &x , &y , &z );
+          test_assert_double_equal( z , corner_depth( i + (corner & 1) , j + ((corner >> 1) & 1) , k + (corner >> 2)));
+        }
+      }
+    }
+  }
+}
+
+
+void test_index( const ecl_grid_type * grid , const ecl_grid_type * lazy ) {
+  int global_index;
+  test_assert_int_equal( ecl_grid_get_global_size( grid ) , ecl_grid_get_global_size( lazy ));
+  test_assert_int_equal( ecl_grid_get_active_size( grid ) , ecl_grid_get_active_size( lazy ));
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++)
+    test_assert_int_equal( ecl_grid_get_active_index1( grid , global_index ) , ecl_grid_get_active_index1( lazy , global_index ));
+}
+
+
+void test_geometry( const ecl_grid_type * grid , const ecl_grid_type * lazy ) {
+  int global_index;
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++) {
+    test_assert_double_equal( ecl_grid_get_cell_volume1( grid , global_index ) , ecl_grid_get_cell_volume1( lazy , global_index ));
+    test_assert_double_equal( ecl_grid_get_cdepth1( grid , global_index ) , ecl_grid_get_cdepth1( lazy , global_index ));
+    test_assert_bool_equal( ecl_grid_cell_invalid1( grid , global_index ) , ecl_grid_cell_invalid1( lazy , global_index ));
+  }
+}
+
+
+void test_lazy( const ecl_grid_type * grid , int flags ) {
+  ecl_grid_type * lazy = ecl_grid_alloc_flags( "CASE.EGRID" , flags );
+  test_assert_false( ecl_grid_has_geometry( lazy ));
+  test_index( grid , lazy );
+  test_assert_false( ecl_grid_has_geometry( lazy ));
+
+  test_geometry( grid , lazy );
+  test_assert_true( ecl_grid_has_geometry( lazy ));
+  ecl_grid_free( lazy );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_grid_lazy");
+  create_grid( "CASE.EGRID" );
+  {
+    ecl_grid_type * grid = ecl_grid_alloc( "CASE.EGRID" );
+    ecl_grid_type * compact = ecl_grid_alloc_compact( "CASE.EGRID" );
+
+    test_assert_true( ecl_grid_has_geometry( grid ));
+    test_corners( grid );
+    test_lazy( grid , ECL_GRID_LAZY );
+    test_lazy( compact , ECL_GRID_LAZY + ECL_GRID_COMPACT );
+
+    /* Lazy loading is only free until the first geometric query. */
+    {
+      ecl_grid_type * lazy = ecl_grid_alloc_flags( "CASE.EGRID" , ECL_GRID_LAZY );
+      ecl_grid_fwrite_EGRID( lazy , "LAZY.EGRID" );
+      test_assert_true( ecl_grid_has_geometry( lazy ));
+      ecl_grid_free( lazy );
+
+      lazy = ecl_grid_alloc( "LAZY.EGRID" );
+      test_assert_true( ecl_grid_compare( grid , lazy , true , false ));
+      ecl_grid_free( lazy );
+    }
+
+    ecl_grid_free( compact );
+    ecl_grid_free( grid );
+  }
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,138 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_kw_kernel_bench.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/time.h>
+
+#include <ert/util/util.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_util.h>
+
+/*
+  Small benchmark of the bulk kernels used when loading keywords:
+  endian flipping of the numeric types and the conversions in
+  ecl_kw_get_data_as_double() / ecl_kw_get_data_as_float(). The
+  numbers are reported as GB/s of input data, using wall clock time.
+
+    ecl_kw_kernel_bench  [size]  [repeat]
+
+  It is also run as a test with a small size, to check the converted
+  values.
+*/
+
+
+static double wall_time( void ) {
+  struct timeval tv;
+  gettimeofday( &tv , NULL );
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+
+static void report( const char * name , size_t bytes , int repeat , double seconds) {
+  printf("%-24s  %10.3f ms   %8.2f GB/s\n", name , 1000 * seconds / repeat , 1e-9 * bytes * repeat / seconds);
+}
+
+
+static void bench_flip( ecl_type_enum ecl_type , int size , int repeat) {
+  int sizeof_ctype = ecl_util_get_sizeof_ctype( ecl_type );
+  char * data = util_calloc( size * sizeof_ctype , sizeof * data );
+  double t0;
+  int r;
+
+  t0 = wall_time();
+  for (r = 0; r < repeat; r++)
+    util_endian_flip_vector( data , sizeof_ctype , size );
+  {
+    char * name = util_alloc_sprintf("flip %s" , ecl_util_get_type_name( ecl_type ));
+    report( name , size * sizeof_ctype , repeat , wall_time() - t0 );
+    free( name );
+  }
+  free( data );
+}
+
+
+static void bench_convert( ecl_type_enum src_type , ecl_type_enum target_type , int size , int repeat) {
+  ecl_kw_type * ecl_kw = ecl_kw_alloc( "KW" , size , src_type );
+  void * target = util_calloc( size , ecl_util_get_sizeof_ctype( target_type ));
+  double t0;
+  int r;
+
+  {
+    int i;
+    for (i=0; i < size; i++) {
+      if (src_type == ECL_INT_TYPE)
+        ecl_kw_iset_int( ecl_kw , i , i % 1000 );
+      else if (src_type == ECL_FLOAT_TYPE)
+        ecl_kw_iset_float( ecl_kw , i , (i % 1000) * 0.25 );
+      else
+        ecl_kw_iset_double( ecl_kw , i , (i % 1000) * 0.25 );
+    }
+  }
+
+  t0 = wall_time();
+  for (r = 0; r < repeat; r++) {
+    if (target_type == ECL_DOUBLE_TYPE)
+      ecl_kw_get_data_as_double( ecl_kw , target );
+    else
+      ecl_kw_get_data_as_float( ecl_kw , target );
+  }
+  {
+    char * name = util_alloc_sprintf("%s -> %s" , ecl_util_get_type_name( src_type ) , ecl_util_get_type_name( target_type ));
+    report( name , size * ecl_util_get_sizeof_ctype( src_type ) , repeat , wall_time() - t0 );
+    free( name );
+  }
+
+  /* Sanity check; all the input values are exactly representable. */
+  {
+    int i;
+    for (i=0; i < size; i++) {
+      double value = (target_type == ECL_DOUBLE_TYPE) ? ((double *) target)[i] : ((float *) target)[i];
+      if (value != ecl_kw_iget_as_double( ecl_kw , i ))
+        util_abort("%s: conversion error at index:%d \n",__func__ , i);
+    }
+  }
+
+  free( target );
+  ecl_kw_free( ecl_kw );
+}
+
+
+
+int main(int argc , char ** argv) {
+  int size   = 10000000;
+  int repeat = 10;
+
+  if (argc > 1)
+    util_sscanf_int( argv[1] , &size );
+  if (argc > 2)
+    util_sscanf_int( argv[2] , &repeat );
+
+  printf("size:%d  repeat:%d\n", size , repeat);
+  bench_flip( ECL_INT_TYPE    , size , repeat );
+  bench_flip( ECL_FLOAT_TYPE  , size , repeat );
+  bench_flip( ECL_DOUBLE_TYPE , size , repeat );
+  bench_flip( ECL_BOOL_TYPE   , size , repeat );
+
+  bench_convert( ECL_FLOAT_TYPE  , ECL_DOUBLE_TYPE , size , repeat );
+  bench_convert( ECL_DOUBLE_TYPE , ECL_FLOAT_TYPE  , size , repeat );
+  bench_convert( ECL_INT_TYPE    , ECL_DOUBLE_TYPE , size , repeat );
+  bench_convert( ECL_INT_TYPE    , ECL_FLOAT_TYPE  , size , repeat );
+  exit(0);
+}
@@ -0,0 +1,183 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_nnc_table.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_nnc_export.h>
+#include <ert/ecl/nnc_table.h>
+#include <ert/ecl/nnc_info.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_endian_flip.h>
+
+#define NX 20
+#define NY 20
+#define NZ 10
+
+/* Large enough for the table to be built by several threads. */
+#define NUM_NNC 150000
+
+
+void create_case( int * nnc1 , int * nnc2 ) {
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( NX , NY , NZ , 1 , 1 , 1 , NULL );
+  int size = NX * NY * NZ;
+  int i;
+
+  for (i = 0; i < NUM_NNC; i++) {
+    nnc1[i] = 1 + (int) ((i * 7919L) % size);
+    nnc2[i] = 1 + (int) ((i * 104729L + 13) % size);
+  }
+  ecl_grid_fwrite_EGRID( grid , "CASE.EGRID" );
+  ecl_grid_free( grid );
+
+  {
+    fortio_type * fortio = fortio_open_append( "CASE.EGRID" , false , ECL_ENDIAN_FLIP );
+    ecl_kw_type * nnchead_kw = ecl_kw_alloc( NNCHEAD_KW , 10 , ECL_INT_TYPE );
+    ecl_kw_type * nnc1_kw = ecl_kw_alloc( NNC1_KW , NUM_NNC , ECL_INT_TYPE );
+    ecl_kw_type * nnc2_kw = ecl_kw_alloc( NNC2_KW , NUM_NNC , ECL_INT_TYPE );
+
+    ecl_kw_scalar_set_int( nnchead_kw , 0 );
+    ecl_kw_iset_int( nnchead_kw , NNCHEAD_NUMNNC_INDEX , NUM_NNC );
+    for (i = 0; i < NUM_NNC; i++) {
+      ecl_kw_iset_int( nnc1_kw , i , nnc1[i] );
+      ecl_kw_iset_int( nnc2_kw , i , nnc2[i] );
+    }
+    ecl_kw_fwrite( nnchead_kw , fortio );
+    ecl_kw_fwrite( nnc1_kw , fortio );
+    ecl_kw_fwrite( nnc2_kw , fortio );
+
+    ecl_kw_free( nnchead_kw );
+    ecl_kw_free( nnc1_kw );
+    ecl_kw_free( nnc2_kw );
+    fortio_fclose( fortio );
+  }
+
+  {
+    fortio_type * fortio = fortio_open_writer( "CASE.INIT" , false , ECL_ENDIAN_FLIP );
+    ecl_kw_type * tran_kw = ecl_kw_alloc( TRANNNC_KW , NUM_NNC , ECL_FLOAT_TYPE );
+
+    for (i = 0; i < NUM_NNC; i++)
+      ecl_kw_iset_float( tran_kw , i , i );
+    ecl_kw_fwrite( tran_kw , fortio );
+
+    ecl_kw_free( tran_kw );
+    fortio_fclose( fortio );
+  }
+}
+
+
+void test_table( const ecl_grid_type * grid , const int * nnc1 , const int * nnc2 ) {
+  const nnc_table_type * nnc_table = ecl_grid_get_nnc_table( grid );
+  int * cursor = util_calloc( NX * NY * NZ , sizeof * cursor );
+  int i;
+
+  for (i = 0; i < NX * NY * NZ; i++)
+    cursor[i] = 0;
+
+  test_assert_true( nnc_table_is_instance( nnc_table ));
+  test_assert_int_equal( NUM_NNC , nnc_table_get_size( nnc_table ));
+  test_assert_int_equal( NUM_NNC , ecl_grid_get_num_nnc( grid ));
+  test_assert_int_equal( 1 , int_vector_size( nnc_table_get_lgr_list( nnc_table )));
+
+  /* The connections of each cell are in the order they were read. */
+  for (i = 0; i < NUM_NNC; i++) {
+    int global_index1 = nnc1[i] - 1;
+    int index = nnc_table_get_cell_offset( nnc_table , global_index1 ) + cursor[ global_index1 ];
+
+    test_assert_int_equal( nnc2[i] - 1 , nnc_table_iget_global_index( nnc_table , index ));
+    test_assert_int_equal( i , nnc_table_iget_nnc_index( nnc_table , index ));
+    test_assert_int_equal( 0 , nnc_table_iget_lgr_nr( nnc_table , index ));
+    cursor[ global_index1 ]++;
+  }
+
+  for (i = 0; i < NX * NY * NZ; i++) {
+    const nnc_info_type * nnc_info = ecl_grid_get_cell_nnc_info1( grid , i );
+    test_assert_int_equal( cursor[i] , nnc_table_get_cell_size( nnc_table , i ));
+    if (cursor[i] > 0) {
+      const int_vector_type * index_list = nnc_info_get_self_grid_index_list( nnc_info );
+      int offset = nnc_table_get_cell_offset( nnc_table , i );
+      int j;
+
+      test_assert_int_equal( cursor[i] , int_vector_size( index_list ));
+      for (j = 0; j < cursor[i]; j++)
+        test_assert_int_equal( nnc_table_iget_global_index( nnc_table , offset + j ) , int_vector_iget( index_list , j ));
+    } else
+      test_assert_NULL( nnc_info );
+  }
+  free( cursor );
+}
+
+
+void test_export( const ecl_grid_type * grid , const int * nnc1 , const int * nnc2 ) {
+  ecl_file_type * init_file = ecl_file_open( "CASE.INIT" , 0 );
+  ecl_nnc_type * nnc_data = util_calloc( ecl_nnc_export_get_size( grid ) , sizeof * nnc_data );
+  bool * exported = util_calloc( NUM_NNC , sizeof * exported );
+  int i;
+
+  for (i = 0; i < NUM_NNC; i++)
+    exported[i] = false;
+
+  test_assert_int_equal( NUM_NNC , ecl_nnc_export_get_size( grid ));
+  ecl_nnc_export( grid , init_file , nnc_data );
+  for (i = 0; i < NUM_NNC; i++) {
+    int nnc_index = (int) nnc_data[i].trans;
+
+    test_assert_false( exported[ nnc_index ] );
+    exported[ nnc_index ] = true;
+    test_assert_int_equal( nnc1[ nnc_index ] - 1 , nnc_data[i].global_index1 );
+    test_assert_int_equal( nnc2[ nnc_index ] - 1 , nnc_data[i].global_index2 );
+    if (i > 0)
+      test_assert_true( ecl_nnc_cmp( &nnc_data[i - 1] , &nnc_data[i] ) <= 0 );
+  }
+
+  free( exported );
+  free( nnc_data );
+  ecl_file_close( init_file );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_nnc_table");
+  int * nnc1 = util_calloc( NUM_NNC , sizeof * nnc1 );
+  int * nnc2 = util_calloc( NUM_NNC , sizeof * nnc2 );
+
+  create_case( nnc1 , nnc2 );
+  {
+    ecl_grid_type * grid = ecl_grid_alloc( "CASE.EGRID" );
+    test_export( grid , nnc1 , nnc2 );
+    test_table( grid , nnc1 , nnc2 );
+    ecl_grid_free( grid );
+  }
+  {
+    ecl_grid_type * grid = ecl_grid_alloc_compact( "CASE.EGRID" );
+    test_table( grid , nnc1 , nnc2 );
+    ecl_grid_free( grid );
+  }
+
+  free( nnc1 );
+  free( nnc2 );
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,220 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_region_select.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/int_vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+
+/* The global size is deliberately not a multiple of 64. */
+#define NX 13
+#define NY 11
+#define NZ  7
+
+
+/*
+  Checks the region against the reference selection @mask, including
+  the global and active index lists.
+*/
+
+void test_mask( ecl_region_type * region , const ecl_grid_type * grid , const bool * mask) {
+  const int_vector_type * global_list = ecl_region_get_global_list( region );
+  const int_vector_type * active_list = ecl_region_get_active_list( region );
+  const int_vector_type * global_active_list = ecl_region_get_global_active_list( region );
+  int global_size = 0;
+  int active_size = 0;
+  int global_index;
+
+  for (global_index = 0; global_index < ecl_grid_get_global_size( grid ); global_index++) {
+    test_assert_bool_equal( mask[ global_index ] , ecl_region_contains_global( region , global_index ));
+    if (mask[ global_index ]) {
+      int active_index = ecl_grid_get_active_index1( grid , global_index );
+
+      test_assert_int_equal( global_index , int_vector_iget( global_list , global_size ));
+      global_size++;
+      if (active_index >= 0) {
+        test_assert_int_equal( active_index , int_vector_iget( active_list , active_size ));
+        test_assert_int_equal( global_index , int_vector_iget( global_active_list , active_size ));
+        active_size++;
+      }
+    }
+  }
+  test_assert_int_equal( global_size , int_vector_size( global_list ));
+  test_assert_int_equal( active_size , int_vector_size( active_list ));
+  test_assert_int_equal( active_size , int_vector_size( global_active_list ));
+}
+
+
+void test_kw_select( const ecl_grid_type * grid ) {
+  const int global_size = ecl_grid_get_global_size( grid );
+  const int active_size = ecl_grid_get_active_size( grid );
+  ecl_kw_type * fipnum = ecl_kw_alloc( "FIPNUM" , global_size , ECL_INT_TYPE );
+  ecl_kw_type * poro   = ecl_kw_alloc( "PORO" , active_size , ECL_FLOAT_TYPE );
+  ecl_region_type * region = ecl_region_alloc( grid , false );
+  bool * mask = util_calloc( global_size , sizeof * mask );
+  int global_index;
+
+  for (global_index = 0; global_index < global_size; global_index++) {
+    int active_index = ecl_grid_get_active_index1( grid , global_index );
+    ecl_kw_iset_int( fipnum , global_index , global_index % 5 );
+    if (active_index >= 0)
+      ecl_kw_iset_float( poro , active_index , 0.01 * (global_index % 37));
+    mask[ global_index ] = false;
+  }
+
+  ecl_region_select_equal( region , fipnum , 3 );
+  for (global_index = 0; global_index < global_size; global_index++)
+    if (global_index % 5 == 3)
+      mask[ global_index ] = true;
+  test_mask( region , grid , mask );
+
+  ecl_region_select_in_interval( region , poro , 0.10 , 0.20 );
+  for (global_index = 0; global_index < global_size; global_index++) {
+    int active_index = ecl_grid_get_active_index1( grid , global_index );
+    if (active_index >= 0) {
+      float value = ecl_kw_iget_float( poro , active_index );
+      if (value >= 0.10f && value < 0.20f)
+        mask[ global_index ] = true;
+    }
+  }
+  test_mask( region , grid , mask );
+
+  ecl_region_deselect_larger( region , fipnum , 3 );
+  for (global_index = 0; global_index < global_size; global_index++)
+    if (global_index % 5 > 3)
+      mask[ global_index ] = false;
+  test_mask( region , grid , mask );
+
+  ecl_region_deselect_smaller( region , poro , 0.15 );
+  for (global_index = 0; global_index < global_size; global_index++) {
+    int active_index = ecl_grid_get_active_index1( grid , global_index );
+    if (active_index >= 0 && ecl_kw_iget_float( poro , active_index ) < 0.15f)
+      mask[ global_index ] = false;
+  }
+  test_mask( region , grid , mask );
+
+  ecl_region_invert_selection( region );
+  for (global_index = 0; global_index < global_size; global_index++)
+    mask[ global_index ] = !mask[ global_index ];
+  test_mask( region , grid , mask );
+
+  ecl_region_deselect_inactive_cells( region );
+  for (global_index = 0; global_index < global_size; global_index++)
+    if (!ecl_grid_cell_active1( grid , global_index ))
+      mask[ global_index ] = false;
+  test_mask( region , grid , mask );
+
+  free( mask );
+  ecl_region_free( region );
+  ecl_kw_free( poro );
+  ecl_kw_free( fipnum );
+}
+
+
+void test_slices( const ecl_grid_type * grid ) {
+  const int global_size = ecl_grid_get_global_size( grid );
+  ecl_region_type * region = ecl_region_alloc( grid , true );
+  bool * mask = util_calloc( global_size , sizeof * mask );
+  int i,j,k;
+
+  ecl_region_deselect_i1i2( region , 2 , 4 );
+  ecl_region_deselect_j1j2( region , 5 , 5 );
+  ecl_region_deselect_k1k2( region , 1 , 2 );
+  ecl_region_select_from_ijkbox( region , 3 , 3 , 0 , NY - 1 , 2 , 2 );
+  ecl_region_deselect_i1i2( region , NX + 2 , NX + 5 );
+
+  for (k = 0; k < NZ; k++)
+    for (j = 0; j < NY; j++)
+      for (i = 0; i < NX; i++) {
+        bool selected = !((i >= 2 && i <= 4) || (j == 5) || (k >= 1 && k <= 2));
+        if (i == 3 && k == 2)
+          selected = true;
+        mask[ ecl_grid_get_global_index3( grid , i , j , k ) ] = selected;
+      }
+  test_mask( region , grid , mask );
+
+  free( mask );
+  ecl_region_free( region );
+}
+
+
+void test_set_operations( const ecl_grid_type * grid ) {
+  const int global_size = ecl_grid_get_global_size( grid );
+  ecl_region_type * region1 = ecl_region_alloc( grid , false );
+  ecl_region_type * region2 = ecl_region_alloc( grid , false );
+  bool * mask1 = util_calloc( global_size , sizeof * mask1 );
+  bool * mask2 = util_calloc( global_size , sizeof * mask2 );
+  int global_index;
+
+  ecl_region_select_k1k2( region1 , 0 , 3 );
+  ecl_region_select_i1i2( region2 , 6 , 9 );
+  for (global_index = 0; global_index < global_size; global_index++) {
+    int i,j,k;
+    ecl_grid_get_ijk1( grid , global_index , &i , &j , &k );
+    mask1[ global_index ] = (k <= 3);
+    mask2[ global_index ] = (i >= 6 && i <= 9);
+  }
+
+  {
+    ecl_region_type * region = ecl_region_alloc_copy( region1 );
+    bool * mask = util_calloc( global_size , sizeof * mask );
+
+    ecl_region_union( region , region2 );
+    for (global_index = 0; global_index < global_size; global_index++)
+      mask[ global_index ] = mask1[ global_index ] || mask2[ global_index ];
+    test_mask( region , grid , mask );
+
+    ecl_region_intersection( region , region1 );
+    ecl_region_subtract( region , region2 );
+    for (global_index = 0; global_index < global_size; global_index++)
+      mask[ global_index ] = mask1[ global_index ] && !mask2[ global_index ];
+    test_mask( region , grid , mask );
+
+    free( mask );
+    ecl_region_free( region );
+  }
+
+  free( mask1 );
+  free( mask2 );
+  ecl_region_free( region1 );
+  ecl_region_free( region2 );
+}
+
+
+int main( int argc , char ** argv) {
+  int * actnum = util_calloc( NX * NY * NZ , sizeof * actnum );
+  ecl_grid_type * grid;
+  int global_index;
+
+  for (global_index = 0; global_index < NX * NY * NZ; global_index++)
+    actnum[ global_index ] = (global_index % 7 == 0) ? 0 : 1;
+
+  grid = ecl_grid_alloc_rectangular( NX , NY , NZ , 1 , 1 , 1 , actnum );
+  test_kw_select( grid );
+  test_slices( grid );
+  test_set_operations( grid );
+
+  ecl_grid_free( grid );
+  free( actnum );
+  exit(0);
+}
@@ -0,0 +1,200 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_region_stat.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/vector.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/ecl_region.h>
+#include <ert/ecl/ecl_region_stat.h>
+
+/* Large enough for the evaluation to be threaded. */
+#define NX 80
+#define NY 60
+#define NZ 40
+#define NUM_REGIONS 7
+
+
+void test_assert_close( double d1 , double d2 ) {
+  if (fabs( d1 - d2 ) > 1e-9 * (1 + fabs( d1 ) + fabs( d2 )))
+    test_error_exit("Values %.15g and %.15g differ \n", d1 , d2 );
+}
+
+
+/*
+  Brute force calculation of the statistics of keyword @kw for the
+  cells where @select is true; compared with the results for
+  @region_nr.
+*/
+
+void test_region( const ecl_region_stat_type * region_stat , int region_nr , int kw_nr , const ecl_grid_type * grid ,
+                  const bool * select , const ecl_kw_type * kw , const ecl_kw_type * weight_kw) {
+  double sum = 0;
+  double weighted_sum = 0;
+  double weight = 0;
+  double min = 0;
+  double max = 0;
+  int count = 0;
+  int active_index;
+
+  for (active_index = 0; active_index < ecl_grid_get_active_size( grid ); active_index++) {
+    if (select[ active_index ]) {
+      double w = ecl_kw_iget_as_double( weight_kw , ecl_grid_get_global_index1A( grid , active_index ));
+      double v = ecl_kw_iget_as_double( kw , active_index );
+
+      if (count == 0) {
+        min = v;
+        max = v;
+      } else {
+        min = util_double_min( min , v );
+        max = util_double_max( max , v );
+      }
+      sum += v;
+      weighted_sum += w * v;
+      weight += w;
+      count++;
+    }
+  }
+
+  test_assert_int_equal( count , ecl_region_stat_get_count( region_stat , region_nr ));
+  test_assert_close( weight , ecl_region_stat_get_weight( region_stat , region_nr ));
+  test_assert_close( sum , ecl_region_stat_get_sum( region_stat , region_nr , kw_nr ));
+  test_assert_double_equal( min , ecl_region_stat_get_min( region_stat , region_nr , kw_nr ));
+  test_assert_double_equal( max , ecl_region_stat_get_max( region_stat , region_nr , kw_nr ));
+  if (count > 0) {
+    test_assert_close( sum / count , ecl_region_stat_get_mean( region_stat , region_nr , kw_nr ));
+    test_assert_close( weighted_sum / weight , ecl_region_stat_get_weighted_mean( region_stat , region_nr , kw_nr ));
+  }
+}
+
+
+int main( int argc , char ** argv) {
+  int * actnum = util_calloc( NX * NY * NZ , sizeof * actnum );
+  ecl_grid_type * grid;
+  int global_index;
+
+  for (global_index = 0; global_index < NX * NY * NZ; global_index++)
+    actnum[ global_index ] = (global_index % 11 == 0) ? 0 : 1;
+  grid = ecl_grid_alloc_rectangular( NX , NY , NZ , 1 , 1 , 1 , actnum );
+
+  {
+    const int active_size = ecl_grid_get_active_size( grid );
+    const int global_size = ecl_grid_get_global_size( grid );
+    ecl_kw_type * fipnum   = ecl_kw_alloc( "FIPNUM" , active_size , ECL_INT_TYPE );
+    ecl_kw_type * pressure = ecl_kw_alloc( "PRESSURE" , active_size , ECL_FLOAT_TYPE );
+    ecl_kw_type * swat     = ecl_kw_alloc( "SWAT" , active_size , ECL_DOUBLE_TYPE );
+    ecl_kw_type * porv     = ecl_kw_alloc( "PORV" , global_size , ECL_FLOAT_TYPE );
+    ecl_region_stat_type * region_stat = ecl_region_stat_alloc( grid , porv );
+    bool * select = util_calloc( active_size , sizeof * select );
+    int active_index , region_nr;
+
+    for (global_index = 0; global_index < global_size; global_index++)
+      ecl_kw_iset_float( porv , global_index , 100 + (global_index % 13));
+
+    for (active_index = 0; active_index < active_size; active_index++) {
+      /* Region 0 is left empty, and some cells are not in any region. */
+      ecl_kw_iset_int( fipnum , active_index , (active_index % 17 == 0) ? -1 : 1 + (active_index % (NUM_REGIONS - 1)));
+      ecl_kw_iset_float( pressure , active_index , 200 + 0.01 * (active_index % 1001));
+      ecl_kw_iset_double( swat , active_index , 0.001 * (active_index % 997));
+    }
+
+    ecl_region_stat_add_kw( region_stat , pressure );
+    ecl_region_stat_add_kw( region_stat , swat );
+    test_assert_true( ecl_region_stat_is_instance( region_stat ));
+    test_assert_int_equal( 2 , ecl_region_stat_get_num_kw( region_stat ));
+
+    /* Regions from the FIPNUM keyword. */
+    ecl_region_stat_eval_region_kw( region_stat , fipnum );
+    test_assert_int_equal( NUM_REGIONS , ecl_region_stat_get_num_regions( region_stat ));
+    for (region_nr = 0; region_nr < NUM_REGIONS; region_nr++) {
+      for (active_index = 0; active_index < active_size; active_index++)
+        select[ active_index ] = (ecl_kw_iget_int( fipnum , active_index ) == region_nr);
+
+      test_region( region_stat , region_nr , 0 , grid , select , pressure , porv );
+      test_region( region_stat , region_nr , 1 , grid , select , swat , porv );
+    }
+    test_assert_double_equal( 0 , ecl_region_stat_get_mean( region_stat , 0 , 0 ));
+
+    /* The same regions as a list of ecl_region instances, and one overlapping region. */
+    {
+      vector_type * region_list = vector_alloc_new();
+      for (region_nr = 0; region_nr < NUM_REGIONS; region_nr++) {
+        ecl_region_type * region = ecl_region_alloc( grid , false );
+        ecl_region_select_equal( region , fipnum , region_nr );
+        vector_append_owned_ref( region_list , region , ecl_region_free__ );
+      }
+      {
+        ecl_region_type * region = ecl_region_alloc( grid , false );
+        ecl_region_select_k1k2( region , 2 , 5 );
+        vector_append_owned_ref( region_list , region , ecl_region_free__ );
+      }
+
+      ecl_region_stat_eval_region_list( region_stat , region_list );
+      test_assert_int_equal( NUM_REGIONS + 1 , ecl_region_stat_get_num_regions( region_stat ));
+      for (region_nr = 0; region_nr < NUM_REGIONS; region_nr++) {
+        for (active_index = 0; active_index < active_size; active_index++)
+          select[ active_index ] = (ecl_kw_iget_int( fipnum , active_index ) == region_nr);
+
+        test_region( region_stat , region_nr , 0 , grid , select , pressure , porv );
+        test_region( region_stat , region_nr , 1 , grid , select , swat , porv );
+      }
+
+      for (active_index = 0; active_index < active_size; active_index++) {
+        int i,j,k;
+        ecl_grid_get_ijk1A( grid , active_index , &i , &j , &k );
+        select[ active_index ] = (k >= 2 && k <= 5);
+      }
+      test_region( region_stat , NUM_REGIONS , 0 , grid , select , pressure , porv );
+      test_region( region_stat , NUM_REGIONS , 1 , grid , select , swat , porv );
+      vector_free( region_list );
+    }
+
+    /* Only counts and weights; no keywords. */
+    {
+      ecl_region_stat_type * count_stat = ecl_region_stat_alloc( grid , NULL );
+      int count = 0;
+
+      for (active_index = 0; active_index < active_size; active_index++)
+        if (ecl_kw_iget_int( fipnum , active_index ) == 1)
+          count++;
+
+      ecl_region_stat_eval_region_kw( count_stat , fipnum );
+      test_assert_int_equal( 0 , ecl_region_stat_get_num_kw( count_stat ));
+      test_assert_int_equal( count , ecl_region_stat_get_count( count_stat , 1 ));
+      test_assert_double_equal( count , ecl_region_stat_get_weight( count_stat , 1 ));
+      test_assert_int_equal( 0 , ecl_region_stat_get_count( count_stat , 0 ));
+      ecl_region_stat_free( count_stat );
+    }
+
+    free( select );
+    ecl_region_stat_free( region_stat );
+    ecl_kw_free( porv );
+    ecl_kw_free( swat );
+    ecl_kw_free( pressure );
+    ecl_kw_free( fipnum );
+  }
+
+  ecl_grid_free( grid );
+  free( actnum );
+  exit(0);
+}
@@ -0,0 +1,297 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_rft_index.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/thread_pool.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/fortio.h>
+#include <ert/ecl/ecl_rft_file.h>
+#include <ert/ecl/ecl_rft_node.h>
+
+#define NUM_WELLS     3
+#define NUM_TIMES     4
+#define NUM_CELLS     5
+
+
+static const char * well_names[NUM_WELLS] = {"OP_1" , "OP_2" , "WI_1"};
+
+
+double cell_pressure( int well , int time , int c ) {
+  return 200 + 10 * time + well + 0.125 * c;
+}
+
+
+time_t rft_date( int time ) {
+  return ecl_util_make_date( 1 , time + 1 , 2000 );
+}
+
+
+void fwrite_block( fortio_type * fortio , const char * type , const char * well , int time , int well_nr) {
+  ecl_kw_type * time_kw    = ecl_kw_alloc( TIME_KW , 1 , ECL_FLOAT_TYPE );
+  ecl_kw_type * date_kw    = ecl_kw_alloc( DATE_KW , 3 , ECL_INT_TYPE );
+  ecl_kw_type * welletc    = ecl_kw_alloc( WELLETC_KW , 16 , ECL_CHAR_TYPE );
+  ecl_kw_type * conipos    = ecl_kw_alloc( CONIPOS_KW , NUM_CELLS , ECL_INT_TYPE );
+  ecl_kw_type * conjpos    = ecl_kw_alloc( CONJPOS_KW , NUM_CELLS , ECL_INT_TYPE );
+  ecl_kw_type * conkpos    = ecl_kw_alloc( CONKPOS_KW , NUM_CELLS , ECL_INT_TYPE );
+  ecl_kw_type * depth      = ecl_kw_alloc( DEPTH_KW , NUM_CELLS , ECL_FLOAT_TYPE );
+  ecl_kw_type * pressure   = ecl_kw_alloc( PRESSURE_KW , NUM_CELLS , ECL_FLOAT_TYPE );
+  ecl_kw_type * swat       = ecl_kw_alloc( SWAT_KW , NUM_CELLS , ECL_FLOAT_TYPE );
+  ecl_kw_type * sgas       = ecl_kw_alloc( SGAS_KW , NUM_CELLS , ECL_FLOAT_TYPE );
+  int c;
+
+  ecl_kw_iset_float( time_kw , 0 , 31 * time );
+  ecl_kw_iset_int( date_kw , DATE_DAY_INDEX , 1 );
+  ecl_kw_iset_int( date_kw , DATE_MONTH_INDEX , time + 1 );
+  ecl_kw_iset_int( date_kw , DATE_YEAR_INDEX , 2000 );
+  for (c = 0; c < 16; c++)
+    ecl_kw_iset_string8( welletc , c , "");
+  ecl_kw_iset_string8( welletc , WELLETC_NAME_INDEX , well );
+  ecl_kw_iset_string8( welletc , WELLETC_TYPE_INDEX , type );
+  
+  for (c = 0; c < NUM_CELLS; c++) {
+    ecl_kw_iset_int( conipos , c , well_nr + 1 );
+    ecl_kw_iset_int( conjpos , c , 2 );
+    ecl_kw_iset_int( conkpos , c , c + 1 );
+    ecl_kw_iset_float( depth , c , 2000 + c );
+    ecl_kw_iset_float( pressure , c , cell_pressure( well_nr , time , c ));
+    ecl_kw_iset_float( swat , c , 0.125 * c );
+    ecl_kw_iset_float( sgas , c , 0.0625 * time );
+  }
+  
+  ecl_kw_fwrite( time_kw , fortio );
+  ecl_kw_fwrite( date_kw , fortio );
+  ecl_kw_fwrite( welletc , fortio );
+  ecl_kw_fwrite( conipos , fortio );
+  ecl_kw_fwrite( conjpos , fortio );
+  ecl_kw_fwrite( conkpos , fortio );
+  ecl_kw_fwrite( depth , fortio );
+  ecl_kw_fwrite( pressure , fortio );
+  ecl_kw_fwrite( swat , fortio );
+  ecl_kw_fwrite( sgas , fortio );
+
+  ecl_kw_free( time_kw );
+  ecl_kw_free( date_kw );
+  ecl_kw_free( welletc );
+  ecl_kw_free( conipos );
+  ecl_kw_free( conjpos );
+  ecl_kw_free( conkpos );
+  ecl_kw_free( depth );
+  ecl_kw_free( pressure );
+  ecl_kw_free( swat );
+  ecl_kw_free( sgas );
+}
+
+
+/* 
+   The file contains one RFT for each well at each time, and one
+   SEGMENT block which should be skipped.
+*/
+
+void create_rft( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  int time , well;
+  for (time = 0; time < NUM_TIMES; time++) {
+    for (well = 0; well < NUM_WELLS; well++)
+      fwrite_block( fortio , "R" , well_names[well] , time , well );
+    
+    if (time == 1)
+      fwrite_block( fortio , "S" , "SEG" , time , 0 );
+  }
+  fortio_fclose( fortio );
+}
+
+
+void test_header( const char * filename ) {
+  ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
+  ecl_rft_node_type * node;
+
+  ecl_file_select_block( ecl_file , TIME_KW , 2 );
+  node = ecl_rft_node_alloc_header( ecl_file_iget_named_kw( ecl_file , WELLETC_KW , 0 ) ,
+                                    ecl_file_iget_named_kw( ecl_file , DATE_KW , 0 ) ,
+                                    ecl_file_iget_named_kw( ecl_file , TIME_KW , 0 ));
+  
+  test_assert_string_equal( ecl_rft_node_get_well_name( node ) , well_names[2] );
+  test_assert_time_t_equal( ecl_rft_node_get_date( node ) , rft_date( 0 ));
+  test_assert_false( ecl_rft_node_cells_loaded( node ));
+  test_assert_int_equal( ecl_rft_node_get_size( node ) , 0 );
+
+  ecl_rft_node_load_cells( node , ecl_file );
+  test_assert_true( ecl_rft_node_cells_loaded( node ));
+  test_assert_int_equal( ecl_rft_node_get_size( node ) , NUM_CELLS );
+  test_assert_double_equal( ecl_rft_node_iget_pressure( node , 3 ) , cell_pressure( 2 , 0 , 3 ));
+  
+  /* The cells have been copied into the node; the keywords can be unloaded. */
+  {
+    ecl_file_kw_type * file_kw = ecl_file_iget_named_file_kw( ecl_file , PRESSURE_KW , 0 );
+    test_assert_not_NULL( ecl_file_kw_get_kw_ptr( file_kw , NULL , NULL ));
+    ecl_file_unload_active( ecl_file );
+    test_assert_NULL( ecl_file_kw_get_kw_ptr( file_kw , NULL , NULL ));
+    test_assert_double_equal( ecl_rft_node_iget_pressure( node , 3 ) , cell_pressure( 2 , 0 , 3 ));
+    test_assert_double_equal( ecl_kw_iget_float( ecl_file_iget_named_kw( ecl_file , PRESSURE_KW , 0 ) , 3 ) , cell_pressure( 2 , 0 , 3 ));
+  }
+
+  ecl_rft_node_free( node );
+  ecl_file_close( ecl_file );
+}
+
+
+void test_index( const ecl_rft_file_type * rft_file ) {
+  int time , well;
+
+  test_assert_int_equal( ecl_rft_file_get_size( rft_file ) , NUM_WELLS * NUM_TIMES );
+  test_assert_int_equal( ecl_rft_file_get_num_wells( rft_file ) , NUM_WELLS );
+  test_assert_false( ecl_rft_file_has_well( rft_file , "SEG" ));
+  test_assert_int_equal( ecl_rft_file_get_size__( rft_file , "OP*" , rft_date( 1 )) , 2 );
+  
+  for (time = 0; time < NUM_TIMES; time++) {
+    for (well = 0; well < NUM_WELLS; well++) {
+      int index = ecl_rft_file_get_well_time_index( rft_file , well_names[well] , rft_date( time ));
+      ecl_rft_node_type * node = ecl_rft_file_get_well_time_rft( rft_file , well_names[well] , rft_date( time ));
+
+      test_assert_int_equal( index , time * NUM_WELLS + well );
+      test_assert_true( ecl_rft_node_cells_loaded( node ));
+      test_assert_true( node == ecl_rft_file_iget_well_rft( rft_file , well_names[well] , time ));
+      test_assert_int_equal( ecl_rft_node_get_size( node ) , NUM_CELLS );
+      test_assert_double_equal( ecl_rft_node_iget_pressure( node , 2 ) , cell_pressure( well , time , 2 ));
+    }
+  }
+  
+  test_assert_int_equal( ecl_rft_file_get_well_time_index( rft_file , "OP_1" , rft_date( NUM_TIMES )) , -1 );
+  test_assert_NULL( ecl_rft_file_get_well_time_rft( rft_file , "OP_1" , rft_date( NUM_TIMES )));
+  test_assert_NULL( ecl_rft_file_get_well_time_rft( rft_file , "NO_SUCH_WELL" , rft_date( 0 )));
+}
+
+
+void test_lookup( const ecl_rft_file_type * rft_file ) {
+  const int num_points = NUM_WELLS * NUM_TIMES * NUM_CELLS + 2;
+  const char ** wells = util_calloc( num_points , sizeof * wells );
+  time_t * times = util_calloc( num_points , sizeof * times );
+  int * i = util_calloc( num_points , sizeof * i );
+  int * j = util_calloc( num_points , sizeof * j );
+  int * k = util_calloc( num_points , sizeof * k );
+  double * pressure = util_calloc( num_points , sizeof * pressure );
+  double * swat = util_calloc( num_points , sizeof * swat );
+  bool * found = util_calloc( num_points , sizeof * found );
+  int point = 0;
+  int time , well , c;
+
+  for (time = 0; time < NUM_TIMES; time++) {
+    for (well = 0; well < NUM_WELLS; well++) {
+      for (c = 0; c < NUM_CELLS; c++) {
+        wells[point] = well_names[well];
+        times[point] = rft_date( time );
+        i[point] = well;
+        j[point] = 1;
+        k[point] = c;
+        point++;
+      }
+    }
+  }
+  
+  /* A missing connection and a missing time. */
+  wells[point] = well_names[0]; times[point] = rft_date( 0 ); i[point] = 7; j[point] = 1; k[point] = 0; point++;
+  wells[point] = well_names[0]; times[point] = rft_date( NUM_TIMES ); i[point] = 0; j[point] = 1; k[point] = 0; point++;
+
+  test_assert_int_equal( ecl_rft_file_lookup_cells( rft_file , num_points , wells , times , i , j , k , pressure , swat , NULL , found ) , num_points - 2 );
+  
+  point = 0;
+  for (time = 0; time < NUM_TIMES; time++) {
+    for (well = 0; well < NUM_WELLS; well++) {
+      for (c = 0; c < NUM_CELLS; c++) {
+        test_assert_true( found[point] );
+        test_assert_double_equal( pressure[point] , cell_pressure( well , time , c ));
+        test_assert_double_equal( swat[point] , 0.125 * c );
+        point++;
+      }
+    }
+  }
+  test_assert_false( found[point] );
+  test_assert_false( found[point + 1] );
+  test_assert_double_equal( pressure[point + 1] , 0 );
+
+  free( wells );
+  free( times );
+  free( i );
+  free( j );
+  free( k );
+  free( pressure );
+  free( swat );
+  free( found );
+}
+
+
+/*
+  Several threads load the cells of the same nodes concurrently.
+*/
+
+void * test_threaded__( void * arg ) {
+  const ecl_rft_file_type * rft_file = (const ecl_rft_file_type *) arg;
+  int index;
+  for (index = 0; index < ecl_rft_file_get_size( rft_file ); index++) {
+    ecl_rft_node_type * node = ecl_rft_file_iget_node( rft_file , index );
+    int time = index / NUM_WELLS;
+    int well = index % NUM_WELLS;
+
+    test_assert_true( ecl_rft_node_cells_loaded( node ));
+    test_assert_double_equal( ecl_rft_node_iget_pressure( node , 3 ) , cell_pressure( well , time , 3 ));
+  }
+  return NULL;
+}
+
+
+void test_threaded( const char * filename ) {
+  ecl_rft_file_type * rft_file = ecl_rft_file_alloc( filename );
+  thread_pool_type * tp = thread_pool_alloc( 4 , true );
+  int i;
+
+  for (i = 0; i < 8; i++)
+    thread_pool_add_job( tp , test_threaded__ , rft_file );
+  thread_pool_join( tp );
+  thread_pool_free( tp );
+  ecl_rft_file_free( rft_file );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_rft_index");
+  create_rft( "CASE.RFT" );
+  test_header( "CASE.RFT" );
+  {
+    ecl_rft_file_type * rft_file = ecl_rft_file_alloc( "CASE.RFT" );
+    test_index( rft_file );
+    test_lookup( rft_file );
+    ecl_rft_file_free( rft_file );
+  }
+  {
+    ecl_rft_file_type * rft_file = ecl_rft_file_alloc( "CASE.RFT" );
+    test_lookup( rft_file );
+    ecl_rft_file_free( rft_file );
+  }
+  test_threaded( "CASE.RFT" );
+  test_work_area_free( work_area );
+  exit(0);
+}
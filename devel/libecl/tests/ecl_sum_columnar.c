@@ -0,0 +1,178 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_columnar.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/smspec_node.h>
+
+#define NUM_REPORT   10
+#define NUM_MINISTEP  3
+
+
+void write_case( const char * case_name ) {
+  time_t start_time = util_make_date( 1 , 1 , 2010 );
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( case_name , false , true , ":" , start_time , 10 , 10 , 10 );
+  double sim_days = 0;
+  int report_step;
+
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL   , 0 , "Barrels" , 0.0 );
+  ecl_sum_add_var( ecl_sum , "FOPR" , NULL   , 0 , "Barrels" , 0.0 );
+  ecl_sum_add_var( ecl_sum , "WWCT" , "OP-1" , 0 , "(1)"     , 0.0 );
+
+  ecl_sum_set_columnar( ecl_sum , true );
+  for (report_step = 0; report_step < NUM_REPORT; report_step++) {
+    int step;
+    for (step = 0; step < NUM_MINISTEP; step++) {
+      ecl_sum_tstep_type * tstep;
+
+      sim_days += 10;
+      tstep = ecl_sum_add_tstep( ecl_sum , report_step + 1 , sim_days );
+      ecl_sum_tstep_set_from_key( tstep , "FOPT" , sim_days * 100 );
+      ecl_sum_tstep_set_from_key( tstep , "FOPR" , report_step );
+      ecl_sum_tstep_set_from_key( tstep , "WWCT:OP-1" , sim_days / 1000 );
+    }
+  }
+  test_assert_true( ecl_sum_is_columnar( ecl_sum ));
+  test_assert_int_equal( ecl_sum_get_data_vector_length( ecl_sum , false ) , NUM_REPORT * NUM_MINISTEP );
+  {
+    int fopt_index = ecl_sum_get_general_var_params_index( ecl_sum , "FOPT" );
+    int time_index;
+    for (time_index = 0; time_index < NUM_REPORT * NUM_MINISTEP; time_index++)
+      test_assert_double_equal( ecl_sum_iget( ecl_sum , time_index , fopt_index ) , (time_index + 1) * 10 * 100 );
+  }
+
+  ecl_sum_fwrite( ecl_sum );
+  ecl_sum_free( ecl_sum );
+}
+
+
+/*
+  A tstep which is added out of time order forces the columns back to
+  rows before the tsteps are sorted.
+*/
+
+void test_write_unsorted( ) {
+  time_t start_time = util_make_date( 1 , 1 , 2010 );
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( "UNSORTED" , false , true , ":" , start_time , 10 , 10 , 10 );
+  double sim_days[] = { 10 , 20 , 30 , 15 , 40 };
+  int fopt_index;
+  int i;
+
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL , 0 , "Barrels" , 0.0 );
+  fopt_index = ecl_sum_get_general_var_params_index( ecl_sum , "FOPT" );
+  ecl_sum_set_columnar( ecl_sum , true );
+  for (i = 0; i < 5; i++) {
+    ecl_sum_tstep_type * tstep = ecl_sum_add_tstep( ecl_sum , i + 1 , sim_days[i] );
+    ecl_sum_tstep_set_from_key( tstep , "FOPT" , sim_days[i] * 100 );
+  }
+
+  test_assert_true( ecl_sum_is_columnar( ecl_sum ));
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 0 , fopt_index ) , 1000 );
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 1 , fopt_index ) , 1500 );
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 2 , fopt_index ) , 2000 );
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 3 , fopt_index ) , 3000 );
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 4 , fopt_index ) , 4000 );
+
+  ecl_sum_set_columnar( ecl_sum , false );
+  test_assert_false( ecl_sum_is_columnar( ecl_sum ));
+  test_assert_double_equal( ecl_sum_iget( ecl_sum , 1 , fopt_index ) , 1500 );
+  ecl_sum_free( ecl_sum );
+}
+
+
+void test_fill( ecl_sum_type * ecl_sum , bool report_only ) {
+  stringlist_type * key_list = stringlist_alloc_new();
+  int length = ecl_sum_get_data_vector_length( ecl_sum , report_only );
+  double * row_buffer;
+  double * column_buffer;
+
+  stringlist_append_ref( key_list , "WWCT:OP-1" );
+  stringlist_append_ref( key_list , "FOPT" );
+  stringlist_append_ref( key_list , "FOPR" );
+
+  test_assert_int_equal( length , report_only ? NUM_REPORT : NUM_REPORT * NUM_MINISTEP );
+  row_buffer = util_calloc( length * stringlist_get_size( key_list ) , sizeof * row_buffer );
+  column_buffer = util_calloc( length * stringlist_get_size( key_list ) , sizeof * column_buffer );
+
+  ecl_sum_set_columnar( ecl_sum , false );
+  ecl_sum_fill_data_vectors( ecl_sum , key_list , report_only , row_buffer );
+  ecl_sum_set_columnar( ecl_sum , true );
+  ecl_sum_fill_data_vectors( ecl_sum , key_list , report_only , column_buffer );
+
+  {
+    int ikey , t;
+    for (ikey = 0; ikey < stringlist_get_size( key_list ); ikey++) {
+      for (t = 0; t < length; t++) {
+        int time_index = report_only ? (t + 1) * NUM_MINISTEP - 1 : t;
+        int params_index = ecl_sum_get_general_var_params_index( ecl_sum , stringlist_iget( key_list , ikey ));
+        double value = ecl_sum_iget( ecl_sum , time_index , params_index );
+
+        test_assert_double_equal( value , row_buffer[ ikey * length + t ] );
+        test_assert_double_equal( value , column_buffer[ ikey * length + t ] );
+      }
+    }
+  }
+
+  free( row_buffer );
+  free( column_buffer );
+  stringlist_free( key_list );
+}
+
+
+void test_data_vector( ecl_sum_type * ecl_sum ) {
+  int params_index = ecl_sum_get_general_var_params_index( ecl_sum , "FOPT" );
+  double_vector_type * row_vector;
+  double_vector_type * column_vector;
+
+  ecl_sum_set_columnar( ecl_sum , false );
+  row_vector = ecl_sum_alloc_data_vector( ecl_sum , params_index , false );
+  ecl_sum_set_columnar( ecl_sum , true );
+  column_vector = ecl_sum_alloc_data_vector( ecl_sum , params_index , false );
+
+  test_assert_true( double_vector_equal( row_vector , column_vector ));
+
+  double_vector_free( row_vector );
+  double_vector_free( column_vector );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_sum_columnar");
+
+  write_case( "CASE" );
+  test_write_unsorted( );
+  {
+    ecl_sum_type * ecl_sum = ecl_sum_fread_alloc_case( "CASE" , ":" );
+    test_assert_not_NULL( ecl_sum );
+
+    test_fill( ecl_sum , false );
+    test_fill( ecl_sum , true );
+    test_data_vector( ecl_sum );
+
+    ecl_sum_free( ecl_sum );
+  }
+
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -0,0 +1,155 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway.
+
+   The file 'ecl_sum_ensemble.c' is part of ERT - Ensemble based Reservoir Tool.
+
+   ERT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.
+
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html>
+   for more details.
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_sum.h>
+#include <ert/ecl/ecl_sum_ensemble.h>
+
+#define NUM_REALISATIONS 8
+#define NUM_REPORT       5
+
+
+void write_case( const char * case_name , int iens , bool extra_var) {
+  time_t start_time = util_make_date( 1 , 1 , 2010 );
+  ecl_sum_type * ecl_sum = ecl_sum_alloc_writer( case_name , false , true , ":" , start_time , 10 , 10 , 10 );
+  int report_step;
+
+  ecl_sum_add_var( ecl_sum , "FOPT" , NULL   , 0 , "Barrels" , 0.0 );
+  ecl_sum_add_var( ecl_sum , "WWCT" , "OP-1" , 0 , "(1)"     , 0.0 );
+  if (extra_var)
+    ecl_sum_add_var( ecl_sum , "FGPT" , NULL , 0 , "SM3" , 0.0 );
+
+  for (report_step = 0; report_step < NUM_REPORT; report_step++) {
+    ecl_sum_tstep_type * tstep = ecl_sum_add_tstep( ecl_sum , report_step + 1 , 10 * (report_step + 1));
+    ecl_sum_tstep_set_from_key( tstep , "FOPT" , iens * 1000 + report_step );
+    ecl_sum_tstep_set_from_key( tstep , "WWCT:OP-1" , iens * 0.01 );
+  }
+  ecl_sum_fwrite( ecl_sum );
+  ecl_sum_free( ecl_sum );
+}
+
+
+/*
+  Each callback writes only its own slot in the result arrays, so no
+  locking is needed.
+*/
+
+typedef struct {
+  int    * data_length;
+  double * last_fopt;
+} apply_result_type;
+
+
+void apply_case( const ecl_sum_type * ecl_sum , int index , void * arg) {
+  apply_result_type * result = arg;
+  if (ecl_sum != NULL) {
+    int last = ecl_sum_get_data_length( ecl_sum ) - 1;
+    result->data_length[index] = ecl_sum_get_data_length( ecl_sum );
+    result->last_fopt[index] = ecl_sum_get_general_var( ecl_sum , last , "FOPT" );
+  } else
+    result->data_length[index] = -1;
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("ecl_sum_ensemble");
+  stringlist_type * case_list = stringlist_alloc_new();
+  int iens;
+
+  for (iens = 0; iens < NUM_REALISATIONS; iens++) {
+    char * path = util_alloc_sprintf("realisation-%d" , iens);
+    char * case_name = util_alloc_filename( path , "CASE" , NULL );
+
+    util_make_path( path );
+    write_case( case_name , iens , (iens == NUM_REALISATIONS - 1));
+    stringlist_append_owned_ref( case_list , case_name );
+    free( path );
+  }
+  stringlist_append_copy( case_list , "does-not-exist/CASE" );
+
+  {
+    ecl_sum_ensemble_type * ensemble = ecl_sum_ensemble_fread_alloc( case_list , ":" , 4 );
+
+    test_assert_true( ecl_sum_ensemble_is_instance( ensemble ));
+    test_assert_int_equal( ecl_sum_ensemble_get_size( ensemble ) , NUM_REALISATIONS + 1 );
+    test_assert_int_equal( ecl_sum_ensemble_get_num_smspec( ensemble ) , 2 );
+    test_assert_NULL( ecl_sum_ensemble_iget( ensemble , NUM_REALISATIONS ));
+    {
+      time_t start_time , end_time;
+      test_assert_false( ecl_sum_fread_time_span( "does-not-exist/CASE" , ":" , &start_time , &end_time ));
+    }
+
+    for (iens = 0; iens < NUM_REALISATIONS; iens++) {
+      const char * case_name = ecl_sum_ensemble_iget_case( ensemble , iens );
+      ecl_sum_type * member = ecl_sum_ensemble_iget( ensemble , iens );
+      ecl_sum_type * ecl_sum = ecl_sum_fread_alloc_case( case_name , ":" );
+      int time_index;
+
+      test_assert_not_NULL( member );
+      test_assert_true( ecl_sum_same_case( member , case_name ));
+      {
+        time_t start_time , end_time;
+        test_assert_true( ecl_sum_fread_time_span( case_name , ":" , &start_time , &end_time ));
+        test_assert_true( start_time == ecl_sum_get_start_time( ecl_sum ));
+        test_assert_true( end_time == ecl_sum_get_end_time( ecl_sum ));
+      }
+      test_assert_int_equal( ecl_sum_get_data_length( member ) , ecl_sum_get_data_length( ecl_sum ));
+      for (time_index = 0; time_index < ecl_sum_get_data_length( ecl_sum ); time_index++) {
+        test_assert_double_equal( ecl_sum_get_general_var( member , time_index , "FOPT" ) , ecl_sum_get_general_var( ecl_sum , time_index , "FOPT" ));
+        test_assert_double_equal( ecl_sum_get_general_var( member , time_index , "WWCT:OP-1" ) , iens * 0.01 );
+      }
+
+      if (iens < NUM_REALISATIONS - 1) {
+        test_assert_false( ecl_sum_has_general_var( member , "FGPT" ));
+        test_assert_true( ecl_sum_get_smspec( member ) == ecl_sum_get_smspec( ecl_sum_ensemble_iget( ensemble , 0 )));
+      } else
+        test_assert_true( ecl_sum_has_general_var( member , "FGPT" ));
+
+      ecl_sum_free( ecl_sum );
+    }
+    ecl_sum_ensemble_free( ensemble );
+  }
+
+  {
+    apply_result_type result;
+    result.data_length = util_calloc( NUM_REALISATIONS + 1 , sizeof * result.data_length );
+    result.last_fopt = util_calloc( NUM_REALISATIONS + 1 , sizeof * result.last_fopt );
+    for (iens = 0; iens <= NUM_REALISATIONS; iens++)
+      result.data_length[iens] = 0;
+
+    ecl_sum_ensemble_fread_apply( case_list , ":" , 4 , apply_case , &result );
+    for (iens = 0; iens < NUM_REALISATIONS; iens++) {
+      test_assert_int_equal( result.data_length[iens] , NUM_REPORT );
+      test_assert_double_equal( result.last_fopt[iens] , iens * 1000 + NUM_REPORT - 1 );
+    }
+    test_assert_int_equal( result.data_length[NUM_REALISATIONS] , -1 );
+
+    free( result.data_length );
+    free( result.last_fopt );
+  }
+
+  stringlist_free( case_list );
+  test_work_area_free( work_area );
+  exit(0);
+}
@@ -24,6 +24,10 @@ add_executable( ecl_nnc_export_get_tran ecl_nnc_export_get_tran.c )
 target_link_libraries( ecl_nnc_export_get_tran ecl test_util )
 add_test (ecl_nnc_export_get_tran ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_export_get_tran  ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Troll/MSW_LGR/2BRANCHES-CCEWELLPATH-NEW-SCH-TUNED-AR3)
 
+add_executable( ecl_kw_kernel_bench ecl_kw_kernel_bench.c )
+target_link_libraries( ecl_kw_kernel_bench ecl test_util )
+add_test( ecl_kw_kernel_bench ${EXECUTABLE_OUTPUT_PATH}/ecl_kw_kernel_bench 100000 2 )
+
 add_executable( ecl_valid_basename ecl_valid_basename.c )
 target_link_libraries( ecl_valid_basename ecl test_util )
 add_test( ecl_valid_basename ${EXECUTABLE_OUTPUT_PATH}/ecl_valid_basename)
@@ -61,6 +65,34 @@ add_test( ecl_grid_cell_contains3 ${EXECUTABLE_OUTPUT_PATH}/ecl_grid_cell_contai
 
 add_test( ecl_grid_cell_contains4 ${EXECUTABLE_OUTPUT_PATH}/ecl_grid_cell_contains 4 ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Brazil/R3_ICD.EGRID )
 
+add_executable( ecl_grid_global_index_xyz ecl_grid_global_index_xyz.c )
+target_link_libraries( ecl_grid_global_index_xyz ecl test_util )
+add_test( ecl_grid_global_index_xyz ${EXECUTABLE_OUTPUT_PATH}/ecl_grid_global_index_xyz )
+
+add_executable( ecl_grid_compact ecl_grid_compact.c )
+target_link_libraries( ecl_grid_compact ecl test_util )
+add_test( ecl_grid_compact ${EXECUTABLE_OUTPUT_PATH}/ecl_grid_compact )
+
+add_executable( ecl_grid_lazy ecl_grid_lazy.c )
+target_link_libraries( ecl_grid_lazy ecl test_util )
+add_test( ecl_grid_lazy ${EXECUTABLE_OUTPUT_PATH}/ecl_grid_lazy )
+
+add_executable( ecl_grav_common ecl_grav_common.c )
+target_link_libraries( ecl_grav_common ecl test_util )
+add_test( ecl_grav_common ${EXECUTABLE_OUTPUT_PATH}/ecl_grav_common )
+
+add_executable( ecl_grdecl_file ecl_grdecl_file.c )
+target_link_libraries( ecl_grdecl_file ecl test_util )
+add_test( ecl_grdecl_file ${EXECUTABLE_OUTPUT_PATH}/ecl_grdecl_file )
+
+add_executable( ecl_region_select ecl_region_select.c )
+target_link_libraries( ecl_region_select ecl test_util )
+add_test( ecl_region_select ${EXECUTABLE_OUTPUT_PATH}/ecl_region_select )
+
+add_executable( ecl_region_stat ecl_region_stat.c )
+target_link_libraries( ecl_region_stat ecl test_util )
+add_test( ecl_region_stat ${EXECUTABLE_OUTPUT_PATH}/ecl_region_stat )
+
 add_executable( ecl_tetrahedron_contains ecl_tetrahedron_contains.c )
 target_link_libraries( ecl_tetrahedron_contains ecl test_util )
 add_test( ecl_tetrahedron_contains1 ${EXECUTABLE_OUTPUT_PATH}/ecl_tetrahedron_contains)
@@ -123,6 +155,10 @@ add_test (ecl_nnc_test3 ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_test  ${PROJECT_SOURCE
 add_test (ecl_nnc_test4 ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_test  ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/DualPoro/DUAL_DIFF.EGRID )
 add_test (ecl_nnc_test5 ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_test  ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/nestedLGRcase/TESTCASE_NESTEDLGR.EGRID)
 
+add_executable( ecl_nnc_table ecl_nnc_table.c )
+target_link_libraries( ecl_nnc_table ecl test_util )
+add_test (ecl_nnc_table ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_table )
+
 add_executable( ecl_nnc_info_test ecl_nnc_info_test.c )
 target_link_libraries( ecl_nnc_info_test ecl test_util )
 add_test (ecl_nnc_info_test ${EXECUTABLE_OUTPUT_PATH}/ecl_nnc_info_test )
@@ -158,6 +194,14 @@ add_executable( ecl_util_month_range ecl_util_month_range.c )
 target_link_libraries( ecl_util_month_range ecl test_util )
 add_test( ecl_util_month_range ${EXECUTABLE_OUTPUT_PATH}/ecl_util_month_range  )
 
+add_executable( ecl_sum_columnar ecl_sum_columnar.c )
+target_link_libraries( ecl_sum_columnar ecl test_util )
+add_test( ecl_sum_columnar ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_columnar )
+
+add_executable( ecl_sum_ensemble ecl_sum_ensemble.c )
+target_link_libraries( ecl_sum_ensemble ecl test_util )
+add_test( ecl_sum_ensemble ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_ensemble )
+
 add_executable( ecl_sum_test ecl_sum_test.c )
 target_link_libraries( ecl_sum_test ecl test_util )
 add_test( ecl_sum_test ${EXECUTABLE_OUTPUT_PATH}/ecl_sum_test ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE )
@@ -188,6 +232,23 @@ add_executable( ecl_file ecl_file.c )
 target_link_libraries( ecl_file  ecl test_util )
 add_test( ecl_file ${EXECUTABLE_OUTPUT_PATH}/ecl_file ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE.UNRST ECLIPSE.UNRST)
 
+
+add_executable( ecl_file_index ecl_file_index.c )
+target_link_libraries( ecl_file_index  ecl test_util )
+add_test( ecl_file_index ${EXECUTABLE_OUTPUT_PATH}/ecl_file_index )
+
+add_executable( ecl_file_rstblock ecl_file_rstblock.c )
+target_link_libraries( ecl_file_rstblock  ecl test_util )
+add_test( ecl_file_rstblock ${EXECUTABLE_OUTPUT_PATH}/ecl_file_rstblock )
+
+add_executable( ecl_archive ecl_archive.c )
+target_link_libraries( ecl_archive  ecl test_util )
+add_test( ecl_archive ${EXECUTABLE_OUTPUT_PATH}/ecl_archive )
+
+add_executable( ecl_file_prefetch ecl_file_prefetch.c )
+target_link_libraries( ecl_file_prefetch  ecl test_util )
+add_test( ecl_file_prefetch ${EXECUTABLE_OUTPUT_PATH}/ecl_file_prefetch )
+
 add_executable( ecl_fmt ecl_fmt.c )
 target_link_libraries( ecl_fmt  ecl test_util )
 add_test( ecl_fmt ${EXECUTABLE_OUTPUT_PATH}/ecl_fmt ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE.UNRST ${PROJECT_SOURCE_DIR}/test-data/Statoil/ECLIPSE/Gurbat/ECLIPSE.DATA)
@@ -208,6 +269,10 @@ add_executable( ecl_rft_cell ecl_rft_cell.c )
 target_link_libraries( ecl_rft_cell ecl test_util )
 add_test( ecl_rft_cell ${EXECUTABLE_OUTPUT_PATH}/ecl_rft_cell )
 
+add_executable( ecl_rft_index ecl_rft_index.c )
+target_link_libraries( ecl_rft_index ecl test_util )
+add_test( ecl_rft_index ${EXECUTABLE_OUTPUT_PATH}/ecl_rft_index )
+
 add_executable( ecl_get_num_cpu ecl_get_num_cpu_test.c )
 target_link_libraries( ecl_get_num_cpu ecl test_util )
 add_test( ecl_get_num_cpu ${EXECUTABLE_OUTPUT_PATH}/ecl_get_num_cpu ${PROJECT_SOURCE_DIR}/libecl/tests/data/num_cpu1 ${PROJECT_SOURCE_DIR}/libecl/tests/data/num_cpu2 ${PROJECT_SOURCE_DIR}/libecl/tests/data/num_cpu3)
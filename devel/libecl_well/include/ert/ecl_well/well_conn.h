@@ -46,6 +46,7 @@ extern "C" {
   void             well_conn_free( well_conn_type * conn);
   void             well_conn_free__( void * arg );
 
+  well_conn_type * well_conn_alloc_copy( const well_conn_type * src );
   well_conn_type * well_conn_alloc( int i , int j , int k , double connection_factor , well_conn_dir_enum dir, bool open);
   well_conn_type * well_conn_alloc_MSW( int i , int j , int k , double connection_factor , well_conn_dir_enum dir, bool open, int segment);
   well_conn_type * well_conn_alloc_fracture( int i , int j , int k , double connection_factor , well_conn_dir_enum dir, bool open);
@@ -34,6 +34,8 @@ extern "C" {
   typedef struct well_conn_collection_struct well_conn_collection_type;
 
   well_conn_collection_type * well_conn_collection_alloc();
+  well_conn_collection_type * well_conn_collection_alloc_copy( const well_conn_collection_type * src );
+  bool                        well_conn_collection_equal( const well_conn_collection_type * wellcc1 , const well_conn_collection_type * wellcc2);
   void                        well_conn_collection_free( well_conn_collection_type * wellcc );
   void                        well_conn_collection_free__( void * arg );
   int                         well_conn_collection_get_size( const well_conn_collection_type * wellcc );
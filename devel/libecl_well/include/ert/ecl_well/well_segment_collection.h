@@ -37,6 +37,7 @@ extern "C" {
 
   well_segment_collection_type * well_segment_collection_alloc();
   void                           well_segment_collection_free(well_segment_collection_type * segment_collection );
+  bool                           well_segment_collection_equal( const well_segment_collection_type * collection1 , const well_segment_collection_type * collection2);
   int                            well_segment_collection_get_size( const well_segment_collection_type * segment_collection );
   void                           well_segment_collection_add( well_segment_collection_type * segment_collection , well_segment_type * segment);
   bool                           well_segment_collection_has_segment( const well_segment_collection_type * segment_collection , int segment_id);
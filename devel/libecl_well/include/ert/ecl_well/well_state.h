@@ -53,9 +53,11 @@ extern "C" {
                            int well_nr);
 
   bool well_state_is_MSW( const well_state_type * well_state);
+  bool well_state_share_completion( well_state_type * well_state , const well_state_type * other );
+  bool well_state_completion_shared( const well_state_type * well_state1 , const well_state_type * well_state2);
 
-  well_segment_collection_type * well_state_get_segments( const well_state_type * well_state );
-  well_branch_collection_type * well_state_get_branches( const well_state_type * well_state );
+  const well_segment_collection_type * well_state_get_segments( const well_state_type * well_state );
+  const well_branch_collection_type * well_state_get_branches( const well_state_type * well_state );
 
 
   void                   well_state_free( well_state_type * well );
@@ -0,0 +1,56 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+   
+   The file 'well_status_ts.h' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#ifndef __WELL_STATUS_TS_H__
+#define __WELL_STATUS_TS_H__
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <time.h>
+
+#include <ert/util/int_vector.h>
+#include <ert/util/type_macros.h>
+
+#define WELL_STATUS_TS_ABSENT  -1
+#define WELL_STATUS_TS_SHUT     0
+#define WELL_STATUS_TS_OPEN     1
+
+  typedef struct well_status_ts_struct well_status_ts_type;
+
+  well_status_ts_type   * well_status_ts_alloc( );
+  void                    well_status_ts_free( well_status_ts_type * status_ts );
+  void                    well_status_ts_load_rstfile( well_status_ts_type * status_ts , const char * filename);
+  int                     well_status_ts_get_size( const well_status_ts_type * status_ts );
+  int                     well_status_ts_iget_report_step( const well_status_ts_type * status_ts , int time_index );
+  time_t                  well_status_ts_iget_sim_time( const well_status_ts_type * status_ts , int time_index );
+  int                     well_status_ts_get_num_wells( const well_status_ts_type * status_ts );
+  const char            * well_status_ts_iget_well_name( const well_status_ts_type * status_ts , int well_index );
+  bool                    well_status_ts_has_well( const well_status_ts_type * status_ts , const char * well_name );
+  const int_vector_type * well_status_ts_get_status( const well_status_ts_type * status_ts , const char * well_name );
+  const int_vector_type * well_status_ts_get_num_connections( const well_status_ts_type * status_ts , const char * well_name );
+
+  UTIL_IS_INSTANCE_HEADER( well_status_ts );
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -54,11 +54,22 @@ struct  well_conn_struct {
   
 
 
+/*
+  The comparison is done field by field; comparing the raw memory
+  with memcmp() would also compare the (uninitialized) struct padding.
+*/
+
 bool well_conn_equal( const well_conn_type *conn1  , const well_conn_type * conn2) {
-  if (memcmp(conn1 , conn2 , sizeof * conn1) == 0)
-    return true;
-  else
-    return false;
+  bool equal = true;
+  equal = equal && (conn1->i == conn2->i);
+  equal = equal && (conn1->j == conn2->j);
+  equal = equal && (conn1->k == conn2->k);
+  equal = equal && (conn1->dir == conn2->dir);
+  equal = equal && (conn1->open == conn2->open);
+  equal = equal && (conn1->segment_id == conn2->segment_id);
+  equal = equal && (conn1->matrix_connection == conn2->matrix_connection);
+  equal = equal && (conn1->connection_factor == conn2->connection_factor);
+  return equal;
 }
 
 double well_conn_get_connection_factor( const well_conn_type * conn ) {
@@ -110,6 +121,13 @@ static well_conn_type * well_conn_alloc__( int i , int j , int k , double connec
 }
 
 
+well_conn_type * well_conn_alloc_copy( const well_conn_type * src ) {
+  well_conn_type * conn = util_malloc( sizeof * conn );
+  memcpy( conn , src , sizeof * conn );
+  return conn;
+}
+
+
 well_conn_type * well_conn_alloc( int i , int j , int k , double connection_factor , well_conn_dir_enum dir , bool open) {
   return well_conn_alloc__(i , j , k , connection_factor , dir , open , WELL_CONN_NORMAL_WELL_SEGMENT_ID , true );
 }
@@ -100,6 +100,29 @@ well_conn_type * well_conn_collection_iget(const well_conn_collection_type * wel
 }
 
 
+well_conn_collection_type * well_conn_collection_alloc_copy( const well_conn_collection_type * src ) {
+  well_conn_collection_type * wellcc = well_conn_collection_alloc();
+  int iconn;
+  for (iconn = 0; iconn < well_conn_collection_get_size( src ); iconn++)
+    well_conn_collection_add( wellcc , well_conn_alloc_copy( well_conn_collection_iget_const( src , iconn )));
+  return wellcc;
+}
+
+
+bool well_conn_collection_equal( const well_conn_collection_type * wellcc1 , const well_conn_collection_type * wellcc2) {
+  int size = well_conn_collection_get_size( wellcc1 );
+  if (size == well_conn_collection_get_size( wellcc2 )) {
+    int iconn;
+    for (iconn = 0; iconn < size; iconn++) {
+      if (!well_conn_equal( well_conn_collection_iget_const( wellcc1 , iconn ) , well_conn_collection_iget_const( wellcc2 , iconn )))
+        return false;
+    }
+    return true;
+  } else
+    return false;
+}
+
+
 int well_conn_collection_load_from_kw( well_conn_collection_type * wellcc , 
                                        const ecl_kw_type * iwel_kw , 
                                        const ecl_kw_type * icon_kw , 
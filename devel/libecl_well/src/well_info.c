@@ -19,9 +19,15 @@
 #include <time.h>
 #include <stdbool.h>
 
+#ifdef WITH_PTHREAD
+#include <unistd.h>
+#include <ert/util/thread_pool.h>
+#endif
+
 #include <ert/util/util.h>
 #include <ert/util/hash.h>
 #include <ert/util/int_vector.h>
+#include <ert/util/vector.h>
 #include <ert/util/stringlist.h>
 
 #include <ert/ecl/ecl_rsthead.h>
@@ -273,17 +279,52 @@ static void well_info_add_state( well_info_type * well_info , well_state_type *
    determine the number of wells.
  */
 
-void well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file , int report_nr) {
+static void well_info_alloc_states( const well_info_type * well_info , ecl_file_type * rst_file , int report_nr , vector_type * states) {
   int well_nr;
   ecl_rsthead_type * global_header = ecl_rsthead_alloc( rst_file );
   for (well_nr = 0; well_nr < global_header->nwells; well_nr++) {
     well_state_type * well_state = well_state_alloc_from_file( rst_file , well_info->grid , report_nr , well_nr );
     if (well_state != NULL)
-      well_info_add_state( well_info , well_state );
+      vector_append_ref( states , well_state );
   }
   ecl_rsthead_free( global_header );
 }
 
+
+static void well_info_add_states( well_info_type * well_info , const vector_type * states ) {
+  int index;
+  for (index = 0; index < vector_get_size( states ); index++)
+    well_info_add_state( well_info , vector_iget( states , index ));
+}
+
+
+void well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file , int report_nr) {
+  vector_type * states = vector_alloc_new();
+  well_info_alloc_states( well_info , rst_file , report_nr , states );
+  well_info_add_states( well_info , states );
+  vector_free( states );
+}
+
+
+/*
+  Will create the well_state instances for block @block_nr of the
+  unified restart file @rst_file; the current block selection of
+  @rst_file is not changed.
+*/
+
+static void well_info_alloc_UNRST_states( const well_info_type * well_info , ecl_file_type * rst_file , int block_nr , vector_type * states) {
+  ecl_file_push_block( rst_file );      // <-------------------------------------------------------
+  {                                                                                               //
+    ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );                                  //  Ensure that the status
+    {                                                                                             //  is not changed as a side
+      const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);          //  effect.
+      int report_nr = ecl_kw_iget_int( seqnum_kw , 0 );                                           //
+      well_info_alloc_states( well_info , rst_file , report_nr , states );                        //
+    }                                                                                             //
+  }                                                                                               //
+  ecl_file_pop_block( rst_file );       // <-------------------------------------------------------
+}
+
 /**
    Observe that this function will fail if the rst_file instance
    corresponds to a non-unified restart file, because these files do
@@ -291,29 +332,98 @@ void well_info_add_wells( well_info_type * well_info , ecl_file_type * rst_file
 */
 
 void well_info_add_UNRST_wells( well_info_type * well_info , ecl_file_type * rst_file) {
+  int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
+  int block_nr;
+  for (block_nr = 0; block_nr < num_blocks; block_nr++) {
+    vector_type * states = vector_alloc_new();
+    well_info_alloc_UNRST_states( well_info , rst_file , block_nr , states );
+    well_info_add_states( well_info , states );
+    vector_free( states );
+  }
+}
+
+
+#ifdef WITH_PTHREAD
+
+/*
+  The ecl_file type is not thread safe, so each of the loader jobs
+  uses its own clone of the unified restart file; the
+  clone shares the keyword index of the file opened by
+  well_info_load_rstfile(), so the file is only scanned once. Each job
+  handles the blocks first_block, first_block + block_step, ...; the
+  well_state instances of each block are collected in @block_states
+  and added to the well_info instance in report step order when all
+  the jobs are complete.
+*/
+
+typedef struct {
+  const well_info_type * well_info;
+  const ecl_file_type  * src_file;
+  int                    first_block;
+  int                    block_step;
+  int                    num_blocks;
+  vector_type         ** block_states;
+} well_info_load_job_type;
+
+
+static void * well_info_load_UNRST_job__( void * arg ) {
+  well_info_load_job_type * job = (well_info_load_job_type *) arg;
+  ecl_file_type * rst_file = ecl_file_open_clone( job->src_file );
+  int block_nr;
+  
+  for (block_nr = job->first_block; block_nr < job->num_blocks; block_nr += job->block_step)
+    well_info_alloc_UNRST_states( job->well_info , rst_file , block_nr , job->block_states[ block_nr ] );
+
+  ecl_file_close( rst_file );
+  return NULL;
+}
+
+
+static void well_info_load_UNRST_threaded( well_info_type * well_info , const ecl_file_type * rst_file , int num_blocks , int num_jobs) {
+  vector_type ** block_states = util_calloc( num_blocks , sizeof * block_states );
+  well_info_load_job_type * job_list = util_calloc( num_jobs , sizeof * job_list );
+  int block_nr;
+  int job_nr;
+
+  for (block_nr = 0; block_nr < num_blocks; block_nr++)
+    block_states[ block_nr ] = vector_alloc_new();
+  
   {
-    int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
-    int block_nr;
-    for (block_nr = 0; block_nr < num_blocks; block_nr++) {
-      ecl_file_push_block( rst_file );      // <-------------------------------------------------------
-      {                                                                                               //
-        ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );                                  //  Ensure that the status
-        {                                                                                             //  is not changed as a side
-          const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);          //  effect.
-          int report_nr = ecl_kw_iget_int( seqnum_kw , 0 );                                           //
-          well_info_add_wells( well_info , rst_file , report_nr );                                    //
-        }                                                                                             //
-      }                                                                                               //
-      ecl_file_pop_block( rst_file );       // <-------------------------------------------------------
+    thread_pool_type * tp = thread_pool_alloc( num_jobs , true );
+    for (job_nr = 0; job_nr < num_jobs; job_nr++) {
+      well_info_load_job_type * job = &job_list[ job_nr ];
+      job->well_info    = well_info;
+      job->src_file     = rst_file;
+      job->first_block  = job_nr;
+      job->block_step   = num_jobs;
+      job->num_blocks   = num_blocks;
+      job->block_states = block_states;
+      thread_pool_add_job( tp , well_info_load_UNRST_job__ , job );
     }
+    thread_pool_join( tp );
+    thread_pool_free( tp );
+  }
+  
+  for (block_nr = 0; block_nr < num_blocks; block_nr++) {
+    well_info_add_states( well_info , block_states[ block_nr ] );
+    vector_free( block_states[ block_nr ] );
   }
+  
+  free( job_list );
+  free( block_states );
 }
 
+#endif
+
 
 /**
    The @filename argument should be the name of a restart file; in
    unified or not-unified format - if that is not the case we will
-   have crash and burn.
+   have crash and burn. 
+
+   Unified restart files with several report steps are loaded with
+   several threads when that is available; the end result is the same
+   as with well_info_add_UNRST_wells().
 */
 
 void well_info_load_rstfile( well_info_type * well_info , const char * filename) {
@@ -321,12 +431,25 @@ void well_info_load_rstfile( well_info_type * well_info , const char * filename)
   ecl_file_enum file_type = ecl_util_get_file_type( filename , NULL , &report_nr);
   if ((file_type == ECL_RESTART_FILE) || (file_type == ECL_UNIFIED_RESTART_FILE))
   {
-    ecl_file_type * ecl_file = ecl_file_open( filename , 0);
+    ecl_file_type * ecl_file = ecl_file_open( filename , 0 );
 
     if (file_type == ECL_RESTART_FILE)
       well_info_add_wells( well_info , ecl_file , report_nr );
-    else
-      well_info_add_UNRST_wells( well_info , ecl_file );
+    else {
+      int num_blocks = ecl_file_get_num_named_kw( ecl_file , SEQNUM_KW );
+      int num_jobs = 1;
+      
+#ifdef WITH_PTHREAD
+      num_jobs = util_int_max( 1 , util_int_min( num_blocks , sysconf( _SC_NPROCESSORS_ONLN )));
+#endif
+      
+      if (num_jobs == 1)
+        well_info_add_UNRST_wells( well_info , ecl_file );
+#ifdef WITH_PTHREAD
+      else 
+        well_info_load_UNRST_threaded( well_info , ecl_file , num_blocks , num_jobs );
+#endif
+    }
     
     ecl_file_close( ecl_file );
   } else
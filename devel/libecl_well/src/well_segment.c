@@ -72,6 +72,43 @@ well_segment_type * well_segment_alloc(int segment_id , int outlet_segment_id ,
 }
 
 
+/*
+  Will create a copy of the segment data; the outlet link and the
+  connections are not copied, that must be redone with the
+  well_segment_collection_link() and
+  well_segment_collection_add_connections() functions.
+*/
+
+well_segment_type * well_segment_alloc_copy( const well_segment_type * src ) {
+  double rseg_data[RSEG_DEPTH_INDEX + 1];
+
+  rseg_data[ RSEG_DEPTH_INDEX ] = src->depth;
+  rseg_data[ RSEG_LENGTH_INDEX ] = src->length;
+  rseg_data[ RSEG_TOTAL_LENGTH_INDEX ] = src->total_length;
+  rseg_data[ RSEG_DIAMETER_INDEX ] = src->diameter;
+
+  return well_segment_alloc( src->segment_id , src->outlet_segment_id , src->branch_id , rseg_data );
+}
+
+
+/*
+  Compares the segment data; the connections of the segments are not
+  compared.
+*/
+
+bool well_segment_equal( const well_segment_type * segment1 , const well_segment_type * segment2) {
+  bool equal = true;
+  equal = equal && (segment1->segment_id == segment2->segment_id);
+  equal = equal && (segment1->branch_id == segment2->branch_id);
+  equal = equal && (segment1->outlet_segment_id == segment2->outlet_segment_id);
+  equal = equal && (segment1->depth == segment2->depth);
+  equal = equal && (segment1->length == segment2->length);
+  equal = equal && (segment1->total_length == segment2->total_length);
+  equal = equal && (segment1->diameter == segment2->diameter);
+  return equal;
+}
+
+
 well_segment_type * well_segment_alloc_from_kw( const ecl_kw_type * iseg_kw , const ecl_kw_type * rseg_kw , const ecl_rsthead_type * header , int well_nr, int segment_index , int segment_id) {
   if (rseg_kw == NULL) {
     util_abort("%s: fatal internal error - tried to create well_segment instance without RSEG keyword.\n",__func__);
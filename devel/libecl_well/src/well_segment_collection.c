@@ -100,6 +100,25 @@ bool  well_segment_collection_has_segment( const well_segment_collection_type *
 
 
 
+/*
+  Compares the segment data of the two collections; the connections
+  of the segments are not compared.
+*/
+
+bool well_segment_collection_equal( const well_segment_collection_type * collection1 , const well_segment_collection_type * collection2) {
+  int size = well_segment_collection_get_size( collection1 );
+  if (size == well_segment_collection_get_size( collection2 )) {
+    int index;
+    for (index = 0; index < size; index++) {
+      if (!well_segment_equal( well_segment_collection_iget( collection1 , index ) , well_segment_collection_iget( collection2 , index )))
+        return false;
+    }
+    return true;
+  } else
+    return false;
+}
+
+
 int well_segment_collection_load_from_kw( well_segment_collection_type * segment_collection , int well_nr , 
                                           const ecl_kw_type * iwel_kw , 
                                           const ecl_kw_type * iseg_kw , 
@@ -138,8 +138,8 @@ coupledte implementation these objects are modelled as such:
     the well_state object for information about segments and branches:
 
        if (well_state_is_MSW( well_state )) {
-          well_segment_collection_type * segments = well_state_get_segments( well_state );  
-          well_branch_collection_type * branches = well_state_get_branches( well_state );
+          const well_segment_collection_type * segments = well_state_get_segments( well_state );  
+          const well_branch_collection_type * branches = well_state_get_branches( well_state );
           int branch_nr;
           
           for (branch_nr = 0; branch_nr < well_branch_collection_get_size( branches ); branch_nr++) {             
@@ -159,6 +159,23 @@ coupledte implementation these objects are modelled as such:
 
 #define WELL_STATE_TYPE_ID 613307832
 
+/*
+  The connections, segments and branches of a well are typically
+  unchanged between many consecutive report steps. To save memory the
+  well_state instances of one well can share these data; they are
+  held in a reference counted well_completion instance. The functions
+  which modify the completion data of a well_state will first create a
+  private copy of the completion if it is shared, i.e. copy-on-write.
+*/
+
+typedef struct {
+  int                            ref_count;
+  hash_type                    * connections;                                         // hash<grid_name,well_conn_collection>
+  well_segment_collection_type * segments;
+  well_branch_collection_type  * branches;
+} well_completion_type;
+
+
 struct well_state_struct {
   UTIL_TYPE_ID_DECLARATION;
   char           * name;
@@ -168,9 +185,7 @@ struct well_state_struct {
   bool             open;
   well_type_enum   type;
 
-  hash_type      * connections;                                                       // hash<grid_name,well_conn_collection>
-  well_segment_collection_type * segments;
-  well_branch_collection_type * branches;
+  well_completion_type * completion;
 
   /*****************************************************************/
 
@@ -180,6 +195,91 @@ struct well_state_struct {
 
 
 
+static well_completion_type * well_completion_alloc( ) {
+  well_completion_type * completion = util_malloc( sizeof * completion );
+  completion->ref_count = 1;
+  completion->connections = hash_alloc();
+  completion->segments = well_segment_collection_alloc();
+  completion->branches = well_branch_collection_alloc();
+  return completion;
+}
+
+
+static void well_completion_add_segment_connections( well_completion_type * completion ) {
+  hash_iter_type * grid_iter = hash_iter_alloc( completion->connections );
+  while (!hash_iter_is_complete( grid_iter )) {
+    const char * grid_name = hash_iter_get_next_key( grid_iter );
+    const well_conn_collection_type * connections = hash_get( completion->connections , grid_name );
+    well_segment_collection_add_connections( completion->segments , grid_name , connections );
+  }
+  hash_iter_free( grid_iter );
+  well_segment_collection_link( completion->segments );
+  well_segment_collection_add_branches( completion->segments , completion->branches );
+}
+
+
+static well_completion_type * well_completion_alloc_copy( const well_completion_type * src ) {
+  well_completion_type * completion = well_completion_alloc();
+  {
+    hash_iter_type * grid_iter = hash_iter_alloc( src->connections );
+    while (!hash_iter_is_complete( grid_iter )) {
+      const char * grid_name = hash_iter_get_next_key( grid_iter );
+      const well_conn_collection_type * connections = hash_get( src->connections , grid_name );
+      hash_insert_hash_owned_ref( completion->connections , grid_name , well_conn_collection_alloc_copy( connections ) , well_conn_collection_free__ );
+    }
+    hash_iter_free( grid_iter );
+  }
+  
+  if (well_segment_collection_get_size( src->segments ) > 0) {
+    int index;
+    for (index = 0; index < well_segment_collection_get_size( src->segments ); index++) 
+      well_segment_collection_add( completion->segments , well_segment_alloc_copy( well_segment_collection_iget( src->segments , index )));
+    
+    well_completion_add_segment_connections( completion );
+  }
+  return completion;
+}
+
+
+static bool well_completion_equal( const well_completion_type * completion1 , const well_completion_type * completion2 ) {
+  if (completion1 == completion2)
+    return true;
+
+  if (hash_get_size( completion1->connections ) != hash_get_size( completion2->connections ))
+    return false;
+  
+  if (!well_segment_collection_equal( completion1->segments , completion2->segments ))
+    return false;
+
+  {
+    bool equal = true;
+    hash_iter_type * grid_iter = hash_iter_alloc( completion1->connections );
+    while (equal && !hash_iter_is_complete( grid_iter )) {
+      const char * grid_name = hash_iter_get_next_key( grid_iter );
+      if (hash_has_key( completion2->connections , grid_name ))
+        equal = well_conn_collection_equal( hash_get( completion1->connections , grid_name ) , hash_get( completion2->connections , grid_name ));
+      else
+        equal = false;
+    }
+    hash_iter_free( grid_iter );
+    return equal;
+  }
+}
+
+
+static void well_completion_free( well_completion_type * completion ) {
+  completion->ref_count--;
+  if (completion->ref_count == 0) {
+    hash_free( completion->connections );
+    well_segment_collection_free( completion->segments );
+    well_branch_collection_free( completion->branches );
+    free( completion );
+  }
+}
+
+/*****************************************************************/
+
+
 UTIL_IS_INSTANCE_FUNCTION( well_state , WELL_STATE_TYPE_ID)
 
 
@@ -195,9 +295,7 @@ well_state_type * well_state_alloc(const char * well_name , int global_well_nr ,
   well_state->open = open;
   well_state->type = type;
   well_state->global_well_nr = global_well_nr;
-  well_state->connections = hash_alloc();
-  well_state->segments = well_segment_collection_alloc();
-  well_state->branches = well_branch_collection_alloc();
+  well_state->completion = well_completion_alloc();
 
   /* See documentation of the 'IWEL_UNDOCUMENTED_ZERO' in well_const.h */
   if ((type == UNDOCUMENTED_ZERO) && open)
@@ -209,6 +307,48 @@ well_state_type * well_state_alloc(const char * well_name , int global_well_nr ,
 
 
 
+/*
+  Returns the completion of the well_state for modification; if the
+  completion is shared with other well_state instances a private copy
+  is created first.
+*/
+
+static well_completion_type * well_state_get_writable_completion( well_state_type * well_state ) {
+  if (well_state->completion->ref_count > 1) {
+    well_completion_type * copy = well_completion_alloc_copy( well_state->completion );
+    well_completion_free( well_state->completion );
+    well_state->completion = copy;
+  }
+  return well_state->completion;
+}
+
+
+/**
+   Will let @well_state share the connections, segments and branches
+   of @other if they are equal, and return true; otherwise the
+   well_state is left unchanged and the function returns false.
+*/
+
+bool well_state_share_completion( well_state_type * well_state , const well_state_type * other ) {
+  if (well_state->completion == other->completion)
+    return true;
+
+  if (well_completion_equal( well_state->completion , other->completion )) {
+    well_completion_free( well_state->completion );
+    well_state->completion = other->completion;
+    well_state->completion->ref_count++;
+    return true;
+  } else
+    return false;
+}
+
+
+bool well_state_completion_shared( const well_state_type * well_state1 , const well_state_type * well_state2) {
+  return (well_state1->completion == well_state2->completion);
+}
+
+
+
 void well_state_add_wellhead( well_state_type * well_state , const ecl_rsthead_type * header , const ecl_kw_type * iwel_kw , int well_nr , const char * grid_name , int grid_nr) {
   well_conn_type * wellhead = well_conn_alloc_wellhead( iwel_kw , header , well_nr );
 
@@ -311,14 +451,16 @@ static void well_state_add_connections__( well_state_type * well_state ,
   const ecl_kw_type * iwel_kw  = ecl_file_iget_named_kw( rst_file , IWEL_KW   , 0);
 
   
+  well_completion_type * completion = well_state_get_writable_completion( well_state );
+  
   well_state_add_wellhead( well_state , header , iwel_kw , well_nr , grid_name , grid_nr );
 
-  if (!well_state_has_grid_connections( well_state , grid_name ))
-    hash_insert_hash_owned_ref( well_state->connections , grid_name, well_conn_collection_alloc( ) , well_conn_collection_free__ );
+  if (!hash_has_key( completion->connections , grid_name ))
+    hash_insert_hash_owned_ref( completion->connections , grid_name, well_conn_collection_alloc( ) , well_conn_collection_free__ );
 
   {
     ecl_kw_type * scon_kw = NULL;
-    well_conn_collection_type * wellcc = hash_get( well_state->connections , grid_name );
+    well_conn_collection_type * wellcc = hash_get( completion->connections , grid_name );
     if (ecl_file_has_kw( rst_file , SCON_KW))
       scon_kw = ecl_file_iget_named_kw( rst_file , SCON_KW , 0);
     
@@ -372,6 +514,7 @@ bool well_state_add_MSW( well_state_type * well_state ,
                          int well_nr) {
 
   if (ecl_file_has_kw( rst_file , ISEG_KW)) {
+    well_completion_type * completion = well_state_get_writable_completion( well_state );
     ecl_rsthead_type  * rst_head  = ecl_rsthead_alloc( rst_file );
     const ecl_kw_type * iwel_kw = ecl_file_iget_named_kw( rst_file , IWEL_KW , 0);
     const ecl_kw_type * iseg_kw = ecl_file_iget_named_kw( rst_file , ISEG_KW , 0);
@@ -390,24 +533,16 @@ bool well_state_add_MSW( well_state_type * well_state ,
       */
       rseg_kw = ecl_file_iget_named_kw( rst_file , RSEG_KW , 0);
 
-    segments = well_segment_collection_load_from_kw( well_state->segments ,
+    segments = well_segment_collection_load_from_kw( completion->segments ,
                                                      well_nr ,
                                                      iwel_kw ,
                                                      iseg_kw ,
                                                      rseg_kw ,
                                                      rst_head);
 
-    if (segments) {
-      hash_iter_type * grid_iter = hash_iter_alloc( well_state->connections );
-      while (!hash_iter_is_complete( grid_iter )) {
-        const char * grid_name = hash_iter_get_next_key( grid_iter );
-        const well_conn_collection_type * connections = hash_get( well_state->connections , grid_name );
-        well_segment_collection_add_connections( well_state->segments , grid_name , connections );
-      }
-      hash_iter_free( grid_iter );
-      well_segment_collection_link( well_state->segments );
-      well_segment_collection_add_branches( well_state->segments , well_state->branches );
-    }
+    if (segments) 
+      well_completion_add_segment_connections( completion );
+
     ecl_rsthead_free( rst_head );
     return true;
   } else
@@ -416,7 +551,7 @@ bool well_state_add_MSW( well_state_type * well_state ,
 
 
 bool well_state_is_MSW( const well_state_type * well_state) {
-  if (well_segment_collection_get_size( well_state->segments ) > 0)
+  if (well_segment_collection_get_size( well_state->completion->segments ) > 0)
     return true;
   else
     return false;
@@ -476,9 +611,7 @@ well_state_type * well_state_alloc_from_file( ecl_file_type * ecl_file , const e
 void well_state_free( well_state_type * well ) {
   hash_free( well->name_wellhead );
   vector_free( well->index_wellhead );
-  hash_free( well->connections );
-  well_segment_collection_free( well->segments );
-  well_branch_collection_free( well->branches );
+  well_completion_free( well->completion );
 
   free( well->name );
   free( well );
@@ -535,8 +668,8 @@ void well_state_summarize( const well_state_type * well_state , FILE * stream )
 
 
 const well_conn_collection_type * well_state_get_grid_connections( const well_state_type * well_state , const char * grid_name) {
-  if (hash_has_key( well_state->connections , grid_name))
-    return hash_get( well_state->connections , grid_name);
+  if (hash_has_key( well_state->completion->connections , grid_name))
+    return hash_get( well_state->completion->connections , grid_name);
   else
     return NULL;
 }
@@ -548,7 +681,7 @@ const well_conn_collection_type * well_state_get_global_connections( const well_
 
 
 bool well_state_has_grid_connections( const well_state_type * well_state , const char * grid_name) {
-  if (hash_has_key( well_state->connections , grid_name))
+  if (hash_has_key( well_state->completion->connections , grid_name))
     return true;
   else
     return false;
@@ -560,12 +693,12 @@ bool well_state_has_global_connections( const well_state_type * well_state ) {
 }
 
 
-well_segment_collection_type * well_state_get_segments( const well_state_type * well_state ) {
-  return well_state->segments;
+const well_segment_collection_type * well_state_get_segments( const well_state_type * well_state ) {
+  return well_state->completion->segments;
 }
 
 
-well_branch_collection_type * well_state_get_branches( const well_state_type * well_state ) {
-  return well_state->branches;
+const well_branch_collection_type * well_state_get_branches( const well_state_type * well_state ) {
+  return well_state->completion->branches;
 }
 
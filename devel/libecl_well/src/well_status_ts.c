@@ -0,0 +1,222 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+   
+   The file 'well_status_ts.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+
+#include <stdbool.h>
+#include <time.h>
+
+#include <ert/util/util.h>
+#include <ert/util/hash.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/time_t_vector.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/type_macros.h>
+
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_rsthead.h>
+#include <ert/ecl/ecl_util.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_status_ts.h>
+
+/*
+  The well_status_ts type holds the open/shut status and the number
+  of connections of all the wells at all the report steps found in
+  one or more restart files. Only the restart header and the global
+  IWEL and ZWEL keywords are read from the files, i.e. it is much
+  cheaper than loading the full well_state instances with
+  well_info_load_rstfile() when these properties are all you need.
+
+  The report steps are indexed by time_index in the order they are
+  loaded; for each well there is an int_vector of status values
+  (WELL_STATUS_TS_OPEN|SHUT|ABSENT) and an int_vector with the number
+  of connections, both with one element for each time_index.
+*/
+
+#define WELL_STATUS_TS_TYPE_ID 71320513
+
+struct well_status_ts_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  int_vector_type    * report_steps;
+  time_t_vector_type * sim_times;
+  stringlist_type    * well_names;         /* The wells in the order they first appear. */
+  hash_type          * status;             /* hash<well_name , int_vector> */
+  hash_type          * num_connections;    /* hash<well_name , int_vector> */
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( well_status_ts , WELL_STATUS_TS_TYPE_ID )
+
+
+well_status_ts_type * well_status_ts_alloc( ) {
+  well_status_ts_type * status_ts = util_malloc( sizeof * status_ts );
+  UTIL_TYPE_ID_INIT( status_ts , WELL_STATUS_TS_TYPE_ID );
+  status_ts->report_steps = int_vector_alloc( 0 , 0 );
+  status_ts->sim_times = time_t_vector_alloc( 0 , 0 );
+  status_ts->well_names = stringlist_alloc_new();
+  status_ts->status = hash_alloc();
+  status_ts->num_connections = hash_alloc();
+  return status_ts;
+}
+
+
+void well_status_ts_free( well_status_ts_type * status_ts ) {
+  int_vector_free( status_ts->report_steps );
+  time_t_vector_free( status_ts->sim_times );
+  stringlist_free( status_ts->well_names );
+  hash_free( status_ts->status );
+  hash_free( status_ts->num_connections );
+  free( status_ts );
+}
+
+
+static void well_status_ts_add_well( well_status_ts_type * status_ts , const char * well_name ) {
+  hash_insert_hash_owned_ref( status_ts->status , well_name , int_vector_alloc( 0 , WELL_STATUS_TS_ABSENT ) , int_vector_free__ );
+  hash_insert_hash_owned_ref( status_ts->num_connections , well_name , int_vector_alloc( 0 , 0 ) , int_vector_free__ );
+  stringlist_append_copy( status_ts->well_names , well_name );
+}
+
+
+/*
+  Will add the status of all the wells from the currently selected
+  block of @rst_file; the block must contain one report step.
+*/
+
+static void well_status_ts_add_block( well_status_ts_type * status_ts , const ecl_file_type * rst_file , int report_nr) {
+  ecl_rsthead_type * header = ecl_rsthead_alloc( rst_file );
+  int time_index = int_vector_size( status_ts->report_steps );
+  
+  int_vector_append( status_ts->report_steps , report_nr );
+  time_t_vector_append( status_ts->sim_times , header->sim_time );
+
+  if (ecl_file_has_kw( rst_file , IWEL_KW )) {
+    const ecl_kw_type * iwel_kw = ecl_file_iget_named_kw( rst_file , IWEL_KW , 0 );
+    const ecl_kw_type * zwel_kw = ecl_file_iget_named_kw( rst_file , ZWEL_KW , 0 );
+    const int * iwel = ecl_kw_get_int_ptr( iwel_kw );
+    int well_nr;
+    
+    for (well_nr = 0; well_nr < header->nwells; well_nr++) {
+      const int iwel_offset = header->niwelz * well_nr;
+      char * well_name = util_alloc_strip_copy( ecl_kw_iget_ptr( zwel_kw , header->nzwelz * well_nr ));
+      
+      if (!hash_has_key( status_ts->status , well_name ))
+        well_status_ts_add_well( status_ts , well_name );
+      
+      int_vector_iset( hash_get( status_ts->status , well_name ) , time_index , 
+                       (iwel[ iwel_offset + IWEL_STATUS_ITEM ] > 0) ? WELL_STATUS_TS_OPEN : WELL_STATUS_TS_SHUT );
+      int_vector_iset( hash_get( status_ts->num_connections , well_name ) , time_index , iwel[ iwel_offset + IWEL_CONNECTIONS_ITEM ] );
+      free( well_name );
+    }
+  }
+  
+  /* Wells which are not present in this report step get the default values. */
+  {
+    int well_index;
+    for (well_index = 0; well_index < stringlist_get_size( status_ts->well_names ); well_index++) {
+      const char * well_name = stringlist_iget( status_ts->well_names , well_index );
+      int_vector_type * status = hash_get( status_ts->status , well_name );
+      int_vector_type * num_connections = hash_get( status_ts->num_connections , well_name );
+      
+      if (int_vector_size( status ) <= time_index) {
+        int_vector_iset( status , time_index , WELL_STATUS_TS_ABSENT );
+        int_vector_iset( num_connections , time_index , 0 );
+      }
+    }
+  }
+  ecl_rsthead_free( header );
+}
+
+
+/**
+   The @filename argument should be the name of a restart file; in
+   unified or not-unified format. The report steps are appended to the
+   time series in the order they are found in the file.
+*/
+
+void well_status_ts_load_rstfile( well_status_ts_type * status_ts , const char * filename) {
+  int report_nr;
+  ecl_file_enum file_type = ecl_util_get_file_type( filename , NULL , &report_nr);
+  if ((file_type == ECL_RESTART_FILE) || (file_type == ECL_UNIFIED_RESTART_FILE)) {
+    ecl_file_type * rst_file = ecl_file_open( filename , 0);
+    
+    if (file_type == ECL_RESTART_FILE)
+      well_status_ts_add_block( status_ts , rst_file , report_nr );
+    else {
+      int num_blocks = ecl_file_get_num_named_kw( rst_file , SEQNUM_KW );
+      int block_nr;
+      for (block_nr = 0; block_nr < num_blocks; block_nr++) {
+        ecl_file_push_block( rst_file );
+        ecl_file_subselect_block( rst_file , SEQNUM_KW , block_nr );
+        {
+          const ecl_kw_type * seqnum_kw = ecl_file_iget_named_kw( rst_file , SEQNUM_KW , 0);
+          well_status_ts_add_block( status_ts , rst_file , ecl_kw_iget_int( seqnum_kw , 0 ));
+        }
+        ecl_file_pop_block( rst_file );
+      }
+    }
+    
+    ecl_file_close( rst_file );
+  } else
+    util_abort("%s: invalid file type:%s - must be a restart file\n",__func__ , filename);
+}
+
+
+int well_status_ts_get_size( const well_status_ts_type * status_ts ) {
+  return int_vector_size( status_ts->report_steps );
+}
+
+
+int well_status_ts_iget_report_step( const well_status_ts_type * status_ts , int time_index ) {
+  return int_vector_iget( status_ts->report_steps , time_index );
+}
+
+
+time_t well_status_ts_iget_sim_time( const well_status_ts_type * status_ts , int time_index ) {
+  return time_t_vector_iget( status_ts->sim_times , time_index );
+}
+
+
+int well_status_ts_get_num_wells( const well_status_ts_type * status_ts ) {
+  return stringlist_get_size( status_ts->well_names );
+}
+
+
+const char * well_status_ts_iget_well_name( const well_status_ts_type * status_ts , int well_index ) {
+  return stringlist_iget( status_ts->well_names , well_index );
+}
+
+
+bool well_status_ts_has_well( const well_status_ts_type * status_ts , const char * well_name ) {
+  return hash_has_key( status_ts->status , well_name );
+}
+
+
+/*
+  The two functions below will fail hard if the well is not known;
+  check with well_status_ts_has_well() first.
+*/
+
+const int_vector_type * well_status_ts_get_status( const well_status_ts_type * status_ts , const char * well_name ) {
+  return hash_get( status_ts->status , well_name );
+}
+
+
+const int_vector_type * well_status_ts_get_num_connections( const well_status_ts_type * status_ts , const char * well_name ) {
+  return hash_get( status_ts->num_connections , well_name );
+}
@@ -260,18 +260,41 @@ static int well_ts_get_index( const well_ts_type * well_ts , int report_step , t
 }
 
 
+/*
+  When a new well_state is added it will share the connections,
+  segments and branches with the well_state immediately before it in
+  time, if these are unchanged. The well_state instances which share
+  completion data are still independent objects; they can be freed in
+  any order.
+*/
+
 void well_ts_add_well( well_ts_type * well_ts , well_state_type * well_state ) {
   well_node_type * new_node = well_node_alloc( well_state );
-  vector_append_owned_ref( well_ts->ts , new_node , well_node_free__ );
+  const well_node_type * prev_node = NULL;
 
-  if (vector_get_size( well_ts->ts ) > 1) {
-    const well_node_type * last_node = vector_get_last_const(well_ts->ts );
-    if (new_node->sim_time < last_node->sim_time) 
-      // The new node is chronologically before the previous node;
-      // i.e. we must sort the nodes in time. This should probably happen
-      // quite seldom:
-      vector_sort( well_ts->ts , well_node_time_cmp );
+  if (vector_get_size( well_ts->ts ) > 0) 
+    prev_node = vector_get_last_const( well_ts->ts );
+  
+  vector_append_owned_ref( well_ts->ts , new_node , well_node_free__ );
+  if ((prev_node != NULL) && (new_node->sim_time < prev_node->sim_time)) {
+    // The new node is chronologically before the previous node;
+    // i.e. we must sort the nodes in time. This should probably happen
+    // quite seldom:
+    vector_sort( well_ts->ts , well_node_time_cmp );
+    {
+      int index = 0;
+      while (vector_iget_const( well_ts->ts , index ) != new_node)
+        index++;
+      
+      if (index > 0)
+        prev_node = vector_iget_const( well_ts->ts , index - 1);
+      else
+        prev_node = NULL;
+    }
   }
+
+  if (prev_node != NULL)
+    well_state_share_completion( well_state , prev_node->well_state );
 }
 
 
@@ -0,0 +1,290 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+   
+   The file 'well_info_share.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/int_vector.h>
+#include <ert/util/test_work_area.h>
+
+#include <ert/ecl/ecl_kw.h>
+#include <ert/ecl/ecl_kw_magic.h>
+#include <ert/ecl/ecl_endian_flip.h>
+#include <ert/ecl/ecl_file.h>
+#include <ert/ecl/ecl_grid.h>
+#include <ert/ecl/fortio.h>
+
+#include <ert/ecl_well/well_const.h>
+#include <ert/ecl_well/well_conn.h>
+#include <ert/ecl_well/well_conn_collection.h>
+#include <ert/ecl_well/well_state.h>
+#include <ert/ecl_well/well_ts.h>
+#include <ert/ecl_well/well_info.h>
+#include <ert/ecl_well/well_status_ts.h>
+
+#define NUM_STEPS  4
+#define NIWELZ   150
+#define NZWELZ     3
+#define NCWMAX     4
+#define NICONZ    25
+#define NSCONZ    40
+
+
+typedef struct {
+  const char * name;
+  int          type;
+  int          first_step;        /* The well is present from this step. */
+  int          shut_step;         /* The well is shut from this step. */
+  int          cf_step;           /* The connection factors change at this step. */
+  int          num_conn;
+} test_well_type;
+
+
+static const test_well_type test_wells[] = {{"OP_1" , IWEL_PRODUCER       , 0 , NUM_STEPS , 2         , 3},
+                                            {"WI_1" , IWEL_WATER_INJECTOR , 0 , 3         , NUM_STEPS , 2},
+                                            {"OP_2" , IWEL_PRODUCER       , 2 , NUM_STEPS , NUM_STEPS , 4}};
+#define NUM_WELLS 3
+
+
+static ecl_kw_type * alloc_int_kw( const char * header , int size ) {
+  ecl_kw_type * kw = ecl_kw_alloc( header , size , ECL_INT_TYPE );
+  int i;
+  for (i=0; i < size; i++)
+    ecl_kw_iset_int( kw , i , 0 );
+  return kw;
+}
+
+
+static ecl_kw_type * alloc_float_kw( const char * header , int size ) {
+  ecl_kw_type * kw = ecl_kw_alloc( header , size , ECL_FLOAT_TYPE );
+  int i;
+  for (i=0; i < size; i++)
+    ecl_kw_iset_float( kw , i , 0 );
+  return kw;
+}
+
+
+static void fwrite_free( ecl_kw_type * kw , fortio_type * fortio ) {
+  ecl_kw_fwrite( kw , fortio );
+  ecl_kw_free( kw );
+}
+
+
+void fwrite_step( fortio_type * fortio , int step ) {
+  int nwells = 0;
+  int w;
+
+  for (w = 0; w < NUM_WELLS; w++)
+    if (test_wells[w].first_step <= step)
+      nwells++;
+  
+  {
+    ecl_kw_type * seqnum   = alloc_int_kw( SEQNUM_KW , 1 );
+    ecl_kw_type * intehead = alloc_int_kw( INTEHEAD_KW , 411 );
+    ecl_kw_type * logihead = ecl_kw_alloc( LOGIHEAD_KW , 80 , ECL_BOOL_TYPE );
+    ecl_kw_type * doubhead = ecl_kw_alloc( DOUBHEAD_KW , 1 , ECL_DOUBLE_TYPE );
+    ecl_kw_type * iwel     = alloc_int_kw( IWEL_KW , NIWELZ * nwells );
+    ecl_kw_type * zwel     = ecl_kw_alloc( ZWEL_KW , NZWELZ * nwells , ECL_CHAR_TYPE );
+    ecl_kw_type * icon     = alloc_int_kw( ICON_KW , NICONZ * NCWMAX * nwells );
+    ecl_kw_type * scon     = alloc_float_kw( SCON_KW , NSCONZ * NCWMAX * nwells );
+    int i;
+
+    ecl_kw_iset_int( seqnum , 0 , step + 1 );
+    ecl_kw_iset_int( intehead , INTEHEAD_NX_INDEX , 10 );
+    ecl_kw_iset_int( intehead , INTEHEAD_NY_INDEX , 10 );
+    ecl_kw_iset_int( intehead , INTEHEAD_NZ_INDEX , 5 );
+    ecl_kw_iset_int( intehead , INTEHEAD_NACTIVE_INDEX , 500 );
+    ecl_kw_iset_int( intehead , INTEHEAD_NWELLS_INDEX , nwells );
+    ecl_kw_iset_int( intehead , INTEHEAD_NIWELZ_INDEX , NIWELZ );
+    ecl_kw_iset_int( intehead , INTEHEAD_NZWELZ_INDEX , NZWELZ );
+    ecl_kw_iset_int( intehead , INTEHEAD_NCWMAX_INDEX , NCWMAX );
+    ecl_kw_iset_int( intehead , INTEHEAD_NICONZ_INDEX , NICONZ );
+    ecl_kw_iset_int( intehead , INTEHEAD_NSCONZ_INDEX , NSCONZ );
+    ecl_kw_iset_int( intehead , INTEHEAD_DAY_INDEX , 1 );
+    ecl_kw_iset_int( intehead , INTEHEAD_MONTH_INDEX , step + 1 );
+    ecl_kw_iset_int( intehead , INTEHEAD_YEAR_INDEX , 2000 );
+    ecl_kw_iset_int( intehead , INTEHEAD_IPROG_INDEX , 100 );
+    for (i = 0; i < 80; i++)
+      ecl_kw_iset_bool( logihead , i , false );
+    ecl_kw_iset_double( doubhead , DOUBHEAD_DAYS_INDEX , 31 * step );
+    for (i = 0; i < NZWELZ * nwells; i++)
+      ecl_kw_iset_string8( zwel , i , "");
+    
+    {
+      int well_nr = 0;
+      for (w = 0; w < NUM_WELLS; w++) {
+        const test_well_type * well = &test_wells[w];
+        if (well->first_step <= step) {
+          int iwel_offset = NIWELZ * well_nr;
+          int c;
+
+          ecl_kw_iset_string8( zwel , NZWELZ * well_nr , well->name );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_HEADI_ITEM , w + 1 );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_HEADJ_ITEM , 1 );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_HEADK_ITEM , 1 );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_CONNECTIONS_ITEM , well->num_conn );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_TYPE_ITEM , well->type );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_STATUS_ITEM , (step < well->shut_step) ? 1 : 0 );
+          ecl_kw_iset_int( iwel , iwel_offset + IWEL_SEGMENTED_WELL_NR_ITEM , 0 );
+
+          for (c = 0; c < well->num_conn; c++) {
+            int icon_offset = NICONZ * ( NCWMAX * well_nr + c );
+            int scon_offset = NSCONZ * ( NCWMAX * well_nr + c );
+            ecl_kw_iset_int( icon , icon_offset + ICON_IC_ITEM , c + 1 );
+            ecl_kw_iset_int( icon , icon_offset + ICON_I_ITEM , w + 1 );
+            ecl_kw_iset_int( icon , icon_offset + ICON_J_ITEM , 1 );
+            ecl_kw_iset_int( icon , icon_offset + ICON_K_ITEM , c + 1 );
+            ecl_kw_iset_int( icon , icon_offset + ICON_STATUS_ITEM , 1 );
+            ecl_kw_iset_float( scon , scon_offset + SCON_CF_ITEM , (step < well->cf_step) ? 1.0 : 2.0 );
+          }
+          well_nr++;
+        }
+      }
+    }
+
+    fwrite_free( seqnum , fortio );
+    fwrite_free( intehead , fortio );
+    fwrite_free( logihead , fortio );
+    fwrite_free( doubhead , fortio );
+    fwrite_free( iwel , fortio );
+    fwrite_free( zwel , fortio );
+    fwrite_free( icon , fortio );
+    fwrite_free( scon , fortio );
+  }
+}
+
+
+void create_restart( const char * filename ) {
+  fortio_type * fortio = fortio_open_writer( filename , false , ECL_ENDIAN_FLIP );
+  int step;
+  for (step = 0; step < NUM_STEPS; step++)
+    fwrite_step( fortio , step );
+  fortio_fclose( fortio );
+}
+
+
+void test_sharing( const well_info_type * well_info ) {
+  test_assert_int_equal( well_info_get_num_wells( well_info ) , NUM_WELLS );
+  {
+    well_ts_type * op1 = well_info_get_ts( well_info , "OP_1" );
+    well_ts_type * wi1 = well_info_get_ts( well_info , "WI_1" );
+    well_ts_type * op2 = well_info_get_ts( well_info , "OP_2" );
+    int step;
+
+    test_assert_int_equal( well_ts_get_size( op1 ) , NUM_STEPS );
+    test_assert_int_equal( well_ts_get_size( op2 ) , NUM_STEPS - 2 );
+    
+    test_assert_true( well_state_completion_shared( well_ts_iget_state( op1 , 0 ) , well_ts_iget_state( op1 , 1 )));
+    test_assert_false( well_state_completion_shared( well_ts_iget_state( op1 , 1 ) , well_ts_iget_state( op1 , 2 )));
+    test_assert_true( well_state_completion_shared( well_ts_iget_state( op1 , 2 ) , well_ts_iget_state( op1 , 3 )));
+    test_assert_true( well_state_completion_shared( well_ts_iget_state( op2 , 0 ) , well_ts_iget_state( op2 , 1 )));
+
+    for (step = 0; step < NUM_STEPS; step++) {
+      const well_state_type * op1_state = well_ts_iget_state( op1 , step );
+      const well_state_type * wi1_state = well_ts_iget_state( wi1 , step );
+      const well_conn_collection_type * op1_conn = well_state_get_global_connections( op1_state );
+      
+      test_assert_int_equal( well_state_get_report_nr( op1_state ) , step + 1 );
+      test_assert_int_equal( well_conn_collection_get_size( op1_conn ) , 3 );
+      test_assert_double_equal( well_conn_get_connection_factor( well_conn_collection_iget_const( op1_conn , 2 )) , (step < 2) ? 1.0 : 2.0 );
+      test_assert_bool_equal( well_state_is_open( wi1_state ) , step < 3 );
+      test_assert_true( well_state_completion_shared( well_ts_iget_state( wi1 , 0 ) , wi1_state ));
+    }
+  }
+}
+
+
+void test_copy_on_write( const well_info_type * well_info , const ecl_grid_type * grid) {
+  ecl_file_type * rst_file = ecl_file_open( "CASE.UNRST" , 0 );
+  well_ts_type * wi1 = well_info_get_ts( well_info , "WI_1" );
+  well_state_type * state0 = well_ts_iget_state( wi1 , 0 );
+  well_state_type * state1 = well_ts_iget_state( wi1 , 1 );
+  well_state_type * state2 = well_ts_iget_state( wi1 , 2 );
+
+  ecl_file_select_block( rst_file , SEQNUM_KW , 1 );
+  well_state_add_connections( state1 , grid , rst_file , 1 );
+
+  test_assert_false( well_state_completion_shared( state0 , state1 ));
+  test_assert_true( well_state_completion_shared( state0 , state2 ));
+  test_assert_int_equal( well_conn_collection_get_size( well_state_get_global_connections( state0 )) , 2 );
+  test_assert_int_equal( well_conn_collection_get_size( well_state_get_global_connections( state1 )) , 4 );
+  
+  ecl_file_close( rst_file );
+}
+
+
+void test_status_ts( ) {
+  well_status_ts_type * status_ts = well_status_ts_alloc();
+  well_status_ts_load_rstfile( status_ts , "CASE.UNRST" );
+
+  test_assert_true( well_status_ts_is_instance( status_ts ));
+  test_assert_int_equal( well_status_ts_get_size( status_ts ) , NUM_STEPS );
+  test_assert_int_equal( well_status_ts_get_num_wells( status_ts ) , NUM_WELLS );
+  test_assert_false( well_status_ts_has_well( status_ts , "NO_WELL" ));
+  {
+    int w , step;
+    for (w = 0; w < NUM_WELLS; w++) {
+      const test_well_type * well = &test_wells[w];
+      const int_vector_type * status = well_status_ts_get_status( status_ts , well->name );
+      const int_vector_type * num_conn = well_status_ts_get_num_connections( status_ts , well->name );
+
+      test_assert_string_equal( well_status_ts_iget_well_name( status_ts , w ) , well->name );
+      test_assert_int_equal( int_vector_size( status ) , NUM_STEPS );
+      test_assert_int_equal( int_vector_size( num_conn ) , NUM_STEPS );
+      for (step = 0; step < NUM_STEPS; step++) {
+        int expected_status = WELL_STATUS_TS_ABSENT;
+        if (step >= well->first_step)
+          expected_status = (step < well->shut_step) ? WELL_STATUS_TS_OPEN : WELL_STATUS_TS_SHUT;
+        
+        test_assert_int_equal( int_vector_iget( status , step ) , expected_status );
+        test_assert_int_equal( int_vector_iget( num_conn , step ) , (step >= well->first_step) ? well->num_conn : 0 );
+      }
+    }
+    for (step = 0; step < NUM_STEPS; step++) 
+      test_assert_int_equal( well_status_ts_iget_report_step( status_ts , step ) , step + 1 );
+  }
+  well_status_ts_free( status_ts );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("well_info_share");
+  ecl_grid_type * grid = ecl_grid_alloc_rectangular( 10 , 10 , 5 , 1 , 1 , 1 , NULL );
+  create_restart( "CASE.UNRST" );
+  {
+    well_info_type * well_info = well_info_alloc( grid );
+    well_info_load_rstfile( well_info , "CASE.UNRST" );
+    test_sharing( well_info );
+    test_copy_on_write( well_info , grid );
+    well_info_free( well_info );
+  }
+  {
+    well_info_type * well_info = well_info_alloc( grid );
+    ecl_file_type * rst_file = ecl_file_open( "CASE.UNRST" , 0 );
+    well_info_add_UNRST_wells( well_info , rst_file );
+    ecl_file_close( rst_file );
+    test_sharing( well_info );
+    well_info_free( well_info );
+  }
+  test_status_ts( );
+  ecl_grid_free( grid );
+  test_work_area_free( work_area );
+  exit(0);
+}
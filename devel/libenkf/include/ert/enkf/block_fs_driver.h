@@ -25,6 +25,8 @@ extern "C" {
 #include <stdio.h>
 #include <stdbool.h>
 
+#include <ert/util/stringlist.h>
+
 #include <ert/enkf/fs_types.h>  
 
   typedef struct block_fs_driver_struct block_fs_driver_type;
@@ -33,6 +35,8 @@ extern "C" {
   void                   block_fs_driver_fwrite_mount_info(FILE * stream , fs_driver_enum driver_type , int num_block_fs_drivers);
   block_fs_driver_type * block_fs_driver_fread_alloc(const char * root_path , FILE * stream);
   bool                   block_fs_sscanf_key(const char * key , char ** config_key , int * __report_step , int * __iens);
+  int                    block_fs_driver_migrate_fs( const char * mount_file , const stringlist_type * vector_keys );
+  int                    block_fs_driver_copy_fs( const stringlist_type * src_mount_files , const stringlist_type * target_mount_files , const stringlist_type * vector_keys );
   void                 * block_fs_driver_open(FILE * fstab_stream , const char * mount_point , fs_driver_enum driver_type , bool read_only);
   void                   block_fs_driver_create_fs( FILE * stream , 
                                                     const char * mount_point , 
@@ -63,6 +63,14 @@ extern "C" {
                                           int iens , 
                                           state_enum state);
   
+  enkf_fs_batch_type * enkf_fs_batch_alloc( enkf_fs_type * fs );
+  void                 enkf_fs_batch_free( enkf_fs_batch_type * batch );
+  void                 enkf_fs_batch_fwrite_node( enkf_fs_batch_type * batch , buffer_type * buffer , const char * node_key, enkf_var_type var_type,  
+                                                  int report_step , int iens , state_enum state);
+  void                 enkf_fs_batch_fwrite_vector( enkf_fs_batch_type * batch , buffer_type * buffer , const char * node_key, enkf_var_type var_type,  
+                                                    int iens , state_enum state);
+  void                 enkf_fs_batch_commit( enkf_fs_batch_type * batch );
+
   bool              enkf_fs_exists( const char * mount_point );
 
   void              enkf_fs_fread_node(enkf_fs_type * enkf_fs , buffer_type * buffer , 
@@ -109,6 +117,7 @@ extern "C" {
 
   UTIL_SAFE_CAST_HEADER( enkf_fs );
   UTIL_IS_INSTANCE_HEADER( enkf_fs );
+  UTIL_IS_INSTANCE_HEADER( enkf_fs_batch );
 
 
 #ifdef __cplusplus
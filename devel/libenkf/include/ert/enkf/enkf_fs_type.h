@@ -19,5 +19,6 @@
 #ifndef __ENKF_FS_TYPES_H__
 #define __ENKF_FS_TYPES_H__
 typedef struct enkf_fs_struct enkf_fs_type;
+typedef struct enkf_fs_batch_struct enkf_fs_batch_type;
 #endif
 
@@ -23,6 +23,7 @@ extern "C" {
 #endif
 #include <ert/util/buffer.h>
 #include <ert/util/stringlist.h>
+#include <ert/util/vector.h>
 
 #include <ert/enkf/enkf_node.h>
 #include <ert/enkf/fs_types.h>
@@ -133,6 +134,7 @@ extern "C" {
 
 
   typedef struct fs_driver_struct         fs_driver_type;
+  typedef struct fs_batch_node_struct     fs_batch_node_type;
   
   typedef void (save_kwlist_ftype)  (void * , int , int , buffer_type * buffer);  /* Functions used to load/store restart_kw_list instances. */
   typedef void (load_kwlist_ftype)  (void * , int , int , buffer_type * buffer);          
@@ -147,6 +149,8 @@ extern "C" {
   typedef void (unlink_vector_ftype)  (void * driver, const char * , int );
   typedef bool (has_vector_ftype)     (void * driver, const char * , int );
   
+  typedef void (save_batch_ftype)   (void * driver, const vector_type * );   /* Vector of fs_batch_node_type instances. */
+  
   typedef void (fsync_driver_ftype) (void * driver);
   typedef void (free_driver_ftype)  (void * driver);
 
@@ -181,6 +185,7 @@ load_vector_ftype         * load_vector;   \
 save_vector_ftype         * save_vector;   \
 has_vector_ftype          * has_vector;    \
 unlink_vector_ftype       * unlink_vector; \
+save_batch_ftype          * save_batch;    \
 free_driver_ftype         * free_driver;   \
 fsync_driver_ftype        * fsync_driver;  \
 int                         type_id
@@ -206,6 +211,15 @@ struct fs_driver_struct {
   void                       fs_driver_assert_magic( FILE * stream );
   void                       fs_driver_assert_version( FILE * stream , const char * mount_point);
 
+  fs_batch_node_type       * fs_batch_node_alloc( const char * node_key , int report_step , int iens , bool vector , buffer_type * buffer);
+  void                       fs_batch_node_free__( void * arg );
+  const char               * fs_batch_node_get_key( const fs_batch_node_type * batch_node );
+  int                        fs_batch_node_get_report_step( const fs_batch_node_type * batch_node );
+  int                        fs_batch_node_get_iens( const fs_batch_node_type * batch_node );
+  bool                       fs_batch_node_is_vector( const fs_batch_node_type * batch_node );
+  const buffer_type        * fs_batch_node_get_buffer( const fs_batch_node_type * batch_node );
+  void                       fs_driver_save_batch( fs_driver_type * driver , const vector_type * batch_nodes );
+
 
 #ifdef __cplusplus
 }
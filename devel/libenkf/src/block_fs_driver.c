@@ -19,11 +19,16 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include <ert/util/util.h>
+#include <ert/util/atomic.h>
 #include <ert/util/path_fmt.h>
 #include <ert/util/block_fs.h>
 #include <ert/util/buffer.h>
+#include <ert/util/hash.h>
+#include <ert/util/stringlist.h>
 #include <ert/util/timer.h>
 #include <ert/util/thread_pool.h>
 
@@ -39,6 +44,8 @@ typedef struct bfs_config_struct bfs_config_type;
 struct bfs_config_struct {
   int             fsync_interval;
   double          fragmentation_limit;
+  double          compactor_limit;
+  long int        compactor_budget;
   bool            read_only;
   bool            preload;
   int             block_size;
@@ -49,6 +56,34 @@ struct bfs_config_struct {
 
 #define  BFS_TYPE_ID  5510643
 
+/*
+  The nodes are stored in the block_fs instances with an integer key
+  (see block_fs_fwrite_ikey_buffer()) which packs the node key,
+  report_step and iens into one 64 bit integer:
+
+     | node_id: 23 bits | report_step + 1: 20 bits | iens: 20 bits |
+
+  where node_id is the node key interned in the block_fs instance. The
+  node keys are stored in the block_fs instance itself, one file
+  NODE_KEY_FMT for each node_id; the file is written once, and synced
+  to disk before the first node with that node_id is written, so a
+  node_id is never lost or given to two different node keys. The
+  vectors are stored with report_step == -1.
+
+  Older cases stored the nodes with the string keys
+  "node_key.report_step.iens" and "node_key.iens" for the vectors. If
+  such files are found when mounting, the string key is tried when
+  the integer key is not found; the files are migrated to the integer
+  keys with block_fs_driver_migrate_fs(), or when the node is saved
+  again.
+*/
+
+#define NODE_KEY_FMT        "#NODE_KEY.%d"     /* The '#' prefix can not clash with the old string keys. */
+#define VECTOR_REPORT_STEP  -1
+#define NODE_ID_BITS        23
+#define REPORT_STEP_BITS    20
+#define IENS_BITS           20
+
 struct bfs_struct  {
   UTIL_TYPE_ID_DECLARATION;
   /*-----------------------------------------------------------------*/
@@ -57,6 +92,11 @@ struct bfs_struct  {
   char          * mountfile;  // The full path to the file mounted by the block_fs layer - including extension. 
 
   const bfs_config_type * config;
+
+  hash_type        * node_ids;      /* node_key -> node_id; the node_ids are 0,1,2,... */
+  pthread_rwlock_t   key_lock;      /* Protects node_ids. */
+  atomic_t           legacy_files;  /* The number of files stored with the old string keys; read without locking. */
+  pthread_mutex_t    legacy_lock;   /* Serializes reading and unlinking the files with the old string keys. */
 };
 
 
@@ -88,11 +128,17 @@ bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only,
   const int fsync_interval         =  10;     /* An fsync() call is issued for every 10'th write. */
   const double fragmentation_limit = 1.0;     /* 1.0 => NO defrag is run. */
 
+  const double DYNAMIC_compactor_limit = 0.25;               /* The dynamic nodes are rewritten every iteration; compact them online. */
+  const double DEFAULT_compactor_limit = 1.0;                /* 1.0 => NO background compactor is started. */
+  const long int compactor_budget      = 16 * 1024 * 1024;   /* Bytes per second moved by the background compactor. */
+
   {
     bfs_config_type * config = util_malloc( sizeof * config );
     config->max_cache_size      = max_cache_size;
     config->fsync_interval      = fsync_interval;
     config->fragmentation_limit = fragmentation_limit;
+    config->compactor_limit     = DEFAULT_compactor_limit;
+    config->compactor_budget    = compactor_budget;
     config->read_only           = read_only;
     config->bfs_lock            = bfs_lock;
     
@@ -109,6 +155,7 @@ bfs_config_type * bfs_config_alloc( fs_driver_enum driver_type , bool read_only,
     case(DRIVER_DYNAMIC_ANALYZED):
       config->block_size = DYNAMIC_blocksize;
       config->preload = DYNAMIC_preload;
+      config->compactor_limit = DYNAMIC_compactor_limit;
       break;
     default:
       config->block_size = DEFAULT_blocksize;
@@ -129,6 +176,10 @@ static UTIL_SAFE_CAST_FUNCTION(bfs , BFS_TYPE_ID);
 static void bfs_close( bfs_type * bfs ) {
   if (bfs->block_fs != NULL)
     block_fs_close( bfs->block_fs , false);
+  hash_free( bfs->node_ids );
+  pthread_rwlock_destroy( &bfs->key_lock );
+  pthread_mutex_destroy( &bfs->legacy_lock );
+  util_safe_free( bfs->mountfile );
   free( bfs );
 }
 
@@ -147,7 +198,12 @@ static bfs_type * bfs_alloc( const bfs_config_type * config ) {
   
   // New init
   fs->mountfile = NULL;
+  fs->block_fs  = NULL;
   
+  fs->node_ids     = hash_alloc_unlocked();
+  atomic_set( &fs->legacy_files , 0 );
+  pthread_rwlock_init( &fs->key_lock , NULL );
+  pthread_mutex_init( &fs->legacy_lock , NULL );
   return fs;
 }
 
@@ -160,6 +216,67 @@ static bfs_type * bfs_alloc_new( const bfs_config_type * config , char * mountfi
 }
 
 
+/*
+  Loads the node keys; the node_ids are given out in order, so the
+  files are read until the first missing node_id. If a file stored
+  with an integer key has a node_id which is not found the node keys
+  have been lost, and the filesystem can not be used.
+*/
+
+static void bfs_load_node_keys( bfs_type * bfs ) {
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int node_id = 0;
+  
+  while (true) {
+    char * filename = util_alloc_sprintf( NODE_KEY_FMT , node_id );
+    bool has_key = block_fs_has_file( bfs->block_fs , filename );
+    if (has_key) {
+      block_fs_fread_realloc_buffer( bfs->block_fs , filename , buffer );
+      hash_insert_int( bfs->node_ids , buffer_fread_string( buffer ) , node_id );
+      node_id++;
+    }
+    free( filename );
+    if (!has_key)
+      break;
+  }
+  buffer_free( buffer );
+  
+  {
+    int64_t max_ikey;
+    if (block_fs_get_max_ikey( bfs->block_fs , &max_ikey ) && ((max_ikey >> (REPORT_STEP_BITS + IENS_BITS)) >= node_id))
+      util_abort("%s: the node key of node_id:%d is missing in:%s - can not mount the filesystem \n",__func__ , (int) (max_ikey >> (REPORT_STEP_BITS + IENS_BITS)) , bfs->mountfile);
+  }
+}
+
+
+/*
+  Stores the node key of a new node_id, and syncs it to disk before
+  any node can be written with the node_id.
+*/
+
+static void bfs_fwrite_node_key( bfs_type * bfs , const char * node_key , int node_id ) {
+  char * filename = util_alloc_sprintf( NODE_KEY_FMT , node_id );
+  buffer_type * buffer = buffer_alloc( 128 );
+  
+  buffer_fwrite_string( buffer , node_key );
+  block_fs_fwrite_buffer( bfs->block_fs , filename , buffer );
+  block_fs_fsync( bfs->block_fs );
+  
+  buffer_free( buffer );
+  free( filename );
+}
+
+
+/*
+  All the files which are not stored with an integer key, and are not
+  node keys, are stored with the old string keys.
+*/
+
+static int bfs_count_legacy_files( bfs_type * bfs ) {
+  return block_fs_get_num_files( bfs->block_fs ) - block_fs_get_num_ikeys( bfs->block_fs ) - hash_get_size( bfs->node_ids );
+}
+
+
 static void bfs_mount( bfs_type * bfs) {
   const bfs_config_type * config = bfs->config;
   bfs->block_fs = block_fs_mount( bfs->mountfile , 
@@ -170,6 +287,12 @@ static void bfs_mount( bfs_type * bfs) {
                                   config->preload , 
                                   config->read_only,
                                   config->bfs_lock);
+
+  bfs_load_node_keys( bfs );
+  atomic_set( &bfs->legacy_files , bfs_count_legacy_files( bfs ));
+
+  if (!config->read_only && (config->compactor_limit < 1.0))
+    block_fs_start_compactor( bfs->block_fs , config->compactor_limit , config->compactor_budget );
 }
 
 
@@ -189,6 +312,311 @@ static void bfs_fsync( bfs_type * bfs ) {
 }
 
 
+static int64_t bfs_make_ikey( int node_id , int report_step , int iens ) {
+  if ((report_step < VECTOR_REPORT_STEP) || (report_step + 1 >= (1 << REPORT_STEP_BITS)))
+    util_abort("%s: report_step:%d can not be stored \n",__func__ , report_step);
+  
+  if ((iens < 0) || (iens >= (1 << IENS_BITS)))
+    util_abort("%s: iens:%d can not be stored \n",__func__ , iens);
+
+  return (((int64_t) node_id) << (REPORT_STEP_BITS + IENS_BITS)) + (((int64_t) (report_step + 1)) << IENS_BITS) + iens;
+}
+
+
+static void bfs_split_ikey( int64_t ikey , int * node_id , int * report_step , int * iens ) {
+  *node_id     = (int) (ikey >> (REPORT_STEP_BITS + IENS_BITS));
+  *report_step = (int) ((ikey >> IENS_BITS) & ((1 << REPORT_STEP_BITS) - 1)) - 1;
+  *iens        = (int) (ikey & ((1 << IENS_BITS) - 1));
+}
+
+
+/*
+  Looks up the integer key of the node; returns false if @node_key has
+  never been stored in this block_fs instance.
+*/
+
+static bool bfs_lookup_ikey( bfs_type * bfs , const char * node_key , int report_step , int iens , int64_t * ikey) {
+  bool has_key;
+  pthread_rwlock_rdlock( &bfs->key_lock );
+  has_key = hash_has_key( bfs->node_ids , node_key );
+  if (has_key)
+    *ikey = bfs_make_ikey( hash_get_int( bfs->node_ids , node_key ) , report_step , iens );
+  pthread_rwlock_unlock( &bfs->key_lock );
+  return has_key;
+}
+
+
+/*
+  As bfs_lookup_ikey(), but a node_key which has not been seen before
+  is interned, and the table of node keys is stored.
+*/
+
+static int64_t bfs_alloc_ikey( bfs_type * bfs , const char * node_key , int report_step , int iens ) {
+  int64_t ikey;
+  if (!bfs_lookup_ikey( bfs , node_key , report_step , iens , &ikey )) {
+    pthread_rwlock_wrlock( &bfs->key_lock );
+    if (!hash_has_key( bfs->node_ids , node_key )) {
+      int node_id = hash_get_size( bfs->node_ids );
+      if (node_id >= (1 << NODE_ID_BITS))
+        util_abort("%s: too many different keys stored in:%s \n",__func__ , bfs->mountfile);
+      
+      bfs_fwrite_node_key( bfs , node_key , node_id );
+      hash_insert_int( bfs->node_ids , node_key , node_id );
+    }
+    ikey = bfs_make_ikey( hash_get_int( bfs->node_ids , node_key ) , report_step , iens );
+    pthread_rwlock_unlock( &bfs->key_lock );
+  }
+  return ikey;
+}
+
+
+static char * bfs_alloc_legacy_key( const char * node_key , int report_step , int iens ) {
+  if (report_step == VECTOR_REPORT_STEP)
+    return util_alloc_sprintf("%s.%d" , node_key , iens);
+  else
+    return util_alloc_sprintf("%s.%d.%d" , node_key , report_step , iens);
+}
+
+
+/*
+  The count only goes down, so once it has reached zero the old string
+  keys need never be looked at again.
+*/
+
+static bool bfs_has_legacy_files( bfs_type * bfs ) {
+  return (atomic_read( &bfs->legacy_files ) > 0);
+}
+
+
+/*
+  Unlinks the file stored with the old string key, if it exists. Must
+  be called with the legacy_lock held.
+*/
+
+static void bfs_unlink_legacy_file__( bfs_type * bfs , const char * legacy_key ) {
+  if (block_fs_has_file( bfs->block_fs , legacy_key )) {
+    block_fs_unlink_file( bfs->block_fs , legacy_key );
+    atomic_dec( &bfs->legacy_files );
+  }
+}
+
+
+static void bfs_unlink_legacy_file( bfs_type * bfs , const char * node_key , int report_step , int iens ) {
+  if (bfs_has_legacy_files( bfs )) {
+    char * legacy_key = bfs_alloc_legacy_key( node_key , report_step , iens );
+    pthread_mutex_lock( &bfs->legacy_lock );
+    bfs_unlink_legacy_file__( bfs , legacy_key );
+    pthread_mutex_unlock( &bfs->legacy_lock );
+    free( legacy_key );
+  }
+}
+
+
+static bool bfs_has_node( bfs_type * bfs , const char * node_key , int report_step , int iens ) {
+  int64_t ikey;
+  bool has_node = false;
+  
+  if (bfs_lookup_ikey( bfs , node_key , report_step , iens , &ikey ))
+    has_node = block_fs_has_ikey( bfs->block_fs , ikey );
+  
+  if (!has_node && bfs_has_legacy_files( bfs )) {
+    char * legacy_key = bfs_alloc_legacy_key( node_key , report_step , iens );
+    has_node = block_fs_has_file( bfs->block_fs , legacy_key );
+    free( legacy_key );
+  }
+  return has_node;
+}
+
+
+/*
+  A node which is only found with the old string key is read from
+  there; the integer key is checked again with the legacy_lock held,
+  because the node might have been saved, and the old file unlinked,
+  by another thread in the meantime.
+*/
+
+static void bfs_load_node( bfs_type * bfs , const char * node_key , int report_step , int iens , buffer_type * buffer) {
+  int64_t ikey;
+  
+  if (bfs_lookup_ikey( bfs , node_key , report_step , iens , &ikey ) && (!bfs_has_legacy_files( bfs ) || block_fs_has_ikey( bfs->block_fs , ikey )))
+    block_fs_fread_ikey_buffer( bfs->block_fs , ikey , buffer );
+  else {
+    pthread_mutex_lock( &bfs->legacy_lock );
+    if (bfs_lookup_ikey( bfs , node_key , report_step , iens , &ikey ) && block_fs_has_ikey( bfs->block_fs , ikey ))
+      block_fs_fread_ikey_buffer( bfs->block_fs , ikey , buffer );
+    else {
+      char * legacy_key = bfs_alloc_legacy_key( node_key , report_step , iens );
+      block_fs_fread_realloc_buffer( bfs->block_fs , legacy_key , buffer );
+      free( legacy_key );
+    }
+    pthread_mutex_unlock( &bfs->legacy_lock );
+  }
+}
+
+
+static void bfs_save_node( bfs_type * bfs , const char * node_key , int report_step , int iens , buffer_type * buffer) {
+  int64_t ikey = bfs_alloc_ikey( bfs , node_key , report_step , iens );
+  block_fs_fwrite_ikey_buffer( bfs->block_fs , ikey , buffer );
+  bfs_unlink_legacy_file( bfs , node_key , report_step , iens );
+}
+
+
+static void bfs_unlink_node( bfs_type * bfs , const char * node_key , int report_step , int iens ) {
+  int64_t ikey;
+  
+  if (bfs_lookup_ikey( bfs , node_key , report_step , iens , &ikey ) && block_fs_has_ikey( bfs->block_fs , ikey ))
+    block_fs_unlink_ikey( bfs->block_fs , ikey );
+  bfs_unlink_legacy_file( bfs , node_key , report_step , iens );
+}
+
+
+
+/*
+  Parses a filename stored with the old string keys; the string keys
+  of the nodes end with two integers and the string keys of the
+  vectors with one, unless the node key itself ends with an integer,
+  in which case the vector is only recognized if the node key is in
+  @vector_keys. Returns false if @filename is not an old string key.
+*/
+
+static bool bfs_sscanf_legacy_key( const char * filename , const stringlist_type * vector_keys , char ** node_key , int * report_step , int * iens) {
+  bool legacy_key = false;
+  char ** tmp;
+  int num_items;
+  
+  *node_key = NULL;
+  util_split_string( filename , "." , &num_items , &tmp );
+  if ((num_items >= 2) && util_sscanf_int( tmp[num_items - 1] , iens )) {
+    char * vector_key = util_alloc_joined_string( (const char **) tmp , num_items - 1 , ".");
+    
+    if (((vector_keys == NULL) || !stringlist_contains( vector_keys , vector_key )) && block_fs_sscanf_key( filename , node_key , report_step , iens ))
+      free( vector_key );
+    else {
+      *node_key    = vector_key;
+      *report_step = VECTOR_REPORT_STEP;
+    }
+    legacy_key = true;
+  }
+  util_free_stringlist( tmp , num_items );
+  return legacy_key;
+}
+
+
+/*
+  Moves all the files stored with the old string keys to the integer
+  keys, and returns the number of files moved.
+*/
+
+static int bfs_migrate( bfs_type * bfs , const stringlist_type * vector_keys ) {
+  int migrated_files = 0;
+  
+  if (bfs_has_legacy_files( bfs )) {
+    vector_type * file_list = block_fs_alloc_filelist( bfs->block_fs , NULL , NO_SORT , false );
+    buffer_type * buffer = buffer_alloc( 1024 );
+    int i;
+    
+    for (i=0; i < vector_get_size( file_list ); i++) {
+      const char * filename = user_file_node_get_filename( vector_iget_const( file_list , i ));
+      int64_t ikey;
+      
+      if (!block_fs_sscanf_ikey( filename , &ikey ) && (filename[0] != '#')) {
+        char * node_key;
+        int report_step , iens;
+        
+        if (!bfs_sscanf_legacy_key( filename , vector_keys , &node_key , &report_step , &iens ))
+          util_abort("%s: failed to parse:%s in:%s \n",__func__ , filename , bfs->mountfile);
+        
+        ikey = bfs_alloc_ikey( bfs , node_key , report_step , iens );
+        pthread_mutex_lock( &bfs->legacy_lock );
+        if (!block_fs_has_ikey( bfs->block_fs , ikey )) {   /* The node might have been saved again already. */
+          block_fs_fread_realloc_buffer( bfs->block_fs , filename , buffer );
+          block_fs_fwrite_ikey_buffer( bfs->block_fs , ikey , buffer );
+        }
+        bfs_unlink_legacy_file__( bfs , filename );
+        pthread_mutex_unlock( &bfs->legacy_lock );
+        
+        migrated_files++;
+        free( node_key );
+      }
+    }
+    buffer_free( buffer );
+    vector_free( file_list );
+  }
+  return migrated_files;
+}
+
+
+
+/*
+  Returns the node keys of the block_fs instance, with the node key of
+  node_id at index node_id.
+*/
+
+static stringlist_type * bfs_alloc_node_key_list( bfs_type * bfs ) {
+  stringlist_type * node_keys = stringlist_alloc_new();
+  hash_iter_type * iter = hash_iter_alloc( bfs->node_ids );
+  
+  while (!hash_iter_is_complete( iter )) {
+    const char * node_key = hash_iter_get_next_key( iter );
+    stringlist_iset_copy( node_keys , hash_get_int( bfs->node_ids , node_key ) , node_key );
+  }
+  hash_iter_free( iter );
+  return node_keys;
+}
+
+
+/*
+  Copies all the nodes in @src_bfs to the target instances; a node
+  goes to target_bfs[iens % num_target]. The node_ids are local to
+  each block_fs instance, so the integer keys are decoded with the
+  node keys of @src_bfs and interned again in the target, and the
+  node key files themselves are not copied. A file with an old string
+  key is copied to the integer key, unless @src_bfs also has the node
+  with the integer key; that is the newer version. Returns the number
+  of nodes copied.
+*/
+
+static int bfs_copy( bfs_type * src_bfs , bfs_type ** target_bfs , int num_target , const stringlist_type * vector_keys ) {
+  stringlist_type * node_keys = bfs_alloc_node_key_list( src_bfs );
+  vector_type * file_list = block_fs_alloc_filelist( src_bfs->block_fs , NULL , NO_SORT , false );
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int copied_files = 0;
+  int i;
+  
+  for (i=0; i < vector_get_size( file_list ); i++) {
+    const char * filename = user_file_node_get_filename( vector_iget_const( file_list , i ));
+    int64_t ikey;
+    
+    if (block_fs_sscanf_ikey( filename , &ikey )) {
+      int node_id , report_step , iens;
+      
+      bfs_split_ikey( ikey , &node_id , &report_step , &iens );
+      block_fs_fread_ikey_buffer( src_bfs->block_fs , ikey , buffer );
+      bfs_save_node( target_bfs[ iens % num_target ] , stringlist_iget( node_keys , node_id ) , report_step , iens , buffer );
+      copied_files++;
+    } else if (filename[0] != '#') {
+      char * node_key;
+      int report_step , iens;
+      
+      if (!bfs_sscanf_legacy_key( filename , vector_keys , &node_key , &report_step , &iens ))
+        util_abort("%s: failed to parse:%s in:%s \n",__func__ , filename , src_bfs->mountfile);
+      
+      if (!(bfs_lookup_ikey( src_bfs , node_key , report_step , iens , &ikey ) && block_fs_has_ikey( src_bfs->block_fs , ikey ))) {
+        block_fs_fread_realloc_buffer( src_bfs->block_fs , filename , buffer );
+        bfs_save_node( target_bfs[ iens % num_target ] , node_key , report_step , iens , buffer );
+        copied_files++;
+      }
+      free( node_key );
+    }
+  }
+  
+  buffer_free( buffer );
+  vector_free( file_list );
+  stringlist_free( node_keys );
+  return copied_files;
+}
+
+
 
 /*****************************************************************/
 
@@ -205,23 +633,13 @@ static block_fs_driver_type * block_fs_driver_safe_cast( void * __driver) {
   return driver;
 }
 
-static char * block_fs_driver_alloc_node_key( const block_fs_driver_type * driver , const char * node_key , int report_step , int iens) {
-  char * key = util_alloc_sprintf("%s.%d.%d" , node_key , report_step , iens);
-  return key;
-}
-
-
-static char * block_fs_driver_alloc_vector_key( const block_fs_driver_type * driver , const char * node_key , int iens) {
-  char * key = util_alloc_sprintf("%s.%d" , node_key , iens);
-  return key;
-}
-
 /**
    This function will take an input string, and try to to parse it as
    string.int.int, where string is the normal enkf key, and the two
-   integers are report_step and ensemble number respectively. The
-   storage for the enkf_key is allocated here in this function, and
-   must be freed by the calling scope.  
+   integers are report_step and ensemble number respectively; i.e. the
+   old string keys of the nodes. The storage for the enkf_key is
+   allocated here in this function, and must be freed by the calling
+   scope.  
 
    If the parsing fails the function will return false, and *config_key
    will be set to NULL; in this case the report_step and iens poinyers
@@ -229,6 +647,7 @@ static char * block_fs_driver_alloc_vector_key( const block_fs_driver_type * dri
 */
 
 bool block_fs_sscanf_key(const char * key , char ** config_key , int * __report_step , int * __iens) {
+  bool parse_ok = false;
   char ** tmp;
   int num_items;
 
@@ -241,14 +660,14 @@ bool block_fs_sscanf_key(const char * key , char ** config_key , int * __report_
       *__report_step = report_step;
       *__iens        = iens;
       *config_key    = util_alloc_joined_string((const char **) tmp , num_items - 2 , ".");  /* This must bee freed by the calling scope */
-      util_free_stringlist( tmp , num_items );
-      return true;
-    } else  
-      /* Failed to parse the two last items as integers. */
-      return false;
-  } else
-    /* Did not have at least three items. */
-    return false;
+      parse_ok = true;
+    } 
+    /* Else: failed to parse the two last items as integers. */
+  } 
+  /* Else: did not have at least three items. */
+  
+  util_free_stringlist( tmp , num_items );
+  return parse_ok;
 }
 
 
@@ -265,12 +684,8 @@ static bfs_type * block_fs_driver_get_fs( block_fs_driver_type * driver , int ie
 static void block_fs_driver_load_node(void * _driver , const char * node_key , int report_step , int iens ,  buffer_type * buffer) {
   block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
   {
-    char * key          = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
     bfs_type      * bfs = block_fs_driver_get_fs( driver , iens );
-    
-    block_fs_fread_realloc_buffer( bfs->block_fs , key , buffer);
-    
-    free( key );
+    bfs_load_node( bfs , node_key , report_step , iens , buffer );
   }
 }
 
@@ -278,11 +693,8 @@ static void block_fs_driver_load_node(void * _driver , const char * node_key , i
 static void block_fs_driver_load_vector(void * _driver , const char * node_key , int iens ,  buffer_type * buffer) {
   block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
   {
-    char * key          = block_fs_driver_alloc_vector_key( driver , node_key , iens );
     bfs_type      * bfs = block_fs_driver_get_fs( driver , iens );
-    
-    block_fs_fread_realloc_buffer( bfs->block_fs , key , buffer);
-    free( key );
+    bfs_load_node( bfs , node_key , VECTOR_REPORT_STEP , iens , buffer );
   }
 }
 
@@ -292,10 +704,8 @@ static void block_fs_driver_save_node(void * _driver , const char * node_key , i
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key     = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
     bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_fwrite_buffer( bfs->block_fs , key , buffer);
-    free( key );
+    bfs_save_node( bfs , node_key , report_step , iens , buffer );
   }
 }
 
@@ -304,10 +714,63 @@ static void block_fs_driver_save_vector(void * _driver , const char * node_key ,
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key     = block_fs_driver_alloc_vector_key( driver , node_key , iens );
     bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_fwrite_buffer( bfs->block_fs , key , buffer);
-    free( key );
+    bfs_save_node( bfs , node_key , VECTOR_REPORT_STEP , iens , buffer );
+  }
+}
+
+/**
+   The nodes in the batch are grouped according to the block_fs
+   instance they belong to, and each group is committed as one
+   block_fs batch; i.e. the batch is atomic for each of the underlying
+   block_fs instances. The nodes of one realization are all stored in
+   the same block_fs instance.
+*/
+
+static int block_fs_batch_node_get_report_step( const fs_batch_node_type * batch_node ) {
+  if (fs_batch_node_is_vector( batch_node ))
+    return VECTOR_REPORT_STEP;
+  else
+    return fs_batch_node_get_report_step( batch_node );
+}
+
+
+static void block_fs_driver_save_batch(void * _driver , const vector_type * batch_nodes) {
+  block_fs_driver_type * driver = block_fs_driver_safe_cast( _driver );
+  {
+    block_fs_batch_type ** batch_list = util_calloc( driver->num_fs , sizeof * batch_list );
+    int i;
+    
+    for (i=0; i < driver->num_fs; i++)
+      batch_list[i] = NULL;
+    
+    for (i=0; i < vector_get_size( batch_nodes ); i++) {
+      const fs_batch_node_type * batch_node = vector_iget_const( batch_nodes , i );
+      int iens              = fs_batch_node_get_iens( batch_node );
+      int phase             = (iens % driver->num_fs);
+      bfs_type * bfs        = block_fs_driver_get_fs( driver , iens );
+      int64_t ikey          = bfs_alloc_ikey( bfs , fs_batch_node_get_key( batch_node ) , block_fs_batch_node_get_report_step( batch_node ) , iens );
+      
+      if (batch_list[phase] == NULL) 
+        batch_list[phase] = block_fs_batch_alloc( bfs->block_fs );
+      
+      /* The buffers in batch_nodes outlive the commit below; they are not copied again. */
+      block_fs_batch_add_ikey_buffer_ref( batch_list[phase] , ikey , fs_batch_node_get_buffer( batch_node ));
+    }
+    
+    for (i=0; i < driver->num_fs; i++) {
+      if (batch_list[i] != NULL) {
+        block_fs_batch_commit( batch_list[i] );
+        block_fs_batch_free( batch_list[i] );
+      }
+    }
+    free( batch_list );
+
+    for (i=0; i < vector_get_size( batch_nodes ); i++) {
+      const fs_batch_node_type * batch_node = vector_iget_const( batch_nodes , i );
+      int iens = fs_batch_node_get_iens( batch_node );
+      bfs_unlink_legacy_file( block_fs_driver_get_fs( driver , iens ) , fs_batch_node_get_key( batch_node ) , block_fs_batch_node_get_report_step( batch_node ) , iens );
+    }
   }
 }
 
@@ -317,10 +780,8 @@ void block_fs_driver_unlink_node(void * _driver , const char * node_key , int re
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key     = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
     bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_unlink_file( bfs->block_fs , key );
-    free( key );
+    bfs_unlink_node( bfs , node_key , report_step , iens );
   }
 }
 
@@ -328,10 +789,8 @@ void block_fs_driver_unlink_vector(void * _driver , const char * node_key , int
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key     = block_fs_driver_alloc_vector_key( driver , node_key , iens );
     bfs_type * bfs = block_fs_driver_get_fs( driver , iens );
-    block_fs_unlink_file( bfs->block_fs , key );
-    free( key );
+    bfs_unlink_node( bfs , node_key , VECTOR_REPORT_STEP , iens );
   }
 }
 
@@ -342,11 +801,8 @@ bool block_fs_driver_has_node(void * _driver , const char * node_key , int repor
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key      = block_fs_driver_alloc_node_key( driver , node_key , report_step , iens );
     bfs_type  * bfs = block_fs_driver_get_fs( driver , iens );
-    bool has_node   = block_fs_has_file( bfs->block_fs , key );
-    free( key );
-    return has_node;
+    return bfs_has_node( bfs , node_key , report_step , iens );
   }
 }
 
@@ -355,11 +811,8 @@ bool block_fs_driver_has_vector(void * _driver , const char * node_key , int ien
   block_fs_driver_type * driver = (block_fs_driver_type *) _driver;
   block_fs_driver_assert_cast(driver);
   {
-    char * key      = block_fs_driver_alloc_vector_key( driver , node_key , iens );
     bfs_type  * bfs = block_fs_driver_get_fs( driver , iens );
-    bool has_node   = block_fs_has_file( bfs->block_fs , key );
-    free( key );
-    return has_node;
+    return bfs_has_node( bfs , node_key , VECTOR_REPORT_STEP , iens );
   }
 }
 
@@ -419,6 +872,7 @@ static block_fs_driver_type * block_fs_driver_alloc(int num_fs) {
   driver->save_vector   = block_fs_driver_save_vector;
   driver->unlink_vector = block_fs_driver_unlink_vector;
   driver->has_vector    = block_fs_driver_has_vector;
+  driver->save_batch    = block_fs_driver_save_batch;
 
   driver->free_driver   = block_fs_driver_free;
   driver->fsync_driver  = block_fs_driver_fsync;
@@ -459,6 +913,66 @@ static void block_fs_driver_mount( block_fs_driver_type * driver ) {
 
 /*****************************************************************/
 
+/*
+  Mounts the block_fs instance @mount_file, and moves all the files
+  stored with the old string keys to the integer keys; see
+  bfs_sscanf_legacy_key() for @vector_keys, which can be NULL. Returns
+  the number of files moved.
+*/
+
+int block_fs_driver_migrate_fs( const char * mount_file , const stringlist_type * vector_keys ) {
+  bfs_config_type * config = bfs_config_alloc( DRIVER_STATIC , false , false );
+  bfs_type * bfs = bfs_alloc_new( config , util_alloc_string_copy( mount_file ));
+  int migrated_files;
+  
+  bfs_mount( bfs );
+  migrated_files = bfs_migrate( bfs , vector_keys );
+  bfs_close( bfs );
+  bfs_config_free( config );
+  return migrated_files;
+}
+
+
+/*
+  Copies all the nodes in the block_fs files @src_mount_files to the
+  block_fs files @target_mount_files, which are created if they do
+  not exist; a node with ensemble member iens is stored in target file
+  number iens % num_target. The nodes are stored with the integer keys
+  of the targets, whether they were stored with integer keys or with
+  the old string keys in the source; see bfs_sscanf_legacy_key() for
+  @vector_keys. The source files are not modified. Returns the number
+  of nodes copied.
+*/
+
+int block_fs_driver_copy_fs( const stringlist_type * src_mount_files , const stringlist_type * target_mount_files , const stringlist_type * vector_keys ) {
+  bfs_config_type * src_config    = bfs_config_alloc( DRIVER_STATIC , true , false );
+  bfs_config_type * target_config = bfs_config_alloc( DRIVER_STATIC , false , false );
+  int num_target = stringlist_get_size( target_mount_files );
+  bfs_type ** target_bfs = util_calloc( num_target , sizeof * target_bfs );
+  int copied_files = 0;
+  int i;
+
+  for (i=0; i < num_target; i++) {
+    target_bfs[i] = bfs_alloc_new( target_config , util_alloc_string_copy( stringlist_iget( target_mount_files , i )));
+    bfs_mount( target_bfs[i] );
+  }
+
+  for (i=0; i < stringlist_get_size( src_mount_files ); i++) {
+    bfs_type * src_bfs = bfs_alloc_new( src_config , util_alloc_string_copy( stringlist_iget( src_mount_files , i )));
+    bfs_mount( src_bfs );
+    copied_files += bfs_copy( src_bfs , target_bfs , num_target , vector_keys );
+    bfs_close( src_bfs );
+  }
+  
+  for (i=0; i < num_target; i++) 
+    bfs_close( target_bfs[i] );
+  free( target_bfs );
+  bfs_config_free( src_config );
+  bfs_config_free( target_config );
+  return copied_files;
+}
+
+
 void block_fs_driver_create_fs( FILE * stream , 
                                 const char * mount_point , 
                                 fs_driver_enum driver_type , 
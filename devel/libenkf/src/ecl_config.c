@@ -762,7 +762,8 @@ void ecl_config_set_grid(ecl_config_type * ecl_config, const char * grid_file)
 {
   if (ecl_config->grid != NULL )
     ecl_grid_free(ecl_config->grid);
-  ecl_config->grid = ecl_grid_alloc(grid_file);
+  /* The grid is mainly used for index mapping; the geometry is only calculated if it is needed. */
+  ecl_config->grid = ecl_grid_alloc_flags(grid_file , ECL_GRID_LAZY);
 }
 
 ui_return_type * ecl_config_validate_grid( const ecl_config_type * ecl_config , const char * grid_file ) {
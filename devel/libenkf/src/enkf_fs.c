@@ -33,6 +33,7 @@
 #include <ert/util/arg_pack.h>
 #include <ert/util/stringlist.h>
 #include <ert/util/arg_pack.h>
+#include <ert/util/vector.h>
 
 #include <ert/enkf/block_fs_driver.h>
 #include <ert/enkf/enkf_fs.h>
@@ -844,9 +845,107 @@ void enkf_fs_fwrite_vector(enkf_fs_type * enkf_fs , buffer_type * buffer , const
 
 
 /*****************************************************************/
+/*
+  The enkf_fs_batch type is used to collect many node writes, e.g. all
+  the summary vectors of one realization, in memory and then write
+  them all in one go with enkf_fs_batch_commit(). The writes are
+  grouped per driver, and the drivers which support it (i.e. the
+  block_fs driver) will write all the nodes as one atomic batch.
+
+  The nodes in a batch are not visible in the filesystem before the
+  batch has been committed. A batch instance should only be used by
+  one thread.
+*/
+
+#define ENKF_FS_BATCH_TYPE_ID  1089764
+
+struct enkf_fs_batch_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  enkf_fs_type * fs;
+  vector_type  * drivers;      /* The drivers which have been written to - not owned. */
+  vector_type  * node_lists;   /* One vector of fs_batch_node instances for each driver. */
+};
+
+
+UTIL_IS_INSTANCE_FUNCTION( enkf_fs_batch , ENKF_FS_BATCH_TYPE_ID)
+
+
+enkf_fs_batch_type * enkf_fs_batch_alloc( enkf_fs_type * fs ) {
+  if (fs->read_only)
+    util_abort("%s: attempt to write to read_only filesystem mounted at:%s - aborting. \n",__func__ , fs->mount_point);
+  {
+    enkf_fs_batch_type * batch = util_malloc( sizeof * batch );
+    UTIL_TYPE_ID_INIT( batch , ENKF_FS_BATCH_TYPE_ID );
+    batch->fs         = fs;
+    batch->drivers    = vector_alloc_new();
+    batch->node_lists = vector_alloc_new();
+    return batch;
+  }
+}
+
+
+/**
+   Writes which have not been committed are discarded.
+*/
 
+void enkf_fs_batch_free( enkf_fs_batch_type * batch ) {
+  vector_free( batch->drivers );
+  vector_free( batch->node_lists );
+  free( batch );
+}
 
 
+static void enkf_fs_batch_add( enkf_fs_batch_type * batch , fs_driver_type * driver , fs_batch_node_type * batch_node) {
+  vector_type * node_list = NULL;
+  int i;
+  for (i=0; i < vector_get_size( batch->drivers ); i++) {
+    if (vector_iget( batch->drivers , i ) == driver) {
+      node_list = vector_iget( batch->node_lists , i );
+      break;
+    }
+  }
+  
+  if (node_list == NULL) {
+    node_list = vector_alloc_new();
+    vector_append_ref( batch->drivers , driver );
+    vector_append_owned_ref( batch->node_lists , node_list , vector_free__ );
+  }
+  vector_append_owned_ref( node_list , batch_node , fs_batch_node_free__ );
+}
+
+
+/**
+   Warning pattern break: the batch takes ownership of the buffer,
+   which will be freed when the batch is committed or freed.
+*/
+
+void enkf_fs_batch_fwrite_node( enkf_fs_batch_type * batch , buffer_type * buffer , const char * node_key, enkf_var_type var_type,  
+                                int report_step , int iens , state_enum state) {
+  fs_driver_type * driver = fs_driver_safe_cast( enkf_fs_select_driver( batch->fs , var_type , state , node_key ));
+  enkf_fs_batch_add( batch , driver , fs_batch_node_alloc( node_key , report_step , iens , false , buffer ));
+}
+
+
+void enkf_fs_batch_fwrite_vector( enkf_fs_batch_type * batch , buffer_type * buffer , const char * node_key, enkf_var_type var_type,  
+                                  int iens , state_enum state) {
+  fs_driver_type * driver = fs_driver_safe_cast( enkf_fs_select_driver( batch->fs , var_type , state , node_key ));
+  enkf_fs_batch_add( batch , driver , fs_batch_node_alloc( node_key , -1 , iens , true , buffer ));
+}
+
+
+/**
+   Writes all the nodes in the batch; afterwards the batch is empty
+   and can be reused.
+*/
+
+void enkf_fs_batch_commit( enkf_fs_batch_type * batch ) {
+  int i;
+  for (i=0; i < vector_get_size( batch->drivers ); i++) 
+    fs_driver_save_batch( vector_iget( batch->drivers , i ) , vector_iget_const( batch->node_lists , i ));
+
+  vector_clear( batch->drivers );
+  vector_clear( batch->node_lists );
+}
 
 
 /*****************************************************************/
@@ -471,7 +471,13 @@ void enkf_node_ecl_load_static(enkf_node_type * enkf_node , const ecl_kw_type *
 
 
 
-static bool enkf_node_store_buffer( enkf_node_type * enkf_node , enkf_fs_type * fs , int report_step , int iens , state_enum state) {
+/**
+   The node is written either directly to @fs, or added to @batch if
+   that is != NULL; in the latter case the batch takes ownership of
+   the buffer.
+*/
+
+static bool enkf_node_store_buffer( enkf_node_type * enkf_node , enkf_fs_type * fs , enkf_fs_batch_type * batch , int report_step , int iens , state_enum state) {
   FUNC_ASSERT(enkf_node->write_to_buffer);
   {
     bool data_written;
@@ -483,19 +489,37 @@ static bool enkf_node_store_buffer( enkf_node_type * enkf_node , enkf_fs_type *
       const char * node_key = enkf_config_node_get_key( config_node );
       enkf_var_type var_type = enkf_config_node_get_var_type( config_node );
 
-      if (enkf_node->vector_storage)
-        enkf_fs_fwrite_vector( fs , buffer , node_key , var_type , iens , state );
-      else
-        enkf_fs_fwrite_node( fs , buffer , node_key , var_type , report_step , iens , state );
-
+      if (batch != NULL) {
+        if (enkf_node->vector_storage)
+          enkf_fs_batch_fwrite_vector( batch , buffer , node_key , var_type , iens , state );
+        else
+          enkf_fs_batch_fwrite_node( batch , buffer , node_key , var_type , report_step , iens , state );
+        buffer = NULL;
+      } else {
+        if (enkf_node->vector_storage)
+          enkf_fs_fwrite_vector( fs , buffer , node_key , var_type , iens , state );
+        else
+          enkf_fs_fwrite_node( fs , buffer , node_key , var_type , report_step , iens , state );
+      }
     }
-    buffer_free( buffer );
+    if (buffer != NULL)
+      buffer_free( buffer );
     return data_written;
   }
 }
 
 bool enkf_node_store_vector(enkf_node_type *enkf_node , enkf_fs_type * fs , int iens , state_enum state) {
-  return enkf_node_store_buffer( enkf_node , fs , -1 , iens , state);
+  return enkf_node_store_buffer( enkf_node , fs , NULL , -1 , iens , state);
+}
+
+
+/**
+   As enkf_node_store_vector(), but the vector is only added to the
+   batch; it is written to disk when the batch is committed.
+*/
+
+bool enkf_node_batch_store_vector(enkf_node_type *enkf_node , enkf_fs_batch_type * batch , int iens , state_enum state) {
+  return enkf_node_store_buffer( enkf_node , NULL , batch , -1 , iens , state);
 }
 
 
@@ -514,7 +538,7 @@ bool enkf_node_store(enkf_node_type * enkf_node , enkf_fs_type * fs , bool force
     }
 
     {
-      bool data_written = enkf_node_store_buffer( enkf_node , fs , node_id.report_step , node_id.iens , node_id.state );
+      bool data_written = enkf_node_store_buffer( enkf_node , fs , NULL , node_id.report_step , node_id.iens , node_id.state );
       enkf_node->__node_id   = node_id;
       enkf_node->__modified  = false;
       return data_written;
@@ -732,7 +732,13 @@ static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enk
         const int iens                         = member_config_get_iens( enkf_state->my_config );
         const int step2                        = ecl_sum_get_last_report_step( summary );  /* Step2 is just taken from the number of steps found in the summary file. */
         {
+          /* 
+             All the summary vectors of the realization are collected
+             in one batch, which is written in one go - instead of
+             one small write for each vector.
+          */
           hash_iter_type * iter = hash_iter_alloc( enkf_state->node_hash );
+          enkf_fs_batch_type * batch = enkf_fs_batch_alloc( fs );
 
           while ( !hash_iter_is_complete(iter) ) {
             enkf_node_type * node = hash_iter_get_next_value(iter);
@@ -741,7 +747,7 @@ static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enk
               {
                 enkf_node_try_load_vector( node , fs , iens , FORECAST );  // Ensure that what is currently on file is loaded before we update.
                 if (enkf_node_forward_load_vector( node , run_info->run_path , summary , NULL , load_start, step2 , iens)) 
-                  enkf_node_store_vector( node , fs , iens , FORECAST );
+                  enkf_node_batch_store_vector( node , batch , iens , FORECAST );
                 else {
                   *result |= LOAD_FAILURE; 
                   log_add_fmt_message(shared_info->logh , 3 , NULL , "[%03d:----] Failed to load data for vector node:%s.",iens , enkf_node_get_key( node ));
@@ -752,6 +758,8 @@ static bool enkf_state_internalize_dynamic_eclipse_results(enkf_state_type * enk
             }
           } 
           
+          enkf_fs_batch_commit( batch );
+          enkf_fs_batch_free( batch );
           hash_iter_free(iter);
         }
         {
@@ -900,7 +908,7 @@ static void enkf_state_internalize_eclipse_state(enkf_state_type * enkf_state ,
     {
       char * filename  = ecl_util_alloc_exfilename(run_info->run_path , member_config_get_eclbase(enkf_state->my_config) , ECL_RESTART_FILE , fmt_file , report_step);
       if (filename) {
-        restart_file = ecl_file_open( filename , 0 );
+        restart_file = ecl_file_open( filename , ECL_FILE_PREFETCH );
         free(filename);
       } else 
         restart_file = NULL;  /* No restart information was found; if that is expected the program will fail hard in the enkf_node_forward_load() functions. */
@@ -46,6 +46,7 @@ void fs_driver_init(fs_driver_type * driver) {
   driver->save_vector   = NULL;
   driver->has_vector    = NULL;
   driver->unlink_vector = NULL;
+  driver->save_batch    = NULL;
   
   driver->free_driver   = NULL;
   driver->fsync_driver  = NULL;
@@ -64,6 +65,84 @@ fs_driver_type * fs_driver_safe_cast(void * __driver) {
   return driver;
 }
 
+/*****************************************************************/
+/* 
+   The fs_batch_node type holds one node write which is part of a
+   batch; the drivers which implement the save_batch() function will
+   get all the writes in the batch in one call, and can then write
+   them in one go. For drivers without save_batch() the batch is
+   written node by node with save_node() / save_vector().
+*/
+
+struct fs_batch_node_struct {
+  char        * node_key;
+  int           report_step;
+  int           iens;
+  bool          vector;
+  buffer_type * buffer;
+};
+
+
+/**
+   Warning pattern break: the batch node takes ownership of the
+   buffer.
+*/
+
+fs_batch_node_type * fs_batch_node_alloc( const char * node_key , int report_step , int iens , bool vector , buffer_type * buffer) {
+  fs_batch_node_type * batch_node = util_malloc( sizeof * batch_node );
+  batch_node->node_key    = util_alloc_string_copy( node_key );
+  batch_node->report_step = report_step;
+  batch_node->iens        = iens;
+  batch_node->vector      = vector;
+  batch_node->buffer      = buffer;
+  return batch_node;
+}
+
+
+void fs_batch_node_free__( void * arg ) {
+  fs_batch_node_type * batch_node = (fs_batch_node_type *) arg;
+  free( batch_node->node_key );
+  buffer_free( batch_node->buffer );
+  free( batch_node );
+}
+
+
+const char * fs_batch_node_get_key( const fs_batch_node_type * batch_node ) {
+  return batch_node->node_key;
+}
+
+int fs_batch_node_get_report_step( const fs_batch_node_type * batch_node ) {
+  return batch_node->report_step;
+}
+
+int fs_batch_node_get_iens( const fs_batch_node_type * batch_node ) {
+  return batch_node->iens;
+}
+
+bool fs_batch_node_is_vector( const fs_batch_node_type * batch_node ) {
+  return batch_node->vector;
+}
+
+const buffer_type * fs_batch_node_get_buffer( const fs_batch_node_type * batch_node ) {
+  return batch_node->buffer;
+}
+
+
+void fs_driver_save_batch( fs_driver_type * driver , const vector_type * batch_nodes ) {
+  if (driver->save_batch != NULL)
+    driver->save_batch( driver , batch_nodes );
+  else {
+    int i;
+    for (i=0; i < vector_get_size( batch_nodes ); i++) {
+      const fs_batch_node_type * batch_node = vector_iget_const( batch_nodes , i );
+      if (batch_node->vector)
+        driver->save_vector( driver , batch_node->node_key , batch_node->iens , batch_node->buffer );
+      else
+        driver->save_node( driver , batch_node->node_key , batch_node->report_step , batch_node->iens , batch_node->buffer );
+    }
+  }
+}
+
 /*****************************************************************/
 
 
@@ -16,60 +16,41 @@
    for more details. 
 */
 
-#include <block_fs.h>
-#include <util.h>
-#include <stringlist.h>
-#include <block_fs.h>
-#include <block_fs_driver.h>
-#include <msg.h>
+#include <ert/util/util.h>
+#include <ert/util/stringlist.h>
+#include <ert/util/msg.h>
 
+#include <ert/enkf/block_fs_driver.h>
 
 
-static void migrate_file( const char * src_case, int num_src_drivers , const char * target_case, int num_target_drivers, const char * file, int block_size , msg_type * msg) {
-  block_fs_type ** target_fs = util_calloc( num_target_drivers , sizeof * target_fs  ); 
-  int itarget;
+
+/*
+  Copies all the nodes to the target case; the nodes are stored with
+  the integer keys of the target, both when the source has them with
+  the old string keys and with the integer keys of the source. See
+  block_fs_driver_copy_fs() for @vector_keys.
+*/
+
+static void migrate_file( const char * src_case, int num_src_drivers , const char * target_case, int num_target_drivers, const char * file, const stringlist_type * vector_keys , msg_type * msg) {
+  stringlist_type * src_mount_files    = stringlist_alloc_new();
+  stringlist_type * target_mount_files = stringlist_alloc_new();
+  int isrc , itarget;
+
+  for (isrc = 0; isrc < num_src_drivers; isrc++) 
+    stringlist_append_owned_ref( src_mount_files , util_alloc_sprintf("%s/mod_%d/%s.mnt" , src_case , isrc , file ));
+  
   for (itarget = 0; itarget < num_target_drivers; itarget++) {
-    char * path       = util_alloc_sprintf("%s/mod_%d" , target_case , itarget );
-    char * mount_file = util_alloc_sprintf("%s/mod_%d/%s.mnt" , target_case , itarget , file );
+    char * path = util_alloc_sprintf("%s/mod_%d" , target_case , itarget );
     util_make_path( path );
-    
-    target_fs[itarget] =  block_fs_mount( mount_file , 16 , 0 , 1.0, 0 , false , false );
-    free( mount_file );
+    stringlist_append_owned_ref( target_mount_files , util_alloc_sprintf("%s/mod_%d/%s.mnt" , target_case , itarget , file ));
     free( path );
   } 
 
-  {
-    int isrc;
-    buffer_type * buffer = buffer_alloc(1024);
-    for (isrc = 0; isrc < num_src_drivers; isrc++) {
-      char * mount_file = util_alloc_sprintf("%s/mod_%d/%s.mnt" , src_case , isrc , file );
-      block_fs_type   * src_fs    = block_fs_mount( mount_file , 16 , 1024 , 1.0 , 0 , true , true );
-      vector_type     * file_list = block_fs_alloc_filelist( src_fs , NULL , NO_SORT , false );
-      int ifile;
-      msg_update( msg , mount_file );
-      for (ifile = 0; ifile < vector_get_size( file_list ); ifile++) {
-        const file_node_type * node = vector_iget_const( file_list , ifile );
-        const char * filename       = file_node_get_filename( node );
-        int   report_step , iens;
-        char * key;
-        if (block_fs_sscanf_key( filename , &key , &report_step , &iens )) {
-          block_fs_fread_realloc_buffer( src_fs , filename , buffer);
-          block_fs_fwrite_buffer( target_fs[(iens % num_target_drivers)] , filename , buffer );
-          free( key );
-        } else
-          util_abort("%s: All hell is loose - failed to parse:%s \n",__func__ , filename);
-      }
-
-      vector_free( file_list );
-      block_fs_close(src_fs , false);
-    }
-    buffer_free( buffer );
-  }
-
+  msg_update( msg , file );
+  block_fs_driver_copy_fs( src_mount_files , target_mount_files , vector_keys );
   
-  for (itarget = 0; itarget < num_target_drivers; itarget++) 
-    block_fs_close( target_fs[itarget] , false);
-  free( target_fs );
+  stringlist_free( src_mount_files );
+  stringlist_free( target_mount_files );
 }
 
 
@@ -91,20 +72,24 @@ static void copy_index( const char * src_case , const char * target_case) {
 
 static void usage() {
   printf("Use:\n");
-  printf("bash%% migrate_bfs <Source ENSPATH>  <Target ENSPATH> case\n");
+  printf("bash%% migrate_bfs <Source ENSPATH>  <Target ENSPATH> case [vector_key ...]\n");
+  printf("\n");
+  printf("The vector keys only need to be given for vectors where the key\n");
+  printf("itself ends with an integer, e.g. FOPR.2\n");
   exit(1);
 }
 
 int main(int argc, char ** argv) {
   int num_src_drivers    = 10;
   int num_target_drivers = 32;
-  if (argc != 4) 
+  if (argc < 4) 
     usage();
   
   {
     char * src_path        = argv[1] ;
     char * target_path     = argv[2] ;
     char * dir             = argv[3] ;
+    stringlist_type * vector_keys = stringlist_alloc_argv_ref( (const char **) &argv[4] , argc - 4 );
    
     util_make_path( target_path );
     if (util_same_file( src_path , target_path)) {
@@ -118,14 +103,15 @@ int main(int argc, char ** argv) {
 
       msg_type * msg = msg_alloc("Copying from: " , false);
       msg_show( msg );
-      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "ANALYZED" , 32 , msg);
-      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "FORECAST" , 32 , msg);
-      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "PARAMETER" , 32 , msg);
-      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "STATIC" , 32 , msg);
+      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "ANALYZED" , vector_keys , msg);
+      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "FORECAST" , vector_keys , msg);
+      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "PARAMETER" , vector_keys , msg);
+      migrate_file(src_case , num_src_drivers , target_case , num_target_drivers , "STATIC" , vector_keys , msg);
       copy_index( src_case , target_case );
       free( src_case);
       free( target_case );
       msg_free( msg , true );
     }
+    stringlist_free( vector_keys );
   }
 }
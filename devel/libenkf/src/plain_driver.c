@@ -231,6 +231,7 @@ void * plain_driver_alloc(const char * mount_point , const char * node_fmt, cons
   driver->unlink_vector       = plain_driver_unlink_vector;
   driver->has_vector          = plain_driver_has_vector;
 
+  driver->save_batch          = NULL;   /* Batches are written node by node. */
   driver->fsync_driver        = NULL;
   driver->free_driver         = plain_driver_free;
   driver->mount_point         = util_alloc_string_copy( mount_point );
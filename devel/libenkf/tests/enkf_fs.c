@@ -20,10 +20,18 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include <ert/util/test_util.h>
 #include <ert/util/test_work_area.h>
+#include <ert/util/buffer.h>
+#include <ert/util/block_fs.h>
+#include <ert/util/stringlist.h>
 #include <ert/enkf/enkf_fs.h>
+#include <ert/enkf/fs_driver.h>
+#include <ert/enkf/block_fs_driver.h>
 
 
 
@@ -87,9 +95,205 @@ void test_read_only() {
 
 
 
+/*
+  Mounts the filesystem in a child process which stores a node under a
+  new node key, and then exits without unmounting the filesystem.
+*/
+
+void crash_write( const char * node_key , int iens , int value ) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    enkf_fs_type * fs = enkf_fs_mount( "mnt" , false );
+    buffer_type * buffer = buffer_alloc( 100 );
+    buffer_fwrite_int( buffer , value );
+    enkf_fs_fwrite_node( fs , buffer , node_key , STATIC_STATE , 0 , iens , FORECAST );
+    _exit(0);
+  } else {
+    int status;
+    waitpid( pid , &status , 0 );
+    test_assert_true( WIFEXITED( status ));
+  }
+}
+
+
+void test_node_value( enkf_fs_type * fs , const char * node_key , int iens , int value ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  test_assert_true( enkf_fs_has_node( fs , node_key , STATIC_STATE , 0 , iens , FORECAST ));
+  enkf_fs_fread_node( fs , buffer , node_key , STATIC_STATE , 0 , iens , FORECAST );
+  test_assert_int_equal( buffer_fread_int( buffer ) , value );
+  buffer_free( buffer );
+}
+
+
+/*
+  The node keys are interned when they are first stored; a node key
+  must survive a crash, and never be given to another node key.
+*/
+
+void test_crash_node_keys() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/crash_node_keys");
+  
+  enkf_fs_create_fs("mnt" , BLOCK_FS_DRIVER_ID , NULL );
+  crash_write( "KEY1" , 0 , 1 );
+  crash_write( "KEY2" , 0 , 2 );
+  crash_write( "KEY1" , 0 , 3 );
+  {
+    enkf_fs_type * fs = enkf_fs_mount( "mnt" , false );
+    test_node_value( fs , "KEY1" , 0 , 3 );
+    test_node_value( fs , "KEY2" , 0 , 2 );
+    test_assert_false( enkf_fs_has_node( fs , "KEY3" , STATIC_STATE , 0 , 0 , FORECAST ));
+    enkf_fs_decref( fs );
+  }
+  
+  /* The node keys are lost; the filesystem can not be mounted. */
+  {
+    block_fs_type * block_fs = block_fs_mount( "mnt/Ensemble/mod_0/STATIC.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    test_assert_true( block_fs_has_file( block_fs , "#NODE_KEY.1" ));
+    block_fs_unlink_file( block_fs , "#NODE_KEY.1" );
+    block_fs_close( block_fs , false );
+  }
+  {
+    pid_t pid = fork();
+    if (pid == 0) {
+      enkf_fs_mount( "mnt" , true );
+      _exit(0);
+    } else {
+      int status;
+      waitpid( pid , &status , 0 );
+      test_assert_true( WIFSIGNALED( status ));
+    }
+  }
+  test_work_area_free( work_area );
+}
+
+
+fs_driver_type * open_driver( const char * mount_point , int num_fs , bool read_only ) {
+  char * fstab = util_alloc_filename( NULL , mount_point , "fstab" );
+  fs_driver_type * driver;
+  
+  if (!util_file_exists( fstab )) {
+    FILE * stream = util_fopen( fstab , "w" );
+    block_fs_driver_create_fs( stream , mount_point , DRIVER_STATIC , num_fs , "mod_%d" , "STATIC" );
+    fclose( stream );
+  }
+  {
+    FILE * stream = util_fopen( fstab , "r" );
+    util_fread_int( stream );
+    driver = block_fs_driver_open( stream , mount_point , DRIVER_STATIC , read_only );
+    fclose( stream );
+  }
+  free( fstab );
+  return driver;
+}
+
+
+void save_node( fs_driver_type * driver , const char * node_key , int report_step , int iens , int value ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  buffer_fwrite_int( buffer , value );
+  if (report_step < 0)
+    driver->save_vector( driver , node_key , iens , buffer );
+  else
+    driver->save_node( driver , node_key , report_step , iens , buffer );
+  buffer_free( buffer );
+}
+
+
+void save_legacy_file( const char * mount_file , const char * filename , int value ) {
+  block_fs_type * block_fs = block_fs_mount( mount_file , 64 , 0 , 1.0 , 0 , false , false , false );
+  buffer_type * buffer = buffer_alloc( 100 );
+  buffer_fwrite_int( buffer , value );
+  block_fs_fwrite_buffer( block_fs , filename , buffer );
+  buffer_free( buffer );
+  block_fs_close( block_fs , false );
+}
+
+
+void test_driver_value( fs_driver_type * driver , const char * node_key , int report_step , int iens , int value ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  if (report_step < 0) {
+    test_assert_true( driver->has_vector( driver , node_key , iens ));
+    driver->load_vector( driver , node_key , iens , buffer );
+  } else {
+    test_assert_true( driver->has_node( driver , node_key , report_step , iens ));
+    driver->load_node( driver , node_key , report_step , iens , buffer );
+  }
+  test_assert_int_equal( buffer_fread_int( buffer ) , value );
+  buffer_free( buffer );
+}
+
+
+/*
+  The source has nodes stored with integer keys, where the same
+  node_id is a different node key in the two block_fs files, and
+  nodes stored with the old string keys; the old file "A.1.0" is
+  older than the node stored with the integer key. The nodes are
+  copied to three block_fs files, i.e. they are moved around.
+*/
+
+void test_copy_fs() {
+  test_work_area_type * work_area = test_work_area_alloc("enkf_fs/copy_fs");
+  {
+    fs_driver_type * src = open_driver( "src" , 2 , false );
+    save_node( src , "B" , 0 , 0 , 1 );
+    save_node( src , "A" , 1 , 0 , 2 );
+    save_node( src , "A" , 1 , 1 , 3 );
+    save_node( src , "B" , 0 , 1 , 4 );
+    save_node( src , "V" , -1 , 1 , 5 );
+    src->free_driver( src );
+  }
+  save_legacy_file( "src/mod_0/STATIC.mnt" , "C.2.2" , 6 );
+  save_legacy_file( "src/mod_0/STATIC.mnt" , "A.1.0" , 99 );
+  save_legacy_file( "src/mod_1/STATIC.mnt" , "W.3" , 7 );
+  
+  {
+    stringlist_type * src_mount_files    = stringlist_alloc_new();
+    stringlist_type * target_mount_files = stringlist_alloc_new();
+    int i;
+    
+    for (i=0; i < 2; i++)
+      stringlist_append_owned_ref( src_mount_files , util_alloc_sprintf("src/mod_%d/STATIC.mnt" , i));
+
+    for (i=0; i < 3; i++) {
+      char * path = util_alloc_sprintf("target/mod_%d" , i);
+      util_make_path( path );
+      stringlist_append_owned_ref( target_mount_files , util_alloc_sprintf("%s/STATIC.mnt" , path));
+      free( path );
+    }
+    test_assert_int_equal( 7 , block_fs_driver_copy_fs( src_mount_files , target_mount_files , NULL ));
+    stringlist_free( src_mount_files );
+    stringlist_free( target_mount_files );
+  }
+
+  {
+    fs_driver_type * target = open_driver( "target" , 3 , true );
+    test_driver_value( target , "B" , 0 , 0 , 1 );
+    test_driver_value( target , "A" , 1 , 0 , 2 );
+    test_driver_value( target , "A" , 1 , 1 , 3 );
+    test_driver_value( target , "B" , 0 , 1 , 4 );
+    test_driver_value( target , "V" , -1 , 1 , 5 );
+    test_driver_value( target , "C" , 2 , 2 , 6 );
+    test_driver_value( target , "W" , -1 , 3 , 7 );
+    test_assert_false( target->has_node( target , "A" , 1 , 2 ));
+    target->free_driver( target );
+  }
+  
+  /* All the nodes are stored with integer keys in the target. */
+  {
+    block_fs_type * block_fs = block_fs_mount( "target/mod_2/STATIC.mnt" , 64 , 0 , 1.0 , 0 , false , true , false );
+    test_assert_false( block_fs_has_file( block_fs , "C.2.2" ));
+    test_assert_int_equal( 1 , block_fs_get_num_ikeys( block_fs ));
+    block_fs_close( block_fs , false );
+  }
+  test_work_area_free( work_area );
+}
+
+
+
 int main(int argc, char ** argv) {
   test_mount();
   test_refcount();
   test_read_only();
+  test_crash_node_keys();
+  test_copy_fs();
   exit(0);
 }
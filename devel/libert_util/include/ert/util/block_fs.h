@@ -18,6 +18,7 @@
 
 #ifndef __BLOCK_FS__
 #define __BLOCK_FS__
+#include <stdint.h>
 #include <ert/util/buffer.h>
 #include <ert/util/vector.h>
 #include <ert/util/type_macros.h>
@@ -27,6 +28,7 @@ extern "C" {
 #endif
 
   typedef struct block_fs_struct  block_fs_type;
+  typedef struct block_fs_batch_struct block_fs_batch_type;
   typedef struct user_file_node_struct user_file_node_type;
   
   typedef enum {
@@ -57,8 +59,36 @@ extern "C" {
   void            block_fs_sync( block_fs_type * block_fs );
   void            block_fs_unlink_file( block_fs_type * block_fs , const char * filename);
   bool            block_fs_has_file( block_fs_type * block_fs , const char * filename);
+  void            block_fs_fwrite_ikey_buffer(block_fs_type * block_fs , int64_t ikey , const buffer_type * buffer);
+  void            block_fs_fread_ikey_buffer( block_fs_type * block_fs , int64_t ikey , buffer_type * buffer);
+  void            block_fs_unlink_ikey( block_fs_type * block_fs , int64_t ikey);
+  bool            block_fs_has_ikey( block_fs_type * block_fs , int64_t ikey);
+  bool            block_fs_get_max_ikey( block_fs_type * block_fs , int64_t * max_ikey);
+  bool            block_fs_sscanf_ikey( const char * filename , int64_t * ikey );
   vector_type   * block_fs_alloc_filelist( block_fs_type * block_fs  , const char * pattern , block_fs_sort_type sort_mode , bool include_free_nodes );
   void            block_fs_defrag( block_fs_type * block_fs );
+  long int        block_fs_compact( block_fs_type * block_fs , long int max_bytes );
+  void            block_fs_start_compactor( block_fs_type * block_fs , double fragmentation_limit , long int io_budget);
+  void            block_fs_stop_compactor( block_fs_type * block_fs );
+  bool            block_fs_compactor_running( const block_fs_type * block_fs );
+  long int        block_fs_get_data_file_size( block_fs_type * block_fs );
+  long int        block_fs_get_free_size( block_fs_type * block_fs );
+  int             block_fs_get_num_files( block_fs_type * block_fs );
+  int             block_fs_get_num_ikeys( block_fs_type * block_fs );
+  int             block_fs_get_num_free_nodes( block_fs_type * block_fs );
+  long int        block_fs_get_relocated_nodes( block_fs_type * block_fs );
+  long int        block_fs_get_relocated_bytes( block_fs_type * block_fs );
+  long int        block_fs_get_reclaimed_bytes( block_fs_type * block_fs );
+  int             block_fs_get_compact_steps( block_fs_type * block_fs );
+
+  block_fs_batch_type * block_fs_batch_alloc( block_fs_type * block_fs );
+  void                  block_fs_batch_free( block_fs_batch_type * batch );
+  int                   block_fs_batch_get_size( const block_fs_batch_type * batch );
+  void                  block_fs_batch_add_file( block_fs_batch_type * batch , const char * filename , const void * ptr , size_t data_size);
+  void                  block_fs_batch_add_buffer( block_fs_batch_type * batch , const char * filename , const buffer_type * buffer);
+  void                  block_fs_batch_add_ikey_buffer( block_fs_batch_type * batch , int64_t ikey , const buffer_type * buffer);
+  void                  block_fs_batch_add_ikey_buffer_ref( block_fs_batch_type * batch , int64_t ikey , const buffer_type * buffer);
+  void                  block_fs_batch_commit( block_fs_batch_type * batch );
   
   long int        user_file_node_get_node_offset( const user_file_node_type * user_file_node );
   long int        user_file_node_get_data_offset( const user_file_node_type * user_file_node );
@@ -68,6 +98,7 @@ extern "C" {
   const char *    user_file_node_get_filename( const user_file_node_type * user_file_node );
 
 UTIL_IS_INSTANCE_HEADER( block_fs );
+UTIL_IS_INSTANCE_HEADER( block_fs_batch );
 #ifdef __cplusplus
 }
 #endif
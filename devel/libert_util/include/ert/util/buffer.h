@@ -63,6 +63,7 @@ extern "C" {
   int                buffer_fread_int(buffer_type * buffer );
   bool               buffer_fread_bool(buffer_type * buffer);
   long int           buffer_fread_long(buffer_type * buffer);
+  void               buffer_fwrite_long(buffer_type * buffer , long int value);
   void               buffer_fskip_long(buffer_type * buffer);
   void               buffer_store(const buffer_type * buffer , const char * filename);
   size_t             buffer_get_offset(const buffer_type * buffer);
@@ -90,6 +91,7 @@ extern "C" {
   size_t             buffer_stream_fwrite_n( const buffer_type * buffer , size_t offset , ssize_t write_size , FILE * stream );
   void               buffer_stream_fprintf( const buffer_type * buffer , FILE * stream );
   void               buffer_stream_fread( buffer_type * buffer , size_t byte_size , FILE * stream);
+  void             * buffer_fwrite_reserve( buffer_type * buffer , size_t byte_size );
   buffer_type      * buffer_fread_alloc(const char * filename);
   void               buffer_fread_realloc(buffer_type * buffer , const char * filename);
 
@@ -26,6 +26,10 @@
 #include <pthread.h>
 #include <time.h>
 #include <fnmatch.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 #include <ert/util/hash.h>
 #include <ert/util/util.h>
@@ -33,23 +37,63 @@
 #include <ert/util/vector.h>
 #include <ert/util/buffer.h>
 #include <ert/util/long_vector.h>
+#include <ert/util/set.h>
 
 
 #define MOUNT_MAP_MAGIC_INT  8861290
 #define BLOCK_FS_TYPE_ID     7100652
 #define INDEX_MAGIC_INT      1213775
-#define INDEX_FORMAT_VERSION       1
+#define INDEX_FORMAT_VERSION       2
+#define LEGACY_INDEX_FORMAT_VERSION 1    /* Validated with the mtime of the data file; can still be loaded. */
+#define JOURNAL_MAGIC_INT    1213776
+#define JOURNAL_FORMAT_VERSION     1
+
+
+/*
+  The index file is a snapshot of the index, and every later change
+  to the index is appended to the journal file as one record:
+
+     |<record_size: Int><record: record_size bytes><record_size: Int>|
+
+  A record which was only partly written when the application went
+  down has no valid trailing size, and the replay stops there. The
+  records are:
+
+     JOURNAL_NODE_RECORD  : <key: String><node>, the node at node_offset
+                            now has the content node; i.e. it holds the
+                            file key, or it has been freed and key was
+                            unlinked. If key was held by another node
+                            the file has been moved by the compactor,
+                            and the other node is free.
+
+     JOURNAL_BATCH_RECORD : <batch_offset: Long><batch_size: Int>, a
+                            batch has been committed.
+
+     JOURNAL_TRUNCATE_RECORD : <data_file_size: Long>, the free nodes at
+                            the end of the datafile have been removed
+                            by the compactor.
+
+  The node record is written before the data it describes; when
+  mounting all the nodes touched by the journal are verified against
+  the data file. The snapshot and the journal share a journal_id, and
+  when the journal has grown larger than both JOURNAL_COMPACT_SIZE
+  records and the number of files in the index, a new snapshot is
+  written and the journal is restarted.
+*/
+
+#define JOURNAL_NODE_RECORD        1
+#define JOURNAL_BATCH_RECORD       2
+#define JOURNAL_TRUNCATE_RECORD    3
+#define JOURNAL_COMPACT_SIZE   10000
 
 // #define ENABLE_CACHE
 
 
 /*
   During mounting a significant part of the time is spent on filling
-  up the index hash table. By default a hash table is created with a
-  quite small size, and when initializing a large block_fs structure
-  it must be resized many times. By setting a default size with the
-  DEFAULT_INDEX_SIZE variable the hash table will immediately be
-  resized, avoiding some of the automatic calls to hash_resize. 
+  up the index hash table. The node_index table is therefor created
+  with room for DEFAULT_INDEX_SIZE nodes, avoiding some of the
+  automatic resizes.
 
   When the file system is loaded from an index a good size estimate
   can be inferred directly from the index.  
@@ -77,16 +121,45 @@ typedef enum {
   NODE_IN_USE       =  1431655765,    /* NODE_IN_USE_BYTE * ( 1 + 256 + 256**2 + 256**3) => Binary 01010101010101010101010101010101 */
   NODE_FREE         = -1431655766,    /* NODE_FREE_BYTE   * ( 1 + 256 + 256**2 + 256**3) => Binary 10101010101010101010101010101010 */
   NODE_WRITE_ACTIVE =  WRITE_START__, /* This */
+  NODE_BATCH_ACTIVE =  0x5A5AAA55,    /* Header of a batch which is being written; the whole batch is discarded on mount. */
+  NODE_BATCH_COMMIT =  0x5A5A5555,    /* Header of a completely written batch; the nodes in the batch are valid. */
+  NODE_BATCH_MEMBER =  0x5A5A5A5A,    /* A node written as part of a batch; only valid inside a committed batch. */
   NODE_INVALID      = 13              /* This should __never__ be written to disk */
 } node_status_type;
 
 
+/**
+   A batch of files is written as one contiguous region at the end of
+   the datafile. The region starts with a small header:
+
+      |<status: Int><batch_size: Int>|<node 0>|<node 1>|....|<node n-1>|
+
+   where status is NODE_BATCH_ACTIVE while the batch is being written
+   and batch_size is the total size of the region, including the
+   header. When all the nodes have been written and synced the status
+   is replaced with NODE_BATCH_COMMIT in one single aligned write. On
+   mount a region with status NODE_BATCH_ACTIVE is skipped as a whole
+   and converted to a free node, i.e. either all or none of the files
+   in a batch survive a crash. The first byte of both batch status
+   tags is NODE_IN_USE_BYTE, so block_fs_fseek_valid_node() will find
+   them.
+
+   The nodes in the batch are written with status NODE_BATCH_MEMBER
+   instead of NODE_IN_USE. They are only accepted when found inside a
+   committed batch, and block_fs_fseek_valid_node() will not stop at
+   them; so also a batch with a torn header is discarded as a whole.
+*/
+
+#define BATCH_HEADER_SIZE  (2 * sizeof(int))
+
+
 /**
    The free_node_struct is used to implement a doubly linked list of
    free nodes; i.e. holes in the file which are available for other use. 
 */
 typedef struct file_node_struct file_node_type;
 typedef struct free_node_struct free_node_type;
+typedef struct node_index_struct node_index_type;
 
 struct free_node_struct {
   free_node_type * next;
@@ -108,6 +181,7 @@ struct file_node_struct{
   int                node_size;     /* The size in bytes of this node - must be >= data_size. NEVER Changed. */
   int                data_size;     /* The size of the data stored in this node - in addition the node might need to store header information. */
   node_status_type   status;        /* This should be: NODE_IN_USE | NODE_FREE; in addition the disk can have NODE_WRITE_ACTIVE for incomplete writes. */
+  unsigned int       write_seq;     /* Taken from the write_seq of the block_fs instance every time the node is inserted, written or unlinked; used to validate lock free reads. */
 
 #ifdef ENABLE_CACHE
   char             * cache;
@@ -118,8 +192,9 @@ struct file_node_struct{
 
 /**
    data_size   : manipulated in block_fs_fwrite__() and block_fs_insert_free_node().
-   status      : manipulated in block_fs_fwrite__() and block_fs_unlink_file__();
+   status      : manipulated in block_fs_fwrite__() and block_fs_free_node__();
    data_offset : manipulated in block_fs_fwrite__() and block_fs_insert_free_node().
+   write_seq   : manipulated in block_fs_insert_index_node(), block_fs_fwrite__() and block_fs_free_node__().
 */
 
 
@@ -138,6 +213,7 @@ struct block_fs_struct {
   char           * data_file;
   char           * lock_file;
   char           * index_file;
+  char           * journal_file;
   
   int              data_fd;
   FILE           * data_stream;
@@ -147,14 +223,14 @@ struct block_fs_struct {
   int              block_size;      /* The size of blocks in bytes. */
   int              lock_fd;         /* The file descriptor for the lock_file. Set to -1 if we do not have write access. */
   
-  pthread_mutex_t  io_lock;         /* Lock held during fread of the data file. */
-  pthread_rwlock_t rw_lock;         /* Read-write lock during all access to the fs. */
+  pthread_rwlock_t rw_lock;         /* Read-write lock during all access to the index; the data is read without holding any lock. */
   
   int              num_free_nodes;   
-  hash_type      * index;           /* THE HASH table of all the nodes/files which have been stored. */
+  node_index_type * index;          /* THE HASH table of all the nodes/files which have been stored. */
   free_node_type * free_nodes;
   vector_type    * file_nodes;      /* This vector owns all the file_node instances - the index and free_nodes structures
-                                       only contain pointers to the objects stored in this vector. */
+                                       only contain pointers to the objects stored in this vector. After mount the vector
+                                       is sorted on node_offset, and new nodes are always appended at the end of the file. */
   int              write_count;     /* This just counts the number of writes since the file system was mounted. */
   int              max_cache_size;
   size_t           total_cache_size;
@@ -165,11 +241,29 @@ struct block_fs_struct {
   bool             data_owner;
   time_t           index_time;   
   int              fsync_interval;  /* 0: never  n: every nth iteration. */
+  unsigned int     write_seq;       /* Incremented for every update of a file_node; a value is never given to two updates. */
+  int              journal_fd;      /* Append only journal of index updates; -1 when the journal is not written. */
+  long int         journal_id;      /* Shared by the index snapshot and the journal written after it. */
+  int              journal_size;    /* The number of records appended to the journal since the last snapshot. */
+
+  long int         relocated_nodes; /* Compaction metrics since the filesystem was mounted. */
+  long int         relocated_bytes;
+  long int         reclaimed_bytes;
+  int              compact_steps;
+  
+  pthread_t        compactor;
+  pthread_mutex_t  compactor_mutex; /* Protects the compactor_stop flag; the compactor waits on compactor_cond between steps. */
+  pthread_cond_t   compactor_cond;
+  bool             compactor_running;
+  bool             compactor_stop;
+  double           compactor_limit;  /* The compactor is idle while the fragmentation is below this limit. */
+  long int         compactor_budget; /* Maximum number of bytes moved per second by the compactor; <= 0: no limit. */
 };
 
 /*****************************************************************/
 
 static void block_fs_rotate__( block_fs_type * block_fs );
+static bool block_fs_pread( int fd , void * ptr , size_t byte_size , long int offset);
 
 
 
@@ -208,6 +302,7 @@ static file_node_type * file_node_alloc( node_status_type status , long int offs
   file_node->data_size   = 0;
   file_node->data_offset = 0;
   file_node->status      = status; 
+  file_node->write_seq   = 0;
   
 #ifdef ENABLE_CACHE
   file_node->cache      = NULL;
@@ -298,9 +393,9 @@ static file_node_type * file_node_fread_alloc( FILE * stream , char ** key) {
   node_status_type status;
   long int node_offset = ftell( stream );
   if (fread( &status , sizeof status , 1 , stream) == 1) {
-    if ((status == NODE_IN_USE) || (status == NODE_FREE)) {
+    if ((status == NODE_IN_USE) || (status == NODE_FREE) || (status == NODE_BATCH_MEMBER)) {
       int node_size;
-      if (status == NODE_IN_USE) 
+      if (status != NODE_FREE) 
         *key = util_fread_realloc_string( *key , stream );
       else {
         util_safe_free( *key );  /* Explicitly set to NULL for free nodes. */
@@ -318,10 +413,15 @@ static file_node_type * file_node_fread_alloc( FILE * stream , char ** key) {
       */
       
       file_node = file_node_alloc( status , node_offset , node_size );
-      if (status == NODE_IN_USE) {
+      if ((status == NODE_IN_USE) || (status == NODE_BATCH_MEMBER)) {
         file_node->data_size = util_fread_int( stream );
         file_node->data_offset    = ftell( stream ) - file_node->node_offset;
       }
+    } else if ((status == NODE_BATCH_ACTIVE) || (status == NODE_BATCH_COMMIT)) {
+      int batch_size = util_fread_int( stream );
+      if (batch_size <= BATCH_HEADER_SIZE)
+        status = NODE_INVALID;
+      file_node = file_node_alloc( status , node_offset , batch_size );
     } else {
       /* 
          We did not recognize the status identifier; the node will
@@ -424,6 +524,37 @@ static void file_node_dump_index( const file_node_type * file_node , FILE * inde
 }
 
 
+static void file_node_buffer_dump_index( const file_node_type * file_node , buffer_type * buffer) {
+  buffer_fwrite_int( buffer , file_node->status );
+  buffer_fwrite_long( buffer , file_node->node_offset );
+  buffer_fwrite_int( buffer , file_node->node_size );
+  buffer_fwrite_int( buffer , file_node->data_offset );
+  buffer_fwrite_int( buffer , file_node->data_size );
+}
+
+
+static int file_node_offset_cmp( const void * arg1 , const void * arg2 ) {
+  const file_node_type * node1 = arg1;
+  const file_node_type * node2 = arg2;
+  
+  if (node1->node_offset < node2->node_offset)
+    return -1;
+  else if (node1->node_offset > node2->node_offset)
+    return 1;
+  else
+    return 0;
+}
+
+
+/* Sorts in order of decreasing node size. */
+static int file_node_size_rcmp( const void * arg1 , const void * arg2 ) {
+  const file_node_type * node1 = arg1;
+  const file_node_type * node2 = arg2;
+  
+  return node2->node_size - node1->node_size;
+}
+
+
 
 /*
 static file_node_type * file_node_index_fread_alloc( FILE * stream ) {
@@ -483,6 +614,425 @@ static void free_node_free_list( free_node_type * head ) {
 }
 
 
+/*****************************************************************/
+/* node_index functions */
+
+/*
+  The node_index is the in-memory index from filename to file_node. It
+  is a hash table with open addressing and linear probing, the keys
+  and their hash values are stored directly in one array of slots; so
+  a lookup does not chase any pointers before the keys are compared,
+  and inserting a key does not allocate anything except the key
+  copy. The capacity is always a power of two, and the table is
+  resized when it is more than 75% full. Removed keys are marked with
+  a tombstone, which is recycled when inserting.
+
+  Files can also be stored with a 64 bit integer key, see
+  block_fs_fwrite_ikey_buffer(). On disk, i.e. in the node headers,
+  the index file and the journal, an integer key is stored as the
+  filename '#' followed by the key as 16 hex digits. In the node_index
+  the integer keys are stored as integers, so looking up a file with
+  an integer key does not involve any strings at all; a filename on
+  the '#' form is converted to the integer key when the index is
+  accessed with a filename.
+*/
+
+#define NODE_INDEX_MIN_CAPACITY 64
+#define IKEY_PREFIX             '#'
+#define IKEY_LENGTH             17       /* '#' + 16 hex digits. */
+
+typedef struct {
+  char           * key;         /* NULL: empty slot, node_index_tombstone: removed key, node_index_ikey: integer key. */
+  file_node_type * file_node;
+  unsigned int     hash;
+  int64_t          ikey;
+} node_index_slot_type;
+
+
+struct node_index_struct {
+  int                    capacity;
+  int                    size;        /* The number of keys in the index. */
+  int                    num_ikeys;   /* The number of integer keys in the index. */
+  int                    used;        /* The number of keys + the number of tombstones. */
+  node_index_slot_type * slots;
+};
+
+
+static char node_index_tombstone[] = "";
+static char node_index_ikey[]      = "#";
+
+
+/*
+  Writes the filename used for the integer key @ikey on disk into
+  @filename, which must have room for IKEY_LENGTH + 1 characters.
+*/
+
+static void block_fs_ikey_filename( int64_t ikey , char * filename ) {
+  static const char hex_digits[] = "0123456789abcdef";
+  uint64_t value = (uint64_t) ikey;
+  int i;
+  
+  filename[0] = IKEY_PREFIX;
+  for (i = IKEY_LENGTH - 1; i > 0; i--) {
+    filename[i] = hex_digits[ value & 15 ];
+    value >>= 4;
+  }
+  filename[IKEY_LENGTH] = '\0';
+}
+
+
+/**
+   Returns true if @filename is the filename of an integer key, and
+   in that case the key is returned in *@ikey.
+*/
+
+bool block_fs_sscanf_ikey( const char * filename , int64_t * ikey ) {
+  if (filename[0] == IKEY_PREFIX) {
+    uint64_t value = 0;
+    int i;
+    for (i=1; i < IKEY_LENGTH; i++) {
+      char c = filename[i];
+      if ((c >= '0') && (c <= '9'))
+        value = (value << 4) + (c - '0');
+      else if ((c >= 'a') && (c <= 'f'))
+        value = (value << 4) + (c - 'a' + 10);
+      else
+        return false;   /* Also the terminating \0 of a too short filename. */
+    }
+    if (filename[IKEY_LENGTH] == '\0') {
+      *ikey = (int64_t) value;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+static unsigned int node_index_hash_ikey( int64_t ikey ) {
+  /* Fibonacci hashing; the high bits are well mixed. */
+  return (unsigned int) ((((uint64_t) ikey) * 11400714819323198485ull) >> 32);
+}
+
+
+static unsigned int node_index_hash( const char * key ) {
+  /* FNV-1a */
+  unsigned int hash = 2166136261u;
+  while (*key != '\0') {
+    hash ^= (unsigned char) *key;
+    hash *= 16777619u;
+    key++;
+  }
+  return hash;
+}
+
+
+static bool node_index_slot_in_use( const node_index_slot_type * slot ) {
+  return ((slot->key != NULL) && (slot->key != node_index_tombstone));
+}
+
+
+static void node_index_free_key( node_index_slot_type * slot ) {
+  if (slot->key != node_index_ikey)
+    free( slot->key );
+}
+
+
+static int node_index_get_capacity( int size ) {
+  int capacity = NODE_INDEX_MIN_CAPACITY;
+  while (capacity < ((size / 3) * 4 + 4))
+    capacity *= 2;
+  return capacity;
+}
+
+
+static void node_index_alloc_slots( node_index_type * index , int capacity ) {
+  int i;
+  index->slots    = util_calloc( capacity , sizeof * index->slots );
+  index->capacity = capacity;
+  index->used      = 0;
+  index->size      = 0;
+  index->num_ikeys = 0;
+  for (i=0; i < capacity; i++) {
+    index->slots[i].key       = NULL;
+    index->slots[i].file_node = NULL;
+  }
+}
+
+
+static node_index_type * node_index_alloc( int size_hint ) {
+  node_index_type * index = util_malloc( sizeof * index );
+  node_index_alloc_slots( index , node_index_get_capacity( size_hint ));
+  return index;
+}
+
+
+static void node_index_free( node_index_type * index ) {
+  int i;
+  for (i=0; i < index->capacity; i++) 
+    if (node_index_slot_in_use( &index->slots[i] ))
+      node_index_free_key( &index->slots[i] );
+  free( index->slots );
+  free( index );
+}
+
+
+/*
+  Returns the slot where @key is stored, or -1 if the key is not in
+  the index.
+*/
+
+static int node_index_lookup( const node_index_type * index , const char * key , unsigned int hash) {
+  const int mask = index->capacity - 1;
+  int i = hash & mask;
+  while (true) {
+    const node_index_slot_type * slot = &index->slots[i];
+    if (slot->key == NULL)
+      return -1;
+    
+    if ((slot->hash == hash) && (slot->key != node_index_tombstone) && (slot->key != node_index_ikey) && (strcmp( slot->key , key ) == 0))
+      return i;
+    
+    i = (i + 1) & mask;
+  }
+}
+
+
+static int node_index_lookup_ikey( const node_index_type * index , int64_t ikey , unsigned int hash) {
+  const int mask = index->capacity - 1;
+  int i = hash & mask;
+  while (true) {
+    const node_index_slot_type * slot = &index->slots[i];
+    if (slot->key == NULL)
+      return -1;
+    
+    if ((slot->key == node_index_ikey) && (slot->ikey == ikey))
+      return i;
+    
+    i = (i + 1) & mask;
+  }
+}
+
+
+/*
+  Returns the slot of the filename @key, which can be the filename of
+  an integer key.
+*/
+
+static int node_index_lookup_filename( const node_index_type * index , const char * key ) {
+  int64_t ikey;
+  if (block_fs_sscanf_ikey( key , &ikey ))
+    return node_index_lookup_ikey( index , ikey , node_index_hash_ikey( ikey ));
+  else
+    return node_index_lookup( index , key , node_index_hash( key ));
+}
+
+
+/*
+  Returns the first empty slot, or slot with a tombstone, for
+  inserting a key which is not already in the index.
+*/
+
+static int node_index_lookup_free( const node_index_type * index , unsigned int hash) {
+  const int mask = index->capacity - 1;
+  int i = hash & mask;
+  while (node_index_slot_in_use( &index->slots[i] ))
+    i = (i + 1) & mask;
+  return i;
+}
+
+
+/*
+  Moves all the keys over to a new slot array with @capacity slots;
+  the tombstones are dropped in the process.
+*/
+
+static void node_index_rehash( node_index_type * index , int capacity ) {
+  node_index_slot_type * old_slots = index->slots;
+  int old_capacity = index->capacity;
+  int size = index->size;
+  int num_ikeys = index->num_ikeys;
+  int i;
+
+  node_index_alloc_slots( index , capacity );
+  for (i=0; i < old_capacity; i++) {
+    if (node_index_slot_in_use( &old_slots[i] )) {
+      int new_slot = node_index_lookup_free( index , old_slots[i].hash );
+      index->slots[new_slot] = old_slots[i];
+    }
+  }
+  index->size      = size;
+  index->used      = size;
+  index->num_ikeys = num_ikeys;
+  free( old_slots );
+}
+
+
+/*
+  Ensures that the index can hold @size keys without being resized.
+*/
+
+static void node_index_resize( node_index_type * index , int size ) {
+  int capacity = node_index_get_capacity( size );
+  if (capacity > index->capacity)
+    node_index_rehash( index , capacity );
+}
+
+
+static file_node_type * node_index_get( const node_index_type * index , const char * key ) {
+  int slot = node_index_lookup_filename( index , key );
+  if (slot >= 0)
+    return index->slots[slot].file_node;
+  else
+    return NULL;
+}
+
+
+static file_node_type * node_index_get_ikey( const node_index_type * index , int64_t ikey ) {
+  int slot = node_index_lookup_ikey( index , ikey , node_index_hash_ikey( ikey ));
+  if (slot >= 0)
+    return index->slots[slot].file_node;
+  else
+    return NULL;
+}
+
+
+static bool node_index_has_key( const node_index_type * index , const char * key ) {
+  return (node_index_lookup_filename( index , key ) >= 0);
+}
+
+
+static void node_index_insert( node_index_type * index , const char * key , file_node_type * file_node ) {
+  int64_t ikey;
+  bool is_ikey = block_fs_sscanf_ikey( key , &ikey );
+  unsigned int hash;
+  int slot;
+  
+  if (is_ikey) {
+    hash = node_index_hash_ikey( ikey );
+    slot = node_index_lookup_ikey( index , ikey , hash );
+  } else {
+    hash = node_index_hash( key );
+    slot = node_index_lookup( index , key , hash );
+  }
+
+  if (slot >= 0)
+    index->slots[slot].file_node = file_node;
+  else {
+    if ((index->used + 1) * 4 > index->capacity * 3) {
+      /* Full - grow the table, or if most of the used slots are tombstones just clean up. */
+      if ((index->size + 1) * 2 > index->capacity)
+        node_index_rehash( index , index->capacity * 2 );
+      else
+        node_index_rehash( index , index->capacity );
+    }
+    
+    slot = node_index_lookup_free( index , hash );
+    if (index->slots[slot].key == NULL)
+      index->used++;
+    
+    if (is_ikey) {
+      index->slots[slot].key     = node_index_ikey;
+      index->slots[slot].ikey    = ikey;
+      index->num_ikeys++;
+    } else
+      index->slots[slot].key     = util_alloc_string_copy( key );
+    index->slots[slot].hash      = hash;
+    index->slots[slot].file_node = file_node;
+    index->size++;
+  }
+}
+
+
+/*
+  Removes @key from the index, and returns the file_node. Returns NULL
+  if the key is not in the index.
+*/
+
+static file_node_type * node_index_pop( node_index_type * index , const char * key ) {
+  int slot = node_index_lookup_filename( index , key );
+  if (slot >= 0) {
+    file_node_type * file_node = index->slots[slot].file_node;
+    if (index->slots[slot].key == node_index_ikey)
+      index->num_ikeys--;
+    node_index_free_key( &index->slots[slot] );
+    index->slots[slot].key       = node_index_tombstone;
+    index->slots[slot].file_node = NULL;
+    index->size--;
+    return file_node;
+  } else
+    return NULL;
+}
+
+
+static int node_index_get_size( const node_index_type * index ) {
+  return index->size;
+}
+
+
+static int node_index_get_num_ikeys( const node_index_type * index ) {
+  return index->num_ikeys;
+}
+
+
+/*
+  Returns true if the index holds any integer keys, and then the
+  largest of them in *@max_ikey.
+*/
+
+static bool node_index_get_max_ikey( const node_index_type * index , int64_t * max_ikey ) {
+  bool has_ikey = false;
+  int slot;
+  for (slot = 0; slot < index->capacity; slot++) {
+    const node_index_slot_type * index_slot = &index->slots[slot];
+    if (index_slot->key == node_index_ikey) {
+      if (!has_ikey || (index_slot->ikey > *max_ikey))
+        *max_ikey = index_slot->ikey;
+      has_ikey = true;
+    }
+  }
+  return has_ikey;
+}
+
+
+/*
+  Iteration over the keys in the index:
+
+     char key_buffer[IKEY_LENGTH + 1];
+     int slot = node_index_next_slot( index , -1 );
+     while (slot >= 0) {
+        ... node_index_iget_key( index , slot , key_buffer ) ...
+        slot = node_index_next_slot( index , slot );
+     }
+
+  The index must not be modified during the iteration. The filename
+  of an integer key is written into the key_buffer.
+*/
+
+static int node_index_next_slot( const node_index_type * index , int slot ) {
+  for (slot++; slot < index->capacity; slot++)
+    if (node_index_slot_in_use( &index->slots[slot] ))
+      return slot;
+  return -1;
+}
+
+
+static const char * node_index_iget_key( const node_index_type * index , int slot , char * key_buffer ) {
+  const node_index_slot_type * index_slot = &index->slots[slot];
+  if (index_slot->key == node_index_ikey) {
+    block_fs_ikey_filename( index_slot->ikey , key_buffer );
+    return key_buffer;
+  } else
+    return index_slot->key;
+}
+
+
+static file_node_type * node_index_iget_node( const node_index_type * index , int slot ) {
+  return index->slots[slot].file_node;
+}
+
+/* node_index functions - end. */
+
+
 
 /*****************************************************************/
 static inline void block_fs_aquire_wlock( block_fs_type * block_fs ) {
@@ -509,8 +1059,28 @@ static inline void block_fs_aquire_rlock( block_fs_type * block_fs ) {
 
 
 
-static void block_fs_insert_index_node( block_fs_type * block_fs , const char * filename , const file_node_type * file_node) {
-  hash_insert_ref( block_fs->index , filename , file_node);
+static void block_fs_insert_index_node( block_fs_type * block_fs , const char * filename , file_node_type * file_node) {
+  file_node->write_seq = ++block_fs->write_seq;
+  node_index_insert( block_fs->index , filename , file_node);
+}
+
+
+static file_node_type * block_fs_get_node( const block_fs_type * block_fs , const char * filename ) {
+  file_node_type * file_node = node_index_get( block_fs->index , filename );
+  if (file_node == NULL)
+    util_abort("%s: the file:%s does not exist in the filesystem:%s \n",__func__ , filename , block_fs->mount_file);
+  return file_node;
+}
+
+
+static file_node_type * block_fs_get_ikey_node( const block_fs_type * block_fs , int64_t ikey ) {
+  file_node_type * file_node = node_index_get_ikey( block_fs->index , ikey );
+  if (file_node == NULL) {
+    char filename[IKEY_LENGTH + 1];
+    block_fs_ikey_filename( ikey , filename );
+    util_abort("%s: the file:%s does not exist in the filesystem:%s \n",__func__ , filename , block_fs->mount_file);
+  }
+  return file_node;
 }
 
 
@@ -593,6 +1163,34 @@ static void block_fs_insert_free_node( block_fs_type * block_fs , file_node_type
 }
 
 
+/**
+   Recreates the list of free nodes from all the NODE_FREE nodes in
+   the file_nodes vector. The nodes are inserted in order of
+   decreasing size, so every insert is at the head of the list.
+*/
+
+static void block_fs_rebuild_free_list( block_fs_type * block_fs ) {
+  vector_type * free_nodes = vector_alloc_new();
+  int i;
+  
+  free_node_free_list( block_fs->free_nodes );
+  block_fs->free_nodes     = NULL;
+  block_fs->num_free_nodes = 0;
+  block_fs->free_size      = 0;
+  
+  for (i=0; i < vector_get_size( block_fs->file_nodes ); i++) {
+    file_node_type * file_node = vector_iget( block_fs->file_nodes , i );
+    if (file_node->status == NODE_FREE)
+      vector_append_ref( free_nodes , file_node );
+  }
+  vector_sort( free_nodes , file_node_size_rcmp );
+  
+  for (i=0; i < vector_get_size( free_nodes ); i++)
+    block_fs_insert_free_node( block_fs , vector_iget( free_nodes , i ));
+  vector_free( free_nodes );
+}
+
+
 /**
    Installing the new node AND updating file tail. 
 */
@@ -603,18 +1201,46 @@ static void block_fs_install_node(block_fs_type * block_fs , file_node_type * no
 }
 
 
+/**
+   Binary search for the node starting at @node_offset; the
+   file_nodes vector must be sorted in order of increasing offset.
+   Will return NULL if no such node exists.
+*/
+
+static file_node_type * block_fs_lookup_node( const block_fs_type * block_fs , long int node_offset) {
+  int lower = 0;
+  int upper = vector_get_size( block_fs->file_nodes );
+  
+  while (lower < upper) {
+    int middle = (lower + upper) / 2;
+    file_node_type * file_node = vector_iget( block_fs->file_nodes , middle );
+    
+    if (file_node->node_offset == node_offset)
+      return file_node;
+    else if (file_node->node_offset < node_offset)
+      lower = middle + 1;
+    else
+      upper = middle;
+  }
+  return NULL;
+}
+
+
 static void block_fs_set_filenames( block_fs_type * block_fs ) {
   char * data_ext  = util_alloc_sprintf("data_%d" , block_fs->version );
   char * lock_ext  = util_alloc_sprintf("lock_%d" , block_fs->version );
   const char * index_ext = "index";
+  const char * journal_ext = "journal";
 
   util_safe_free( block_fs->data_file );
   util_safe_free( block_fs->lock_file );
   util_safe_free( block_fs->index_file );
+  util_safe_free( block_fs->journal_file );
   
-  block_fs->data_file  = util_alloc_filename( block_fs->path , block_fs->base_name , data_ext);
-  block_fs->lock_file  = util_alloc_filename( block_fs->path , block_fs->base_name , lock_ext);
-  block_fs->index_file = util_alloc_filename( block_fs->path , block_fs->base_name , index_ext);
+  block_fs->data_file    = util_alloc_filename( block_fs->path , block_fs->base_name , data_ext);
+  block_fs->lock_file    = util_alloc_filename( block_fs->path , block_fs->base_name , lock_ext);
+  block_fs->index_file   = util_alloc_filename( block_fs->path , block_fs->base_name , index_ext);
+  block_fs->journal_file = util_alloc_filename( block_fs->path , block_fs->base_name , journal_ext);
 
   free( data_ext );
   free( lock_ext );
@@ -629,7 +1255,7 @@ static void block_fs_set_filenames( block_fs_type * block_fs ) {
 
 
 static void block_fs_reinit( block_fs_type * block_fs ) {
-  block_fs->index               = hash_alloc_unlocked();
+  block_fs->index               = node_index_alloc( DEFAULT_INDEX_SIZE );
   block_fs->file_nodes          = vector_alloc_new();
   block_fs->free_nodes          = NULL;
   block_fs->num_free_nodes      = 0;
@@ -641,6 +1267,19 @@ static void block_fs_reinit( block_fs_type * block_fs ) {
 }
 
 
+/**
+   Discards the complete in-memory index, and leaves the block_fs
+   instance as a freshly allocated one.
+*/
+
+static void block_fs_clear_index( block_fs_type * block_fs ) {
+  free_node_free_list( block_fs->free_nodes );
+  node_index_free( block_fs->index );
+  vector_free( block_fs->file_nodes );
+  block_fs_reinit( block_fs );
+}
+
+
 
 
 static block_fs_type * block_fs_alloc_empty( const char * mount_file ,
@@ -662,7 +1301,6 @@ static block_fs_type * block_fs_alloc_empty( const char * mount_file ,
   
   block_fs->fragmentation_limit = fragmentation_limit;   
   util_alloc_file_components( mount_file , &block_fs->path , &block_fs->base_name, NULL );
-  pthread_mutex_init( &block_fs->io_lock  , NULL);
   pthread_rwlock_init( &block_fs->rw_lock , NULL);
   {
     FILE * stream            = util_fopen( mount_file , "r");
@@ -676,6 +1314,19 @@ static block_fs_type * block_fs_alloc_empty( const char * mount_file ,
   block_fs->data_file   = NULL;
   block_fs->lock_file   = NULL;
   block_fs->index_file  = NULL;
+  block_fs->journal_file = NULL;
+  block_fs->journal_fd   = -1;
+  block_fs->journal_id   = 0;
+  block_fs->journal_size = 0;
+  block_fs->write_seq    = 0;
+  block_fs->relocated_nodes   = 0;
+  block_fs->relocated_bytes   = 0;
+  block_fs->reclaimed_bytes   = 0;
+  block_fs->compact_steps     = 0;
+  block_fs->compactor_running = false;
+  block_fs->compactor_stop    = false;
+  pthread_mutex_init( &block_fs->compactor_mutex , NULL );
+  pthread_cond_init( &block_fs->compactor_cond , NULL );
   block_fs_reinit( block_fs );
 
   if (read_only)
@@ -746,7 +1397,7 @@ static bool block_fs_fseek_valid_node( block_fs_type * block_fs ) {
         */
         fseek__( block_fs->data_stream , -1 , SEEK_CUR);
         if (fread(&status , sizeof status , 1 , block_fs->data_stream) == 1) {
-          if (status == NODE_IN_USE || status == NODE_FREE_BYTE) {
+          if (status == NODE_IN_USE || status == NODE_FREE_BYTE || status == NODE_BATCH_ACTIVE || status == NODE_BATCH_COMMIT) {
             /* 
                OK - we have found a valid identifier. We reposition to
                the start of this valid status id and return true.
@@ -839,10 +1490,11 @@ static void block_fs_update_cache_node( block_fs_type * block_fs, file_node_type
 static void block_fs_preload( block_fs_type * block_fs ) {
   if ((block_fs->max_cache_size > 0) && (block_fs->data_stream != NULL) && (block_fs->max_total_cache_size > 0)) {
     void * buffer = util_malloc( block_fs->max_cache_size );
-    hash_iter_type * index_iter = hash_iter_alloc( block_fs->index );
+    int slot = node_index_next_slot( block_fs->index , -1 );
     
-    while (!hash_iter_is_complete( index_iter )) {
-      file_node_type * node = hash_iter_get_next_value( index_iter );
+    while (slot >= 0) {
+      file_node_type * node = node_index_iget_node( block_fs->index , slot );
+      slot = node_index_next_slot( block_fs->index , slot );
       if ((node->data_size < block_fs->max_cache_size) &&                                         /* Check the size of this node */ 
           (block_fs->total_cache_size + node->data_size < block_fs->max_total_cache_size)) {      /* Check the total cache size */
         block_fs_fseek_node_data(block_fs , node);
@@ -851,7 +1503,6 @@ static void block_fs_preload( block_fs_type * block_fs ) {
       }
     }
     
-    hash_iter_free( index_iter );
     free( buffer );
   }
 }
@@ -863,20 +1514,228 @@ static void block_fs_preload( block_fs_type * block_fs ) { return; }
 
 
 
-/**
-   This function will 'fix' the nodes with offset in offset_list.  The
-   fixing in this case means the following:
+/*****************************************************************/
+/* The index journal - see the documentation of JOURNAL_NODE_RECORD. */
+
+static bool block_fs_write( int fd , const void * ptr , size_t byte_size) {
+  const char * source = ptr;
+  while (byte_size > 0) {
+    ssize_t written_bytes = write( fd , source , byte_size );
+    if (written_bytes > 0) {
+      source    += written_bytes;
+      byte_size -= written_bytes;
+    } else if ((written_bytes < 0) && (errno == EINTR))
+      continue;
+    else
+      return false;
+  }
+  return true;
+}
 
-     1. The node is updated in place on the file to become a free node.
-     2. The node is added to the block_fs instance as a free node, which can
-        be recycled at a later stage.
-   
-   If the instance is not data owner (i.e. read-only) the function
-   will return immediately.
+
+static buffer_type * block_fs_journal_alloc_record( int record_type ) {
+  buffer_type * record = buffer_alloc( 128 );
+  buffer_fwrite_int( record , 0 );   /* The record size is updated in block_fs_journal_fwrite_record(). */
+  buffer_fwrite_int( record , record_type );
+  return record;
+}
+
+
+/*
+  The complete record is written with one write() call to the journal,
+  which has been opened in append mode.
 */
 
+static void block_fs_journal_fwrite_record( block_fs_type * block_fs , buffer_type * record ) {
+  int record_size = buffer_get_size( record ) - sizeof record_size;
+  
+  memcpy( buffer_get_data( record ) , &record_size , sizeof record_size );
+  buffer_fwrite_int( record , record_size );
+  if (!block_fs_write( block_fs->journal_fd , buffer_get_data( record ) , buffer_get_size( record )))
+    util_abort("%s: failed to write to journal:%s - %s \n",__func__ , block_fs->journal_file , strerror( errno ));
+  
+  block_fs->journal_size++;
+  buffer_free( record );
+}
 
-static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * offset_list ) {
+
+static void block_fs_journal_node( block_fs_type * block_fs , const char * filename , const file_node_type * file_node) {
+  if (block_fs->journal_fd >= 0) {
+    buffer_type * record = block_fs_journal_alloc_record( JOURNAL_NODE_RECORD );
+    buffer_fwrite_string( record , filename );
+    file_node_buffer_dump_index( file_node , record );
+    block_fs_journal_fwrite_record( block_fs , record );
+  }
+}
+
+
+static void block_fs_journal_batch( block_fs_type * block_fs , long int batch_offset , int batch_size) {
+  if (block_fs->journal_fd >= 0) {
+    buffer_type * record = block_fs_journal_alloc_record( JOURNAL_BATCH_RECORD );
+    buffer_fwrite_long( record , batch_offset );
+    buffer_fwrite_int( record , batch_size );
+    block_fs_journal_fwrite_record( block_fs , record );
+  }
+}
+
+
+static void block_fs_journal_truncate( block_fs_type * block_fs , long int data_file_size) {
+  if (block_fs->journal_fd >= 0) {
+    buffer_type * record = block_fs_journal_alloc_record( JOURNAL_TRUNCATE_RECORD );
+    buffer_fwrite_long( record , data_file_size );
+    block_fs_journal_fwrite_record( block_fs , record );
+  }
+}
+
+
+static void block_fs_journal_close( block_fs_type * block_fs ) {
+  if (block_fs->journal_fd >= 0) {
+    close( block_fs->journal_fd );
+    block_fs->journal_fd = -1;
+  }
+}
+
+
+/*
+  Appends to an existing journal which has been replayed without
+  finding any records.
+*/
+
+static void block_fs_journal_open( block_fs_type * block_fs ) {
+  if (block_fs->data_owner) {
+    block_fs->journal_fd = open( block_fs->journal_file , O_WRONLY | O_APPEND );
+    if (block_fs->journal_fd == -1)
+      util_abort("%s: failed to open journal:%s - %s \n",__func__ , block_fs->journal_file , strerror( errno ));
+  }
+}
+
+
+/*
+  Creates a new and empty journal with the current journal_id; the
+  journal is written to a temporary file which is renamed in place
+  when the header is on disk.
+*/
+
+static void block_fs_journal_create( block_fs_type * block_fs ) {
+  char * tmp_file = util_alloc_sprintf("%s.tmp" , block_fs->journal_file );
+  int fd = open( tmp_file , O_WRONLY | O_CREAT | O_TRUNC | O_APPEND , S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+  
+  if (fd == -1)
+    util_abort("%s: failed to create journal:%s - %s \n",__func__ , tmp_file , strerror( errno ));
+  {
+    buffer_type * header = buffer_alloc( 64 );
+    buffer_fwrite_int( header , JOURNAL_MAGIC_INT );
+    buffer_fwrite_int( header , JOURNAL_FORMAT_VERSION );
+    buffer_fwrite_int( header , block_fs->version );
+    buffer_fwrite_long( header , block_fs->journal_id );
+    if (!block_fs_write( fd , buffer_get_data( header ) , buffer_get_size( header )))
+      util_abort("%s: failed to write to journal:%s - %s \n",__func__ , tmp_file , strerror( errno ));
+    buffer_free( header );
+  }
+  fsync( fd );
+  if (rename( tmp_file , block_fs->journal_file ) != 0)
+    util_abort("%s: failed to rename %s -> %s - %s \n",__func__ , tmp_file , block_fs->journal_file , strerror( errno ));
+  
+  block_fs_journal_close( block_fs );
+  block_fs->journal_fd   = fd;
+  block_fs->journal_size = 0;
+  free( tmp_file );
+}
+
+
+/**
+   Writes a snapshot of the index to the index file. The snapshot is
+   written to a temporary file which is renamed in place, so the index
+   file on disk is always complete.
+*/
+
+static void block_fs_dump_index( block_fs_type * block_fs ) {
+  char * tmp_file = util_alloc_sprintf("%s.tmp" , block_fs->index_file );
+  FILE * index_stream = util_fopen( tmp_file , "w");
+  
+  util_fwrite_int( INDEX_MAGIC_INT , index_stream );
+  util_fwrite_int( INDEX_FORMAT_VERSION , index_stream );
+  util_fwrite_int( block_fs->version , index_stream );
+  util_fwrite_long( block_fs->journal_id , index_stream );
+  
+  /* 1: Dumping the hash table of active nodes. */
+  {
+    char key_buffer[IKEY_LENGTH + 1];
+    int slot = node_index_next_slot( block_fs->index , -1 );
+    
+    util_fwrite_int( node_index_get_size( block_fs->index ) , index_stream);
+    while (slot >= 0) {
+      const char * key = node_index_iget_key( block_fs->index , slot , key_buffer );
+      const file_node_type * file_node = node_index_iget_node( block_fs->index , slot );
+      
+      util_fwrite_string( key , index_stream);
+      file_node_dump_index( file_node , index_stream );
+      slot = node_index_next_slot( block_fs->index , slot );
+    }
+  }
+  
+  /* 2: Dumping information about empty slots in the datafile. */
+  util_fwrite_int( block_fs->num_free_nodes , index_stream );
+  {
+    free_node_type * current = block_fs->free_nodes;
+    while ( current != NULL) {
+      file_node_dump_index( current->file_node , index_stream );
+      current = current->next;
+    }
+  }
+  
+  fflush( index_stream );
+  fsync( fileno( index_stream ));
+  fclose( index_stream );
+  if (rename( tmp_file , block_fs->index_file ) != 0)
+    util_abort("%s: failed to rename %s -> %s - %s \n",__func__ , tmp_file , block_fs->index_file , strerror( errno ));
+  free( tmp_file );
+}
+
+
+/**
+   Writes a new snapshot of the index and restarts the journal. The
+   data file is synced first, so the snapshot never refers to data
+   which is not on disk. If the application goes down after the new
+   snapshot has been written, but before the new journal is in place,
+   the old journal is recognized by its journal_id when mounting, and
+   ignored.
+*/
+
+static void block_fs_compact_journal( block_fs_type * block_fs ) {
+  if (block_fs->data_owner) {
+    if (block_fs->data_stream != NULL) {
+      fflush( block_fs->data_stream );
+      fsync( block_fs->data_fd );
+    }
+    block_fs->journal_id++;
+    block_fs_dump_index( block_fs );
+    block_fs_journal_create( block_fs );
+  }
+}
+
+
+static void block_fs_maybe_compact_journal( block_fs_type * block_fs ) {
+  if (block_fs->journal_size > util_int_max( JOURNAL_COMPACT_SIZE , node_index_get_size( block_fs->index )))
+    block_fs_compact_journal( block_fs );
+}
+
+
+
+/**
+   This function will 'fix' the nodes with offset in offset_list.  The
+   fixing in this case means the following:
+
+     1. The node is updated in place on the file to become a free node.
+     2. The node is added to the block_fs instance as a free node, which can
+        be recycled at a later stage.
+   
+   If the instance is not data owner (i.e. read-only) the function
+   will return immediately.
+*/
+
+
+static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * offset_list ) {
   if (block_fs->data_owner) { 
     fsync( block_fs->data_fd );
     {
@@ -888,7 +1747,9 @@ static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * of
         block_fs_fseek(block_fs , node_offset);
         file_node = file_node_fread_alloc( block_fs->data_stream , &key );
         
-        if ((file_node->status == NODE_INVALID) || (file_node->status == NODE_WRITE_ACTIVE)) {
+        if ((file_node->status == NODE_INVALID) || 
+            (file_node->status == NODE_WRITE_ACTIVE) || 
+            ((file_node->status == NODE_BATCH_MEMBER) && (block_fs_lookup_free_node( block_fs , node_offset) == NULL))) {
           /* This node is really quite broken. */
           long int node_end;
           block_fs_fseek_valid_node( block_fs );
@@ -919,16 +1780,64 @@ static void block_fs_fix_nodes( block_fs_type * block_fs , long_vector_type * of
 
 
 
-static void block_fs_build_index( block_fs_type * block_fs , long_vector_type * error_offset ) {
+/**
+   A committed batch only frees the nodes it replaces after the commit
+   tag has been written; if the application went down in between the
+   same file will be found both inside and before the batch. The copy
+   in the batch is the newest, the old node is made free; its offset
+   is added to @error_offset so that it is also marked free on disk.
+   The same applies to files found when scanning the tail of the data
+   file which is not covered by the index journal.
+*/
+
+static void block_fs_index_batch_node( block_fs_type * block_fs , const char * filename , long_vector_type * error_offset ) {
+  if (node_index_has_key( block_fs->index , filename )) {
+    file_node_type * old_node = node_index_pop( block_fs->index , filename );
+    
+    old_node->status      = NODE_FREE;
+    old_node->data_size   = 0;
+    old_node->data_offset = 0;
+    block_fs_insert_free_node( block_fs , old_node );
+    long_vector_append( error_offset , old_node->node_offset );
+  }
+}
+
+
+/*
+  Builds the index by scanning the data file from @start_offset to the
+  end; nodes which can not be used are added to @error_offset. When
+  the journal was only partly written the scan can start in the middle
+  of a committed batch, whose header is then not seen; @batch_end is
+  the end of that batch, or zero.
+*/
+
+static void block_fs_build_index( block_fs_type * block_fs , long int start_offset , long int batch_end , long_vector_type * error_offset ) {
   char * filename = NULL;
   file_node_type * file_node;
   
-  hash_resize( block_fs->index , DEFAULT_INDEX_SIZE );
-  block_fs_fseek( block_fs , 0);
+  block_fs_fseek( block_fs , start_offset );
   do {
     file_node = file_node_fread_alloc( block_fs->data_stream , &filename );
     if (file_node != NULL) {
-      if ((file_node->status == NODE_INVALID) || (file_node->status == NODE_WRITE_ACTIVE)) {
+      if (file_node->status == NODE_BATCH_MEMBER) {
+        if (file_node->node_offset < batch_end) 
+          file_node->status = NODE_IN_USE;
+        else
+          file_node->status = NODE_INVALID;   /* Part of a batch which was never committed. */
+      }
+      
+      if (file_node->status == NODE_BATCH_COMMIT) {
+        /* The nodes in the batch are read as ordinary nodes. */
+        batch_end = file_node->node_offset + file_node->node_size;
+        block_fs_fseek( block_fs , file_node->node_offset + BATCH_HEADER_SIZE );
+        file_node_free( file_node );
+      } else if (file_node->status == NODE_BATCH_ACTIVE) {
+        /* The batch was never committed - the whole region is skipped, and made free in block_fs_fix_nodes(). */
+        fprintf(stderr,"** Warning:: file system was prematurely shut down while writing batch in %s/%ld - will be discarded.\n",block_fs->data_file , file_node->node_offset);
+        long_vector_append( error_offset , file_node->node_offset );
+        block_fs_fseek_node_end( block_fs , file_node );
+        file_node_free( file_node );
+      } else if ((file_node->status == NODE_INVALID) || (file_node->status == NODE_WRITE_ACTIVE)) {
         /* Oh fuck */
         if (file_node->status == NODE_INVALID) 
           fprintf(stderr,"** Warning:: invalid node found at offset:%ld in datafile:%s - data will be lost, node_size:%d\n", file_node->node_offset , block_fs->data_file , file_node->node_size);
@@ -944,6 +1853,8 @@ static void block_fs_build_index( block_fs_type * block_fs , long_vector_type *
           block_fs_install_node( block_fs , file_node );
           switch(file_node->status) {
           case(NODE_IN_USE):
+            if ((file_node->node_offset < batch_end) || (start_offset > 0))
+              block_fs_index_batch_node( block_fs , filename , error_offset );
             block_fs_insert_index_node(block_fs , filename , file_node);
             break;
           case(NODE_FREE):
@@ -972,66 +1883,435 @@ static void block_fs_build_index( block_fs_type * block_fs , long_vector_type *
 }
 
 
-/**
-   Load an index for (slightly) faster mounting of the filesystem. The
-   function starts be reading a header and check if the current index
-   file is applicable.
-
-   Will return true of the loading succedeed, and false if no index
-   was loaded.  
+/*
+  Loads the body of an index file: the active nodes are inserted in
+  the index, and the free nodes are only installed; the list of free
+  nodes must be built with block_fs_rebuild_free_list() afterwards.
 */
 
+static void block_fs_fread_index_nodes( block_fs_type * block_fs , buffer_type * buffer ) {
+  /*1: Loading all the active nodes. */
+  {
+    int num_active_nodes = buffer_fread_int( buffer );
+    node_index_resize( block_fs->index , num_active_nodes );
+    
+    for (int i=0; i < num_active_nodes; i++) {
+      const char * filename = buffer_fread_string( buffer );
+      file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
+      block_fs_install_node( block_fs , file_node);
+      block_fs_insert_index_node(block_fs , filename , file_node);
+    }
+  }
+  
+  /*2: Loading all the free nodes. */
+  {
+    int num_free_nodes = buffer_fread_int( buffer );
+    for (int i=0; i < num_free_nodes; i++) {
+      file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
+      block_fs_install_node( block_fs , file_node);
+    }
+  }
+}
+
+
+/*
+  The version 1 index file is only valid if it has the same time stamp
+  as the data file; i.e. if the filesystem was properly closed.
+*/
 
-static bool block_fs_load_index( block_fs_type * block_fs ) {
+static bool block_fs_load_legacy_index( block_fs_type * block_fs , buffer_type * buffer ) {
   struct stat data_stat;
   if (fstat( block_fs->data_fd , &data_stat) == 0) {
-    FILE * stream = fopen( block_fs->index_file , "r");
-    if (stream != NULL) {
-      int    id          = util_fread_int( stream );
-      int    version     = util_fread_int( stream );
-      time_t index_mtime = util_fread_time_t( stream );
-
-      time_t data_mtime  = data_stat.st_mtime;
-      fclose( stream );
-
-      if ((id == INDEX_MAGIC_INT) &&               /* This is indeed an index file. */ 
-          (version == INDEX_FORMAT_VERSION) &&     /* The version on disk agrees with this version. */
-          (index_mtime == data_mtime)) {           /* The time stamp agrees with the time stamp of the data. */
+    time_t index_mtime = buffer_fread_time_t( buffer );
+    time_t data_mtime  = data_stat.st_mtime;
+    
+    if (index_mtime == data_mtime) {     /* The time stamp agrees with the time stamp of the data. */
+      block_fs_fread_index_nodes( block_fs , buffer );
+      block_fs_rebuild_free_list( block_fs );
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+  The nodes in a batch are written with status NODE_BATCH_MEMBER;
+  @batch_start and @batch_end hold the committed batches found in the
+  journal, sorted on offset.
+*/
+
+static bool block_fs_batch_member( long int node_offset , const long_vector_type * batch_start , const long_vector_type * batch_end) {
+  int lower = 0;
+  int upper = long_vector_size( batch_start );
+  
+  while (lower < upper) {
+    int middle = (lower + upper) / 2;
+    if (long_vector_iget( batch_start , middle ) <= node_offset)
+      lower = middle + 1;
+    else
+      upper = middle;
+  }
+  
+  if (lower == 0)
+    return false;
+  else
+    return (node_offset < long_vector_iget( batch_end , lower - 1 ));
+}
+
+
+/*
+  Verifies that the header and the end tag of the node holding
+  @filename have been completely written to the data file.
+*/
+
+static bool block_fs_verify_node( const block_fs_type * block_fs , const char * filename , const file_node_type * file_node , bool batch_member) {
+  bool valid = false;
+  int header_size = file_node_header_size( filename ) - sizeof NODE_END_TAG;
+  
+  if ((file_node->data_offset == header_size) && 
+      (file_node->data_offset + file_node->data_size + sizeof NODE_END_TAG <= file_node->node_size)) {
+    buffer_type * expected = buffer_alloc( header_size );
+    char * header = util_malloc( header_size );
+    int end_tag;
+    
+    buffer_fwrite_int( expected , NODE_IN_USE );
+    buffer_fwrite_string( expected , filename );
+    buffer_fwrite_int( expected , file_node->node_size );
+    buffer_fwrite_int( expected , file_node->data_size );
+    
+    if (block_fs_pread( block_fs->data_fd , header , header_size , file_node->node_offset ) && 
+        block_fs_pread( block_fs->data_fd , &end_tag , sizeof end_tag , file_node->node_offset + file_node->node_size - sizeof end_tag)) {
+      int status;
+      
+      memcpy( &status , header , sizeof status );
+      if ((status == NODE_IN_USE) || (batch_member && (status == NODE_BATCH_MEMBER)))
+        valid = ((end_tag == NODE_END_TAG) && 
+                 (memcmp( &header[sizeof status] , &((char *) buffer_get_data( expected ))[sizeof status] , header_size - sizeof status) == 0));
+    }
+    
+    free( header );
+    buffer_free( expected );
+  }
+  return valid;
+}
+
+
+static bool block_fs_verify_free_node( const block_fs_type * block_fs , const file_node_type * file_node ) {
+  int header[3];
+  int end_tag;
+  
+  if (block_fs_pread( block_fs->data_fd , header , sizeof header , file_node->node_offset ) && 
+      block_fs_pread( block_fs->data_fd , &end_tag , sizeof end_tag , file_node->node_offset + file_node->node_size - sizeof end_tag)) 
+    return ((header[0] == NODE_FREE) && (header[1] == file_node->node_size) && (end_tag == NODE_END_TAG));
+  else
+    return false;
+}
+
+
+/*
+  Applies one node record from the journal. New nodes must be
+  allocated at the end of the datafile, and an existing node can only
+  be taken over from the file it holds. When a file has been moved by
+  the compactor the node it is moved from is made free, and its
+  offset is added to @touched_free. Returns false if the record is not
+  consistent with the current index.
+*/
+
+static bool block_fs_replay_node( block_fs_type * block_fs , const char * filename , const file_node_type * record , long_vector_type * touched_free) {
+  file_node_type * file_node = block_fs_lookup_node( block_fs , record->node_offset );
+  
+  if ((record->status != NODE_IN_USE) && (record->status != NODE_FREE))
+    return false;
+  
+  if (file_node == NULL) {
+    if ((record->node_offset != block_fs->data_file_size) || (record->node_size <= 0))
+      return false;
+    
+    file_node = file_node_alloc( NODE_FREE , record->node_offset , record->node_size );
+    block_fs_install_node( block_fs , file_node );
+  } else {
+    if (file_node->node_size != record->node_size)
+      return false;
+    
+    if (file_node->status == NODE_IN_USE) {
+      if (node_index_get( block_fs->index , filename ) != file_node)
+        return false;
+      node_index_pop( block_fs->index , filename );
+    } else if (record->status == NODE_FREE)
+      return false;
+  }
+  
+  if (record->status == NODE_IN_USE) {
+    if (node_index_has_key( block_fs->index , filename )) {
+      file_node_type * old_node = node_index_pop( block_fs->index , filename );
+      
+      old_node->status      = NODE_FREE;
+      old_node->data_offset = 0;
+      old_node->data_size   = 0;
+      long_vector_append( touched_free , old_node->node_offset );
+    }
+    block_fs_insert_index_node( block_fs , filename , file_node );
+  }
+  
+  file_node->status      = record->status;
+  file_node->data_offset = record->data_offset;
+  file_node->data_size   = record->data_size;
+  return true;
+}
+
+
+/*
+  Removes the nodes from the end of the datafile, they must all be
+  free.
+*/
+
+static bool block_fs_replay_truncate( block_fs_type * block_fs , long int data_file_size ) {
+  if (data_file_size > block_fs->data_file_size)
+    return false;
+  
+  while (vector_get_size( block_fs->file_nodes ) > 0) {
+    file_node_type * file_node = vector_get_last( block_fs->file_nodes );
+    if (file_node->node_offset < data_file_size)
+      break;
+    
+    if (file_node->status != NODE_FREE)
+      return false;
+    file_node_free( vector_pop_back( block_fs->file_nodes ));
+  }
+  
+  if (vector_get_size( block_fs->file_nodes ) > 0) {
+    const file_node_type * file_node = vector_get_last_const( block_fs->file_nodes );
+    if (file_node->node_offset + file_node->node_size > data_file_size)
+      return false;
+  }
+  block_fs->data_file_size = data_file_size;
+  return true;
+}
+
+
+/*
+  Replays the records in @journal on top of the index loaded from the
+  snapshot. A record which was not completely written ends the
+  replay. Afterwards all the nodes touched by the journal are verified
+  against the data file; the nodes which were not completely written
+  are made free, and added to @journal_fix so they can be marked free
+  also on disk.
+
+  The end of the last batch in the journal is returned in
+  @last_batch_end;
+  if the application went down before all the nodes in the batch were
+  journaled the rest of them are found by scanning the data file.
+
+  Returns false if the journal is not consistent with the snapshot.
+*/
+
+static bool block_fs_replay_journal( block_fs_type * block_fs , buffer_type * journal , vector_type * journal_fix , bool * compact_journal , long int * last_batch_end) {
+  set_type * touched_files         = set_alloc_empty( );
+  long_vector_type * touched_free  = long_vector_alloc( 0 , 0 );
+  long_vector_type * batch_start   = long_vector_alloc( 0 , 0 );
+  long_vector_type * batch_end     = long_vector_alloc( 0 , 0 );
+  bool consistent = true;
+  int num_records = 0;
+  
+  vector_sort( block_fs->file_nodes , file_node_offset_cmp );
+  while (consistent) {
+    int record_size;
+    size_t record_start;
+    
+    if (buffer_get_remaining_size( journal ) < sizeof record_size)
+      break;
+    record_size  = buffer_fread_int( journal );
+    record_start = buffer_get_offset( journal );
+    if ((record_size < (int) sizeof(int)) || (buffer_get_remaining_size( journal ) < record_size + sizeof record_size))
+      break;
+    
+    buffer_fseek( journal , record_start + record_size , SEEK_SET );
+    if (buffer_fread_int( journal ) != record_size)
+      break;    /* The record was not completely written. */
+    
+    buffer_fseek( journal , record_start , SEEK_SET );
+    {
+      int record_type = buffer_fread_int( journal );
+      if (record_type == JOURNAL_NODE_RECORD) {
+        const char * filename  = buffer_fread_string( journal );
+        file_node_type * record = file_node_index_buffer_fread_alloc( journal );
         
-        /* Read the whole index file in one single read operation. */
-        buffer_type * buffer = buffer_fread_alloc( block_fs->index_file );
+        consistent = block_fs_replay_node( block_fs , filename , record , touched_free );
+        if (record->status == NODE_IN_USE)
+          set_add_key( touched_files , filename );
+        else
+          long_vector_append( touched_free , record->node_offset );
+        file_node_free( record );
+      } else if (record_type == JOURNAL_BATCH_RECORD) {
+        long int batch_offset = buffer_fread_long( journal );
+        int batch_size        = buffer_fread_int( journal );
         
-        buffer_fskip( buffer , sizeof( time_t ) + 2 * sizeof( int ));
-        /*1: Loading all the active nodes. */
-        {
-          int num_active_nodes = buffer_fread_int( buffer );
-          hash_resize( block_fs->index , num_active_nodes * 2 + 64);
-          
-          for (int i=0; i < num_active_nodes; i++) {
-            const char * filename = buffer_fread_string( buffer );
-            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
-            block_fs_install_node( block_fs , file_node);
-            block_fs_insert_index_node(block_fs , filename , file_node);
+        if (batch_offset == block_fs->data_file_size) {
+          long_vector_append( batch_start , batch_offset );
+          long_vector_append( batch_end , batch_offset + batch_size );
+          block_fs->data_file_size = batch_offset + BATCH_HEADER_SIZE;
+        } else
+          consistent = false;
+      } else if (record_type == JOURNAL_TRUNCATE_RECORD) {
+        long int data_file_size = buffer_fread_long( journal );
+        consistent = block_fs_replay_truncate( block_fs , data_file_size );
+      } else
+        consistent = false;
+    }
+    buffer_fseek( journal , record_start + record_size + sizeof record_size , SEEK_SET );
+    num_records++;
+  }
+  
+  /* Records have been replayed, or there is a broken record at the end which must not be appended to. */
+  if ((num_records > 0) || (buffer_get_remaining_size( journal ) > 0))
+    *compact_journal = true;
+  
+  if (consistent) {
+    if (long_vector_size( touched_free ) > 0)
+      long_vector_select_unique( touched_free );
+    for (int i=0; i < long_vector_size( touched_free ); i++) {
+      file_node_type * file_node = block_fs_lookup_node( block_fs , long_vector_iget( touched_free , i ));
+      if ((file_node != NULL) && (file_node->status == NODE_FREE) && !block_fs_verify_free_node( block_fs , file_node ))
+        vector_append_ref( journal_fix , file_node );
+    }
+    
+    {
+      set_iter_type * iter = set_iter_alloc( touched_files );
+      while (!set_iter_is_complete( iter )) {
+        const char * filename = set_iter_get_next_key( iter );
+        file_node_type * file_node = node_index_get( block_fs->index , filename );
+        
+        if (file_node != NULL) {
+          bool batch_member = block_fs_batch_member( file_node->node_offset , batch_start , batch_end );
+          if (!block_fs_verify_node( block_fs , filename , file_node , batch_member )) {
+            fprintf(stderr,"** Warning: file system was prematurely shut down while writing node:%s in %s/%ld - will be discarded.\n",filename , block_fs->data_file , file_node->node_offset);
+            node_index_pop( block_fs->index , filename );
+            file_node->status      = NODE_FREE;
+            file_node->data_offset = 0;
+            file_node->data_size   = 0;
+            vector_append_ref( journal_fix , file_node );
           }
         }
-        
-        /*2: Loading all the free nodes. */
-        {
-          int num_free_nodes = buffer_fread_int( buffer );
-          for (int i=0; i < num_free_nodes; i++) {
-            file_node_type * file_node = file_node_index_buffer_fread_alloc( buffer );
-            block_fs_install_node( block_fs , file_node);
-            block_fs_insert_free_node(block_fs , file_node);
+      }
+      set_iter_free( iter );
+    }
+    block_fs_rebuild_free_list( block_fs );
+  }
+  
+  if (long_vector_size( batch_end ) > 0)
+    *last_batch_end = long_vector_get_last( batch_end );
+  long_vector_free( batch_end );
+  long_vector_free( batch_start );
+  long_vector_free( touched_free );
+  set_free( touched_files );
+  return consistent;
+}
+
+
+/*
+  Loads the index snapshot and replays the journal written after it.
+  If the application went down after a new snapshot was written, but
+  before the journal was restarted, the journal has the previous
+  journal_id; it is then already contained in the snapshot.
+*/
+
+static bool block_fs_load_journaled_index( block_fs_type * block_fs , buffer_type * index_buffer , vector_type * journal_fix , bool * compact_journal , long int * last_batch_end) {
+  bool loaded = false;
+  
+  if ((buffer_get_remaining_size( index_buffer ) >= sizeof(int) + sizeof(long)) && util_file_exists( block_fs->journal_file )) {
+    int data_version     = buffer_fread_int( index_buffer );
+    long int journal_id  = buffer_fread_long( index_buffer );
+    buffer_type * journal = buffer_fread_alloc( block_fs->journal_file );
+    
+    if ((data_version == block_fs->version) && (buffer_get_remaining_size( journal ) >= 3 * sizeof(int) + sizeof(long))) {
+      int id                       = buffer_fread_int( journal );
+      int version                  = buffer_fread_int( journal );
+      int journal_data_version     = buffer_fread_int( journal );
+      long int journal_journal_id  = buffer_fread_long( journal );
+      
+      if ((id == JOURNAL_MAGIC_INT) && (version == JOURNAL_FORMAT_VERSION) && (journal_data_version == data_version)) {
+        if ((journal_journal_id == journal_id) || (journal_journal_id == journal_id - 1)) {
+          block_fs->journal_id = journal_id;
+          block_fs_fread_index_nodes( block_fs , index_buffer );
+          if (journal_journal_id == journal_id) {
+            loaded = block_fs_replay_journal( block_fs , journal , journal_fix , compact_journal , last_batch_end );
+            if (!loaded)
+              block_fs_clear_index( block_fs );
+          } else {
+            block_fs_rebuild_free_list( block_fs );
+            loaded = true;
           }
         }
-        buffer_free( buffer );
-        
-        return true;
       }
-    } 
+    }
+    buffer_free( journal );
+  }
+  return loaded;
+}
+
+
+/**
+   Load an index for faster mounting of the filesystem. The function
+   starts be reading a header and check if the current index file is
+   applicable. Files written to the end of the data file after the
+   index, i.e. which are not found in the journal, are indexed by
+   scanning the tail of the data file.
+
+   Will return true of the loading succedeed, and false if no index
+   was loaded. The @compact_journal flag is set to false if the index
+   file and journal can be used further as they are.
+*/
+
+static bool block_fs_load_index( block_fs_type * block_fs , long_vector_type * error_offset , vector_type * journal_fix , bool * compact_journal) {
+  bool loaded = false;
+  long int last_batch_end = 0;
+  
+  *compact_journal = true;
+  if (util_file_exists( block_fs->index_file )) {
+    buffer_type * buffer = buffer_fread_alloc( block_fs->index_file );
+    
+    if (buffer_get_remaining_size( buffer ) >= 2 * sizeof(int)) {
+      int id      = buffer_fread_int( buffer );
+      int version = buffer_fread_int( buffer );
+      
+      if (id == INDEX_MAGIC_INT) {                 /* This is indeed an index file. */ 
+        if (version == INDEX_FORMAT_VERSION) {
+          *compact_journal = false;
+          loaded = block_fs_load_journaled_index( block_fs , buffer , journal_fix , compact_journal , &last_batch_end );
+        } else if (version == LEGACY_INDEX_FORMAT_VERSION)
+          loaded = block_fs_load_legacy_index( block_fs , buffer );
+      }
+    }
+    buffer_free( buffer );
+  }
+  
+  if (loaded) {
+    struct stat data_stat;
+    if ((fstat( block_fs->data_fd , &data_stat) == 0) && (data_stat.st_size > block_fs->data_file_size)) {
+      block_fs_build_index( block_fs , block_fs->data_file_size , last_batch_end , error_offset );
+      *compact_journal = true;
+    }
+  } else
+    *compact_journal = true;
+  
+  return loaded;
+}
+
+
+/**
+   Marks the nodes which were found incomplete when replaying the
+   journal as free nodes on disk.
+*/
+
+static void block_fs_fix_journal_nodes( block_fs_type * block_fs , const vector_type * journal_fix ) {
+  if (block_fs->data_owner && (vector_get_size( journal_fix ) > 0)) {
+    for (int i=0; i < vector_get_size( journal_fix ); i++) 
+      file_node_fwrite( vector_iget_const( journal_fix , i ) , NULL , block_fs->data_stream );
+    
+    fflush( block_fs->data_stream );
+    fsync( block_fs->data_fd );
   }
-  /** No index was loaded - for whatever reason. */
-  return false;
 }
 
 
@@ -1068,18 +2348,28 @@ block_fs_type * block_fs_mount( const char * mount_file ,
       block_fs_fwrite_mount_info__( mount_file , 0 );
     {
       long_vector_type * fix_nodes = long_vector_alloc(0 , 0);
+      vector_type * journal_fix    = vector_alloc_new();
+      bool compact_journal         = true;
       block_fs = block_fs_alloc_empty( mount_file , block_size , max_cache_size , fragmentation_limit , fsync_interval , read_only, block_level_lock);
       /* We build up the index & free_nodes_list based on the header/index information embedded in the datafile. */
       block_fs_open_data( block_fs , false );
       if (block_fs->data_stream != NULL) {
-        if (!block_fs_load_index( block_fs ))
-          block_fs_build_index( block_fs , fix_nodes );
+        if (!block_fs_load_index( block_fs , fix_nodes , journal_fix , &compact_journal ))
+          block_fs_build_index( block_fs , 0 , 0 , fix_nodes );
 
         fclose(block_fs->data_stream);
       }
       
       block_fs_open_data( block_fs , block_fs->data_owner ); /* The data_stream is opened for reading AND writing (IFF we are data_owner - otherwise it is still read only) */
+      block_fs_fix_journal_nodes( block_fs , journal_fix );
       block_fs_fix_nodes( block_fs , fix_nodes );  
+      vector_sort( block_fs->file_nodes , file_node_offset_cmp );
+      if (compact_journal)
+        block_fs_compact_journal( block_fs );
+      else
+        block_fs_journal_open( block_fs );
+      
+      vector_free( journal_fix );
       long_vector_free( fix_nodes );
     }
   }
@@ -1109,6 +2399,19 @@ static void block_fs_unlink_free_node( block_fs_type * block_fs , free_node_type
 
 
 
+/**
+   Rounds @min_size up to a whole number of blocks.
+*/
+
+static int block_fs_alloc_node_size( const block_fs_type * block_fs , size_t min_size ) {
+  div_t d       = div( min_size , block_fs->block_size );
+  int node_size = d.quot * block_fs->block_size;
+  if (d.rem)
+    node_size += block_fs->block_size;
+  return node_size;
+}
+
+
 /**
    This function first checks the free nodes if any of them can be
    used, otherwise a new node is created.
@@ -1139,15 +2442,8 @@ static file_node_type * block_fs_get_new_node( block_fs_type * block_fs , const
     /* No usable nodes in the free nodes list - must allocate a brand new one. */
 
     long int offset;
-    int node_size;
+    int node_size = block_fs_alloc_node_size( block_fs , min_size );
     file_node_type * new_node;
-    
-    {
-      div_t d   = div( min_size , block_fs->block_size );
-      node_size = d.quot * block_fs->block_size;
-      if (d.rem)
-        node_size += block_fs->block_size;
-    }
 
     /* Must lock the total size here ... */
     offset = block_fs->data_file_size;
@@ -1163,7 +2459,7 @@ static file_node_type * block_fs_get_new_node( block_fs_type * block_fs , const
 
 
 bool block_fs_has_file__( const block_fs_type * block_fs , const char * filename) {
-  return hash_has_key( block_fs->index , filename );
+  return node_index_has_key( block_fs->index , filename );
 }
 
 
@@ -1179,274 +2475,1117 @@ bool block_fs_has_file( block_fs_type * block_fs , const char * filename) {
 }
 
 
+bool block_fs_has_ikey( block_fs_type * block_fs , int64_t ikey) {
+  bool has_file;
+  block_fs_aquire_rlock( block_fs );
+  {
+    has_file = (node_index_get_ikey( block_fs->index , ikey ) != NULL);
+  }
+  block_fs_release_rwlock( block_fs );
+  return has_file;
+}
+
+
+/**
+   Returns true if any files are stored with an integer key, and then
+   the largest integer key in *@max_ikey.
+*/
+
+bool block_fs_get_max_ikey( block_fs_type * block_fs , int64_t * max_ikey) {
+  bool has_ikey;
+  block_fs_aquire_rlock( block_fs );
+  {
+    has_ikey = node_index_get_max_ikey( block_fs->index , max_ikey );
+  }
+  block_fs_release_rwlock( block_fs );
+  return has_ikey;
+}
+
+
+
+
+/**
+   Marks @node as free, both in memory and on disk. With @sync == true
+   the on disk update is sandwiched between two fsync() calls. The
+   node must already have been removed from the index, @filename is
+   the file it held; or NULL if the node has already been recorded
+   as free in the journal.
+*/
+
+static void block_fs_free_node__( block_fs_type * block_fs , const char * filename , file_node_type * node , bool sync) {
+  block_fs_clear_cache_node( block_fs , node );
+
+  node->status      = NODE_FREE;
+  node->data_offset = 0;
+  node->data_size   = 0;
+  node->write_seq   = ++block_fs->write_seq;
+  if (filename != NULL)
+    block_fs_journal_node( block_fs , filename , node );
+  if (block_fs->data_stream != NULL) {  
+    if (sync)
+      fsync( block_fs->data_fd );
+    block_fs_fseek(block_fs , node->node_offset);
+    file_node_fwrite( node , NULL , block_fs->data_stream );
+    if (sync)
+      fsync( block_fs->data_fd );
+  }
+  block_fs_insert_free_node( block_fs , node );
+}
+
+
+static void block_fs_unlink_file__( block_fs_type * block_fs , const char * filename ) {
+  file_node_type * node = node_index_pop( block_fs->index , filename );
+  block_fs_free_node__( block_fs , filename , node , true );
+}
+
+/**
+   Returns the fraction of unused space in the block_fs instance. 
+*/
+double block_fs_get_fragmentation( const block_fs_type * block_fs ) {
+  return block_fs->free_size * 1.0 / block_fs->data_file_size;
+}
+
+
+void block_fs_unlink_file( block_fs_type * block_fs , const char * filename) {
+  block_fs_aquire_wlock( block_fs );
+
+  block_fs_unlink_file__( block_fs , filename );
+  if (block_fs_get_fragmentation( block_fs ) > block_fs->fragmentation_limit) 
+    block_fs_rotate__( block_fs );
+  else
+    block_fs_maybe_compact_journal( block_fs );
+  
+  block_fs_release_rwlock( block_fs );
+}
+
+
+void block_fs_unlink_ikey( block_fs_type * block_fs , int64_t ikey) {
+  char filename[IKEY_LENGTH + 1];
+  block_fs_ikey_filename( ikey , filename );
+  block_fs_unlink_file( block_fs , filename );
+}
+
+
+/**
+   This function can be used to initiate explicit rotate of the file
+   system, observe the following.
+
+   1. This function is called with an explicit fragmentation_limit
+   which might differ from the fragmentation limit held by the
+   filesystem
+
+   2. This function will take the write lock, it is therefor
+   essential that this function is NOT called by another function
+   which has already taken the write lock (i.e. the
+   block_fs_unlink_file() or block_fs_fwrite_file() functions),
+   that will deadlock.
+
+   The return value is whether a rotation actually has taken place.
+*/
+
+bool block_fs_rotate( block_fs_type * block_fs , double fragmentation_limit) {
+  if (block_fs_get_fragmentation( block_fs ) > fragmentation_limit) {
+    block_fs_aquire_wlock( block_fs );
+    block_fs_rotate__( block_fs );
+    block_fs_release_rwlock( block_fs );
+    return true;
+  } else
+    return false;
+}
+
+    
+/* 
+   It seems it is not enough to call fsync(); must also issue this
+   funny fseek + ftell combination to ensure that all data is on
+   disk after an uncontrolled shutdown.
+
+   Could possibly use fdatasync() to improve speed slightly?
+*/
+
+static void block_fs_fsync__( block_fs_type * block_fs ) {
+  if (block_fs->data_owner) {
+    long pos;
+    //fdatasync( block_fs->data_fd );
+    if (block_fs->journal_fd >= 0)
+      fsync( block_fs->journal_fd );
+    fsync( block_fs->data_fd );
+    block_fs_fseek( block_fs , block_fs->data_file_size );
+    pos = ftell( block_fs->data_stream ); 
+  }
+}
+
+
+/**
+   Syncs the data written so far to disk; the write lock is taken, so
+   the data stream is not moved under a concurrent writer.
+*/
+
+void block_fs_fsync( block_fs_type * block_fs ) {
+  if (block_fs->data_owner) {
+    block_fs_aquire_wlock( block_fs );
+    block_fs_fsync__( block_fs );
+    block_fs_release_rwlock( block_fs );
+  }
+}
+
+
+
+
+/**
+   Writes the data and the header of @node to the datafile; the
+   status, data_size and data_offset fields of the node must already
+   have been updated.
+*/
+
+static void block_fs_fwrite_node__(block_fs_type * block_fs , const char * filename , const file_node_type * node , const void * ptr , int data_size) {
+  /* This marks the node section in the datafile as write in progress with: NODE_WRITE_ACTIVE_START ... NODE_WRITE_ACTIVE_END */
+  file_node_init_fwrite( node , block_fs->data_stream );                
+  
+  /* Writes the actual data content. */
+  block_fs_fseek_node_data(block_fs , node);
+  util_fwrite( ptr , 1 , data_size , block_fs->data_stream , __func__);
+  
+  /* Writes the file node header data, including the NODE_END_TAG. */
+  file_node_fwrite( node , filename , block_fs->data_stream );
+  
+  /* The readers use pread() on the file descriptor, and will not see data still in the stream buffer. */
+  fflush( block_fs->data_stream );
+}
+
+
+/**
+   The single lowest-level write function:
+   
+   3. seek to correct position.
+   4. Write the data with util_fwrite()
+
+   7. increase the write_count
+   8. set the data_size field of the node.
+
+   Observe that when 'designing' this file-system the priority has
+   been on read-spead, one consequence of this is that all write
+   operations are sandwiched between two fsync() calls; that
+   guarantees that the read access (which should be the fast path) can
+   be without any calls to fsync().
+
+   Not necessary to lock - since all writes are protected by the
+   'global' rwlock anyway.
+*/
+
+
+static void block_fs_fwrite__(block_fs_type * block_fs , const char * filename , file_node_type * node , const void * ptr , int data_size) {
+
+#ifdef ENABLE_CACHE
+  if ((node->cache_size == data_size) && (memcmp( ptr , node->cache , data_size ) == 0)) 
+    /* The current cache is identical to the data we are attempting to write - can leave immediately. */
+    return;
+#else 
+  if (false) 
+    return;
+#endif
+
+  else {
+    block_fs_fseek(block_fs , node->node_offset);
+    node->status      = NODE_IN_USE;
+    node->data_size   = data_size; 
+    node->write_seq   = ++block_fs->write_seq;
+    file_node_set_data_offset( node , filename );
+    
+    /* The journal record is written before the data; the node is verified when the journal is replayed. */
+    block_fs_journal_node( block_fs , filename , node );
+    block_fs_fwrite_node__( block_fs , filename , node , ptr , data_size );
+
+    block_fs_update_cache_node( block_fs , node , data_size , ptr);
+    block_fs->write_count++;
+    if (block_fs->fsync_interval && ((block_fs->write_count % block_fs->fsync_interval) == 0)) 
+      block_fs_fsync__( block_fs );
+    
+  }
+}
+
+
+
+static void block_fs_fwrite_file_unlocked(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
+  file_node_type * file_node;
+  bool   new_node = true;   
+  size_t min_size = data_size + file_node_header_size( filename );
+  
+  if (block_fs_has_file__( block_fs , filename )) {
+    file_node = node_index_get( block_fs->index , filename );
+    if (file_node->node_size < min_size) {
+      /* 
+         The current node is too small for the new content:
+         
+         1. Remove the existing node, from the index and insert it
+         into the free_nodes list.
+
+         2. Get a new node.
+        
+      */
+      block_fs_unlink_file__( block_fs , filename );
+      file_node = block_fs_get_new_node( block_fs , filename , min_size );
+    } else
+      new_node = false;  /* We are reusing the existing node. */
+  } else 
+    file_node = block_fs_get_new_node( block_fs , filename , min_size );
+  
+  
+  /* The actual writing ... */
+  block_fs_fwrite__( block_fs , filename , file_node , ptr , data_size);
+  if (new_node)
+    block_fs_insert_index_node(block_fs , filename , file_node);
+}
+
+
+
+void block_fs_fwrite_file(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
+  block_fs_aquire_wlock( block_fs );
+  {
+    block_fs_fwrite_file_unlocked( block_fs , filename , ptr , data_size );
+    
+    /* OKAY - this is going to take some time ... */
+    if ((block_fs->free_size * 1.0 / block_fs->data_file_size) > block_fs->fragmentation_limit)
+      block_fs_rotate__( block_fs );
+    else
+      block_fs_maybe_compact_journal( block_fs );
+
+  }
+  block_fs_release_rwlock( block_fs );
+}
+
+
+void block_fs_defrag( block_fs_type * block_fs ) {
+  block_fs_aquire_wlock( block_fs );
+  block_fs_rotate__( block_fs );
+  block_fs_release_rwlock( block_fs );
+}
+
+
+void block_fs_fwrite_buffer(block_fs_type * block_fs , const char * filename , const buffer_type * buffer) {
+  block_fs_fwrite_file( block_fs , filename , buffer_get_data( buffer ) , buffer_get_size( buffer ));
+}
+
+
+/*
+  The _ikey functions store and access files with an integer key
+  instead of a filename; the lookups go directly to the integer part
+  of the index without formatting or hashing any strings. The files
+  are listed by block_fs_alloc_filelist() with a filename which can be
+  converted back to the integer key with block_fs_sscanf_ikey().
+*/
+
+void block_fs_fwrite_ikey_buffer(block_fs_type * block_fs , int64_t ikey , const buffer_type * buffer) {
+  char filename[IKEY_LENGTH + 1];
+  block_fs_ikey_filename( ikey , filename );
+  block_fs_fwrite_buffer( block_fs , filename , buffer );
+}
+
+
+/*****************************************************************/
+/* Online compaction */
+
+/*
+  The compactor makes the datafile shorter while the filesystem is in
+  use. The files at the end of the datafile are moved into free nodes
+  earlier in the file, and then the free nodes at the end of the
+  datafile are truncated away. This is done in small steps with
+  block_fs_compact(), each holding the write lock while moving at most
+  max_bytes of data; readers which are reading a file while it is
+  moved will retry, see block_fs_fread__().
+
+  The free nodes are never split or merged, so the compaction stops
+  when the last file in the datafile does not fit in any of the free
+  nodes in front of it.
+
+  The compactor can run in a background thread, see
+  block_fs_start_compactor().
+*/
+
+#define COMPACTOR_STEP_SIZE  (1024 * 1024)   /* Maximum number of bytes moved by the background compactor while holding the write lock. */
+#define COMPACTOR_POLL_TIME  1.0             /* Seconds between fragmentation checks when the background compactor is idle. */
+
+
+/*
+  Reads the key of the file held by @file_node from the node header in
+  the datafile. Returns NULL if the header does not agree with the
+  index.
+*/
+
+static char * block_fs_alloc_node_key( const block_fs_type * block_fs , const file_node_type * file_node ) {
+  char * key = NULL;
+  int header_size = file_node->data_offset;
+  int key_length  = header_size - (file_node_header_size( "" ) - sizeof NODE_END_TAG);
+  
+  if (key_length > 0) {
+    char * header = util_malloc( header_size );
+    if (block_fs_pread( block_fs->data_fd , header , header_size , file_node->node_offset )) {
+      int status;
+      int length;
+      
+      memcpy( &status , header , sizeof status );
+      memcpy( &length , &header[ sizeof status ] , sizeof length );
+      if (((status == NODE_IN_USE) || (status == NODE_BATCH_MEMBER)) && (length == key_length) && (header[ 2 * sizeof(int) + key_length ] == '\0')) {
+        key = util_alloc_string_copy( &header[ 2 * sizeof(int) ] );
+        if (node_index_get( block_fs->index , key ) != file_node) {
+          free( key );
+          key = NULL;
+        }
+      }
+    }
+    free( header );
+  }
+  return key;
+}
+
+
+/*
+  Moves the file held by @file_node into the smallest free node in
+  front of it which is large enough. The data is written to the new
+  node before the move is recorded in the journal, so if the
+  application goes down during the move the file is found in the old
+  node. Returns false if no free node could be used.
+*/
+
+static bool block_fs_relocate_node( block_fs_type * block_fs , file_node_type * file_node , buffer_type * buffer ) {
+  bool relocated = false;
+  char * filename = block_fs_alloc_node_key( block_fs , file_node );
+  
+  if (filename != NULL) {
+    size_t min_size = file_node->data_size + file_node_header_size( filename );
+    free_node_type * free_node = block_fs->free_nodes;
+    
+    while ((free_node != NULL) && ((free_node->file_node->node_size < min_size) || (free_node->file_node->node_offset > file_node->node_offset))) 
+      free_node = free_node->next;
+    
+    if (free_node != NULL) {
+      file_node_type * new_node = free_node->file_node;
+      int data_size = file_node->data_size;
+      void * data;
+      
+      buffer_clear( buffer );
+      data = buffer_fwrite_reserve( buffer , data_size );
+      if (!block_fs_pread( block_fs->data_fd , data , data_size , file_node->node_offset + file_node->data_offset ))
+        util_abort("%s: failed to read:%s from data file:%s - %s \n",__func__ , filename , block_fs->data_file , strerror( errno ));
+      
+      block_fs_unlink_free_node( block_fs , free_node );
+      new_node->status    = NODE_IN_USE;
+      new_node->data_size = data_size;
+      file_node_set_data_offset( new_node , filename );
+      block_fs_fwrite_node__( block_fs , filename , new_node , data , data_size );
+      block_fs_journal_node( block_fs , filename , new_node );
+      
+      node_index_pop( block_fs->index , filename );
+      block_fs_insert_index_node( block_fs , filename , new_node );
+      block_fs_free_node__( block_fs , NULL , file_node , false );
+      
+      block_fs->relocated_nodes++;
+      block_fs->relocated_bytes += data_size;
+      relocated = true;
+    }
+    free( filename );
+  }
+  return relocated;
+}
+
+
+/*
+  Removes the free nodes at the end of the datafile. The moved files,
+  and the free headers of the nodes they were moved from, are synced
+  to disk before the datafile is truncated.
+*/
+
+static void block_fs_truncate_free_tail( block_fs_type * block_fs ) {
+  int num_nodes = vector_get_size( block_fs->file_nodes );
+  long int data_file_size = block_fs->data_file_size;
+  
+  while (num_nodes > 0) {
+    const file_node_type * file_node = vector_iget_const( block_fs->file_nodes , num_nodes - 1 );
+    if (file_node->status != NODE_FREE)
+      break;
+    data_file_size = file_node->node_offset;
+    num_nodes--;
+  }
+  
+  if (data_file_size < block_fs->data_file_size) {
+    fflush( block_fs->data_stream );
+    fsync( block_fs->data_fd );
+    block_fs_journal_truncate( block_fs , data_file_size );
+    if (block_fs->journal_fd >= 0)
+      fsync( block_fs->journal_fd );   /* The truncation must be in the journal before the nodes are gone. */
+    if (ftruncate( block_fs->data_fd , data_file_size ) != 0)
+      util_abort("%s: failed to truncate data file:%s - %s \n",__func__ , block_fs->data_file , strerror( errno ));
+    
+    {
+      free_node_type * current = block_fs->free_nodes;
+      while (current != NULL) {
+        free_node_type * next = current->next;
+        if (current->file_node->node_offset >= data_file_size)
+          block_fs_unlink_free_node( block_fs , current );
+        current = next;
+      }
+    }
+    
+    /* The readers do not hold on to the nodes while the lock is released, see block_fs_fread__(). */
+    while (vector_get_size( block_fs->file_nodes ) > num_nodes) 
+      file_node_free( vector_pop_back( block_fs->file_nodes ));
+    
+    block_fs->reclaimed_bytes += block_fs->data_file_size - data_file_size;
+    block_fs->data_file_size   = data_file_size;
+  }
+}
+
+
+/**
+   Runs one compaction step: files are moved from the end of the
+   datafile into free nodes earlier in the file until @max_bytes of
+   data have been moved, or the last file can not be moved. Then the
+   free space at the end of the datafile is truncated. Observe that
+   this function takes the write lock.
+
+   Returns the number of bytes moved.
+*/
+
+long int block_fs_compact( block_fs_type * block_fs , long int max_bytes ) {
+  long int moved_bytes = 0;
+  
+  if (block_fs->data_owner) {
+    buffer_type * buffer = buffer_alloc( 1024 );
+    block_fs_aquire_wlock( block_fs );
+    {
+      int inode = vector_get_size( block_fs->file_nodes ) - 1;
+      while ((inode >= 0) && (moved_bytes < max_bytes)) {
+        file_node_type * file_node = vector_iget( block_fs->file_nodes , inode );
+        if (file_node->status == NODE_IN_USE) {
+          int data_size = file_node->data_size;
+          if (!block_fs_relocate_node( block_fs , file_node , buffer ))
+            break;
+          moved_bytes += data_size;
+        }
+        inode--;
+      }
+      block_fs_truncate_free_tail( block_fs );
+      block_fs->compact_steps++;
+      block_fs_maybe_compact_journal( block_fs );
+    }
+    block_fs_release_rwlock( block_fs );
+    buffer_free( buffer );
+  }
+  return moved_bytes;
+}
+
+
+static void * block_fs_compactor_main( void * arg ) {
+  block_fs_type * block_fs = arg;
+  bool stop = false;
+  
+  while (!stop) {
+    double wait_time = COMPACTOR_POLL_TIME;
+    double fragmentation;
+    
+    block_fs_aquire_rlock( block_fs );
+    fragmentation = block_fs_get_fragmentation( block_fs );
+    block_fs_release_rwlock( block_fs );
+    
+    if (fragmentation > block_fs->compactor_limit) {
+      long int moved_bytes = block_fs_compact( block_fs , COMPACTOR_STEP_SIZE );
+      if (moved_bytes > 0) {
+        if (block_fs->compactor_budget > 0)
+          wait_time = 1.0 * moved_bytes / block_fs->compactor_budget;
+        else
+          wait_time = 0;
+      }
+    }
+    
+    pthread_mutex_lock( &block_fs->compactor_mutex );
+    if (!block_fs->compactor_stop && (wait_time > 0)) {
+      struct timespec deadline;
+      long int nsec;
+      
+      clock_gettime( CLOCK_REALTIME , &deadline );
+      nsec = deadline.tv_nsec + (long int) ((wait_time - (long int) wait_time) * 1e9);
+      deadline.tv_sec  += (long int) wait_time + nsec / 1000000000;
+      deadline.tv_nsec  = nsec % 1000000000;
+      pthread_cond_timedwait( &block_fs->compactor_cond , &block_fs->compactor_mutex , &deadline );
+    }
+    stop = block_fs->compactor_stop;
+    pthread_mutex_unlock( &block_fs->compactor_mutex );
+  }
+  return NULL;
+}
+
+
+/**
+   Starts a background thread which compacts the datafile whenever the
+   fragmentation is above @fragmentation_limit. The thread moves at
+   most @io_budget bytes per second; with @io_budget <= 0 there is no
+   limit. The compactor is stopped with block_fs_stop_compactor(), or
+   when the filesystem is closed.
+
+   The compactor is only started if this instance owns the datafile.
+*/
+
+void block_fs_start_compactor( block_fs_type * block_fs , double fragmentation_limit , long int io_budget) {
+  if (block_fs->data_owner && !block_fs->compactor_running) {
+    block_fs->compactor_limit  = fragmentation_limit;
+    block_fs->compactor_budget = io_budget;
+    block_fs->compactor_stop   = false;
+    if (pthread_create( &block_fs->compactor , NULL , block_fs_compactor_main , block_fs ) != 0)
+      util_abort("%s: failed to start compactor thread - %s \n",__func__ , strerror( errno ));
+    block_fs->compactor_running = true;
+  }
+}
+
+
+void block_fs_stop_compactor( block_fs_type * block_fs ) {
+  if (block_fs->compactor_running) {
+    pthread_mutex_lock( &block_fs->compactor_mutex );
+    block_fs->compactor_stop = true;
+    pthread_cond_signal( &block_fs->compactor_cond );
+    pthread_mutex_unlock( &block_fs->compactor_mutex );
+    
+    pthread_join( block_fs->compactor , NULL );
+    block_fs->compactor_running = false;
+  }
+}
+
+
+bool block_fs_compactor_running( const block_fs_type * block_fs ) {
+  return block_fs->compactor_running;
+}
+
+
+/*
+  Fragmentation and compaction metrics; the compaction metrics count
+  from when the filesystem was mounted.
+*/
+
+long int block_fs_get_data_file_size( block_fs_type * block_fs ) {
+  long int data_file_size;
+  block_fs_aquire_rlock( block_fs );
+  data_file_size = block_fs->data_file_size;
+  block_fs_release_rwlock( block_fs );
+  return data_file_size;
+}
+
+
+long int block_fs_get_free_size( block_fs_type * block_fs ) {
+  long int free_size;
+  block_fs_aquire_rlock( block_fs );
+  free_size = block_fs->free_size;
+  block_fs_release_rwlock( block_fs );
+  return free_size;
+}
+
+
+int block_fs_get_num_files( block_fs_type * block_fs ) {
+  int num_files;
+  block_fs_aquire_rlock( block_fs );
+  num_files = node_index_get_size( block_fs->index );
+  block_fs_release_rwlock( block_fs );
+  return num_files;
+}
+
+
+/*
+  The number of files stored with an integer key, i.e. with
+  block_fs_fwrite_ikey_buffer().
+*/
+
+int block_fs_get_num_ikeys( block_fs_type * block_fs ) {
+  int num_ikeys;
+  block_fs_aquire_rlock( block_fs );
+  num_ikeys = node_index_get_num_ikeys( block_fs->index );
+  block_fs_release_rwlock( block_fs );
+  return num_ikeys;
+}
+
+
+int block_fs_get_num_free_nodes( block_fs_type * block_fs ) {
+  int num_free_nodes;
+  block_fs_aquire_rlock( block_fs );
+  num_free_nodes = block_fs->num_free_nodes;
+  block_fs_release_rwlock( block_fs );
+  return num_free_nodes;
+}
+
+
+long int block_fs_get_relocated_nodes( block_fs_type * block_fs ) {
+  long int relocated_nodes;
+  block_fs_aquire_rlock( block_fs );
+  relocated_nodes = block_fs->relocated_nodes;
+  block_fs_release_rwlock( block_fs );
+  return relocated_nodes;
+}
+
+
+long int block_fs_get_relocated_bytes( block_fs_type * block_fs ) {
+  long int relocated_bytes;
+  block_fs_aquire_rlock( block_fs );
+  relocated_bytes = block_fs->relocated_bytes;
+  block_fs_release_rwlock( block_fs );
+  return relocated_bytes;
+}
+
+
+long int block_fs_get_reclaimed_bytes( block_fs_type * block_fs ) {
+  long int reclaimed_bytes;
+  block_fs_aquire_rlock( block_fs );
+  reclaimed_bytes = block_fs->reclaimed_bytes;
+  block_fs_release_rwlock( block_fs );
+  return reclaimed_bytes;
+}
+
+
+int block_fs_get_compact_steps( block_fs_type * block_fs ) {
+  int compact_steps;
+  block_fs_aquire_rlock( block_fs );
+  compact_steps = block_fs->compact_steps;
+  block_fs_release_rwlock( block_fs );
+  return compact_steps;
+}
+
+
+/*****************************************************************/
+/* Batched writes */
+
+/*
+  A block_fs_batch instance collects the content of many files in
+  memory, and writes them all to the datafile in one go with
+  block_fs_batch_commit(). The files are written contiguously at the
+  end of the datafile with pwritev(), and the batch is committed with
+  a single tag write - see the documentation of BATCH_HEADER_SIZE.
+
+  The files in a batch are not visible to readers of the block_fs
+  instance before the batch has been committed. Each thread should
+  use its own batch instance.
+*/
+
+#define BLOCK_FS_BATCH_TYPE_ID  7100653
+
+typedef struct {
+  char       * filename;
+  const void * data;
+  void       * data_copy;    /* Owned copy of the data; NULL when the data is only referenced. */
+  int          data_size;
+} batch_node_type;
+
+
+struct block_fs_batch_struct {
+  UTIL_TYPE_ID_DECLARATION;
+  block_fs_type * block_fs;
+  hash_type     * index;        /* filename -> position in the nodes vector. */
+  vector_type   * nodes;        /* The batch_node instances; in the order they will be written. */
+};
+
+
+static batch_node_type * batch_node_alloc( const char * filename , const void * ptr , int data_size , bool copy_data) {
+  batch_node_type * batch_node = util_malloc( sizeof * batch_node );
+  batch_node->filename  = util_alloc_string_copy( filename );
+  batch_node->data_copy = copy_data ? util_alloc_copy( ptr , data_size ) : NULL;
+  batch_node->data      = copy_data ? batch_node->data_copy : ptr;
+  batch_node->data_size = data_size;
+  return batch_node;
+}
+
+
+static void batch_node_free( batch_node_type * batch_node ) {
+  free( batch_node->filename );
+  util_safe_free( batch_node->data_copy );
+  free( batch_node );
+}
+
+
+static void batch_node_free__( void * batch_node ) {
+  batch_node_free( (batch_node_type *) batch_node );
+}
+
 
+UTIL_IS_INSTANCE_FUNCTION(block_fs_batch , BLOCK_FS_BATCH_TYPE_ID);
 
-static void block_fs_unlink_file__( block_fs_type * block_fs , const char * filename ) {
-  file_node_type * node = hash_pop( block_fs->index , filename );
-  block_fs_clear_cache_node( block_fs , node );
 
-  node->status      = NODE_FREE;
-  node->data_offset = 0;
-  node->data_size   = 0;
-  if (block_fs->data_stream != NULL) {  
-    fsync( block_fs->data_fd );
-    block_fs_fseek(block_fs , node->node_offset);
-    file_node_fwrite( node , NULL , block_fs->data_stream );
-    fsync( block_fs->data_fd );
-  }
-  block_fs_insert_free_node( block_fs , node );
+block_fs_batch_type * block_fs_batch_alloc( block_fs_type * block_fs ) {
+  block_fs_batch_type * batch = util_malloc( sizeof * batch );
+  UTIL_TYPE_ID_INIT( batch , BLOCK_FS_BATCH_TYPE_ID );
+  batch->block_fs = block_fs;
+  batch->index    = hash_alloc_unlocked();
+  batch->nodes    = vector_alloc_new();
+  return batch;
 }
 
+
 /**
-   Returns the fraction of unused space in the block_fs instance. 
+   Files which have been added to the batch, but not committed, are
+   discarded.
 */
-double block_fs_get_fragmentation( const block_fs_type * block_fs ) {
-  return block_fs->free_size * 1.0 / block_fs->data_file_size;
-}
 
+void block_fs_batch_free( block_fs_batch_type * batch ) {
+  hash_free( batch->index );
+  vector_free( batch->nodes );
+  free( batch );
+}
 
-void block_fs_unlink_file( block_fs_type * block_fs , const char * filename) {
-  block_fs_aquire_wlock( block_fs );
 
-  block_fs_unlink_file__( block_fs , filename );
-  if (block_fs_get_fragmentation( block_fs ) > block_fs->fragmentation_limit) 
-    block_fs_rotate__( block_fs );
-  
-  block_fs_release_rwlock( block_fs );
+int block_fs_batch_get_size( const block_fs_batch_type * batch ) {
+  return vector_get_size( batch->nodes );
 }
 
 
-/**
-   This function can be used to initiate explicit rotate of the file
-   system, observe the following.
+static void block_fs_batch_clear( block_fs_batch_type * batch ) {
+  hash_clear( batch->index );
+  vector_clear( batch->nodes );
+}
 
-   1. This function is called with an explicit fragmentation_limit
-   which might differ from the fragmentation limit held by the
-   filesystem
 
-   2. This function will take the write lock, it is therefor
-   essential that this function is NOT called by another function
-   which has already taken the write lock (i.e. the
-   block_fs_unlink_file() or block_fs_fwrite_file() functions),
-   that will deadlock.
+static void block_fs_batch_add_node( block_fs_batch_type * batch , const char * filename , const void * ptr , size_t data_size , bool copy_data) {
+  batch_node_type * batch_node = batch_node_alloc( filename , ptr , data_size , copy_data );
+  if (hash_has_key( batch->index , filename ))
+    vector_iset_owned_ref( batch->nodes , hash_get_int( batch->index , filename ) , batch_node , batch_node_free__ );
+  else {
+    hash_insert_int( batch->index , filename , vector_get_size( batch->nodes ));
+    vector_append_owned_ref( batch->nodes , batch_node , batch_node_free__ );
+  }
+}
 
-   The return value is whether a rotation actually has taken place.
+
+/**
+   The data is copied into the batch; if the same filename is added
+   several times the last content wins.
 */
 
-bool block_fs_rotate( block_fs_type * block_fs , double fragmentation_limit) {
-  if (block_fs_get_fragmentation( block_fs ) > fragmentation_limit) {
-    block_fs_aquire_wlock( block_fs );
-    block_fs_rotate__( block_fs );
-    block_fs_release_rwlock( block_fs );
-    return true;
-  } else
-    return false;
+void block_fs_batch_add_file( block_fs_batch_type * batch , const char * filename , const void * ptr , size_t data_size) {
+  block_fs_batch_add_node( batch , filename , ptr , data_size , true );
 }
 
-    
-/* 
-   It seems it is not enough to call fsync(); must also issue this
-   funny fseek + ftell combination to ensure that all data is on
-   disk after an uncontrolled shutdown.
-
-   Could possibly use fdatasync() to improve speed slightly?
-*/
 
-void block_fs_fsync( block_fs_type * block_fs ) {
-  if (block_fs->data_owner) {
-    long pos;
-    //fdatasync( block_fs->data_fd );
-    fsync( block_fs->data_fd );
-    block_fs_fseek( block_fs , block_fs->data_file_size );
-    pos = ftell( block_fs->data_stream ); 
-  }
+void block_fs_batch_add_buffer( block_fs_batch_type * batch , const char * filename , const buffer_type * buffer) {
+  block_fs_batch_add_file( batch , filename , buffer_get_data( buffer ) , buffer_get_size( buffer ));
 }
 
 
+void block_fs_batch_add_ikey_buffer( block_fs_batch_type * batch , int64_t ikey , const buffer_type * buffer) {
+  char filename[IKEY_LENGTH + 1];
+  block_fs_ikey_filename( ikey , filename );
+  block_fs_batch_add_buffer( batch , filename , buffer );
+}
 
 
 /**
-   The single lowest-level write function:
-   
-   3. seek to correct position.
-   4. Write the data with util_fwrite()
+   As block_fs_batch_add_ikey_buffer(), but the content of the buffer
+   is not copied; the buffer must be kept alive, and unmodified, until
+   the batch has been committed or freed.
+*/
 
-   7. increase the write_count
-   8. set the data_size field of the node.
+void block_fs_batch_add_ikey_buffer_ref( block_fs_batch_type * batch , int64_t ikey , const buffer_type * buffer) {
+  char filename[IKEY_LENGTH + 1];
+  block_fs_ikey_filename( ikey , filename );
+  block_fs_batch_add_node( batch , filename , buffer_get_data( buffer ) , buffer_get_size( buffer ) , false );
+}
 
-   Observe that when 'designing' this file-system the priority has
-   been on read-spead, one consequence of this is that all write
-   operations are sandwiched between two fsync() calls; that
-   guarantees that the read access (which should be the fast path) can
-   be without any calls to fsync().
 
-   Not necessary to lock - since all writes are protected by the
-   'global' rwlock anyway.
+/*
+  Positional vectored write of all the @iovcnt vectors in @iov,
+  starting at @offset; at most IOV_MAX vectors are written in one
+  call. The iov array is modified when short writes occur. All the
+  vectors must have iov_len > 0.
 */
 
+static bool block_fs_pwritev( int fd , struct iovec * iov , int iovcnt , long int offset) {
+  while (iovcnt > 0) {
+    ssize_t written = pwritev( fd , iov , util_int_min( iovcnt , IOV_MAX ) , offset );
+    if (written > 0) {
+      offset += written;
+      while ((iovcnt > 0) && ((size_t) written >= iov->iov_len)) {
+        written -= iov->iov_len;
+        iov++;
+        iovcnt--;
+      }
+      if (written > 0) {
+        iov->iov_base = (char *) iov->iov_base + written;
+        iov->iov_len -= written;
+      }
+    } else if ((written < 0) && (errno == EINTR))
+      continue;
+    else
+      return false;
+  }
+  return true;
+}
 
-static void block_fs_fwrite__(block_fs_type * block_fs , const char * filename , file_node_type * node , const void * ptr , int data_size) {
 
-#ifdef ENABLE_CACHE
-  if ((node->cache_size == data_size) && (memcmp( ptr , node->cache , data_size ) == 0)) 
-    /* The current cache is identical to the data we are attempting to write - can leave immediately. */
-    return;
-#else 
-  if (false) 
-    return;
-#endif
+/**
+   Writes all the files in the batch to the datafile, and installs
+   them in the index; afterwards the batch is empty and can be reused.
+   The commit goes like this:
 
-  else {
-    block_fs_fseek(block_fs , node->node_offset);
-    node->status      = NODE_IN_USE;
-    node->data_size   = data_size; 
-    file_node_set_data_offset( node , filename );
-    
-    /* This marks the node section in the datafile as write in progress with: NODE_WRITE_ACTIVE_START ... NODE_WRITE_ACTIVE_END */
-    file_node_init_fwrite( node , block_fs->data_stream );                
-    
-    /* Writes the actual data content. */
-    block_fs_fseek_node_data(block_fs , node);
-    util_fwrite( ptr , 1 , data_size , block_fs->data_stream , __func__);
-    
-    /* Writes the file node header data, including the NODE_END_TAG. */
-    file_node_fwrite( node , filename , block_fs->data_stream );
+     1. Space for all the files is allocated contiguously at the end
+        of the datafile; the free list is not used.
 
-    block_fs_update_cache_node( block_fs , node , data_size , ptr);
-    block_fs->write_count++;
-    if (block_fs->fsync_interval && ((block_fs->write_count % block_fs->fsync_interval) == 0)) 
-      block_fs_fsync( block_fs );
-    
-  }
-}
+     2. The batch header, with status NODE_BATCH_ACTIVE, and the
+        complete nodes - header, data and NODE_END_TAG - are written
+        with pwritev() and synced to disk.
 
+     3. The batch status is changed to NODE_BATCH_COMMIT, and synced
+        to disk.
 
+     4. The new nodes are installed in the index, and the nodes they
+        replace are marked as free. These updates are not synced to
+        disk; a crash at this point is repaired when mounting.
 
-static void block_fs_fwrite_file_unlocked(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
-  file_node_type * file_node;
-  bool   new_node = true;   
-  size_t min_size = data_size + file_node_header_size( filename );
-  
-  if (block_fs_has_file__( block_fs , filename )) {
-    file_node = hash_get( block_fs->index , filename );
-    if (file_node->node_size < min_size) {
-      /* 
-         The current node is too small for the new content:
-         
-         1. Remove the existing node, from the index and insert it
-         into the free_nodes list.
+   The files written in one batch are hence either all, or none,
+   present after a crash.
+*/
 
-         2. Get a new node.
-        
-      */
-      block_fs_unlink_file__( block_fs , filename );
-      file_node = block_fs_get_new_node( block_fs , filename , min_size );
-    } else
-      new_node = false;  /* We are reusing the existing node. */
-  } else 
-    file_node = block_fs_get_new_node( block_fs , filename , min_size );
-  
+void block_fs_batch_commit( block_fs_batch_type * batch ) {
+  block_fs_type * block_fs = batch->block_fs;
+  const int num_nodes      = vector_get_size( batch->nodes );
+  if (num_nodes == 0)
+    return;
   
-  /* The actual writing ... */
-  block_fs_fwrite__( block_fs , filename , file_node , ptr , data_size);
-  if (new_node)
-    block_fs_insert_index_node(block_fs , filename , file_node);
-}
+  block_fs_aquire_wlock( block_fs );
+  {
+    const long int batch_offset = block_fs->data_file_size;
+    long int offset             = batch_offset + BATCH_HEADER_SIZE;
+    file_node_type ** file_nodes = util_calloc( num_nodes , sizeof * file_nodes );
+    size_t * head_offset         = util_calloc( num_nodes + 1 , sizeof * head_offset );
+    size_t * tail_offset         = util_calloc( num_nodes , sizeof * tail_offset );
+    struct iovec * iov           = util_calloc( 3 * num_nodes + 1 , sizeof * iov );
+    buffer_type * meta           = buffer_alloc( num_nodes * 64 + BATCH_HEADER_SIZE );
+    char * padding               = util_malloc( block_fs->block_size );
+    int iovcnt                   = 0;
+    int i;
+
+    memset( padding , 0 , block_fs->block_size );
+    
+    /* 1: Allocating the nodes, and assembling the node headers and tails in the meta buffer. */
+    buffer_fwrite_int( meta , NODE_BATCH_ACTIVE );
+    buffer_fwrite_int( meta , 0 );   /* The batch size is updated below. */
+    for (i=0; i < num_nodes; i++) {
+      const batch_node_type * batch_node = vector_iget_const( batch->nodes , i );
+      size_t min_size = batch_node->data_size + file_node_header_size( batch_node->filename );
+      file_node_type * node = file_node_alloc( NODE_IN_USE , offset , block_fs_alloc_node_size( block_fs , min_size ));
+      
+      node->data_size = batch_node->data_size;
+      file_node_set_data_offset( node , batch_node->filename );
+      
+      head_offset[i] = buffer_get_size( meta );
+      buffer_fwrite_int( meta , NODE_BATCH_MEMBER );
+      buffer_fwrite_string( meta , batch_node->filename );
+      buffer_fwrite_int( meta , node->node_size );
+      buffer_fwrite_int( meta , node->data_size );
+      
+      tail_offset[i] = buffer_get_size( meta );
+      buffer_fwrite( meta , padding , 1 , node->node_size - node->data_offset - node->data_size - sizeof NODE_END_TAG );
+      buffer_fwrite_int( meta , NODE_END_TAG );
+      
+      offset += node->node_size;
+      file_nodes[i] = node;
+    }
+    head_offset[num_nodes] = buffer_get_size( meta );
 
+    if ((offset - batch_offset) > INT_MAX)
+      util_abort("%s: batch of %d files is too large - must be committed in smaller batches \n",__func__ , num_nodes);
+    {
+      int  batch_size = offset - batch_offset;
+      char * meta_data = buffer_get_data( meta );
+      
+      memcpy( &meta_data[ sizeof(int) ] , &batch_size , sizeof batch_size );
+      iov[iovcnt].iov_base = meta_data;
+      iov[iovcnt].iov_len  = BATCH_HEADER_SIZE;
+      iovcnt++;
+      for (i=0; i < num_nodes; i++) {
+        const batch_node_type * batch_node = vector_iget_const( batch->nodes , i );
+
+        iov[iovcnt].iov_base = &meta_data[ head_offset[i] ];
+        iov[iovcnt].iov_len  = tail_offset[i] - head_offset[i];
+        iovcnt++;
+
+        if (batch_node->data_size > 0) {
+          iov[iovcnt].iov_base = (void *) batch_node->data;
+          iov[iovcnt].iov_len  = batch_node->data_size;
+          iovcnt++;
+        }
 
+        iov[iovcnt].iov_base = &meta_data[ tail_offset[i] ];
+        iov[iovcnt].iov_len  = head_offset[i + 1] - tail_offset[i];
+        iovcnt++;
+      }
+    }
+    
+    /* 2: Writing the whole batch, and syncing it to disk. */
+    fflush( block_fs->data_stream );
+    if (!block_fs_pwritev( block_fs->data_fd , iov , iovcnt , batch_offset ))
+      util_abort("%s: failed to write batch to:%s - %s \n",__func__ , block_fs->data_file , strerror( errno ));
+    fsync( block_fs->data_fd );
 
-void block_fs_fwrite_file(block_fs_type * block_fs , const char * filename , const void * ptr , size_t data_size) {
-  block_fs_aquire_wlock( block_fs );
-  {
-    block_fs_fwrite_file_unlocked( block_fs , filename , ptr , data_size );
+    /* 3: Committing the batch. */
+    {
+      int commit_tag = NODE_BATCH_COMMIT;
+      struct iovec commit_iov = { .iov_base = &commit_tag , .iov_len = sizeof commit_tag };
+      if (!block_fs_pwritev( block_fs->data_fd , &commit_iov , 1 , batch_offset ))
+        util_abort("%s: failed to commit batch to:%s - %s \n",__func__ , block_fs->data_file , strerror( errno ));
+      fsync( block_fs->data_fd );
+    }
+    
+    /* 4: Installing the new nodes, and freeing the nodes they replace. */
+    block_fs_journal_batch( block_fs , batch_offset , offset - batch_offset );
+    for (i=0; i < num_nodes; i++) {
+      const batch_node_type * batch_node = vector_iget_const( batch->nodes , i );
+      file_node_type * node = file_nodes[i];
+      
+      if (node_index_has_key( block_fs->index , batch_node->filename )) {
+        file_node_type * old_node = node_index_pop( block_fs->index , batch_node->filename );
+        block_fs_free_node__( block_fs , batch_node->filename , old_node , false );
+      }
+      block_fs_install_node( block_fs , node );
+      block_fs_insert_index_node( block_fs , batch_node->filename , node );
+      block_fs_journal_node( block_fs , batch_node->filename , node );
+      block_fs_update_cache_node( block_fs , node , batch_node->data_size , batch_node->data );
+    }
+    fflush( block_fs->data_stream );
+    block_fs->write_count += num_nodes;
     
-    /* OKAY - this is going to take some time ... */
     if ((block_fs->free_size * 1.0 / block_fs->data_file_size) > block_fs->fragmentation_limit)
       block_fs_rotate__( block_fs );
-
+    else
+      block_fs_maybe_compact_journal( block_fs );
+
+    free( padding );
+    buffer_free( meta );
+    free( iov );
+    free( tail_offset );
+    free( head_offset );
+    free( file_nodes );
   }
   block_fs_release_rwlock( block_fs );
+  block_fs_batch_clear( batch );
 }
 
 
-void block_fs_defrag( block_fs_type * block_fs ) {
-  block_fs_aquire_wlock( block_fs );
-  block_fs_rotate__( block_fs );
-  block_fs_release_rwlock( block_fs );
-}
-
-
-void block_fs_fwrite_buffer(block_fs_type * block_fs , const char * filename , const buffer_type * buffer) {
-  block_fs_fwrite_file( block_fs , filename , buffer_get_data( buffer ) , buffer_get_size( buffer ));
-}
-
-
-/**
-   Need extra locking here - because the global rwlock allows many
-   concurrent readers.
+/*
+  Positional read of @byte_size bytes from @fd starting at @offset;
+  pread() does not use the file position, so any number of threads
+  can read from the same file descriptor concurrently.
 */
-static void block_fs_fread__(block_fs_type * block_fs , const file_node_type * file_node , void * ptr , size_t read_bytes) {
-
-#ifdef ENABLE_CACHE  
-  if (file_node->cache != NULL) 
-    file_node_read_from_cache( file_node , ptr , read_bytes);
-  else
-#else
-    if (true) 
-#endif
 
-  {
-    pthread_mutex_lock( &block_fs->io_lock );
-    block_fs_fseek_node_data( block_fs , file_node );
-    util_fread( ptr , 1 , read_bytes , block_fs->data_stream , __func__);
-    //file_node_verify_end_tag( file_node , block_fs->data_stream );
-    pthread_mutex_unlock( &block_fs->io_lock );
+static bool block_fs_pread( int fd , void * ptr , size_t byte_size , long int offset) {
+  char * target = ptr;
+  while (byte_size > 0) {
+    ssize_t read_bytes = pread( fd , target , byte_size , offset );
+    if (read_bytes > 0) {
+      target    += read_bytes;
+      offset    += read_bytes;
+      byte_size -= read_bytes;
+    } else if ((read_bytes < 0) && (errno == EINTR))
+      continue;
+    else
+      return false;
   }
+  return true;
 }
 
 
 /**
-   Reads the full content of 'filename' into the buffer. 
+   The read path does not hold any lock while reading from the data
+   file. The node is looked up in the index while holding the read
+   lock, and the position, size and write_seq of the node are copied
+   before the lock is released. The data is then read with pread(),
+   and afterwards the node is looked up under the read lock again: if
+   the node has been written to or unlinked, or the filesystem has
+   been rotated, while the data was read the read is retried.
+
+   Readers hence never wait for each other; they only wait for the
+   writers while the index is updated. The data is read either
+   directly into @ptr, or into @buffer if that is != NULL. With
+   @filename == NULL the file is looked up with the integer key @ikey.
 */
 
-void block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * filename , buffer_type * buffer) {
-  block_fs_aquire_rlock( block_fs );
-  {
-    file_node_type * node = hash_get( block_fs->index , filename);
+static void block_fs_fread__(block_fs_type * block_fs , const char * filename , int64_t ikey , void * ptr , buffer_type * buffer) {
+  while (true) {
+    file_node_type * node;
+    long int     data_pos;
+    int          data_size;
+    int          data_fd;
+    int          version;
+    unsigned int write_seq;
+    bool         read_ok;
+    bool         node_valid;
     
-    buffer_clear( buffer );   /* Setting: content_size = 0; pos = 0;  */
-    {
-      /* 
-         Going low-level - essentially a second implementation of
-         block_fs_fread__():
-      */
-
-#ifdef ENABLE_CACHE
-      if (node->cache != NULL) 
+    block_fs_aquire_rlock( block_fs );
+    if (filename != NULL)
+      node = block_fs_get_node( block_fs , filename );
+    else
+      node = block_fs_get_ikey_node( block_fs , ikey );
+#ifdef ENABLE_CACHE  
+    if (node->cache != NULL) {
+      if (buffer != NULL) {
+        buffer_clear( buffer );
         file_node_buffer_read_from_cache( node , buffer );
-      else 
-#else
-      if (true)  
+        buffer_rewind( buffer );
+      } else
+        file_node_read_from_cache( node , ptr , node->data_size );
+      block_fs_release_rwlock( block_fs );
+      return;
+    }
 #endif
+    data_pos  = node->node_offset + node->data_offset;
+    data_size = node->data_size;
+    data_fd   = block_fs->data_fd;
+    version   = block_fs->version;
+    write_seq = node->write_seq;
+    block_fs_release_rwlock( block_fs );
+    
+    if (buffer != NULL) {
+      buffer_clear( buffer );   /* Setting: content_size = 0; pos = 0;  */
+      ptr = buffer_fwrite_reserve( buffer , data_size );
+    }
+    read_ok = block_fs_pread( data_fd , ptr , data_size , data_pos );
+    
+    /* 
+       The node might have been freed while the lock was released, so
+       it is looked up again; a write_seq value is never reused, so an
+       equal value means that the node has not been touched.
+    */
+    block_fs_aquire_rlock( block_fs );
+    if (version == block_fs->version) {
+      if (filename != NULL)
+        node = node_index_get( block_fs->index , filename );
+      else
+        node = node_index_get_ikey( block_fs->index , ikey );
+      node_valid = ((node != NULL) && (node->write_seq == write_seq));
+    } else
+      node_valid = false;
+    block_fs_release_rwlock( block_fs );
 
-      {
-        pthread_mutex_lock( &block_fs->io_lock );
-        block_fs_fseek_node_data(block_fs , node );
-        buffer_stream_fread( buffer , node->data_size , block_fs->data_stream );
-        //file_node_verify_end_tag( node , block_fs->data_stream );
-        pthread_mutex_unlock( &block_fs->io_lock );
+    if (node_valid) {
+      if (!read_ok) {
+        char ikey_filename[IKEY_LENGTH + 1];
+        if (filename == NULL) {
+          block_fs_ikey_filename( ikey , ikey_filename );
+          filename = ikey_filename;
+        }
+        util_abort("%s: failed to read:%s from data file:%s - %s \n",__func__ , filename , block_fs->data_file , strerror( errno ));
       }
-      
+      break;
     }
-    buffer_rewind( buffer );  /* Setting: pos = 0; */
   }
-  block_fs_release_rwlock( block_fs );
+  
+  if (buffer != NULL)
+    buffer_rewind( buffer );  /* Setting: pos = 0; */
 }
 
 
+/**
+   Reads the full content of 'filename' into the buffer. 
+*/
 
+void block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * filename , buffer_type * buffer) {
+  block_fs_fread__( block_fs , filename , 0 , NULL , buffer );
+}
 
 
+void block_fs_fread_ikey_buffer( block_fs_type * block_fs , int64_t ikey , buffer_type * buffer) {
+  block_fs_fread__( block_fs , NULL , ikey , NULL , buffer );
+}
 
 
 /*
@@ -1456,14 +3595,8 @@ void block_fs_fread_realloc_buffer( block_fs_type * block_fs , const char * file
   check.
 */
 
-
 void block_fs_fread_file( block_fs_type * block_fs , const char * filename , void * ptr) {
-  block_fs_aquire_rlock( block_fs );
-  {
-    file_node_type * node = hash_get( block_fs->index , filename);
-    block_fs_fread__( block_fs , node , ptr , node->data_size);
-  }
-  block_fs_release_rwlock( block_fs );
+  block_fs_fread__( block_fs , filename , 0 , ptr , NULL );
 }
 
 
@@ -1472,7 +3605,7 @@ int block_fs_get_filesize( block_fs_type * block_fs , const char * filename) {
   int data_size;
   block_fs_aquire_rlock( block_fs );
   {
-    file_node_type * node = hash_get( block_fs->index , filename );
+    file_node_type * node = block_fs_get_node( block_fs , filename );
     data_size = node->data_size;
   }
   block_fs_release_rwlock( block_fs );
@@ -1480,50 +3613,6 @@ int block_fs_get_filesize( block_fs_type * block_fs , const char * filename) {
 }
 
 
-static void block_fs_dump_index( block_fs_type * block_fs ) {
-  if (block_fs->data_owner) {
-    struct stat stat_buffer;
-    int stat_return = stat(block_fs->data_file , &stat_buffer);
-    if (stat_return != 0)
-      return;
-    {
-      time_t data_mtime = stat_buffer.st_mtime;
-      FILE * index_stream = util_fopen( block_fs->index_file , "w");
-      util_fwrite_int( INDEX_MAGIC_INT , index_stream );
-      util_fwrite_int( INDEX_FORMAT_VERSION , index_stream );
-      util_fwrite_time_t( data_mtime , index_stream );
-
-      /* 1: Dumping the hash table of active nodes. */
-      {
-        hash_iter_type * index_iter = hash_iter_alloc( block_fs->index );
-        
-        util_fwrite_int( hash_get_size( block_fs->index ) , index_stream);
-        while (!hash_iter_is_complete( index_iter )) {
-          const char * key = hash_iter_get_next_key( index_iter );
-          const file_node_type * file_node = hash_get( block_fs->index , key );
-          
-          util_fwrite_string( key , index_stream);
-          file_node_dump_index( file_node , index_stream );
-        }
-        hash_iter_free( index_iter );
-      }
-      
-      /* 2: Dumping information about empty slots in the datafile. */
-      util_fwrite_int( block_fs->num_free_nodes , index_stream );
-      {
-        free_node_type * current = block_fs->free_nodes;
-        while ( current != NULL) {
-          file_node_dump_index( current->file_node , index_stream );
-          current = current->next;
-        }
-      }
-      
-      fclose( index_stream );
-    }
-  }
-}
-
-
 /**
    Close/synchronize the open file descriptors and free all memory
    related to the block_fs instance.
@@ -1533,16 +3622,18 @@ static void block_fs_dump_index( block_fs_type * block_fs ) {
 */
 
 void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
+  block_fs_stop_compactor( block_fs );
   block_fs_fsync( block_fs );
   
   if (block_fs->data_owner) 
     block_fs_aquire_wlock( block_fs );
 
+  if (block_fs->journal_size > 0)
+    block_fs_compact_journal( block_fs );
+  block_fs_journal_close( block_fs );
+
   if (block_fs->data_stream != NULL) 
     fclose( block_fs->data_stream );
-
-  if (block_fs->data_owner) 
-    block_fs_dump_index( block_fs );
       
   if (block_fs->lock_fd > 0) {
     close( block_fs->lock_fd );     /* Closing the lock_file file descriptor - and releasing the lock. */
@@ -1550,15 +3641,17 @@ void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
   }
 
   if (block_fs->data_owner) {
-    if ( unlink_empty && (hash_get_size( block_fs->index) == 0)) {
+    if ( unlink_empty && (node_index_get_size( block_fs->index) == 0)) {
       util_unlink_existing( block_fs->data_file );
       util_unlink_existing( block_fs->index_file );
+      util_unlink_existing( block_fs->journal_file );
       util_unlink_existing( block_fs->mount_file );
     }
     block_fs_release_rwlock( block_fs );
   }
 
   free( block_fs->index_file );
+  free( block_fs->journal_file );
   free( block_fs->lock_file );
   free( block_fs->base_name );
   free( block_fs->data_file );
@@ -1566,8 +3659,10 @@ void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
   free( block_fs->mount_file );
   
   free_node_free_list( block_fs->free_nodes );
-  hash_free( block_fs->index );
+  node_index_free( block_fs->index );
   vector_free( block_fs->file_nodes );
+  pthread_cond_destroy( &block_fs->compactor_cond );
+  pthread_mutex_destroy( &block_fs->compactor_mutex );
   free( block_fs );
 }
 
@@ -1583,6 +3678,10 @@ void block_fs_close( block_fs_type * block_fs , bool unlink_empty) {
    
    Observe that the block_fs instance should hold the write lock when
    entering this function.
+
+   The files are not recorded in the journal while they are copied;
+   when the rotation is complete a new index snapshot is written for
+   the new datafile.
 */
 
 static void block_fs_rotate__( block_fs_type * block_fs ) {
@@ -1594,12 +3693,13 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
   block_fs_fwrite_mount_info__( block_fs->mount_file , block_fs->version ); 
   {
     vector_type    * old_nodes         = block_fs->file_nodes;
-    hash_type      * old_index         = block_fs->index;
+    node_index_type * old_index        = block_fs->index;
     FILE           * old_data_stream   = block_fs->data_stream;
     free_node_type * old_free_nodes    = block_fs->free_nodes;
     char           * old_data_file     = util_alloc_string_copy( block_fs->data_file );
     char           * old_lock_file     = util_alloc_string_copy( block_fs->lock_file );
 
+    block_fs_journal_close( block_fs );
     block_fs_reinit( block_fs );
     /** 
         Now the block_fs pointers point to the new copy. Must use the
@@ -1607,12 +3707,14 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
     */
     block_fs_open_data( block_fs , block_fs->data_owner );
     {
-      hash_iter_type * iter = hash_iter_alloc( old_index );
+      char key_buffer[IKEY_LENGTH + 1];
+      int slot              = node_index_next_slot( old_index , -1 );
       buffer_type * buffer  = buffer_alloc(1024);
       
-      while (!hash_iter_is_complete( iter )) {
-        const char * key          = hash_iter_get_next_key( iter );
-        file_node_type * old_node = hash_get( old_index , key );
+      while (slot >= 0) {
+        const char * key          = node_index_iget_key( old_index , slot , key_buffer );
+        file_node_type * old_node = node_index_iget_node( old_index , slot );
+        slot = node_index_next_slot( old_index , slot );
         buffer_clear( buffer );
 
         /* Low level read of the old file. */
@@ -1623,7 +3725,6 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
       }
       
       buffer_free( buffer );
-      hash_iter_free( iter );
     }
     /*
       OK - everything has been played over, and we should clean up the old fs:
@@ -1642,9 +3743,10 @@ static void block_fs_rotate__( block_fs_type * block_fs ) {
     free( old_data_file );
     
     free_node_free_list( old_free_nodes );
-    hash_free( old_index );
+    node_index_free( old_index );
     vector_free( old_nodes );
   }
+  block_fs_compact_journal( block_fs );
 }
 
 
@@ -1765,16 +3867,17 @@ vector_type * block_fs_alloc_filelist( block_fs_type * block_fs  , const char *
   /* Inserting the nodes from the index. */
   block_fs_aquire_rlock( block_fs );
   {
-    hash_iter_type * iter        = hash_iter_alloc( block_fs->index );
-    while ( !hash_iter_is_complete( iter )) {
-      const char * key            = hash_iter_get_next_key( iter );
-      file_node_type * node = hash_get( block_fs->index , key );
+    char key_buffer[IKEY_LENGTH + 1];
+    int slot = node_index_next_slot( block_fs->index , -1 );
+    while (slot >= 0) {
+      const char * key      = node_index_iget_key( block_fs->index , slot , key_buffer );
+      file_node_type * node = node_index_iget_node( block_fs->index , slot );
       if (pattern_match( pattern , key )) {
         user_file_node_type * unode = user_file_node_alloc( key , node );
         vector_append_owned_ref( sort_vector , unode , user_file_node_free__ );
       }
+      slot = node_index_next_slot( block_fs->index , slot );
     }
-    hash_iter_free( iter );
   }
   block_fs_release_rwlock( block_fs );
 
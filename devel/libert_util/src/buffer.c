@@ -388,6 +388,11 @@ void buffer_fwrite_int(buffer_type * buffer , int value) {
 }
 
 
+void buffer_fwrite_long(buffer_type * buffer , long int value) {
+  buffer_fwrite(buffer , &value , sizeof value , 1);
+}
+
+
 void buffer_fwrite_bool(buffer_type * buffer , bool value) {
   buffer_fwrite(buffer , &value , sizeof value , 1);
 }
@@ -736,6 +741,28 @@ void buffer_summarize(const buffer_type * buffer , const char * header) {
 */
 
 
+/**
+   Will make room for @byte_size bytes at the current position, and
+   return a pointer to that storage; the position and content size
+   are updated as if @byte_size bytes had been written. This is used
+   to read data directly into the buffer storage, e.g. with
+   pread(). The returned pointer is invalidated by the next write to
+   the buffer.
+*/
+
+void * buffer_fwrite_reserve( buffer_type * buffer , size_t byte_size ) {
+  size_t min_size = byte_size + buffer->pos;
+  void * storage;
+  if (buffer->alloc_size < min_size)
+    buffer_resize__(buffer , min_size , true);
+
+  storage = &buffer->data[buffer->pos];
+  buffer->pos += byte_size;
+  buffer->content_size = util_size_t_max( buffer->content_size , buffer->pos );
+  return storage;
+}
+
+
 void buffer_stream_fread( buffer_type * buffer , size_t byte_size , FILE * stream) {
   size_t min_size = byte_size + buffer->pos;
   if (buffer->alloc_size < min_size)
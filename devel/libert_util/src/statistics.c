@@ -122,3 +122,139 @@ double statistics_empirical_quantile__( const double_vector_type * data , double
     }
   }
 }
+
+
+
+/*
+  Partial sort of data[0..size) with quickselect: on return data[k]
+  holds the value it would have in a sorted array, all elements in
+  data[0..k) are <= data[k] and all elements in data(k..size) are >=
+  data[k].
+*/
+
+static void statistics_select( double * data , int size , int k ) {
+  int left = 0;
+  int right = size - 1;
+
+  while (right > left) {
+    double pivot = data[ left + (right - left) / 2 ];
+    int i = left;
+    int j = right;
+
+    while (i <= j) {
+      while (data[i] < pivot)
+        i++;
+      while (data[j] > pivot)
+        j--;
+      if (i <= j) {
+        double tmp = data[i];
+        data[i] = data[j];
+        data[j] = tmp;
+        i++;
+        j--;
+      }
+    }
+
+    if (k <= j)
+      right = j;
+    else if (k >= i)
+      left = i;
+    else
+      break;
+  }
+}
+
+
+/**
+   Will return the same value as statistics_empirical_quantile(), but
+   uses selection instead of sorting the data, i.e. O(n) instead of
+   O(n log(n)). The order of the elements in @data is scrambled
+   afterwards; unlike statistics_empirical_quantile() the vector is
+   NOT sorted, and can not be passed to
+   statistics_empirical_quantile__() afterwards.
+*/
+
+double statistics_empirical_quantile_select( double_vector_type * data , double quantile ) {
+  if ((quantile < 0) || (quantile > 1.0))
+    util_abort("%s: quantile must be in [0,1] \n",__func__);
+
+  {
+    double * values = double_vector_get_ptr( data );
+    const int size = double_vector_size( data ) - 1;
+    double min_value = values[0];
+    double max_value = values[0];
+    int i;
+
+    for (i=1; i <= size; i++) {
+      min_value = util_double_min( min_value , values[i] );
+      max_value = util_double_max( max_value , values[i] );
+    }
+
+    if (min_value == max_value)
+      /* All elements are equal - see statistics_empirical_quantile__(). */
+      return min_value;
+    else {
+      double real_index = quantile * size;
+      int lower_index = floor( real_index );
+      int upper_index = ceil( real_index );
+      double lower_value;
+      double upper_value;
+
+      statistics_select( values , size + 1 , lower_index );
+      lower_value = values[lower_index];
+      upper_value = lower_value;
+      if (upper_index > lower_index) {
+        upper_value = values[upper_index];
+        for (i = upper_index + 1; i <= size; i++)
+          upper_value = util_double_min( upper_value , values[i] );
+      }
+
+      if (upper_value == lower_value) {
+        /*
+          The same search as in statistics_empirical_quantile__(), but
+          carried out on the index range [first_equal, last_equal]
+          of the elements which are equal to lower_value in sorted
+          order; the values on the outside of that range are the
+          nearest smaller and larger values.
+        */
+        double value = lower_value;
+        double smaller_value = min_value;
+        double larger_value = max_value;
+        int first_equal = 0;
+        int last_equal = -1;
+
+        for (i=0; i <= size; i++) {
+          if (values[i] < value) {
+            first_equal++;
+            smaller_value = util_double_max( smaller_value , values[i] );
+          } else if (values[i] > value)
+            larger_value = util_double_min( larger_value , values[i] );
+          if (values[i] <= value)
+            last_equal++;
+        }
+
+        while (true) {
+          if ((upper_index <= last_equal) && (lower_index >= first_equal))
+            upper_index = util_int_min( size , upper_index + 1 );
+          else
+            break;
+
+          if ((upper_index <= last_equal) && (lower_index >= first_equal))
+            lower_index = util_int_max( 0 , lower_index - 1 );
+          else
+            break;
+        }
+        upper_value = (upper_index > last_equal) ? larger_value : value;
+        lower_value = (lower_index < first_equal) ? smaller_value : value;
+      }
+
+      {
+        double upper_quantile = upper_index * 1.0 / size;
+        double lower_quantile = lower_index * 1.0 / size;
+        double a = (upper_value - lower_value) / (upper_quantile - lower_quantile);
+
+        return lower_value + a*(quantile - lower_quantile);
+      }
+    }
+  }
+}
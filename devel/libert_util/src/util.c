@@ -168,6 +168,7 @@ static uint64_t util_endian_convert64( uint64_t u ) {
 }
 
 
+#if defined(ARCH64) && !defined(HAVE_TARGET_CLONES)
 static uint64_t util_endian_convert32_64( uint64_t u ) {
   const uint64_t m8  = (uint64_t) 0x00FF00FF00FF00FFULL;
   const uint64_t m16 = (uint64_t) 0x0000FFFF0000FFFFULL;
@@ -177,7 +178,58 @@ static uint64_t util_endian_convert32_64( uint64_t u ) {
   u = (( u >> 16U ) & m16) | ((u & m16) << 16U);
   return u;
 }
+#endif
+
+
+
+/*
+  The bulk loops below are compiled in several versions for different
+  instruction sets when the compiler supports it (HAVE_TARGET_CLONES);
+  the best version for the running cpu is then selected when the
+  library is loaded. The loops are written in a form the compiler can
+  vectorize; for the vectorized 32 bit case the plain one element at a
+  time loop is faster than the util_endian_convert32_64() trick.
+*/
+
+#ifdef HAVE_TARGET_CLONES
+#define UTIL_VECTOR_KERNEL __attribute__((target_clones("avx2","default"),optimize("tree-vectorize")))
+#else
+#define UTIL_VECTOR_KERNEL
+#endif
+
+
+UTIL_VECTOR_KERNEL
+static void util_endian_flip_vector32( uint32_t * data , int elements ) {
+  int i;
+#if defined(ARCH64) && !defined(HAVE_TARGET_CLONES)
+  /*
+    In the case of a 64 bit CPU the fastest way to swap 32 bit
+    variables will be by swapping two elements in one operation;
+    this is provided by the util_endian_convert32_64() function. In the case
+    of binary ECLIPSE files this case is quite common, and
+    therefor worth supporting as a special case. 
+  */
+  uint64_t *tmp64 = (uint64_t *) data;
+  
+  for (i = 0; i <elements/2; i++)
+    tmp64[i] = util_endian_convert32_64(tmp64[i]);
+  
+  if ( elements & 1 ) 
+    // Odd number of elements - flip the last element as an ordinary 32 bit swap.
+    data[ elements - 1] = util_endian_convert32( data[elements - 1] );
+#else
+  for (i = 0; i <elements; i++)
+    data[i] = util_endian_convert32(data[i]);
+#endif
+}
+
 
+UTIL_VECTOR_KERNEL
+static void util_endian_flip_vector64( uint64_t * data , int elements ) {
+  int i;
+  for (i = 0; i <elements; i++)
+    data[i] = util_endian_convert64(data[i]);
+}
 
 
 void util_endian_flip_vector(void *data, int element_size , int elements) {
@@ -194,43 +246,11 @@ void util_endian_flip_vector(void *data, int element_size , int elements) {
       break;
     }
   case(4):
-    {
-#ifdef ARCH64
-      /*
-        In the case of a 64 bit CPU the fastest way to swap 32 bit
-        variables will be by swapping two elements in one operation;
-        this is provided by the util_endian_convert32_64() function. In the case
-        of binary ECLIPSE files this case is quite common, and
-        therefor worth supporting as a special case. 
-      */
-      uint64_t *tmp64 = (uint64_t *) data;
-
-      for (i = 0; i <elements/2; i++)
-        tmp64[i] = util_endian_convert32_64(tmp64[i]);
-
-      if ( elements & 1 ) {
-        // Odd number of elements - flip the last element as an ordinary 32 bit swap.
-        uint32_t *tmp32 = (uint32_t *) data;
-        tmp32[ elements - 1] = util_endian_convert32( tmp32[elements - 1] );
-      }
-      break;
-#else
-      uint32_t *tmp32 = (uint32_t *) data;
-      
-      for (i = 0; i <elements; i++)
-        tmp32[i] = util_endian_convert32(tmp32[i]);
-      
-      break;
-#endif
-    }
+    util_endian_flip_vector32( (uint32_t *) data , elements );
+    break;
   case(8):
-    {
-      uint64_t *tmp64 = (uint64_t *) data;
-
-      for (i = 0; i <elements; i++)
-        tmp64[i] = util_endian_convert64(tmp64[i]);
-      break;
-    }
+    util_endian_flip_vector64( (uint64_t *) data , elements );
+    break;
   default:
     fprintf(stderr,"%s: current element size: %d \n",__func__ , element_size);
     util_abort("%s: can only endian flip 1/2/4/8 byte variables - aborting \n",__func__);
@@ -4046,14 +4066,16 @@ char * util_string_strip_chars_alloc(const char * buff_org, const char * chars)
 
 
 
-void util_float_to_double(double *double_ptr , const float *float_ptr , int size) {
+UTIL_VECTOR_KERNEL
+void util_float_to_double(double * __restrict double_ptr , const float * __restrict float_ptr , int size) {
   int i;
   for (i=0; i < size; i++) 
     double_ptr[i] = float_ptr[i];
 }
 
 
-void util_double_to_float(float *float_ptr , const double *double_ptr , int size) {
+UTIL_VECTOR_KERNEL
+void util_double_to_float(float * __restrict float_ptr , const double * __restrict double_ptr , int size) {
   int i;
   for (i=0; i < size; i++)
     float_ptr[i] = (float) double_ptr[i];
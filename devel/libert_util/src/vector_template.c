@@ -165,7 +165,7 @@ static void @TYPE@_vector_memmove(@TYPE@_vector_type * vector , int offset , int
     @TYPE@_vector_realloc_data__( vector , util_int_min( 2*vector->alloc_size , count + vector->size ));
   
   {
-    int block_size     = abs(count) * sizeof(@TYPE@);
+    int block_size     = (vector->size - offset) * sizeof(@TYPE@);   /* All the elements from @offset to the end are moved. */
     @TYPE@ * target    = &vector->data[offset + count];
     const @TYPE@ * src = &vector->data[offset];
     memmove( target , src , block_size );
@@ -0,0 +1,886 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'ert_util_block_fs.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/test_work_area.h>
+#include <ert/util/util.h>
+#include <ert/util/buffer.h>
+#include <ert/util/block_fs.h>
+
+#define NUM_FILES    20
+#define NUM_READERS   4
+#define NUM_WRITES 2000
+
+
+/*
+  The block_fs library calls fsync() through this function; when
+  exit_on_fsync is set the process exits right after the data has been
+  synced. Used to take a process down in the middle of a batch commit.
+*/
+
+static bool exit_on_fsync = false;
+
+int fsync( int fd ) {
+  int result = syscall( SYS_fsync , fd );
+  if (exit_on_fsync)
+    _exit(0);
+  return result;
+}
+
+
+/*
+  The content of a file is: version, size and then size bytes where
+  byte i has the value (version + i) % 256; a torn read will be
+  detected as content which is not consistent.
+*/
+
+buffer_type * alloc_content( int ifile , int version ) {
+  int size = 100 + (version * 37 + ifile * 11) % 5000;
+  buffer_type * buffer = buffer_alloc( size + 2 * sizeof(int));
+  int i;
+
+  buffer_fwrite_int( buffer , version );
+  buffer_fwrite_int( buffer , size );
+  for (i=0; i < size; i++)
+    buffer_fwrite_char( buffer , (version + i) % 256 );
+  
+  return buffer;
+}
+
+
+void write_file( block_fs_type * block_fs , int ifile , int version ) {
+  char * filename = util_alloc_sprintf("FILE.%d" , ifile );
+  buffer_type * buffer = alloc_content( ifile , version );
+  
+  block_fs_fwrite_buffer( block_fs , filename , buffer );
+  buffer_free( buffer );
+  free( filename );
+}
+
+
+void batch_add_file( block_fs_batch_type * batch , int ifile , int version ) {
+  char * filename = util_alloc_sprintf("FILE.%d" , ifile );
+  buffer_type * buffer = alloc_content( ifile , version );
+  
+  block_fs_batch_add_buffer( batch , filename , buffer );
+  buffer_free( buffer );
+  free( filename );
+}
+
+
+bool content_valid( buffer_type * buffer ) {
+  int version = buffer_fread_int( buffer );
+  int size = buffer_fread_int( buffer );
+  const unsigned char * data = buffer_get_data( buffer );
+  int i;
+  
+  if (buffer_get_size( buffer ) != (size + 2 * sizeof(int)))
+    return false;
+
+  data += 2 * sizeof(int);
+  for (i=0; i < size; i++)
+    if (data[i] != (version + i) % 256)
+      return false;
+  
+  return true;
+}
+
+
+typedef struct {
+  block_fs_type * block_fs;
+  bool            writer_done;
+  int             num_reads;
+  int             num_errors;
+  pthread_mutex_t lock;
+} reader_arg_type;
+
+
+void * reader( void * void_arg ) {
+  reader_arg_type * arg = void_arg;
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int num_reads = 0;
+  int num_errors = 0;
+  int ifile = 0;
+  bool done = false;
+
+  while (!done) {
+    char * filename = util_alloc_sprintf("FILE.%d" , ifile );
+    block_fs_fread_realloc_buffer( arg->block_fs , filename , buffer );
+    if (!content_valid( buffer ))
+      num_errors++;
+    num_reads++;
+    free( filename );
+    
+    ifile = (ifile + 7) % NUM_FILES;
+    pthread_mutex_lock( &arg->lock );
+    done = arg->writer_done;
+    pthread_mutex_unlock( &arg->lock );
+  }
+
+  pthread_mutex_lock( &arg->lock );
+  arg->num_reads += num_reads;
+  arg->num_errors += num_errors;
+  pthread_mutex_unlock( &arg->lock );
+
+  buffer_free( buffer );
+  return NULL;
+}
+
+
+/*
+  The readers are running concurrently with a writer which rewrites
+  the files with changing size, unlinks other files and thereby
+  forces the filesystem to rotate.
+*/
+
+void test_concurrent_read( ) {
+  block_fs_type * block_fs = block_fs_mount( "TEST.mnt" , 64 , 0 , 0.50 , 0 , false , false , false );
+  pthread_t readers[NUM_READERS];
+  reader_arg_type arg;
+  int i;
+
+  for (i=0; i < NUM_FILES; i++) 
+    write_file( block_fs , i , 0 );
+
+  arg.block_fs = block_fs;
+  arg.writer_done = false;
+  arg.num_reads = 0;
+  arg.num_errors = 0;
+  pthread_mutex_init( &arg.lock , NULL );
+  
+  for (i=0; i < NUM_READERS; i++)
+    pthread_create( &readers[i] , NULL , reader , &arg );
+
+  for (i=0; i < NUM_WRITES; i++) {
+    write_file( block_fs , i % NUM_FILES , i );
+    if ((i % 10) == 0) {
+      block_fs_fwrite_file( block_fs , "TMP" , &i , sizeof i );
+      block_fs_unlink_file( block_fs , "TMP" );
+    }
+  }
+
+  pthread_mutex_lock( &arg.lock );
+  arg.writer_done = true;
+  pthread_mutex_unlock( &arg.lock );
+  
+  for (i=0; i < NUM_READERS; i++)
+    pthread_join( readers[i] , NULL );
+  
+  test_assert_true( arg.num_reads > 0 );
+  test_assert_int_equal( arg.num_errors , 0 );
+  block_fs_close( block_fs , false );
+}
+
+
+void test_reopen( ) {
+  block_fs_type * block_fs = block_fs_mount( "TEST.mnt" , 64 , 0 , 0.50 , 0 , false , false , false );
+  buffer_type * buffer = buffer_alloc( 1024 );
+  int i;
+  
+  test_assert_false( block_fs_has_file( block_fs , "TMP" ));
+  for (i=0; i < NUM_FILES; i++) {
+    char * filename = util_alloc_sprintf("FILE.%d" , i );
+    int size = block_fs_get_filesize( block_fs , filename );
+    char * data = util_malloc( size );
+
+    block_fs_fread_realloc_buffer( block_fs , filename , buffer );
+    test_assert_true( content_valid( buffer ));
+    test_assert_int_equal( buffer_get_size( buffer ) , size );
+
+    block_fs_fread_file( block_fs , filename , data );
+    test_assert_true( memcmp( data , buffer_get_data( buffer ) , size ) == 0 );
+    
+    free( data );
+    free( filename );
+  }
+  buffer_free( buffer );
+  block_fs_close( block_fs , false );
+}
+
+
+void test_file( block_fs_type * block_fs , int ifile , int version ) {
+  char * filename = util_alloc_sprintf("FILE.%d" , ifile );
+  buffer_type * buffer = buffer_alloc( 1024 );
+  
+  test_assert_true( block_fs_has_file( block_fs , filename ));
+  block_fs_fread_realloc_buffer( block_fs , filename , buffer );
+  test_assert_true( content_valid( buffer ));
+  buffer_rewind( buffer );
+  test_assert_int_equal( buffer_fread_int( buffer ) , version );
+  
+  buffer_free( buffer );
+  free( filename );
+}
+
+
+void test_batch_content( block_fs_type * block_fs ) {
+  int i;
+  test_file( block_fs , 0 , 2 );
+  for (i=1; i < 5; i++)
+    test_file( block_fs , i , 1 );
+  for (i=5; i < 10; i++)
+    test_file( block_fs , i , 0 );
+  for (i=10; i < 15; i++)
+    test_file( block_fs , i , 1 );
+}
+
+
+void test_batch( ) {
+  block_fs_type * block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  block_fs_batch_type * batch = block_fs_batch_alloc( block_fs );
+  int i;
+
+  test_assert_true( block_fs_batch_is_instance( batch ));
+  for (i=0; i < 10; i++) 
+    write_file( block_fs , i , 0 );
+  
+  for (i=0; i < 5; i++)
+    batch_add_file( batch , i , 1 );
+  for (i=10; i < 15; i++)
+    batch_add_file( batch , i , 1 );
+  batch_add_file( batch , 0 , 2 );
+  test_assert_int_equal( block_fs_batch_get_size( batch ) , 10 );
+  
+  /* Nothing is visible before the commit. */
+  test_assert_false( block_fs_has_file( block_fs , "FILE.10" ));
+  test_file( block_fs , 0 , 0 );
+
+  block_fs_batch_commit( batch );
+  test_assert_int_equal( block_fs_batch_get_size( batch ) , 0 );
+  test_batch_content( block_fs );
+  block_fs_batch_free( batch );
+  block_fs_close( block_fs , false );
+
+  /* Mounting from the index file. */
+  block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_batch_content( block_fs );
+  block_fs_close( block_fs , false );
+  
+  /* Mounting by scanning the data file. */
+  unlink( "BATCH.index" );
+  block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_batch_content( block_fs );
+  block_fs_close( block_fs , false );
+}
+
+
+/*
+  A child process commits a batch, and goes down after the batch has
+  been written and synced, but before it has been committed; i.e. the
+  batch is left with status NODE_BATCH_ACTIVE on disk. None of the
+  files in the batch should survive, neither when mounting from the
+  journal nor when scanning the data file.
+*/
+
+void crash_batch( ) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    block_fs_type * block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    block_fs_batch_type * batch = block_fs_batch_alloc( block_fs );
+    int i;
+    for (i=20; i < 25; i++)
+      batch_add_file( batch , i , 1 );
+    exit_on_fsync = true;
+    block_fs_batch_commit( batch );
+    _exit(1);
+  } else {
+    int status;
+    waitpid( pid , &status , 0 );
+    test_assert_true( WIFEXITED( status ));
+    test_assert_int_equal( WEXITSTATUS( status ) , 0 );
+  }
+}
+
+
+void test_batch_crash_content( ) {
+  block_fs_type * block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  int i;
+  for (i=20; i < 25; i++) {
+    char * filename = util_alloc_sprintf("FILE.%d" , i );
+    test_assert_false( block_fs_has_file( block_fs , filename ));
+    free( filename );
+  }
+  test_batch_content( block_fs );
+  block_fs_close( block_fs , false );
+}
+
+
+void test_batch_crash( ) {
+  block_fs_type * block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  long int batch_offset = block_fs_get_data_file_size( block_fs );
+  block_fs_batch_type * batch;
+  int i;
+  
+  block_fs_close( block_fs , false );
+  crash_batch( );
+  {
+    /* The batch is on disk, but still marked as active. */
+    FILE * stream = util_fopen( "BATCH.data_0" , "r");
+    fseek( stream , batch_offset , SEEK_SET );
+    test_assert_int_equal( util_fread_int( stream ) , 0x5A5AAA55 );
+    fclose( stream );
+  }
+  test_batch_crash_content( );
+  
+  crash_batch( );
+  unlink( "BATCH.index" );
+  test_batch_crash_content( );
+  
+  /* The discarded region can be reused. */
+  block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  batch = block_fs_batch_alloc( block_fs );
+  for (i=20; i < 25; i++)
+    batch_add_file( batch , i , 3 );
+  block_fs_batch_commit( batch );
+  write_file( block_fs , 25 , 3 );
+  block_fs_batch_free( batch );
+  block_fs_close( block_fs , false );
+  
+  unlink( "BATCH.index" );
+  block_fs = block_fs_mount( "BATCH.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  for (i=20; i < 26; i++)
+    test_file( block_fs , i , 3 );
+  test_batch_content( block_fs );
+  block_fs_close( block_fs , false );
+}
+
+
+/*
+  Mounts the filesystem in a child process which writes and unlinks
+  some files, and then exits without closing the filesystem; i.e. the
+  index is only available from the journal.
+*/
+
+void crash_write( const char * mount_file , int first , int last , int version , int unlink_file , bool batch) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    block_fs_type * block_fs = block_fs_mount( mount_file , 64 , 0 , 1.0 , 0 , false , false , false );
+    int i;
+    if (batch) {
+      block_fs_batch_type * batch = block_fs_batch_alloc( block_fs );
+      for (i=first; i < last; i++)
+        batch_add_file( batch , i , version );
+      block_fs_batch_commit( batch );
+    } else {
+      for (i=first; i < last; i++)
+        write_file( block_fs , i , version );
+    }
+    
+    if (unlink_file >= 0) {
+      char * filename = util_alloc_sprintf("FILE.%d" , unlink_file );
+      block_fs_unlink_file( block_fs , filename );
+      free( filename );
+    }
+    _exit(0);
+  } else {
+    int status;
+    waitpid( pid , &status , 0 );
+    test_assert_true( WIFEXITED( status ));
+  }
+}
+
+
+void test_journal_content( block_fs_type * block_fs ) {
+  int i;
+  for (i=0; i < 5; i++)
+    test_file( block_fs , i , 1 );
+  for (i=5; i < 9; i++)
+    test_file( block_fs , i , 0 );
+  test_assert_false( block_fs_has_file( block_fs , "FILE.9" ));
+  test_file( block_fs , 10 , 1 );
+}
+
+
+void test_journal( ) {
+  block_fs_type * block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  struct stat stat_buffer;
+  int i;
+  
+  for (i=0; i < 10; i++)
+    write_file( block_fs , i , 0 );
+  block_fs_close( block_fs , false );
+  
+  /* 1: Recovering the files written after the index snapshot. */
+  crash_write( "JOURNAL.mnt" , 0 , 5 , 1 , 9 , false );
+  crash_write( "JOURNAL.mnt" , 10 , 11 , 1 , -1 , false );
+  test_assert_true( util_file_exists( "JOURNAL.index" ));
+  block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_journal_content( block_fs );
+  block_fs_close( block_fs , false );
+  
+  crash_write( "JOURNAL.mnt" , 20 , 25 , 1 , -1 , true );
+  crash_write( "JOURNAL.mnt" , 20 , 22 , 2 , -1 , true );
+  block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_journal_content( block_fs );
+  for (i=20; i < 25; i++)
+    test_file( block_fs , i , (i < 22) ? 2 : 1 );
+  block_fs_close( block_fs , false );
+  
+  /* 2: The last file is not completely written, and the last journal record is torn. */
+  crash_write( "JOURNAL.mnt" , 11 , 12 , 100 , -1 , false );
+  stat( "JOURNAL.data_0" , &stat_buffer );
+  test_assert_int_equal( truncate( "JOURNAL.data_0" , stat_buffer.st_size - 10 ) , 0 );
+  {
+    FILE * stream = util_fopen( "JOURNAL.journal" , "a");
+    util_fwrite_int( 1000 , stream );
+    fclose( stream );
+  }
+  block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_assert_false( block_fs_has_file( block_fs , "FILE.11" ));
+  test_journal_content( block_fs );
+  write_file( block_fs , 11 , 3 );
+  block_fs_close( block_fs , false );
+  
+  block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_journal_content( block_fs );
+  test_file( block_fs , 11 , 3 );
+  block_fs_close( block_fs , false );
+  
+  /* 3: The journal is lost; mounting by scanning the data file. */
+  crash_write( "JOURNAL.mnt" , 12 , 13 , 1 , 11 , false );
+  unlink( "JOURNAL.journal" );
+  block_fs = block_fs_mount( "JOURNAL.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_journal_content( block_fs );
+  test_file( block_fs , 12 , 1 );
+  test_assert_false( block_fs_has_file( block_fs , "FILE.11" ));
+  block_fs_close( block_fs , false );
+}
+
+
+/*
+  A batch is journaled as one batch record followed by a record for
+  each of the nodes in the batch. The journal is cut after each of the
+  records in turn; the files which are not found in the journal are
+  recovered by scanning the data file, i.e. the batch is still either
+  completely present or not present at all.
+*/
+
+#define JOURNAL_HEADER_SIZE (3 * sizeof(int) + sizeof(long))
+
+void test_journal_batch( ) {
+  const char * file_list[] = { "REPLAY.data_0" , "REPLAY.index" , "REPLAY.journal" };
+  block_fs_type * block_fs = block_fs_mount( "REPLAY.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  long int journal_size;
+  long int cut;
+  int i;
+  
+  for (i=0; i < 10; i++)
+    write_file( block_fs , i , 0 );
+  block_fs_close( block_fs , false );
+  crash_write( "REPLAY.mnt" , 0 , 5 , 1 , -1 , true );
+  
+  for (i=0; i < 3; i++) {
+    char * copy = util_alloc_sprintf("%s.orig" , file_list[i] );
+    util_copy_file( file_list[i] , copy );
+    free( copy );
+  }
+  journal_size = util_file_size( "REPLAY.journal" );
+  test_assert_true( journal_size > JOURNAL_HEADER_SIZE );
+  
+  cut = JOURNAL_HEADER_SIZE;
+  while (cut < journal_size) {
+    for (i=0; i < 3; i++) {
+      char * copy = util_alloc_sprintf("%s.orig" , file_list[i] );
+      util_copy_file( copy , file_list[i] );
+      free( copy );
+    }
+    test_assert_int_equal( truncate( "REPLAY.journal" , cut ) , 0 );
+    
+    block_fs = block_fs_mount( "REPLAY.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+    for (i=0; i < 10; i++)
+      test_file( block_fs , i , (i < 5) ? 1 : 0 );
+    block_fs_close( block_fs , false );
+    
+    {
+      FILE * stream = util_fopen( "REPLAY.journal.orig" , "r");
+      fseek( stream , cut , SEEK_SET );
+      cut += util_fread_int( stream ) + 2 * sizeof(int);
+      fclose( stream );
+    }
+  }
+  test_assert_int_equal( cut , journal_size );
+}
+
+
+void test_compact_content( block_fs_type * block_fs , int first ) {
+  int i;
+  for (i=0; i < 40; i++) {
+    char * filename = util_alloc_sprintf("FILE.%d" , i );
+    if ((i % 2) && (i >= first))
+      test_file( block_fs , i , 0 );
+    else
+      test_assert_false( block_fs_has_file( block_fs , filename ));
+    free( filename );
+  }
+}
+
+
+void test_compact_size( block_fs_type * block_fs ) {
+  struct stat stat_buffer;
+  stat( "COMPACT.data_0" , &stat_buffer );
+  test_assert_true( stat_buffer.st_size == block_fs_get_data_file_size( block_fs ));
+}
+
+
+void test_compact( ) {
+  block_fs_type * block_fs = block_fs_mount( "COMPACT.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  long int data_file_size;
+  int i;
+  
+  /* Written largest first, so the holes in front can take the files at the tail. */
+  for (i=39; i >= 0; i--)
+    write_file( block_fs , i , 0 );
+  for (i=0; i < 40; i += 2) {
+    char * filename = util_alloc_sprintf("FILE.%d" , i );
+    block_fs_unlink_file( block_fs , filename );
+    free( filename );
+  }
+  test_assert_int_equal( block_fs_get_num_free_nodes( block_fs ) , 20 );
+  test_assert_true( block_fs_get_fragmentation( block_fs ) > 0.40 );
+  data_file_size = block_fs_get_data_file_size( block_fs );
+  
+  test_assert_true( block_fs_compact( block_fs , 1024 * 1024 ) > 0 );
+  test_assert_true( block_fs_get_relocated_nodes( block_fs ) > 0 );
+  test_assert_true( block_fs_get_data_file_size( block_fs ) < data_file_size );
+  test_assert_true( block_fs_get_reclaimed_bytes( block_fs ) == data_file_size - block_fs_get_data_file_size( block_fs ));
+  test_assert_true( block_fs_get_fragmentation( block_fs ) < 0.20 );
+  test_assert_int_equal( block_fs_get_compact_steps( block_fs ) , 1 );
+  test_compact_size( block_fs );
+  test_compact_content( block_fs , 0 );
+  
+  /* The files moved can be rewritten and unlinked as usual. */
+  write_file( block_fs , 39 , 0 );
+  block_fs_unlink_file( block_fs , "FILE.1" );
+  block_fs_close( block_fs , false );
+  
+  block_fs = block_fs_mount( "COMPACT.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_compact_content( block_fs , 3 );
+  test_compact_size( block_fs );
+  block_fs_close( block_fs , false );
+  
+  /* Compacting in a process which goes down; the index is recovered from the journal. */
+  {
+    pid_t pid = fork();
+    if (pid == 0) {
+      block_fs = block_fs_mount( "COMPACT.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+      for (i=3; i < 10; i += 2) {
+        char * filename = util_alloc_sprintf("FILE.%d" , i );
+        block_fs_unlink_file( block_fs , filename );
+        free( filename );
+      }
+      block_fs_compact( block_fs , 1024 * 1024 );
+      _exit(0);
+    } else {
+      int status;
+      waitpid( pid , &status , 0 );
+    }
+  }
+  block_fs = block_fs_mount( "COMPACT.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_compact_content( block_fs , 11 );
+  test_compact_size( block_fs );
+  block_fs_close( block_fs , false );
+  
+  /* Mounting by scanning the compacted data file. */
+  unlink( "COMPACT.index" );
+  block_fs = block_fs_mount( "COMPACT.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_compact_content( block_fs , 11 );
+  block_fs_close( block_fs , false );
+}
+
+
+/*
+  The background compactor is running while files are written,
+  unlinked and read concurrently.
+*/
+
+void test_background_compactor( ) {
+  block_fs_type * block_fs = block_fs_mount( "BACKGROUND.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  pthread_t readers[NUM_READERS];
+  reader_arg_type arg;
+  int i;
+
+  for (i=0; i < NUM_FILES; i++) 
+    write_file( block_fs , i , 0 );
+  
+  arg.block_fs = block_fs;
+  arg.writer_done = false;
+  arg.num_reads = 0;
+  arg.num_errors = 0;
+  pthread_mutex_init( &arg.lock , NULL );
+  for (i=0; i < NUM_READERS; i++)
+    pthread_create( &readers[i] , NULL , reader , &arg );
+  
+  block_fs_start_compactor( block_fs , 0.10 , 0 );
+  test_assert_true( block_fs_compactor_running( block_fs ));
+  for (i=0; i < NUM_WRITES; i++) {
+    write_file( block_fs , i % NUM_FILES , i );
+    if ((i % 10) == 0) {
+      block_fs_fwrite_file( block_fs , "TMP" , &i , sizeof i );
+      block_fs_unlink_file( block_fs , "TMP" );
+    }
+  }
+  
+  for (i=0; (i < 200) && (block_fs_get_compact_steps( block_fs ) == 0); i++)
+    usleep( 50000 );
+  test_assert_true( block_fs_get_compact_steps( block_fs ) > 0 );
+  
+  pthread_mutex_lock( &arg.lock );
+  arg.writer_done = true;
+  pthread_mutex_unlock( &arg.lock );
+  for (i=0; i < NUM_READERS; i++)
+    pthread_join( readers[i] , NULL );
+  test_assert_int_equal( arg.num_errors , 0 );
+  
+  block_fs_stop_compactor( block_fs );
+  test_assert_false( block_fs_compactor_running( block_fs ));
+  for (i=0; i < NUM_FILES; i++)
+    test_file( block_fs , i , NUM_WRITES - NUM_FILES + i );
+  block_fs_close( block_fs , false );
+  
+  block_fs = block_fs_mount( "BACKGROUND.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  for (i=0; i < NUM_FILES; i++)
+    test_file( block_fs , i , NUM_WRITES - NUM_FILES + i );
+  block_fs_close( block_fs , false );
+}
+
+
+#define NUM_IKEYS 5
+static const int64_t ikey_list[NUM_IKEYS] = { 0 , 1 , 77 , -1 , 4611686018427387904LL };
+
+void test_ikey_content( block_fs_type * block_fs , int num_keys , int version ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  int i;
+  for (i=0; i < NUM_IKEYS; i++) {
+    if (i < num_keys) {
+      buffer_type * content = alloc_content( i , version );
+      test_assert_true( block_fs_has_ikey( block_fs , ikey_list[i] ));
+      block_fs_fread_ikey_buffer( block_fs , ikey_list[i] , buffer );
+      test_assert_true( buffer_get_size( buffer ) == buffer_get_size( content ));
+      test_assert_true( memcmp( buffer_get_data( buffer ) , buffer_get_data( content ) , buffer_get_size( buffer )) == 0);
+      buffer_free( content );
+    } else
+      test_assert_false( block_fs_has_ikey( block_fs , ikey_list[i] ));
+  }
+  buffer_free( buffer );
+}
+
+
+void test_ikey( ) {
+  block_fs_type * block_fs = block_fs_mount( "IKEY.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  int64_t max_ikey;
+  int i;
+
+  test_assert_false( block_fs_has_ikey( block_fs , 0 ));
+  test_assert_false( block_fs_get_max_ikey( block_fs , &max_ikey ));
+  for (i=0; i < NUM_IKEYS; i++) {
+    buffer_type * content = alloc_content( i , 0 );
+    block_fs_fwrite_ikey_buffer( block_fs , ikey_list[i] , content );
+    buffer_free( content );
+  }
+  write_file( block_fs , 0 , 0 );
+  test_ikey_content( block_fs , NUM_IKEYS , 0 );
+  test_assert_true( block_fs_get_max_ikey( block_fs , &max_ikey ));
+  test_assert_true( max_ikey == ikey_list[ NUM_IKEYS - 1 ] );
+  test_assert_int_equal( block_fs_get_num_files( block_fs ) , NUM_IKEYS + 1 );
+  test_assert_int_equal( block_fs_get_num_ikeys( block_fs ) , NUM_IKEYS );
+  
+  /* The files are listed with a filename which maps back to the integer key. */
+  {
+    vector_type * file_list = block_fs_alloc_filelist( block_fs , NULL , NO_SORT , false );
+    int num_ikeys = 0;
+    test_assert_int_equal( vector_get_size( file_list ) , NUM_IKEYS + 1 );
+    for (i=0; i < vector_get_size( file_list ); i++) {
+      const char * filename = user_file_node_get_filename( vector_iget_const( file_list , i ));
+      int64_t ikey;
+      if (block_fs_sscanf_ikey( filename , &ikey )) {
+        test_assert_true( block_fs_has_file( block_fs , filename ));
+        test_assert_true( block_fs_has_ikey( block_fs , ikey ));
+        num_ikeys++;
+      } else
+        test_assert_string_equal( filename , "FILE.0" );
+    }
+    test_assert_int_equal( num_ikeys , NUM_IKEYS );
+    vector_free( file_list );
+  }
+  {
+    int64_t ikey;
+    test_assert_true( block_fs_sscanf_ikey( "#000000000000004d" , &ikey ));
+    test_assert_true( ikey == 77 );
+    test_assert_false( block_fs_sscanf_ikey( "#000000000000004D" , &ikey ));
+    test_assert_false( block_fs_sscanf_ikey( "#000000000000004" , &ikey ));
+    test_assert_false( block_fs_sscanf_ikey( "#000000000000004d0" , &ikey ));
+    test_assert_false( block_fs_sscanf_ikey( "FILE.0" , &ikey ));
+  }
+  
+  block_fs_unlink_ikey( block_fs , ikey_list[ NUM_IKEYS - 1 ] );
+  test_assert_true( block_fs_get_max_ikey( block_fs , &max_ikey ));
+  test_assert_true( max_ikey == 77 );
+  test_assert_int_equal( block_fs_get_num_ikeys( block_fs ) , NUM_IKEYS - 1 );
+  {
+    block_fs_batch_type * batch = block_fs_batch_alloc( block_fs );
+    for (i=0; i < NUM_IKEYS - 1; i++) {
+      buffer_type * content = alloc_content( i , 1 );
+      block_fs_batch_add_ikey_buffer( batch , ikey_list[i] , content );
+      buffer_free( content );
+    }
+    block_fs_batch_commit( batch );
+    block_fs_batch_free( batch );
+  }
+  test_ikey_content( block_fs , NUM_IKEYS - 1 , 1 );
+  block_fs_close( block_fs , false );
+  
+  /* Mounting from the index, and by scanning the datafile. */
+  block_fs = block_fs_mount( "IKEY.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_ikey_content( block_fs , NUM_IKEYS - 1 , 1 );
+  block_fs_defrag( block_fs );
+  test_ikey_content( block_fs , NUM_IKEYS - 1 , 1 );
+  test_file( block_fs , 0 , 0 );
+  block_fs_close( block_fs , false );
+  
+  unlink( "IKEY.index" );
+  block_fs = block_fs_mount( "IKEY.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_ikey_content( block_fs , NUM_IKEYS - 1 , 1 );
+  test_assert_int_equal( block_fs_get_num_files( block_fs ) , NUM_IKEYS );
+  test_assert_int_equal( block_fs_get_num_ikeys( block_fs ) , NUM_IKEYS - 1 );
+  block_fs_close( block_fs , false );
+}
+
+
+/*
+  Many keys are inserted and unlinked, so that the index is grown
+  several times, the removed keys are replaced by new keys, and the
+  index is finally cleaned up without growing. Every fourth of the
+  first keys is kept.
+*/
+
+#define NUM_INDEX_KEYS  4000
+#define NUM_CHURN_KEYS 20000
+
+static int64_t index_ikey( int i ) {
+  return i * 7919LL - 2 * NUM_INDEX_KEYS;
+}
+
+
+void test_index_content( block_fs_type * block_fs ) {
+  buffer_type * buffer = buffer_alloc( 100 );
+  int i;
+  
+  for (i=0; i < NUM_INDEX_KEYS; i++) {
+    char * filename = util_alloc_sprintf("KEY.%d" , i );
+    if ((i % 4) == 0) {
+      test_assert_true( block_fs_has_file( block_fs , filename ));
+      test_assert_true( block_fs_has_ikey( block_fs , index_ikey( i )));
+      
+      block_fs_fread_realloc_buffer( block_fs , filename , buffer );
+      test_assert_int_equal( buffer_fread_int( buffer ) , i );
+      block_fs_fread_ikey_buffer( block_fs , index_ikey( i ) , buffer );
+      test_assert_int_equal( buffer_fread_int( buffer ) , -i );
+    } else {
+      test_assert_false( block_fs_has_file( block_fs , filename ));
+      test_assert_false( block_fs_has_ikey( block_fs , index_ikey( i )));
+    }
+    free( filename );
+  }
+  test_assert_false( block_fs_has_file( block_fs , "CHURN.0" ));
+  test_assert_true( block_fs_has_file( block_fs , "CHURN.LAST" ));
+  {
+    vector_type * file_list = block_fs_alloc_filelist( block_fs , NULL , NO_SORT , false );
+    test_assert_int_equal( vector_get_size( file_list ) , 2 * (NUM_INDEX_KEYS / 4) + 1 );
+    vector_free( file_list );
+  }
+  test_assert_int_equal( block_fs_get_num_files( block_fs ) , 2 * (NUM_INDEX_KEYS / 4) + 1 );
+  test_assert_int_equal( block_fs_get_num_ikeys( block_fs ) , NUM_INDEX_KEYS / 4 );
+  buffer_free( buffer );
+}
+
+
+void test_index( ) {
+  block_fs_type * block_fs = block_fs_mount( "INDEX.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  buffer_type * buffer = buffer_alloc( 100 );
+  int i;
+  
+  for (i=0; i < NUM_INDEX_KEYS; i++) {
+    char * filename = util_alloc_sprintf("KEY.%d" , i );
+    int value = -i;
+    block_fs_fwrite_file( block_fs , filename , &i , sizeof i );
+    buffer_clear( buffer );
+    buffer_fwrite_int( buffer , value );
+    block_fs_fwrite_ikey_buffer( block_fs , index_ikey( i ) , buffer );
+    free( filename );
+  }
+  
+  for (i=0; i < NUM_INDEX_KEYS; i++) {
+    if ((i % 4) != 0) {
+      char * filename = util_alloc_sprintf("KEY.%d" , i );
+      block_fs_unlink_file( block_fs , filename );
+      block_fs_unlink_ikey( block_fs , index_ikey( i ));
+      free( filename );
+    }
+  }
+  
+  /* The index holds few keys, and fills up with tombstones. */
+  for (i=0; i < NUM_CHURN_KEYS; i++) {
+    char * filename = util_alloc_sprintf("CHURN.%d" , i );
+    block_fs_fwrite_file( block_fs , filename , &i , sizeof i );
+    block_fs_unlink_file( block_fs , filename );
+    free( filename );
+  }
+  block_fs_fwrite_file( block_fs , "CHURN.LAST" , &i , sizeof i );
+  test_index_content( block_fs );
+  block_fs_close( block_fs , false );
+  
+  /* Mounting from the index, and by scanning the datafile. */
+  block_fs = block_fs_mount( "INDEX.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_index_content( block_fs );
+  block_fs_close( block_fs , false );
+  
+  unlink( "INDEX.index" );
+  block_fs = block_fs_mount( "INDEX.mnt" , 64 , 0 , 1.0 , 0 , false , false , false );
+  test_index_content( block_fs );
+  block_fs_close( block_fs , false );
+  buffer_free( buffer );
+}
+
+
+int main( int argc , char ** argv) {
+  test_work_area_type * work_area = test_work_area_alloc("block_fs");
+  
+  test_concurrent_read( );
+  test_reopen( );
+  test_batch( );
+  test_batch_crash( );
+  test_journal( );
+  test_journal_batch( );
+  test_compact( );
+  test_background_compactor( );
+  test_ikey( );
+  test_index( );
+  
+  test_work_area_free( work_area );
+  exit(0);
+}
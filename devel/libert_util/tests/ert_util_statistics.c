@@ -0,0 +1,69 @@
+/*
+   Copyright (C) 2013  Statoil ASA, Norway. 
+    
+   The file 'ert_util_statistics.c' is part of ERT - Ensemble based Reservoir Tool. 
+    
+   ERT is free software: you can redistribute it and/or modify 
+   it under the terms of the GNU General Public License as published by 
+   the Free Software Foundation, either version 3 of the License, or 
+   (at your option) any later version. 
+    
+   ERT is distributed in the hope that it will be useful, but WITHOUT ANY 
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or 
+   FITNESS FOR A PARTICULAR PURPOSE.   
+    
+   See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+   for more details. 
+*/
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <ert/util/test_util.h>
+#include <ert/util/util.h>
+#include <ert/util/rng.h>
+#include <ert/util/double_vector.h>
+#include <ert/util/statistics.h>
+
+
+void test_quantile( const double_vector_type * data ) {
+  double_vector_type * sorted = double_vector_alloc_copy( data );
+  double_vector_type * selected = double_vector_alloc( 0 , 0 );
+  int iq;
+
+  double_vector_sort( sorted );
+  for (iq = 0; iq <= 100; iq++) {
+    double quantile = iq * 0.01;
+    double_vector_memcpy( selected , data );
+    test_assert_double_equal( statistics_empirical_quantile__( sorted , quantile ) ,
+                              statistics_empirical_quantile_select( selected , quantile ));
+  }
+  double_vector_free( selected );
+  double_vector_free( sorted );
+}
+
+
+int main(int argc , char ** argv) {
+  rng_type * rng = rng_alloc( MZRAN , INIT_DEFAULT );
+  int size;
+
+  for (size = 1; size < 200; size += 7) {
+    double_vector_type * data = double_vector_alloc( 0 , 0 );
+    int i;
+
+    /* Distinct values. */
+    for (i=0; i < size; i++)
+      double_vector_append( data , rng_get_double( rng ));
+    test_quantile( data );
+
+    /* Many equal values. */
+    double_vector_reset( data );
+    for (i=0; i < size; i++)
+      double_vector_append( data , rng_get_int( rng , 4 ));
+    test_quantile( data );
+
+    double_vector_free( data );
+  }
+
+  rng_free( rng );
+  exit(0);
+}
@@ -68,6 +68,25 @@ void test_alloc() {
 
 
 
+void test_idel_insert() {
+  int_vector_type * v = int_vector_alloc(0,0);
+  int i;
+  for (i=0; i < 10; i++)
+    int_vector_append( v , i );
+
+  test_assert_int_equal( int_vector_idel( v , 1 ) , 1 );
+  int_vector_idel_block( v , 3 , 2 );
+  int_vector_insert( v , 1 , 77 );
+  {
+    const int expected[] = {0 , 77 , 2 , 3 , 6 , 7 , 8 , 9};
+    test_assert_int_equal( int_vector_size( v ) , 8 );
+    for (i=0; i < 8; i++)
+      test_assert_int_equal( int_vector_iget( v , i ) , expected[i] );
+  }
+  int_vector_free( v );
+}
+
+
 int main(int argc , char ** argv) {
   
   int_vector_type * int_vector = int_vector_alloc( 0 , 99);
@@ -75,6 +94,7 @@ int main(int argc , char ** argv) {
   test_assert_int_equal( -1 , int_vector_index(int_vector , 100));
   test_assert_int_equal( -1 , int_vector_index_sorted(int_vector , 100));
 
+  test_idel_insert();
   test_assert_true( int_vector_is_instance( int_vector ));
   test_assert_false( double_vector_is_instance( int_vector ));
   int_vector_iset( int_vector , 2 , 0);       
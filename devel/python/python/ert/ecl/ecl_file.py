@@ -185,6 +185,10 @@ class EclFile(CClass):
               when not used; to save number of open file descriptors
               in cases where a high number of EclFile instances are
               open concurrently.
+
+           ecl.ECL_FILE_USE_INDEX : The keyword index is loaded from
+              the file 'filename.idx' instead of scanning through the
+              file; the index file is (re)created when needed.
         
         When the file has been loaded the EclFile instance can be used
         to query for and get reference to the EclKW instances